@@ -0,0 +1,458 @@
+﻿#pragma once
+// ir_codegen 이 생성하는 모델별 C++ 코드가 사용하는 kernel (표준 라이브러리만 사용, OpenMP 선택)
+// shape, stride, padding 은 모두 template 인자 (레이어마다 따로 instantiate 되어 loop 범위가 상수)
+// 계산식은 cpu_interpreter.cpp 의 같은 레이어와 동일 (conv, fully connected 는 누적 순서만 다름)
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#include <immintrin.h>
+#define AOT_AVX2 1
+#endif
+
+namespace aot
+{
+	// ir::ActivationType 과 같은 계산 (kNONE : activation 없음)
+	enum class Act { kNONE, kRELU, kSIGMOID, kTANH, kLEAKY_RELU, kELU, kSELU, kSOFTSIGN, kSOFTPLUS, kCLIP, kSILU };
+
+	template <Act A>
+	inline float activate(float x, float alpha, float beta)
+	{
+		switch (A) {
+		case Act::kNONE: return x;
+		case Act::kRELU: return x > 0.f ? x : 0.f;
+		case Act::kSIGMOID: return 1.f / (1.f + std::exp(-x));
+		case Act::kTANH: return std::tanh(x);
+		case Act::kLEAKY_RELU: return x > 0.f ? x : alpha * x;
+		case Act::kELU: return x > 0.f ? x : alpha * (std::exp(x) - 1.f);
+		case Act::kSELU: return beta * (x > 0.f ? x : alpha * (std::exp(x) - 1.f));
+		case Act::kSOFTSIGN: return x / (1.f + std::fabs(x));
+		case Act::kSOFTPLUS: return alpha * std::log(1.f + std::exp(beta * x));
+		case Act::kCLIP: return std::min(std::max(x, alpha), beta);
+		case Act::kSILU: return x / (1.f + std::exp(-x));
+		}
+		return x;
+	}
+
+	// ir::ElementWiseOperation 과 같은 순서
+	enum class Op { kSUM, kPROD, kMAX, kMIN, kSUB, kDIV, kPOW };
+
+	template <Op O>
+	inline float binary(float a, float b)
+	{
+		switch (O) {
+		case Op::kSUM: return a + b;
+		case Op::kPROD: return a * b;
+		case Op::kMAX: return std::max(a, b);
+		case Op::kMIN: return std::min(a, b);
+		case Op::kSUB: return a - b;
+		case Op::kDIV: return a / b;
+		case Op::kPOW: return std::pow(a, b);
+		}
+		return a;
+	}
+
+	/* ------ conv (panel GEMM) ------ */
+
+	static const int kMR = 6;	// 가중치 panel 행 수 (AVX2 6x16 register block, cpu_gemm 과 같음)
+	static const int kNR = 16;	// micro kernel 열 수
+	static const int kNT = 64;	// task 당 출력 pixel 수
+	static const int kMT = 96;	// task 당 출력 채널 수 (kMR 배수)
+
+	// 가중치 [rows, depth] -> [rows / kMR][depth][kMR] (남는 행은 0), ir_codegen 이 생성시 정렬해서 저장
+	inline int64_t packedSize(int rows, int depth)
+	{
+		return (int64_t)(rows + kMR - 1) / kMR * kMR * depth;
+	}
+
+	inline void packPanels(const float* w, int rows, int depth, float* dst)
+	{
+		for (int p = 0; p < (rows + kMR - 1) / kMR; p++) {
+			for (int k = 0; k < depth; k++) {
+				for (int i = 0; i < kMR; i++) {
+					const int r = p * kMR + i;
+					dst[((int64_t)p * depth + k) * kMR + i] = r < rows ? w[(int64_t)r * depth + k] : 0.f;
+				}
+			}
+		}
+	}
+
+	// acc[kMR][kNR] = panel [KD][kMR] x b [KD][kNR] (행 간격 ldb)
+	// 생성 코드는 대상 CPU 로 compile 하므로 AVX2 여부는 compile 시점에 결정 (cpu_gemm 의 runtime dispatch 불필요)
+	template <int KD>
+	inline void micro(const float* a, const float* b, int64_t ldb, float (&acc)[kMR][kNR])
+	{
+#ifdef AOT_AVX2
+		__m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps(), c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+		__m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps(), c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+		__m256 c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps(), c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+		for (int k = 0; k < KD; k++) {
+			const float* bk = b + k * ldb;
+			const float* ak = a + k * kMR;
+			const __m256 b0 = _mm256_loadu_ps(bk), b1 = _mm256_loadu_ps(bk + 8);
+			__m256 av = _mm256_broadcast_ss(ak + 0);
+			c00 = _mm256_fmadd_ps(av, b0, c00); c01 = _mm256_fmadd_ps(av, b1, c01);
+			av = _mm256_broadcast_ss(ak + 1);
+			c10 = _mm256_fmadd_ps(av, b0, c10); c11 = _mm256_fmadd_ps(av, b1, c11);
+			av = _mm256_broadcast_ss(ak + 2);
+			c20 = _mm256_fmadd_ps(av, b0, c20); c21 = _mm256_fmadd_ps(av, b1, c21);
+			av = _mm256_broadcast_ss(ak + 3);
+			c30 = _mm256_fmadd_ps(av, b0, c30); c31 = _mm256_fmadd_ps(av, b1, c31);
+			av = _mm256_broadcast_ss(ak + 4);
+			c40 = _mm256_fmadd_ps(av, b0, c40); c41 = _mm256_fmadd_ps(av, b1, c41);
+			av = _mm256_broadcast_ss(ak + 5);
+			c50 = _mm256_fmadd_ps(av, b0, c50); c51 = _mm256_fmadd_ps(av, b1, c51);
+		}
+		_mm256_storeu_ps(acc[0], c00); _mm256_storeu_ps(acc[0] + 8, c01);
+		_mm256_storeu_ps(acc[1], c10); _mm256_storeu_ps(acc[1] + 8, c11);
+		_mm256_storeu_ps(acc[2], c20); _mm256_storeu_ps(acc[2] + 8, c21);
+		_mm256_storeu_ps(acc[3], c30); _mm256_storeu_ps(acc[3] + 8, c31);
+		_mm256_storeu_ps(acc[4], c40); _mm256_storeu_ps(acc[4] + 8, c41);
+		_mm256_storeu_ps(acc[5], c50); _mm256_storeu_ps(acc[5] + 8, c51);
+#else
+		float c[kMR][kNR] = {};
+		for (int k = 0; k < KD; k++) {
+			const float* bk = b + k * ldb;
+			for (int i = 0; i < kMR; i++) {
+				const float ai = a[k * kMR + i];
+				for (int n = 0; n < kNR; n++) c[i][n] += ai * bk[n];
+			}
+		}
+		std::memcpy(acc, c, sizeof(c));
+#endif
+	}
+
+	//! \struct Conv
+	//!
+	//! \brief 1 sample NCHW conv. task = (group, 출력 pixel tile, 출력 채널 chunk)
+	//!  1x1 stride 1 은 입력을 그대로 B 로 사용, 나머지는 tile 단위 im2col 후 panel GEMM, bias, activation 은 저장시 적용
+	//!
+	template <int C, int H, int W, int K, int OH, int OW, int KH, int KW, int SH, int SW, int PH, int PW, int DH, int DW, int G, Act A>
+	struct Conv
+	{
+		static const int Cg = C / G, Kg = K / G, KD = Cg * KH * KW, P = OH * OW;
+		static const bool kDIRECT_B = KH == 1 && KW == 1 && SH == 1 && SW == 1 && PH == 0 && PW == 0 && OH == H && OW == W;
+		static const int kTILES = (P + kNT - 1) / kNT, kCHUNKS = (Kg + kMT - 1) / kMT;
+		static const int64_t kGROUP_WEIGHTS = (int64_t)(Kg + kMR - 1) / kMR * kMR * KD;
+
+		// 출력 pixel [j0, j0 + nc) 의 im2col -> col [KD][kNT] (남는 열은 0)
+		static void im2col(const float* in, int g, int j0, int nc, float* col)
+		{
+			for (int p = 0; p < KD; p++) {
+				const int c = p / (KH * KW), kh = p / KW % KH, kw = p % KW;
+				const float* plane = in + (int64_t)(g * Cg + c) * H * W;
+				float* d = col + (int64_t)p * kNT;
+				int oh = j0 / OW, ow = j0 % OW;
+				for (int j = 0; j < nc; j++) {
+					const int ih = oh * SH + kh * DH - PH, iw = ow * SW + kw * DW - PW;
+					d[j] = (ih >= 0 && ih < H && iw >= 0 && iw < W) ? plane[ih * W + iw] : 0.f;
+					if (++ow == OW) { ow = 0; oh++; }
+				}
+				for (int j = nc; j < kNT; j++) d[j] = 0.f;
+			}
+		}
+
+		// weights : group 별 packPanels(Kg, KD), bias : K 개 (nullptr 이면 0)
+		static void run(const float* in, const float* weights, const float* bias, float alpha, float beta, float* out)
+		{
+#pragma omp parallel
+			{
+				std::vector<float> col((size_t)KD * kNT);
+#pragma omp for schedule(dynamic)
+				for (int t = 0; t < G * kTILES * kCHUNKS; t++) {
+					const int g = t / (kTILES * kCHUNKS), j0 = t / kCHUNKS % kTILES * kNT;
+					const int m0 = t % kCHUNKS * kMT, m1 = std::min(Kg, m0 + kMT);
+					const int nc = std::min(kNT, P - j0);
+					const float* b;
+					int64_t ldb;
+					if (kDIRECT_B && nc == kNT) {
+						b = in + (int64_t)g * Cg * P + j0;
+						ldb = P;
+					}
+					else {
+						im2col(in, g, j0, nc, col.data());
+						b = col.data();
+						ldb = kNT;
+					}
+					// 열 block (B 가 L1 에 남음) 마다 panel 순회
+					for (int n0 = 0; n0 < nc; n0 += kNR) {
+						const int nr = std::min(kNR, nc - n0);
+						for (int m = m0; m < m1; m += kMR) {
+							float acc[kMR][kNR];
+							micro<KD>(weights + g * kGROUP_WEIGHTS + (int64_t)m * KD, b + n0, ldb, acc);
+							for (int i = 0; i < std::min(kMR, m1 - m); i++) {
+								const int k = g * Kg + m + i;
+								const float bk = bias ? bias[k] : 0.f;
+								float* o = out + (int64_t)k * P + j0 + n0;
+								for (int n = 0; n < nr; n++) o[n] = activate<A>(acc[i][n] + bk, alpha, beta);
+							}
+						}
+					}
+				}
+			}
+		}
+	};
+
+	// fully connected (batch 1) : out[N] = W[N, KD] in + bias
+	template <int N, int KD, Act A>
+	inline void fullyConnected(const float* in, const float* weights, const float* bias, float alpha, float beta, float* out)
+	{
+#pragma omp parallel for schedule(static)
+		for (int n = 0; n < N; n++) {
+			const float* w = weights + (int64_t)n * KD;
+			float partial[kNR] = {};
+			int k = 0;
+			for (; k + kNR <= KD; k += kNR) {
+				for (int i = 0; i < kNR; i++) partial[i] += w[k + i] * in[k + i];
+			}
+			float sum = 0.f;
+			for (; k < KD; k++) sum += w[k] * in[k];
+			for (int i = 0; i < kNR; i++) sum += partial[i];
+			out[n] = activate<A>(sum + (bias ? bias[n] : 0.f), alpha, beta);
+		}
+	}
+
+	/* ------ 나머지 레이어 ------ */
+
+	// NHWC BGR uint8 -> NCHW RGB float (TYPE 1 이면 mean / std 정규화)
+	template <int C, int H, int W, int TYPE>
+	inline void preprocess(const uint8_t* in, const float* mean, const float* std, float* out)
+	{
+		for (int c = 0; c < C; c++) {
+			const int src_c = C - 1 - c;
+			const float m = TYPE == 1 ? mean[c] : 0.f;
+			const float inv_std = TYPE == 1 ? 1.f / std[c] : 1.f;
+			float* dst = out + (int64_t)c * H * W;
+#pragma omp parallel for schedule(static)
+			for (int i = 0; i < H * W; i++) dst[i] = (in[(int64_t)i * C + src_c] / 255.f - m) * inv_std;
+		}
+	}
+
+	template <int64_t COUNT, Act A>
+	inline void activation(const float* in, float alpha, float beta, float* out)
+	{
+#pragma omp parallel for schedule(static)
+		for (int i = 0; i < (int)COUNT; i++) out[i] = activate<A>(in[i], alpha, beta);
+	}
+
+	// 같은 shape 의 두 입력
+	template <int64_t COUNT, Op O, Act A>
+	inline void elementwise(const float* a, const float* b, float alpha, float beta, float* out)
+	{
+#pragma omp parallel for schedule(static)
+		for (int i = 0; i < (int)COUNT; i++) out[i] = activate<A>(binary<O>(a[i], b[i]), alpha, beta);
+	}
+
+	template <int PLANES, int H, int W, int OH, int OW, int KH, int KW, int SH, int SW, int PH, int PW, bool MAX, bool EXCLUDE_PADDING>
+	inline void pooling(const float* in, float* out)
+	{
+#pragma omp parallel for schedule(static)
+		for (int p = 0; p < PLANES; p++) {
+			const float* src = in + (int64_t)p * H * W;
+			float* dst = out + (int64_t)p * OH * OW;
+			for (int oh = 0; oh < OH; oh++) {
+				const int h0 = oh * SH - PH, h1 = std::min(h0 + KH, H);
+				for (int ow = 0; ow < OW; ow++) {
+					const int w0 = ow * SW - PW, w1 = std::min(w0 + KW, W);
+					float acc = MAX ? -INFINITY : 0.f;
+					for (int h = std::max(h0, 0); h < h1; h++) {
+						for (int w = std::max(w0, 0); w < w1; w++) acc = MAX ? std::max(acc, src[h * W + w]) : acc + src[h * W + w];
+					}
+					if (!MAX) acc /= EXCLUDE_PADDING ? (h1 - std::max(h0, 0)) * (w1 - std::max(w0, 0)) : KH * KW;
+					dst[oh * OW + ow] = acc;
+				}
+			}
+		}
+	}
+
+	// concat 입력 하나를 출력의 OFFSET 위치에 복사 (OUTER 개 block)
+	template <int OUTER, int64_t OUT_BLOCK, int64_t BLOCK, int64_t OFFSET>
+	inline void concatInput(const float* in, float* out)
+	{
+#pragma omp parallel for schedule(static)
+		for (int o = 0; o < OUTER; o++) memcpy(out + o * OUT_BLOCK + OFFSET, in + o * BLOCK, BLOCK * sizeof(float));
+	}
+
+	// 마지막 2 차원 padding (음수면 잘라냄)
+	template <int PLANES, int H, int W, int OH, int OW, int PT, int PL>
+	inline void padding(const float* in, float* out)
+	{
+#pragma omp parallel for schedule(static)
+		for (int p = 0; p < PLANES; p++) {
+			for (int oh = 0; oh < OH; oh++) {
+				const int ih = oh - PT;
+				float* orow = out + ((int64_t)p * OH + oh) * OW;
+				for (int ow = 0; ow < OW; ow++) {
+					const int iw = ow - PL;
+					orow[ow] = (ih >= 0 && ih < H && iw >= 0 && iw < W) ? in[((int64_t)p * H + ih) * W + iw] : 0.f;
+				}
+			}
+		}
+	}
+
+	// 마지막 2 차원 resize (asymmetric 또는 align corners 좌표), 합쳐진 padding (PT, PL, PB, PR) 은 0
+	template <int PLANES, int H, int W, int OH, int OW, bool NEAREST, bool ALIGN, int PT = 0, int PL = 0, int PB = 0, int PR = 0>
+	inline void resize(const float* in, float* out)
+	{
+		const int FH = PT + OH + PB, FW = PL + OW + PR;
+		const float sy = ALIGN ? (OH > 1 ? (float)(H - 1) / (OH - 1) : 0.f) : (float)H / OH;
+		const float sx = ALIGN ? (OW > 1 ? (float)(W - 1) / (OW - 1) : 0.f) : (float)W / OW;
+		int x0[OW], x1[OW];
+		float fx[OW];
+		for (int ow = 0; ow < OW; ow++) {
+			const float x = ow * sx;
+			x0[ow] = NEAREST ? std::min(ALIGN ? (int)std::lround(x) : (int)std::floor(x), W - 1) : std::min((int)x, W - 1);
+			x1[ow] = std::min(x0[ow] + 1, W - 1);
+			fx[ow] = x - x0[ow];
+		}
+#pragma omp parallel for schedule(static)
+		for (int t = 0; t < PLANES * OH; t++) {
+			const int p = t / OH, oh = t % OH;
+			const float* src = in + (int64_t)p * H * W;
+			float* orow = out + ((int64_t)p * FH + PT + oh) * FW + PL;
+			const float y = oh * sy;
+			if (PL + PR > 0) {
+				std::fill(orow - PL, orow, 0.f);
+				std::fill(orow + OW, orow + OW + PR, 0.f);
+			}
+			if (oh == 0 && PT > 0) std::fill(orow - PL - (int64_t)PT * FW, orow - PL, 0.f);
+			if (oh == OH - 1 && PB > 0) std::fill(orow - PL + FW, orow - PL + (int64_t)(PB + 1) * FW, 0.f);
+			if (NEAREST) {
+				const float* row = src + (int64_t)std::min(ALIGN ? (int)std::lround(y) : (int)std::floor(y), H - 1) * W;
+				for (int ow = 0; ow < OW; ow++) orow[ow] = row[x0[ow]];
+			}
+			else {
+				const int y0 = std::min((int)y, H - 1), y1 = std::min(y0 + 1, H - 1);
+				const float fy = y - y0;
+				const float* r0 = src + (int64_t)y0 * W;
+				const float* r1 = src + (int64_t)y1 * W;
+				for (int ow = 0; ow < OW; ow++) {
+					const float top = r0[x0[ow]] + (r0[x1[ow]] - r0[x0[ow]]) * fx[ow];
+					const float bottom = r1[x0[ow]] + (r1[x1[ow]] - r1[x0[ow]]) * fx[ow];
+					orow[ow] = top + (bottom - top) * fy;
+				}
+			}
+		}
+	}
+
+	// 임의 축 순서 변경 (out.d[i] = dims[perm[i]]), dims, perm 은 생성 코드의 constexpr 배열
+	template <int NB>
+	inline void permute(const float* in, const int (&dims)[NB], const int (&perm)[NB], float* out)
+	{
+		int64_t strides[NB], src_strides[NB];
+		int out_dims[NB];
+		int64_t s = 1, total = 1;
+		for (int i = NB - 1; i >= 0; i--) {
+			strides[i] = s;
+			s *= dims[i];
+		}
+		for (int i = 0; i < NB; i++) {
+			out_dims[i] = dims[perm[i]];
+			src_strides[i] = strides[perm[i]];
+			total *= dims[i];
+		}
+		const int inner = out_dims[NB - 1];
+		const int rows = (int)(total / inner);
+#pragma omp parallel for schedule(static)
+		for (int r = 0; r < rows; r++) {
+			int64_t rem = r, src = 0;
+			for (int i = NB - 2; i >= 0; i--) {
+				src += (rem % out_dims[i]) * src_strides[i];
+				rem /= out_dims[i];
+			}
+			float* o = out + (int64_t)r * inner;
+			for (int x = 0; x < inner; x++) o[x] = in[src + x * src_strides[NB - 1]];
+		}
+	}
+
+	template <int NB>
+	inline void slice(const float* in, const int (&dims)[NB], const int (&out_dims)[NB], const int (&start)[NB], const int (&stride)[NB], float* out)
+	{
+		int64_t strides[NB];
+		int64_t s = 1, total = 1;
+		for (int i = NB - 1; i >= 0; i--) {
+			strides[i] = s;
+			s *= dims[i];
+			total *= out_dims[i];
+		}
+		const int inner = out_dims[NB - 1];
+		const int rows = (int)(total / inner);
+#pragma omp parallel for schedule(static)
+		for (int r = 0; r < rows; r++) {
+			int64_t rem = r, src = 0;
+			for (int i = NB - 2; i >= 0; i--) {
+				src += (start[i] + (rem % out_dims[i]) * stride[i]) * strides[i];
+				rem /= out_dims[i];
+			}
+			src += start[NB - 1];
+			float* o = out + (int64_t)r * inner;
+			for (int x = 0; x < inner; x++) o[x] = in[src + (int64_t)x * stride[NB - 1]];
+		}
+	}
+
+	template <int OUTER, int LEN, int64_t INNER, int K, bool MAX>
+	inline void topk(const float* in, float* values, float* indices)
+	{
+		std::vector<int> order(LEN);
+		for (int t = 0; t < OUTER * (int)INNER; t++) {
+			const int64_t o = t / INNER, i = t % INNER;
+			const float* src = in + o * LEN * INNER + i;
+			for (int j = 0; j < LEN; j++) order[j] = j;
+			std::partial_sort(order.begin(), order.begin() + K, order.end(), [&](int x, int y) {
+				const float vx = src[x * INNER], vy = src[y * INNER];
+				if (vx != vy) return MAX ? vx > vy : vx < vy;
+				return x < y;
+			});
+			for (int j = 0; j < K; j++) {
+				values[(o * K + j) * INNER + i] = src[order[j] * INNER];
+				indices[(o * K + j) * INNER + i] = (float)order[j];
+			}
+		}
+	}
+
+	template <int OUTER, int LEN, int64_t INNER, int COUNT>
+	inline void gather(const float* data, const float* indices, float* out)
+	{
+#pragma omp parallel for schedule(static)
+		for (int t = 0; t < OUTER * COUNT; t++) {
+			const int o = t / COUNT, j = t % COUNT;
+			int idx = (int)indices[j];
+			if (idx < 0) idx += LEN;
+			memcpy(out + (int64_t)t * INNER, data + ((int64_t)o * LEN + idx) * INNER, INNER * sizeof(float));
+		}
+	}
+
+	// yololayer plugin 과 같은 계산 ([3, H, W, CLASSES + 5] -> [3 * H * W, 6])
+	template <int H, int W, int CLASSES, int STRIDE>
+	inline void yololayer(const float* in, const float* anchor_grid, float* out)
+	{
+		const int C = CLASSES + 5;
+#pragma omp parallel for schedule(static)
+		for (int o = 0; o < 3 * H * W; o++) {
+			const float* v = in + (int64_t)o * C;
+			float* r = out + (int64_t)o * 6;
+			const int w_idx = o % W, h_idx = o / W % H, a_idx = o / (W * H) % 3 * 2;
+			r[0] = (v[0] * 2.f - 0.5f + w_idx) * STRIDE;
+			r[1] = (v[1] * 2.f - 0.5f + h_idx) * STRIDE;
+			r[2] = v[2] * v[2] * 4.f * anchor_grid[a_idx] * STRIDE;
+			r[3] = v[3] * v[3] * 4.f * anchor_grid[a_idx + 1] * STRIDE;
+			if (v[4] < 0.1f) {
+				r[4] = 0.f;
+				r[5] = -1.f;
+				continue;
+			}
+			int class_id = 0;
+			float max_cls_prob = 0.f;
+			for (int i = 5; i < C; i++) {
+				if (v[i] > max_cls_prob) {
+					max_cls_prob = v[i];
+					class_id = i - 5;
+				}
+			}
+			r[4] = v[4] * max_cls_prob;
+			r[5] = (float)class_id;
+		}
+	}
+}
@@ -0,0 +1,118 @@
+﻿// DETR attention (E 256, head 8) 의 fused (online softmax) / unfused (score 행렬) 실행 시간, 오차 비교
+// usage : attention_bench [-s 500,800,...] [-n iterations] [-t threads]
+//   -s : 입력 이미지 크기 (정사각형), encoder self-attention 길이 = (s/32)^2, decoder cross-attention 은 query 100 개
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+#include "cpu_attention.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+static const int kEMBED = 256;
+static const int kHEADS = 8;
+static const int kQUERIES = 100;	// DETR num_queries
+static const float kSCALING = 0.17677669529663687f;	// 1 / sqrt(head_dim)
+
+static double bestMs(int iterations, const std::function<void()>& fn)
+{
+	fn();	// warm up
+	double ms = 1e30;
+	for (int it = 0; it < iterations; it++) {
+		auto t0 = std::chrono::high_resolution_clock::now();
+		fn();
+		auto t1 = std::chrono::high_resolution_clock::now();
+		ms = std::min(ms, std::chrono::duration<double, std::milli>(t1 - t0).count());
+	}
+	return ms;
+}
+
+// double 정밀도 기준값 (head 별, query 행 별 softmax)
+static void attentionReference(const float* q, const float* k, const float* v, int Lq, int Lk, int heads, int D, float scale, float* out)
+{
+	const int E = heads * D;
+#pragma omp parallel for schedule(dynamic)
+	for (int t = 0; t < heads * Lq; t++) {
+		const int h = t / Lq, i = t % Lq;
+		std::vector<double> p(Lk);
+		double m = -1e300, sum = 0.0;
+		for (int j = 0; j < Lk; j++) {
+			double dot = 0.0;
+			for (int d = 0; d < D; d++) dot += (double)q[(size_t)i * E + h * D + d] * k[(size_t)j * E + h * D + d];
+			p[j] = dot * scale;
+			m = std::max(m, p[j]);
+		}
+		for (int j = 0; j < Lk; j++) sum += p[j] = std::exp(p[j] - m);
+		for (int d = 0; d < D; d++) {
+			double acc = 0.0;
+			for (int j = 0; j < Lk; j++) acc += p[j] * v[(size_t)j * E + h * D + d];
+			out[(size_t)i * E + h * D + d] = (float)(acc / sum);
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<int> sizes = { 500, 800, 1024, 1333 };
+	int iterations = 5;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-n") && i + 1 < argc) iterations = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+			sizes.clear();
+			std::stringstream ss(argv[++i]);
+			std::string item;
+			while (std::getline(ss, item, ',')) sizes.push_back(atoi(item.c_str()));
+		}
+		else if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+#ifdef _OPENMP
+			omp_set_num_threads(atoi(argv[++i]));
+#else
+			++i;
+#endif
+		}
+	}
+
+	const int D = kEMBED / kHEADS;
+	std::cout << std::left << std::setw(8) << "input" << std::setw(16) << "attention" << std::right << std::setw(7) << "Lq" << std::setw(7) << "Lk"
+		<< std::setw(16) << "score MB" << std::setw(14) << "unfused ms" << std::setw(12) << "fused ms" << std::setw(10) << "speedup"
+		<< std::setw(14) << "unfused err" << std::setw(12) << "fused err" << std::endl;
+	std::mt19937 rng(0);
+	std::normal_distribution<float> normal(0.f, 1.f);
+	for (int size : sizes) {
+		const int L = ((size + 31) / 32) * ((size + 31) / 32);	// backbone stride 32 feature map
+		const int cases[2][2] = { { L, L }, { kQUERIES, L } };
+		const char* names[2] = { "encoder self", "decoder cross" };
+		for (int c = 0; c < 2; c++) {
+			const int Lq = cases[c][0], Lk = cases[c][1];
+			std::vector<float> q((size_t)Lq * kEMBED), k((size_t)Lk * kEMBED), v(k.size());
+			for (auto& x : q) x = normal(rng);
+			for (auto& x : k) x = normal(rng);
+			for (auto& x : v) x = normal(rng);
+			std::vector<float> ref(q.size()), fused(q.size()), unfused(q.size());
+			attentionReference(q.data(), k.data(), v.data(), Lq, Lk, kHEADS, D, kSCALING, ref.data());
+
+			const double unfused_ms = bestMs(iterations, [&]() { attentionUnfused(q.data(), k.data(), v.data(), Lq, Lk, kHEADS, D, kSCALING, unfused.data()); });
+			const double fused_ms = bestMs(iterations, [&]() { attention(q.data(), k.data(), v.data(), Lq, Lk, kHEADS, D, kSCALING, fused.data()); });
+			double unfused_err = 0.0, fused_err = 0.0;
+			for (size_t i = 0; i < ref.size(); i++) {
+				unfused_err = std::max(unfused_err, (double)std::fabs(unfused[i] - ref[i]));
+				fused_err = std::max(fused_err, (double)std::fabs(fused[i] - ref[i]));
+			}
+			// 분해된 graph 는 matmul, softmax 출력 [heads, Lq, Lk] 두 개를 만듦
+			const double score_mb = 2.0 * kHEADS * Lq * Lk * sizeof(float) / (1 << 20);
+			std::cout << std::left << std::setw(8) << size << std::setw(16) << names[c] << std::right << std::setw(7) << Lq << std::setw(7) << Lk
+				<< std::fixed << std::setprecision(1) << std::setw(16) << score_mb << std::setprecision(2) << std::setw(14) << unfused_ms << std::setw(12) << fused_ms
+				<< std::setw(9) << unfused_ms / fused_ms << "x" << std::scientific << std::setprecision(1) << std::setw(14) << unfused_err << std::setw(12) << fused_err << std::fixed;
+			if (fused_err > 1e-4) std::cout << " [ERROR]";
+			std::cout << std::endl;
+		}
+	}
+	return 0;
+}
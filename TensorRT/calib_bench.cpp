@@ -0,0 +1,99 @@
+﻿// calibration 이미지 공급 시간 비교 : getBatch 안에서 동기로 읽기 (기존 방식) vs CalibBatchLoader 미리 읽기
+// usage : calib_bench <yolov5s|resnet18|vgg11|unet|detr> [options]
+//   -d <dir>         calibration 이미지 폴더 (기본 ../Data_calib/)
+//   -b <batch>       batch 크기 (기본 1)
+//   -t <threads>     미리 읽기 thread 수 (기본 hardware thread 수)
+//   -q <depth>       미리 준비하는 batch 수 (기본 kCALIB_PREFETCH_BATCHES)
+//   -s <ms>          batch 하나를 소비하는 시간 (builder 의 calibration 실행 대신 sleep, 기본 0)
+//   -raw             폴더의 파일을 입력 크기 uint8 HWC BGR raw 로 읽음 (OpenCV 디코딩 없이)
+// 전처리는 모델 예제의 Int8EntropyCalibrator2 와 같은 process_type (ModelConfig::calib_process)
+// 두 방식의 batch 내용이 같은지 hash 로 확인, wall 은 첫 batch 요청부터 마지막 batch 까지
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "calib_loader.hpp"
+#include "calib_preprocess.hpp"
+#include "common.hpp"
+#include "ir_models.hpp"
+
+struct BenchResult {
+	CalibLoaderStats stats;
+	double wall_ms;
+	uint64_t hash;
+};
+
+static BenchResult consume(const std::vector<std::string>& files, int batch, const CalibPreprocess& preprocess, int threads, int depth, int consume_ms)
+{
+	BenchResult r;
+	r.hash = 1469598103934665603ull;	// FNV-1a
+	auto t0 = std::chrono::high_resolution_clock::now();
+	CalibBatchLoader loader(files, batch, preprocess, threads, depth);
+	while (const uint8_t* data = loader.next()) {
+		for (size_t i = 0; i < loader.batchBytes(); i++) r.hash = (r.hash ^ data[i]) * 1099511628211ull;
+		if (consume_ms > 0) std::this_thread::sleep_for(std::chrono::milliseconds(consume_ms));
+	}
+	auto t1 = std::chrono::high_resolution_clock::now();
+	r.stats = loader.stats();
+	r.wall_ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+	return r;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2) {
+		std::cerr << "usage : calib_bench <yolov5s|resnet18|vgg11|unet|detr> [-d dir] [-b batch] [-t threads] [-q depth] [-s consume_ms] [-raw]" << std::endl;
+		return 1;
+	}
+	const ir::ModelConfig* config = ir::findModel(argv[1]);
+	if (!config) {
+		std::cerr << "[ERROR] unknown model : " << argv[1] << std::endl;
+		return 1;
+	}
+	std::string dir = "../Data_calib/";
+	int batch = 1, threads = -1, depth = kCALIB_PREFETCH_BATCHES, consume_ms = 0;
+	bool raw = false;
+	for (int i = 2; i < argc; i++) {
+		if (!strcmp(argv[i], "-d") && i + 1 < argc) dir = argv[++i];
+		else if (!strcmp(argv[i], "-b") && i + 1 < argc) batch = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-t") && i + 1 < argc) threads = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-q") && i + 1 < argc) depth = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-s") && i + 1 < argc) consume_ms = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-raw")) raw = true;
+	}
+	if (dir.back() != '/' && dir.back() != '\\') dir += '/';
+
+	std::vector<std::string> names, files;
+	if (read_files_in_dir(dir.c_str(), names) != 0) return 1;
+	for (const std::string& name : names) files.push_back(dir + name);
+	std::unique_ptr<CalibPreprocess> preprocess;
+	if (raw) preprocess.reset(new RawPreprocess(config->input_w, config->input_h));
+	else preprocess = makeCalibPreprocess(config->calib_process, config->input_w, config->input_h);
+	if (threads < 0) threads = std::max(1, (int)std::thread::hardware_concurrency());
+
+	std::cout << "[" << config->name << "] " << files.size() << " images, batch " << batch << ", " << preprocess->name() << " "
+		<< config->input_w << "x" << config->input_h << ", consume " << consume_ms << " ms/batch" << std::endl;
+	const BenchResult sync = consume(files, batch, *preprocess, 0, 1, consume_ms);
+	const BenchResult prefetch = consume(files, batch, *preprocess, threads, depth, consume_ms);
+
+	std::cout << "  " << std::left << std::setw(24) << "mode" << std::right << std::setw(9) << "batches" << std::setw(11) << "wall ms"
+		<< std::setw(12) << "decode ms" << std::setw(10) << "wait ms" << std::setw(10) << "img/s" << std::endl;
+	auto print = [&](const char* mode, const BenchResult& r) {
+		std::cout << "  " << std::left << std::setw(24) << mode << std::right << std::fixed << std::setprecision(1) << std::setw(9) << r.stats.batches
+			<< std::setw(11) << r.wall_ms << std::setw(12) << r.stats.decode_ms << std::setw(10) << r.stats.wait_ms
+			<< std::setw(10) << r.stats.batches * batch * 1000.0 / std::max(r.wall_ms, 1e-9) << std::endl;
+	};
+	print("synchronous", sync);
+	const std::string name = "prefetch " + std::to_string(threads) + " threads x " + std::to_string(depth);
+	print(name.c_str(), prefetch);
+	std::cout << "  speedup " << std::setprecision(2) << sync.wall_ms / std::max(prefetch.wall_ms, 1e-9) << "x, batches "
+		<< (sync.hash == prefetch.hash ? "identical" : "DIFFER") << std::endl;
+	return sync.hash == prefetch.hash ? 0 : 1;
+}
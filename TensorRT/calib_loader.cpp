@@ -0,0 +1,145 @@
+﻿#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include "calib_loader.hpp"
+
+bool RawPreprocess::load(const std::string& path, uint8_t* dst) const
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file.is_open()) return false;
+	file.read((char*)dst, imageBytes());
+	return (size_t)file.gcount() == imageBytes();
+}
+
+bool isCalibList(const std::string& path)
+{
+	return path.size() > 4 && path.compare(path.size() - 4, 4, ".txt") == 0;
+}
+
+bool readCalibList(const std::string& path, std::vector<std::string>& files)
+{
+	std::ifstream file(path);
+	if (!file.is_open()) {
+		std::cerr << "[ERROR] calibration list open error : " << path << std::endl;
+		return false;
+	}
+	std::string line;
+	while (std::getline(file, line)) {
+		if (!line.empty() && line.back() == '\r') line.pop_back();
+		if (line.empty() || line[0] == '#') continue;
+		files.push_back(line);
+	}
+	return true;
+}
+
+bool writeCalibList(const std::string& path, const std::vector<std::string>& files, const std::string& comment)
+{
+	std::ofstream file(path);
+	if (!file.is_open()) {
+		std::cerr << "[ERROR] calibration list write error : " << path << std::endl;
+		return false;
+	}
+	if (!comment.empty()) file << "# " << comment << "\n";
+	for (const std::string& f : files) file << f << "\n";
+	return file.good();
+}
+
+CalibBatchLoader::CalibBatchLoader(const std::vector<std::string>& files, int batchSize, const CalibPreprocess& preprocess, int threads, int depth)
+	: files_(files), batch_(batchSize), nb_batches_(batchSize > 0 ? (int)files.size() / batchSize : 0), preprocess_(preprocess),
+	next_image_(0), released_(0), current_(0), stop_(false), failed_(false), stats_{ 0, 0, 0.0, 0.0, 0.0 },
+	start_(std::chrono::high_resolution_clock::now())
+{
+	if (threads < 0) threads = std::max(1, (int)std::thread::hardware_concurrency());
+	// 동기 실행은 버퍼 하나, 미리 읽기는 batch 수보다 많을 필요 없음
+	depth = threads == 0 ? 1 : std::max(1, std::min(depth, nb_batches_));
+	slots_.resize(depth);
+	for (Slot& s : slots_) {
+		s.data.resize(batchBytes());
+		s.remaining = batch_;
+		s.failed = false;
+	}
+	for (int i = 0; i < threads && nb_batches_ > 0; i++) workers_.emplace_back(&CalibBatchLoader::workerLoop, this);
+}
+
+CalibBatchLoader::~CalibBatchLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	work_cv_.notify_all();
+	for (auto& w : workers_) w.join();
+}
+
+bool CalibBatchLoader::loadImage(int index, Slot& slot)
+{
+	auto t0 = std::chrono::high_resolution_clock::now();
+	const bool ok = preprocess_.load(files_[index], slot.data.data() + (index % batch_) * preprocess_.imageBytes());
+	auto t1 = std::chrono::high_resolution_clock::now();
+	std::lock_guard<std::mutex> lock(mutex_);
+	stats_.decode_ms += std::chrono::duration<double, std::milli>(t1 - t0).count();
+	stats_.images++;
+	if (!ok) {
+		std::cerr << "[ERROR] calibration image cannot open : " << files_[index] << std::endl;
+		slot.failed = true;
+	}
+	return --slot.remaining == 0;
+}
+
+// 이미지 단위로 나눠 가짐 (batch 하나를 여러 thread 가 함께 준비)
+void CalibBatchLoader::workerLoop()
+{
+	const int depth = (int)slots_.size();
+	const int total = nb_batches_ * batch_;
+	while (true) {
+		int index;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			work_cv_.wait(lock, [&] { return stop_ || next_image_ >= total || next_image_ / batch_ < released_ + depth; });
+			if (stop_ || next_image_ >= total) return;
+			index = next_image_++;
+		}
+		if (loadImage(index, slots_[(index / batch_) % depth])) ready_cv_.notify_all();
+	}
+}
+
+const uint8_t* CalibBatchLoader::next()
+{
+	const int depth = (int)slots_.size();
+	auto t0 = std::chrono::high_resolution_clock::now();
+	std::unique_lock<std::mutex> lock(mutex_);
+	// 앞에서 넘겨준 batch 자리를 비우고 depth 뒤의 batch 를 준비하게 함
+	if (current_ > released_) {
+		Slot& prev = slots_[released_ % depth];
+		prev.remaining = batch_;
+		prev.failed = false;
+		released_ = current_;
+		work_cv_.notify_all();
+	}
+	if (failed_ || current_ >= nb_batches_) return nullptr;
+	Slot& slot = slots_[current_ % depth];
+	if (workers_.empty()) {
+		lock.unlock();
+		for (int i = current_ * batch_; i < (current_ + 1) * batch_; i++) loadImage(i, slot);
+		lock.lock();
+	}
+	else {
+		ready_cv_.wait(lock, [&] { return slot.remaining == 0; });
+	}
+	auto t1 = std::chrono::high_resolution_clock::now();
+	stats_.wait_ms += std::chrono::duration<double, std::milli>(t1 - t0).count();
+	stats_.wall_ms = std::chrono::duration<double, std::milli>(t1 - start_).count();
+	if (slot.failed) {
+		failed_ = true;
+		return nullptr;
+	}
+	current_++;
+	stats_.batches++;
+	return slot.data.data();
+}
+
+CalibLoaderStats CalibBatchLoader::stats() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return stats_;
+}
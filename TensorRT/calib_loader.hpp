@@ -0,0 +1,113 @@
+﻿#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const int kCALIB_PREFETCH_BATCHES = 3;	// 미리 준비해 두는 batch 수 (ring buffer 크기)
+
+//! \class CalibPreprocess
+//!
+//! \brief 이미지 파일 하나를 calibration 입력 (uint8 [H, W, 3] BGR, preprocess plugin 입력과 같은 형식) 으로 만드는 전처리
+//!  모델마다 다른 resize, letterbox 방식을 구현 (calib_preprocess.hpp), load 는 여러 thread 에서 동시에 호출됨
+//!
+class CalibPreprocess
+{
+public:
+	CalibPreprocess(int width, int height) : width_(width), height_(height) {}
+	virtual ~CalibPreprocess() {}
+
+	virtual const char* name() const = 0;
+	// path 의 이미지를 dst (imageBytes byte) 에 기록, 읽기 실패면 false
+	virtual bool load(const std::string& path, uint8_t* dst) const = 0;
+
+	int width() const { return width_; }
+	int height() const { return height_; }
+	size_t imageBytes() const { return (size_t)width_ * height_ * 3; }
+
+protected:
+	int width_;
+	int height_;
+};
+
+// 이미 입력 크기로 만든 uint8 HWC BGR raw 파일 (int8_eval -i 와 같은 형식, OpenCV 없이 사용)
+class RawPreprocess : public CalibPreprocess
+{
+public:
+	using CalibPreprocess::CalibPreprocess;
+	const char* name() const override { return "raw"; }
+	bool load(const std::string& path, uint8_t* dst) const override;
+};
+
+// calibration 목록 파일 (calib_select 가 만든 subset) : 줄마다 이미지 경로, '#' 로 시작하는 줄은 주석
+// 폴더 대신 목록 파일 (.txt) 을 주면 목록의 이미지만 순서대로 사용
+bool isCalibList(const std::string& path);
+bool readCalibList(const std::string& path, std::vector<std::string>& files);
+bool writeCalibList(const std::string& path, const std::vector<std::string>& files, const std::string& comment = std::string());
+
+struct CalibLoaderStats {
+	int batches;		// next 로 넘겨준 batch 수
+	int images;			// 전처리한 이미지 수
+	double decode_ms;	// 이미지 읽기, 전처리 시간 합 (모든 thread)
+	double wait_ms;		// next 에서 batch 준비를 기다린 시간 (동기 실행이면 전처리 시간 포함)
+	double wall_ms;		// 생성부터 마지막 batch 까지
+};
+
+//! \class CalibBatchLoader
+//!
+//! \brief calibration 이미지를 batch 단위로 공급. worker thread 가 앞으로 쓸 batch 를 미리 읽어서
+//!  재사용하는 batch 버퍼 ring (depth 개) 에 전처리, 소비 쪽 (getBatch) 은 준비된 버퍼 포인터만 받음
+//!  next 가 반환한 버퍼는 다음 next 호출까지 유효, 그 뒤 같은 자리에 depth 뒤의 batch 를 준비
+//!  threads 0 이면 next 안에서 동기로 읽음 (미리 읽기 없이 비교할 때)
+//!  CUDA 와 무관 (CPU 에서 그대로 테스트, calibrator 는 버퍼를 pinned memory 로 등록해서 전송)
+//!
+class CalibBatchLoader
+{
+public:
+	// files : 이미지 경로, 끝의 batch 크기가 안되는 나머지는 사용 안함 (Int8EntropyCalibrator2 와 같음)
+	// threads < 0 이면 hardware thread 수
+	CalibBatchLoader(const std::vector<std::string>& files, int batchSize, const CalibPreprocess& preprocess, int threads = -1, int depth = kCALIB_PREFETCH_BATCHES);
+	~CalibBatchLoader();
+
+	// 다음 batch (uint8 [batch, H, W, 3]), 끝이거나 읽기 실패면 nullptr
+	const uint8_t* next();
+	bool failed() const { return failed_; }
+
+	int batchCount() const { return nb_batches_; }
+	int batchSize() const { return batch_; }
+	size_t batchBytes() const { return batch_ * preprocess_.imageBytes(); }
+	// ring buffer (pinned memory 등록용)
+	int slotCount() const { return (int)slots_.size(); }
+	uint8_t* slotData(int index) { return slots_[index].data.data(); }
+	CalibLoaderStats stats() const;
+
+private:
+	struct Slot {
+		std::vector<uint8_t> data;
+		int remaining;		// 아직 전처리하지 않은 이미지 수
+		bool failed;
+	};
+
+	void workerLoop();
+	bool loadImage(int index, Slot& slot);
+
+	std::vector<std::string> files_;
+	int batch_;
+	int nb_batches_;
+	const CalibPreprocess& preprocess_;
+	std::vector<Slot> slots_;
+	std::vector<std::thread> workers_;
+	mutable std::mutex mutex_;
+	std::condition_variable work_cv_;		// 다음 batch 자리가 비었음
+	std::condition_variable ready_cv_;		// batch 전처리 완료
+	int next_image_;						// 다음에 읽을 이미지
+	int released_;							// 소비 쪽이 다 쓴 batch 수 (이 batch + depth 전까지 읽기 가능)
+	int current_;							// 다음에 넘겨줄 batch
+	bool stop_;
+	bool failed_;
+	CalibLoaderStats stats_;
+	std::chrono::high_resolution_clock::time_point start_;
+};
@@ -0,0 +1,69 @@
+﻿#include <algorithm>
+#include <cmath>
+#include <opencv2/opencv.hpp>
+#include "calib_preprocess.hpp"
+
+bool ResizePreprocess::load(const std::string& path, uint8_t* dst) const
+{
+	cv::Mat img = cv::imread(path);
+	if (img.empty()) return false;
+	cv::Mat out(height_, width_, CV_8UC3, dst);
+	cv::resize(img, out, out.size(), 0, 0, cv::INTER_LINEAR);
+	return true;
+}
+
+bool CenterLetterboxPreprocess::load(const std::string& path, uint8_t* dst) const
+{
+	cv::Mat img = cv::imread(path);
+	if (img.empty()) return false;
+	cv::Mat out(height_, width_, CV_8UC3, dst);
+	if (img.rows == img.cols) {	// 정사각형 이미지는 그대로 resize
+		cv::resize(img, out, out.size(), 0, 0, cv::INTER_LINEAR);
+		return true;
+	}
+	int new_h, new_w;
+	if (img.cols >= img.rows) {
+		new_h = (int)(img.rows * ((float)width_ / img.cols));
+		new_w = width_;
+	}
+	else {
+		new_h = height_;
+		new_w = (int)(img.cols * ((float)height_ / img.rows));
+	}
+	const int top = (height_ - new_h) / 2;
+	const int left = (width_ - new_w) / 2;
+	out.setTo(cv::Scalar(128, 128, 128));
+	cv::Mat roi = out(cv::Rect(left, top, new_w, new_h));
+	cv::resize(img, roi, roi.size(), 0, 0, cv::INTER_LINEAR);
+	return true;
+}
+
+bool YoloLetterboxPreprocess::load(const std::string& path, uint8_t* dst) const
+{
+	cv::Mat img = cv::imread(path);
+	if (img.empty()) return false;
+	cv::Mat out(height_, width_, CV_8UC3, dst);
+	if (img.rows == img.cols) {
+		cv::resize(img, out, out.size(), 0, 0, cv::INTER_LINEAR);
+		return true;
+	}
+	const float ratio = std::min((float)height_ / img.cols, (float)width_ / img.rows);
+	const int new_h = (int)std::round(img.rows * ratio);
+	const int new_w = (int)std::round(img.cols * ratio);
+	const int top = (int)std::round((height_ - new_h) / 2.f - 0.1f);
+	const int left = (int)std::round((width_ - new_w) / 2.f - 0.1f);
+	out.setTo(cv::Scalar(114, 114, 114));
+	cv::Mat roi = out(cv::Rect(left, top, new_w, new_h));
+	cv::resize(img, roi, roi.size(), 0, 0, cv::INTER_LINEAR);
+	return true;
+}
+
+std::unique_ptr<CalibPreprocess> makeCalibPreprocess(int processType, int width, int height)
+{
+	switch (processType) {
+	case 0: return std::unique_ptr<CalibPreprocess>(new ResizePreprocess(width, height));
+	case 1: return std::unique_ptr<CalibPreprocess>(new CenterLetterboxPreprocess(width, height));
+	case 2: return std::unique_ptr<CalibPreprocess>(new YoloLetterboxPreprocess(width, height));
+	}
+	return nullptr;
+}
@@ -0,0 +1,36 @@
+﻿#pragma once
+#include <memory>
+#include "calib_loader.hpp"
+
+// 예제별 calibration 전처리 (Int8EntropyCalibrator2 의 process_type, 결과는 기존 구현과 같은 byte)
+// 모두 OpenCV 로 읽고 출력 버퍼에 바로 resize (중간 cv::Mat, 복사 없음)
+
+// process_type 0 : 입력 크기로 그대로 resize (vgg11, resnet18, detr)
+class ResizePreprocess : public CalibPreprocess
+{
+public:
+	using CalibPreprocess::CalibPreprocess;
+	const char* name() const override { return "resize"; }
+	bool load(const std::string& path, uint8_t* dst) const override;
+};
+
+// process_type 1 : 긴 변을 입력 크기에 맞추고 가운데 배치, 나머지는 128 (unet)
+class CenterLetterboxPreprocess : public CalibPreprocess
+{
+public:
+	using CalibPreprocess::CalibPreprocess;
+	const char* name() const override { return "letterbox"; }
+	bool load(const std::string& path, uint8_t* dst) const override;
+};
+
+// process_type 2 : yolov5 letterbox (비율 반올림, 114 padding)
+class YoloLetterboxPreprocess : public CalibPreprocess
+{
+public:
+	using CalibPreprocess::CalibPreprocess;
+	const char* name() const override { return "yolo letterbox"; }
+	bool load(const std::string& path, uint8_t* dst) const override;
+};
+
+// process_type 에 맞는 전처리 (알 수 없는 값이면 nullptr)
+std::unique_ptr<CalibPreprocess> makeCalibPreprocess(int processType, int width, int height);
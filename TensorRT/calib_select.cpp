@@ -0,0 +1,246 @@
+﻿// calibration 이미지 중 대표 subset 선택 (calibration 시간 단축), 선택한 목록을 calibrator 가 읽는 목록 파일로 저장
+// usage : calib_select <yolov5s|resnet18|vgg11|unet|detr> [options]
+//   -d <dir|list>    calibration 이미지 폴더 (기본 ../Data_calib/) 또는 목록 파일 (.txt)
+//   -raw             폴더의 파일을 입력 크기 uint8 HWC BGR raw 로 읽음 (OpenCV 디코딩 없이)
+//   -k <images>      subset 크기 (기본 전체의 1/4, 최소 batch 1 개)
+//   -x <fraction>    subset 중 activation 범위 coverage 로 고르는 비율 (기본 0.25)
+//   -e <dims>        penultimate 텐서 embedding 차원 수 (기본 64, 0 이면 color histogram 만)
+//   -c <bins>        채널별 color histogram bin 수 (기본 8)
+//   -o <file>        목록 파일 경로 (기본 ../Int8_calib_table/<model>_calib_subset.txt)
+//   -a <entropy|percentile|max>  비교에 쓰는 calibration 방식 (기본 entropy)
+//   -v <images>      INT8 / fp32 출력 비교 이미지 수 (먼저 seed 로 뽑아서 모든 후보 set 에서 제외, 기본 8)
+//   -w <workers>     동시에 실행하는 interpreter 수 (기본 hardware thread 수 / -t)
+//   -t <threads>     interpreter 당 OpenMP thread 수 (기본 1)
+//   -s <seed>        비교 이미지, k-means, random subset seed (기본 0)
+//   -r               .wts 에 없는 가중치를 난수로 생성 (가중치 파일 없이 실행)
+// 비교 이미지를 뺀 전체, 선택한 subset, 같은 크기의 random subset, 폴더 순서 앞 k 장 (기존 calibrator 를 일찍 끊은 경우) 을
+// activation 범위 coverage, CPU calibration 시간 (ir_calibrate 와 같은 CpuCalibrator), INT8 출력 정확도로 비교
+// 목록 파일은 Int8EntropyCalibrator2 (img_dir 에 .txt 경로), ir_calibrate -d 에 그대로 사용
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "calib_loader.hpp"
+#include "calib_preprocess.hpp"
+#include "calib_subset.hpp"
+#include "calib_table.hpp"
+#include "common.hpp"
+#include "cpu_calibrator.hpp"
+#include "cpu_interpreter.hpp"
+#include "graph_passes.hpp"
+#include "ir_models.hpp"
+
+typedef std::chrono::high_resolution_clock Clock;
+
+struct SetResult {
+	double coverage_mean;
+	double coverage_min;
+	double calib_ms;		// histogram 수집 + scale 계산
+	double min_cosine;
+	double mean_cosine;
+	double max_abs;
+};
+
+int main(int argc, char** argv)
+{
+	if (argc < 2) {
+		std::cerr << "usage : calib_select <yolov5s|resnet18|vgg11|unet|detr> [-d dir] [-raw] [-k images] [-x fraction] [-e dims] [-c bins] [-o list] [-a entropy|percentile|max] [-v images] [-w workers] [-t threads] [-s seed] [-r]" << std::endl;
+		return 1;
+	}
+	const ir::ModelConfig* config = ir::findModel(argv[1]);
+	if (!config) {
+		std::cerr << "[ERROR] unknown model : " << argv[1] << std::endl;
+		return 1;
+	}
+	std::string dir = "../Data_calib/", algorithm = "entropy";
+	std::string list = std::string("../Int8_calib_table/") + config->name + "_calib_subset.txt";
+	CalibSubsetOptions options;
+	int k = 0, eval_images = 8, workers = 0, threads = 1;
+	bool raw = false, random_missing = false;
+	for (int i = 2; i < argc; i++) {
+		if (!strcmp(argv[i], "-d") && i + 1 < argc) dir = argv[++i];
+		else if (!strcmp(argv[i], "-raw")) raw = true;
+		else if (!strcmp(argv[i], "-k") && i + 1 < argc) k = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-x") && i + 1 < argc) options.extreme_fraction = atof(argv[++i]);
+		else if (!strcmp(argv[i], "-e") && i + 1 < argc) options.embed_dims = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-c") && i + 1 < argc) options.color_bins = std::max(1, atoi(argv[++i]));
+		else if (!strcmp(argv[i], "-o") && i + 1 < argc) list = argv[++i];
+		else if (!strcmp(argv[i], "-a") && i + 1 < argc) algorithm = argv[++i];
+		else if (!strcmp(argv[i], "-v") && i + 1 < argc) eval_images = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-w") && i + 1 < argc) workers = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-t") && i + 1 < argc) threads = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-s") && i + 1 < argc) options.seed = (unsigned)atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-r")) random_missing = true;
+	}
+	if (!isCalibList(dir) && dir.back() != '/' && dir.back() != '\\') dir += '/';
+	threads = std::max(1, threads);
+	if (workers <= 0) workers = std::max(1, (int)std::thread::hardware_concurrency() / threads);
+	CalibAlgorithm calib_algorithm = CalibAlgorithm::kENTROPY;
+	bool known = false;
+	for (CalibAlgorithm a : { CalibAlgorithm::kENTROPY, CalibAlgorithm::kPERCENTILE, CalibAlgorithm::kMAX }) {
+		if (algorithm == calibAlgorithmName(a)) {
+			calib_algorithm = a;
+			known = true;
+		}
+	}
+	if (!known) {
+		std::cerr << "[ERROR] unknown algorithm : " << algorithm << std::endl;
+		return 1;
+	}
+
+	// 1. 가중치 로드, network 기록 (graph pass 없이 TensorRT 와 같은 텐서 이름)
+	ir::WeightMap weightMap;
+	std::ifstream wts(config->weight_file);
+	if (wts.good()) {
+		wts.close();
+		weightMap = ir::loadWeights(config->weight_file);
+	}
+	else if (!random_missing) {
+		std::cerr << "[ERROR] weight file not found : " << config->weight_file << " (use -r for random weights)" << std::endl;
+		return 1;
+	}
+	ir::WeightSource weights(weightMap, random_missing);
+	ir::Network network;
+	if (!ir::buildModel(config->name, network, weights, 1)) return 1;
+
+	// 2. calibration 이미지
+	std::vector<std::string> names, files;
+	if (isCalibList(dir)) {
+		if (!readCalibList(dir, files)) return 1;
+	}
+	else {
+		if (read_files_in_dir(dir.c_str(), names) != 0) return 1;
+		std::sort(names.begin(), names.end());
+		for (const std::string& name : names) files.push_back(dir + name);
+	}
+	std::unique_ptr<CalibPreprocess> preprocess;
+	if (raw) preprocess.reset(new RawPreprocess(config->input_w, config->input_h));
+	else preprocess = makeCalibPreprocess(config->calib_process, config->input_w, config->input_h);
+	// 비교 이미지를 먼저 뽑아서 후보에서 제외 (어느 set 의 calibration 에도 쓰지 않음), 나머지는 폴더 순서 유지
+	std::mt19937 rng(options.seed);
+	std::vector<int> order(files.size());
+	for (int i = 0; i < (int)order.size(); i++) order[i] = i;
+	std::shuffle(order.begin(), order.end(), rng);
+	eval_images = std::max(0, std::min(eval_images, (int)files.size() - 2));
+	std::vector<int> held_out(order.begin(), order.begin() + eval_images), pool(order.begin() + eval_images, order.end());
+	std::sort(held_out.begin(), held_out.end());
+	std::sort(pool.begin(), pool.end());
+	std::vector<std::string> eval_files;
+	for (int i : held_out) eval_files.push_back(files[i]);
+	{
+		std::vector<std::string> candidates;
+		for (int i : pool) candidates.push_back(files[i]);
+		files.swap(candidates);
+	}
+	const int n = (int)files.size();
+	if (k <= 0) k = std::max(1, n / 4);
+	if (n < 2 || k >= n) {
+		std::cerr << "[ERROR] subset size " << k << " must be smaller than the number of candidate images " << n << " in " << dir << " (" << eval_images << " held out)" << std::endl;
+		return 1;
+	}
+	const ir::Tensor* embedding = embeddingTensor(network);
+	std::cout << "[" << config->name << "] " << n << " images (+ " << eval_images << " held out) -> " << k << ", " << preprocess->name() << " " << config->input_w << "x" << config->input_h
+		<< ", " << workers << " workers x " << threads << " threads, embedding " << (embedding && options.embed_dims > 0 ? embedding->getName() : "none") << std::endl;
+
+	// 3. 이미지별 descriptor, activation 범위 (fp32 한번) 와 subset 선택
+	std::vector<CalibImageProfile> profiles;
+	Clock::time_point t0 = Clock::now();
+	{
+		CalibBatchLoader loader(files, 1, *preprocess);
+		if (!profileCalibImages(network, loader, config->input_name, options, workers, threads, profiles)) return 1;
+	}
+	Clock::time_point t1 = Clock::now();
+	const std::vector<int> subset = selectCalibSubset(profiles, k, options);
+	Clock::time_point t2 = Clock::now();
+	std::cout << std::fixed << std::setprecision(1) << "  profile " << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms, select "
+		<< std::chrono::duration<double, std::milli>(t2 - t1).count() << " ms" << std::endl;
+	std::vector<std::string> subset_files;
+	for (int i : subset) subset_files.push_back(files[i]);
+	const std::string comment = std::string(config->name) + " calibration subset " + std::to_string(k) + " / " + std::to_string(n) + " (calib_select)";
+	if (!writeCalibList(list, subset_files, comment)) return 1;
+	std::cout << "  subset list : " << list << std::endl;
+
+	// 4. 비교 : 전체, 선택, random, 앞 k 장
+	std::vector<int> all(n), random_subset, first_k;
+	for (int i = 0; i < n; i++) all[i] = i;
+	random_subset = all;
+	std::shuffle(random_subset.begin(), random_subset.end(), rng);
+	random_subset.resize(k);
+	std::sort(random_subset.begin(), random_subset.end());
+	first_k.assign(all.begin(), all.begin() + k);
+
+	// 정확도 비교 이미지 : 처음에 뺀 held out (어느 후보 set 에도 없음)
+	std::vector<std::vector<uint8_t>> images;
+	std::vector<std::vector<float>> reference;
+	ir::Network fp32_network;
+	if (!ir::buildModel(config->name, fp32_network, weights, 1)) return 1;
+	ir::optimizeNetwork(fp32_network, nullptr);
+	{
+		CpuInterpreter fp32(fp32_network, 1, threads * workers);
+		const ir::Tensor* output = fp32_network.getOutput(0);
+		const size_t output_count = (size_t)ir::volume(output->getDimensions());
+		for (const std::string& file : eval_files) {
+			images.emplace_back(preprocess->imageBytes());
+			if (!preprocess->load(file, images.back().data())) return 1;
+			fp32.setInput(config->input_name, images.back().data());
+			fp32.run(1);
+			reference.emplace_back(fp32.getTensor(output), fp32.getTensor(output) + output_count);
+		}
+	}
+
+	auto measure = [&](const std::vector<int>& set, SetResult& r) {
+		rangeCoverage(profiles, set, r.coverage_mean, r.coverage_min);
+		std::vector<std::string> set_files;
+		for (int i : set) set_files.push_back(files[i]);
+		const Clock::time_point c0 = Clock::now();
+		CpuCalibrator calibrator(network, workers, threads);
+		CalibBatchLoader loader(set_files, 1, *preprocess);
+		if (!calibrator.collect(loader, config->input_name)) return false;
+		const std::vector<std::pair<std::string, float>> scales = calibrator.scales(calib_algorithm);
+		r.calib_ms = std::chrono::duration<double, std::milli>(Clock::now() - c0).count();
+		// graph pass 전 network 에 적용하고 INT8 CPU 실행
+		std::map<std::string, float> table(scales.begin(), scales.end());
+		ir::Network int8_network;
+		if (!ir::buildModel(config->name, int8_network, weights, 1)) return false;
+		applyCalibrationTable(int8_network, table);
+		ir::optimizeNetwork(int8_network, nullptr);
+		CpuInterpreter int8(int8_network, 1, threads * workers, CpuPrecision::kINT8);
+		const ir::Tensor* output = int8_network.getOutput(0);
+		r.min_cosine = 1.0;
+		r.mean_cosine = r.max_abs = 0.0;
+		for (size_t i = 0; i < images.size(); i++) {
+			int8.setInput(config->input_name, images[i].data());
+			int8.run(1);
+			const TensorDiff d = diffTensors(int8.getTensor(output), reference[i].data(), reference[i].size());
+			r.min_cosine = std::min(r.min_cosine, d.cosine);
+			r.mean_cosine += d.cosine / images.size();
+			r.max_abs = std::max(r.max_abs, d.max_abs);
+		}
+		return true;
+	};
+	std::cout << "  " << std::left << std::setw(16) << "set" << std::right << std::setw(8) << "images" << std::setw(11) << "coverage"
+		<< std::setw(11) << "min cov" << std::setw(12) << "calib ms" << std::setw(9) << "speedup" << std::setw(12) << "min cosine"
+		<< std::setw(13) << "mean cosine" << std::setw(12) << "max abs" << std::endl;
+	const std::pair<const char*, const std::vector<int>*> sets[] = { { "full", &all }, { "selected", &subset }, { "random", &random_subset }, { "first k", &first_k } };
+	double full_ms = 0.0;
+	for (const auto& s : sets) {
+		SetResult r;
+		if (!measure(*s.second, r)) return 1;
+		if (s.second == &all) full_ms = r.calib_ms;
+		std::cout << "  " << std::left << std::setw(16) << s.first << std::right << std::setw(8) << s.second->size() << std::setprecision(4)
+			<< std::setw(11) << r.coverage_mean << std::setw(11) << r.coverage_min << std::setprecision(1) << std::setw(12) << r.calib_ms
+			<< std::setprecision(2) << std::setw(9) << full_ms / std::max(r.calib_ms, 1e-9) << std::setprecision(5) << std::setw(12) << r.min_cosine
+			<< std::setw(13) << r.mean_cosine << std::setprecision(4) << std::setw(12) << r.max_abs << std::endl;
+	}
+	return 0;
+}
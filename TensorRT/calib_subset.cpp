@@ -0,0 +1,262 @@
+﻿#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <thread>
+#include "calib_subset.hpp"
+#include "cpu_calibrator.hpp"
+#include "cpu_interpreter.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace ir;
+
+static void normalize(float* v, int n)
+{
+	double sum = 0.0;
+	for (int i = 0; i < n; i++) sum += (double)v[i] * v[i];
+	if (sum <= 0.0) return;
+	const float inv = (float)(1.0 / std::sqrt(sum));
+	for (int i = 0; i < n; i++) v[i] *= inv;
+}
+
+static float distance2(const std::vector<float>& a, const float* b)
+{
+	float d = 0.f;
+	for (size_t i = 0; i < a.size(); i++) d += (a[i] - b[i]) * (a[i] - b[i]);
+	return d;
+}
+
+const Tensor* embeddingTensor(const Network& network)
+{
+	for (int i = network.getNbLayers() - 1; i >= 0; i--) {
+		const Layer* l = network.getLayer(i);
+		if (l->getType() != LayerType::kCONVOLUTION && l->getType() != LayerType::kFULLY_CONNECTED) continue;
+		if (l->getInput(0)->isBatched() && l->getInput(0)->getType() == DataType::kFLOAT) return l->getInput(0);
+	}
+	return nullptr;
+}
+
+// 채널별 공간 평균 -> embed_dims 개 채널 묶음 평균 ([C] 또는 [C, H, W] 외에는 연속 구간 평균)
+static void embed(const Tensor* t, const float* data, int dims, float* out)
+{
+	const Dims d = t->getDimensions();
+	const int64_t count = volume(d);
+	const int64_t channels = d.nbDims >= 3 ? d.d[0] : count;
+	const int64_t spatial = count / channels;
+	std::fill(out, out + dims, 0.f);
+	std::vector<int> members(dims, 0);
+	for (int64_t c = 0; c < channels; c++) {
+		double sum = 0.0;
+		for (int64_t s = 0; s < spatial; s++) sum += data[c * spatial + s];
+		const int k = (int)(c * dims / channels);
+		out[k] += (float)(sum / spatial);
+		members[k]++;
+	}
+	for (int k = 0; k < dims; k++) {
+		if (members[k] > 0) out[k] /= members[k];
+	}
+}
+
+bool profileCalibImages(const Network& network, CalibBatchLoader& loader, const std::string& inputName, const CalibSubsetOptions& options,
+	int workers, int threads, std::vector<CalibImageProfile>& profiles)
+{
+	const Tensor* embedding = embeddingTensor(network);
+	const int nb = network.getNbTensors();
+	const int color_dims = options.color_bins * 3;
+	const int embed_dims = embedding ? options.embed_dims : 0;
+	const size_t image_bytes = loader.batchBytes() / loader.batchSize();
+	profiles.assign(loader.batchCount() * loader.batchSize(), CalibImageProfile());
+	std::mutex mutex;	// loader.next 와 넘겨받은 버퍼 복사
+	int next_image = 0;
+	workers = std::max(1, workers);
+	std::vector<std::thread> pool;
+	for (int w = 0; w < workers; w++) {
+		pool.emplace_back([&]() {
+#ifdef _OPENMP
+			omp_set_num_threads(std::max(1, threads));
+#endif
+			CpuInterpreter interpreter(network, 1, threads, CpuPrecision::kFP32, true);
+			CalibImageProfile* current = nullptr;
+			const Tensor* in = network.findTensor(inputName);
+			interpreter.setLayerCallback([&](const Layer& l) {
+				for (int k = 0; k < l.getNbOutputs(); k++) {
+					const Tensor* t = l.getOutput(k);
+					if (t == embedding && embed_dims > 0) embed(t, interpreter.getTensor(t), embed_dims, current->descriptor.data() + color_dims);
+					if (!calibratedTensor(t)) continue;
+					const float* v = interpreter.getTensor(t);
+					const int64_t count = volume(t->getDimensions());
+					float m = 0.f;
+					for (int64_t i = 0; i < count; i++) {
+						const float a = std::fabs(v[i]);
+						if (a > m && std::isfinite(a)) m = a;
+					}
+					current->amax[t->id()] = m;
+				}
+			});
+			std::vector<uint8_t> input(image_bytes);
+			while (true) {
+				int index;
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					const uint8_t* data = loader.next();
+					if (!data) break;
+					memcpy(input.data(), data, image_bytes);
+					index = next_image++;
+				}
+				current = &profiles[index];
+				current->descriptor.assign(color_dims + embed_dims, 0.f);
+				current->amax.assign(nb, 0.f);
+				// color histogram (uint8 HWC BGR)
+				for (size_t i = 0; i < image_bytes; i++) current->descriptor[(i % 3) * options.color_bins + input[i] * options.color_bins / 256] += 1.f;
+				// 입력은 callback 에 오지 않으므로 byte 최대값
+				if (calibratedTensor(in)) current->amax[in->id()] = *std::max_element(input.begin(), input.end());
+				interpreter.setInput(inputName, input.data());
+				interpreter.run(1);
+				normalize(current->descriptor.data(), color_dims);
+				normalize(current->descriptor.data() + color_dims, embed_dims);
+			}
+		});
+	}
+	for (auto& t : pool) t.join();
+	return !loader.failed();
+}
+
+void rangeCoverage(const std::vector<CalibImageProfile>& profiles, const std::vector<int>& subset, double& mean, double& min)
+{
+	mean = 0.0;
+	min = 1.0;
+	if (profiles.empty()) return;
+	const size_t nb = profiles[0].amax.size();
+	int counted = 0;
+	for (size_t t = 0; t < nb; t++) {
+		float full = 0.f, part = 0.f;
+		for (const CalibImageProfile& p : profiles) full = std::max(full, p.amax[t]);
+		for (int i : subset) part = std::max(part, profiles[i].amax[t]);
+		if (full <= 0.f) continue;
+		mean += part / full;
+		min = std::min(min, (double)(part / full));
+		counted++;
+	}
+	if (counted > 0) mean /= counted;
+}
+
+std::vector<int> selectCalibSubset(const std::vector<CalibImageProfile>& profiles, int k, const CalibSubsetOptions& options)
+{
+	const int n = (int)profiles.size();
+	std::vector<int> subset;
+	if (k >= n) {
+		for (int i = 0; i < n; i++) subset.push_back(i);
+		return subset;
+	}
+	std::vector<char> selected(n, 0);
+	auto pick = [&](int i) {
+		selected[i] = 1;
+		subset.push_back(i);
+	};
+
+	// 1. activation 범위 coverage : 텐서별 subset 최대 / 전체 최대 합을 greedy 로 최대화
+	const int nb = (int)profiles[0].amax.size();
+	std::vector<float> full(nb, 0.f), covered(nb, 0.f);
+	for (const CalibImageProfile& p : profiles) {
+		for (int t = 0; t < nb; t++) full[t] = std::max(full[t], p.amax[t]);
+	}
+	const int extremes = std::min(k, (int)std::lround(k * options.extreme_fraction));
+	std::vector<double> gain(n);
+	for (int e = 0; e < extremes; e++) {
+#pragma omp parallel for
+		for (int i = 0; i < n; i++) {
+			gain[i] = 0.0;
+			if (selected[i]) continue;
+			for (int t = 0; t < nb; t++) {
+				if (full[t] > 0.f && profiles[i].amax[t] > covered[t]) gain[i] += (profiles[i].amax[t] - covered[t]) / full[t];
+			}
+		}
+		const int best = (int)(std::max_element(gain.begin(), gain.end()) - gain.begin());
+		if (gain[best] <= 0.0) break;	// 이미 모든 텐서의 최대를 포함
+		pick(best);
+		for (int t = 0; t < nb; t++) covered[t] = std::max(covered[t], profiles[best].amax[t]);
+	}
+
+	// 2. descriptor k-means++ (cluster 수 = 남은 자리)
+	const int clusters = k - (int)subset.size();
+	const int dims = (int)profiles[0].descriptor.size();
+	std::mt19937 rng(options.seed);
+	std::vector<float> centers;
+	std::vector<float> nearest(n, HUGE_VALF);
+	if (clusters > 0) centers = profiles[rng() % n].descriptor;
+	for (int c = 1; c < clusters; c++) {
+		double total = 0.0;
+		for (int i = 0; i < n; i++) {
+			nearest[i] = std::min(nearest[i], distance2(profiles[i].descriptor, centers.data() + (c - 1) * dims));
+			total += nearest[i];
+		}
+		double r = std::uniform_real_distribution<double>(0.0, total)(rng);
+		int chosen = n - 1;
+		for (int i = 0; i < n; i++) {
+			r -= nearest[i];
+			if (r <= 0.0) {
+				chosen = i;
+				break;
+			}
+		}
+		centers.insert(centers.end(), profiles[chosen].descriptor.begin(), profiles[chosen].descriptor.end());
+	}
+	std::vector<int> assign(n, 0);
+	for (int it = 0; it < options.iterations && clusters > 0; it++) {
+#pragma omp parallel for
+		for (int i = 0; i < n; i++) {
+			float best = HUGE_VALF;
+			for (int c = 0; c < clusters; c++) {
+				const float d = distance2(profiles[i].descriptor, centers.data() + c * dims);
+				if (d < best) {
+					best = d;
+					assign[i] = c;
+				}
+			}
+		}
+		std::vector<float> sum((size_t)clusters * dims, 0.f);
+		std::vector<int> members(clusters, 0);
+		for (int i = 0; i < n; i++) {
+			for (int j = 0; j < dims; j++) sum[assign[i] * dims + j] += profiles[i].descriptor[j];
+			members[assign[i]]++;
+		}
+		for (int c = 0; c < clusters; c++) {
+			if (members[c] == 0) continue;	// 빈 cluster 는 중심 유지
+			for (int j = 0; j < dims; j++) centers[c * dims + j] = sum[c * dims + j] / members[c];
+		}
+	}
+	// cluster 마다 중심에 가장 가까운 (아직 고르지 않은) 이미지
+	for (int c = 0; c < clusters; c++) {
+		int best = -1;
+		float best_d = HUGE_VALF;
+		for (int i = 0; i < n; i++) {
+			if (selected[i] || assign[i] != c) continue;
+			const float d = distance2(profiles[i].descriptor, centers.data() + c * dims);
+			if (d < best_d) {
+				best_d = d;
+				best = i;
+			}
+		}
+		if (best >= 0) pick(best);
+	}
+	// 빈 cluster 자리 : 고른 이미지와 가장 먼 이미지 (farthest point)
+	while ((int)subset.size() < k) {
+		int best = -1;
+		float best_d = -1.f;
+		for (int i = 0; i < n; i++) {
+			if (selected[i]) continue;
+			float d = HUGE_VALF;
+			for (int s : subset) d = std::min(d, distance2(profiles[i].descriptor, profiles[s].descriptor.data()));
+			if (d > best_d) {
+				best_d = d;
+				best = i;
+			}
+		}
+		pick(best);
+	}
+	std::sort(subset.begin(), subset.end());
+	return subset;
+}
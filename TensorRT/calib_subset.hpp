@@ -0,0 +1,36 @@
+﻿#pragma once
+#include <string>
+#include <vector>
+#include "calib_loader.hpp"
+#include "graph_ir.hpp"
+
+// 이미지 descriptor, subset 선택 설정
+struct CalibSubsetOptions {
+	int color_bins = 8;				// 채널별 color histogram bin 수
+	int embed_dims = 64;			// embedding 을 줄인 차원 수 (채널 묶음 평균)
+	double extreme_fraction = 0.25;	// subset 중 activation 범위 coverage 로 고르는 비율 (나머지는 cluster 대표)
+	int iterations = 20;			// k-means 반복 수
+	unsigned seed = 0;
+};
+
+// 이미지 하나의 fp32 실행 결과
+struct CalibImageProfile {
+	std::vector<float> descriptor;	// color histogram, embedding (각각 L2 정규화 후 연결)
+	std::vector<float> amax;		// tensor id 별 최대 절대값 (calibratedTensor 가 아니면 0)
+};
+
+// embedding 으로 쓸 penultimate 텐서 : 마지막 conv / fully connected 레이어의 입력 (분류기의 pooling 결과, detector head 의 입력)
+const ir::Tensor* embeddingTensor(const ir::Network& network);
+
+// loader (batch 1) 의 이미지를 workers 개 interpreter 로 나눠 fp32 실행해서 이미지별 descriptor, 텐서별 amax 계산
+// profiles 는 loader 의 이미지 순서, 입력 읽기 실패면 false
+bool profileCalibImages(const ir::Network& network, CalibBatchLoader& loader, const std::string& inputName, const CalibSubsetOptions& options,
+	int workers, int threads, std::vector<CalibImageProfile>& profiles);
+
+// k 장 선택 (이미지 index 오름차순)
+//  1. extreme_fraction * k 장 : 텐서별 (subset 최대 / 전체 최대) 합이 가장 커지는 이미지를 하나씩 추가 (activation 범위 coverage)
+//  2. 나머지 : descriptor 를 k-means++ 로 묶고 cluster 마다 중심에 가장 가까운 이미지 (분포 대표)
+std::vector<int> selectCalibSubset(const std::vector<CalibImageProfile>& profiles, int k, const CalibSubsetOptions& options);
+
+// subset 의 텐서별 최대 / 전체 최대 (전체 최대가 0 인 텐서 제외) 의 평균, 최소
+void rangeCoverage(const std::vector<CalibImageProfile>& profiles, const std::vector<int>& subset, double& mean, double& min);
@@ -0,0 +1,101 @@
+﻿#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include "calib_table.hpp"
+
+// "(Unnamed Layer* 12) [Convolution]_output" -> "12:0", "_output_1" -> "12:1" (다른 이름은 빈 문자열)
+static std::string unnamedKey(const std::string& name)
+{
+	static const char kPREFIX[] = "(Unnamed Layer* ";
+	if (name.compare(0, sizeof(kPREFIX) - 1, kPREFIX) != 0) return std::string();
+	const size_t end = name.find(')');
+	const size_t output = name.rfind("]_output");
+	if (end == std::string::npos || output == std::string::npos) return std::string();
+	const std::string layer = name.substr(sizeof(kPREFIX) - 1, end - (sizeof(kPREFIX) - 1));
+	const std::string suffix = name.substr(output + 8);
+	return layer + ":" + (suffix.size() > 1 && suffix[0] == '_' ? suffix.substr(1) : "0");
+}
+
+bool readCalibrationTable(const std::string& path, std::map<std::string, float>& scales)
+{
+	std::ifstream file(path);
+	if (!file.is_open()) {
+		std::cerr << "[ERROR] calibration table open error : " << path << std::endl;
+		return false;
+	}
+	std::string line;
+	std::getline(file, line);
+	if (line.compare(0, 4, "TRT-") != 0) {
+		std::cerr << "[ERROR] not a TensorRT calibration table : " << path << std::endl;
+		return false;
+	}
+	while (std::getline(file, line)) {
+		if (!line.empty() && line.back() == '\r') line.pop_back();
+		const size_t colon = line.rfind(':');
+		if (colon == std::string::npos) continue;
+		const uint32_t bits = (uint32_t)strtoul(line.c_str() + colon + 1, nullptr, 16);
+		float scale;
+		memcpy(&scale, &bits, sizeof(scale));
+		scales[line.substr(0, colon)] = scale;
+	}
+	return true;
+}
+
+int applyCalibrationTable(ir::Network& network, const std::map<std::string, float>& scales)
+{
+	std::map<std::string, float> unnamed;
+	for (const auto& s : scales) {
+		const std::string key = unnamedKey(s.first);
+		if (!key.empty()) unnamed[key] = s.second;
+	}
+	int count = 0;
+	for (int i = 0; i < network.getNbTensors(); i++) {
+		ir::Tensor* t = network.getTensor(i);
+		auto it = scales.find(t->getName());
+		if (it == scales.end()) {
+			const std::string key = unnamedKey(t->getName());
+			if (key.empty() || (it = unnamed.find(key)) == unnamed.end()) continue;
+		}
+		const float amax = it->second * 127.f;
+		t->setDynamicRange(-amax, amax);
+		count++;
+	}
+	return count;
+}
+
+bool writeCalibrationTable(const std::string& path, const std::string& header, const std::vector<std::pair<std::string, float>>& scales)
+{
+	std::ofstream file(path);
+	if (!file.is_open()) {
+		std::cerr << "[ERROR] calibration table write error : " << path << std::endl;
+		return false;
+	}
+	file << header << "\n";
+	for (const auto& s : scales) {
+		uint32_t bits;
+		memcpy(&bits, &s.second, sizeof(bits));
+		char hex[16];
+		snprintf(hex, sizeof(hex), "%08x", bits);
+		file << s.first << ": " << hex << "\n";
+	}
+	return file.good();
+}
+
+std::string trtTensorName(const std::string& name)
+{
+	static const char* kTYPES[][2] = {
+		{ "[FullyConnected]", "[Fully Connected]" },
+		{ "[MatrixMultiply]", "[Matrix Multiply]" },
+		{ "[Preprocess]", "[PluginV2IOExt]" },
+		{ "[Yololayer]", "[PluginV2IOExt]" },
+	};
+	if (unnamedKey(name).empty()) return name;
+	for (const auto& t : kTYPES) {
+		const size_t pos = name.find(t[0]);
+		if (pos != std::string::npos) return name.substr(0, pos) + t[1] + name.substr(pos + strlen(t[0]));
+	}
+	return name;
+}
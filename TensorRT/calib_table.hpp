@@ -0,0 +1,26 @@
+﻿#pragma once
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "graph_ir.hpp"
+
+// TensorRT calibration table (Int8EntropyCalibrator2::writeCalibrationCache 로 저장한 파일)
+// 첫 줄 "TRT-<version>-<algorithm>", 이후 줄마다 "<tensor 이름>: <float scale 의 bit 를 16진수로>" (scale = amax / 127)
+// scales : tensor 이름 -> scale
+bool readCalibrationTable(const std::string& path, std::map<std::string, float>& scales);
+
+// table 의 scale 로 network 텐서에 dynamic range [-127 * scale, 127 * scale] 설정, 설정한 텐서 수 반환
+// 이름이 같은 텐서 우선, 이름 없는 텐서는 "(Unnamed Layer* N) [...]_output" 의 레이어 번호, 출력 번호로 찾음
+// (plugin 레이어는 TensorRT 와 IR 의 레이어 종류 이름이 다름)
+int applyCalibrationTable(ir::Network& network, const std::map<std::string, float>& scales);
+
+// 예제 calibrator (Int8EntropyCalibrator2) 의 table 알고리즘 이름, TensorRT 는 header 의 알고리즘이 calibrator 와 다르면 table 을 무시
+static const char kCALIB_TABLE_ALGORITHM[] = "EntropyCalibration2";
+
+// (이름, scale) 을 순서대로 TensorRT calibration table 로 저장 (Int8EntropyCalibrator2::readCalibrationCache 가 읽는 형식)
+// header : 첫 줄 (예 "TRT-8003-EntropyCalibration2", TensorRT 는 버전, 알고리즘이 다른 table 을 무시하고 다시 calibration)
+bool writeCalibrationTable(const std::string& path, const std::string& header, const std::vector<std::pair<std::string, float>>& scales);
+
+// IR 텐서 이름 -> TensorRT 텐서 이름 (이름 없는 레이어 중 종류 이름이 다른 fully connected, matrix multiply, plugin 만 바뀜)
+std::string trtTensorName(const std::string& name);
@@ -3,6 +3,7 @@
 #include <fstream>
 #include <opencv2/dnn/dnn.hpp>
 #include "calibrator.h"
+#include "calib_preprocess.hpp"
 #include "cuda_runtime_api.h"
 #include "common.hpp"		
 #include <opencv2/opencv.hpp>
@@ -20,26 +21,36 @@
     } while (0)
 
 Int8EntropyCalibrator2::Int8EntropyCalibrator2(int batchsize, int input_w, int input_h, int process_type, const char* img_dir, const char* calib_table_name, const char* input_blob_name, bool read_cache)
+	: Int8EntropyCalibrator2(batchsize, makeCalibPreprocess(process_type, input_w, input_h), img_dir, calib_table_name, input_blob_name, read_cache)
+{
+}
+
+Int8EntropyCalibrator2::Int8EntropyCalibrator2(int batchsize, std::unique_ptr<CalibPreprocess> preprocess, const char* img_dir, const char* calib_table_name, const char* input_blob_name, bool read_cache, int loader_threads)
 	: batchsize_(batchsize)
-	, input_w_(input_w)
-	, input_h_(input_h)
-	, img_idx_(0)
-	, process_type_(process_type)
-	, img_dir_(img_dir)
+	, preprocess_(std::move(preprocess))
 	, calib_table_name_(calib_table_name)
 	, input_blob_name_(input_blob_name)
 	, read_cache_(read_cache)
+	, loader_threads_(loader_threads)
+	, device_input_(nullptr)
 {
-	input_count_ = 3 * input_w * input_h * batchsize;
-	input_size_ = 3 * input_w * input_h;
-	CHECK(cudaMalloc(&device_input_, input_count_ * sizeof(uint8_t)));
-	read_files_in_dir(img_dir, img_files_);
-
+	// calib_select    ̸  ̹ 
+	if (isCalibList(img_dir)) readCalibList(img_dir, img_files_);
+	else {
+		std::vector<std::string> names;
+		read_files_in_dir(img_dir, names);
+		for (const std::string& name : names) img_files_.push_back(std::string(img_dir) + name);
+	}
+	CHECK(cudaStreamCreate(&stream_));
+	if (preprocess_) CHECK(cudaMalloc(&device_input_, batchsize_ * preprocess_->imageBytes()));
 }
 
 Int8EntropyCalibrator2::~Int8EntropyCalibrator2()
 {
-	CHECK(cudaFree(device_input_));
+	for (void* p : pinned_) cudaHostUnregister(p);
+	loader_.reset();
+	if (device_input_) CHECK(cudaFree(device_input_));
+	CHECK(cudaStreamDestroy(stream_));
 }
 
 int Int8EntropyCalibrator2::getBatchSize() const noexcept
@@ -47,113 +58,34 @@ int Int8EntropyCalibrator2::getBatchSize() const noexcept
 	return batchsize_;
 } 
 
-bool Int8EntropyCalibrator2::getBatch(void* bindings[], const char* names[], int nbBindings) noexcept
+// о  cache     (cache   ̹  )
+void Int8EntropyCalibrator2::startLoader()
 {
-	if (img_idx_ + batchsize_ > (int)img_files_.size()) {
-		return false;
-	}
-
-	if (process_type_ == 0) { // vgg, resnet, detr (with preprocess layer) 
-		std::vector<uint8_t> input_imgs_(input_count_, 0);
-		cv::Mat img(input_h_, input_w_, CV_8UC3);
-		for (int i = img_idx_; i < img_idx_ + batchsize_; i++) {
-			std::cout << img_files_[i] << "  " << i << std::endl;
-			cv::Mat temp = cv::imread(img_dir_ + img_files_[i]);
-			if (temp.empty()) {
-				std::cerr << "Fatal error: image cannot open!" << std::endl;
-				return false;
-			}
-			cv::resize(temp, img, img.size(), cv::INTER_LINEAR);
-			memcpy(input_imgs_.data() + (i - img_idx_) * input_size_, img.data, input_size_);
-		}
-		img_idx_ += batchsize_;
-		CHECK(cudaMemcpy(device_input_, input_imgs_.data(), input_count_ * sizeof(uint8_t), cudaMemcpyHostToDevice));
-	}else if (process_type_ == 1) {  // unet (with preprocess layer) 
-		std::vector<uint8_t> input_imgs_(input_count_, 0);
-		cv::Mat img(input_h_, input_w_, CV_8UC3);
-		for (int i = img_idx_; i < img_idx_ + batchsize_; i++) {
-			std::cout << img_files_[i] << "  " << i << std::endl;
-			cv::Mat ori_img = cv::imread(img_dir_ + img_files_[i]);
-			if (ori_img.empty()) {
-				std::cerr << "Fatal error: image cannot open!" << std::endl;
-				return false;
-			}
-			int ori_w = ori_img.cols;
-			int ori_h = ori_img.rows;
-			if (ori_h == ori_w) { // Է̹ 簢 
-				cv::Mat img_r(input_h_, input_w_, CV_8UC3);
-				cv::resize(ori_img, img_r, img_r.size(), cv::INTER_LINEAR); //   
-				memcpy(input_imgs_.data() + (i - img_idx_) * input_size_, img_r.data, input_size_);
-			}
-			else {
-				int new_h, new_w;
-				if (ori_w >= ori_h) {
-					new_h = (int)(ori_h * ((float)input_w_ / ori_w));
-					new_w = input_w_;
-				}
-				else {
-					new_h = input_h_;
-					new_w = (int)(ori_w * ((float)input_h_ / ori_h));
-				}
-				cv::Mat img_r(new_h, new_w, CV_8UC3);
-				cv::resize(ori_img, img_r, img_r.size(), cv::INTER_LINEAR);
-				int tb = (int)((input_h_ - new_h) / 2);
-				int bb = ((new_h % 2) == 1) ? tb + 1 : tb;
-				int lb = (int)((input_w_ - new_w) / 2);
-				int rb = ((new_w % 2) == 1) ? lb + 1 : lb;
-				cv::Mat img_p(input_h_, input_w_, CV_8UC3);
-				cv::copyMakeBorder(img_r, img_p, tb, bb, lb, rb, cv::BORDER_CONSTANT, cv::Scalar(128, 128, 128));
-				memcpy(input_imgs_.data() + (i - img_idx_) * input_size_, img_p.data, input_size_);
-			}
-		}
-		img_idx_ += batchsize_;
-		CHECK(cudaMemcpy(device_input_, input_imgs_.data(), input_count_ * sizeof(uint8_t), cudaMemcpyHostToDevice));
+	if (loader_ || !preprocess_) return;
+	loader_.reset(new CalibBatchLoader(img_files_, batchsize_, *preprocess_, loader_threads_));
+	// ring buffer  pinned memory   (host -> device  staging   DMA)
+	for (int i = 0; i < loader_->slotCount(); i++) {
+		if (cudaHostRegister(loader_->slotData(i), loader_->batchBytes(), cudaHostRegisterDefault) == cudaSuccess) pinned_.push_back(loader_->slotData(i));
 	}
-	else if (process_type_ == 2) {
-		std::vector<uint8_t> input_imgs_(input_count_, 0);
-		cv::Mat img(input_h_, input_w_, CV_8UC3);
-		for (int i = img_idx_; i < img_idx_ + batchsize_; i++) {
-			std::cout << img_files_[i] << "  " << i << std::endl;
-			cv::Mat ori_img = cv::imread(img_dir_ + img_files_[i]);
-			if (ori_img.empty()) {
-				std::cerr << "Fatal error: image cannot open!" << std::endl;
-				return false;
-			}
-			int ori_w = ori_img.cols;
-			int ori_h = ori_img.rows;
-
-			if (ori_h == ori_w) { // Է̹ 簢 
-				cv::Mat img_r(input_h_, input_w_, CV_8UC3);
-				cv::resize(ori_img, img_r, img_r.size(), cv::INTER_LINEAR); //   
-				memcpy(input_imgs_.data() + (i - img_idx_) * input_size_, img_r.data, input_size_);
-			}
-			else {
-				float ratio = std::min(((float)input_h_ / ori_w), ((float)input_w_ / ori_h));
-				int	new_h = (int)(round(ori_h * ratio));
-				int	new_w = (int)(round(ori_w * ratio));
-				cv::Mat img_r(new_h, new_w, CV_8UC3);
-				cv::resize(ori_img, img_r, img_r.size(), cv::INTER_LINEAR); // ռ ġ
-				//int dh = (INPUT_H - new_h) % 32;
-				//int dw = (INPUT_W - new_w) % 32;
-				int dh = (input_h_ - new_h);
-				int dw = (input_w_ - new_w);
-				int tb = (int)round(((float)dh / 2) - 0.1);
-				int bb = (int)round(((float)dh / 2) + 0.1);
-				int lb = (int)round(((float)dw / 2) - 0.1);
-				int rb = (int)round(((float)dw / 2) + 0.1);
-				cv::Mat img_p((new_h + dh), (new_w + dw), CV_8UC3);
-				cv::copyMakeBorder(img_r, img_p, tb, bb, lb, rb, cv::BORDER_CONSTANT, cv::Scalar(114, 114, 114));
-				memcpy(input_imgs_.data() + (i - img_idx_) * input_size_, img_p.data, input_size_);
-			}
-		}
-		img_idx_ += batchsize_;
-		CHECK(cudaMemcpy(device_input_, input_imgs_.data(), input_count_ * sizeof(uint8_t), cudaMemcpyHostToDevice));
+	std::cout << "calibration : " << img_files_.size() << " images, " << loader_->batchCount() << " batches, " << preprocess_->name() << std::endl;
+}
 
-	}
-	else { // 
+bool Int8EntropyCalibrator2::getBatch(void* bindings[], const char* names[], int nbBindings) noexcept
+{
+	if (!preprocess_) {
 		std::cerr << "Fatal error: pre-preprocess type is wrong!" << std::endl;
 		return false;
 	}
+	startLoader();
+	const uint8_t* batch = loader_->next();
+	if (!batch) {
+		const CalibLoaderStats s = loader_->stats();
+		std::cout << "calibration : " << s.batches << " batches, " << s.images << " images, wall " << s.wall_ms << " ms, decode " << s.decode_ms
+			<< " ms (all threads), getBatch wait " << s.wait_ms << " ms" << std::endl;
+		return false;
+	}
+	CHECK(cudaMemcpyAsync(device_input_, batch, loader_->batchBytes(), cudaMemcpyHostToDevice, stream_));
+	CHECK(cudaStreamSynchronize(stream_));
 
 	assert(!strcmp(names[0], input_blob_name_));
 	bindings[0] = device_input_;
@@ -171,6 +103,7 @@ const void* Int8EntropyCalibrator2::readCalibrationCache(size_t& length) noexcep
 		std::copy(std::istream_iterator<char>(input), std::istream_iterator<char>(), std::back_inserter(calib_cache_));
 	}
 	length = calib_cache_.size();
+	if (!length) startLoader();
 	return length ? calib_cache_.data() : nullptr;
 }
 
@@ -1,17 +1,24 @@
 #pragma once
 #include "NvInfer.h"
+#include "cuda_runtime_api.h"
+#include <memory>
 #include <string>
 #include <vector>
+#include "calib_loader.hpp"
 
 //! \class Int8EntropyCalibrator2
 //!
 //! \brief Implements Entropy calibrator 2.
 //!  CalibrationAlgoType is kENTROPY_CALIBRATION_2.
+//!  Calibration images are prefetched by CalibBatchLoader worker threads into reusable pinned batch buffers.
 //!
 class Int8EntropyCalibrator2 : public nvinfer1::IInt8EntropyCalibrator2
 {
 public:
+	// process_type : calib_preprocess.hpp (0 resize, 1 center letterbox, 2 yolo letterbox)
 	Int8EntropyCalibrator2(int batchsize, int input_w, int input_h, int process_type, const char* img_dir, const char* calib_table_name, const char* input_blob_name, bool read_cache = true);
+	// loader_threads : 0 decodes synchronously in getBatch, < 0 uses all hardware threads
+	Int8EntropyCalibrator2(int batchsize, std::unique_ptr<CalibPreprocess> preprocess, const char* img_dir, const char* calib_table_name, const char* input_blob_name, bool read_cache = true, int loader_threads = -1);
 
 	virtual ~Int8EntropyCalibrator2();
 	int getBatchSize() const noexcept override;
@@ -20,18 +27,18 @@ public:
 	void writeCalibrationCache(const void* cache, size_t length) noexcept override;
 
 private:
+	void startLoader();
+
 	int batchsize_;
-	int input_w_;
-	int input_h_;
-	int img_idx_;
-	int process_type_;
-	std::string img_dir_;
+	std::unique_ptr<CalibPreprocess> preprocess_;
 	std::vector<std::string> img_files_;
-	size_t input_count_;
-	size_t input_size_;
 	std::string calib_table_name_;
 	const char* input_blob_name_;
 	bool read_cache_;
+	int loader_threads_;
+	std::unique_ptr<CalibBatchLoader> loader_;
+	std::vector<void*> pinned_;
+	cudaStream_t stream_;
 	void* device_input_;
 	std::vector<char> calib_cache_;
 };
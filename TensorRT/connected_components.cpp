@@ -0,0 +1,167 @@
+﻿#include <algorithm>
+#include "connected_components.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+ConnectedComponents::ConnectedComponents(const ConnectedComponentsParam& param)
+	: param_(param)
+{
+}
+
+// [y0, y1) 행의 run 추출 (배경 제외, 같은 클래스가 연속된 구간)
+void ConnectedComponents::extractRuns(const uint8_t* label, int width, int y0, int y1, std::vector<Run>& runs, std::vector<int>& row_start)
+{
+	runs.clear();
+	row_start.resize(y1 - y0 + 1);
+	for (int y = y0; y < y1; y++) {
+		row_start[y - y0] = (int)runs.size();
+		const uint8_t* row = label + (size_t)y * width;
+		int x = 0;
+		while (x < width) {
+			int v = row[x];
+			int x0 = x++;
+			while (x < width && row[x] == v) x++;
+			if (v != param_.background) {
+				runs.push_back(Run{ x0, x, y, v });
+			}
+		}
+	}
+	row_start[y1 - y0] = (int)runs.size();
+}
+
+int ConnectedComponents::find(int i)
+{
+	while (parent_[i] != i) {
+		parent_[i] = parent_[parent_[i]]; // path halving
+		i = parent_[i];
+	}
+	return i;
+}
+
+// 작은 인덱스(raster 순서상 앞)를 root 로 유지
+void ConnectedComponents::unite(int a, int b)
+{
+	a = find(a);
+	b = find(b);
+	if (a < b) parent_[b] = a;
+	else if (b < a) parent_[a] = b;
+}
+
+// 인접한 두 행의 run 연결 (8-connectivity 는 대각선 접촉 포함)
+void ConnectedComponents::unionRows(int prev_begin, int prev_end, int cur_begin, int cur_end)
+{
+	const int d = param_.connectivity == 8 ? 1 : 0;
+	int i = prev_begin;
+	for (int j = cur_begin; j < cur_end; j++) {
+		const Run& c = runs_[j];
+		while (i < prev_end && runs_[i].x1 + d <= c.x0) i++;
+		for (int k = i; k < prev_end && runs_[k].x0 < c.x1 + d; k++) {
+			if (runs_[k].class_id == c.class_id) unite(k, j);
+		}
+	}
+}
+
+void ConnectedComponents::run(const uint8_t* label, int width, int height, ComponentResult& result)
+{
+	int strips = 1;
+#ifdef _OPENMP
+	strips = omp_get_max_threads();
+#endif
+	strips = std::max(1, std::min(strips, height));
+	strip_runs_.resize(strips);
+	strip_rows_.resize(strips);
+	strip_offset_.resize(strips + 1);
+
+	// 1. strip 별 run 추출
+#pragma omp parallel for schedule(static, 1)
+	for (int s = 0; s < strips; s++) {
+		extractRuns(label, width, height * s / strips, height * (s + 1) / strips, strip_runs_[s], strip_rows_[s]);
+	}
+	strip_offset_[0] = 0;
+	for (int s = 0; s < strips; s++) {
+		strip_offset_[s + 1] = strip_offset_[s] + (int)strip_runs_[s].size();
+	}
+	const int total = strip_offset_[strips];
+	runs_.resize(total);
+	parent_.resize(total);
+	component_.resize(total);
+
+	// 2. strip 내부 union-find (각 strip 은 자신의 인덱스 구간만 수정)
+#pragma omp parallel for schedule(static, 1)
+	for (int s = 0; s < strips; s++) {
+		const int off = strip_offset_[s];
+		const std::vector<int>& rows = strip_rows_[s];
+		std::copy(strip_runs_[s].begin(), strip_runs_[s].end(), runs_.begin() + off);
+		for (int i = off; i < strip_offset_[s + 1]; i++) {
+			parent_[i] = i;
+		}
+		for (size_t r = 1; r + 1 < rows.size(); r++) {
+			unionRows(off + rows[r - 1], off + rows[r], off + rows[r], off + rows[r + 1]);
+		}
+	}
+
+	// 3. strip 경계 병합 (이전 strip 의 마지막 행 - 현재 strip 의 첫 행)
+	for (int s = 1; s < strips; s++) {
+		const std::vector<int>& prev = strip_rows_[s - 1];
+		const std::vector<int>& cur = strip_rows_[s];
+		const int prev_rows = (int)prev.size() - 1;
+		unionRows(strip_offset_[s - 1] + prev[prev_rows - 1], strip_offset_[s - 1] + prev[prev_rows],
+			strip_offset_[s] + cur[0], strip_offset_[s] + cur[1]);
+	}
+
+	// 4. 요소 번호 부여 및 통계 (root 는 항상 앞쪽 run 이므로 한번의 순회로 처리)
+	result.width = width;
+	result.height = height;
+	result.components.clear();
+	std::vector<double> sum_x, sum_y;
+	for (int i = 0; i < total; i++) {
+		const Run& r = runs_[i];
+		int root = find(i);
+		if (root == i) {
+			component_[i] = (int)result.components.size() + 1;
+			result.components.push_back(ComponentStats{ r.class_id, r.x0, r.y, r.x1, r.y + 1, 0, 0.f, 0.f }); // width, height 자리에 right, bottom 을 임시 저장
+			sum_x.push_back(0.0);
+			sum_y.push_back(0.0);
+		}
+		else {
+			component_[i] = component_[root];
+		}
+		int k = component_[i] - 1;
+		ComponentStats& st = result.components[k];
+		int len = r.x1 - r.x0;
+		st.left = std::min(st.left, r.x0);
+		st.width = std::max(st.width, r.x1);
+		st.height = std::max(st.height, r.y + 1);
+		st.area += len;
+		sum_x[k] += (double)(r.x0 + r.x1 - 1) * len * 0.5;
+		sum_y[k] += (double)r.y * len;
+	}
+	for (size_t k = 0; k < result.components.size(); k++) {
+		ComponentStats& st = result.components[k];
+		st.width -= st.left;
+		st.height -= st.top;
+		st.cx = (float)(sum_x[k] / st.area);
+		st.cy = (float)(sum_y[k] / st.area);
+	}
+
+	// 5. 인스턴스 label 이미지 (strip 단위 멀티스레드)
+	if (!param_.output_labels) {
+		result.labels.clear();
+		return;
+	}
+	result.labels.resize((size_t)width * height);
+#pragma omp parallel for schedule(static, 1)
+	for (int s = 0; s < strips; s++) {
+		const int off = strip_offset_[s];
+		const std::vector<int>& rows = strip_rows_[s];
+		const int y0 = height * s / strips;
+		for (size_t r = 0; r + 1 < rows.size(); r++) {
+			int* dst = result.labels.data() + (size_t)(y0 + r) * width;
+			std::fill(dst, dst + width, 0);
+			for (int i = off + rows[r]; i < off + rows[r + 1]; i++) {
+				std::fill(dst + runs_[i].x0, dst + runs_[i].x1, component_[i]);
+			}
+		}
+	}
+}
@@ -0,0 +1,63 @@
+﻿#pragma once
+#include <cstdint>
+#include <vector>
+
+struct ConnectedComponentsParam {
+	int connectivity;		// 4 or 8
+	int background;			// 배경 클래스 (label 값), 이 값의 픽셀은 무시
+	bool output_labels;		// 인스턴스 label 이미지 출력 여부 (false 면 통계만 계산)
+};
+
+// 연결 요소 통계 (cv::connectedComponentsWithStats 의 stats, centroids 와 동일한 정의)
+struct ComponentStats {
+	int class_id;	// 원본 label map 의 클래스
+	int left;
+	int top;
+	int width;
+	int height;
+	int area;
+	float cx;		// 무게 중심
+	float cy;
+};
+
+struct ComponentResult {
+	int width;
+	int height;
+	std::vector<int> labels;				// [H, W] 0 : 배경, k : components[k - 1] (output_labels == true 일때)
+	std::vector<ComponentStats> components;	// raster 순서 (첫 픽셀 기준)
+};
+
+//! \class ConnectedComponents
+//!
+//! \brief 분할 결과(label map [H, W])의 인스턴스 분리.
+//!  행 strip 별로 run 추출 및 union-find (멀티스레드) -> strip 경계 병합 -> 요소 번호 부여 -> label 이미지, 통계 계산
+//!  같은 클래스의 인접 픽셀만 연결 (다중 클래스 label map 그대로 사용)
+//!
+class ConnectedComponents
+{
+public:
+	ConnectedComponents(const ConnectedComponentsParam& param);
+
+	// label : SegResult::label 과 같은 uint8 class index map
+	void run(const uint8_t* label, int width, int height, ComponentResult& result);
+
+private:
+	struct Run {
+		int x0;		// [x0, x1)
+		int x1;
+		int y;
+		int class_id;
+	};
+	void extractRuns(const uint8_t* label, int width, int y0, int y1, std::vector<Run>& runs, std::vector<int>& row_start);
+	void unionRows(int prev_begin, int prev_end, int cur_begin, int cur_end);
+	int find(int i);
+	void unite(int a, int b);
+
+	ConnectedComponentsParam param_;
+	std::vector<std::vector<Run>> strip_runs_;		// strip 별 run 목록
+	std::vector<std::vector<int>> strip_rows_;		// strip 별 행 시작 run 인덱스 [rows + 1]
+	std::vector<int> strip_offset_;					// strip 별 전체 run 인덱스 시작 위치
+	std::vector<int> parent_;						// run 단위 union-find
+	std::vector<int> component_;					// run -> 요소 번호 (1 부터)
+	std::vector<Run> runs_;							// 전체 run (strip 순서로 이어 붙임)
+};
@@ -0,0 +1,131 @@
+﻿// 다섯 모델의 모든 conv shape 에 대해 알고리즘별 GFLOP/s, 오차 측정
+// usage : conv_bench [model (기본 전체)] [-n iterations] [-t threads]
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include "cpu_conv.hpp"
+#include "ir_models.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+static std::string shapeKey(const ConvShape& s)
+{
+	std::ostringstream os;
+	os << s.C << "x" << s.H << "x" << s.W << " -> " << s.K << "x" << s.OH << "x" << s.OW << " k" << s.KH << "x" << s.KW << " s" << s.SH;
+	if (s.DH > 1) os << " d" << s.DH;
+	if (s.G > 1) os << " g" << s.G;
+	return os.str();
+}
+
+struct ShapeEntry {
+	ConvShape shape;
+	std::map<std::string, int> count;	// 모델별 사용 횟수
+};
+
+int main(int argc, char** argv)
+{
+	std::string only;
+	int iterations = 5;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-n") && i + 1 < argc) iterations = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+#ifdef _OPENMP
+			omp_set_num_threads(atoi(argv[++i]));
+#else
+			++i;
+#endif
+		}
+		else only = argv[i];
+	}
+
+	// 1. 모델별 conv shape 수집 (가중치는 shape 만 필요하므로 난수)
+	std::map<std::string, ShapeEntry> shapes;
+	std::vector<std::string> order;
+	for (const ir::ModelConfig& config : ir::modelConfigs()) {
+		if (!only.empty() && only != config.name) continue;
+		ir::WeightMap weightMap;
+		ir::WeightSource weights(weightMap, true);
+		ir::Network network;
+		if (!ir::buildModel(config.name, network, weights, 1)) continue;
+		for (int i = 0; i < network.getNbLayers(); i++) {
+			const ir::Layer* l = network.getLayer(i);
+			if (l->getType() != ir::LayerType::kCONVOLUTION) continue;
+			const ConvShape s = convShapeOf(*l);
+			const std::string key = shapeKey(s);
+			if (!shapes.count(key)) order.push_back(key);
+			shapes[key].shape = s;
+			shapes[key].count[config.name]++;
+		}
+	}
+
+	const ConvAlgo algos[] = { ConvAlgo::kDIRECT, ConvAlgo::kGEMM_1X1, ConvAlgo::kIM2COL_GEMM, ConvAlgo::kDIRECT_NCHWC, ConvAlgo::kWINOGRAD_2X2, ConvAlgo::kWINOGRAD_4X4 };
+	std::cout << std::left << std::setw(44) << "shape" << std::setw(20) << "models" << std::right << std::setw(8) << "MFLOP";
+	for (ConvAlgo a : algos) std::cout << std::setw(10) << convAlgoName(a);
+	std::cout << "  (GFLOP/s)  auto / best" << std::endl;
+
+	std::map<std::string, std::pair<double, double>> model_ms;	// 모델별 (auto, best) conv 시간 합
+	std::mt19937 rng(0);
+	std::uniform_real_distribution<float> uni(-1.f, 1.f);
+	for (const std::string& key : order) {
+		const ShapeEntry& e = shapes[key];
+		const ConvShape& s = e.shape;
+		std::vector<float> in((size_t)s.C * s.H * s.W), w((size_t)s.K * (s.C / s.G) * s.KH * s.KW), b(s.K);
+		for (auto& v : in) v = uni(rng);
+		const float ws = std::sqrt(3.f / ((s.C / s.G) * s.KH * s.KW));
+		for (auto& v : w) v = uni(rng) * ws;
+		for (auto& v : b) v = uni(rng);
+		std::vector<float> ref((size_t)s.K * s.OH * s.OW), out(ref.size());
+		CpuConv(s, w.data(), b.data(), ConvAlgo::kDIRECT).forward(in.data(), ref.data());
+		double ref_max = 0.0;
+		for (float v : ref) ref_max = std::max(ref_max, (double)std::fabs(v));
+
+		std::ostringstream models;
+		for (const auto& c : e.count) models << (models.tellp() > 0 ? "," : "") << c.first << "x" << c.second;
+		const double flops = (double)convFlops(s);
+		std::cout << std::left << std::setw(44) << key << std::setw(20) << models.str() << std::right << std::fixed << std::setprecision(1) << std::setw(8) << flops / 1e6;
+
+		double best_ms = 0.0, auto_ms = 0.0;
+		ConvAlgo best = ConvAlgo::kDIRECT;
+		const ConvAlgo chosen = chooseConvAlgo(s);
+		std::ostringstream errors;
+		for (ConvAlgo a : algos) {
+			if (!convSupports(s, a)) {
+				std::cout << std::setw(10) << "-";
+				continue;
+			}
+			CpuConv conv(s, w.data(), b.data(), a);
+			conv.forward(in.data(), out.data());	// warm up
+			double ms = 1e30;
+			for (int it = 0; it < iterations; it++) {
+				auto t0 = std::chrono::high_resolution_clock::now();
+				conv.forward(in.data(), out.data());
+				auto t1 = std::chrono::high_resolution_clock::now();
+				ms = std::min(ms, std::chrono::duration<double, std::milli>(t1 - t0).count());
+			}
+			double err = 0.0;
+			for (size_t i = 0; i < out.size(); i++) err = std::max(err, (double)std::fabs(out[i] - ref[i]));
+			if (err > 1e-3 * std::max(ref_max, 1.0)) errors << " [ERROR] " << convAlgoName(a) << " max abs err " << err;
+			std::cout << std::setw(10) << std::setprecision(2) << flops / (ms * 1e6);
+			if (best_ms == 0.0 || ms < best_ms) { best_ms = ms; best = a; }
+			if (a == chosen) auto_ms = ms;
+		}
+		std::cout << "  " << convAlgoName(chosen) << " / " << convAlgoName(best) << errors.str() << std::endl;
+		for (const auto& c : e.count) {
+			model_ms[c.first].first += auto_ms * c.second;
+			model_ms[c.first].second += best_ms * c.second;
+		}
+	}
+
+	std::cout << std::endl << "conv total per model (batch 1)" << std::endl;
+	for (const auto& m : model_ms) {
+		std::cout << "  " << std::left << std::setw(10) << m.first << std::right << " auto " << std::setw(10) << std::setprecision(2) << m.second.first
+			<< " ms, best per shape " << std::setw(10) << m.second.second << " ms" << std::endl;
+	}
+	return 0;
+}
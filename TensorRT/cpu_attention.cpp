@@ -0,0 +1,98 @@
+﻿#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "cpu_attention.hpp"
+#include "cpu_gemm.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+static const int kBQ = 64;		// task 당 query 행 수
+static const int kBK = 128;		// key block (score tile kBQ x kBK 가 L1, L2 경계에 남는 크기, GEMM panel 폭의 배수)
+
+static inline int divUp(int a, int b) { return (a + b - 1) / b; }
+
+void attention(const float* q, const float* k, const float* v, int Lq, int Lk, int heads, int headDim, float scale, float* out)
+{
+	const int D = headDim, E = heads * D;
+	const GemmIsa isa = gemmIsa();
+	const int nr = gemmPanelWidth(isa);
+	// head 별 K^T [D, Lk], V [Lk, D] 를 GEMM B panel 로 정렬 (head 분리는 stride 로)
+	const int64_t k_size = (int64_t)((Lk + nr - 1) / nr * nr) * D, v_size = (int64_t)((D + nr - 1) / nr * nr) * Lk;
+	std::vector<float> kp((size_t)(heads * k_size)), vp((size_t)(heads * v_size));
+#pragma omp parallel for schedule(static)
+	for (int h = 0; h < heads; h++) {
+		packGemmB(k + h * D, D, Lk, 1, E, kp.data() + h * k_size, isa);
+		packGemmB(v + h * D, Lk, D, E, 1, vp.data() + h * v_size, isa);
+	}
+
+	const int qblocks = divUp(Lq, kBQ);
+#pragma omp parallel
+	{
+		std::vector<float> qs(kBQ * D), s(kBQ * kBK), acc(kBQ * D), row_max(kBQ), row_sum(kBQ);
+#pragma omp for schedule(dynamic)
+		for (int t = 0; t < heads * qblocks; t++) {
+			const int h = t / qblocks, i0 = t % qblocks * kBQ, bq = std::min(kBQ, Lq - i0);
+			for (int i = 0; i < bq; i++) {
+				const float* qr = q + (size_t)(i0 + i) * E + h * D;
+				for (int d = 0; d < D; d++) qs[i * D + d] = qr[d] * scale;
+			}
+			std::fill(acc.begin(), acc.end(), 0.f);
+			std::fill(row_max.begin(), row_max.end(), -std::numeric_limits<float>::infinity());
+			std::fill(row_sum.begin(), row_sum.end(), 0.f);
+
+			for (int j0 = 0; j0 < Lk; j0 += kBK) {
+				const int bk = std::min(kBK, Lk - j0);
+				// s = q k^T (key block, kBK 는 panel 폭의 배수)
+				gemmSerial(bq, bk, D, qs.data(), D, 1, kp.data() + h * k_size + (int64_t)j0 * D, (int64_t)D * nr, s.data(), kBK, false, isa);
+				// online softmax : 최대값이 커지면 이전 누적값, 합을 exp(old - new) 배
+				for (int i = 0; i < bq; i++) {
+					float* si = s.data() + i * kBK;
+					float m = row_max[i];
+					for (int j = 0; j < bk; j++) m = std::max(m, si[j]);
+					const float correction = std::exp(row_max[i] - m);
+					float sum = 0.f;
+					for (int j = 0; j < bk; j++) {
+						si[j] = std::exp(si[j] - m);
+						sum += si[j];
+					}
+					row_max[i] = m;
+					row_sum[i] = row_sum[i] * correction + sum;
+					float* ai = acc.data() + i * D;
+					for (int d = 0; d < D; d++) ai[d] *= correction;
+				}
+				// acc += p v (key block 행)
+				gemmSerial(bq, D, bk, s.data(), kBK, 1, vp.data() + h * v_size + (int64_t)j0 * nr, (int64_t)Lk * nr, acc.data(), D, true, isa);
+			}
+			for (int i = 0; i < bq; i++) {
+				const float inv = 1.f / row_sum[i];
+				float* o = out + (size_t)(i0 + i) * E + h * D;
+				for (int d = 0; d < D; d++) o[d] = acc[i * D + d] * inv;
+			}
+		}
+	}
+}
+
+void attentionUnfused(const float* q, const float* k, const float* v, int Lq, int Lk, int heads, int headDim, float scale, float* out)
+{
+	const int D = headDim, E = heads * D;
+	std::vector<float> qs((size_t)Lq * E), scores((size_t)Lq * Lk);
+	for (size_t i = 0; i < qs.size(); i++) qs[i] = q[i] * scale;
+	for (int h = 0; h < heads; h++) {
+		// head 분리는 stride 로 : q_h[i, d] = qs[i * E + h * D + d], k_h^T[d, j] = k[j * E + h * D + d]
+		gemm(Lq, Lk, D, qs.data() + h * D, E, 1, k + h * D, 1, E, scores.data(), Lk);
+#pragma omp parallel for schedule(static)
+		for (int i = 0; i < Lq; i++) {
+			float* r = scores.data() + (size_t)i * Lk;
+			const float m = *std::max_element(r, r + Lk);
+			float sum = 0.f;
+			for (int j = 0; j < Lk; j++) {
+				r[j] = std::exp(r[j] - m);
+				sum += r[j];
+			}
+			for (int j = 0; j < Lk; j++) r[j] /= sum;
+		}
+		gemm(Lq, D, Lk, scores.data(), Lk, 1, v + h * D, E, 1, out + h * D, E);
+	}
+}
@@ -0,0 +1,10 @@
+﻿#pragma once
+
+// multi-head attention (DETR MultiHeadAttention() 의 linear 이후 부분)
+// q : [Lq, E], k, v : [Lk, E] (head h 는 열 [h * D, (h + 1) * D), E = heads * D) -> out : [Lq, E]
+// out_h = softmax(scale * q_h k_h^T) v_h, head 분리, 합치기와 query scale 은 index 계산으로 처리
+// query block 단위로 key block 을 돌면서 online softmax (최대값이 바뀌면 누적값 rescale), [Lq, Lk] score 행렬을 만들지 않음
+void attention(const float* q, const float* k, const float* v, int Lq, int Lk, int heads, int headDim, float scale, float* out);
+
+// 비교용 : head 별 [Lq, Lk] score 행렬 전체를 만들고 gemm, softmax, gemm (graph pass 이전 레이어 순서와 같은 계산)
+void attentionUnfused(const float* q, const float* k, const float* v, int Lq, int Lk, int heads, int headDim, float scale, float* out);
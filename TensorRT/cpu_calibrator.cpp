@@ -0,0 +1,266 @@
+﻿#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include "calib_table.hpp"
+#include "cpu_calibrator.hpp"
+#include "cpu_interpreter.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace ir;
+
+static const int kUNSET = INT_MIN;
+static const int kQUANT_BINS = 128;	// entropy : 양자화 후 bin 수 (|x| 를 int8 0 ~ 127 로)
+
+const char* calibAlgorithmName(CalibAlgorithm algorithm)
+{
+	switch (algorithm) {
+	case CalibAlgorithm::kENTROPY: return "entropy";
+	case CalibAlgorithm::kPERCENTILE: return "percentile";
+	case CalibAlgorithm::kMAX: return "max";
+	}
+	return "unknown";
+}
+
+bool calibratedTensor(const Tensor* tensor)
+{
+	return tensor->isBatched() && tensor->getType() == DataType::kFLOAT;
+}
+
+ActivationHistogram::ActivationHistogram()
+	: bins_(kBINS, 0), exponent_(kUNSET), max_(0.f), count_(0)
+{
+}
+
+// 범위를 2^exponent 로 늘림, bin i 는 i >> shift 로 (범위가 2 의 거듭제곱이라 처음부터 넓은 범위로 기록한 것과 같음)
+void ActivationHistogram::grow(int exponent)
+{
+	if (exponent_ != kUNSET && exponent > exponent_) {
+		const int shift = exponent - exponent_;
+		if (shift >= 31) {
+			uint64_t total = 0;
+			for (uint64_t v : bins_) total += v;
+			std::fill(bins_.begin(), bins_.end(), 0);
+			bins_[0] = total;
+		}
+		else {
+			for (int i = 1; i < kBINS; i++) {
+				const int j = i >> shift;
+				if (j == i) continue;
+				bins_[j] += bins_[i];
+				bins_[i] = 0;
+			}
+		}
+	}
+	if (exponent_ == kUNSET || exponent > exponent_) exponent_ = exponent;
+}
+
+void ActivationHistogram::add(const float* data, int64_t count)
+{
+	float local_max = 0.f;
+	for (int64_t i = 0; i < count; i++) {
+		const float a = std::fabs(data[i]);
+		if (a > local_max && std::isfinite(a)) local_max = a;
+	}
+	if (local_max > 0.f) {
+		int e;
+		std::frexp(local_max, &e);	// local_max < 2^e
+		grow(e);
+		max_ = std::max(max_, local_max);
+	}
+	// 0 만 받은 동안은 범위 없이 bin 0 에 기록
+	const double scale = exponent_ == kUNSET ? 0.0 : std::ldexp(1.0, 11 - exponent_);	// kBINS / 2^exponent
+	for (int64_t i = 0; i < count; i++) {
+		const float a = std::fabs(data[i]);
+		if (!std::isfinite(a)) continue;
+		bins_[std::min((int)(a * scale), kBINS - 1)]++;
+		count_++;
+	}
+}
+
+void ActivationHistogram::merge(const ActivationHistogram& other)
+{
+	if (other.count_ == 0) return;
+	if (other.exponent_ != kUNSET) grow(other.exponent_);
+	if (other.exponent_ == kUNSET || other.exponent_ == exponent_) {
+		for (int i = 0; i < kBINS; i++) bins_[i] += other.bins_[i];
+	}
+	else {
+		const int shift = std::min(exponent_ - other.exponent_, 31);
+		for (int i = 0; i < kBINS; i++) bins_[shift >= 31 ? 0 : i >> shift] += other.bins_[i];
+	}
+	max_ = std::max(max_, other.max_);
+	count_ += other.count_;
+}
+
+float ActivationHistogram::amax(CalibAlgorithm algorithm, double percentile) const
+{
+	if (exponent_ == kUNSET) return 0.f;
+	const double width = std::ldexp(1.0, exponent_ - 11);
+	switch (algorithm) {
+	case CalibAlgorithm::kMAX:
+		return max_;
+	case CalibAlgorithm::kPERCENTILE: {
+		const double target = count_ * std::min(std::max(percentile, 0.0), 100.0) / 100.0;
+		uint64_t cumulative = 0;
+		for (int i = 0; i < kBINS; i++) {
+			cumulative += bins_[i];
+			if (cumulative >= target) return std::min((float)((i + 1) * width), max_);
+		}
+		return max_;
+	}
+	case CalibAlgorithm::kENTROPY:
+		return entropyAmax();
+	}
+	return max_;
+}
+
+// 후보 구간 [0, i bin) 마다 P (구간 밖은 마지막 bin 에 합침) 와 P 를 128 단계로 양자화한 Q 의 KL divergence 를 구하고
+// 가장 작은 (같으면 앞쪽) 후보의 끝을 amax 로 (pytorch-quantization 의 _compute_amax_entropy, TensorRT EntropyCalibration2)
+float ActivationHistogram::entropyAmax() const
+{
+	int stop = kBINS;
+	while (stop > 0 && bins_[stop - 1] == 0) stop--;
+	if (stop <= kQUANT_BINS) return max_;	// 값이 128 bin 안에 모두 있으면 잘라낼 것이 없음
+	std::vector<double> bins(bins_.begin(), bins_.begin() + stop);
+	bins[0] = bins[1];	// relu 출력의 0 이 분포를 지배하지 않게 (pytorch-quantization 과 같음)
+	std::vector<double> suffix(stop + 1, 0.0);	// suffix[i] = bins[i:] 합
+	for (int i = stop - 1; i >= 0; i--) suffix[i] = suffix[i + 1] + bins[i];
+
+	std::vector<double> q_sum(kQUANT_BINS), p(stop), q(stop);
+	std::vector<int> q_nonzero(kQUANT_BINS);
+	double best = HUGE_VAL;
+	int best_i = stop;
+	for (int i = kQUANT_BINS; i <= stop; i++) {
+		// Q : 양자화 bin 마다 0 이 아닌 원래 bin 에 평균을 나눠줌
+		std::fill(q_sum.begin(), q_sum.end(), 0.0);
+		std::fill(q_nonzero.begin(), q_nonzero.end(), 0);
+		for (int j = 0; j < i; j++) {
+			if (bins[j] == 0.0) continue;
+			const int k = j * kQUANT_BINS / i;
+			q_sum[k] += bins[j];
+			q_nonzero[k]++;
+		}
+		double q_total = 0.0;
+		for (int j = 0; j < i; j++) {
+			const int k = j * kQUANT_BINS / i;
+			q[j] = bins[j] == 0.0 ? 0.0 : q_sum[k] / q_nonzero[k];
+			q_total += q[j];
+		}
+		const double p_total = suffix[0];
+		double divergence = 0.0;
+		for (int j = 0; j < i; j++) {
+			const double pj = (j == i - 1 ? bins[j] + suffix[i] : bins[j]) / p_total;
+			if (pj == 0.0) continue;
+			const double qj = q[j] / q_total;
+			if (qj == 0.0) {
+				divergence = HUGE_VAL;
+				break;
+			}
+			divergence += pj * std::log(pj / qj);
+		}
+		if (divergence < best) {
+			best = divergence;
+			best_i = i;
+		}
+	}
+	return std::min((float)(best_i * std::ldexp(1.0, exponent_ - 11)), max_);
+}
+
+CpuCalibrator::CpuCalibrator(const Network& network, int workers, int threads)
+	: network_(network), workers_(std::max(1, workers)), threads_(std::max(1, threads)), stats_{ 0, 0.0, 0.0, 0.0, 0.0 }
+{
+}
+
+bool CpuCalibrator::collect(CalibBatchLoader& loader, const std::string& inputName)
+{
+	using Clock = std::chrono::high_resolution_clock;
+	const Clock::time_point t0 = Clock::now();
+	const int nb = network_.getNbTensors();
+	const int batch = loader.batchSize();
+	std::vector<std::vector<ActivationHistogram>> local(workers_);
+	std::vector<double> wait_ms(workers_, 0.0), run_ms(workers_, 0.0);
+	std::mutex mutex;	// loader.next 와 넘겨받은 버퍼 복사
+	int images = 0;
+	std::vector<std::thread> pool;
+	for (int w = 0; w < workers_; w++) {
+		pool.emplace_back([&, w]() {
+#ifdef _OPENMP
+			omp_set_num_threads(threads_);
+#endif
+			std::vector<ActivationHistogram>& histograms = local[w];
+			histograms.resize(nb);
+			const Tensor* in = network_.findTensor(inputName);
+			CpuInterpreter interpreter(network_, batch, threads_, CpuPrecision::kFP32, true);
+			interpreter.setLayerCallback([&](const Layer& l) {
+				for (int k = 0; k < l.getNbOutputs(); k++) {
+					const Tensor* t = l.getOutput(k);
+					if (calibratedTensor(t)) histograms[t->id()].add(interpreter.getTensor(t), volume(t->getDimensions()) * batch);
+				}
+			});
+			std::vector<uint8_t> input(loader.batchBytes());
+			while (true) {
+				const Clock::time_point w0 = Clock::now();
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					const uint8_t* data = loader.next();
+					if (!data) break;
+					memcpy(input.data(), data, input.size());
+					images += batch;
+				}
+				const Clock::time_point r0 = Clock::now();
+				wait_ms[w] += std::chrono::duration<double, std::milli>(r0 - w0).count();
+				interpreter.setInput(inputName, input.data());
+				// 입력은 레이어 출력이 아니라 callback 에 오지 않음 (uint8 을 float 로 바꾼 값)
+				if (calibratedTensor(in)) histograms[in->id()].add(interpreter.getTensor(in), volume(in->getDimensions()) * batch);
+				interpreter.run(batch);
+				run_ms[w] += std::chrono::duration<double, std::milli>(Clock::now() - r0).count();
+			}
+		});
+	}
+	for (auto& t : pool) t.join();
+
+	// 텐서별로 worker histogram 합치기
+	const Clock::time_point m0 = Clock::now();
+	histograms_.assign(nb, ActivationHistogram());
+#pragma omp parallel for schedule(dynamic)
+	for (int i = 0; i < nb; i++) {
+		for (int w = 0; w < workers_; w++) histograms_[i].merge(local[w][i]);
+	}
+	const Clock::time_point t1 = Clock::now();
+	stats_.images = images;
+	stats_.wall_ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+	stats_.merge_ms = std::chrono::duration<double, std::milli>(t1 - m0).count();
+	stats_.wait_ms = stats_.run_ms = 0.0;
+	for (int w = 0; w < workers_; w++) {
+		stats_.wait_ms += wait_ms[w];
+		stats_.run_ms += run_ms[w];
+	}
+	return !loader.failed();
+}
+
+const ActivationHistogram* CpuCalibrator::histogram(const Tensor* tensor) const
+{
+	if (histograms_.empty() || !calibratedTensor(tensor)) return nullptr;
+	return &histograms_[tensor->id()];
+}
+
+std::vector<std::pair<std::string, float>> CpuCalibrator::scales(CalibAlgorithm algorithm, double percentile) const
+{
+	const int nb = (int)histograms_.size();
+	std::vector<float> amax(nb, 0.f);
+#pragma omp parallel for schedule(dynamic)
+	for (int i = 0; i < nb; i++) {
+		if (calibratedTensor(network_.getTensor(i))) amax[i] = histograms_[i].amax(algorithm, percentile);
+	}
+	std::vector<std::pair<std::string, float>> result;
+	for (int i = 0; i < nb; i++) {
+		if (amax[i] > 0.f) result.emplace_back(trtTensorName(network_.getTensor(i)->getName()), amax[i] / 127.f);
+	}
+	return result;
+}
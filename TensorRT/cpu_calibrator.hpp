@@ -0,0 +1,87 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "calib_loader.hpp"
+#include "graph_ir.hpp"
+
+// calibration scale 결정 방식
+enum class CalibAlgorithm {
+	kENTROPY,		// KL divergence 최소 (TensorRT EntropyCalibration2 와 같은 방식)
+	kPERCENTILE,	// |x| 분포의 percentile
+	kMAX,			// 최대 절대값
+};
+const char* calibAlgorithmName(CalibAlgorithm algorithm);
+// calibration 대상 : batch 마다 달라지는 float 텐서 (network 입력 포함, index 텐서, 상수 제외)
+bool calibratedTensor(const ir::Tensor* tensor);
+
+//! \class ActivationHistogram
+//!
+//! \brief 텐서 하나의 |x| 분포 (kBINS 개 bin, 범위 [0, 2^exponent))
+//!  범위를 넘는 값이 오면 인접한 bin 을 둘씩 합쳐 범위를 2 배로 늘림 -> 범위가 항상 2 의 거듭제곱이라
+//!  thread 별로 따로 모은 histogram 을 잃는 것 없이 합칠 수 있음 (같은 이미지 집합이면 합치는 순서와 무관하게 같은 결과)
+//!  inf, nan 은 제외
+//!
+class ActivationHistogram
+{
+public:
+	static const int kBINS = 2048;
+
+	ActivationHistogram();
+	void add(const float* data, int64_t count);
+	void merge(const ActivationHistogram& other);
+
+	// algorithm 으로 정한 amax (dynamic range [-amax, amax]), percentile 은 kPERCENTILE 에서만 사용 (예 99.99)
+	float amax(CalibAlgorithm algorithm, double percentile = 99.99) const;
+	float maxAbs() const { return max_; }
+	uint64_t count() const { return count_; }
+
+private:
+	void grow(int exponent);
+	float entropyAmax() const;
+
+	std::vector<uint64_t> bins_;
+	int exponent_;		// 범위 지수, 0 이 아닌 값을 아직 받지 않았으면 kUNSET (0 은 bin 0 에 기록)
+	float max_;
+	uint64_t count_;
+};
+
+struct CpuCalibratorStats {
+	int images;
+	double wall_ms;		// collect 전체
+	double wait_ms;		// worker 가 loader 를 기다린 시간 합
+	double run_ms;		// interpreter 실행 (histogram 기록 포함) 시간 합
+	double merge_ms;	// worker 별 histogram 합치기
+};
+
+//! \class CpuCalibrator
+//!
+//! \brief TensorRT 없이 CPU interpreter 로 calibration 이미지를 실행해서 텐서별 activation histogram 을 모으고
+//!  entropy, percentile, max 방식으로 scale 을 정함 (결과는 writeCalibrationTable 로 TensorRT table 저장)
+//!  worker thread 마다 interpreter (planMemory) 와 텐서별 histogram 을 따로 두고 (lock 없음), 끝난 뒤 한번에 합침
+//!  이미지는 CalibBatchLoader 하나를 공유 (미리 읽기 thread 가 디코딩)
+//!  network 는 graph pass 전의 원래 network 를 사용 (텐서 이름이 TensorRT 와 같아야 함)
+//!
+class CpuCalibrator
+{
+public:
+	// workers : 동시에 실행하는 interpreter 수, threads : interpreter 당 OpenMP thread 수
+	CpuCalibrator(const ir::Network& network, int workers, int threads = 1);
+
+	// loader 의 batch 를 모두 실행해서 histogram 을 모음 (loader 의 batch 크기로 실행), 입력 읽기 실패면 false
+	bool collect(CalibBatchLoader& loader, const std::string& inputName);
+
+	// calibratedTensor 의 histogram, 대상이 아니면 nullptr
+	const ActivationHistogram* histogram(const ir::Tensor* tensor) const;
+	// network 텐서 순서의 (TensorRT 텐서 이름, scale = amax / 127), 한번도 0 이 아닌 값을 받지 못한 텐서는 제외
+	std::vector<std::pair<std::string, float>> scales(CalibAlgorithm algorithm, double percentile = 99.99) const;
+	const CpuCalibratorStats& stats() const { return stats_; }
+
+private:
+	const ir::Network& network_;
+	int workers_;
+	int threads_;
+	std::vector<ActivationHistogram> histograms_;	// tensor id 별
+	CpuCalibratorStats stats_;
+};
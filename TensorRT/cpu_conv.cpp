@@ -0,0 +1,638 @@
+﻿#include <cassert>
+#include <cstring>
+#include "cpu_conv.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// blocked GEMM 크기
+// micro kernel 은 SSE register 16 개 안에서 누적 (4 x 8 누적 + B 2 + A 1)
+static const int kMR = 4;		// micro kernel 행 (출력 채널)
+static const int kNR = 8;		// micro kernel 열 (출력 pixel, 연속 메모리)
+static const int kKC = 256;		// k 방향 block (A, B panel 이 L1, L2 에 남는 크기)
+static const int kNC = 96;		// im2col 출력 pixel tile 기본값 (kNR 배수)
+static const int kMC = 64;		// 병렬 task 당 출력 채널 수 (kMR 배수)
+static const int kTB = 32;		// Winograd tile block (kNR 배수)
+
+static inline int divUp(int a, int b) { return (a + b - 1) / b; }
+static inline int roundUp(int a, int b) { return divUp(a, b) * b; }
+
+int maxThreads()
+{
+#ifdef _OPENMP
+	return omp_get_max_threads();
+#else
+	return 1;
+#endif
+}
+
+const char* convAlgoName(ConvAlgo algo)
+{
+	switch (algo) {
+	case ConvAlgo::kAUTO: return "auto";
+	case ConvAlgo::kDIRECT: return "direct";
+	case ConvAlgo::kGEMM_1X1: return "gemm1x1";
+	case ConvAlgo::kIM2COL_GEMM: return "im2col";
+	case ConvAlgo::kDIRECT_NCHWC: return "nchwc";
+	case ConvAlgo::kWINOGRAD_2X2: return "wino2x2";
+	case ConvAlgo::kWINOGRAD_4X4: return "wino4x4";
+	}
+	return "unknown";
+}
+
+ConvShape convShapeOf(const ir::Layer& layer)
+{
+	const ir::Dims in = layer.getInput(0)->getDimensions();
+	const ir::Dims out = layer.getOutput(0)->getDimensions();
+	assert(in.nbDims == 3 && layer.kernel_.nbDims == 2);
+	return ConvShape{ in.d[0], in.d[1], in.d[2], out.d[0], out.d[1], out.d[2],
+		layer.kernel_.d[0], layer.kernel_.d[1], layer.stride_.d[0], layer.stride_.d[1],
+		layer.pre_padding_.d[0], layer.pre_padding_.d[1], layer.dilation_.d[0], layer.dilation_.d[1], layer.groups_ };
+}
+
+int64_t convFlops(const ConvShape& s)
+{
+	return 2LL * s.K * s.OH * s.OW * (s.C / s.G) * s.KH * s.KW;
+}
+
+bool convSupports(const ConvShape& s, ConvAlgo algo)
+{
+	switch (algo) {
+	case ConvAlgo::kAUTO:
+	case ConvAlgo::kDIRECT:
+	case ConvAlgo::kIM2COL_GEMM:
+		return true;
+	case ConvAlgo::kGEMM_1X1:
+		return s.KH == 1 && s.KW == 1 && s.SH == 1 && s.SW == 1 && s.PH == 0 && s.PW == 0 && s.OH == s.H && s.OW == s.W;
+	case ConvAlgo::kDIRECT_NCHWC:
+		return (s.C / s.G) % kCONV_BLOCK == 0 && (s.K / s.G) % kCONV_BLOCK == 0;
+	case ConvAlgo::kWINOGRAD_2X2:
+	case ConvAlgo::kWINOGRAD_4X4:
+		return s.KH == 3 && s.KW == 3 && s.SH == 1 && s.SW == 1 && s.DH == 1 && s.DW == 1 && s.G == 1;
+	}
+	return false;
+}
+
+ConvAlgo chooseConvAlgo(const ConvShape& s)
+{
+	if (convSupports(s, ConvAlgo::kGEMM_1X1)) return ConvAlgo::kGEMM_1X1;
+	if (convSupports(s, ConvAlgo::kWINOGRAD_4X4) && s.C >= 16 && s.K >= 16) {
+		// 작은 feature map 은 F(4x4) tile 의 경계 낭비가 큼
+		return std::min(s.OH, s.OW) >= 16 ? ConvAlgo::kWINOGRAD_4X4 : ConvAlgo::kWINOGRAD_2X2;
+	}
+	return ConvAlgo::kIM2COL_GEMM;
+}
+
+void nchwToNchwc(const float* in, int C, int HW, float* out)
+{
+#pragma omp parallel for schedule(static)
+	for (int cb = 0; cb < C / kCONV_BLOCK; cb++) {
+		const float* src = in + (int64_t)cb * kCONV_BLOCK * HW;
+		float* dst = out + (int64_t)cb * kCONV_BLOCK * HW;
+		for (int i = 0; i < HW; i++) {
+			for (int c = 0; c < kCONV_BLOCK; c++) dst[i * kCONV_BLOCK + c] = src[(int64_t)c * HW + i];
+		}
+	}
+}
+
+void nchwcToNchw(const float* in, int C, int HW, float* out)
+{
+#pragma omp parallel for schedule(static)
+	for (int cb = 0; cb < C / kCONV_BLOCK; cb++) {
+		const float* src = in + (int64_t)cb * kCONV_BLOCK * HW;
+		float* dst = out + (int64_t)cb * kCONV_BLOCK * HW;
+		for (int c = 0; c < kCONV_BLOCK; c++) {
+			for (int i = 0; i < HW; i++) dst[(int64_t)c * HW + i] = src[i * kCONV_BLOCK + c];
+		}
+	}
+}
+
+/* ------ blocked GEMM ------ */
+
+// A [M, Kd] (행 간격 lda) -> kMR 행 panel 단위 [M/kMR][Kd][kMR] (남는 행은 0)
+static void packA(const float* a, int M, int Kd, int64_t lda, float* dst)
+{
+	for (int mp = 0; mp < divUp(M, kMR); mp++) {
+		float* d = dst + (int64_t)mp * Kd * kMR;
+		for (int p = 0; p < Kd; p++) {
+			for (int i = 0; i < kMR; i++) {
+				const int m = mp * kMR + i;
+				d[p * kMR + i] = m < M ? a[m * lda + p] : 0.f;
+			}
+		}
+	}
+}
+
+// c[mr, nr] (+)= a[kc, kMR]^T b[kc, kNR] (b 는 행 간격 ldb, 열 kNR 개를 읽을 수 있어야 함)
+static void microKernel(int kc, const float* a, const float* b, int64_t ldb, float* c, int64_t ldc, int mr, int nr, bool accumulate)
+{
+	float acc[kMR][kNR];
+	for (int i = 0; i < kMR; i++) {
+		for (int j = 0; j < kNR; j++) acc[i][j] = 0.f;
+	}
+	for (int p = 0; p < kc; p++) {
+		const float* bp = b + p * ldb;
+		for (int i = 0; i < kMR; i++) {
+			const float av = a[p * kMR + i];
+			for (int j = 0; j < kNR; j++) acc[i][j] += av * bp[j];
+		}
+	}
+	for (int i = 0; i < mr; i++) {
+		float* cr = c + i * ldc;
+		if (accumulate) {
+			for (int j = 0; j < nr; j++) cr[j] += acc[i][j];
+		}
+		else {
+			for (int j = 0; j < nr; j++) cr[j] = acc[i][j];
+		}
+	}
+}
+
+// C[m0:m1, 0:N] = A[m0:m1, :] B (A 는 packA 형식, m0 은 kMR 배수, c 는 m0 행 위치)
+static void gemmBlock(const float* packed_a, int m0, int m1, int Kd, const float* b, int64_t ldb, int N, float* c, int64_t ldc)
+{
+	for (int p0 = 0; p0 < Kd; p0 += kKC) {
+		const int kc = std::min(kKC, Kd - p0);
+		for (int m = m0; m < m1; m += kMR) {
+			const float* a = packed_a + (int64_t)(m / kMR) * Kd * kMR + (int64_t)p0 * kMR;
+			for (int n = 0; n < N; n += kNR) {
+				microKernel(kc, a, b + p0 * ldb + n, ldb, c + (int64_t)(m - m0) * ldc + n, ldc, std::min(kMR, m1 - m), std::min(kNR, N - n), p0 > 0);
+			}
+		}
+	}
+}
+
+/* ------ Winograd ------ */
+
+// F(2x2,3x3)
+static const float kBT2[4 * 4] = {
+	1.f, 0.f, -1.f, 0.f,
+	0.f, 1.f, 1.f, 0.f,
+	0.f, -1.f, 1.f, 0.f,
+	0.f, 1.f, 0.f, -1.f,
+};
+static const float kG2[4 * 3] = {
+	1.f, 0.f, 0.f,
+	0.5f, 0.5f, 0.5f,
+	0.5f, -0.5f, 0.5f,
+	0.f, 0.f, 1.f,
+};
+static const float kAT2[2 * 4] = {
+	1.f, 1.f, 1.f, 0.f,
+	0.f, 1.f, -1.f, -1.f,
+};
+
+// F(4x4,3x3)
+static const float kBT4[6 * 6] = {
+	4.f, 0.f, -5.f, 0.f, 1.f, 0.f,
+	0.f, -4.f, -4.f, 1.f, 1.f, 0.f,
+	0.f, 4.f, -4.f, -1.f, 1.f, 0.f,
+	0.f, -2.f, -1.f, 2.f, 1.f, 0.f,
+	0.f, 2.f, -1.f, -2.f, 1.f, 0.f,
+	0.f, 4.f, 0.f, -5.f, 0.f, 1.f,
+};
+static const float kG4[6 * 3] = {
+	1.f / 4, 0.f, 0.f,
+	-1.f / 6, -1.f / 6, -1.f / 6,
+	-1.f / 6, 1.f / 6, -1.f / 6,
+	1.f / 24, 1.f / 12, 1.f / 6,
+	1.f / 24, -1.f / 12, 1.f / 6,
+	0.f, 0.f, 1.f,
+};
+static const float kAT4[4 * 6] = {
+	1.f, 1.f, 1.f, 1.f, 1.f, 0.f,
+	0.f, 1.f, -1.f, 2.f, -2.f, 0.f,
+	0.f, 1.f, 1.f, 4.f, 4.f, 0.f,
+	0.f, 1.f, -1.f, 8.f, -8.f, 1.f,
+};
+
+// Y[r, r] = L[r, n] X[n, n] L^T
+static inline void transform(const float* L, int r, int n, const float* X, float* Y)
+{
+	float tmp[6 * 6];
+	for (int i = 0; i < r; i++) {
+		for (int j = 0; j < n; j++) {
+			float s = 0.f;
+			for (int k = 0; k < n; k++) s += L[i * n + k] * X[k * n + j];
+			tmp[i * n + j] = s;
+		}
+	}
+	for (int i = 0; i < r; i++) {
+		for (int j = 0; j < r; j++) {
+			float s = 0.f;
+			for (int k = 0; k < n; k++) s += tmp[i * n + k] * L[j * n + k];
+			Y[i * r + j] = s;
+		}
+	}
+}
+
+/* ------ CpuConv ------ */
+
+CpuConv::CpuConv(const ConvShape& shape, const float* weights, const float* bias, ConvAlgo algo, const ConvActivation& activation)
+	: shape_(shape), algo_(algo == ConvAlgo::kAUTO ? chooseConvAlgo(shape) : algo), tile_(kNC), threads_(0), activation_(activation)
+{
+	const ConvShape& s = shape_;
+	assert(convSupports(s, algo_));
+	const int Cg = s.C / s.G, Kg = s.K / s.G, KK = s.KH * s.KW;
+	bias_.assign(s.K, 0.f);
+	if (bias) bias_.assign(bias, bias + s.K);
+
+	switch (algo_) {
+	case ConvAlgo::kGEMM_1X1:
+	case ConvAlgo::kIM2COL_GEMM: {
+		// 그룹별 [Kg, Cg * KH * KW] 를 kMR panel 로 정렬
+		const int Kd = Cg * KK;
+		const int64_t group_size = (int64_t)roundUp(Kg, kMR) * Kd;
+		weights_.resize(group_size * s.G);
+		for (int g = 0; g < s.G; g++) {
+			packA(weights + (int64_t)g * Kg * Kd, Kg, Kd, Kd, weights_.data() + g * group_size);
+		}
+		break;
+	}
+	case ConvAlgo::kDIRECT_NCHWC: {
+		// [K/8][Cg/8][KH][KW][8 (c)][8 (k)]
+		const int Kb = s.K / kCONV_BLOCK, Cgb = Cg / kCONV_BLOCK;
+		weights_.resize((size_t)s.K * Cg * KK);
+		for (int kb = 0; kb < Kb; kb++) {
+			for (int cb = 0; cb < Cgb; cb++) {
+				for (int r = 0; r < KK; r++) {
+					float* d = weights_.data() + (((int64_t)kb * Cgb + cb) * KK + r) * kCONV_BLOCK * kCONV_BLOCK;
+					for (int ci = 0; ci < kCONV_BLOCK; ci++) {
+						for (int ko = 0; ko < kCONV_BLOCK; ko++) {
+							d[ci * kCONV_BLOCK + ko] = weights[(((int64_t)kb * kCONV_BLOCK + ko) * Cg + cb * kCONV_BLOCK + ci) * KK + r];
+						}
+					}
+				}
+			}
+		}
+		break;
+	}
+	case ConvAlgo::kWINOGRAD_2X2:
+	case ConvAlgo::kWINOGRAD_4X4: {
+		// U = G g G^T, 변환 위치(xi)별 [K, C] 를 kMR panel 로 정렬
+		const bool f4 = algo_ == ConvAlgo::kWINOGRAD_4X4;
+		const int alpha = f4 ? 6 : 4, A2 = alpha * alpha;
+		std::vector<float> U((size_t)A2 * s.K * s.C);
+		for (int k = 0; k < s.K; k++) {
+			for (int c = 0; c < s.C; c++) {
+				float u[36];
+				transform(f4 ? kG4 : kG2, alpha, 3, weights + ((int64_t)k * s.C + c) * 9, u);
+				for (int xi = 0; xi < A2; xi++) U[((int64_t)xi * s.K + k) * s.C + c] = u[xi];
+			}
+		}
+		const int64_t xi_size = (int64_t)roundUp(s.K, kMR) * s.C;
+		weights_.resize(xi_size * A2);
+		for (int xi = 0; xi < A2; xi++) {
+			packA(U.data() + (int64_t)xi * s.K * s.C, s.K, s.C, s.C, weights_.data() + xi * xi_size);
+		}
+		break;
+	}
+	default:
+		weights_.assign(weights, weights + (size_t)s.K * Cg * KK);
+		break;
+	}
+}
+
+void CpuConv::setSchedule(int tile, int threads)
+{
+	tile_ = tile > 0 ? roundUp(tile, kNR) : kNC;
+	threads_ = threads;
+}
+
+// 0 이면 전체, 실행 시점의 최대값 (scheduler 가 준 core 수) 을 넘지 않음
+int CpuConv::threads() const
+{
+	return threads_ > 0 ? std::min(threads_, maxThreads()) : maxThreads();
+}
+
+// bias + activation (출력 채널 k 의 연속된 count 개)
+inline void CpuConv::finish(float* data, int count, int k) const
+{
+	const float b = bias_[k];
+	if (activation_.enabled) {
+		for (int i = 0; i < count; i++) data[i] = activate(data[i] + b, activation_.type, activation_.alpha, activation_.beta);
+	}
+	else if (b != 0.f) {
+		for (int i = 0; i < count; i++) data[i] += b;
+	}
+}
+
+void CpuConv::forward(const float* in, float* out) const
+{
+	switch (algo_) {
+	case ConvAlgo::kGEMM_1X1:
+	case ConvAlgo::kIM2COL_GEMM:
+		forwardGemm(in, out);
+		break;
+	case ConvAlgo::kDIRECT_NCHWC: {
+		const ConvShape& s = shape_;
+		std::vector<float> in_b((size_t)s.C * s.H * s.W), out_b((size_t)s.K * s.OH * s.OW);
+		nchwToNchwc(in, s.C, s.H * s.W, in_b.data());
+		forwardBlocked(in_b.data(), out_b.data());
+		nchwcToNchw(out_b.data(), s.K, s.OH * s.OW, out);
+		break;
+	}
+	case ConvAlgo::kWINOGRAD_2X2:
+	case ConvAlgo::kWINOGRAD_4X4:
+		forwardWinograd<FloatElement>(in, out);
+		break;
+	default:
+		forwardDirect(in, out);
+		break;
+	}
+}
+
+// 출력 채널 plane 단위 병렬, 가중치 하나를 출력 행 전체에 누적 (가장 안쪽 loop 는 연속 메모리)
+void CpuConv::forwardDirect(const float* in, float* out) const
+{
+	const ConvShape& s = shape_;
+	const int Cg = s.C / s.G, Kg = s.K / s.G;
+	const float* weights = weights_.data();
+	const int nt = threads();
+
+#pragma omp parallel for schedule(dynamic) num_threads(nt)
+	for (int k = 0; k < s.K; k++) {
+		const int g = k / Kg;
+		float* o = out + (int64_t)k * s.OH * s.OW;
+		std::fill(o, o + (int64_t)s.OH * s.OW, 0.f);
+		for (int c = 0; c < Cg; c++) {
+			const float* plane = in + (int64_t)(g * Cg + c) * s.H * s.W;
+			const float* wk = weights + ((int64_t)k * Cg + c) * s.KH * s.KW;
+			for (int kh = 0; kh < s.KH; kh++) {
+				for (int kw = 0; kw < s.KW; kw++) {
+					const float w = wk[kh * s.KW + kw];
+					const int offset_w = kw * s.DW - s.PW;
+					// iw = ow * SW + offset_w 가 [0, W) 인 ow 범위
+					const int ow0 = offset_w >= 0 ? 0 : (-offset_w + s.SW - 1) / s.SW;
+					const int ow1 = s.W - 1 - offset_w < 0 ? 0 : std::min(s.OW, (s.W - 1 - offset_w) / s.SW + 1);
+					for (int oh = 0; oh < s.OH; oh++) {
+						const int ih = oh * s.SH + kh * s.DH - s.PH;
+						if (ih < 0 || ih >= s.H) continue;
+						const float* row = plane + (int64_t)ih * s.W + offset_w;
+						float* orow = o + (int64_t)oh * s.OW;
+						if (s.SW == 1) {
+							for (int ow = ow0; ow < ow1; ow++) orow[ow] += w * row[ow];
+						}
+						else {
+							for (int ow = ow0; ow < ow1; ow++) orow[ow] += w * row[ow * s.SW];
+						}
+					}
+				}
+			}
+		}
+		finish(o, s.OH * s.OW, k);
+	}
+}
+
+// 출력 pixel tile [j0, j0 + nc) 의 im2col -> dst [Cg * KH * KW][ldd] (16 bit 입력은 읽으면서 float 로 변환)
+template <class E>
+static void im2col(const ConvShape& s, const typename E::type* in, int g, int j0, int nc, float* dst, int ldd)
+{
+	const int Cg = s.C / s.G, KK = s.KH * s.KW;
+	for (int p = 0; p < Cg * KK; p++) {
+		const int c = p / KK, kh = (p % KK) / s.KW, kw = p % s.KW;
+		const typename E::type* plane = in + (int64_t)(g * Cg + c) * s.H * s.W;
+		float* d = dst + (int64_t)p * ldd;
+		int oh = j0 / s.OW, ow = j0 % s.OW;
+		for (int j = 0; j < nc; j++) {
+			const int ih = oh * s.SH + kh * s.DH - s.PH;
+			const int iw = ow * s.SW + kw * s.DW - s.PW;
+			d[j] = (ih >= 0 && ih < s.H && iw >= 0 && iw < s.W) ? E::load(plane[(int64_t)ih * s.W + iw]) : 0.f;
+			if (++ow == s.OW) { ow = 0; oh++; }
+		}
+		for (int j = nc; j < roundUp(nc, kNR); j++) d[j] = 0.f;
+	}
+}
+
+// task = (group, 출력 pixel tile, 출력 채널 chunk), tile 마다 im2col 후 blocked GEMM
+void CpuConv::forwardGemm(const float* in, float* out) const
+{
+	const ConvShape& s = shape_;
+	const int Cg = s.C / s.G, Kg = s.K / s.G, Kd = Cg * s.KH * s.KW, P = s.OH * s.OW;
+	const int64_t group_size = (int64_t)roundUp(Kg, kMR) * Kd;
+	const int tile = tile_, tiles = divUp(P, tile), chunks = divUp(Kg, kMC);
+	const int tasks = s.G * tiles * chunks;
+	const bool direct_b = algo_ == ConvAlgo::kGEMM_1X1;
+	const int nt = threads();
+
+#pragma omp parallel num_threads(nt)
+	{
+		std::vector<float> col((size_t)Kd * tile);
+#pragma omp for schedule(dynamic)
+		for (int t = 0; t < tasks; t++) {
+			const int g = t / (tiles * chunks);
+			const int j0 = (t / chunks) % tiles * tile;
+			const int m0 = t % chunks * kMC, m1 = std::min(Kg, m0 + kMC);
+			const int nc = std::min(tile, P - j0);
+			const float* b;
+			int64_t ldb;
+			if (direct_b && j0 + roundUp(nc, kNR) <= P) {
+				// 1x1 : 입력 [Cg, HW] 를 그대로 B 로 사용
+				b = in + (int64_t)g * Cg * P + j0;
+				ldb = P;
+			}
+			else {
+				im2col<FloatElement>(s, in, g, j0, nc, col.data(), tile);
+				b = col.data();
+				ldb = tile;
+			}
+			float* c = out + (int64_t)(g * Kg + m0) * P + j0;
+			gemmBlock(weights_.data() + g * group_size, m0, m1, Kd, b, ldb, nc, c, P);
+			for (int m = m0; m < m1; m++) finish(c + (int64_t)(m - m0) * P, nc, g * Kg + m);
+		}
+	}
+}
+
+// 16 bit 입출력 : B 는 float 로 변환 (1x1 은 입력 행, 나머지는 im2col), GEMM 결과는 thread 별 float tile 에 받아서 finish 후 변환
+template <class E>
+void CpuConv::forwardGemmHalf(const uint16_t* in, uint16_t* out) const
+{
+	const ConvShape& s = shape_;
+	const int Cg = s.C / s.G, Kg = s.K / s.G, Kd = Cg * s.KH * s.KW, P = s.OH * s.OW;
+	const int64_t group_size = (int64_t)roundUp(Kg, kMR) * Kd;
+	const int tile = tile_, tiles = divUp(P, tile), chunks = divUp(Kg, kMC);
+	const int tasks = s.G * tiles * chunks;
+	const bool direct_b = algo_ == ConvAlgo::kGEMM_1X1;
+	const int nt = threads();
+
+#pragma omp parallel num_threads(nt)
+	{
+		std::vector<float> col((size_t)Kd * tile), acc((size_t)kMC * tile);
+#pragma omp for schedule(dynamic)
+		for (int t = 0; t < tasks; t++) {
+			const int g = t / (tiles * chunks);
+			const int j0 = (t / chunks) % tiles * tile;
+			const int m0 = t % chunks * kMC, m1 = std::min(Kg, m0 + kMC);
+			const int nc = std::min(tile, P - j0);
+			if (direct_b) {
+				for (int c = 0; c < Cg; c++) {
+					float* d = col.data() + (int64_t)c * tile;
+					E::toFloat(in + (int64_t)(g * Cg + c) * P + j0, d, nc);
+					std::fill(d + nc, d + roundUp(nc, kNR), 0.f);
+				}
+			}
+			else {
+				im2col<E>(s, in, g, j0, nc, col.data(), tile);
+			}
+			gemmBlock(weights_.data() + g * group_size, m0, m1, Kd, col.data(), tile, nc, acc.data(), tile);
+			for (int m = m0; m < m1; m++) {
+				float* c = acc.data() + (int64_t)(m - m0) * tile;
+				finish(c, nc, g * Kg + m);
+				E::fromFloat(c, out + (int64_t)(g * Kg + m) * P + j0, nc);
+			}
+		}
+	}
+}
+
+template <class E>
+void CpuConv::forwardHalf(const uint16_t* in, uint16_t* out) const
+{
+	switch (algo_) {
+	case ConvAlgo::kGEMM_1X1:
+	case ConvAlgo::kIM2COL_GEMM:
+		forwardGemmHalf<E>(in, out);
+		break;
+	case ConvAlgo::kWINOGRAD_2X2:
+	case ConvAlgo::kWINOGRAD_4X4:
+		forwardWinograd<E>(in, out);
+		break;
+	default: {
+		const ConvShape& s = shape_;
+		std::vector<float> in_f((size_t)s.C * s.H * s.W), out_f((size_t)s.K * s.OH * s.OW);
+		E::toFloat(in, in_f.data(), (int64_t)in_f.size());
+		forward(in_f.data(), out_f.data());
+		E::fromFloat(out_f.data(), out, (int64_t)out_f.size());
+		break;
+	}
+	}
+}
+
+void CpuConv::forwardHalf(const uint16_t* in, uint16_t* out, HalfFormat format) const
+{
+	if (format == HalfFormat::kFP16) forwardHalf<Fp16Element>(in, out);
+	else forwardHalf<Bf16Element>(in, out);
+}
+
+// 8 채널 block layout : task = (출력 채널 block, 출력 행), 출력 4 pixel x 8 채널을 register 에 누적
+void CpuConv::forwardBlocked(const float* in, float* out) const
+{
+	assert(algo_ == ConvAlgo::kDIRECT_NCHWC);
+	const ConvShape& s = shape_;
+	const int B = kCONV_BLOCK, OWT = 4;
+	const int Cgb = s.C / s.G / B, Kgb = s.K / s.G / B, Kb = s.K / B, KK = s.KH * s.KW;
+	const int nt = threads();
+
+#pragma omp parallel for schedule(static) num_threads(nt)
+	for (int t = 0; t < Kb * s.OH; t++) {
+		const int kb = t / s.OH, oh = t % s.OH;
+		const int cb0 = kb / Kgb * Cgb;	// 그룹의 첫 입력 채널 block
+		const float* wk = weights_.data() + (int64_t)kb * Cgb * KK * B * B;
+		float* orow = out + ((int64_t)kb * s.OH + oh) * s.OW * B;
+		for (int ow0 = 0; ow0 < s.OW; ow0 += OWT) {
+			const int nt = std::min(OWT, s.OW - ow0);
+			float acc[OWT][B];
+			for (int i = 0; i < OWT; i++) {
+				for (int ko = 0; ko < B; ko++) acc[i][ko] = 0.f;
+			}
+			for (int cb = 0; cb < Cgb; cb++) {
+				const float* plane = in + (int64_t)(cb0 + cb) * s.H * s.W * B;
+				for (int kh = 0; kh < s.KH; kh++) {
+					const int ih = oh * s.SH + kh * s.DH - s.PH;
+					if (ih < 0 || ih >= s.H) continue;
+					const float* row = plane + (int64_t)ih * s.W * B;
+					for (int kw = 0; kw < s.KW; kw++) {
+						const float* w = wk + ((int64_t)cb * KK + kh * s.KW + kw) * B * B;
+						for (int i = 0; i < nt; i++) {
+							const int iw = (ow0 + i) * s.SW + kw * s.DW - s.PW;
+							if (iw < 0 || iw >= s.W) continue;
+							const float* x = row + (int64_t)iw * B;
+							for (int ci = 0; ci < B; ci++) {
+								const float xv = x[ci];
+								for (int ko = 0; ko < B; ko++) acc[i][ko] += xv * w[ci * B + ko];
+							}
+						}
+					}
+				}
+			}
+			for (int i = 0; i < nt; i++) {
+				float* o = orow + (int64_t)(ow0 + i) * B;
+				for (int ko = 0; ko < B; ko++) {
+					const float v = acc[i][ko] + bias_[kb * B + ko];
+					o[ko] = activation_.enabled ? activate(v, activation_.type, activation_.alpha, activation_.beta) : v;
+				}
+			}
+		}
+	}
+}
+
+// task = (tile block, 출력 채널 chunk) : 입력 변환 -> 변환 위치별 GEMM -> 출력 변환
+// E : 입출력 원소 형식 (16 bit 는 tile 을 읽을 때와 출력 tile 을 쓸 때 변환)
+template <class E>
+void CpuConv::forwardWinograd(const typename E::type* in, typename E::type* out) const
+{
+	const ConvShape& s = shape_;
+	const bool f4 = algo_ == ConvAlgo::kWINOGRAD_4X4;
+	const int m = f4 ? 4 : 2, alpha = m + 2, A2 = alpha * alpha;
+	const float* BT = f4 ? kBT4 : kBT2;
+	const float* AT = f4 ? kAT4 : kAT2;
+	const int th = divUp(s.OH, m), tw = divUp(s.OW, m), T = th * tw;
+	const int blocks = divUp(T, kTB), chunks = divUp(s.K, kMC);
+	const int64_t xi_size = (int64_t)roundUp(s.K, kMR) * s.C;
+	const int nt = threads();
+
+#pragma omp parallel num_threads(nt)
+	{
+		std::vector<float> V((size_t)A2 * s.C * kTB);	// [xi][C][kTB]
+		std::vector<float> M((size_t)A2 * kMC * kTB);	// [xi][kMC][kTB]
+#pragma omp for schedule(dynamic)
+		for (int task = 0; task < blocks * chunks; task++) {
+			const int t0 = task / chunks * kTB, nt = std::min(kTB, T - t0);
+			const int m0 = task % chunks * kMC, m1 = std::min(s.K, m0 + kMC);
+
+			// 입력 tile 변환 V = B^T d B
+			for (int c = 0; c < s.C; c++) {
+				const typename E::type* plane = in + (int64_t)c * s.H * s.W;
+				for (int t = 0; t < kTB; t++) {
+					float d[36], v[36];
+					if (t < nt) {
+						const int ty = (t0 + t) / tw, tx = (t0 + t) % tw;
+						const int y0 = ty * m - s.PH, x0 = tx * m - s.PW;
+						for (int i = 0; i < alpha; i++) {
+							const int y = y0 + i;
+							for (int j = 0; j < alpha; j++) {
+								const int x = x0 + j;
+								d[i * alpha + j] = (y >= 0 && y < s.H && x >= 0 && x < s.W) ? E::load(plane[(int64_t)y * s.W + x]) : 0.f;
+							}
+						}
+						transform(BT, alpha, alpha, d, v);
+					}
+					else {
+						std::fill(v, v + A2, 0.f);
+					}
+					for (int xi = 0; xi < A2; xi++) V[((size_t)xi * s.C + c) * kTB + t] = v[xi];
+				}
+			}
+			// 변환 위치별 [K, C] x [C, tiles]
+			for (int xi = 0; xi < A2; xi++) {
+				gemmBlock(weights_.data() + xi * xi_size, m0, m1, s.C, V.data() + (size_t)xi * s.C * kTB, kTB, nt, M.data() + (size_t)xi * kMC * kTB, kTB);
+			}
+			// 출력 변환 Y = A^T M A, bias + activation
+			for (int k = m0; k < m1; k++) {
+				typename E::type* plane = out + (int64_t)k * s.OH * s.OW;
+				for (int t = 0; t < nt; t++) {
+					float mt[36], y[16];
+					for (int xi = 0; xi < A2; xi++) mt[xi] = M[((size_t)xi * kMC + (k - m0)) * kTB + t];
+					transform(AT, m, alpha, mt, y);
+					const int ty = (t0 + t) / tw, tx = (t0 + t) % tw;
+					for (int i = 0; i < m && ty * m + i < s.OH; i++) {
+						const int n = std::min(m, s.OW - tx * m);
+						float* r = y + i * m;
+						finish(r, n, k);
+						typename E::type* o = plane + (int64_t)(ty * m + i) * s.OW + tx * m;
+						for (int j = 0; j < n; j++) o[j] = E::store(r[j]);
+					}
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,115 @@
+﻿#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "cpu_half.hpp"
+#include "graph_ir.hpp"
+
+// activation 계산 (interpreter 의 activation 레이어, conv epilogue 공용)
+inline float activate(float x, ir::ActivationType type, float alpha, float beta)
+{
+	switch (type) {
+	case ir::ActivationType::kRELU: return x > 0.f ? x : 0.f;
+	case ir::ActivationType::kSIGMOID: return 1.f / (1.f + std::exp(-x));
+	case ir::ActivationType::kTANH: return std::tanh(x);
+	case ir::ActivationType::kLEAKY_RELU: return x > 0.f ? x : alpha * x;
+	case ir::ActivationType::kELU: return x > 0.f ? x : alpha * (std::exp(x) - 1.f);
+	case ir::ActivationType::kSELU: return beta * (x > 0.f ? x : alpha * (std::exp(x) - 1.f));
+	case ir::ActivationType::kSOFTSIGN: return x / (1.f + std::fabs(x));
+	case ir::ActivationType::kSOFTPLUS: return alpha * std::log(1.f + std::exp(beta * x));
+	case ir::ActivationType::kCLIP: return std::min(std::max(x, alpha), beta);
+	case ir::ActivationType::kSILU: return x / (1.f + std::exp(-x));
+	}
+	return x;
+}
+
+// CPU convolution 알고리즘
+enum class ConvAlgo {
+	kAUTO,
+	kDIRECT,		// NCHW direct (가중치 하나를 출력 행에 누적, 모든 shape, 검증 기준)
+	kGEMM_1X1,		// 1x1 stride 1 : 가중치 [K, C] x 입력 [C, HW] GEMM (입력을 그대로 사용)
+	kIM2COL_GEMM,	// 출력 tile 단위 im2col + blocked GEMM (모든 shape)
+	kDIRECT_NCHWC,	// 8 채널 block layout direct conv (그룹 당 입출력 채널이 8 의 배수)
+	kWINOGRAD_2X2,	// Winograd F(2x2,3x3) (3x3, stride 1, dilation 1, group 1)
+	kWINOGRAD_4X4,	// Winograd F(4x4,3x3)
+};
+const char* convAlgoName(ConvAlgo algo);
+
+// OpenMP 최대 thread 수 (OpenMP 없이 빌드하면 1), conv, gemm, int8, scheduler, kernel tuner 공용
+int maxThreads();
+
+static const int kCONV_BLOCK = 8;	// NCHWc 채널 block 크기
+
+// 1 sample 기준 convolution shape (padding 은 앞쪽, 출력 크기는 뒤쪽 padding 포함해서 계산된 값)
+struct ConvShape {
+	int C, H, W;	// 입력
+	int K, OH, OW;	// 출력
+	int KH, KW;
+	int SH, SW;
+	int PH, PW;
+	int DH, DW;
+	int G;
+};
+
+ConvShape convShapeOf(const ir::Layer& layer);
+int64_t convFlops(const ConvShape& shape);
+bool convSupports(const ConvShape& shape, ConvAlgo algo);
+// shape 기준 기본 알고리즘 (1x1 -> GEMM, 3x3 stride 1 -> Winograd, 나머지 -> im2col)
+ConvAlgo chooseConvAlgo(const ConvShape& shape);
+
+// conv 출력에 합쳐서 적용하는 activation (graph pass 의 fused_activation_)
+struct ConvActivation {
+	bool enabled;
+	ir::ActivationType type;
+	float alpha;
+	float beta;
+};
+
+// NCHW <-> NCHWc (C 는 kCONV_BLOCK 의 배수)
+void nchwToNchwc(const float* in, int C, int HW, float* out);
+void nchwcToNchw(const float* in, int C, int HW, float* out);
+
+//! \class CpuConv
+//!
+//! \brief 한 conv 레이어의 CPU 실행. 생성시 알고리즘에 맞게 가중치를 변환, 정렬해서 보관
+//!  forward 는 OpenMP 로 출력 tile 단위 병렬 실행, bias 와 activation 은 tile 계산 직후 적용
+//!
+class CpuConv
+{
+public:
+	// weights : [K, C/G, KH, KW], bias : K 개 (nullptr 이면 0)
+	CpuConv(const ConvShape& shape, const float* weights, const float* bias, ConvAlgo algo = ConvAlgo::kAUTO, const ConvActivation& activation = ConvActivation{ false, ir::ActivationType::kRELU, 0.f, 0.f });
+
+	// 1 sample, NCHW 입력 [C, H, W] -> 출력 [K, OH, OW]
+	void forward(const float* in, float* out) const;
+	// 1 sample, NCHWc 입출력 (kDIRECT_NCHWC 만)
+	void forwardBlocked(const float* in, float* out) const;
+	// 1 sample, 16 bit NCHW 입출력 (cpu_half.hpp), 계산과 누적은 float
+	// GEMM, Winograd 는 im2col / tile 변환에서 읽으면서 변환하고 출력 tile 은 bias, activation 후 변환, 나머지 알고리즘은 float 로 변환해서 forward
+	void forwardHalf(const uint16_t* in, uint16_t* out, HalfFormat format) const;
+
+	ConvAlgo algo() const { return algo_; }
+	const ConvShape& shape() const { return shape_; }
+	// tile : im2col 출력 pixel tile (GEMM 알고리즘만, 0 이면 기본값), threads : 최대 thread 수 (0 이면 전체)
+	// 가중치 정렬과 무관한 실행 설정 (kernel_tuner.hpp 가 shape 별로 선택)
+	void setSchedule(int tile, int threads);
+	int tile() const { return tile_; }
+
+private:
+	void forwardDirect(const float* in, float* out) const;
+	void forwardGemm(const float* in, float* out) const;
+	template <class E> void forwardWinograd(const typename E::type* in, typename E::type* out) const;
+	template <class E> void forwardGemmHalf(const uint16_t* in, uint16_t* out) const;
+	template <class E> void forwardHalf(const uint16_t* in, uint16_t* out) const;
+	void finish(float* data, int count, int k) const;
+	int threads() const;
+
+	ConvShape shape_;
+	ConvAlgo algo_;
+	int tile_;
+	int threads_;
+	ConvActivation activation_;
+	std::vector<float> weights_;	// 알고리즘별 변환된 가중치
+	std::vector<float> bias_;
+};
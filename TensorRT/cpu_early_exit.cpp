@@ -0,0 +1,111 @@
+﻿#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include "cpu_early_exit.hpp"
+#include "detr_postprocess.hpp"
+
+using namespace ir;
+
+EarlyExitRunner::EarlyExitRunner(CpuInterpreter& interpreter, const std::vector<std::vector<const Tensor*>>& stages)
+	: interpreter_(interpreter)
+{
+	assert(!interpreter.memoryPlanned());
+	const Network& network = interpreter.network();
+	const int nb_layers = network.getNbLayers();
+	std::vector<int> producer(network.getNbTensors(), -1);
+	for (int i = 0; i < nb_layers; i++) {
+		const Layer* l = network.getLayer(i);
+		for (int k = 0; k < l->getNbOutputs(); k++) producer[l->getOutput(k)->id()] = i;
+		if (!l->getOutput(0)->isBatched()) constants_.push_back(i);
+	}
+
+	// 출력에서 거꾸로 따라가며 아직 어느 단계에도 속하지 않은 레이어 표시
+	std::vector<int> stage_of(nb_layers, -1);
+	int layers = 0;
+	int64_t flops = 0;
+	for (int s = 0; s < (int)stages.size(); s++) {
+		std::vector<int> pending;
+		for (const Tensor* t : stages[s]) {
+			if (producer[t->id()] >= 0) pending.push_back(producer[t->id()]);
+		}
+		while (!pending.empty()) {
+			const int i = pending.back();
+			pending.pop_back();
+			if (stage_of[i] >= 0) continue;
+			stage_of[i] = s;
+			const Layer* l = network.getLayer(i);
+			for (int k = 0; k < l->getNbInputs(); k++) {
+				const int p = producer[l->getInput(k)->id()];
+				if (p >= 0 && stage_of[p] < 0) pending.push_back(p);
+			}
+		}
+		std::vector<int> order;
+		for (int i = 0; i < nb_layers; i++) {
+			if (stage_of[i] == s && network.getLayer(i)->getOutput(0)->isBatched()) order.push_back(i);
+		}
+		for (int i : order) flops += layerFlops(*network.getLayer(i));
+		layers += (int)order.size();
+		layers_.push_back(layers);
+		flops_.push_back(flops);
+		stages_.push_back(order);
+	}
+}
+
+int EarlyExitRunner::run(const std::function<bool(int)>& stop, int batchSize)
+{
+	interpreter_.beginRun(batchSize);
+	if (interpreter_.runCount() == 0) {
+		for (int i : constants_) interpreter_.runLayer(i);
+	}
+	int last = -1;
+	for (int s = 0; s < (int)stages_.size(); s++) {
+		for (int i : stages_[s]) interpreter_.runLayer(i);
+		last = s;
+		if (s + 1 < (int)stages_.size() && stop(s)) break;
+	}
+	interpreter_.endRun();
+	return last;
+}
+
+DetrExitCriterion::DetrExitCriterion(const DetrExitPolicy& policy, int num_queries, int num_class)
+	: policy_(policy), num_queries_(num_queries), num_class_(num_class), has_previous_(false),
+	score_(num_queries), label_(num_queries), box_((size_t)num_queries * 4), reason_(ExitReason::kNONE)
+{
+}
+
+void DetrExitCriterion::reset()
+{
+	has_previous_ = false;
+	reason_ = ExitReason::kNONE;
+}
+
+bool DetrExitCriterion::update(int exit, const float* scores, const float* boxes)
+{
+	const float thresh = policy_.score_thresh;
+	bool confident = true, stable = has_previous_;
+	int detected_count = 0;
+	for (int q = 0; q < num_queries_; q++) {
+		int label;
+		const float score = maxArgmax(scores + (size_t)q * num_class_, num_class_, label);
+		const float* box = boxes + (size_t)q * 4;
+		confident &= std::fabs(score - thresh) >= policy_.margin;
+		detected_count += score > thresh;
+		if (stable) {
+			const bool detected = score > thresh, was_detected = score_[q] > thresh;
+			if (detected != was_detected) stable = false;
+			else if (detected) {
+				float moved = 0.f;
+				for (int c = 0; c < 4; c++) moved = std::max(moved, std::fabs(box[c] - box_[(size_t)q * 4 + c]));
+				stable = label == label_[q] && std::fabs(score - score_[q]) < policy_.score_delta && moved < policy_.box_delta;
+			}
+		}
+		score_[q] = score;
+		label_[q] = label;
+		memcpy(&box_[(size_t)q * 4], box, 4 * sizeof(float));
+	}
+	has_previous_ = true;
+	confident &= detected_count > 0;	// 검출이 없는 exit 은 다음 exit 과 비교 (stable) 해서 확정
+	reason_ = confident ? ExitReason::kCONFIDENT : stable ? ExitReason::kSTABLE : ExitReason::kNONE;
+	return exit >= policy_.min_exit && reason_ != ExitReason::kNONE;
+}
@@ -0,0 +1,70 @@
+﻿#pragma once
+#include <functional>
+#include <vector>
+#include "cpu_interpreter.hpp"
+
+//! \class EarlyExitRunner
+//!
+//! \brief network 출력을 단계 (exit) 로 나눠 단계 순서대로 필요한 레이어만 실행, 판정 함수가 멈추라고 하면 남은 레이어 생략
+//!  단계 k 의 레이어 : 단계 k 출력을 계산하는 레이어 중 앞 단계에서 실행하지 않은 batch 레이어 (network 순서)
+//!  상수 부분 그래프는 첫 실행에서 전부 계산 (어느 단계에서 멈춰도 다음 실행의 상수가 준비됨)
+//!  뒤 단계가 앞 단계의 중간 텐서를 다시 읽으므로 interpreter 는 planMemory 없이 생성
+//!
+class EarlyExitRunner
+{
+public:
+	// stages : 단계별 출력 텐서 (마지막 단계는 보통 최종 출력)
+	EarlyExitRunner(CpuInterpreter& interpreter, const std::vector<std::vector<const ir::Tensor*>>& stages);
+
+	// 단계 k (마지막 제외) 출력 계산 후 stop(k) 호출, true 면 멈춤. 반환 : 마지막으로 실행한 단계
+	int run(const std::function<bool(int)>& stop, int batchSize = 1);
+
+	int nbStages() const { return (int)stages_.size(); }
+	// 단계 0 ~ k 를 실행할 때의 batch 레이어 수, 연산량 (batch 1)
+	int layersUpTo(int k) const { return layers_[k]; }
+	int64_t flopsUpTo(int k) const { return flops_[k]; }
+
+private:
+	CpuInterpreter& interpreter_;
+	std::vector<std::vector<int>> stages_;	// 단계별 레이어 index
+	std::vector<int> constants_;			// batch 와 무관한 레이어 (첫 실행에서만)
+	std::vector<int> layers_;
+	std::vector<int64_t> flops_;
+};
+
+// DETR 중간 예측 (scores [Q, K] softmax, boxes [Q, 4] cxcywh) 으로 early exit 판정
+struct DetrExitPolicy {
+	float score_thresh = 0.5f;	// 검출 기준 (detr_trt.cpp SCORE_THRESH)
+	float margin = 0.2f;		// confident : 검출이 있고 최대 점수가 score_thresh ± margin 안인 query 가 없음
+	float score_delta = 0.05f;	// stable : 앞 exit 와 검출 query, class 가 같고 점수 변화 < score_delta, box 변화 < box_delta
+	float box_delta = 0.02f;	// 정규화 좌표
+	int min_exit = 0;			// 이 exit (단계 index) 전에는 멈추지 않음
+};
+
+enum class ExitReason { kNONE, kCONFIDENT, kSTABLE };
+
+//! \class DetrExitCriterion
+//!
+//! \brief exit 마다 query 별 max / argmax 를 계산해서 confident 또는 stable 이면 멈춤
+//!  이미지마다 reset 후 exit 순서대로 update
+//!
+class DetrExitCriterion
+{
+public:
+	DetrExitCriterion(const DetrExitPolicy& policy, int num_queries, int num_class);
+
+	void reset();
+	// exit 단계 출력 확인, 멈춰도 되면 true
+	bool update(int exit, const float* scores, const float* boxes);
+	ExitReason reason() const { return reason_; }
+
+private:
+	DetrExitPolicy policy_;
+	int num_queries_;
+	int num_class_;
+	bool has_previous_;
+	std::vector<float> score_;		// [Q] 앞 exit 의 max 점수
+	std::vector<int> label_;		// [Q]
+	std::vector<float> box_;		// [Q, 4]
+	ExitReason reason_;
+};
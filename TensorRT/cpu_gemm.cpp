@@ -0,0 +1,521 @@
+﻿#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include "cpu_gemm.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define GEMM_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// 빌드 옵션 (/arch) 과 무관하게 kernel 함수 단위로 명령어 집합 지정 (MSVC 는 intrinsic 을 항상 사용 가능)
+#if defined(_MSC_VER) || !defined(GEMM_X86)
+#define GEMM_TARGET_AVX2
+#define GEMM_TARGET_AVX512
+#else
+#define GEMM_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define GEMM_TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+static const int kKC = 256;		// k 방향 block (B micro panel kKC x NR 이 L1 에 남는 크기)
+static const int kMC = 96;		// task 당 행 수 (packed A block 이 L2 에 남는 크기, 4, 6, 8 의 배수)
+static const int kNC = 512;		// task 당 최대 열 수
+
+static inline int divUp(int a, int b) { return (a + b - 1) / b; }
+static inline int roundUp(int a, int b) { return divUp(a, b) * b; }
+
+// 0 이면 전체, 실행 시점의 최대값 (scheduler 가 준 core 수) 을 넘지 않음
+static int threadLimit(int threads)
+{
+	return threads > 0 ? std::min(threads, maxThreads()) : maxThreads();
+}
+
+/* ------ 명령어 집합 선택 ------ */
+
+const char* gemmIsaName(GemmIsa isa)
+{
+	switch (isa) {
+	case GemmIsa::kSCALAR: return "scalar";
+	case GemmIsa::kAVX2: return "avx2";
+	case GemmIsa::kAVX512: return "avx512";
+	}
+	return "unknown";
+}
+
+#ifdef GEMM_X86
+static void cpuid(int leaf, int sub, unsigned regs[4])
+{
+#ifdef _MSC_VER
+	int r[4];
+	__cpuidex(r, leaf, sub);
+	for (int i = 0; i < 4; i++) regs[i] = (unsigned)r[i];
+#else
+	__cpuid_count(leaf, sub, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+// OS 가 저장, 복원하는 register 상태 (XCR0)
+static uint64_t xcr0()
+{
+#ifdef _MSC_VER
+	return _xgetbv(0);
+#else
+	uint32_t lo, hi;
+	__asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+	return ((uint64_t)hi << 32) | lo;
+#endif
+}
+#endif
+
+GemmIsa detectGemmIsa()
+{
+#ifdef GEMM_X86
+	unsigned r[4];
+	cpuid(0, 0, r);
+	const unsigned max_leaf = r[0];
+	cpuid(1, 0, r);
+	const bool osxsave = (r[2] >> 27) & 1, avx = (r[2] >> 28) & 1, fma = (r[2] >> 12) & 1;
+	if (!osxsave || !avx || max_leaf < 7) return GemmIsa::kSCALAR;
+	const uint64_t xcr = xcr0();
+	if ((xcr & 0x6) != 0x6) return GemmIsa::kSCALAR;	// XMM, YMM
+	cpuid(7, 0, r);
+	const bool avx2 = (r[1] >> 5) & 1, avx512f = (r[1] >> 16) & 1;
+	if (avx512f && (xcr & 0xE6) == 0xE6) return GemmIsa::kAVX512;	// + opmask, ZMM
+	if (avx2 && fma) return GemmIsa::kAVX2;
+#endif
+	return GemmIsa::kSCALAR;
+}
+
+std::string cpuModelName()
+{
+#ifdef GEMM_X86
+	unsigned r[4];
+	cpuid(0x80000000, 0, r);
+	if (r[0] >= 0x80000004) {
+		char brand[49] = {};
+		for (int i = 0; i < 3; i++) {
+			cpuid(0x80000002 + i, 0, r);
+			memcpy(brand + i * 16, r, 16);
+		}
+		std::string name(brand);
+		const size_t b = name.find_first_not_of(' '), e = name.find_last_not_of(' ');
+		if (b != std::string::npos) return name.substr(b, e - b + 1);
+	}
+#endif
+	return "unknown";
+}
+
+bool gemmIsaSupported(GemmIsa isa)
+{
+	return (int)isa <= (int)detectGemmIsa();
+}
+
+static GemmIsa& currentIsa()
+{
+	static GemmIsa isa = detectGemmIsa();
+	return isa;
+}
+
+GemmIsa gemmIsa()
+{
+	return currentIsa();
+}
+
+void setGemmIsa(GemmIsa isa)
+{
+	if (!gemmIsaSupported(isa)) {
+		std::cerr << "[ERROR] " << gemmIsaName(isa) << " is not supported on this CPU, keep " << gemmIsaName(currentIsa()) << std::endl;
+		return;
+	}
+	currentIsa() = isa;
+}
+
+/* ------ micro kernel ------ */
+
+// c[mr, nr] = (accumulate ? c : 0) + a[kc, MR]^T b[kc, NR] (+ bias[nr]) (ReLU)
+// a : packed A panel, b : packed B panel (행 간격 NR), bias 는 NR 개를 읽을 수 있어야 함
+typedef void (*MicroKernel)(int kc, const float* a, const float* b, float* c, int64_t ldc, int mr, int nr, bool accumulate, const float* bias, bool relu);
+// c[nr] = a[K] panel[K, NR] (+ bias) (ReLU)
+typedef void (*GemvKernel)(int K, const float* a, const float* panel, float* c, int nr, const float* bias, bool relu);
+
+struct GemmKernels {
+	int mr, nr;
+	MicroKernel micro;
+	GemvKernel gemv;
+};
+
+// register tile 결과 (tile[MR][NR]) 를 c 에 저장 (누적, bias, ReLU)
+template <int MR, int NR>
+static inline void storeTile(const float* tile, float* c, int64_t ldc, int mr, int nr, bool accumulate, const float* bias, bool relu)
+{
+	for (int i = 0; i < mr; i++) {
+		const float* t = tile + i * NR;
+		float* cr = c + i * ldc;
+		for (int j = 0; j < nr; j++) {
+			float v = t[j];
+			if (accumulate) v += cr[j];
+			if (bias) v += bias[j];
+			if (relu) v = std::max(v, 0.f);
+			cr[j] = v;
+		}
+	}
+}
+
+static void microScalar(int kc, const float* a, const float* b, float* c, int64_t ldc, int mr, int nr, bool accumulate, const float* bias, bool relu)
+{
+	const int MR = 4, NR = 8;
+	float acc[MR * NR];
+	for (int i = 0; i < MR * NR; i++) acc[i] = 0.f;
+	for (int p = 0; p < kc; p++) {
+		const float* bp = b + p * NR;
+		for (int i = 0; i < MR; i++) {
+			const float av = a[p * MR + i];
+			for (int j = 0; j < NR; j++) acc[i * NR + j] += av * bp[j];
+		}
+	}
+	storeTile<4, 8>(acc, c, ldc, mr, nr, accumulate, bias, relu);
+}
+
+static void gemvScalar(int K, const float* a, const float* panel, float* c, int nr, const float* bias, bool relu)
+{
+	const int NR = 8;
+	float acc[NR];
+	for (int j = 0; j < NR; j++) acc[j] = 0.f;
+	for (int k = 0; k < K; k++) {
+		const float av = a[k];
+		const float* p = panel + k * NR;
+		for (int j = 0; j < NR; j++) acc[j] += av * p[j];
+	}
+	storeTile<1, 8>(acc, c, 0, 1, nr, false, bias, relu);
+}
+
+#ifdef GEMM_X86
+// AVX2 : 6 x 16 누적 (ymm 12 개) + B 2 + A broadcast 1
+GEMM_TARGET_AVX2 static void microAvx2(int kc, const float* a, const float* b, float* c, int64_t ldc, int mr, int nr, bool accumulate, const float* bias, bool relu)
+{
+	const int MR = 6, NR = 16;
+	__m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps(), c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+	__m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps(), c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+	__m256 c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps(), c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+	for (int p = 0; p < kc; p++) {
+		const __m256 b0 = _mm256_loadu_ps(b + p * NR), b1 = _mm256_loadu_ps(b + p * NR + 8);
+		const float* ap = a + p * MR;
+		__m256 av = _mm256_broadcast_ss(ap + 0);
+		c00 = _mm256_fmadd_ps(av, b0, c00); c01 = _mm256_fmadd_ps(av, b1, c01);
+		av = _mm256_broadcast_ss(ap + 1);
+		c10 = _mm256_fmadd_ps(av, b0, c10); c11 = _mm256_fmadd_ps(av, b1, c11);
+		av = _mm256_broadcast_ss(ap + 2);
+		c20 = _mm256_fmadd_ps(av, b0, c20); c21 = _mm256_fmadd_ps(av, b1, c21);
+		av = _mm256_broadcast_ss(ap + 3);
+		c30 = _mm256_fmadd_ps(av, b0, c30); c31 = _mm256_fmadd_ps(av, b1, c31);
+		av = _mm256_broadcast_ss(ap + 4);
+		c40 = _mm256_fmadd_ps(av, b0, c40); c41 = _mm256_fmadd_ps(av, b1, c41);
+		av = _mm256_broadcast_ss(ap + 5);
+		c50 = _mm256_fmadd_ps(av, b0, c50); c51 = _mm256_fmadd_ps(av, b1, c51);
+	}
+	float tile[MR * NR];
+	_mm256_storeu_ps(tile + 0, c00); _mm256_storeu_ps(tile + 8, c01);
+	_mm256_storeu_ps(tile + 16, c10); _mm256_storeu_ps(tile + 24, c11);
+	_mm256_storeu_ps(tile + 32, c20); _mm256_storeu_ps(tile + 40, c21);
+	_mm256_storeu_ps(tile + 48, c30); _mm256_storeu_ps(tile + 56, c31);
+	_mm256_storeu_ps(tile + 64, c40); _mm256_storeu_ps(tile + 72, c41);
+	_mm256_storeu_ps(tile + 80, c50); _mm256_storeu_ps(tile + 88, c51);
+	if (mr < MR || nr < NR) {
+		storeTile<6, 16>(tile, c, ldc, mr, nr, accumulate, bias, relu);
+		return;
+	}
+	const __m256 zero = _mm256_setzero_ps();
+	for (int i = 0; i < MR; i++) {
+		float* cr = c + i * ldc;
+		for (int j = 0; j < NR; j += 8) {
+			__m256 v = _mm256_loadu_ps(tile + i * NR + j);
+			if (accumulate) v = _mm256_add_ps(v, _mm256_loadu_ps(cr + j));
+			if (bias) v = _mm256_add_ps(v, _mm256_loadu_ps(bias + j));
+			if (relu) v = _mm256_max_ps(v, zero);
+			_mm256_storeu_ps(cr + j, v);
+		}
+	}
+}
+
+// k 4 개씩 서로 다른 누적 register 에 더해서 FMA latency 를 숨김
+GEMM_TARGET_AVX2 static void gemvAvx2(int K, const float* a, const float* panel, float* c, int nr, const float* bias, bool relu)
+{
+	const int NR = 16;
+	__m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps(), s2 = _mm256_setzero_ps(), s3 = _mm256_setzero_ps();
+	__m256 s4 = _mm256_setzero_ps(), s5 = _mm256_setzero_ps(), s6 = _mm256_setzero_ps(), s7 = _mm256_setzero_ps();
+	int k = 0;
+	for (; k + 4 <= K; k += 4) {
+		const float* p = panel + k * NR;
+		const __m256 a0 = _mm256_broadcast_ss(a + k), a1 = _mm256_broadcast_ss(a + k + 1);
+		const __m256 a2 = _mm256_broadcast_ss(a + k + 2), a3 = _mm256_broadcast_ss(a + k + 3);
+		s0 = _mm256_fmadd_ps(a0, _mm256_loadu_ps(p), s0); s1 = _mm256_fmadd_ps(a0, _mm256_loadu_ps(p + 8), s1);
+		s2 = _mm256_fmadd_ps(a1, _mm256_loadu_ps(p + 16), s2); s3 = _mm256_fmadd_ps(a1, _mm256_loadu_ps(p + 24), s3);
+		s4 = _mm256_fmadd_ps(a2, _mm256_loadu_ps(p + 32), s4); s5 = _mm256_fmadd_ps(a2, _mm256_loadu_ps(p + 40), s5);
+		s6 = _mm256_fmadd_ps(a3, _mm256_loadu_ps(p + 48), s6); s7 = _mm256_fmadd_ps(a3, _mm256_loadu_ps(p + 56), s7);
+	}
+	for (; k < K; k++) {
+		const float* p = panel + k * NR;
+		const __m256 av = _mm256_broadcast_ss(a + k);
+		s0 = _mm256_fmadd_ps(av, _mm256_loadu_ps(p), s0); s1 = _mm256_fmadd_ps(av, _mm256_loadu_ps(p + 8), s1);
+	}
+	float tile[NR];
+	_mm256_storeu_ps(tile, _mm256_add_ps(_mm256_add_ps(s0, s2), _mm256_add_ps(s4, s6)));
+	_mm256_storeu_ps(tile + 8, _mm256_add_ps(_mm256_add_ps(s1, s3), _mm256_add_ps(s5, s7)));
+	storeTile<1, 16>(tile, c, 0, 1, nr, false, bias, relu);
+}
+
+// AVX-512 : 8 x 32 누적 (zmm 16 개) + B 2 + A broadcast 1
+GEMM_TARGET_AVX512 static void microAvx512(int kc, const float* a, const float* b, float* c, int64_t ldc, int mr, int nr, bool accumulate, const float* bias, bool relu)
+{
+	const int MR = 8, NR = 32;
+	__m512 c00 = _mm512_setzero_ps(), c01 = _mm512_setzero_ps(), c10 = _mm512_setzero_ps(), c11 = _mm512_setzero_ps();
+	__m512 c20 = _mm512_setzero_ps(), c21 = _mm512_setzero_ps(), c30 = _mm512_setzero_ps(), c31 = _mm512_setzero_ps();
+	__m512 c40 = _mm512_setzero_ps(), c41 = _mm512_setzero_ps(), c50 = _mm512_setzero_ps(), c51 = _mm512_setzero_ps();
+	__m512 c60 = _mm512_setzero_ps(), c61 = _mm512_setzero_ps(), c70 = _mm512_setzero_ps(), c71 = _mm512_setzero_ps();
+	for (int p = 0; p < kc; p++) {
+		const __m512 b0 = _mm512_loadu_ps(b + p * NR), b1 = _mm512_loadu_ps(b + p * NR + 16);
+		const float* ap = a + p * MR;
+		__m512 av = _mm512_set1_ps(ap[0]);
+		c00 = _mm512_fmadd_ps(av, b0, c00); c01 = _mm512_fmadd_ps(av, b1, c01);
+		av = _mm512_set1_ps(ap[1]);
+		c10 = _mm512_fmadd_ps(av, b0, c10); c11 = _mm512_fmadd_ps(av, b1, c11);
+		av = _mm512_set1_ps(ap[2]);
+		c20 = _mm512_fmadd_ps(av, b0, c20); c21 = _mm512_fmadd_ps(av, b1, c21);
+		av = _mm512_set1_ps(ap[3]);
+		c30 = _mm512_fmadd_ps(av, b0, c30); c31 = _mm512_fmadd_ps(av, b1, c31);
+		av = _mm512_set1_ps(ap[4]);
+		c40 = _mm512_fmadd_ps(av, b0, c40); c41 = _mm512_fmadd_ps(av, b1, c41);
+		av = _mm512_set1_ps(ap[5]);
+		c50 = _mm512_fmadd_ps(av, b0, c50); c51 = _mm512_fmadd_ps(av, b1, c51);
+		av = _mm512_set1_ps(ap[6]);
+		c60 = _mm512_fmadd_ps(av, b0, c60); c61 = _mm512_fmadd_ps(av, b1, c61);
+		av = _mm512_set1_ps(ap[7]);
+		c70 = _mm512_fmadd_ps(av, b0, c70); c71 = _mm512_fmadd_ps(av, b1, c71);
+	}
+	float tile[MR * NR];
+	_mm512_storeu_ps(tile + 0, c00); _mm512_storeu_ps(tile + 16, c01);
+	_mm512_storeu_ps(tile + 32, c10); _mm512_storeu_ps(tile + 48, c11);
+	_mm512_storeu_ps(tile + 64, c20); _mm512_storeu_ps(tile + 80, c21);
+	_mm512_storeu_ps(tile + 96, c30); _mm512_storeu_ps(tile + 112, c31);
+	_mm512_storeu_ps(tile + 128, c40); _mm512_storeu_ps(tile + 144, c41);
+	_mm512_storeu_ps(tile + 160, c50); _mm512_storeu_ps(tile + 176, c51);
+	_mm512_storeu_ps(tile + 192, c60); _mm512_storeu_ps(tile + 208, c61);
+	_mm512_storeu_ps(tile + 224, c70); _mm512_storeu_ps(tile + 240, c71);
+	if (mr < MR || nr < NR) {
+		storeTile<8, 32>(tile, c, ldc, mr, nr, accumulate, bias, relu);
+		return;
+	}
+	const __m512 zero = _mm512_setzero_ps();
+	for (int i = 0; i < MR; i++) {
+		float* cr = c + i * ldc;
+		for (int j = 0; j < NR; j += 16) {
+			__m512 v = _mm512_loadu_ps(tile + i * NR + j);
+			if (accumulate) v = _mm512_add_ps(v, _mm512_loadu_ps(cr + j));
+			if (bias) v = _mm512_add_ps(v, _mm512_loadu_ps(bias + j));
+			if (relu) v = _mm512_max_ps(v, zero);
+			_mm512_storeu_ps(cr + j, v);
+		}
+	}
+}
+
+GEMM_TARGET_AVX512 static void gemvAvx512(int K, const float* a, const float* panel, float* c, int nr, const float* bias, bool relu)
+{
+	const int NR = 32;
+	__m512 s0 = _mm512_setzero_ps(), s1 = _mm512_setzero_ps(), s2 = _mm512_setzero_ps(), s3 = _mm512_setzero_ps();
+	__m512 s4 = _mm512_setzero_ps(), s5 = _mm512_setzero_ps(), s6 = _mm512_setzero_ps(), s7 = _mm512_setzero_ps();
+	int k = 0;
+	for (; k + 4 <= K; k += 4) {
+		const float* p = panel + k * NR;
+		const __m512 a0 = _mm512_set1_ps(a[k]), a1 = _mm512_set1_ps(a[k + 1]);
+		const __m512 a2 = _mm512_set1_ps(a[k + 2]), a3 = _mm512_set1_ps(a[k + 3]);
+		s0 = _mm512_fmadd_ps(a0, _mm512_loadu_ps(p), s0); s1 = _mm512_fmadd_ps(a0, _mm512_loadu_ps(p + 16), s1);
+		s2 = _mm512_fmadd_ps(a1, _mm512_loadu_ps(p + 32), s2); s3 = _mm512_fmadd_ps(a1, _mm512_loadu_ps(p + 48), s3);
+		s4 = _mm512_fmadd_ps(a2, _mm512_loadu_ps(p + 64), s4); s5 = _mm512_fmadd_ps(a2, _mm512_loadu_ps(p + 80), s5);
+		s6 = _mm512_fmadd_ps(a3, _mm512_loadu_ps(p + 96), s6); s7 = _mm512_fmadd_ps(a3, _mm512_loadu_ps(p + 112), s7);
+	}
+	for (; k < K; k++) {
+		const float* p = panel + k * NR;
+		const __m512 av = _mm512_set1_ps(a[k]);
+		s0 = _mm512_fmadd_ps(av, _mm512_loadu_ps(p), s0); s1 = _mm512_fmadd_ps(av, _mm512_loadu_ps(p + 16), s1);
+	}
+	float tile[NR];
+	_mm512_storeu_ps(tile, _mm512_add_ps(_mm512_add_ps(s0, s2), _mm512_add_ps(s4, s6)));
+	_mm512_storeu_ps(tile + 16, _mm512_add_ps(_mm512_add_ps(s1, s3), _mm512_add_ps(s5, s7)));
+	storeTile<1, 32>(tile, c, 0, 1, nr, false, bias, relu);
+}
+#endif
+
+static const GemmKernels& kernelsOf(GemmIsa isa)
+{
+	static const GemmKernels scalar{ 4, 8, microScalar, gemvScalar };
+#ifdef GEMM_X86
+	static const GemmKernels avx2{ 6, 16, microAvx2, gemvAvx2 };
+	static const GemmKernels avx512{ 8, 32, microAvx512, gemvAvx512 };
+	if (isa == GemmIsa::kAVX512) return avx512;
+	if (isa == GemmIsa::kAVX2) return avx2;
+#endif
+	return scalar;
+}
+
+/* ------ packing, driver ------ */
+
+// B[K, N] (stride sbk, sbn) -> NR 열 panel [N/NR][K][NR] (남는 열은 0)
+static void packB(const float* b, int K, int N, int64_t sbk, int64_t sbn, int nr, float* dst)
+{
+	const int panels = divUp(N, nr);
+#pragma omp parallel for schedule(static)
+	for (int np = 0; np < panels; np++) {
+		float* d = dst + (int64_t)np * K * nr;
+		const int n0 = np * nr, cols = std::min(nr, N - n0);
+		for (int k = 0; k < K; k++) {
+			const float* src = b + k * sbk + n0 * sbn;
+			float* dk = d + (int64_t)k * nr;
+			if (sbn == 1) memcpy(dk, src, cols * sizeof(float));
+			else for (int j = 0; j < cols; j++) dk[j] = src[j * sbn];
+			for (int j = cols; j < nr; j++) dk[j] = 0.f;
+		}
+	}
+}
+
+// A[m0:m1, p0:p0+kc] -> MR 행 panel [rows/MR][kc][MR] (남는 행은 0)
+static void packA(const float* a, int64_t sam, int64_t sak, int m0, int m1, int p0, int kc, int mr, float* dst)
+{
+	for (int mp = 0; mp < divUp(m1 - m0, mr); mp++) {
+		float* d = dst + (int64_t)mp * kc * mr;
+		for (int i = 0; i < mr; i++) {
+			const int m = m0 + mp * mr + i;
+			if (m >= m1) {
+				for (int p = 0; p < kc; p++) d[p * mr + i] = 0.f;
+				continue;
+			}
+			const float* src = a + m * sam + p0 * sak;
+			for (int p = 0; p < kc; p++) d[p * mr + i] = src[p * sak];
+		}
+	}
+}
+
+// relu 이외의 activation 은 tile 저장 후 별도 적용
+static void applyActivation(const ConvActivation& act, float* c, int64_t ldc, int rows, int cols)
+{
+	for (int i = 0; i < rows; i++) {
+		float* cr = c + i * ldc;
+		for (int j = 0; j < cols; j++) cr[j] = activate(cr[j], act.type, act.alpha, act.beta);
+	}
+}
+
+// C[m0:m1, panel np0:np1] = A B (+ bias) (activation), panel np 는 packed_b + np * panel_stride (행 간격 NR)
+// abuf : kMC x kKC, accumulate 면 기존 C 에 더함
+static void gemmTask(const GemmKernels& k, int m0, int m1, int np0, int np1, int N, int K, const float* a, int64_t sam, int64_t sak,
+	const float* packed_b, int64_t panel_stride, const float* bias, const ConvActivation& act, bool accumulate, float* c, int64_t ldc, float* abuf)
+{
+	const bool relu = act.enabled && act.type == ir::ActivationType::kRELU;
+	for (int p0 = 0; p0 < K; p0 += kKC) {
+		const int kc = std::min(kKC, K - p0);
+		const bool last = p0 + kc == K;
+		packA(a, sam, sak, m0, m1, p0, kc, k.mr, abuf);
+		for (int np = np0; np < np1; np++) {
+			const int n0 = np * k.nr, nr = std::min(k.nr, N - n0);
+			const float* bp = packed_b + np * panel_stride + (int64_t)p0 * k.nr;
+			for (int m = m0; m < m1; m += k.mr) {
+				k.micro(kc, abuf + (int64_t)(m - m0) * kc, bp, c + m * ldc + n0, ldc, std::min(k.mr, m1 - m), nr,
+					accumulate || p0 > 0, last && bias ? bias + n0 : nullptr, last && relu);
+			}
+		}
+	}
+	if (act.enabled && !relu) {
+		const int n0 = np0 * k.nr, n1 = std::min(N, np1 * k.nr);
+		applyActivation(act, c + m0 * ldc + n0, ldc, m1 - m0, n1 - n0);
+	}
+}
+
+// C[M, N] = A B (+ bias) (activation), B 는 packB 형식
+// M == 1 : panel 단위 GEMV, 그 외 : task = (MC 행 block, panel 묶음), task 수가 thread 수의 2 배 이상이 되도록 열 방향 분할
+static void gemmPacked(const GemmKernels& k, int M, int N, int K, const float* a, int64_t sam, int64_t sak, const float* packed_b,
+	const float* bias, const ConvActivation& act, float* c, int64_t ldc, int threads = 0)
+{
+	const int panels = divUp(N, k.nr);
+	const int nt = threadLimit(threads);
+	if (M == 1 && sak == 1) {
+		const bool relu = act.enabled && act.type == ir::ActivationType::kRELU;
+#pragma omp parallel for schedule(static) num_threads(nt)
+		for (int np = 0; np < panels; np++) {
+			const int n0 = np * k.nr, nr = std::min(k.nr, N - n0);
+			k.gemv(K, a, packed_b + (int64_t)np * K * k.nr, c + n0, nr, bias ? bias + n0 : nullptr, relu);
+			if (act.enabled && !relu) applyActivation(act, c + n0, 0, 1, nr);
+		}
+		return;
+	}
+
+	const int mc = roundUp(std::min(M, kMC), k.mr);
+	const int mblocks = divUp(M, mc);
+	const int splits = std::max(1, divUp(2 * nt, mblocks));
+	const int task_panels = std::max(1, std::min(kNC / k.nr, divUp(panels, splits)));
+	const int nblocks = divUp(panels, task_panels);
+	const int tasks = mblocks * nblocks;
+
+#pragma omp parallel num_threads(nt)
+	{
+		std::vector<float> abuf((size_t)mc * std::min(K, kKC));
+#pragma omp for schedule(dynamic)
+		for (int t = 0; t < tasks; t++) {
+			const int m0 = t / nblocks * mc, m1 = std::min(M, m0 + mc);
+			const int np0 = t % nblocks * task_panels, np1 = std::min(panels, np0 + task_panels);
+			gemmTask(k, m0, m1, np0, np1, N, K, a, sam, sak, packed_b, (int64_t)K * k.nr, bias, act, false, c, ldc, abuf.data());
+		}
+	}
+}
+
+static const ConvActivation kNO_ACTIVATION{ false, ir::ActivationType::kRELU, 0.f, 0.f };
+
+void gemm(int M, int N, int K, const float* a, int64_t sam, int64_t sak, const float* b, int64_t sbk, int64_t sbn, float* c, int64_t ldc, GemmIsa isa)
+{
+	const GemmKernels& k = kernelsOf(isa);
+	std::vector<float> packed((size_t)roundUp(N, k.nr) * K);
+	packB(b, K, N, sbk, sbn, k.nr, packed.data());
+	gemmPacked(k, M, N, K, a, sam, sak, packed.data(), nullptr, kNO_ACTIVATION, c, ldc);
+}
+
+int gemmPanelWidth(GemmIsa isa)
+{
+	return kernelsOf(isa).nr;
+}
+
+void packGemmB(const float* b, int K, int N, int64_t sbk, int64_t sbn, float* dst, GemmIsa isa)
+{
+	packB(b, K, N, sbk, sbn, kernelsOf(isa).nr, dst);
+}
+
+void gemmSerial(int M, int N, int K, const float* a, int64_t sam, int64_t sak, const float* packedB, int64_t panelStride, float* c, int64_t ldc, bool accumulate, GemmIsa isa)
+{
+	const GemmKernels& k = kernelsOf(isa);
+	const int mc = roundUp(std::min(M, kMC), k.mr);
+	std::vector<float> abuf((size_t)mc * std::min(K, kKC));
+	for (int m0 = 0; m0 < M; m0 += mc) {
+		gemmTask(k, m0, std::min(M, m0 + mc), 0, divUp(N, k.nr), N, K, a, sam, sak, packedB, panelStride, nullptr, kNO_ACTIVATION, accumulate, c, ldc, abuf.data());
+	}
+}
+
+CpuGemm::CpuGemm(int N, int K, const float* weights, const float* bias, const ConvActivation& activation, GemmIsa isa)
+	: N_(N), K_(K), isa_(isa), threads_(0), activation_(activation)
+{
+	const int nr = kernelsOf(isa).nr;
+	packed_.resize((size_t)roundUp(N, nr) * K);
+	packB(weights, K, N, 1, K, nr, packed_.data());	// W[N, K] = B^T
+	if (bias) {
+		bias_.assign(bias, bias + N);
+		bias_.resize(roundUp(N, nr), 0.f);
+	}
+}
+
+void CpuGemm::run(int M, const float* in, float* out) const
+{
+	gemmPacked(kernelsOf(isa_), M, N_, K_, in, K_, 1, packed_.data(), bias_.empty() ? nullptr : bias_.data(), activation_, out, N_, threads_);
+}
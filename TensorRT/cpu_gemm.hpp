@@ -0,0 +1,63 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "cpu_conv.hpp"
+
+// GEMM micro kernel 명령어 집합 (실행 중 CPUID 로 선택)
+enum class GemmIsa {
+	kSCALAR,	// 4 x 8 C++ kernel (compiler 자동 vectorize, 모든 CPU)
+	kAVX2,		// AVX2 + FMA 6 x 16
+	kAVX512,	// AVX-512F 8 x 32
+};
+const char* gemmIsaName(GemmIsa isa);
+// CPU, OS 가 지원하는 가장 넓은 명령어 집합
+GemmIsa detectGemmIsa();
+bool gemmIsaSupported(GemmIsa isa);
+// CPUID brand string (x86 이외는 "unknown")
+std::string cpuModelName();
+// 이후 생성되는 CpuGemm, gemm() 의 기본 명령어 집합 (기본값 detectGemmIsa())
+GemmIsa gemmIsa();
+void setGemmIsa(GemmIsa isa);
+
+// C[M, N] = A[M, K] B[K, N], a[m, k] = a[m * sam + k * sak], b[k, n] = b[k * sbk + n * sbn] (transpose 는 stride 로 표현)
+// B 는 호출마다 panel 로 정렬 (attention 처럼 B 가 상수가 아닌 matmul 용)
+void gemm(int M, int N, int K, const float* a, int64_t sam, int64_t sak, const float* b, int64_t sbk, int64_t sbn, float* c, int64_t ldc, GemmIsa isa = gemmIsa());
+
+// 이미 병렬 영역 안에서 작은 행렬을 여러번 곱하는 경우 (attention 의 tile) : B 를 한번 panel 로 정렬하고 단일 thread 로 곱함
+// packGemmB : B[K, N] -> [N/NR][K][NR] (dst 는 roundUp(N, NR) * K 개), panel 일부 행 [k0, k0 + K') 만 곱할 때는 packedB 를 k0 * NR 만큼 이동
+// gemmSerial : C[M, N] (+)= A B, panel np 는 packedB + np * panelStride
+int gemmPanelWidth(GemmIsa isa = gemmIsa());
+void packGemmB(const float* b, int K, int N, int64_t sbk, int64_t sbn, float* dst, GemmIsa isa = gemmIsa());
+void gemmSerial(int M, int N, int K, const float* a, int64_t sam, int64_t sak, const float* packedB, int64_t panelStride, float* c, int64_t ldc, bool accumulate, GemmIsa isa = gemmIsa());
+
+//! \class CpuGemm
+//!
+//! \brief fully connected 레이어용 GEMM. 가중치 [N, K] 를 생성시 micro kernel 열 폭 panel [N/NR][K][NR] 로 정렬해서 보관
+//!  run 은 out[M, N] = in[M, K] W^T + bias, bias 와 ReLU 는 micro kernel 저장 단계에서 적용
+//!  M == 1 은 panel 단위 GEMV (N 방향 병렬), 그 외는 (M, N) block task 병렬
+//!
+class CpuGemm
+{
+public:
+	// weights : [N, K] row-major (TensorRT fully connected 형식), bias : N 개 (nullptr 이면 0)
+	CpuGemm(int N, int K, const float* weights, const float* bias, const ConvActivation& activation = ConvActivation{ false, ir::ActivationType::kRELU, 0.f, 0.f }, GemmIsa isa = gemmIsa());
+
+	// in : [M, K] (행 간격 K), out : [M, N] (행 간격 N)
+	void run(int M, const float* in, float* out) const;
+
+	GemmIsa isa() const { return isa_; }
+	// run 의 최대 thread 수 (0 이면 전체, kernel_tuner.hpp 가 shape 별로 선택)
+	void setThreads(int threads) { threads_ = threads; }
+	int threads() const { return threads_; }
+	int rows() const { return N_; }
+	int depth() const { return K_; }
+
+private:
+	int N_, K_;
+	GemmIsa isa_;
+	int threads_;
+	ConvActivation activation_;
+	std::vector<float> packed_;		// [N/NR][K][NR] (남는 열은 0)
+	std::vector<float> bias_;		// NR 배수 길이 (0 채움)
+};
@@ -0,0 +1,197 @@
+﻿#include <iostream>
+#include "cpu_gemm.hpp"
+#include "cpu_half.hpp"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define HALF_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// 빌드 옵션 (/arch) 과 무관하게 함수 단위로 명령어 집합 지정 (cpu_gemm.cpp 와 같은 방식)
+#if defined(_MSC_VER) || !defined(HALF_X86)
+#define HALF_TARGET_F16C
+#define HALF_TARGET_AVX512
+#else
+#define HALF_TARGET_F16C __attribute__((target("avx2,f16c")))
+#define HALF_TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+const char* halfFormatName(HalfFormat format)
+{
+	return format == HalfFormat::kFP16 ? "fp16" : "bf16";
+}
+
+/* ------ 명령어 집합 선택 ------ */
+
+const char* halfIsaName(HalfIsa isa)
+{
+	switch (isa) {
+	case HalfIsa::kSCALAR: return "scalar";
+	case HalfIsa::kF16C: return "f16c";
+	case HalfIsa::kAVX512: return "avx512";
+	}
+	return "unknown";
+}
+
+HalfIsa detectHalfIsa()
+{
+	// AVX2, AVX-512 의 OS 지원 (XCR0) 은 GEMM 쪽 검사 결과 사용, AVX-512F 는 F16C 를 포함
+	const GemmIsa gemm = detectGemmIsa();
+#ifdef HALF_X86
+	if (gemm == GemmIsa::kAVX512) return HalfIsa::kAVX512;
+	if (gemm == GemmIsa::kAVX2) {
+		unsigned r[4];
+#ifdef _MSC_VER
+		int regs[4];
+		__cpuidex(regs, 1, 0);
+		for (int i = 0; i < 4; i++) r[i] = (unsigned)regs[i];
+#else
+		__cpuid_count(1, 0, r[0], r[1], r[2], r[3]);
+#endif
+		if ((r[2] >> 29) & 1) return HalfIsa::kF16C;	// CPUID.1:ECX F16C
+	}
+#endif
+	return HalfIsa::kSCALAR;
+}
+
+bool halfIsaSupported(HalfIsa isa)
+{
+	return (int)isa <= (int)detectHalfIsa();
+}
+
+static HalfIsa& currentIsa()
+{
+	static HalfIsa isa = detectHalfIsa();
+	return isa;
+}
+
+HalfIsa halfIsa()
+{
+	return currentIsa();
+}
+
+void setHalfIsa(HalfIsa isa)
+{
+	if (!halfIsaSupported(isa)) {
+		std::cerr << "[ERROR] " << halfIsaName(isa) << " is not supported on this CPU, keep " << halfIsaName(currentIsa()) << std::endl;
+		return;
+	}
+	currentIsa() = isa;
+}
+
+/* ------ 변환 ------ */
+
+// vector 로 처리한 앞부분 개수를 반환, 나머지는 원소 단위
+#ifdef HALF_X86
+HALF_TARGET_F16C static int64_t toFloatF16c(const uint16_t* in, float* out, int64_t n, HalfFormat format)
+{
+	int64_t i = 0;
+	if (format == HalfFormat::kFP16) {
+		for (; i + 8 <= n; i += 8) _mm256_storeu_ps(out + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(in + i))));
+	}
+	else {
+		for (; i + 8 <= n; i += 8) {
+			const __m256i v = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(in + i)));
+			_mm256_storeu_ps(out + i, _mm256_castsi256_ps(_mm256_slli_epi32(v, 16)));
+		}
+	}
+	return i;
+}
+
+HALF_TARGET_F16C static int64_t toHalfF16c(const float* in, uint16_t* out, int64_t n, HalfFormat format)
+{
+	int64_t i = 0;
+	if (format == HalfFormat::kFP16) {
+		for (; i + 8 <= n; i += 8) _mm_storeu_si128((__m128i*)(out + i), _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT));
+	}
+	else {
+		// floatToBf16 과 같은 반올림 (+ 0x7fff + 하위 bit), nan 은 quiet nan
+		const __m256i lsb = _mm256_set1_epi32(1), bias = _mm256_set1_epi32(0x7fff), qnan = _mm256_set1_epi32(0x7fc0);
+		for (; i + 8 <= n; i += 8) {
+			const __m256 f = _mm256_loadu_ps(in + i);
+			const __m256i u = _mm256_castps_si256(f);
+			__m256i r = _mm256_add_epi32(u, _mm256_add_epi32(bias, _mm256_and_si256(_mm256_srli_epi32(u, 16), lsb)));
+			r = _mm256_srli_epi32(r, 16);
+			const __m256i nan = _mm256_castps_si256(_mm256_cmp_ps(f, f, _CMP_UNORD_Q));
+			r = _mm256_blendv_epi8(r, _mm256_or_si256(_mm256_srli_epi32(u, 16), qnan), nan);
+			// 32 bit 8 개 -> 16 bit (packus 는 128 bit lane 단위라 순서 정리)
+			const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(r, r), 0xD8);
+			_mm_storeu_si128((__m128i*)(out + i), _mm256_castsi256_si128(packed));
+		}
+	}
+	return i;
+}
+
+HALF_TARGET_AVX512 static int64_t toFloatAvx512(const uint16_t* in, float* out, int64_t n, HalfFormat format)
+{
+	int64_t i = 0;
+	if (format == HalfFormat::kFP16) {
+		for (; i + 16 <= n; i += 16) _mm512_storeu_ps(out + i, _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*)(in + i))));
+	}
+	else {
+		for (; i + 16 <= n; i += 16) {
+			const __m512i v = _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i*)(in + i)));
+			_mm512_storeu_ps(out + i, _mm512_castsi512_ps(_mm512_slli_epi32(v, 16)));
+		}
+	}
+	return i;
+}
+
+HALF_TARGET_AVX512 static int64_t toHalfAvx512(const float* in, uint16_t* out, int64_t n, HalfFormat format)
+{
+	int64_t i = 0;
+	if (format == HalfFormat::kFP16) {
+		for (; i + 16 <= n; i += 16) _mm256_storeu_si256((__m256i*)(out + i), _mm512_cvtps_ph(_mm512_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT));
+	}
+	else {
+		const __m512i lsb = _mm512_set1_epi32(1), bias = _mm512_set1_epi32(0x7fff), qnan = _mm512_set1_epi32(0x7fc0);
+		for (; i + 16 <= n; i += 16) {
+			const __m512 f = _mm512_loadu_ps(in + i);
+			const __m512i u = _mm512_castps_si512(f);
+			__m512i r = _mm512_add_epi32(u, _mm512_add_epi32(bias, _mm512_and_si512(_mm512_srli_epi32(u, 16), lsb)));
+			r = _mm512_srli_epi32(r, 16);
+			const __mmask16 nan = _mm512_cmp_ps_mask(f, f, _CMP_UNORD_Q);
+			r = _mm512_mask_or_epi32(r, nan, _mm512_srli_epi32(u, 16), qnan);
+			_mm256_storeu_si256((__m256i*)(out + i), _mm512_cvtepi32_epi16(r));
+		}
+	}
+	return i;
+}
+#endif
+
+void halfToFloat(const uint16_t* in, float* out, int64_t n, HalfFormat format)
+{
+	int64_t i = 0;
+#ifdef HALF_X86
+	const HalfIsa isa = currentIsa();
+	if (isa == HalfIsa::kAVX512) i = toFloatAvx512(in, out, n, format);
+	else if (isa == HalfIsa::kF16C) i = toFloatF16c(in, out, n, format);
+#endif
+	if (format == HalfFormat::kFP16) {
+		for (; i < n; i++) out[i] = fp16ToFloat(in[i]);
+	}
+	else {
+		for (; i < n; i++) out[i] = bf16ToFloat(in[i]);
+	}
+}
+
+void floatToHalf(const float* in, uint16_t* out, int64_t n, HalfFormat format)
+{
+	int64_t i = 0;
+#ifdef HALF_X86
+	const HalfIsa isa = currentIsa();
+	if (isa == HalfIsa::kAVX512) i = toHalfAvx512(in, out, n, format);
+	else if (isa == HalfIsa::kF16C) i = toHalfF16c(in, out, n, format);
+#endif
+	if (format == HalfFormat::kFP16) {
+		for (; i < n; i++) out[i] = floatToFp16(in[i]);
+	}
+	else {
+		for (; i < n; i++) out[i] = floatToBf16(in[i]);
+	}
+}
@@ -0,0 +1,123 @@
+﻿#pragma once
+#include <cstdint>
+#include <cstring>
+// 빌드 옵션이 F16C 를 허용하면 (gcc -mf16c, MSVC /arch:AVX2) 원소 변환도 명령어 하나
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define HALF_F16C_INLINE 1
+#include <immintrin.h>
+#endif
+
+// 16 bit activation 저장 형식 (kernel 은 float 로 변환해서 계산, 누적)
+enum class HalfFormat {
+	kFP16,	// IEEE binary16 (지수 5 bit, 가수 10 bit, 최대 65504, 넘으면 inf)
+	kBF16,	// bfloat16 (float 상위 16 bit, float 와 같은 지수 범위, 가수 7 bit)
+};
+const char* halfFormatName(HalfFormat format);
+
+// 변환 명령어 집합 (실행 중 CPUID 로 선택)
+enum class HalfIsa {
+	kSCALAR,	// bit 연산 (모든 CPU)
+	kF16C,		// AVX2 + F16C : 8 개씩 (vcvtph2ps / vcvtps2ph, bf16 은 32 bit shift)
+	kAVX512,	// AVX-512F : 16 개씩
+};
+const char* halfIsaName(HalfIsa isa);
+HalfIsa detectHalfIsa();
+bool halfIsaSupported(HalfIsa isa);
+// halfToFloat, floatToHalf 가 사용하는 명령어 집합 (기본값 detectHalfIsa())
+HalfIsa halfIsa();
+void setHalfIsa(HalfIsa isa);
+
+// 원소 하나 변환 (float -> 16 bit 는 round to nearest even)
+// kernel 안쪽 loop 에서 부르므로 inline
+inline float fp16ToFloat(uint16_t h)
+{
+#ifdef HALF_F16C_INLINE
+	return _cvtsh_ss(h);
+#else
+	const uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+	const uint32_t exp = (h >> 10) & 0x1f, mant = h & 0x3ff;
+	uint32_t u;
+	if (exp == 0x1f) u = sign | 0x7f800000 | (mant << 13) | (mant ? 0x400000 : 0);	// inf, nan (quiet)
+	else if (exp != 0) u = sign | ((exp + 112) << 23) | (mant << 13);	// 지수 bias 15 -> 127
+	else {
+		// 0, subnormal (mant * 2^-24)
+		const float f = mant * 5.9604644775390625e-8f;
+		return sign ? -f : f;
+	}
+	float f;
+	memcpy(&f, &u, 4);
+	return f;
+#endif
+}
+
+inline uint16_t floatToFp16(float f)
+{
+#ifdef HALF_F16C_INLINE
+	return (uint16_t)_cvtss_sh(f, _MM_FROUND_TO_NEAREST_INT);
+#else
+	uint32_t u;
+	memcpy(&u, &f, 4);
+	const uint16_t sign = (uint16_t)((u >> 16) & 0x8000);
+	u &= 0x7fffffff;
+	if (u >= 0x7f800000) return (uint16_t)(sign | 0x7c00 | (u > 0x7f800000 ? 0x200 : 0));	// inf, nan
+	if (u >= 0x477ff000) return (uint16_t)(sign | 0x7c00);	// 65520 이상은 반올림하면 inf
+	if (u < 0x38800000) {
+		// 결과가 subnormal : 0.5 를 더하면 가수의 하위 bit 가 반올림된 결과 (float 덧셈의 반올림 사용)
+		float v;
+		memcpy(&v, &u, 4);
+		v += 0.5f;
+		uint32_t r;
+		memcpy(&r, &v, 4);
+		return (uint16_t)(sign | (r - 0x3f000000));
+	}
+	// 지수 bias 127 -> 15, 버리는 13 bit 로 round to nearest even
+	u += 0xc8000fff + ((u >> 13) & 1);
+	return (uint16_t)(sign | (u >> 13));
+#endif
+}
+
+inline float bf16ToFloat(uint16_t h)
+{
+	const uint32_t u = (uint32_t)h << 16;
+	float f;
+	memcpy(&f, &u, 4);
+	return f;
+}
+
+inline uint16_t floatToBf16(float f)
+{
+	uint32_t u;
+	memcpy(&u, &f, 4);
+	if ((u & 0x7fffffff) > 0x7f800000) return (uint16_t)((u >> 16) | 0x40);	// nan 유지 (quiet)
+	return (uint16_t)((u + 0x7fff + ((u >> 16) & 1)) >> 16);
+}
+
+// n 개 변환 (halfIsa() 의 vector 명령어, 나머지는 원소 단위)
+void halfToFloat(const uint16_t* in, float* out, int64_t n, HalfFormat format);
+void floatToHalf(const float* in, uint16_t* out, int64_t n, HalfFormat format);
+
+// kernel template 의 원소 형식 : 같은 kernel 코드로 float, 16 bit 텐서를 읽고 씀
+// load, store 는 원소 하나, toFloat, fromFloat 는 연속 n 개
+struct FloatElement {
+	typedef float type;
+	static float load(float v) { return v; }
+	static float store(float v) { return v; }
+	static void toFloat(const float* in, float* out, int64_t n) { memcpy(out, in, (size_t)n * sizeof(float)); }
+	static void fromFloat(const float* in, float* out, int64_t n) { memcpy(out, in, (size_t)n * sizeof(float)); }
+};
+
+struct Fp16Element {
+	typedef uint16_t type;
+	static float load(uint16_t v) { return fp16ToFloat(v); }
+	static uint16_t store(float v) { return floatToFp16(v); }
+	static void toFloat(const uint16_t* in, float* out, int64_t n) { halfToFloat(in, out, n, HalfFormat::kFP16); }
+	static void fromFloat(const float* in, uint16_t* out, int64_t n) { floatToHalf(in, out, n, HalfFormat::kFP16); }
+};
+
+struct Bf16Element {
+	typedef uint16_t type;
+	static float load(uint16_t v) { return bf16ToFloat(v); }
+	static uint16_t store(float v) { return floatToBf16(v); }
+	static void toFloat(const uint16_t* in, float* out, int64_t n) { halfToFloat(in, out, n, HalfFormat::kBF16); }
+	static void fromFloat(const float* in, uint16_t* out, int64_t n) { floatToHalf(in, out, n, HalfFormat::kBF16); }
+};
@@ -0,0 +1,427 @@
+﻿#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include "cpu_gemm.hpp"
+#include "cpu_int8.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define INT8_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+// AVX-512 VNNI intrinsic 은 VS2019 (MSVC 19.20) 부터 제공
+#if !defined(_MSC_VER) || _MSC_VER >= 1920
+#define INT8_VNNI 1
+#endif
+#endif
+
+// 빌드 옵션 (/arch) 과 무관하게 kernel 함수 단위로 명령어 집합 지정 (cpu_gemm.cpp 와 같은 방식)
+#if defined(_MSC_VER) || !defined(INT8_X86)
+#define INT8_TARGET_AVX2
+#define INT8_TARGET_VNNI
+#else
+#define INT8_TARGET_AVX2 __attribute__((target("avx2")))
+#define INT8_TARGET_VNNI __attribute__((target("avx512f,avx512vnni")))
+#endif
+
+static const int kKC4 = 128;	// k 방향 block (4 개 단위, B micro panel 512 x NR byte 가 L1 에 남는 크기)
+static const int kMC = 96;		// task 당 출력 채널 수 (4, 6, 8 의 배수)
+static const int kNC = 256;		// task 당 출력 pixel (열) 수 (8, 32 의 배수)
+static const uint8_t kZERO_POINT = 128;
+
+static inline int divUp(int a, int b) { return (a + b - 1) / b; }
+static inline int roundUp(int a, int b) { return divUp(a, b) * b; }
+
+/* ------ 명령어 집합 선택 ------ */
+
+const char* int8IsaName(Int8Isa isa)
+{
+	switch (isa) {
+	case Int8Isa::kSCALAR: return "scalar";
+	case Int8Isa::kAVX2: return "avx2";
+	case Int8Isa::kAVX512_VNNI: return "avx512-vnni";
+	}
+	return "unknown";
+}
+
+Int8Isa detectInt8Isa()
+{
+	// AVX2, AVX-512 의 OS 지원 (XCR0) 은 GEMM 쪽 검사 결과 사용
+	const GemmIsa gemm = detectGemmIsa();
+#ifdef INT8_VNNI
+	if (gemm == GemmIsa::kAVX512) {
+		unsigned r[4];
+#ifdef _MSC_VER
+		int regs[4];
+		__cpuidex(regs, 7, 0);
+		for (int i = 0; i < 4; i++) r[i] = (unsigned)regs[i];
+#else
+		__cpuid_count(7, 0, r[0], r[1], r[2], r[3]);
+#endif
+		if ((r[2] >> 11) & 1) return Int8Isa::kAVX512_VNNI;	// CPUID.7.0:ECX AVX512_VNNI
+	}
+#endif
+	if (gemm != GemmIsa::kSCALAR) return Int8Isa::kAVX2;
+	return Int8Isa::kSCALAR;
+}
+
+bool int8IsaSupported(Int8Isa isa)
+{
+	return (int)isa <= (int)detectInt8Isa();
+}
+
+static Int8Isa& currentIsa()
+{
+	static Int8Isa isa = detectInt8Isa();
+	return isa;
+}
+
+Int8Isa int8Isa()
+{
+	return currentIsa();
+}
+
+void setInt8Isa(Int8Isa isa)
+{
+	if (!int8IsaSupported(isa)) {
+		std::cerr << "[ERROR] " << int8IsaName(isa) << " is not supported on this CPU, keep " << int8IsaName(currentIsa()) << std::endl;
+		return;
+	}
+	currentIsa() = isa;
+}
+
+/* ------ micro kernel ------ */
+
+// c[MR, NR] (+)= a[k4 * 4, MR]^T b[k4 * 4, NR] (int32)
+// a : 가중치 행 panel [k4][MR][4] (int8, AVX2 는 a16 int16), b : 입력 열 panel [k4][NR][4] (uint8)
+typedef void (*Int8MicroKernel)(int k4, const int8_t* a, const int16_t* a16, const uint8_t* b, int32_t* c, int64_t ldc, bool accumulate);
+
+struct Int8Kernels {
+	int mr, nr;
+	Int8MicroKernel micro;
+};
+
+template <int MR, int NR>
+static inline void storeTile(const int32_t* tile, int32_t* c, int64_t ldc, bool accumulate)
+{
+	for (int r = 0; r < MR; r++) {
+		int32_t* cr = c + r * ldc;
+		const int32_t* tr = tile + r * NR;
+		if (accumulate) {
+			for (int n = 0; n < NR; n++) cr[n] += tr[n];
+		}
+		else {
+			for (int n = 0; n < NR; n++) cr[n] = tr[n];
+		}
+	}
+}
+
+static void microScalar(int k4, const int8_t* a, const int16_t*, const uint8_t* b, int32_t* c, int64_t ldc, bool accumulate)
+{
+	const int MR = 4, NR = 8;
+	int32_t tile[MR * NR] = {};
+	for (int k = 0; k < k4; k++) {
+		const int8_t* ak = a + k * MR * 4;
+		const uint8_t* bk = b + k * NR * 4;
+		for (int r = 0; r < MR; r++) {
+			const int8_t* ar = ak + r * 4;
+			for (int n = 0; n < NR; n++) {
+				const uint8_t* bn = bk + n * 4;
+				tile[r * NR + n] += ar[0] * bn[0] + ar[1] * bn[1] + ar[2] * bn[2] + ar[3] * bn[3];
+			}
+		}
+	}
+	storeTile<MR, NR>(tile, c, ldc, accumulate);
+}
+
+#ifdef INT8_X86
+// uint8 입력을 16 bit 로 확장, 가중치 4 개 (int16) 를 broadcast 해서 vpmaddwd (열마다 두 쌍의 합이 나옴, 마지막에 hadd)
+INT8_TARGET_AVX2 static void microAvx2(int k4, const int8_t*, const int16_t* a, const uint8_t* b, int32_t* c, int64_t ldc, bool accumulate)
+{
+	const int MR = 6, NR = 8;
+	__m256i c00 = _mm256_setzero_si256(), c01 = _mm256_setzero_si256(), c10 = _mm256_setzero_si256(), c11 = _mm256_setzero_si256();
+	__m256i c20 = _mm256_setzero_si256(), c21 = _mm256_setzero_si256(), c30 = _mm256_setzero_si256(), c31 = _mm256_setzero_si256();
+	__m256i c40 = _mm256_setzero_si256(), c41 = _mm256_setzero_si256(), c50 = _mm256_setzero_si256(), c51 = _mm256_setzero_si256();
+	for (int k = 0; k < k4; k++) {
+		// 열 0 ~ 3, 4 ~ 7 의 4 개씩 (16 bit)
+		const __m256i b0 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(b + k * NR * 4)));
+		const __m256i b1 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(b + k * NR * 4 + 16)));
+		const int16_t* ak = a + k * MR * 4;
+		int64_t w;
+		__m256i av;
+		memcpy(&w, ak + 0, 8); av = _mm256_set1_epi64x(w);
+		c00 = _mm256_add_epi32(c00, _mm256_madd_epi16(b0, av)); c01 = _mm256_add_epi32(c01, _mm256_madd_epi16(b1, av));
+		memcpy(&w, ak + 4, 8); av = _mm256_set1_epi64x(w);
+		c10 = _mm256_add_epi32(c10, _mm256_madd_epi16(b0, av)); c11 = _mm256_add_epi32(c11, _mm256_madd_epi16(b1, av));
+		memcpy(&w, ak + 8, 8); av = _mm256_set1_epi64x(w);
+		c20 = _mm256_add_epi32(c20, _mm256_madd_epi16(b0, av)); c21 = _mm256_add_epi32(c21, _mm256_madd_epi16(b1, av));
+		memcpy(&w, ak + 12, 8); av = _mm256_set1_epi64x(w);
+		c30 = _mm256_add_epi32(c30, _mm256_madd_epi16(b0, av)); c31 = _mm256_add_epi32(c31, _mm256_madd_epi16(b1, av));
+		memcpy(&w, ak + 16, 8); av = _mm256_set1_epi64x(w);
+		c40 = _mm256_add_epi32(c40, _mm256_madd_epi16(b0, av)); c41 = _mm256_add_epi32(c41, _mm256_madd_epi16(b1, av));
+		memcpy(&w, ak + 20, 8); av = _mm256_set1_epi64x(w);
+		c50 = _mm256_add_epi32(c50, _mm256_madd_epi16(b0, av)); c51 = _mm256_add_epi32(c51, _mm256_madd_epi16(b1, av));
+	}
+	// [c0 c0 c1 c1 | c2 c2 c3 c3], [c4 c4 c5 c5 | c6 c6 c7 c7] -> hadd [c0 c1 c4 c5 | c2 c3 c6 c7] -> 64 bit 순서 (0, 2, 1, 3)
+	int32_t tile[MR * NR];
+	_mm256_storeu_si256((__m256i*)(tile + 0), _mm256_permute4x64_epi64(_mm256_hadd_epi32(c00, c01), 0xD8));
+	_mm256_storeu_si256((__m256i*)(tile + 8), _mm256_permute4x64_epi64(_mm256_hadd_epi32(c10, c11), 0xD8));
+	_mm256_storeu_si256((__m256i*)(tile + 16), _mm256_permute4x64_epi64(_mm256_hadd_epi32(c20, c21), 0xD8));
+	_mm256_storeu_si256((__m256i*)(tile + 24), _mm256_permute4x64_epi64(_mm256_hadd_epi32(c30, c31), 0xD8));
+	_mm256_storeu_si256((__m256i*)(tile + 32), _mm256_permute4x64_epi64(_mm256_hadd_epi32(c40, c41), 0xD8));
+	_mm256_storeu_si256((__m256i*)(tile + 40), _mm256_permute4x64_epi64(_mm256_hadd_epi32(c50, c51), 0xD8));
+	storeTile<MR, NR>(tile, c, ldc, accumulate);
+}
+#endif
+
+#ifdef INT8_VNNI
+// 가중치 4 개 (int8) broadcast, 입력 열 16 개 x 4 (uint8) 와 vpdpbusd
+INT8_TARGET_VNNI static void microVnni(int k4, const int8_t* a, const int16_t*, const uint8_t* b, int32_t* c, int64_t ldc, bool accumulate)
+{
+	const int MR = 8, NR = 32;
+	__m512i c00 = _mm512_setzero_si512(), c01 = _mm512_setzero_si512(), c10 = _mm512_setzero_si512(), c11 = _mm512_setzero_si512();
+	__m512i c20 = _mm512_setzero_si512(), c21 = _mm512_setzero_si512(), c30 = _mm512_setzero_si512(), c31 = _mm512_setzero_si512();
+	__m512i c40 = _mm512_setzero_si512(), c41 = _mm512_setzero_si512(), c50 = _mm512_setzero_si512(), c51 = _mm512_setzero_si512();
+	__m512i c60 = _mm512_setzero_si512(), c61 = _mm512_setzero_si512(), c70 = _mm512_setzero_si512(), c71 = _mm512_setzero_si512();
+	for (int k = 0; k < k4; k++) {
+		const __m512i b0 = _mm512_loadu_si512(b + k * NR * 4), b1 = _mm512_loadu_si512(b + k * NR * 4 + 64);
+		const int8_t* ak = a + k * MR * 4;
+		int32_t w;
+		__m512i av;
+		memcpy(&w, ak + 0, 4); av = _mm512_set1_epi32(w);
+		c00 = _mm512_dpbusd_epi32(c00, b0, av); c01 = _mm512_dpbusd_epi32(c01, b1, av);
+		memcpy(&w, ak + 4, 4); av = _mm512_set1_epi32(w);
+		c10 = _mm512_dpbusd_epi32(c10, b0, av); c11 = _mm512_dpbusd_epi32(c11, b1, av);
+		memcpy(&w, ak + 8, 4); av = _mm512_set1_epi32(w);
+		c20 = _mm512_dpbusd_epi32(c20, b0, av); c21 = _mm512_dpbusd_epi32(c21, b1, av);
+		memcpy(&w, ak + 12, 4); av = _mm512_set1_epi32(w);
+		c30 = _mm512_dpbusd_epi32(c30, b0, av); c31 = _mm512_dpbusd_epi32(c31, b1, av);
+		memcpy(&w, ak + 16, 4); av = _mm512_set1_epi32(w);
+		c40 = _mm512_dpbusd_epi32(c40, b0, av); c41 = _mm512_dpbusd_epi32(c41, b1, av);
+		memcpy(&w, ak + 20, 4); av = _mm512_set1_epi32(w);
+		c50 = _mm512_dpbusd_epi32(c50, b0, av); c51 = _mm512_dpbusd_epi32(c51, b1, av);
+		memcpy(&w, ak + 24, 4); av = _mm512_set1_epi32(w);
+		c60 = _mm512_dpbusd_epi32(c60, b0, av); c61 = _mm512_dpbusd_epi32(c61, b1, av);
+		memcpy(&w, ak + 28, 4); av = _mm512_set1_epi32(w);
+		c70 = _mm512_dpbusd_epi32(c70, b0, av); c71 = _mm512_dpbusd_epi32(c71, b1, av);
+	}
+	int32_t tile[MR * NR];
+	_mm512_storeu_si512(tile + 0, c00); _mm512_storeu_si512(tile + 16, c01);
+	_mm512_storeu_si512(tile + 32, c10); _mm512_storeu_si512(tile + 48, c11);
+	_mm512_storeu_si512(tile + 64, c20); _mm512_storeu_si512(tile + 80, c21);
+	_mm512_storeu_si512(tile + 96, c30); _mm512_storeu_si512(tile + 112, c31);
+	_mm512_storeu_si512(tile + 128, c40); _mm512_storeu_si512(tile + 144, c41);
+	_mm512_storeu_si512(tile + 160, c50); _mm512_storeu_si512(tile + 176, c51);
+	_mm512_storeu_si512(tile + 192, c60); _mm512_storeu_si512(tile + 208, c61);
+	_mm512_storeu_si512(tile + 224, c70); _mm512_storeu_si512(tile + 240, c71);
+	storeTile<MR, NR>(tile, c, ldc, accumulate);
+}
+#endif
+
+static const Int8Kernels& kernels(Int8Isa isa)
+{
+	static const Int8Kernels scalar{ 4, 8, microScalar };
+#ifdef INT8_X86
+	static const Int8Kernels avx2{ 6, 8, microAvx2 };
+	if (isa == Int8Isa::kAVX2) return avx2;
+#endif
+#ifdef INT8_VNNI
+	static const Int8Kernels vnni{ 8, 32, microVnni };
+	if (isa == Int8Isa::kAVX512_VNNI) return vnni;
+#endif
+	return scalar;
+}
+
+/* ------ 양자화, 정렬 ------ */
+
+static inline uint8_t quantizeU8(float v)
+{
+	v = std::min(std::max(v, -127.f), 127.f);
+	return (uint8_t)((int)std::nearbyint(v) + kZERO_POINT);
+}
+
+static void quantize(const float* in, int count, float scale, uint8_t* out)
+{
+	const float inv = 1.f / scale;
+#pragma omp parallel for schedule(static)
+	for (int i = 0; i < count; i++) out[i] = quantizeU8(in[i] * inv);
+}
+
+// 행 (출력 채널) 별 대칭 양자화 -> micro kernel 행 panel
+static Int8Weights quantizeWeights(int rows, int depth, const float* weights, const float* bias, float inputScale, const ConvActivation& activation, Int8Isa isa)
+{
+	const Int8Kernels& kern = kernels(isa);
+	Int8Weights w;
+	w.rows = rows;
+	w.depth = depth;
+	w.padded_depth = roundUp(depth, 4);
+	w.isa = isa;
+	w.activation = activation;
+	const int k4 = w.padded_depth / 4, mr = kern.mr;
+	w.q.assign((size_t)roundUp(rows, mr) * w.padded_depth, 0);
+	w.compensation.resize(rows);
+	w.scale.resize(rows);
+	w.bias.resize(rows);
+	for (int r = 0; r < rows; r++) {
+		const float* wr = weights + (int64_t)r * depth;
+		float amax = 0.f;
+		for (int d = 0; d < depth; d++) amax = std::max(amax, std::fabs(wr[d]));
+		const float scale = int8Scale(amax);
+		int8_t* panel = w.q.data() + (int64_t)(r / mr) * k4 * mr * 4 + (r % mr) * 4;
+		int32_t sum = 0;
+		for (int d = 0; d < depth; d++) {
+			const int v = (int)std::nearbyint(std::min(std::max(wr[d] / scale, -127.f), 127.f));
+			panel[(d / 4) * mr * 4 + d % 4] = (int8_t)v;
+			sum += v;
+		}
+		w.compensation[r] = sum * kZERO_POINT;
+		w.scale[r] = inputScale * scale;
+		w.bias[r] = bias ? bias[r] : 0.f;
+	}
+	if (isa == Int8Isa::kAVX2) w.q16.assign(w.q.begin(), w.q.end());
+	return w;
+}
+
+// 입력 행 [M, K] -> 열 panel [M/NR][k4][NR][4] (열 = 입력 행), 남는 열, 깊이는 zero point
+static void packRows(const float* in, int M, int K, int paddedDepth, int nr, float scale, uint8_t* dst)
+{
+	const int k4 = paddedDepth / 4;
+	const float inv = 1.f / scale;
+	memset(dst, kZERO_POINT, (size_t)roundUp(M, nr) * paddedDepth);
+#pragma omp parallel for schedule(static)
+	for (int m = 0; m < M; m++) {
+		const float* row = in + (int64_t)m * K;
+		uint8_t* d = dst + (int64_t)(m / nr) * k4 * nr * 4 + (m % nr) * 4;
+		for (int k = 0; k < K; k++) d[(k / 4) * nr * 4 + k % 4] = quantizeU8(row[k] * inv);
+	}
+}
+
+// 출력 pixel tile [j0, j0 + nc) 의 im2col (양자화된 입력) -> 열 panel [nc/NR][k4][NR][4], 입력 범위 밖과 남는 깊이는 zero point
+static void im2col(const ConvShape& s, const uint8_t* in, int j0, int nc, int paddedDepth, int nr, uint8_t* dst)
+{
+	const int KK = s.KH * s.KW, Kd = s.C * KK;
+	const int64_t panel_size = (int64_t)paddedDepth * nr;
+	memset(dst, kZERO_POINT, (size_t)roundUp(nc, nr) * paddedDepth);
+	for (int p = 0; p < Kd; p++) {
+		const int c = p / KK, kh = p % KK / s.KW, kw = p % s.KW;
+		const uint8_t* plane = in + (int64_t)c * s.H * s.W;
+		uint8_t* d = dst + (p / 4) * nr * 4 + p % 4;
+		int oh = j0 / s.OW, ow = j0 % s.OW;
+		for (int jp = 0; jp < nc; jp += nr, d += panel_size) {
+			const int n = std::min(nr, nc - jp);
+			for (int j = 0; j < n; j++) {
+				const int ih = oh * s.SH + kh * s.DH - s.PH;
+				const int iw = ow * s.SW + kw * s.DW - s.PW;
+				if (ih >= 0 && ih < s.H && iw >= 0 && iw < s.W) d[j * 4] = plane[(int64_t)ih * s.W + iw];
+				if (++ow == s.OW) { ow = 0; oh++; }
+			}
+		}
+	}
+}
+
+/* ------ GEMM ------ */
+
+// 가중치 행 [m0, m1) x 입력 열 panel [0, cols) -> c[r * rs + j * cs] (r 은 전체 행 번호, j 는 b 의 열 번호)
+// acc : (m1 - m0) x roundUp(cols, NR) int32 작업 공간
+static void int8Gemm(const Int8Weights& w, int m0, int m1, const uint8_t* b, int cols, float* c, int64_t rs, int64_t cs, int32_t* acc)
+{
+	const Int8Kernels& kern = kernels(w.isa);
+	const int mr = kern.mr, nr = kern.nr, k4 = w.padded_depth / 4;
+	const int panels = divUp(cols, nr), ldc = panels * nr;
+	for (int kc0 = 0; kc0 < k4; kc0 += kKC4) {
+		const int kc = std::min(kKC4, k4 - kc0);
+		for (int np = 0; np < panels; np++) {
+			const uint8_t* bp = b + ((int64_t)np * k4 + kc0) * nr * 4;
+			for (int m = m0; m < m1; m += mr) {
+				const int64_t a_offset = ((int64_t)(m / mr) * k4 + kc0) * mr * 4;
+				kern.micro(kc, w.q.data() + a_offset, w.q16.empty() ? nullptr : w.q16.data() + a_offset, bp,
+					acc + (int64_t)(m - m0) * ldc + np * nr, ldc, kc0 > 0);
+			}
+		}
+	}
+	// epilogue : zero point 보정, dequantize, bias, activation
+	const ConvActivation& act = w.activation;
+	for (int r = m0; r < m1; r++) {
+		const int32_t* ar = acc + (int64_t)(r - m0) * ldc;
+		const int32_t comp = w.compensation[r];
+		const float scale = w.scale[r], bias = w.bias[r];
+		float* cr = c + r * rs;
+		for (int j = 0; j < cols; j++) {
+			float y = (float)(ar[j] - comp) * scale + bias;
+			if (act.enabled) y = activate(y, act.type, act.alpha, act.beta);
+			cr[j * cs] = y;
+		}
+	}
+}
+
+/* ------ CpuInt8Conv ------ */
+
+CpuInt8Conv::CpuInt8Conv(const ConvShape& shape, const float* weights, const float* bias, float inputScale, const ConvActivation& activation, Int8Isa isa)
+	: shape_(shape), input_scale_(inputScale),
+	weights_(quantizeWeights(shape.K, shape.C * shape.KH * shape.KW, weights, bias, inputScale, activation, isa))
+{
+}
+
+// task = (출력 pixel tile, 출력 채널 묶음), tile 이 충분하면 채널은 나누지 않음 (im2col 을 한번만)
+void CpuInt8Conv::forward(const float* in, float* out) const
+{
+	const ConvShape& s = shape_;
+	const Int8Kernels& kern = kernels(weights_.isa);
+	const int P = s.OH * s.OW, Kp = weights_.padded_depth;
+	std::vector<uint8_t> qin((size_t)s.C * s.H * s.W);
+	quantize(in, (int)qin.size(), input_scale_, qin.data());
+
+	const int tiles = divUp(P, kNC), threads = maxThreads();
+	const int chunks = tiles >= 2 * threads ? 1 : std::min(divUp(s.K, kMC), divUp(2 * threads, tiles));
+	const int chunk_rows = roundUp(divUp(s.K, chunks), kern.mr);
+
+#pragma omp parallel
+	{
+		std::vector<uint8_t> col((size_t)Kp * kNC);
+		std::vector<int32_t> acc((size_t)chunk_rows * kNC);
+#pragma omp for schedule(dynamic)
+		for (int t = 0; t < tiles * chunks; t++) {
+			const int j0 = t / chunks * kNC, nc = std::min(kNC, P - j0);
+			const int m0 = t % chunks * chunk_rows, m1 = std::min(s.K, m0 + chunk_rows);
+			if (m0 >= m1) continue;
+			im2col(s, qin.data(), j0, nc, Kp, kern.nr, col.data());
+			int8Gemm(weights_, m0, m1, col.data(), nc, out + j0, P, 1, acc.data());
+		}
+	}
+}
+
+/* ------ CpuInt8Gemm ------ */
+
+CpuInt8Gemm::CpuInt8Gemm(int N, int K, const float* weights, const float* bias, float inputScale, const ConvActivation& activation, Int8Isa isa)
+	: input_scale_(inputScale), weights_(quantizeWeights(N, K, weights, bias, inputScale, activation, isa))
+{
+}
+
+// 출력 채널이 행, 입력 행이 열 : out[m, n] = c[n * 1 + m * N]
+// batch 가 작으면 열 panel 의 일부만 사용 (resnet18 의 FC 처럼 연산량이 작은 레이어)
+void CpuInt8Gemm::run(int M, const float* in, float* out) const
+{
+	const Int8Kernels& kern = kernels(weights_.isa);
+	const int N = weights_.rows, K = weights_.depth, Kp = weights_.padded_depth;
+	std::vector<uint8_t> b((size_t)roundUp(M, kern.nr) * Kp);
+	packRows(in, M, K, Kp, kern.nr, input_scale_, b.data());
+
+	const int tiles = divUp(M, kNC), chunks = divUp(N, kMC);
+#pragma omp parallel
+	{
+		std::vector<int32_t> acc((size_t)kMC * kNC);
+#pragma omp for schedule(dynamic)
+		for (int t = 0; t < tiles * chunks; t++) {
+			const int j0 = t / chunks * kNC, nc = std::min(kNC, M - j0);
+			const int m0 = t % chunks * kMC, m1 = std::min(N, m0 + kMC);
+			int8Gemm(weights_, m0, m1, b.data() + (int64_t)j0 * Kp, nc, out + (int64_t)j0 * N, 1, N, acc.data());
+		}
+	}
+}
@@ -0,0 +1,86 @@
+﻿#pragma once
+#include <cstdint>
+#include <vector>
+#include "cpu_conv.hpp"
+
+// INT8 micro kernel 명령어 집합 (실행 중 CPUID 로 선택)
+enum class Int8Isa {
+	kSCALAR,		// 4 x 8 C++ kernel (모든 CPU)
+	kAVX2,			// 16 bit 확장 + vpmaddwd 6 x 8
+	kAVX512_VNNI,	// vpdpbusd 8 x 32 (uint8 x int8 4 개 곱의 합을 int32 에 누적)
+};
+const char* int8IsaName(Int8Isa isa);
+// CPU, OS, 컴파일러가 지원하는 가장 빠른 명령어 집합
+Int8Isa detectInt8Isa();
+bool int8IsaSupported(Int8Isa isa);
+// 이후 생성되는 CpuInt8Conv, CpuInt8Gemm 의 기본 명령어 집합 (기본값 detectInt8Isa())
+Int8Isa int8Isa();
+void setInt8Isa(Int8Isa isa);
+
+// 대칭 per-tensor 양자화 scale (amax : dynamic range 의 최대 절대값), q = clamp(round(x / scale), -127, 127)
+inline float int8Scale(float amax) { return amax > 0.f ? amax / 127.f : 1.f; }
+
+// 출력 채널(행) 별 대칭 양자화 가중치와 epilogue 계수 (conv, fully connected 공용)
+// 입력은 zero point 128 의 uint8 (q + 128) 로 곱하므로 누적값에서 128 * sum(q_w) 를 빼고
+// y = (acc - compensation) * scale + bias 를 activation 과 함께 float 출력에 바로 저장
+struct Int8Weights {
+	int rows;
+	int depth;
+	int padded_depth;					// 4 의 배수 (kernel 이 4 개씩 곱함)
+	Int8Isa isa;
+	std::vector<int8_t> q;				// [rows/MR][padded_depth/4][MR][4] (남는 행, 열은 0)
+	std::vector<int16_t> q16;			// AVX2 kernel 용 16 bit 확장 (같은 배치)
+	std::vector<int32_t> compensation;	// 128 * sum(q_w)
+	std::vector<float> scale;			// input scale * weight scale
+	std::vector<float> bias;
+	ConvActivation activation;
+};
+
+//! \class CpuInt8Conv
+//!
+//! \brief 한 conv 레이어의 INT8 실행. 가중치는 생성시 출력 채널별로 양자화, micro kernel 행 panel 로 정렬
+//!  forward 는 float 입력을 입력 텐서 scale 로 양자화 -> 출력 pixel tile 단위 im2col (uint8 panel)
+//!  -> int8 x uint8 -> int32 GEMM -> epilogue 에서 scale, bias, activation 적용 후 float 출력
+//!
+class CpuInt8Conv
+{
+public:
+	// weights : [K, C, KH, KW], bias : K 개 (nullptr 이면 0), inputScale : 입력 텐서 scale (int8Scale(dynamic range))
+	CpuInt8Conv(const ConvShape& shape, const float* weights, const float* bias, float inputScale, const ConvActivation& activation = ConvActivation{ false, ir::ActivationType::kRELU, 0.f, 0.f }, Int8Isa isa = int8Isa());
+
+	// group conv 는 지원하지 않음 (float 경로 사용)
+	static bool supports(const ConvShape& shape) { return shape.G == 1; }
+
+	// 1 sample, NCHW 입력 [C, H, W] -> 출력 [K, OH, OW]
+	void forward(const float* in, float* out) const;
+
+	Int8Isa isa() const { return weights_.isa; }
+	const ConvShape& shape() const { return shape_; }
+
+private:
+	ConvShape shape_;
+	float input_scale_;
+	Int8Weights weights_;
+};
+
+//! \class CpuInt8Gemm
+//!
+//! \brief fully connected 레이어의 INT8 실행. out[M, N] = in[M, K] W^T + bias (CpuGemm 과 같은 입출력)
+//!  입력 행들을 uint8 panel (열 = 입력 행) 로 양자화해서 CpuInt8Conv 와 같은 kernel 로 곱함
+//!
+class CpuInt8Gemm
+{
+public:
+	// weights : [N, K] row-major, bias : N 개 (nullptr 이면 0)
+	CpuInt8Gemm(int N, int K, const float* weights, const float* bias, float inputScale, const ConvActivation& activation = ConvActivation{ false, ir::ActivationType::kRELU, 0.f, 0.f }, Int8Isa isa = int8Isa());
+
+	void run(int M, const float* in, float* out) const;
+
+	Int8Isa isa() const { return weights_.isa; }
+	int rows() const { return weights_.rows; }
+	int depth() const { return weights_.depth; }
+
+private:
+	float input_scale_;
+	Int8Weights weights_;
+};
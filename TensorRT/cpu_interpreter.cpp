@@ -0,0 +1,1242 @@
+﻿#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include "cpu_attention.hpp"
+#include "cpu_interpreter.hpp"
+#include "cpu_spatial.hpp"
+#include "kernel_tuner.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace ir;
+
+// Dims 의 row-major stride
+static void stridesOf(const Dims& dims, int64_t* strides)
+{
+	int64_t s = 1;
+	for (int i = dims.nbDims - 1; i >= 0; i--) {
+		strides[i] = s;
+		s *= dims.d[i];
+	}
+}
+
+static int64_t product(const Dims& dims, int begin, int end)
+{
+	int64_t v = 1;
+	for (int i = begin; i < end; i++) v *= dims.d[i];
+	return v;
+}
+
+static int lowestAxis(uint32_t axes)
+{
+	int a = 0;
+	while (a < 31 && !(axes & (1u << a))) a++;
+	return a;
+}
+
+// 임의 축 순서 변경 : out[i0..] = in[perm 적용 index] (out.d[i] = in.d[perm[i]])
+static void permute(const float* in, const Dims& in_dims, const int* perm, float* out)
+{
+	const int nb = in_dims.nbDims;
+	bool identity = true;
+	for (int i = 0; i < nb; i++) identity &= perm[i] == i;
+	const int64_t total = volume(in_dims);
+	if (identity) {
+		memcpy(out, in, total * sizeof(float));
+		return;
+	}
+	int64_t in_strides[kMAX_DIMS], src_strides[kMAX_DIMS];
+	stridesOf(in_dims, in_strides);
+	Dims out_dims = in_dims;
+	for (int i = 0; i < nb; i++) {
+		out_dims.d[i] = in_dims.d[perm[i]];
+		src_strides[i] = in_strides[perm[i]];
+	}
+	const int inner = out_dims.d[nb - 1];
+	const int64_t inner_stride = src_strides[nb - 1];
+	const int rows = (int)(total / inner);
+#pragma omp parallel for schedule(static)
+	for (int r = 0; r < rows; r++) {
+		int64_t rem = r, src = 0;
+		for (int i = nb - 2; i >= 0; i--) {
+			src += (rem % out_dims.d[i]) * src_strides[i];
+			rem /= out_dims.d[i];
+		}
+		float* o = out + (int64_t)r * inner;
+		for (int x = 0; x < inner; x++) o[x] = in[src + x * inner_stride];
+	}
+}
+
+static inline float unary(float x, UnaryOperation op)
+{
+	switch (op) {
+	case UnaryOperation::kEXP: return std::exp(x);
+	case UnaryOperation::kLOG: return std::log(x);
+	case UnaryOperation::kSQRT: return std::sqrt(x);
+	case UnaryOperation::kRECIP: return 1.f / x;
+	case UnaryOperation::kABS: return std::fabs(x);
+	case UnaryOperation::kNEG: return -x;
+	case UnaryOperation::kSIN: return std::sin(x);
+	case UnaryOperation::kCOS: return std::cos(x);
+	}
+	return x;
+}
+
+static inline float binary(float a, float b, ElementWiseOperation op)
+{
+	switch (op) {
+	case ElementWiseOperation::kSUM: return a + b;
+	case ElementWiseOperation::kPROD: return a * b;
+	case ElementWiseOperation::kMAX: return std::max(a, b);
+	case ElementWiseOperation::kMIN: return std::min(a, b);
+	case ElementWiseOperation::kSUB: return a - b;
+	case ElementWiseOperation::kDIV: return a / b;
+	case ElementWiseOperation::kPOW: return std::pow(a, b);
+	}
+	return a;
+}
+
+// graph pass 로 합쳐진 activation (fused_activation_) 적용
+static inline float epilogue(const Layer& l, float x)
+{
+	return l.fused_activation_ ? activate(x, l.activation_, l.alpha_, l.beta_) : x;
+}
+
+static void applyEpilogue(const Layer& l, float* data, int64_t count)
+{
+	if (!l.fused_activation_) return;
+	for (int64_t i = 0; i < count; i++) data[i] = activate(data[i], l.activation_, l.alpha_, l.beta_);
+}
+
+// deconv : 가중치 [C, K/G, KH, KW] (TensorRT 형식)
+static void deconvolution(const Layer& l, const Dims& in_dims, const float* in, const Dims& out_dims, float* out)
+{
+	const int C = in_dims.d[0], H = in_dims.d[1], W = in_dims.d[2];
+	const int K = out_dims.d[0], OH = out_dims.d[1], OW = out_dims.d[2];
+	const int G = l.groups_, Cg = C / G, Kg = K / G;
+	const int KH = l.kernel_.d[0], KW = l.kernel_.d[1];
+	const int SH = l.stride_.d[0], SW = l.stride_.d[1];
+	const int PH = l.pre_padding_.d[0], PW = l.pre_padding_.d[1];
+	const int DH = l.dilation_.d[0], DW = l.dilation_.d[1];
+	const bool has_bias = !l.bias_weights_.empty();
+
+#pragma omp parallel for schedule(dynamic)
+	for (int k = 0; k < K; k++) {
+		const int g = k / Kg, kk = k % Kg;
+		float* o = out + (int64_t)k * OH * OW;
+		std::fill(o, o + (int64_t)OH * OW, has_bias ? l.bias_weights_[k] : 0.f);
+		for (int c = 0; c < Cg; c++) {
+			const int ci = g * Cg + c;
+			const float* plane = in + (int64_t)ci * H * W;
+			const float* wk = l.kernel_weights_.data() + ((int64_t)ci * Kg + kk) * KH * KW;
+			for (int kh = 0; kh < KH; kh++) {
+				for (int kw = 0; kw < KW; kw++) {
+					const float w = wk[kh * KW + kw];
+					for (int ih = 0; ih < H; ih++) {
+						const int oh = ih * SH + kh * DH - PH;
+						if (oh < 0 || oh >= OH) continue;
+						for (int iw = 0; iw < W; iw++) {
+							const int ow = iw * SW + kw * DW - PW;
+							if (ow >= 0 && ow < OW) o[(int64_t)oh * OW + ow] += w * plane[(int64_t)ih * W + iw];
+						}
+					}
+				}
+			}
+		}
+		applyEpilogue(l, o, (int64_t)OH * OW);
+	}
+}
+
+// stride 1 max pooling 은 window 크기와 무관한 separable running max (cpu_spatial.hpp)
+static bool stride1MaxPool(const Layer& l)
+{
+	return l.pooling_type_ == PoolingType::kMAX && l.kernel_.nbDims == 2 && l.stride_.d[0] == 1 && l.stride_.d[1] == 1;
+}
+
+static MaxPoolStage maxPoolStage(const Layer& l, float* out)
+{
+	const Dims d = l.getOutput(0)->getDimensions();
+	return MaxPoolStage{ l.kernel_.d[0], l.kernel_.d[1], l.pre_padding_.d[0], l.pre_padding_.d[1], d.d[d.nbDims - 2], d.d[d.nbDims - 1], out };
+}
+
+// 일반 window pooling (E : 입출력 원소 형식)
+template <class E>
+static void windowPooling(const Layer& l, const Dims& in_dims, const typename E::type* in, const Dims& out_dims, typename E::type* out)
+{
+	const int nb = in_dims.nbDims;
+	const int H = in_dims.d[nb - 2], W = in_dims.d[nb - 1];
+	const int OH = out_dims.d[nb - 2], OW = out_dims.d[nb - 1];
+	const int planes = (int)product(in_dims, 0, nb - 2);
+	const int KH = l.kernel_.d[0], KW = l.kernel_.d[1];
+	const int SH = l.stride_.d[0], SW = l.stride_.d[1];
+	const int PH = l.pre_padding_.d[0], PW = l.pre_padding_.d[1];
+	const bool is_max = l.pooling_type_ == PoolingType::kMAX;
+
+#pragma omp parallel for schedule(static)
+	for (int p = 0; p < planes; p++) {
+		const typename E::type* src = in + (int64_t)p * H * W;
+		typename E::type* dst = out + (int64_t)p * OH * OW;
+		for (int oh = 0; oh < OH; oh++) {
+			const int h0 = oh * SH - PH, h1 = std::min(h0 + KH, H);
+			for (int ow = 0; ow < OW; ow++) {
+				const int w0 = ow * SW - PW, w1 = std::min(w0 + KW, W);
+				float acc = is_max ? -INFINITY : 0.f;
+				for (int h = std::max(h0, 0); h < h1; h++) {
+					const typename E::type* row = src + (int64_t)h * W;
+					for (int w = std::max(w0, 0); w < w1; w++) {
+						const float v = E::load(row[w]);
+						acc = is_max ? std::max(acc, v) : acc + v;
+					}
+				}
+				if (!is_max) {
+					const int count = l.average_count_excludes_padding_
+						? (h1 - std::max(h0, 0)) * (w1 - std::max(w0, 0))
+						: KH * KW;
+					acc /= count;
+				}
+				dst[oh * OW + ow] = E::store(acc);
+			}
+		}
+	}
+}
+
+static void pooling(const Layer& l, const Dims& in_dims, const float* in, const Dims& out_dims, float* out)
+{
+	const int nb = in_dims.nbDims;
+	if (stride1MaxPool(l)) {
+		const MaxPoolStage stage = maxPoolStage(l, out);
+		maxPoolCascade(in, (int)product(in_dims, 0, nb - 2), in_dims.d[nb - 2], in_dims.d[nb - 1], &stage, 1);
+		return;
+	}
+	windowPooling<FloatElement>(l, in_dims, in, out_dims, out);
+}
+
+// 행렬 곱 (마지막 2 차원, 나머지 차원은 broadcast)
+static void matrixMultiply(const Layer& l, const Dims& a_dims, const float* a, const Dims& b_dims, const float* b, const Dims& out_dims, float* out)
+{
+	const int nb = out_dims.nbDims;
+	const bool ta = l.op0_ == MatrixOperation::kTRANSPOSE, tb = l.op1_ == MatrixOperation::kTRANSPOSE;
+	const int M = out_dims.d[nb - 2], N = out_dims.d[nb - 1];
+	const int Kd = ta ? a_dims.d[nb - 2] : a_dims.d[nb - 1];
+	// a[m,k] = a[m * sam + k * sak]
+	const int64_t sam = ta ? 1 : Kd, sak = ta ? M : 1;
+	const int64_t sbk = tb ? 1 : N, sbn = tb ? Kd : 1;
+	const int mats = (int)product(out_dims, 0, nb - 2);
+
+	for (int mat = 0; mat < mats; mat++) {
+		// broadcast 된 선행 차원의 a, b 위치
+		int64_t rem = mat, ia = 0, ib = 0, sa = 1, sb = 1;
+		for (int i = nb - 3; i >= 0; i--) {
+			const int idx = (int)(rem % out_dims.d[i]);
+			rem /= out_dims.d[i];
+			if (a_dims.d[i] != 1) ia += idx * sa;
+			if (b_dims.d[i] != 1) ib += idx * sb;
+			sa *= a_dims.d[i];
+			sb *= b_dims.d[i];
+		}
+		gemm(M, N, Kd, a + ia * M * Kd, sam, sak, b + ib * Kd * N, sbk, sbn, out + (int64_t)mat * M * N, N);
+	}
+}
+
+static void elementwise(const Layer& l, const Dims& a_dims, const float* a, const Dims& b_dims, const float* b, const Dims& out_dims, float* out)
+{
+	const ElementWiseOperation op = l.elementwise_op_;
+	const int64_t total = volume(out_dims);
+	const int64_t va = volume(a_dims), vb = volume(b_dims);
+	if (va == total && vb == total) {
+#pragma omp parallel for schedule(static)
+		for (int i = 0; i < (int)total; i++) out[i] = epilogue(l, binary(a[i], b[i], op));
+		return;
+	}
+	if (vb == 1 || va == 1) {
+		const float s = vb == 1 ? b[0] : a[0];
+		const float* v = vb == 1 ? a : b;
+		const bool scalar_rhs = vb == 1;
+#pragma omp parallel for schedule(static)
+		for (int i = 0; i < (int)total; i++) out[i] = epilogue(l, scalar_rhs ? binary(v[i], s, op) : binary(s, v[i], op));
+		return;
+	}
+	// 일반 broadcast : 마지막 차원 단위 행 처리
+	const int nb = out_dims.nbDims;
+	int64_t sa[kMAX_DIMS], sb[kMAX_DIMS];
+	stridesOf(a_dims, sa);
+	stridesOf(b_dims, sb);
+	for (int i = 0; i < nb; i++) {
+		if (a_dims.d[i] == 1) sa[i] = 0;
+		if (b_dims.d[i] == 1) sb[i] = 0;
+	}
+	const int inner = out_dims.d[nb - 1];
+	const int rows = (int)(total / inner);
+#pragma omp parallel for schedule(static)
+	for (int r = 0; r < rows; r++) {
+		int64_t rem = r, ia = 0, ib = 0;
+		for (int i = nb - 2; i >= 0; i--) {
+			const int64_t idx = rem % out_dims.d[i];
+			rem /= out_dims.d[i];
+			ia += idx * sa[i];
+			ib += idx * sb[i];
+		}
+		float* o = out + (int64_t)r * inner;
+		for (int x = 0; x < inner; x++) o[x] = epilogue(l, binary(a[ia + x * sa[nb - 1]], b[ib + x * sb[nb - 1]], op));
+	}
+}
+
+static void scale(const Layer& l, const Dims& dims, const float* in, float* out)
+{
+	const int64_t total = volume(dims);
+	int64_t inner = 1;
+	int channels = 1;
+	if (l.scale_mode_ == ScaleMode::kCHANNEL) {
+		channels = dims.d[l.channel_axis_];
+		inner = product(dims, l.channel_axis_ + 1, dims.nbDims);
+	}
+	else if (l.scale_mode_ == ScaleMode::kELEMENTWISE) {
+		channels = (int)total;
+	}
+	const float* shift = l.shift_.empty() ? nullptr : l.shift_.data();
+	const float* sc = l.scale_.empty() ? nullptr : l.scale_.data();
+	const float* pw = l.power_.empty() ? nullptr : l.power_.data();
+#pragma omp parallel for schedule(static)
+	for (int i = 0; i < (int)total; i++) {
+		const int c = (int)((i / inner) % channels);
+		float v = in[i];
+		if (sc) v *= sc[c];
+		if (shift) v += shift[c];
+		if (pw && pw[c] != 1.f) v = pw[c] == 2.f ? v * v : std::pow(v, pw[c]);
+		out[i] = epilogue(l, v);
+	}
+}
+
+static void softmax(const Layer& l, const Dims& dims, const float* in, float* out)
+{
+	const int axis = lowestAxis(l.axes_);
+	const int outer = (int)product(dims, 0, axis);
+	const int len = dims.d[axis];
+	const int64_t inner = product(dims, axis + 1, dims.nbDims);
+#pragma omp parallel for schedule(static)
+	for (int t = 0; t < outer * (int)inner; t++) {
+		const int64_t o = t / inner, i = t % inner;
+		const float* src = in + o * len * inner + i;
+		float* dst = out + o * len * inner + i;
+		float mx = -INFINITY;
+		for (int k = 0; k < len; k++) mx = std::max(mx, src[k * inner]);
+		float sum = 0.f;
+		for (int k = 0; k < len; k++) {
+			dst[k * inner] = std::exp(src[k * inner] - mx);
+			sum += dst[k * inner];
+		}
+		const float inv = 1.f / sum;
+		for (int k = 0; k < len; k++) dst[k * inner] *= inv;
+	}
+}
+
+static void reduce(const Layer& l, const Dims& in_dims, const float* in, const Dims& out_dims, float* out)
+{
+	int64_t strides[kMAX_DIMS];
+	stridesOf(in_dims, strides);
+	// 유지 차원, 축소 차원 분리
+	int keep[kMAX_DIMS], red[kMAX_DIMS], nk = 0, nr = 0;
+	int64_t red_count = 1;
+	for (int i = 0; i < in_dims.nbDims; i++) {
+		if (l.axes_ & (1u << i)) {
+			red[nr++] = i;
+			red_count *= in_dims.d[i];
+		}
+		else {
+			keep[nk++] = i;
+		}
+	}
+	const int total = (int)volume(out_dims);
+	const ReduceOperation op = l.reduce_op_;
+#pragma omp parallel for schedule(static)
+	for (int o = 0; o < total; o++) {
+		int64_t rem = o, base = 0;
+		for (int i = nk - 1; i >= 0; i--) {
+			base += (rem % in_dims.d[keep[i]]) * strides[keep[i]];
+			rem /= in_dims.d[keep[i]];
+		}
+		float acc = op == ReduceOperation::kPROD ? 1.f : op == ReduceOperation::kMAX ? -INFINITY : op == ReduceOperation::kMIN ? INFINITY : 0.f;
+		for (int64_t r = 0; r < red_count; r++) {
+			int64_t rr = r, off = base;
+			for (int i = nr - 1; i >= 0; i--) {
+				off += (rr % in_dims.d[red[i]]) * strides[red[i]];
+				rr /= in_dims.d[red[i]];
+			}
+			const float v = in[off];
+			switch (op) {
+			case ReduceOperation::kSUM:
+			case ReduceOperation::kAVG: acc += v; break;
+			case ReduceOperation::kPROD: acc *= v; break;
+			case ReduceOperation::kMAX: acc = std::max(acc, v); break;
+			case ReduceOperation::kMIN: acc = std::min(acc, v); break;
+			}
+		}
+		out[o] = op == ReduceOperation::kAVG ? acc / red_count : acc;
+	}
+}
+
+static void topk(const Layer& l, const Dims& dims, const float* in, float* values, float* indices)
+{
+	const int axis = lowestAxis(l.axes_);
+	const int outer = (int)product(dims, 0, axis);
+	const int len = dims.d[axis];
+	const int64_t inner = product(dims, axis + 1, dims.nbDims);
+	const int k = l.nb_outputs_;
+	const bool is_max = l.topk_op_ == TopKOperation::kMAX;
+	for (int t = 0; t < outer * (int)inner; t++) {
+		const int64_t o = t / inner, i = t % inner;
+		const float* src = in + o * len * inner + i;
+		std::vector<int> order(len);
+		for (int j = 0; j < len; j++) order[j] = j;
+		std::partial_sort(order.begin(), order.begin() + k, order.end(), [&](int x, int y) {
+			const float vx = src[x * inner], vy = src[y * inner];
+			if (vx != vy) return is_max ? vx > vy : vx < vy;
+			return x < y;
+		});
+		for (int j = 0; j < k; j++) {
+			values[(o * k + j) * inner + i] = src[order[j] * inner];
+			indices[(o * k + j) * inner + i] = (float)order[j];
+		}
+	}
+}
+
+static void gather(const Layer& l, const Dims& dims, const float* data, const Dims& idx_dims, const float* indices, float* out)
+{
+	const int axis = l.axis_;
+	const int outer = (int)product(dims, 0, axis);
+	const int len = dims.d[axis];
+	const int64_t inner = product(dims, axis + 1, dims.nbDims);
+	const int count = (int)volume(idx_dims);
+#pragma omp parallel for schedule(static)
+	for (int t = 0; t < outer * count; t++) {
+		const int o = t / count, j = t % count;
+		int idx = (int)indices[j];
+		if (idx < 0) idx += len;
+		memcpy(out + (int64_t)t * inner, data + ((int64_t)o * len + idx) * inner, inner * sizeof(float));
+	}
+}
+
+// 복사만 하는 레이어 (concat, padding, slice) 는 원소 형식과 무관 (T : float 또는 16 bit)
+template <class T>
+static void concatenation(const Layer& l, const std::vector<const T*>& ins, const Dims& out_dims, T* out)
+{
+	const int axis = l.axis_;
+	const int outer = (int)product(out_dims, 0, axis);
+	const int64_t inner = product(out_dims, axis + 1, out_dims.nbDims);
+	const int64_t out_block = out_dims.d[axis] * inner;
+	int64_t offset = 0;
+	for (int n = 0; n < (int)ins.size(); n++) {
+		const int64_t block = l.getInput(n)->getDimensions().d[axis] * inner;
+		const T* src = ins[n];
+		if (outer == 1 && src == out + offset) {
+			// zero-copy concat : 입력이 이미 출력 구간에 있음
+			offset += block;
+			continue;
+		}
+#pragma omp parallel for schedule(static)
+		for (int o = 0; o < outer; o++) {
+			memcpy(out + o * out_block + offset, src + o * block, block * sizeof(T));
+		}
+		offset += block;
+	}
+}
+
+// 마지막 2 차원 padding (음수면 잘라냄)
+template <class T>
+static void padding(const Layer& l, const Dims& in_dims, const T* in, const Dims& out_dims, T* out)
+{
+	const int nb = in_dims.nbDims;
+	const int H = in_dims.d[nb - 2], W = in_dims.d[nb - 1];
+	const int OH = out_dims.d[nb - 2], OW = out_dims.d[nb - 1];
+	const int PT = l.pre_padding_.d[0], PL = l.pre_padding_.d[1];
+	const int planes = (int)product(in_dims, 0, nb - 2);
+#pragma omp parallel for schedule(static)
+	for (int p = 0; p < planes; p++) {
+		for (int oh = 0; oh < OH; oh++) {
+			const int ih = oh - PT;
+			T* orow = out + ((int64_t)p * OH + oh) * OW;
+			for (int ow = 0; ow < OW; ow++) {
+				const int iw = ow - PL;
+				orow[ow] = (ih >= 0 && ih < H && iw >= 0 && iw < W) ? in[((int64_t)p * H + ih) * W + iw] : T();
+			}
+		}
+	}
+}
+
+template <class T>
+static void slice(const Layer& l, const Dims& in_dims, const T* in, const Dims& out_dims, T* out)
+{
+	const int nb = in_dims.nbDims;
+	int64_t strides[kMAX_DIMS];
+	stridesOf(in_dims, strides);
+	// 뒤쪽의 전체 선택 차원 (start 0, stride 1, 크기 같음) 은 하나로 합침 (DETR q, k 분리 [L, 512, 1, 1] -> [L, 256, 1, 1] 은 행 단위 복사)
+	int last = nb - 1;
+	int64_t block = 1;
+	while (last > 0 && l.slice_start_.d[last] == 0 && l.slice_stride_.d[last] == 1 && out_dims.d[last] == in_dims.d[last]) block *= out_dims.d[last--];
+	const int inner = out_dims.d[last];
+	const int rows = (int)(volume(out_dims) / ((int64_t)inner * block));
+	const int64_t step = l.slice_stride_.d[last] * strides[last];
+#pragma omp parallel for schedule(static)
+	for (int r = 0; r < rows; r++) {
+		int64_t rem = r, src = 0;
+		for (int i = last - 1; i >= 0; i--) {
+			src += (l.slice_start_.d[i] + (rem % out_dims.d[i]) * l.slice_stride_.d[i]) * strides[i];
+			rem /= out_dims.d[i];
+		}
+		src += l.slice_start_.d[last] * strides[last];
+		T* o = out + (int64_t)r * inner * block;
+		if (block == 1) {
+			for (int x = 0; x < inner; x++) o[x] = in[src + x * step];
+		}
+		else {
+			for (int x = 0; x < inner; x++) memcpy(o + x * block, in + src + x * step, block * sizeof(T));
+		}
+	}
+}
+
+// 마지막 2 차원 resize (asymmetric 또는 align corners 좌표 변환), 합쳐진 padding 은 0 으로 채움
+static ResizeShape resizeShape(const Layer& l, const Dims& in_dims, const Dims& out_dims)
+{
+	const int nb = in_dims.nbDims;
+	assert(product(in_dims, 0, nb - 2) == product(out_dims, 0, nb - 2));
+	const bool padded = l.pre_padding_.nbDims == 2;
+	ResizeShape shape;
+	shape.planes = (int)product(in_dims, 0, nb - 2);
+	shape.H = in_dims.d[nb - 2];
+	shape.W = in_dims.d[nb - 1];
+	shape.PT = padded ? l.pre_padding_.d[0] : 0;
+	shape.PL = padded ? l.pre_padding_.d[1] : 0;
+	shape.PB = padded ? l.post_padding_.d[0] : 0;
+	shape.PR = padded ? l.post_padding_.d[1] : 0;
+	shape.OH = out_dims.d[nb - 2] - shape.PT - shape.PB;
+	shape.OW = out_dims.d[nb - 1] - shape.PL - shape.PR;
+	shape.nearest = l.resize_mode_ == ResizeMode::kNEAREST;
+	shape.align_corners = l.align_corners_;
+	return shape;
+}
+
+// 16 bit 원소별 연산 : L1 에 남는 chunk 단위로 float 변환 -> 계산 -> 변환 (b 가 nullptr 이면 단항)
+static const int kHALF_CHUNK = 1024;
+
+template <class F>
+static void mapHalf(const uint16_t* a, const uint16_t* b, uint16_t* out, int64_t total, HalfFormat format, F f)
+{
+	const int chunks = (int)((total + kHALF_CHUNK - 1) / kHALF_CHUNK);
+#pragma omp parallel for schedule(static)
+	for (int c = 0; c < chunks; c++) {
+		float x[kHALF_CHUNK], y[kHALF_CHUNK];
+		const int64_t i0 = (int64_t)c * kHALF_CHUNK;
+		const int n = (int)std::min<int64_t>(kHALF_CHUNK, total - i0);
+		halfToFloat(a + i0, x, n, format);
+		if (b) {
+			halfToFloat(b + i0, y, n, format);
+			for (int i = 0; i < n; i++) x[i] = f(x[i], y[i]);
+		}
+		else {
+			for (int i = 0; i < n; i++) x[i] = f(x[i], 0.f);
+		}
+		floatToHalf(x, out + i0, n, format);
+	}
+}
+
+// preprocess plugin 과 같은 계산 (NHWC BGR uint8 -> NCHW RGB float)
+// 연속된 axes 구간으로 정규화 (평균, 분산 두 번 순회), channel_axis_ 기준 scale, shift
+static void layerNorm(const Layer& l, const Dims& dims, const float* in, float* out)
+{
+	const int nb = dims.nbDims;
+	int a0 = nb, a1 = -1;
+	for (int i = 0; i < nb; i++) {
+		if (l.axes_ & (1u << i)) { a0 = std::min(a0, i); a1 = i; }
+	}
+	const int64_t outer = product(dims, 0, a0), R = product(dims, a0, a1 + 1), inner = product(dims, a1 + 1, nb);
+	const int64_t c_inner = product(dims, l.channel_axis_ + 1, nb);
+	const int channels = dims.d[l.channel_axis_];
+	const float* shift = l.shift_.empty() ? nullptr : l.shift_.data();
+	const float* sc = l.scale_.empty() ? nullptr : l.scale_.data();
+#pragma omp parallel for schedule(static)
+	for (int t = 0; t < (int)(outer * inner); t++) {
+		const int64_t o = t / inner, i = t % inner;
+		const float* x = in + o * R * inner + i;
+		float* y = out + o * R * inner + i;
+		double mean = 0.0, var = 0.0;
+		for (int64_t r = 0; r < R; r++) mean += x[r * inner];
+		mean /= R;
+		for (int64_t r = 0; r < R; r++) {
+			const double d = x[r * inner] - mean;
+			var += d * d;
+		}
+		const float inv = 1.f / std::sqrt((float)(var / R) + l.epsilon_);
+		for (int64_t r = 0; r < R; r++) {
+			const int64_t idx = (o * R + r) * inner + i;
+			const int c = (int)((idx / c_inner) % channels);
+			float v = (x[r * inner] - (float)mean) * inv;
+			if (sc) v *= sc[c];
+			if (shift) v += shift[c];
+			y[r * inner] = v;
+		}
+	}
+}
+
+static void preprocess(const PreprocessParam& p, const uint8_t* in, float* out)
+{
+	const int HW = p.H * p.W;
+	for (int c = 0; c < p.C; c++) {
+		const int src_c = p.C - 1 - c;
+		const float mean = p.preproc_type == 1 ? p.mean[c] : 0.f;
+		const float inv_std = p.preproc_type == 1 ? 1.f / p.std[c] : 1.f;
+		float* dst = out + (int64_t)c * HW;
+#pragma omp parallel for schedule(static)
+		for (int i = 0; i < HW; i++) {
+			dst[i] = (in[(int64_t)i * p.C + src_c] / 255.f - mean) * inv_std;
+		}
+	}
+}
+
+// yololayer plugin 과 같은 계산 (input [3, H, W, CLASS_NUM + 5] -> [3 * H * W, 6] x, y, w, h, conf, class)
+static void yololayer(const YololayerParam& p, const float* in, const float* anchor_grid, float* out)
+{
+	const int C = p.CLASS_NUM + 5;
+	const int count = 3 * p.H * p.W;
+#pragma omp parallel for schedule(static)
+	for (int o = 0; o < count; o++) {
+		const float* v = in + (int64_t)o * C;
+		float* r = out + (int64_t)o * 6;
+		const int w_idx = o % p.W;
+		const int h_idx = (o / p.W) % p.H;
+		const int a_idx = (o / (p.W * p.H)) % 3 * 2;
+		r[0] = (v[0] * 2.f - 0.5f + w_idx) * p.Grid_stride;
+		r[1] = (v[1] * 2.f - 0.5f + h_idx) * p.Grid_stride;
+		r[2] = v[2] * v[2] * 4.f * anchor_grid[a_idx] * p.Grid_stride;
+		r[3] = v[3] * v[3] * 4.f * anchor_grid[a_idx + 1] * p.Grid_stride;
+		const float box_prob = v[4];
+		if (box_prob < 0.1f) {
+			r[4] = 0.f;
+			r[5] = -1.f;
+		}
+		else {
+			int class_id = 0;
+			float max_cls_prob = 0.f;
+			for (int i = 5; i < C; i++) {
+				if (v[i] > max_cls_prob) {
+					max_cls_prob = v[i];
+					class_id = i - 5;
+				}
+			}
+			r[4] = box_prob * max_cls_prob;
+			r[5] = (float)class_id;
+		}
+	}
+}
+
+TensorDiff diffTensors(const float* a, const float* b, size_t count)
+{
+	TensorDiff d{ 0.0, 0.0, 0.0, 0.0, count };
+	double dot = 0.0, na = 0.0, nb = 0.0;
+	for (size_t i = 0; i < count; i++) {
+		const double diff = std::fabs((double)a[i] - b[i]);
+		d.max_abs = std::max(d.max_abs, diff);
+		d.mean_abs += diff;
+		d.max_rel = std::max(d.max_rel, diff / std::max(std::fabs((double)b[i]), 1e-6));
+		dot += (double)a[i] * b[i];
+		na += (double)a[i] * a[i];
+		nb += (double)b[i] * b[i];
+	}
+	if (count) d.mean_abs /= count;
+	d.cosine = (na > 0.0 && nb > 0.0) ? dot / std::sqrt(na * nb) : (na == nb ? 1.0 : 0.0);
+	return d;
+}
+
+std::ostream& operator<<(std::ostream& os, const TensorDiff& diff)
+{
+	return os << "max abs " << diff.max_abs << ", mean abs " << diff.mean_abs << ", max rel " << diff.max_rel
+		<< ", cosine " << std::setprecision(8) << diff.cosine << std::setprecision(6) << " (" << diff.count << " values)";
+}
+
+int64_t layerFlops(const Layer& layer)
+{
+	switch (layer.getType()) {
+	case LayerType::kCONVOLUTION:
+	case LayerType::kDECONVOLUTION: {
+		const Dims in = layer.getInput(0)->getDimensions();
+		const Dims out = layer.getOutput(0)->getDimensions();
+		const int64_t cin = in.d[in.nbDims - 3] / layer.groups_;
+		const int64_t spatial = layer.getType() == LayerType::kCONVOLUTION ? volume(out) : volume(in) / in.d[in.nbDims - 3] * out.d[out.nbDims - 3];
+		return 2 * spatial * cin * volume(layer.kernel_);
+	}
+	case LayerType::kFULLY_CONNECTED:
+		return 2 * volume(layer.getOutput(0)->getDimensions()) * (int64_t)(layer.kernel_weights_.size() / layer.nb_outputs_);
+	case LayerType::kMATRIX_MULTIPLY: {
+		const Dims a = layer.getInput(0)->getDimensions();
+		const int64_t k = layer.op0_ == MatrixOperation::kTRANSPOSE ? a.d[a.nbDims - 2] : a.d[a.nbDims - 1];
+		return 2 * volume(layer.getOutput(0)->getDimensions()) * k;
+	}
+	case LayerType::kATTENTION: {
+		// q k^T, p v 두 행렬 곱
+		const Dims q = layer.getInput(0)->getDimensions();
+		return 4 * volume(q) * layer.getInput(1)->getDimensions().d[0];
+	}
+	default:
+		return 0;
+	}
+}
+
+// INT8 로 실행할 수 있는 레이어 입력 (batch 텐서, dynamic range 설정됨)
+static bool quantizable(const Tensor* input)
+{
+	return input->isBatched() && input->dynamicRangeIsSet();
+}
+
+static float inputScale(const Tensor* input)
+{
+	return int8Scale(std::max(std::fabs(input->getDynamicRangeMin()), std::fabs(input->getDynamicRangeMax())));
+}
+
+CpuInterpreter::CpuInterpreter(const Network& network, int maxBatchSize, int threads, CpuPrecision precision, bool planMemory, bool planLayout)
+	: network_(network), max_batch_(maxBatchSize), batch_(maxBatchSize), half_(precision == CpuPrecision::kFP16 || precision == CpuPrecision::kBF16),
+	half_format_(precision == CpuPrecision::kBF16 ? HalfFormat::kBF16 : HalfFormat::kFP16), activation_bytes_(0), dump_(nullptr), constants_ready_(false), run_count_(0)
+{
+#ifdef _OPENMP
+	if (threads > 0) omp_set_num_threads(threads);
+#endif
+	buffers_.resize(network.getNbTensors());
+	raw_inputs_.resize(network.getNbTensors());
+	storage_.resize(network.getNbTensors());
+	batch_stride_.resize(network.getNbTensors());
+	converted_.resize(network.getNbTensors());
+	half_buffers_.resize(network.getNbTensors());
+	half_storage_.resize(network.getNbTensors());
+	// 16 bit 저장 텐서 : batch 중간 텐서 중 network 출력과 index (topk 출력 1, gather 입력 1) 제외
+	std::vector<int> element_bytes(network.getNbTensors(), (int)sizeof(float));
+	if (half_) {
+		std::vector<char> index(network.getNbTensors(), 0);
+		for (int i = 0; i < network.getNbLayers(); i++) {
+			const Layer* l = network.getLayer(i);
+			if (l->getType() == LayerType::kTOPK) index[l->getOutput(1)->id()] = 1;
+			if (l->getType() == LayerType::kGATHER) index[l->getInput(1)->id()] = 1;
+		}
+		for (int i = 0; i < network.getNbTensors(); i++) {
+			const Tensor* t = network.getTensor(i);
+			if (t->isBatched() && !t->isNetworkInput() && !t->isNetworkOutput() && !index[t->id()]) element_bytes[t->id()] = (int)sizeof(uint16_t);
+		}
+		if (planLayout) std::cerr << "[WARNING] layout planning is ignored with " << halfFormatName(half_format_) << " activations" << std::endl;
+		planLayout = false;
+	}
+	std::vector<int64_t> offsets(network.getNbTensors(), -1);
+	if (planMemory) {
+		const MemoryPlan plan = ::planMemory(network, maxBatchSize, PlanStrategy::kGREEDY_BY_SIZE, true, &element_bytes);
+		arena_.resize((size_t)(plan.arena_bytes / sizeof(float)));
+		offsets = plan.offsets;
+		activation_bytes_ = plan.arena_bytes;
+		if (planLayout) std::cerr << "[WARNING] layout planning is ignored with memory planning" << std::endl;
+	}
+	else if (planLayout) {
+		// INT8 conv 는 NCHW kernel 만 있음
+		layout_ = planLayouts(network, precision == CpuPrecision::kFP32);
+	}
+	for (int i = 0; i < network.getNbTensors(); i++) {
+		const Tensor* t = network.getTensor(i);
+		const int64_t vol = volume(t->getDimensions());
+		const size_t count = (size_t)vol * (t->isBatched() ? maxBatchSize : 1);
+		batch_stride_[t->id()] = vol;
+		if (!layout_.convert.empty() && layout_.convert[t->id()]) {
+			converted_[t->id()].resize(count);
+			activation_bytes_ += count * sizeof(float);
+		}
+		const bool half = element_bytes[t->id()] == (int)sizeof(uint16_t);
+		if (offsets[t->id()] >= 0) {
+			if (half) half_storage_[t->id()] = reinterpret_cast<uint16_t*>(reinterpret_cast<char*>(arena_.data()) + offsets[t->id()]);
+			else storage_[t->id()] = arena_.data() + offsets[t->id()] / sizeof(float);
+			continue;
+		}
+		if (half) {
+			half_buffers_[t->id()].resize(count);
+			half_storage_[t->id()] = half_buffers_[t->id()].data();
+			if (!planMemory) activation_bytes_ += count * sizeof(uint16_t);
+			continue;
+		}
+		if (!layout_.concat_root.empty() && layout_.concat_root[t->id()] >= 0) continue;
+		buffers_[t->id()].resize(count);
+		storage_[t->id()] = buffers_[t->id()].data();
+		if (!planMemory && t->isBatched() && !t->isNetworkInput()) activation_bytes_ += count * sizeof(float);
+	}
+	// zero-copy concat 입력 : concat 출력 (중첩되면 가장 바깥 출력) 의 구간을 사용
+	for (int i = 0; i < (int)layout_.concat_root.size(); i++) {
+		int64_t offset = 0;
+		int root = i;
+		for (; layout_.concat_root[root] >= 0; root = layout_.concat_root[root]) offset += layout_.concat_offset[root];
+		if (root == i) continue;
+		storage_[i] = storage_[root] + offset;
+		batch_stride_[i] = batch_stride_[root];
+	}
+	// 연속된 stride 1 max pooling (SPPF) : 첫 레이어가 plane 단위로 모든 단계를 계산
+	// 뒤 레이어의 출력을 먼저 쓰므로 수명 기준으로 버퍼를 공유하는 planMemory 에서는 사용하지 않음
+	if (!planMemory) {
+		std::map<const Tensor*, std::vector<const Layer*>> users;
+		for (int i = 0; i < network.getNbLayers(); i++) {
+			const Layer* l = network.getLayer(i);
+			for (int k = 0; k < l->getNbInputs(); k++) users[l->getInput(k)].push_back(l);
+		}
+		for (int i = 0; i < network.getNbLayers(); i++) {
+			const Layer* head = network.getLayer(i);
+			if (head->getType() != LayerType::kPOOLING || !stride1MaxPool(*head) || chained_pools_.count(head) || !head->getOutput(0)->isBatched()) continue;
+			for (const Layer* cur = head;;) {
+				const Layer* next = nullptr;
+				int count = 0;
+				for (const Layer* u : users[cur->getOutput(0)]) {
+					if (u->getType() == LayerType::kPOOLING && stride1MaxPool(*u)) {
+						next = u;
+						count++;
+					}
+				}
+				// 16 bit 는 저장 형식이 같은 단계끼리만
+				if (count != 1 || (half_storage_[next->getOutput(0)->id()] != nullptr) != (half_storage_[head->getOutput(0)->id()] != nullptr)) break;
+				pool_chains_[head].push_back(next);
+				chained_pools_.insert(next);
+				cur = next;
+			}
+		}
+	}
+	for (int i = 0; i < network.getNbLayers(); i++) {
+		const Layer* l = network.getLayer(i);
+		profile_.push_back({ l->getName(), l->getType(), 0.0, layerFlops(*l) });
+		const bool int8 = precision == CpuPrecision::kINT8 && l->getNbInputs() > 0 && quantizable(l->getInput(0));
+		const float* bias = l->bias_weights_.empty() ? nullptr : l->bias_weights_.data();
+		if (l->getType() == LayerType::kCONVOLUTION) {
+			const ConvActivation act{ l->fused_activation_, l->activation_, l->alpha_, l->beta_ };
+			const ConvShape shape = convShapeOf(*l);
+			if (int8 && CpuInt8Conv::supports(shape))
+				int8_convs_[l].reset(new CpuInt8Conv(shape, l->kernel_weights_.data(), bias, inputScale(l->getInput(0)), act));
+			else if (!layout_.blocked_layers.empty() && layout_.blocked_layers[i])
+				convs_[l].reset(new CpuConv(shape, l->kernel_weights_.data(), bias, ConvAlgo::kDIRECT_NCHWC, act));
+			else if (KernelTuner* tuner = kernelTuner()) {
+				const ConvTactic tactic = tuner->tuneConv(shape, l->kernel_weights_.data(), bias, act);
+				convs_[l].reset(new CpuConv(shape, l->kernel_weights_.data(), bias, tactic.algo, act));
+				convs_[l]->setSchedule(tactic.tile, tactic.threads);
+			}
+			else
+				convs_[l].reset(new CpuConv(shape, l->kernel_weights_.data(), bias, ConvAlgo::kAUTO, act));
+		}
+		else if (l->getType() == LayerType::kFULLY_CONNECTED) {
+			const ConvActivation act{ l->fused_activation_, l->activation_, l->alpha_, l->beta_ };
+			const int K = (int)(l->kernel_weights_.size() / l->nb_outputs_);
+			if (int8)
+				int8_gemms_[l].reset(new CpuInt8Gemm(l->nb_outputs_, K, l->kernel_weights_.data(), bias, inputScale(l->getInput(0)), act));
+			else if (KernelTuner* tuner = kernelTuner()) {
+				const GemmTactic tactic = tuner->tuneGemm(maxBatchSize, l->nb_outputs_, K, l->kernel_weights_.data(), bias, act);
+				gemms_[l].reset(new CpuGemm(l->nb_outputs_, K, l->kernel_weights_.data(), bias, act, tactic.isa));
+				gemms_[l]->setThreads(tactic.threads);
+			}
+			else
+				gemms_[l].reset(new CpuGemm(l->nb_outputs_, K, l->kernel_weights_.data(), bias, act));
+		}
+	}
+}
+
+void CpuInterpreter::setInput(const std::string& name, const uint8_t* data)
+{
+	const Tensor* t = network_.findTensor(name);
+	assert(t && t->isNetworkInput());
+	const size_t count = (size_t)volume(t->getDimensions()) * max_batch_;
+	raw_inputs_[t->id()].assign(data, data + count);
+	float* buf = storage_[t->id()];
+	for (size_t i = 0; i < count; i++) buf[i] = data[i];
+}
+
+void CpuInterpreter::setInput(const std::string& name, const float* data)
+{
+	const Tensor* t = network_.findTensor(name);
+	assert(t && t->isNetworkInput());
+	memcpy(storage_[t->id()], data, (size_t)volume(t->getDimensions()) * max_batch_ * sizeof(float));
+	raw_inputs_[t->id()].clear();
+}
+
+float* CpuInterpreter::data(const Tensor* tensor, int b)
+{
+	return storage_[tensor->id()] + (tensor->isBatched() ? b * batch_stride_[tensor->id()] : 0);
+}
+
+const float* CpuInterpreter::cdata(const Tensor* tensor, int b) const
+{
+	return storage_[tensor->id()] + (tensor->isBatched() ? b * batch_stride_[tensor->id()] : 0);
+}
+
+uint16_t* CpuInterpreter::halfData(const Tensor* tensor, int b) const
+{
+	return half_storage_[tensor->id()] + (tensor->isBatched() ? b * batch_stride_[tensor->id()] : 0);
+}
+
+const float* CpuInterpreter::input(const Tensor* tensor, int b, bool blocked) const
+{
+	const bool stored_blocked = !layout_.layouts.empty() && layout_.layouts[tensor->id()] == TensorLayout::kNCHWC;
+	if (stored_blocked == blocked) return cdata(tensor, b);
+	return converted_[tensor->id()].data() + (tensor->isBatched() ? (size_t)b * volume(tensor->getDimensions()) : 0);
+}
+
+const float* CpuInterpreter::getTensor(const Tensor* tensor) const
+{
+	if (!converted_[tensor->id()].empty() && layout_.layouts[tensor->id()] == TensorLayout::kNCHWC) return converted_[tensor->id()].data();
+	return storage_[tensor->id()];
+}
+
+const float* CpuInterpreter::getOutput(const std::string& name) const
+{
+	const Tensor* t = network_.findTensor(name);
+	return t ? getTensor(t) : nullptr;
+}
+
+void CpuInterpreter::run(int batchSize)
+{
+	beginRun(batchSize);
+	for (int i = 0; i < network_.getNbLayers(); i++) runLayer(i);
+	endRun();
+}
+
+void CpuInterpreter::beginRun(int batchSize)
+{
+	assert(batchSize <= max_batch_);
+	batch_ = batchSize;
+}
+
+void CpuInterpreter::runLayer(int index)
+{
+	const Layer* l = network_.getLayer(index);
+	const bool batched = l->getOutput(0)->isBatched();
+	if (!batched && constants_ready_) return;
+	auto t0 = std::chrono::high_resolution_clock::now();
+	// fully connected 는 batch 전체를 GEMM 한번으로 실행
+	const int calls = batched && l->getType() != LayerType::kFULLY_CONNECTED ? batch_ : 1;
+	const bool blocked = !layout_.blocked_layers.empty() && layout_.blocked_layers[index];
+	const bool chained = chained_pools_.count(l) > 0;	// 앞 pooling 레이어가 이미 계산
+	for (int b = 0; !chained && b < calls; b++) {
+		execute(*l, b, blocked);
+	}
+	convertOutputs(*l);
+	auto t1 = std::chrono::high_resolution_clock::now();
+	profile_[index].total_ms += std::chrono::duration<double, std::milli>(t1 - t0).count();
+	if (dump_) dumpOutputs(*l);	// 기록 시간은 profile 에서 제외
+	if (layer_callback_) layer_callback_(*l);
+}
+
+void CpuInterpreter::endRun()
+{
+	constants_ready_ = true;
+	run_count_++;
+}
+
+void CpuInterpreter::evaluateConstants()
+{
+	for (int i = 0; i < network_.getNbLayers(); i++) {
+		const Layer* l = network_.getLayer(i);
+		if (!l->getOutput(0)->isBatched()) execute(*l, 0, false);
+	}
+	constants_ready_ = true;
+}
+
+// planLayout : 다른 layout 을 읽는 레이어가 있는 출력을 변환 (NCHWc <-> NCHW)
+void CpuInterpreter::convertOutputs(const Layer& l)
+{
+	if (layout_.convert.empty()) return;
+	for (int k = 0; k < l.getNbOutputs(); k++) {
+		const Tensor* t = l.getOutput(k);
+		if (!layout_.convert[t->id()]) continue;
+		const Dims d = t->getDimensions();
+		const int C = d.d[0], HW = (int)product(d, 1, d.nbDims);
+		for (int b = 0; b < (t->isBatched() ? batch_ : 1); b++) {
+			float* dst = converted_[t->id()].data() + (size_t)b * volume(d);
+			if (layout_.layouts[t->id()] == TensorLayout::kNCHWC) nchwcToNchw(cdata(t, b), C, HW, dst);
+			else nchwToNchwc(cdata(t, b), C, HW, dst);
+		}
+	}
+}
+
+// 출력을 sample 순서대로 모아서 기록 (zero-copy concat 입력의 batch 간격, NCHWc 저장은 NCHW 로 정리)
+void CpuInterpreter::dumpOutputs(const Layer& l)
+{
+	for (int k = 0; k < l.getNbOutputs(); k++) {
+		const Tensor* t = l.getOutput(k);
+		if (!dump_->wants(t->getName())) continue;
+		const Dims d = t->getDimensions();
+		const int samples = t->isBatched() ? batch_ : 1;
+		const int64_t count = volume(d);
+		std::vector<int> dims;
+		if (t->isBatched()) dims.push_back(batch_);
+		dims.insert(dims.end(), d.d, d.d + d.nbDims);
+		if (half_storage_[t->id()]) {
+			std::vector<uint16_t> v((size_t)(count * samples));
+			for (int b = 0; b < samples; b++) memcpy(v.data() + b * count, halfData(t, b), (size_t)count * sizeof(uint16_t));
+			dump_->append(t->getName(), l.getName(), half_format_ == HalfFormat::kFP16 ? kDUMP_FLOAT16 : kDUMP_BFLOAT16, (int)dims.size(), dims.data(), v.data(), run_count_);
+			continue;
+		}
+		const bool stored_blocked = !layout_.layouts.empty() && layout_.layouts[t->id()] == TensorLayout::kNCHWC;
+		std::vector<float> v((size_t)(count * samples));
+		for (int b = 0; b < samples; b++) {
+			if (stored_blocked) nchwcToNchw(cdata(t, b), d.d[0], (int)product(d, 1, d.nbDims), v.data() + b * count);
+			else memcpy(v.data() + b * count, cdata(t, b), (size_t)count * sizeof(float));
+		}
+		dump_->append(t->getName(), l.getName(), kDUMP_FLOAT32, (int)dims.size(), dims.data(), v.data(), run_count_);
+	}
+}
+
+void CpuInterpreter::execute(const Layer& l, int b, bool blocked)
+{
+	if (half_ && executeHalf(l, b)) return;
+	// 16 bit 텐서 : 입력은 float 복사본으로 변환해서 읽고, 출력은 복사본에 계산한 뒤 변환 (fully connected 는 batch 전체)
+	std::vector<std::vector<float>> staged;
+	std::vector<const Tensor*> staged_outputs;
+	std::vector<float*> staged_results;
+	auto stagedCount = [&](const Tensor* t) { return volume(t->getDimensions()) * (l.getType() == LayerType::kFULLY_CONNECTED ? batch_ : 1); };
+	auto src = [&](int k) -> const float* {
+		const Tensor* t = l.getInput(k);
+		if (!half_storage_[t->id()]) return input(t, b, blocked);
+		staged.emplace_back((size_t)stagedCount(t));
+		halfToFloat(halfData(t, b), staged.back().data(), stagedCount(t), half_format_);
+		return staged.back().data();
+	};
+	auto dst = [&](int k) -> float* {
+		const Tensor* t = l.getOutput(k);
+		if (!half_storage_[t->id()]) return data(t, b);
+		staged.emplace_back((size_t)stagedCount(t));
+		staged_outputs.push_back(t);
+		staged_results.push_back(staged.back().data());
+		return staged.back().data();
+	};
+	const Tensor* in0 = l.getNbInputs() > 0 ? l.getInput(0) : nullptr;
+	const Dims in_dims = in0 ? in0->getDimensions() : Dims{};
+	const Dims out_dims = l.getOutput(0)->getDimensions();
+	const float* in = in0 ? src(0) : nullptr;
+	float* out = dst(0);
+	const int64_t total = volume(out_dims);
+
+	switch (l.getType()) {
+	case LayerType::kCONVOLUTION:
+		if (int8_convs_.count(&l)) int8_convs_.at(&l)->forward(in, out);
+		else if (blocked) convs_.at(&l)->forwardBlocked(in, out);
+		else convs_.at(&l)->forward(in, out);
+		break;
+	case LayerType::kDECONVOLUTION:
+		deconvolution(l, in_dims, in, out_dims, out);
+		break;
+	case LayerType::kFULLY_CONNECTED: {
+		// batch 전체를 행으로 한번에 계산 (run 에서 b == 0 으로 한번만 호출)
+		const int rows = (int)product(in_dims, 0, in_dims.nbDims - 3) * (in0->isBatched() ? batch_ : 1);
+		if (int8_gemms_.count(&l)) int8_gemms_.at(&l)->run(rows, in, out);
+		else gemms_.at(&l)->run(rows, in, out);
+		break;
+	}
+	case LayerType::kACTIVATION:
+#pragma omp parallel for schedule(static)
+		for (int i = 0; i < (int)total; i++) out[i] = activate(in[i], l.activation_, l.alpha_, l.beta_);
+		break;
+	case LayerType::kPOOLING: {
+		auto chain = pool_chains_.find(&l);
+		if (chain == pool_chains_.end()) {
+			pooling(l, in_dims, in, out_dims, out);
+			break;
+		}
+		const int nb = in_dims.nbDims;
+		std::vector<MaxPoolStage> stages{ maxPoolStage(l, out) };
+		for (const Layer* next : chain->second) stages.push_back(maxPoolStage(*next, data(next->getOutput(0), b)));
+		maxPoolCascade(in, (int)product(in_dims, 0, nb - 2), in_dims.d[nb - 2], in_dims.d[nb - 1], stages.data(), (int)stages.size());
+		break;
+	}
+	case LayerType::kSCALE:
+		scale(l, in_dims, in, out);
+		break;
+	case LayerType::kSOFTMAX:
+		softmax(l, in_dims, in, out);
+		break;
+	case LayerType::kCONCATENATION: {
+		std::vector<const float*> ins;
+		for (int i = 0; i < l.getNbInputs(); i++) ins.push_back(src(i));
+		concatenation(l, ins, out_dims, out);
+		break;
+	}
+	case LayerType::kELEMENTWISE:
+		elementwise(l, in_dims, in, l.getInput(1)->getDimensions(), src(1), out_dims, out);
+		break;
+	case LayerType::kUNARY:
+#pragma omp parallel for schedule(static)
+		for (int i = 0; i < (int)total; i++) out[i] = unary(in[i], l.unary_op_);
+		break;
+	case LayerType::kPADDING:
+		padding(l, in_dims, in, out_dims, out);
+		break;
+	case LayerType::kSHUFFLE: {
+		// first transpose -> reshape (메모리 변화 없음) -> second transpose
+		std::vector<float> tmp((size_t)total);
+		permute(in, in_dims, l.first_transpose_.order, tmp.data());
+		Dims reshaped = out_dims;
+		for (int i = 0; i < out_dims.nbDims; i++) reshaped.d[l.second_transpose_.order[i]] = out_dims.d[i];
+		permute(tmp.data(), reshaped, l.second_transpose_.order, out);
+		break;
+	}
+	case LayerType::kREDUCE:
+		reduce(l, in_dims, in, out_dims, out);
+		break;
+	case LayerType::kTOPK:
+		topk(l, in_dims, in, out, dst(1));
+		break;
+	case LayerType::kGATHER:
+		gather(l, in_dims, in, l.getInput(1)->getDimensions(), src(1), out);
+		break;
+	case LayerType::kMATRIX_MULTIPLY:
+		matrixMultiply(l, in_dims, in, l.getInput(1)->getDimensions(), src(1), out_dims, out);
+		break;
+	case LayerType::kCONSTANT:
+		memcpy(out, l.constant_.data(), total * sizeof(float));
+		break;
+	case LayerType::kSLICE:
+		slice(l, in_dims, in, out_dims, out);
+		break;
+	case LayerType::kRESIZE:
+		resizePadded(resizeShape(l, in_dims, out_dims), in, out);
+		break;
+	case LayerType::kPREPROCESS: {
+		const std::vector<uint8_t>& raw = raw_inputs_[in0->id()];
+		if (raw.empty()) {
+			std::cerr << "[ERROR] preprocess input must be set as uint8 : " << in0->getName() << std::endl;
+			break;
+		}
+		preprocess(l.preprocess_, raw.data() + (size_t)b * volume(in_dims), out);
+		break;
+	}
+	case LayerType::kYOLOLAYER:
+		yololayer(l.yololayer_, in, src(1), out);
+		break;
+	case LayerType::kLAYER_NORM:
+		layerNorm(l, in_dims, in, out);
+		break;
+	case LayerType::kATTENTION: {
+		const int E = (int)product(in_dims, 1, in_dims.nbDims);
+		attention(in, src(1), src(2), in_dims.d[0], l.getInput(1)->getDimensions().d[0],
+			l.num_heads_, E / l.num_heads_, l.attention_scale_, out);
+		break;
+	}
+	}
+	for (int k = 0; k < (int)staged_outputs.size(); k++) {
+		floatToHalf(staged_results[k], halfData(staged_outputs[k], b), stagedCount(staged_outputs[k]), half_format_);
+	}
+}
+
+// 입출력이 모두 16 bit 인 레이어 중 16 bit kernel 이 있는 레이어 실행 (없으면 false, execute 가 float 로 변환해서 실행)
+bool CpuInterpreter::executeHalf(const Layer& l, int b)
+{
+	if (l.getNbInputs() == 0) return false;
+	for (int k = 0; k < l.getNbInputs(); k++) {
+		if (!half_storage_[l.getInput(k)->id()]) return false;
+	}
+	for (int k = 0; k < l.getNbOutputs(); k++) {
+		if (!half_storage_[l.getOutput(k)->id()]) return false;
+	}
+	const Tensor* in0 = l.getInput(0);
+	const Dims in_dims = in0->getDimensions();
+	const Dims out_dims = l.getOutput(0)->getDimensions();
+	const uint16_t* in = halfData(in0, b);
+	uint16_t* out = halfData(l.getOutput(0), b);
+	const int64_t total = volume(out_dims);
+	const HalfFormat format = half_format_;
+
+	switch (l.getType()) {
+	case LayerType::kCONVOLUTION:
+		convs_.at(&l)->forwardHalf(in, out, format);
+		return true;
+	case LayerType::kACTIVATION:
+		mapHalf(in, nullptr, out, total, format, [&](float x, float) { return activate(x, l.activation_, l.alpha_, l.beta_); });
+		return true;
+	case LayerType::kUNARY:
+		mapHalf(in, nullptr, out, total, format, [&](float x, float) { return unary(x, l.unary_op_); });
+		return true;
+	case LayerType::kELEMENTWISE:
+		if (volume(in_dims) != total || volume(l.getInput(1)->getDimensions()) != total) return false;
+		mapHalf(in, halfData(l.getInput(1), b), out, total, format, [&](float x, float y) { return epilogue(l, binary(x, y, l.elementwise_op_)); });
+		return true;
+	case LayerType::kPOOLING: {
+		const int nb = in_dims.nbDims;
+		auto chain = pool_chains_.find(&l);
+		if (chain == pool_chains_.end() && !stride1MaxPool(l)) {
+			if (format == HalfFormat::kFP16) windowPooling<Fp16Element>(l, in_dims, in, out_dims, out);
+			else windowPooling<Bf16Element>(l, in_dims, in, out_dims, out);
+			return true;
+		}
+		std::vector<MaxPoolStage> stages{ maxPoolStage(l, nullptr) };
+		std::vector<uint16_t*> outs{ out };
+		if (chain != pool_chains_.end()) {
+			for (const Layer* next : chain->second) {
+				stages.push_back(maxPoolStage(*next, nullptr));
+				outs.push_back(halfData(next->getOutput(0), b));
+			}
+		}
+		maxPoolCascade(in, (int)product(in_dims, 0, nb - 2), in_dims.d[nb - 2], in_dims.d[nb - 1], stages.data(), outs.data(), (int)stages.size(), format);
+		return true;
+	}
+	case LayerType::kCONCATENATION: {
+		std::vector<const uint16_t*> ins;
+		for (int i = 0; i < l.getNbInputs(); i++) ins.push_back(halfData(l.getInput(i), b));
+		concatenation(l, ins, out_dims, out);
+		return true;
+	}
+	case LayerType::kPADDING:
+		padding(l, in_dims, in, out_dims, out);
+		return true;
+	case LayerType::kSLICE:
+		slice(l, in_dims, in, out_dims, out);
+		return true;
+	case LayerType::kRESIZE:
+		resizePadded(resizeShape(l, in_dims, out_dims), in, out, format);
+		return true;
+	default:
+		return false;
+	}
+}
+
+void CpuInterpreter::resetProfile()
+{
+	for (auto& p : profile_) p.total_ms = 0.0;
+	run_count_ = 0;
+	constants_ready_ = false;
+}
+
+void CpuInterpreter::printProfile(std::ostream& os, int top) const
+{
+	const int runs = std::max(run_count_, 1);
+	double total = 0.0;
+	for (const auto& p : profile_) total += p.total_ms;
+
+	std::vector<int> order(profile_.size());
+	for (int i = 0; i < (int)order.size(); i++) order[i] = i;
+	if (top > 0) {
+		std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return profile_[a].total_ms > profile_[b].total_ms; });
+		order.resize(std::min((int)order.size(), top));
+	}
+	os << std::fixed << std::setprecision(3);
+	os << "=== layer profile (" << run_count_ << " runs, batch " << batch_ << ") ===" << std::endl;
+	for (int i : order) {
+		const LayerProfile& p = profile_[i];
+		const double ms = p.total_ms / runs;
+		os << std::setw(10) << ms << " ms " << std::setw(6) << std::setprecision(1) << (total > 0.0 ? p.total_ms * 100.0 / total : 0.0) << "%  "
+			<< std::setprecision(3) << std::left << std::setw(15) << ir::layerTypeName(p.type) << std::right << " " << p.name;
+		if (p.flops > 0 && ms > 0.0) os << "  (" << std::setprecision(2) << p.flops * batch_ / (ms * 1e6) << " GFLOP/s)" << std::setprecision(3);
+		os << std::endl;
+	}
+	// 종류별 합계
+	std::map<std::string, std::pair<double, int>> by_type;
+	for (const auto& p : profile_) {
+		auto& e = by_type[ir::layerTypeName(p.type)];
+		e.first += p.total_ms;
+		e.second++;
+	}
+	os << "--- by type ---" << std::endl;
+	for (const auto& e : by_type) {
+		os << std::setw(10) << e.second.first / runs << " ms " << std::setw(6) << std::setprecision(1) << (total > 0.0 ? e.second.first * 100.0 / total : 0.0) << "%  "
+			<< std::setprecision(3) << e.first << " x " << e.second.second << std::endl;
+	}
+	os << "total : " << total / runs << " ms / run" << std::endl;
+	os.unsetf(std::ios::floatfield);
+	os << std::setprecision(6);
+}
@@ -0,0 +1,150 @@
+﻿#pragma once
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <set>
+#include <string>
+#include <vector>
+#include "cpu_conv.hpp"
+#include "cpu_gemm.hpp"
+#include "cpu_half.hpp"
+#include "cpu_int8.hpp"
+#include "graph_ir.hpp"
+#include "layout_planner.hpp"
+#include "memory_planner.hpp"
+#include "tensor_dump.hpp"
+
+// CPU 실행 정밀도
+enum class CpuPrecision {
+	kFP32,
+	kINT8,		// dynamic range 가 설정된 입력을 받는 conv (group 1), fully connected 만 INT8, 나머지는 float
+	kFP16,		// batch 중간 텐서를 IEEE half 로 저장 (계산, 누적은 float, cpu_half.hpp)
+	kBF16,		// batch 중간 텐서를 bfloat16 으로 저장
+};
+
+// 레이어별 실행 시간 (run 호출 누적)
+struct LayerProfile {
+	std::string name;
+	ir::LayerType type;
+	double total_ms;
+	int64_t flops;		// 1 sample 기준 연산량 (conv, deconv, fc, matmul 만, 나머지 0)
+};
+
+// 두 텐서 비교 결과 (TensorRT 출력과 교차 검증)
+struct TensorDiff {
+	double max_abs;
+	double mean_abs;
+	double max_rel;
+	double cosine;
+	size_t count;
+};
+
+TensorDiff diffTensors(const float* a, const float* b, size_t count);
+std::ostream& operator<<(std::ostream& os, const TensorDiff& diff);
+
+// 레이어 연산량 (multiply-add = 2 flops, batch 1)
+int64_t layerFlops(const ir::Layer& layer);
+
+//! \class CpuInterpreter
+//!
+//! \brief ir::Network 를 TensorRT 없이 CPU 에서 실행하는 reference interpreter.
+//!  레이어를 기록된 순서대로 하나씩 실행 (OpenMP 로 레이어 내부 병렬화), 모든 중간 텐서를 보관
+//!  batch 와 무관한 상수 부분 그래프는 첫 실행에서 한번만 계산
+//!  conv 는 생성시 레이어별로 CpuConv (shape 에 맞는 알고리즘, 정렬된 가중치) 준비
+//!  fully connected 는 CpuGemm (panel 정렬된 가중치) 으로 batch 전체를 한번에 실행
+//!  kINT8 이면 calibration 된 conv, fully connected 를 CpuInt8Conv, CpuInt8Gemm 으로 실행 (레이어 사이 텐서는 float)
+//!  planMemory 이면 중간 텐서를 수명 기준으로 하나의 arena 에 배치 (memory_planner.hpp), 이때 getTensor 는 출력, 입력, 상수만 유효
+//!  planLayout 이면 layout_planner.hpp 의 NCHWc 영역과 zero-copy concat 적용 (planMemory 와 함께 쓰면 무시)
+//!  연속된 stride 1 max pooling (SPPF) 은 첫 레이어에서 plane 단위로 함께 계산 (planMemory 가 아닐 때)
+//!  kFP16, kBF16 이면 network 입출력, 상수, index 텐서 (topk, gather) 를 제외한 텐서를 16 bit 로 저장 (planLayout 무시)
+//!   conv, activation, unary, 같은 shape elementwise, pooling, concat, padding, slice, resize 는 16 bit 를 읽으면서 변환하고 결과를 변환해서 씀
+//!   나머지 레이어는 16 bit 입력을 float 복사본으로 변환해서 실행하고 출력을 변환
+//!  setDump 이면 레이어 실행 직후 출력 텐서를 [batch, dims...] NCHW 로 기록 (16 bit 텐서는 16 bit 그대로)
+//!  setLayerCallback 이면 레이어 실행 직후 호출 (planMemory 여도 그 레이어 출력은 getTensor 로 읽을 수 있음, cpu_calibrator.hpp)
+//!
+class CpuInterpreter
+{
+public:
+	// threads : OpenMP thread 수 (0 이면 기본값)
+	CpuInterpreter(const ir::Network& network, int maxBatchSize, int threads = 0, CpuPrecision precision = CpuPrecision::kFP32, bool planMemory = false, bool planLayout = false);
+
+	// network 입력 설정 (batch 크기 만큼 연속된 데이터)
+	// preprocess 레이어의 입력은 uint8 [N,H,W,C] 원본 이미지
+	void setInput(const std::string& name, const uint8_t* data);
+	void setInput(const std::string& name, const float* data);
+
+	void run(int batchSize = 1);
+	// run 을 나눈 단계 (cpu_scheduler.hpp 에서 레이어를 의존성 순서로 동시에 실행할 때 사용)
+	// 서로 다른 레이어의 runLayer 는 동시에 호출 가능 (출력 텐서, profile 항목이 레이어별로 분리), planMemory 이면 순서대로만 실행
+	void beginRun(int batchSize);
+	void runLayer(int index);
+	void endRun();
+	bool memoryPlanned() const { return !arena_.empty(); }
+	// planLayout 결과 (적용하지 않았으면 빈 plan)
+	const LayoutPlan& layoutPlan() const { return layout_; }
+	// batch 와 무관한 상수 부분 그래프만 실행 (constant folding 용, 입력 불필요)
+	void evaluateConstants();
+	// 이후 실행의 레이어 출력을 writer 에 기록 (nullptr 이면 기록 안함, writer 의 filter 적용)
+	void setDump(TensorDumpWriter* writer) { dump_ = writer; }
+	// 이후 실행에서 레이어마다 실행 직후 호출 (빈 함수면 호출 안함, 상수 레이어는 첫 실행에서만)
+	void setLayerCallback(std::function<void(const ir::Layer&)> callback) { layer_callback_ = std::move(callback); }
+
+	// 실행 결과 ([batch, dims...], 상수 텐서는 batch 차원 없음)
+	// planLayout : NCHW 복사본이 없는 NCHWc 텐서는 NCHWc 로, zero-copy concat 입력은 batch 간격이 concat 출력 크기
+	const float* getTensor(const ir::Tensor* tensor) const;
+	const float* getOutput(const std::string& name) const;
+	// kFP16, kBF16 : 16 bit 로 저장된 텐서 (getTensor 는 nullptr), float 텐서면 nullptr
+	const uint16_t* getHalfTensor(const ir::Tensor* tensor) const { return half_storage_[tensor->id()]; }
+	HalfFormat halfFormat() const { return half_format_; }
+	const ir::Network& network() const { return network_; }
+	// 입력, 상수를 제외한 중간 텐서 메모리 (arena 또는 텐서별 버퍼 합, byte)
+	int64_t activationBytes() const { return activation_bytes_; }
+	// INT8 로 실행하는 레이어 수
+	int int8LayerCount() const { return (int)(int8_convs_.size() + int8_gemms_.size()); }
+
+	const std::vector<LayerProfile>& profile() const { return profile_; }
+	int runCount() const { return run_count_; }
+	void resetProfile();
+	// 레이어별 평균 시간, 종류별 합계 (top > 0 이면 느린 순서 top 개만)
+	void printProfile(std::ostream& os, int top = 0) const;
+
+private:
+	void execute(const ir::Layer& layer, int b, bool blocked);
+	bool executeHalf(const ir::Layer& layer, int b);
+	void convertOutputs(const ir::Layer& layer);
+	void dumpOutputs(const ir::Layer& layer);
+	float* data(const ir::Tensor* tensor, int b);
+	const float* cdata(const ir::Tensor* tensor, int b) const;
+	uint16_t* halfData(const ir::Tensor* tensor, int b) const;
+	// blocked 레이어가 읽는 layout 의 입력 (저장 layout 이 다르면 변환 복사본)
+	const float* input(const ir::Tensor* tensor, int b, bool blocked) const;
+
+	const ir::Network& network_;
+	int max_batch_;
+	int batch_;
+	std::vector<std::vector<float>> buffers_;		// tensor id 별 버퍼 (arena 에 배치된 텐서는 비어 있음)
+	std::vector<float> arena_;						// planMemory : 중간 텐서 공용 영역
+	std::vector<float*> storage_;					// tensor id 별 시작 주소 (buffers_, arena_ 또는 concat 출력 안)
+	std::vector<int64_t> batch_stride_;				// tensor id 별 sample 간격 (원소 개수)
+	bool half_;										// kFP16, kBF16
+	HalfFormat half_format_;
+	std::vector<std::vector<uint16_t>> half_buffers_;	// 16 bit 텐서 버퍼 (arena 에 배치된 텐서는 비어 있음)
+	std::vector<uint16_t*> half_storage_;			// tensor id 별 16 bit 시작 주소 (float 텐서는 nullptr)
+	LayoutPlan layout_;
+	std::vector<std::vector<float>> converted_;		// planLayout : 다른 layout 복사본
+	int64_t activation_bytes_;
+	std::vector<std::vector<uint8_t>> raw_inputs_;	// uint8 입력
+	std::vector<LayerProfile> profile_;
+	std::map<const ir::Layer*, std::unique_ptr<CpuConv>> convs_;	// conv 레이어별 정렬된 가중치, 알고리즘
+	std::map<const ir::Layer*, std::unique_ptr<CpuGemm>> gemms_;	// fully connected 레이어별 정렬된 가중치
+	std::map<const ir::Layer*, std::unique_ptr<CpuInt8Conv>> int8_convs_;	// kINT8 : 양자화된 conv
+	std::map<const ir::Layer*, std::unique_ptr<CpuInt8Gemm>> int8_gemms_;	// kINT8 : 양자화된 fully connected
+	std::map<const ir::Layer*, std::vector<const ir::Layer*>> pool_chains_;	// stride 1 max pooling 연속의 첫 레이어 -> 함께 계산하는 뒤 레이어
+	std::set<const ir::Layer*> chained_pools_;
+	TensorDumpWriter* dump_;
+	std::function<void(const ir::Layer&)> layer_callback_;
+	bool constants_ready_;
+	int run_count_;
+};
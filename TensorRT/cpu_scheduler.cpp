@@ -0,0 +1,513 @@
+﻿#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include "cpu_scheduler.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace ir;
+
+static void setThreads(int threads)
+{
+#ifdef _OPENMP
+	omp_set_num_threads(threads);
+#endif
+}
+
+CostModel defaultCostModel()
+{
+	// AVX2 FMA 한 core 의 conv, GEMM 실측 수준, 한 core 가 낼 수 있는 memory 대역폭
+	return CostModel{ 20.0, 8.0, 2.0, 40.0 };
+}
+
+static int64_t tensorBytes(const Tensor* t, int batchSize)
+{
+	return volume(t->getDimensions()) * (t->isBatched() ? batchSize : 1) * (int64_t)sizeof(float);
+}
+
+LayerDag buildLayerDag(const Network& network, int batchSize, int threads, const CostModel& model)
+{
+	const int nb_layers = network.getNbLayers();
+	LayerDag dag;
+	dag.successors.resize(nb_layers);
+	dag.nb_predecessors.assign(nb_layers, 0);
+	dag.cost_us.resize(nb_layers);
+	dag.width.resize(nb_layers);
+
+	std::vector<int> producer(network.getNbTensors(), -1);
+	for (int i = 0; i < nb_layers; i++) {
+		const Layer* l = network.getLayer(i);
+		for (int k = 0; k < l->getNbOutputs(); k++) producer[l->getOutput(k)->id()] = i;
+	}
+	for (int i = 0; i < nb_layers; i++) {
+		const Layer* l = network.getLayer(i);
+		int64_t bytes = (int64_t)l->kernel_weights_.size() * sizeof(float);
+		std::vector<int> preds;
+		for (int k = 0; k < l->getNbInputs(); k++) {
+			const Tensor* in = l->getInput(k);
+			bytes += tensorBytes(in, batchSize);
+			const int p = producer[in->id()];
+			if (p >= 0 && std::find(preds.begin(), preds.end(), p) == preds.end()) preds.push_back(p);
+		}
+		for (int k = 0; k < l->getNbOutputs(); k++) bytes += tensorBytes(l->getOutput(k), batchSize);
+		for (int p : preds) dag.successors[p].push_back(i);
+		dag.nb_predecessors[i] = (int)preds.size();
+
+		const int64_t flops = layerFlops(*l) * (l->getOutput(0)->isBatched() ? batchSize : 1);
+		dag.cost_us[i] = std::max(flops / (model.gflops * 1e3), bytes / (model.gbytes * 1e3)) + model.overhead_us;
+		dag.width[i] = std::max(1, std::min(threads, (int)(dag.cost_us[i] / model.grain_us)));
+	}
+	return dag;
+}
+
+double criticalPath(const LayerDag& dag, const std::vector<double>& cost, std::vector<int>* path)
+{
+	// 레이어 index 가 위상 순서 (입력은 항상 앞 레이어가 생성)
+	const int n = (int)cost.size();
+	std::vector<double> finish(n, 0.0);
+	std::vector<int> from(n, -1);
+	int last = -1;
+	for (int i = 0; i < n; i++) {
+		finish[i] += cost[i];
+		if (last < 0 || finish[i] > finish[last]) last = i;
+		for (int s : dag.successors[i]) {
+			if (finish[i] > finish[s]) {
+				finish[s] = finish[i];
+				from[s] = i;
+			}
+		}
+	}
+	if (path) {
+		path->clear();
+		for (int i = last; i >= 0; i = from[i]) path->push_back(i);
+		std::reverse(path->begin(), path->end());
+	}
+	return last < 0 ? 0.0 : finish[last];
+}
+
+/* ------ work-stealing pool ------ */
+
+WorkStealingPool::WorkStealingPool(int threads)
+	: threads_(std::max(1, threads)), generation_(0), active_(0), stop_(false), dag_(nullptr), task_(nullptr),
+	remaining_(0), queued_(0), spare_(0), steals_(0)
+{
+	for (int i = 0; i < threads_; i++) queues_.emplace_back(new Queue);
+	for (int i = 1; i < threads_; i++) workers_.emplace_back(&WorkStealingPool::workerLoop, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	start_cv_.notify_all();
+	for (auto& w : workers_) w.join();
+}
+
+void WorkStealingPool::run(const LayerDag& dag, const std::function<void(int, int)>& task)
+{
+	const int n = (int)dag.nb_predecessors.size();
+	if (n == 0) return;
+	const int omp_threads = maxThreads();
+	dag_ = &dag;
+	task_ = &task;
+	pending_.reset(new std::atomic<int>[n]);
+	for (int i = 0; i < n; i++) pending_[i] = dag.nb_predecessors[i];
+	remaining_ = n;
+	queued_ = 0;
+	spare_ = threads_;
+	steals_ = 0;
+	// 시작 node 를 thread 들에 나눠 넣음
+	int next = 0;
+	for (int i = 0; i < n; i++) {
+		if (dag.nb_predecessors[i] == 0) push(next++ % threads_, i);
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		generation_++;
+		active_ = threads_ - 1;
+	}
+	start_cv_.notify_all();
+	work(0);
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		done_cv_.wait(lock, [&] { return active_ == 0; });
+	}
+	setThreads(omp_threads);
+}
+
+void WorkStealingPool::workerLoop(int self)
+{
+	int seen = 0;
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			start_cv_.wait(lock, [&] { return stop_ || generation_ != seen; });
+			if (stop_) return;
+			seen = generation_;
+		}
+		work(self);
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			active_--;
+		}
+		done_cv_.notify_one();
+	}
+}
+
+void WorkStealingPool::work(int self)
+{
+	for (;;) {
+		int node;
+		if (!pop(self, node) && !steal(self, node)) {
+			std::unique_lock<std::mutex> lock(mutex_);
+			if (remaining_ == 0) return;
+			idle_cv_.wait(lock, [&] { return queued_ > 0 || remaining_ == 0; });
+			continue;
+		}
+		// 자기 core 1 개 + 남는 core 를 width 까지 (다른 node 가 core 를 모두 빌렸으면 잠시 초과 사용)
+		int cores = 1;
+		spare_--;
+		for (int s = spare_; cores < dag_->width[node] && s > 0; s = spare_) {
+			if (spare_.compare_exchange_weak(s, s - 1)) cores++;
+		}
+		setThreads(cores);
+		(*task_)(node, cores);
+		spare_ += cores;
+		for (int s : dag_->successors[node]) {
+			if (--pending_[s] == 0) push(self, s);
+		}
+		if (--remaining_ == 0) {
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+			}
+			idle_cv_.notify_all();
+		}
+	}
+}
+
+void WorkStealingPool::push(int self, int node)
+{
+	{
+		std::lock_guard<std::mutex> lock(queues_[self]->mutex);
+		queues_[self]->nodes.push_back(node);
+	}
+	queued_++;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+	}
+	idle_cv_.notify_one();
+}
+
+bool WorkStealingPool::pop(int self, int& node)
+{
+	std::lock_guard<std::mutex> lock(queues_[self]->mutex);
+	if (queues_[self]->nodes.empty()) return false;
+	node = queues_[self]->nodes.back();
+	queues_[self]->nodes.pop_back();
+	queued_--;
+	return true;
+}
+
+bool WorkStealingPool::steal(int self, int& node)
+{
+	for (int k = 1; k < threads_; k++) {
+		Queue& victim = *queues_[(self + k) % threads_];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (victim.nodes.empty()) continue;
+		node = victim.nodes.front();
+		victim.nodes.pop_front();
+		queued_--;
+		steals_++;
+		return true;
+	}
+	return false;
+}
+
+/* ------ scheduler ------ */
+
+DagScheduler::DagScheduler(const Network& network, int maxBatchSize, int threads, const CostModel& model)
+	: dag_(buildLayerDag(network, maxBatchSize, threads > 0 ? threads : maxThreads(), model)),
+	pool_(threads > 0 ? threads : maxThreads()), stats_{}
+{
+}
+
+void DagScheduler::run(CpuInterpreter& interpreter, int batchSize)
+{
+	if (interpreter.memoryPlanned()) {
+		// arena 배치는 레이어 순서의 수명 기준이므로 동시에 실행하면 텐서가 겹침
+		std::cerr << "[WARNING] memory planned interpreter runs sequentially" << std::endl;
+		interpreter.run(batchSize);
+		return;
+	}
+	const int n = (int)dag_.nb_predecessors.size();
+	std::vector<double> start(n, 0.0), end(n, 0.0);
+	std::vector<int> used(n, 1);
+	typedef std::chrono::high_resolution_clock Clock;
+	const Clock::time_point t0 = Clock::now();
+	interpreter.beginRun(batchSize);
+	pool_.run(dag_, [&](int node, int cores) {
+		start[node] = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+		interpreter.runLayer(node);
+		end[node] = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+		used[node] = cores;
+	});
+	interpreter.endRun();
+
+	stats_ = ScheduleStats{};
+	stats_.wall_ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+	stats_.steals = pool_.steals();
+	std::vector<double> duration(n);
+	std::vector<std::pair<double, int>> events;
+	for (int i = 0; i < n; i++) {
+		duration[i] = end[i] - start[i];
+		stats_.work_ms += duration[i] * used[i];
+		events.push_back({ start[i], 1 });
+		events.push_back({ end[i], -1 });
+	}
+	stats_.critical_ms = criticalPath(dag_, duration);
+	// 같은 시각이면 종료를 먼저
+	std::sort(events.begin(), events.end());
+	int running = 0;
+	for (const auto& e : events) {
+		running += e.second;
+		stats_.max_concurrency = std::max(stats_.max_concurrency, running);
+	}
+}
+
+double DagScheduler::estimatedWorkMs() const
+{
+	double total = 0.0;
+	for (double c : dag_.cost_us) total += c;
+	return total / 1e3;
+}
+
+double DagScheduler::estimatedCriticalMs() const
+{
+	std::vector<double> cost(dag_.cost_us.size());
+	for (size_t i = 0; i < cost.size(); i++) cost[i] = dag_.cost_us[i] / dag_.width[i];
+	return criticalPath(dag_, cost) / 1e3;
+}
+
+/* ------ pipeline ------ */
+
+std::vector<int> partitionLayers(const std::vector<double>& cost, int stages)
+{
+	const int n = (int)cost.size();
+	stages = std::max(1, std::min(stages, std::max(n, 1)));
+	std::vector<double> prefix(n + 1, 0.0);
+	for (int i = 0; i < n; i++) prefix[i + 1] = prefix[i] + cost[i];
+	// best[s][i] : 앞 i 개 레이어를 s 개 구간으로 나눌 때 구간 합 최대값의 최소, cut[s][i] : 마지막 구간 시작
+	std::vector<std::vector<double>> best(stages + 1, std::vector<double>(n + 1, 1e300));
+	std::vector<std::vector<int>> cut(stages + 1, std::vector<int>(n + 1, 0));
+	best[0][0] = 0.0;
+	for (int s = 1; s <= stages; s++) {
+		for (int i = s; i <= n; i++) {
+			for (int j = s - 1; j < i; j++) {
+				const double v = std::max(best[s - 1][j], prefix[i] - prefix[j]);
+				if (v < best[s][i]) {
+					best[s][i] = v;
+					cut[s][i] = j;
+				}
+			}
+		}
+	}
+	std::vector<int> bounds(stages + 1, n);
+	for (int s = stages, i = n; s > 0; s--) {
+		bounds[s] = i;
+		i = cut[s][i];
+	}
+	bounds[0] = 0;
+	return bounds;
+}
+
+SpscRing::SpscRing(int capacity)
+	: items_(capacity), head_(0), tail_(0)
+{
+}
+
+bool SpscRing::push(int value)
+{
+	const size_t tail = tail_.load(std::memory_order_relaxed);
+	if (tail - head_.load(std::memory_order_acquire) == items_.size()) return false;
+	items_[tail % items_.size()] = value;
+	tail_.store(tail + 1, std::memory_order_release);
+	return true;
+}
+
+bool SpscRing::pop(int& value)
+{
+	const size_t head = head_.load(std::memory_order_relaxed);
+	if (head == tail_.load(std::memory_order_acquire)) return false;
+	value = items_[head % items_.size()];
+	head_.store(head + 1, std::memory_order_release);
+	return true;
+}
+
+const std::vector<int>& allowedCores()
+{
+	// 처음 호출한 thread 의 affinity (고정하기 전에 부르므로 process 에서 물려받은 값)
+	static const std::vector<int> cores = []() {
+		std::vector<int> ids;
+#ifdef _WIN32
+		DWORD_PTR process = 0, system = 0;
+		if (GetProcessAffinityMask(GetCurrentProcess(), &process, &system)) {
+			for (int c = 0; c < (int)sizeof(DWORD_PTR) * 8; c++) {
+				if (process & ((DWORD_PTR)1 << c)) ids.push_back(c);
+			}
+		}
+#elif defined(__linux__)
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+			for (int c = 0; c < CPU_SETSIZE; c++) {
+				if (CPU_ISSET(c, &set)) ids.push_back(c);
+			}
+		}
+#endif
+		if (ids.empty()) {
+			for (int c = 0; c < (int)std::max(1u, std::thread::hardware_concurrency()); c++) ids.push_back(c);
+		}
+		return ids;
+	}();
+	return cores;
+}
+
+bool pinCurrentThread(int first, int count)
+{
+	const std::vector<int>& cores = allowedCores();
+	if (count <= 0 || first < 0 || first + count > (int)cores.size()) return false;
+#ifdef _WIN32
+	DWORD_PTR mask = 0;
+	for (int c = first; c < first + count; c++) mask |= (DWORD_PTR)1 << cores[c];
+	return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#elif defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (int c = first; c < first + count; c++) CPU_SET(cores[c], &set);
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+	return false;
+#endif
+}
+
+PipelineExecutor::PipelineExecutor(const Network& network, const PipelineConfig& config)
+	: network_(network), config_(config), stats_{}
+{
+	config_.stages = std::max(1, std::min(config_.stages, network.getNbLayers()));
+	config_.cores_per_stage = std::max(1, config_.cores_per_stage);
+	const int omp_threads = maxThreads();
+	for (int i = 0; i < config_.stages + 1; i++) {
+		slots_.emplace_back(new CpuInterpreter(network, 1, config_.cores_per_stage));
+		slots_.back()->evaluateConstants();
+	}
+	setThreads(omp_threads);
+	// 측정 전에는 cost model 예상 (상수 레이어는 실행하지 않으므로 0)
+	const LayerDag dag = buildLayerDag(network, 1, config_.cores_per_stage);
+	layer_ms_.assign(network.getNbLayers(), 0.0);
+	for (int i = 0; i < network.getNbLayers(); i++) {
+		if (network.getLayer(i)->getOutput(0)->isBatched()) layer_ms_[i] = dag.cost_us[i] / dag.width[i] / 1e3;
+	}
+	bounds_ = partitionLayers(layer_ms_, config_.stages);
+	const int cores = (int)allowedCores().size();
+	if (config_.pin && config_.stages * config_.cores_per_stage > cores) {
+		std::cerr << "[WARNING] " << config_.stages << " x " << config_.cores_per_stage << " cores exceed " << cores << " available cores, some stages are not pinned" << std::endl;
+	}
+}
+
+void PipelineExecutor::balance(const FeedFn& feed, int iterations)
+{
+	CpuInterpreter& interpreter = *slots_[0];
+	const int n = network_.getNbLayers();
+	std::vector<double> total(n, 0.0);
+	const int omp_threads = maxThreads();
+	setThreads(config_.cores_per_stage);
+	feed(0, interpreter);
+	for (int it = 0; it <= iterations; it++) {	// 처음 한번은 warm up
+		interpreter.beginRun(1);
+		for (int i = 0; i < n; i++) {
+			const Clock::time_point t0 = Clock::now();
+			interpreter.runLayer(i);
+			if (it > 0) total[i] += std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+		}
+		interpreter.endRun();
+	}
+	setThreads(omp_threads);
+	for (int i = 0; i < n; i++) layer_ms_[i] = total[i] / std::max(iterations, 1);
+	bounds_ = partitionLayers(layer_ms_, config_.stages);
+}
+
+double PipelineExecutor::stageCostMs(int s) const
+{
+	double ms = 0.0;
+	for (int i = bounds_[s]; i < bounds_[s + 1]; i++) ms += layer_ms_[i];
+	return ms;
+}
+
+void PipelineExecutor::run(int frames, const FeedFn& feed, const CollectFn& collect)
+{
+	const int stages = config_.stages;
+	rings_.clear();
+	for (int s = 0; s < stages; s++) rings_.emplace_back(new SpscRing(slots()));
+	for (int k = 0; k < slots(); k++) rings_[0]->push(k);
+	stats_ = PipelineStats{};
+	stats_.stage_ms.assign(stages, 0.0);
+	std::vector<double> start(frames, 0.0), end(frames, 0.0);
+
+	epoch_ = Clock::now();
+	std::vector<std::thread> threads;
+	for (int s = 0; s < stages; s++) {
+		threads.emplace_back(&PipelineExecutor::stageLoop, this, s, frames, std::cref(feed), std::cref(collect), std::ref(start), std::ref(end));
+	}
+	for (auto& t : threads) t.join();
+
+	stats_.wall_ms = std::chrono::duration<double, std::milli>(Clock::now() - epoch_).count();
+	stats_.fps = frames * 1e3 / stats_.wall_ms;
+	for (int k = 0; k < frames; k++) {
+		stats_.mean_latency_ms += (end[k] - start[k]) / frames;
+		stats_.max_latency_ms = std::max(stats_.max_latency_ms, end[k] - start[k]);
+	}
+	for (double& ms : stats_.stage_ms) ms /= std::max(frames, 1);
+}
+
+// 단계 s thread : 입력 ring 에서 slot 을 받아 구간 레이어 실행 후 다음 ring 으로 (마지막 단계는 빈 slot ring 으로)
+// 단계마다 frame 을 받은 순서대로 처리하므로 k 번째로 받은 slot 이 frame k
+void PipelineExecutor::stageLoop(int s, int frames, const FeedFn& feed, const CollectFn& collect, std::vector<double>& start, std::vector<double>& end)
+{
+	const int stages = config_.stages, cores = config_.cores_per_stage;
+	if (config_.pin) pinCurrentThread(s * cores, cores);
+	setThreads(cores);
+	SpscRing& in = *rings_[s];
+	SpscRing& out = *rings_[(s + 1) % stages];
+	for (int k = 0; k < frames; k++) {
+		int slot;
+		while (!in.pop(slot)) std::this_thread::yield();
+		CpuInterpreter& interpreter = *slots_[slot];
+		const Clock::time_point t0 = Clock::now();
+		if (s == 0) {
+			start[k] = std::chrono::duration<double, std::milli>(t0 - epoch_).count();
+			feed(k, interpreter);
+			interpreter.beginRun(1);
+		}
+		for (int i = bounds_[s]; i < bounds_[s + 1]; i++) interpreter.runLayer(i);
+		if (s == stages - 1) {
+			interpreter.endRun();
+			collect(k, interpreter);
+		}
+		const Clock::time_point t1 = Clock::now();
+		stats_.stage_ms[s] += std::chrono::duration<double, std::milli>(t1 - t0).count();
+		if (s == stages - 1) end[k] = std::chrono::duration<double, std::milli>(t1 - epoch_).count();
+		while (!out.push(slot)) std::this_thread::yield();
+	}
+}
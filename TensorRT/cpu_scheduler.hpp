@@ -0,0 +1,205 @@
+﻿#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "cpu_interpreter.hpp"
+
+// 레이어 실행 시간 예측 (thread 하나 기준)
+struct CostModel {
+	double gflops;			// thread 당 연산 속도 (GFLOP/s)
+	double gbytes;			// thread 당 memory 대역폭 (GB/s)
+	double overhead_us;		// 레이어 실행 고정 비용
+	double grain_us;		// intra-op thread 하나가 맡을 최소 작업 (OpenMP fork/join 비용 대비)
+};
+CostModel defaultCostModel();
+
+// network 의 레이어 의존 그래프 (node = 레이어 index)
+struct LayerDag {
+	std::vector<std::vector<int>> successors;
+	std::vector<int> nb_predecessors;
+	std::vector<double> cost_us;	// thread 하나로 실행할 때 예상 시간 (max(연산, memory) + 고정 비용)
+	std::vector<int> width;			// cost model 이 정한 intra-op thread 수 (cost_us / grain_us, 1 ~ threads)
+};
+
+// 텐서 생성 / 사용 관계로 DAG 구성, 비용은 batchSize 기준
+LayerDag buildLayerDag(const ir::Network& network, int batchSize, int threads, const CostModel& model = defaultCostModel());
+// cost 합이 가장 큰 경로의 길이 (path 가 있으면 경로의 레이어 index)
+double criticalPath(const LayerDag& dag, const std::vector<double>& cost, std::vector<int>* path = nullptr);
+
+//! \class WorkStealingPool
+//!
+//! \brief thread 별 deque 를 가진 DAG 실행 pool. 준비된 node 는 실행한 thread 의 deque 뒤에 넣고
+//!  각 thread 는 자기 deque 뒤에서 꺼냄 (방금 만든 텐서를 바로 사용), 비면 다른 thread deque 앞에서 훔침
+//!  node 마다 width 만큼 core 를 요청, 남는 core 가 있을 때만 더 받아서 그 수로 OpenMP thread 를 설정
+//!  호출한 thread 도 worker 0 으로 참여
+//!
+class WorkStealingPool
+{
+public:
+	explicit WorkStealingPool(int threads);
+	~WorkStealingPool();
+
+	// dag 의 모든 node 를 의존성 순서로 실행하고 반환. task(node, cores)
+	void run(const LayerDag& dag, const std::function<void(int, int)>& task);
+
+	int threads() const { return threads_; }
+	int steals() const { return steals_; }	// 마지막 run 에서 훔친 node 수
+
+private:
+	struct Queue {
+		std::mutex mutex;
+		std::deque<int> nodes;
+	};
+
+	void workerLoop(int self);
+	void work(int self);
+	void push(int self, int node);
+	bool pop(int self, int& node);
+	bool steal(int self, int& node);
+
+	int threads_;
+	std::vector<std::thread> workers_;
+	std::vector<std::unique_ptr<Queue>> queues_;
+	std::mutex mutex_;
+	std::condition_variable start_cv_;		// 새 run (generation_)
+	std::condition_variable idle_cv_;		// deque 에 node 추가, run 종료
+	std::condition_variable done_cv_;		// worker 가 run 을 마침
+	int generation_;
+	int active_;							// 이번 run 을 아직 마치지 않은 worker 수 (호출 thread 제외)
+	bool stop_;
+
+	const LayerDag* dag_;
+	const std::function<void(int, int)>* task_;
+	std::unique_ptr<std::atomic<int>[]> pending_;	// node 별 남은 선행 node 수
+	std::atomic<int> remaining_;
+	std::atomic<int> queued_;
+	std::atomic<int> spare_;				// 어느 node 도 사용하지 않는 core 수
+	std::atomic<int> steals_;
+};
+
+// 마지막 run 의 측정 결과
+struct ScheduleStats {
+	double wall_ms;
+	double work_ms;			// 레이어 시간 x 사용 core 합 (core-ms)
+	double critical_ms;		// 측정된 레이어 시간 기준 critical path
+	int max_concurrency;	// 동시에 실행된 레이어 수의 최대
+	int steals;
+};
+
+//! \class DagScheduler
+//!
+//! \brief 서로 의존하지 않는 레이어 (yolov5s C3 의 cv1 / cv2, detect head 3 개 등) 를 동시에 실행
+//!  작은 레이어는 1 core task 로 여러 개를 병렬 (inter-op), 큰 레이어는 남는 core 를 받아 OpenMP 로 병렬 (intra-op)
+//!  결과는 CpuInterpreter::run 과 같음 (레이어 내부 계산 순서는 core 수와 무관)
+//!
+class DagScheduler
+{
+public:
+	DagScheduler(const ir::Network& network, int maxBatchSize, int threads = 0, const CostModel& model = defaultCostModel());
+
+	void run(CpuInterpreter& interpreter, int batchSize = 1);
+
+	const LayerDag& dag() const { return dag_; }
+	int threads() const { return pool_.threads(); }
+	// cost model 예상 : 전체 작업 (1 thread), intra-op width 반영한 critical path
+	double estimatedWorkMs() const;
+	double estimatedCriticalMs() const;
+	const ScheduleStats& stats() const { return stats_; }
+
+private:
+	LayerDag dag_;
+	WorkStealingPool pool_;
+	ScheduleStats stats_;
+};
+
+// network 순서의 연속 구간 stages 개로 나눠서 구간 cost 합의 최대값이 최소가 되는 경계
+// 반환 [stages + 1] : 구간 s = 레이어 [bounds[s], bounds[s + 1])
+std::vector<int> partitionLayers(const std::vector<double>& cost, int stages);
+
+//! \class SpscRing
+//!
+//! \brief 한 thread 가 넣고 한 thread 가 꺼내는 고정 크기 lock-free ring (pipeline 단계 사이 frame slot 전달)
+//!
+class SpscRing
+{
+public:
+	explicit SpscRing(int capacity);
+
+	bool push(int value);	// 가득 차면 false
+	bool pop(int& value);	// 비어 있으면 false
+
+private:
+	std::vector<int> items_;
+	std::atomic<size_t> head_;	// 꺼낼 위치 (소비 thread 만 갱신)
+	char pad_[64];				// head_, tail_ 을 다른 cache line 에
+	std::atomic<size_t> tail_;	// 넣을 위치 (생산 thread 만 갱신)
+};
+
+struct PipelineConfig {
+	int stages;				// 단계 수
+	int cores_per_stage;	// 단계별 OpenMP thread 수
+	bool pin;				// 단계 s 의 thread 를 allowedCores() [s * cores_per_stage, (s + 1) * cores_per_stage) 에 고정
+};
+
+// 마지막 run 의 측정 결과
+struct PipelineStats {
+	double wall_ms;
+	double fps;
+	double mean_latency_ms;		// frame 입력 설정 ~ 마지막 단계 종료
+	double max_latency_ms;
+	std::vector<double> stage_ms;	// 단계별 frame 당 평균 실행 시간
+};
+
+//! \class PipelineExecutor
+//!
+//! \brief 연속된 frame (video stream, batch 1) 을 레이어 구간 단계로 나눠 흘려보내는 pipeline 병렬 실행
+//!  단계마다 thread 하나 (core 묶음에 고정, 내부는 cores_per_stage thread OpenMP), 단계 사이는 SpscRing 으로 slot 전달
+//!  in-flight frame 마다 텐서가 따로 필요해서 slot (단계 수 + 1) 마다 CpuInterpreter 를 생성 (상수 부분 그래프는 생성시 계산)
+//!  단계 경계는 cost model 예상으로 시작, balance 가 측정한 레이어 시간으로 다시 결정
+//!  처리량은 가장 느린 단계가, 지연 시간은 단계 합 + 대기 시간이 결정
+//!  Linux 는 단계 thread 가 만든 OpenMP thread 도 같은 core 묶음 (affinity 상속), Windows 는 단계 thread 만 고정
+//!
+class PipelineExecutor
+{
+public:
+	typedef std::function<void(int, CpuInterpreter&)> FeedFn;				// (frame, interpreter) : 입력 설정
+	typedef std::function<void(int, const CpuInterpreter&)> CollectFn;		// (frame, interpreter) : 출력 사용 (다음 frame 이 slot 을 쓰기 전)
+
+	PipelineExecutor(const ir::Network& network, const PipelineConfig& config);
+
+	// feed(0, ...) 입력으로 레이어별 시간을 iterations 번 측정 (cores_per_stage thread) 해서 경계 결정
+	void balance(const FeedFn& feed, int iterations = 3);
+	// frames 개를 순서대로 흘려보냄 (collect 도 frame 순서)
+	void run(int frames, const FeedFn& feed, const CollectFn& collect);
+
+	const std::vector<int>& bounds() const { return bounds_; }
+	const std::vector<double>& layerMs() const { return layer_ms_; }	// balance 측정값 (없으면 cost model 예상)
+	double stageCostMs(int s) const;
+	int slots() const { return (int)slots_.size(); }
+	const PipelineStats& stats() const { return stats_; }
+
+private:
+	void stageLoop(int s, int frames, const FeedFn& feed, const CollectFn& collect, std::vector<double>& start, std::vector<double>& end);
+
+	typedef std::chrono::high_resolution_clock Clock;
+
+	const ir::Network& network_;
+	PipelineConfig config_;
+	std::vector<std::unique_ptr<CpuInterpreter>> slots_;
+	std::vector<int> bounds_;
+	std::vector<double> layer_ms_;
+	std::vector<std::unique_ptr<SpscRing>> rings_;	// [stages] : rings_[s] 는 단계 s 의 입력 (rings_[0] 은 빈 slot)
+	Clock::time_point epoch_;
+	PipelineStats stats_;
+};
+
+// process 가 쓸 수 있는 CPU id (affinity mask, cgroup/taskset 제한 반영), 처음 호출할 때 한번 조회
+const std::vector<int>& allowedCores();
+// 현재 thread 를 allowedCores() [first, first + count) 에 고정 (실패하면 false)
+bool pinCurrentThread(int first, int count);
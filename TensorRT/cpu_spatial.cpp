@@ -0,0 +1,265 @@
+﻿#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "cpu_spatial.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/* ------ stride 1 max pooling ------ */
+
+// van Herk / Gil-Werman : padding 포함 위치 t 를 k 개씩 block 으로 나누고
+// g[t] = block 시작 ~ t 의 max, h[t] = t ~ block 끝의 max 이면 window [j, j + k) 의 max = max(h[j], g[j + k - 1])
+// x[0, n) 앞에 pad 개, 뒤에 나머지를 -inf 로 채운 열 -> out[0, on)
+static void runningMax(const float* x, int n, int pad, int k, int on, float* out, float* g, float* h)
+{
+	const int L = on + k - 1;
+	for (int t = 0; t < L; t++) {
+		const int i = t - pad;
+		const float v = i >= 0 && i < n ? x[i] : -INFINITY;
+		g[t] = t % k == 0 ? v : std::max(g[t - 1], v);
+	}
+	for (int t = L - 1; t >= 0; t--) {
+		const int i = t - pad;
+		const float v = i >= 0 && i < n ? x[i] : -INFINITY;
+		h[t] = t % k == k - 1 || t == L - 1 ? v : std::max(h[t + 1], v);
+	}
+	for (int j = 0; j < on; j++) out[j] = std::max(h[j], g[j + k - 1]);
+}
+
+// 같은 계산을 행 단위로 (원소 = 길이 w 의 행, 행 안의 loop 는 연속 메모리)
+static void runningMaxRows(const float* x, int n, int pad, int k, int on, int w, float* out, float* g, float* h)
+{
+	const int L = on + k - 1;
+	auto row = [&](int t) { const int i = t - pad; return i >= 0 && i < n ? x + (int64_t)i * w : nullptr; };
+	for (int t = 0; t < L; t++) {
+		const float* v = row(t);
+		float* gt = g + (int64_t)t * w;
+		if (t % k == 0) {
+			if (v) memcpy(gt, v, w * sizeof(float));
+			else std::fill(gt, gt + w, -INFINITY);
+		}
+		else {
+			const float* prev = gt - w;
+			if (v) for (int c = 0; c < w; c++) gt[c] = std::max(prev[c], v[c]);
+			else memcpy(gt, prev, w * sizeof(float));
+		}
+	}
+	for (int t = L - 1; t >= 0; t--) {
+		const float* v = row(t);
+		float* ht = h + (int64_t)t * w;
+		if (t % k == k - 1 || t == L - 1) {
+			if (v) memcpy(ht, v, w * sizeof(float));
+			else std::fill(ht, ht + w, -INFINITY);
+		}
+		else {
+			const float* next = ht + w;
+			if (v) for (int c = 0; c < w; c++) ht[c] = std::max(next[c], v[c]);
+			else memcpy(ht, next, w * sizeof(float));
+		}
+	}
+	for (int j = 0; j < on; j++) {
+		const float* hj = h + (int64_t)j * w;
+		const float* gj = g + (int64_t)(j + k - 1) * w;
+		float* o = out + (int64_t)j * w;
+		for (int c = 0; c < w; c++) o[c] = std::max(hj[c], gj[c]);
+	}
+}
+
+void maxPoolCascade(const float* in, int planes, int H, int W, const MaxPoolStage* stages, int nbStages)
+{
+	// thread 별 작업 공간 크기 (단계 중 최대)
+	size_t rows = 0, line = 0;
+	int h = H;
+	for (int s = 0; s < nbStages; s++) {
+		const MaxPoolStage& st = stages[s];
+		rows = std::max(rows, (size_t)h * st.OW);									// 열 방향 결과
+		rows = std::max(rows, (size_t)(st.OH + st.KH - 1) * st.OW);					// 행 방향 g, h
+		line = std::max(line, (size_t)(st.OW + st.KW - 1));
+		h = st.OH;
+	}
+
+#pragma omp parallel
+	{
+		std::vector<float> cols(rows), g(rows), hbuf(rows), g1(line), h1(line);
+#pragma omp for schedule(static)
+		for (int p = 0; p < planes; p++) {
+			const float* src = in + (int64_t)p * H * W;
+			int sh = H, sw = W;
+			for (int s = 0; s < nbStages; s++) {
+				const MaxPoolStage& st = stages[s];
+				for (int r = 0; r < sh; r++) {
+					runningMax(src + (int64_t)r * sw, sw, st.PW, st.KW, st.OW, cols.data() + (int64_t)r * st.OW, g1.data(), h1.data());
+				}
+				float* dst = st.out + (int64_t)p * st.OH * st.OW;
+				runningMaxRows(cols.data(), sh, st.PH, st.KH, st.OH, st.OW, dst, g.data(), hbuf.data());
+				src = dst;
+				sh = st.OH;
+				sw = st.OW;
+			}
+		}
+	}
+}
+
+void maxPoolCascade(const uint16_t* in, int planes, int H, int W, const MaxPoolStage* stages, uint16_t* const* outs, int nbStages, HalfFormat format)
+{
+	size_t rows = 0, line = 0, plane = (size_t)H * W;
+	int h = H;
+	for (int s = 0; s < nbStages; s++) {
+		const MaxPoolStage& st = stages[s];
+		rows = std::max(rows, (size_t)h * st.OW);
+		rows = std::max(rows, (size_t)(st.OH + st.KH - 1) * st.OW);
+		line = std::max(line, (size_t)(st.OW + st.KW - 1));
+		plane = std::max(plane, (size_t)st.OH * st.OW);
+		h = st.OH;
+	}
+
+#pragma omp parallel
+	{
+		// 단계 입력을 열 방향 결과 (cols) 로 읽은 뒤 같은 버퍼에 단계 출력을 씀
+		std::vector<float> buf(plane), cols(rows), g(rows), hbuf(rows), g1(line), h1(line);
+#pragma omp for schedule(static)
+		for (int p = 0; p < planes; p++) {
+			halfToFloat(in + (int64_t)p * H * W, buf.data(), (int64_t)H * W, format);
+			int sh = H, sw = W;
+			for (int s = 0; s < nbStages; s++) {
+				const MaxPoolStage& st = stages[s];
+				for (int r = 0; r < sh; r++) {
+					runningMax(buf.data() + (int64_t)r * sw, sw, st.PW, st.KW, st.OW, cols.data() + (int64_t)r * st.OW, g1.data(), h1.data());
+				}
+				runningMaxRows(cols.data(), sh, st.PH, st.KH, st.OH, st.OW, buf.data(), g.data(), hbuf.data());
+				floatToHalf(buf.data(), outs[s] + (int64_t)p * st.OH * st.OW, (int64_t)st.OH * st.OW, format);
+				sh = st.OH;
+				sw = st.OW;
+			}
+		}
+	}
+}
+
+/* ------ resize ------ */
+
+// E : 입출력 원소 형식 (nearest 는 원소를 그대로 복사, bilinear 는 float 로 읽어서 보간)
+template <class E>
+static void resize(const ResizeShape& s, const typename E::type* in, typename E::type* out)
+{
+	typedef typename E::type T;
+	const T zero = E::store(0.f);
+	const int H = s.H, W = s.W, OH = s.OH, OW = s.OW;
+	const int FH = s.PT + OH + s.PB, FW = s.PL + OW + s.PR;
+	const bool align = s.align_corners;
+	const float sy = align ? (OH > 1 ? (float)(H - 1) / (OH - 1) : 0.f) : (float)H / OH;
+	const float sx = align ? (OW > 1 ? (float)(W - 1) / (OW - 1) : 0.f) : (float)W / OW;
+
+	// 열 좌표는 모든 행에서 같으므로 미리 계산 (interpreter 의 기존 resize 와 같은 식)
+	std::vector<int> x0(OW), x1(OW);
+	std::vector<float> fx(OW);
+	for (int ow = 0; ow < OW; ow++) {
+		const float x = ow * sx;
+		if (s.nearest) {
+			x0[ow] = std::min(align ? (int)std::lround(x) : (int)std::floor(x), W - 1);
+		}
+		else {
+			x0[ow] = std::min((int)x, W - 1);
+			x1[ow] = std::min(x0[ow] + 1, W - 1);
+			fx[ow] = x - x0[ow];
+		}
+	}
+	auto nearestRow = [&](int oh) {
+		const float y = oh * sy;
+		return std::min(align ? (int)std::lround(y) : (int)std::floor(y), H - 1);
+	};
+	// 정수배 nearest : 좌표가 ow / fx, oh / fy 와 같으면 열 복제 + 행 복사
+	int fy_int = 0, fx_int = 0;
+	if (s.nearest && OH % H == 0 && OW % W == 0) {
+		fy_int = OH / H;
+		fx_int = OW / W;
+		for (int ow = 0; ow < OW && fx_int; ow++) {
+			if (x0[ow] != ow / fx_int) fx_int = 0;
+		}
+		for (int oh = 0; oh < OH && fy_int; oh++) {
+			if (nearestRow(oh) != oh / fy_int) fy_int = 0;
+		}
+	}
+
+#pragma omp parallel
+	{
+		std::vector<float> rows(s.nearest ? 0 : (size_t)2 * OW);
+#pragma omp for schedule(static)
+		for (int p = 0; p < s.planes; p++) {
+			const T* src = in + (int64_t)p * H * W;
+			T* dst = out + (int64_t)p * FH * FW;
+			// 0 padding (위, 아래 행, 좌우 열)
+			std::fill(dst, dst + (int64_t)s.PT * FW, zero);
+			std::fill(dst + (int64_t)(s.PT + OH) * FW, dst + (int64_t)FH * FW, zero);
+			for (int oh = 0; oh < OH; oh++) {
+				T* orow = dst + (int64_t)(s.PT + oh) * FW;
+				std::fill(orow, orow + s.PL, zero);
+				std::fill(orow + s.PL + OW, orow + FW, zero);
+			}
+
+			if (fy_int && fx_int) {
+				for (int iy = 0; iy < H; iy++) {
+					const T* row = src + (int64_t)iy * W;
+					T* orow = dst + (int64_t)(s.PT + iy * fy_int) * FW + s.PL;
+					if (fx_int == 2) {
+						for (int ix = 0; ix < W; ix++) orow[2 * ix] = orow[2 * ix + 1] = row[ix];
+					}
+					else {
+						for (int ix = 0; ix < W; ix++) {
+							for (int k = 0; k < fx_int; k++) orow[ix * fx_int + k] = row[ix];
+						}
+					}
+					for (int k = 1; k < fy_int; k++) memcpy(orow + (int64_t)k * FW, orow, OW * sizeof(T));
+				}
+			}
+			else if (s.nearest) {
+				for (int oh = 0; oh < OH; oh++) {
+					const T* row = src + (int64_t)nearestRow(oh) * W;
+					T* orow = dst + (int64_t)(s.PT + oh) * FW + s.PL;
+					for (int ow = 0; ow < OW; ow++) orow[ow] = row[x0[ow]];
+				}
+			}
+			else {
+				// 입력 행의 열 방향 보간 결과 2 개를 보관 (연속된 출력 행은 같은 입력 행을 다시 사용)
+				float* slot[2] = { rows.data(), rows.data() + OW };
+				int slot_row[2] = { -1, -1 };
+				auto interpolated = [&](int iy, int keep) -> const float* {
+					for (int k = 0; k < 2; k++) {
+						if (slot_row[k] == iy) return slot[k];
+					}
+					const int k = slot_row[0] == keep ? 1 : 0;
+					const T* r = src + (int64_t)iy * W;
+					float* d = slot[k];
+					for (int ow = 0; ow < OW; ow++) {
+						const float a = E::load(r[x0[ow]]);
+						d[ow] = a + (E::load(r[x1[ow]]) - a) * fx[ow];
+					}
+					slot_row[k] = iy;
+					return d;
+				};
+				for (int oh = 0; oh < OH; oh++) {
+					const float y = oh * sy;
+					const int y0 = std::min((int)y, H - 1), y1 = std::min(y0 + 1, H - 1);
+					const float fy = y - y0;
+					const float* top = interpolated(y0, y1);
+					const float* bottom = interpolated(y1, y0);
+					T* orow = dst + (int64_t)(s.PT + oh) * FW + s.PL;
+					for (int ow = 0; ow < OW; ow++) orow[ow] = E::store(top[ow] + (bottom[ow] - top[ow]) * fy);
+				}
+			}
+		}
+	}
+}
+
+void resizePadded(const ResizeShape& s, const float* in, float* out)
+{
+	resize<FloatElement>(s, in, out);
+}
+
+void resizePadded(const ResizeShape& s, const uint16_t* in, uint16_t* out, HalfFormat format)
+{
+	if (format == HalfFormat::kFP16) resize<Fp16Element>(s, in, out);
+	else resize<Bf16Element>(s, in, out);
+}
@@ -0,0 +1,35 @@
+﻿#pragma once
+#include <cstdint>
+#include "cpu_half.hpp"
+
+// stride 1 max pooling 한 단계 (출력 plane 크기 OH x OW, 범위 밖 입력은 -inf)
+struct MaxPoolStage {
+	int KH, KW;
+	int PH, PW;		// 앞쪽 padding
+	int OH, OW;
+	float* out;		// [planes, OH, OW]
+};
+
+// stride 1 max pooling 을 단계 순서대로 적용 (단계 s 의 입력은 단계 s - 1 의 출력, 첫 단계는 in [planes, H, W])
+// 행, 열 방향으로 나눈 van Herk / Gil-Werman running max : window 크기와 무관하게 출력 하나에 비교 약 6 번
+// plane 단위로 모든 단계를 계산해서 앞 단계 출력을 cache 에 있을 때 바로 사용 (SPPF 의 pool1 -> pool2 -> pool3)
+void maxPoolCascade(const float* in, int planes, int H, int W, const MaxPoolStage* stages, int nbStages);
+// 16 bit 입출력 (stages 의 out 대신 outs[s]), plane 을 float 로 변환해서 모든 단계를 계산하고 단계 출력마다 변환
+void maxPoolCascade(const uint16_t* in, int planes, int H, int W, const MaxPoolStage* stages, uint16_t* const* outs, int nbStages, HalfFormat format);
+
+// 마지막 2 차원 resize 후 0 padding (graph pass 가 resize 다음 padding 을 합친 경우, padding 이 없으면 모두 0)
+struct ResizeShape {
+	int planes;
+	int H, W;		// 입력
+	int OH, OW;		// resize 결과 (padding 제외)
+	bool nearest;	// false 면 bilinear
+	bool align_corners;
+	int PT, PL, PB, PR;
+};
+
+// 출력 [planes, PT + OH + PB, PL + OW + PR], 계산식은 interpreter 의 기존 resize 와 같음
+// 정수배 nearest (align corners 아님) : 행을 열 방향으로 복제한 뒤 나머지 행은 memcpy
+// bilinear : 입력 행마다 열 방향 보간을 한번만 계산해 두고 출력 행은 두 보간 행의 연속 메모리 blend (vectorize)
+void resizePadded(const ResizeShape& shape, const float* in, float* out);
+// 16 bit 입출력 : nearest 는 변환 없이 복사, bilinear 는 보간 행을 float 로 계산
+void resizePadded(const ResizeShape& shape, const uint16_t* in, uint16_t* out, HalfFormat format);
@@ -0,0 +1,77 @@
+﻿#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <utility>
+#include "detection_eval.hpp"
+
+bool readFile(const std::string& path, void* dst, size_t bytes)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file.is_open()) {
+		std::cerr << "[ERROR] file open error : " << path << std::endl;
+		return false;
+	}
+	file.read((char*)dst, bytes);
+	if ((size_t)file.gcount() != bytes) {
+		std::cerr << "[ERROR] file size mismatch : " << path << " (" << file.gcount() << " / " << bytes << " bytes)" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+float iou(const float a[4], const float b[4])
+{
+	const float l = std::max(a[0] - a[2] / 2.f, b[0] - b[2] / 2.f), r = std::min(a[0] + a[2] / 2.f, b[0] + b[2] / 2.f);
+	const float t = std::max(a[1] - a[3] / 2.f, b[1] - b[3] / 2.f), btm = std::min(a[1] + a[3] / 2.f, b[1] + b[3] / 2.f);
+	if (t > btm || l > r) return 0.f;
+	const float inter = (r - l) * (btm - t);
+	return inter / (a[2] * a[3] + b[2] * b[3] - inter);
+}
+
+double meanAveragePrecision(const std::vector<std::vector<Detection>>& truth, const std::vector<std::vector<Detection>>& pred)
+{
+	std::map<int, int> truth_count;
+	for (const auto& image : truth)
+		for (const Detection& d : image) truth_count[d.class_id]++;
+	if (truth_count.empty()) return -1.0;
+
+	double sum = 0.0;
+	for (const auto& cls : truth_count) {
+		// (conf, image, detection)
+		std::vector<std::pair<float, std::pair<int, int>>> ranked;
+		for (int i = 0; i < (int)pred.size(); i++)
+			for (int j = 0; j < (int)pred[i].size(); j++)
+				if (pred[i][j].class_id == cls.first) ranked.push_back({ pred[i][j].conf, { i, j } });
+		std::stable_sort(ranked.begin(), ranked.end(), [](const std::pair<float, std::pair<int, int>>& a, const std::pair<float, std::pair<int, int>>& b) { return a.first > b.first; });
+
+		std::vector<std::vector<bool>> used(truth.size());
+		for (size_t i = 0; i < truth.size(); i++) used[i].assign(truth[i].size(), false);
+		std::vector<double> precision, recall;
+		int tp = 0;
+		for (size_t r = 0; r < ranked.size(); r++) {
+			const int image = ranked[r].second.first;
+			const Detection& p = pred[image][ranked[r].second.second];
+			int best = -1;
+			float best_iou = 0.5f;
+			for (int t = 0; t < (int)truth[image].size(); t++) {
+				const Detection& g = truth[image][t];
+				if (g.class_id != cls.first || used[image][t]) continue;
+				const float o = iou(p.bbox, g.bbox);
+				if (o >= best_iou) { best_iou = o; best = t; }
+			}
+			if (best >= 0) { used[image][best] = true; tp++; }
+			precision.push_back((double)tp / (r + 1));
+			recall.push_back((double)tp / cls.second);
+		}
+		// precision 을 뒤에서부터 최대값으로 바꾸고 recall 증가분 만큼 적분
+		double ap = 0.0, prev_recall = 0.0;
+		for (int i = (int)precision.size() - 2; i >= 0; i--) precision[i] = std::max(precision[i], precision[i + 1]);
+		for (size_t i = 0; i < precision.size(); i++) {
+			ap += (recall[i] - prev_recall) * precision[i];
+			prev_recall = recall[i];
+		}
+		sum += ap;
+	}
+	return sum / truth_count.size();
+}
@@ -0,0 +1,20 @@
+﻿#pragma once
+#include <string>
+#include <vector>
+
+// CPU 도구 (int8_eval, detr_exit, ir_run) 공용 : raw 입력 파일 읽기, 검출 결과 비교
+
+// path 의 앞 bytes byte 를 dst 에 읽음, 열기 실패나 크기 부족이면 에러 출력 후 false
+bool readFile(const std::string& path, void* dst, size_t bytes);
+
+struct Detection {
+	float bbox[4];	// center x, center y, w, h
+	float conf;
+	int class_id;
+};
+
+// center x, y, w, h 박스의 IoU
+float iou(const float a[4], const float b[4]);
+
+// truth (기준 검출) 기준 pred 의 class 별 AP@0.5 (all-point 보간) 평균, 정답이 없으면 -1
+double meanAveragePrecision(const std::vector<std::vector<Detection>>& truth, const std::vector<std::vector<Detection>>& pred);
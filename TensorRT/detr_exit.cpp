@@ -0,0 +1,207 @@
+﻿// DETR 중간 decoder 레이어 예측으로 early exit (cpu_early_exit.hpp)
+// usage : detr_exit [options]
+//   -e <layers>      head 를 붙일 중간 decoder 레이어 (쉼표 구분, 0 부터, 기본 0,1,2,3,4)
+//   -s <thresh>      검출 점수 기준 (기본 0.5)
+//   -m <margin>      confident 판정 : 점수가 기준 ± margin 안인 query 가 없으면 멈춤 (기본 0.2)
+//   -d <delta>       stable 판정 : 앞 exit 대비 점수 변화 한계 (기본 0.05, box 변화 한계는 0.02)
+//   -x <exit>        이 exit (단계 index) 전에는 멈추지 않음 (기본 0)
+//   -i <files>       uint8 HWC BGR raw 입력 파일 목록 (쉼표 구분, 없으면 난수 이미지)
+//   -k <count>       난수 이미지 수 (기본 8)
+//   -n <iterations>  이미지마다 속도 측정 반복 횟수 (기본 3)
+//   -t <threads>     OpenMP thread 수
+//   -r               .wts 에 없는 가중치를 난수로 생성 (가중치 파일 없이 실행)
+// exit 별 실행 레이어 수, 연산량, 전체 decoder 결과를 정답으로 한 mAP@0.5, 멈춘 이미지 수
+// early exit 평균 decoder 레이어 수, 줄어든 레이어 / 연산량, frame 당 지연 시간 (중간 head 없는 network 대비), mAP@0.5
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include "cpu_early_exit.hpp"
+#include "detection_eval.hpp"
+#include "detr_postprocess.hpp"
+#include "graph_passes.hpp"
+#include "ir_models.hpp"
+
+static const int NUM_DECODE_LAYERS = 6;
+
+static std::vector<int> parseList(const char* text)
+{
+	std::vector<int> values;
+	std::stringstream ss(text);
+	std::string item;
+	while (std::getline(ss, item, ',')) values.push_back(atoi(item.c_str()));
+	return values;
+}
+
+/* ------ 검출 (detection_eval.hpp 의 mAP 로 비교) ------ */
+
+// scores [Q, K], boxes [Q, 4] -> 점수가 기준보다 큰 query (DETR 은 NMS 없음)
+static std::vector<Detection> detections(const float* scores, const float* boxes, int num_queries, int num_class, float thresh)
+{
+	std::vector<Detection> result;
+	for (int q = 0; q < num_queries; q++) {
+		int label;
+		const float score = maxArgmax(scores + (size_t)q * num_class, num_class, label);
+		if (score <= thresh) continue;
+		const float* b = boxes + (size_t)q * 4;
+		result.push_back(Detection{ { b[0], b[1], b[2], b[3] }, score, label });
+	}
+	return result;
+}
+
+static void printMap(std::ostream& os, double map)
+{
+	if (map < 0.0) os << std::setw(10) << "n/a";
+	else os << std::setw(9) << map * 100.0 << "%";
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<int> exit_layers = { 0, 1, 2, 3, 4 };
+	std::vector<std::string> input_files;
+	DetrExitPolicy policy;
+	int images = 8, iterations = 3, threads = 0;
+	bool random_missing = false;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-e") && i + 1 < argc) exit_layers = parseList(argv[++i]);
+		else if (!strcmp(argv[i], "-s") && i + 1 < argc) policy.score_thresh = (float)atof(argv[++i]);
+		else if (!strcmp(argv[i], "-m") && i + 1 < argc) policy.margin = (float)atof(argv[++i]);
+		else if (!strcmp(argv[i], "-d") && i + 1 < argc) policy.score_delta = (float)atof(argv[++i]);
+		else if (!strcmp(argv[i], "-x") && i + 1 < argc) policy.min_exit = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-i") && i + 1 < argc) {
+			std::stringstream ss(argv[++i]);
+			std::string item;
+			while (std::getline(ss, item, ',')) input_files.push_back(item);
+		}
+		else if (!strcmp(argv[i], "-k") && i + 1 < argc) images = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-n") && i + 1 < argc) iterations = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-t") && i + 1 < argc) threads = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-r")) random_missing = true;
+	}
+
+	// 1. 중간 head 가 없는 network (기준), 있는 network 를 같은 가중치로 기록
+	const ir::ModelConfig* config = ir::findModel("detr");
+	ir::WeightMap weightMap;
+	std::ifstream wts(config->weight_file);
+	if (wts.good()) {
+		wts.close();
+		weightMap = ir::loadWeights(config->weight_file);
+	}
+	else if (!random_missing) {
+		std::cerr << "[ERROR] weight file not found : " << config->weight_file << " (use -r for random weights)" << std::endl;
+		return 1;
+	}
+	ir::WeightSource weights(weightMap, random_missing);
+	ir::Network full_network, exit_network;
+	ir::BuildOptions options;
+	options.detr_exit_layers = exit_layers;
+	if (!ir::buildModel(config->name, full_network, weights, 1)) return 1;
+	if (!ir::buildModel(config->name, exit_network, weights, 1, options)) return 1;
+	ir::optimizeNetwork(full_network, nullptr);
+	ir::optimizeNetwork(exit_network, nullptr);
+
+	// 단계 : 중간 exit (decoder 레이어 순서), 마지막은 최종 출력 (network 출력 순서 : scores, boxes, scores_<i>, boxes_<i>, ...)
+	std::vector<int> stage_layer;
+	std::vector<std::vector<const ir::Tensor*>> stages;
+	for (int i = 2; i + 1 < exit_network.getNbOutputs(); i += 2) {
+		const std::string name = exit_network.getOutput(i)->getName();
+		stage_layer.push_back(atoi(name.c_str() + name.rfind('_') + 1));
+		stages.push_back({ exit_network.getOutput(i), exit_network.getOutput(i + 1) });
+	}
+	stage_layer.push_back(NUM_DECODE_LAYERS - 1);
+	stages.push_back({ exit_network.getOutput(0), exit_network.getOutput(1) });
+	const int nb_stages = (int)stages.size();
+	const int num_queries = stages[0][0]->getDimensions().d[0];
+	const int num_class = stages[0][0]->getDimensions().d[1];
+
+	// 2. 입력
+	if (!input_files.empty()) images = (int)input_files.size();
+	const size_t input_size = (size_t)config->input_h * config->input_w * config->input_c;
+	std::vector<std::vector<uint8_t>> inputs(images, std::vector<uint8_t>(input_size));
+	std::mt19937 rng(0);
+	for (int i = 0; i < images; i++) {
+		if (!input_files.empty()) {
+			if (!readFile(input_files[i], inputs[i].data(), input_size)) return 1;
+		}
+		else {
+			for (auto& v : inputs[i]) v = (uint8_t)(rng() & 255);
+		}
+	}
+
+	// 3. 이미지마다 : 전체 실행 (기준 검출, 모든 exit 검출), early exit 실행, 속도
+	CpuInterpreter full(full_network, 1, threads), early(exit_network, 1, threads);
+	EarlyExitRunner runner(early, stages);
+	DetrExitCriterion criterion(policy, num_queries, num_class);
+	std::vector<std::vector<Detection>> truth(images), early_pred(images);
+	std::vector<std::vector<std::vector<Detection>>> stage_pred(nb_stages, std::vector<std::vector<Detection>>(images));
+	std::vector<int> exited(nb_stages, 0), reasons(3, 0);
+	double full_ms = 0.0, early_ms = 0.0, decoder_layers = 0.0, max_final_diff = 0.0;
+	int64_t layers_run = 0, flops_run = 0;
+	auto clock = []() { return std::chrono::high_resolution_clock::now(); };
+	for (int i = 0; i < images; i++) {
+		full.setInput(config->input_name, inputs[i].data());
+		early.setInput(config->input_name, inputs[i].data());
+		full.run(1);
+		truth[i] = detections(full.getTensor(full_network.getOutput(0)), full.getTensor(full_network.getOutput(1)), num_queries, num_class, policy.score_thresh);
+		runner.run([](int) { return false; });
+		for (int s = 0; s < nb_stages; s++) {
+			stage_pred[s][i] = detections(early.getTensor(stages[s][0]), early.getTensor(stages[s][1]), num_queries, num_class, policy.score_thresh);
+		}
+		const size_t count = (size_t)num_queries * num_class;
+		max_final_diff = std::max(max_final_diff, diffTensors(early.getTensor(stages.back()[0]), full.getTensor(full_network.getOutput(0)), count).max_abs);
+
+		auto earlyRun = [&]() {
+			criterion.reset();
+			return runner.run([&](int s) { return criterion.update(s, early.getTensor(stages[s][0]), early.getTensor(stages[s][1])); });
+		};
+		const int stage = earlyRun();
+		early_pred[i] = detections(early.getTensor(stages[stage][0]), early.getTensor(stages[stage][1]), num_queries, num_class, policy.score_thresh);
+		exited[stage]++;
+		reasons[stage + 1 < nb_stages ? (int)criterion.reason() : 0]++;
+		decoder_layers += stage_layer[stage] + 1;
+		layers_run += runner.layersUpTo(stage);
+		flops_run += runner.flopsUpTo(stage);
+
+		auto t0 = clock();
+		for (int it = 0; it < iterations; it++) full.run(1);
+		auto t1 = clock();
+		for (int it = 0; it < iterations; it++) earlyRun();
+		auto t2 = clock();
+		full_ms += std::chrono::duration<double, std::milli>(t1 - t0).count() / iterations;
+		early_ms += std::chrono::duration<double, std::milli>(t2 - t1).count() / iterations;
+	}
+
+	// 4. 결과
+	const int total_layers = runner.layersUpTo(nb_stages - 1);
+	const int64_t total_flops = runner.flopsUpTo(nb_stages - 1);
+	std::cout << "[detr] " << images << " images, score thresh " << policy.score_thresh << ", margin " << policy.margin << ", score delta " << policy.score_delta
+		<< ", box delta " << policy.box_delta << ", min exit " << policy.min_exit << std::endl;
+	std::cout << std::left << std::setw(8) << "exit" << std::right << std::setw(9) << "decoder" << std::setw(9) << "layers" << std::setw(10) << "GFLOP"
+		<< std::setw(10) << "mAP@0.5" << std::setw(9) << "images" << std::endl;
+	for (int s = 0; s < nb_stages; s++) {
+		std::cout << std::left << std::setw(8) << (s + 1 < nb_stages ? "aux" + std::to_string(s) : std::string("final")) << std::right
+			<< std::setw(9) << stage_layer[s] + 1 << std::setw(9) << runner.layersUpTo(s) << std::fixed << std::setprecision(3)
+			<< std::setw(10) << runner.flopsUpTo(s) * 1e-9 << std::setprecision(2);
+		printMap(std::cout, meanAveragePrecision(truth, stage_pred[s]));
+		std::cout << std::setw(9) << exited[s] << std::endl;
+	}
+	std::cout << "stop     confident " << reasons[(int)ExitReason::kCONFIDENT] << ", stable " << reasons[(int)ExitReason::kSTABLE]
+		<< ", full depth " << reasons[(int)ExitReason::kNONE] << std::endl;
+	std::cout << "decoder  " << decoder_layers / images << " / " << NUM_DECODE_LAYERS << " layers per frame" << std::endl;
+	std::cout << "saved    " << 100.0 * (1.0 - (double)layers_run / images / total_layers) << " % layers, "
+		<< 100.0 * (1.0 - (double)flops_run / images / total_flops) << " % flops" << std::endl;
+	std::cout << "latency  full " << full_ms / images << " ms, early exit " << early_ms / images << " ms per frame, speedup " << full_ms / early_ms << "x" << std::endl;
+	std::cout << "mAP@0.5  early exit vs full depth ";
+	const double map = meanAveragePrecision(truth, early_pred);
+	if (map < 0.0) std::cout << "n/a (no full depth detections)" << std::endl;
+	else std::cout << map * 100.0 << " %" << std::endl;
+	std::cout << std::scientific << std::setprecision(1) << "final    max abs diff vs network without exits " << max_final_diff << std::endl;
+	return 0;
+}
@@ -0,0 +1,153 @@
+﻿#include <algorithm>
+#include "detr_postprocess.hpp"
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define DETR_USE_SSE2
+#endif
+
+float maxArgmax(const float* data, int n, int& index)
+{
+	int i = 0;
+	float max = data[0];
+	index = 0;
+#ifdef DETR_USE_SSE2
+	if (n >= 8) {
+		// 4 lane 별로 최대값, 인덱스 유지 (lane 내에서는 앞의 인덱스 우선)
+		__m128 vmax = _mm_loadu_ps(data);
+		__m128i vidx = _mm_set_epi32(3, 2, 1, 0);
+		__m128i cur = vidx;
+		const __m128i inc = _mm_set1_epi32(4);
+		for (i = 4; i + 4 <= n; i += 4) {
+			cur = _mm_add_epi32(cur, inc);
+			__m128 v = _mm_loadu_ps(data + i);
+			__m128i m = _mm_castps_si128(_mm_cmpgt_ps(v, vmax));
+			vmax = _mm_max_ps(vmax, v);
+			vidx = _mm_or_si128(_mm_and_si128(m, cur), _mm_andnot_si128(m, vidx));
+		}
+		float lane_max[4];
+		int lane_idx[4];
+		_mm_storeu_ps(lane_max, vmax);
+		_mm_storeu_si128((__m128i*)lane_idx, vidx);
+		max = lane_max[0];
+		index = lane_idx[0];
+		for (int l = 1; l < 4; l++) {
+			if (lane_max[l] > max || (lane_max[l] == max && lane_idx[l] < index)) {
+				max = lane_max[l];
+				index = lane_idx[l];
+			}
+		}
+	}
+#endif
+	for (; i < n; i++) {
+		if (max < data[i]) {
+			max = data[i];
+			index = i;
+		}
+	}
+	return max;
+}
+
+void cxcywhToXyxy(const float* cxcywh, int n, float img_w, float img_h, float* xyxy)
+{
+	int i = 0;
+#ifdef DETR_USE_SSE2
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 sw = _mm_set1_ps(img_w);
+	const __m128 sh = _mm_set1_ps(img_h);
+	for (; i + 4 <= n; i += 4) {
+		// [4 box, cx cy w h] -> [cx x4], [cy x4], [w x4], [h x4]
+		__m128 cx = _mm_loadu_ps(cxcywh + i * 4);
+		__m128 cy = _mm_loadu_ps(cxcywh + i * 4 + 4);
+		__m128 w = _mm_loadu_ps(cxcywh + i * 4 + 8);
+		__m128 h = _mm_loadu_ps(cxcywh + i * 4 + 12);
+		_MM_TRANSPOSE4_PS(cx, cy, w, h);
+		__m128 hw = _mm_mul_ps(w, half);
+		__m128 hh = _mm_mul_ps(h, half);
+		__m128 x1 = _mm_mul_ps(_mm_sub_ps(cx, hw), sw);
+		__m128 y1 = _mm_mul_ps(_mm_sub_ps(cy, hh), sh);
+		__m128 x2 = _mm_mul_ps(_mm_add_ps(cx, hw), sw);
+		__m128 y2 = _mm_mul_ps(_mm_add_ps(cy, hh), sh);
+		_MM_TRANSPOSE4_PS(x1, y1, x2, y2);
+		_mm_storeu_ps(xyxy + i * 4, x1);
+		_mm_storeu_ps(xyxy + i * 4 + 4, y1);
+		_mm_storeu_ps(xyxy + i * 4 + 8, x2);
+		_mm_storeu_ps(xyxy + i * 4 + 12, y2);
+	}
+#endif
+	for (; i < n; i++) {
+		float cx = cxcywh[i * 4];
+		float cy = cxcywh[i * 4 + 1];
+		float w = cxcywh[i * 4 + 2];
+		float h = cxcywh[i * 4 + 3];
+		xyxy[i * 4] = (cx - w / 2.f) * img_w;
+		xyxy[i * 4 + 1] = (cy - h / 2.f) * img_h;
+		xyxy[i * 4 + 2] = (cx + w / 2.f) * img_w;
+		xyxy[i * 4 + 3] = (cy + h / 2.f) * img_h;
+	}
+}
+
+DetrPostprocess::DetrPostprocess(const DetrPostprocessParam& param)
+	: param_(param)
+{
+}
+
+// 한 이미지의 후보 선택 (threshold 통과한 query 만 top-k 정렬)
+void DetrPostprocess::selectImage(const float* scores, std::vector<Candidate>& cand)
+{
+	cand.clear();
+	for (int q = 0; q < param_.num_queries; q++) {
+		int label;
+		float score = maxArgmax(scores + q * param_.num_class, param_.num_class, label);
+		if (score > param_.score_thresh) {
+			cand.push_back(Candidate{ score, q, label });
+		}
+	}
+	auto greater = [](const Candidate& a, const Candidate& b) {
+		return a.score > b.score || (a.score == b.score && a.query < b.query);
+	};
+	if ((int)cand.size() > param_.top_k) {
+		std::nth_element(cand.begin(), cand.begin() + param_.top_k, cand.end(), greater);
+		cand.resize(param_.top_k);
+	}
+	std::sort(cand.begin(), cand.end(), greater);
+}
+
+void DetrPostprocess::run(const float* scores, const float* boxes, int batch, const int* img_w, const int* img_h, DetrResult& result)
+{
+	if ((int)cand_.size() < batch) cand_.resize(batch);
+	const int score_stride = param_.num_queries * param_.num_class;
+	const int box_stride = param_.num_queries * 4;
+
+#pragma omp parallel for schedule(dynamic, 1) if (batch > 1)
+	for (int b = 0; b < batch; b++) {
+		selectImage(scores + b * score_stride, cand_[b]);
+	}
+
+	result.offsets.resize(batch + 1);
+	result.offsets[0] = 0;
+	for (int b = 0; b < batch; b++) {
+		result.offsets[b + 1] = result.offsets[b] + (int)cand_[b].size();
+	}
+	int total = result.offsets[batch];
+	result.boxes.resize(total * 4);
+	result.scores.resize(total);
+	result.class_ids.resize(total);
+	result.query_ids.resize(total);
+
+#pragma omp parallel for schedule(dynamic, 1) if (batch > 1)
+	for (int b = 0; b < batch; b++) {
+		const std::vector<Candidate>& cand = cand_[b];
+		int offset = result.offsets[b];
+		const float* img_boxes = boxes + b * box_stride;
+		// 선택된 box 를 연속된 위치로 모은 뒤 한번에 변환
+		float* out_boxes = result.boxes.data() + offset * 4;
+		for (size_t i = 0; i < cand.size(); i++) {
+			const float* src = img_boxes + cand[i].query * 4;
+			std::copy(src, src + 4, out_boxes + i * 4);
+			result.scores[offset + i] = cand[i].score;
+			result.class_ids[offset + i] = cand[i].label;
+			result.query_ids[offset + i] = cand[i].query;
+		}
+		cxcywhToXyxy(out_boxes, (int)cand.size(), (float)img_w[b], (float)img_h[b], out_boxes);
+	}
+}
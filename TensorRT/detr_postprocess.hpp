@@ -0,0 +1,52 @@
+﻿#pragma once
+#include <cstdint>
+#include <vector>
+
+struct DetrPostprocessParam {
+	int num_queries;	// 100
+	int num_class;		// scores 출력의 클래스 수 (background 제외, 91)
+	float score_thresh;	// 이 값 이하의 query 는 정렬 전에 제외
+	int top_k;			// 이미지당 최대 출력 개수
+};
+
+// 배치 결과 (이미지별 결과를 이어 붙인 flat 배열)
+// b 번째 이미지의 결과 : [offsets[b], offsets[b + 1])
+struct DetrResult {
+	std::vector<int> offsets;		// [batch + 1]
+	std::vector<float> boxes;		// [N, 4] x1, y1, x2, y2 (원본 이미지 좌표)
+	std::vector<float> scores;		// [N] (내림차순)
+	std::vector<int> class_ids;		// [N]
+	std::vector<int> query_ids;		// [N]
+};
+
+//! \class DetrPostprocess
+//!
+//! \brief DETR 출력(scores [B, Q, K], boxes [B, Q, 4] cxcywh) 배치 후처리.
+//!  query 별 max/argmax(SIMD) -> threshold -> partial top-k -> cxcywh to xyxy(SIMD) 순으로 수행
+//!
+class DetrPostprocess
+{
+public:
+	DetrPostprocess(const DetrPostprocessParam& param);
+
+	// img_w, img_h : 이미지별 원본 크기 [batch]
+	void run(const float* scores, const float* boxes, int batch, const int* img_w, const int* img_h, DetrResult& result);
+
+private:
+	struct Candidate {
+		float score;
+		int query;
+		int label;
+	};
+	void selectImage(const float* scores, std::vector<Candidate>& cand);
+
+	DetrPostprocessParam param_;
+	std::vector<std::vector<Candidate>> cand_;	// 이미지별 후보 (재사용)
+};
+
+// 한 query 의 클래스 점수에 대한 최대값, 인덱스 (SIMD)
+float maxArgmax(const float* data, int n, int& index);
+
+// cxcywh(0~1) -> xyxy(원본 이미지 좌표) 변환, n 개의 box 를 SIMD 로 처리
+// cxcywh : [n, 4], xyxy : [n, 4]
+void cxcywhToXyxy(const float* cxcywh, int n, float img_w, float img_h, float* xyxy);
@@ -15,6 +15,7 @@
 #include "preprocess.hpp"	// preprocess plugin 
 #include "logging.hpp"	
 #include "calibrator.h"		// ptq
+#include "detr_postprocess.hpp"	// detr postprocess
 
 #define DEVICE 0
 #define BATCH_SIZE 1
@@ -43,6 +44,7 @@ static const int NUM_DECODE_LAYERS = 6;
 static const int NUM_QUERIES = 100;
 static const float SCORE_THRESH = 0.5;
 static const int precision_mode = 32; // fp32 : 32, fp16 : 16, int8(ptq) : 8
+static const bool simplify_graph = true; // self-attention q, k projection 합치기, memory + pos 한번만 계산, 첫 decoder self-attention 상수 (false : PyTorch 구조 그대로)
 
 const char* INPUT_BLOB_NAME = "images";
 const std::vector<std::string> OUTPUT_NAMES = { "scores", "boxes" };
@@ -59,8 +61,9 @@ ITensor* MultiHeadAttention(INetworkDefinition *network, std::unordered_map<std:
 ITensor* LayerNorm(INetworkDefinition *network, ITensor& input, std::unordered_map<std::string, Weights>& weightMap, const std::string& lname, int d_model = 256);
 ITensor* TransformerEncoderLayer(INetworkDefinition *network, std::unordered_map<std::string, Weights>& weightMap, const std::string& lname, ITensor& src, ITensor& pos, int d_model = 256, int nhead = 8, int dim_feedforward = 2048);
 ITensor* TransformerEncoder(INetworkDefinition *network, std::unordered_map<std::string, Weights>& weightMap, const std::string& lname, ITensor& src, ITensor& pos, int num_layers = 6);
-ITensor* TransformerDecoderLayer(INetworkDefinition *network, std::unordered_map<std::string, Weights>& weightMap, const std::string& lname, ITensor& tgt, ITensor& memory, ITensor& pos, ITensor& query_pos, int d_model = 256, int nhead = 8, int dim_feedforward = 2048);
-ITensor* TransformerDecoder(INetworkDefinition *network, std::unordered_map<std::string, Weights>& weightMap, const std::string& lname, ITensor& tgt, ITensor& memory, ITensor& pos, ITensor& query_pos, int num_layers = 6, int d_model = 256, int nhead = 8, int dim_feedforward = 2048);
+ITensor* ZeroTargetSelfAttention(INetworkDefinition *network, std::unordered_map<std::string, Weights>& weightMap, const std::string& lname, int num_queries, int d_model = 256);
+ITensor* TransformerDecoderLayer(INetworkDefinition *network, std::unordered_map<std::string, Weights>& weightMap, const std::string& lname, ITensor* tgt, ITensor& memory, ITensor& key_embed, ITensor& query_pos, int d_model = 256, int nhead = 8, int dim_feedforward = 2048);
+ITensor* TransformerDecoder(INetworkDefinition *network, std::unordered_map<std::string, Weights>& weightMap, const std::string& lname, ITensor* tgt, ITensor& memory, ITensor& pos, ITensor& query_pos, int num_layers = 6, int d_model = 256, int nhead = 8, int dim_feedforward = 2048);
 ITensor* Transformer(INetworkDefinition *network, std::unordered_map<std::string, Weights>& weightMap, const std::string& lname, ITensor& src, ITensor& pos_embed, int num_queries = 100, int num_encoder_layers = 6, int num_decoder_layers = 6, int d_model = 256, int nhead = 8, int dim_feedforward = 2048);
 ITensor* MLP(INetworkDefinition *network, std::unordered_map<std::string, Weights>& weightMap, const std::string& lname, ITensor& src, int num_layers = 3, int hidden_dim = 256, int output_dim = 4);
 std::vector<ITensor*> Predict(INetworkDefinition *network, std::unordered_map<std::string, Weights>& weightMap, ITensor* src);
@@ -168,6 +171,7 @@ int main()
 {
 	unsigned int maxBatchSize = 1;	// 생성할 TensorRT 엔진파일에서 사용할 배치 사이즈 값 
 	bool serialize = false;			// Serialize 강제화 시키기(true 엔진 파일 생성)
+	bool dump_tensors = false;		// 첫 추론의 plugin 중간 텐서 (preprocess), 엔진 출력을 dump 파일로 기록 (tensor_diff 로 ir_run -d 결과와 비교)
 	char engineFileName[] = "detr";
 	char engine_file_path[256];
 	sprintf(engine_file_path, "../Engine/%s_%d.engine", engineFileName, precision_mode);
@@ -235,18 +239,16 @@ int main()
 	else {
 		std::cout << "Total number of images : " << file_names.size() << std::endl << std::endl;
 	}
-	cv::Mat ori_img;
+	std::vector<cv::Mat> ori_imgs(maxBatchSize);
+	std::vector<int> ori_w(maxBatchSize), ori_h(maxBatchSize); // 후처리에서 box 좌표 복원에 사용
 	cv::Mat img_r(INPUT_H, INPUT_W, CV_8UC3);
 	for (int idx = 0; idx < maxBatchSize; idx++) { // mat -> vector<uint8_t> 
-		ori_img = cv::imread(file_names[idx]);
-		cv::resize(ori_img, img_r, img_r.size(), cv::INTER_LINEAR);
-		memcpy(input.data(), img_r.data, maxBatchSize * INPUT_H * INPUT_W * INPUT_C);
+		ori_imgs[idx] = cv::imread(file_names[idx % file_names.size()]);
+		ori_w[idx] = ori_imgs[idx].cols;
+		ori_h[idx] = ori_imgs[idx].rows;
+		cv::resize(ori_imgs[idx], img_r, img_r.size(), cv::INTER_LINEAR);
+		memcpy(input.data() + idx * INPUT_H * INPUT_W * INPUT_C, img_r.data, INPUT_H * INPUT_W * INPUT_C);
 	}
-	//std::ofstream ofs("../Validation_py/trt_1", std::ios::binary);
-	//if (ofs.is_open())
-	//	ofs.write((const char*)input.data(), input.size() * sizeof(uint8_t));
-	//ofs.close();
-	//std::exit(0);
 
 	std::cout << "===== input load done =====" << std::endl << std::endl;
 
@@ -256,6 +258,34 @@ int main()
 	// CUDA 스트림 생성
 	cudaStream_t stream;
 	CHECK(cudaStreamCreate(&stream));
+
+	// 중간 텐서 dump : 한번 추론하면서 plugin 이 기록한 텐서와 엔진 출력 (batch 포함 binding shape) 저장
+	if (dump_tensors) {
+		char dump_file_path[256];
+		sprintf(dump_file_path, "../Engine/%s_%d.dump", engineFileName, precision_mode);
+		TensorDumpWriter dump;
+		if (dump.open(dump_file_path, std::string(engineFileName) + " trt " + std::to_string(precision_mode))) {
+			setTensorDump(&dump);
+			CHECK(cudaMemcpyAsync(buffers[0], input.data(), maxBatchSize * INPUT_C * INPUT_H * INPUT_W * sizeof(uint8_t), cudaMemcpyHostToDevice, stream));
+			context->enqueue(maxBatchSize, buffers.data(), stream, nullptr);
+			CHECK(cudaMemcpyAsync(outputs[0], buffers[1], maxBatchSize * NUM_QUERIES * (NUM_CLASS - 1) * sizeof(float), cudaMemcpyDeviceToHost, stream));
+			CHECK(cudaMemcpyAsync(outputs[1], buffers[2], maxBatchSize * NUM_QUERIES * 4 * sizeof(float), cudaMemcpyDeviceToHost, stream));
+			cudaStreamSynchronize(stream);
+			setTensorDump(nullptr);
+			for (int k = 0; k < (int)OUTPUT_NAMES.size(); k++) {
+				const Dims d = engine->getBindingDimensions(engine->getBindingIndex(OUTPUT_NAMES[k].c_str()));
+				int dims[kDUMP_MAX_DIMS] = { (int)maxBatchSize };
+				for (int j = 0; j < d.nbDims && j + 1 < kDUMP_MAX_DIMS; j++) dims[j + 1] = d.d[j];
+				dump.append(OUTPUT_NAMES[k], "output", kDUMP_FLOAT32, std::min(d.nbDims + 1, kDUMP_MAX_DIMS), dims, outputs[k]);
+			}
+			dump.close();
+			std::cout << "dump " << dump_file_path << " : " << dump.recordCount() << " tensors" << std::endl << std::endl;
+		}
+		else {
+			std::cerr << "[ERROR] file open error : " << dump_file_path << std::endl;
+		}
+	}
+
 	CHECK(cudaMemcpyAsync(buffers[0], input.data(), maxBatchSize * INPUT_C * INPUT_H * INPUT_W * sizeof(uint8_t), cudaMemcpyHostToDevice, stream));
 	context->enqueue(maxBatchSize, buffers.data(), stream, nullptr);
 	CHECK(cudaMemcpyAsync(outputs[0], buffers[1], maxBatchSize * NUM_QUERIES * (NUM_CLASS - 1) * sizeof(float), cudaMemcpyDeviceToHost, stream));
@@ -284,48 +314,29 @@ int main()
 	std::cout << iter_count << " th Iteration, Total dur time : " << dur_time << " [milliseconds]" << std::endl;
 
 	// 이미지 출력 로직
-	//prob [100, 91]
-	//box  [100, 4]
-	std::vector<std::pair<float, int>> items(NUM_QUERIES);
-	int offset = (NUM_CLASS - 1);
-	for (int i = 0; i < NUM_QUERIES; i++) { // 100
-		float* pred = scores_h.data() + i * offset;
-		int label = -1;
-		float score = -1;
-		for (int j = 0; j < offset; j++) { // 91
-			if (score < pred[j]) {
-				label = j + i * offset;
-				score = pred[j];
-			}
-		}
-		items[i].first = score;
-		items[i].second = label;
-	}
-	sort(items.rbegin(), items.rend());
+	//prob [B, 100, 91]
+	//box  [B, 100, 4]
+	DetrPostprocess detr_postprocess({ NUM_QUERIES, NUM_CLASS - 1, 0.9f, 5 }); // score > 0.9, 최대 5개
+	DetrResult det;
+	detr_postprocess.run(scores_h.data(), boxes_h.data(), maxBatchSize, ori_w.data(), ori_h.data(), det);
+
 	std::vector<std::vector<float>> COLORS = { {0.000, 0.447, 0.741}, {0.850, 0.325, 0.098}, {0.929, 0.694, 0.125},
 		{0.494, 0.184, 0.556}, {0.466, 0.674, 0.188}, {0.301, 0.745, 0.933} };
 
-	for (int idx = 0; idx < 5 && items[idx].first > 0.9; idx++) {
-		int ind = items[idx].second / offset;
-		int label = items[idx].second % offset;
-		float cx = boxes_h[ind * 4];
-		float cy = boxes_h[ind * 4 + 1];
-		float w = boxes_h[ind * 4 + 2];
-		float h = boxes_h[ind * 4 + 3];
-		float x1 = (cx - w / 2.0) * ori_img.cols;
-		float y1 = (cy - h / 2.0) * ori_img.rows;
-		float x2 = (cx + w / 2.0) * ori_img.cols;
-		float y2 = (cy + h / 2.0) * ori_img.rows;
-
-		cv::Rect rec(x1, y1, x2 - x1, y2 - y1);
-		cv::Scalar color(int(COLORS[idx%COLORS.size()][2]*100), int(COLORS[idx%COLORS.size()][1] * 100), int(COLORS[idx%COLORS.size()][0] * 100));
-		cv::rectangle(ori_img, rec, color, 1.5);
-		cv::putText(ori_img, COCO_names[label].c_str(), cv::Point(rec.x, rec.y - 1), cv::FONT_HERSHEY_PLAIN, 0.8, color, 1.5);
-		printf("      %d %4d prob=%.5f %s\n", idx, label, items[idx].first, COCO_names[label].c_str());
-	}
-	// items [100, 2] (sorted) (label = second%offset, box_location = second/offset) 
-	cv::imshow("result", ori_img);
-	cv::waitKey(0);
+	for (int b = 0; b < maxBatchSize; b++) {
+		cv::Mat& ori_img = ori_imgs[b];
+		for (int i = det.offsets[b], idx = 0; i < det.offsets[b + 1]; i++, idx++) { // score 내림차순
+			const float* xyxy = &det.boxes[i * 4];
+			int label = det.class_ids[i];
+			cv::Rect rec(xyxy[0], xyxy[1], xyxy[2] - xyxy[0], xyxy[3] - xyxy[1]);
+			cv::Scalar color(int(COLORS[idx%COLORS.size()][2]*100), int(COLORS[idx%COLORS.size()][1] * 100), int(COLORS[idx%COLORS.size()][0] * 100));
+			cv::rectangle(ori_img, rec, color, 1.5);
+			cv::putText(ori_img, COCO_names[label].c_str(), cv::Point(rec.x, rec.y - 1), cv::FONT_HERSHEY_PLAIN, 0.8, color, 1.5);
+			printf("      %d %4d prob=%.5f %s\n", idx, label, det.scores[i], COCO_names[label].c_str());
+		}
+		cv::imshow("result", ori_img);
+		cv::waitKey(0);
+	}
 	std::cout << "==================================================" << std::endl;
 
 	// Release...
@@ -642,22 +653,51 @@ ITensor* PositionEmbeddingSine(INetworkDefinition *network, std::unordered_map<s
 	return pos_embed->getOutput(0);
 }
 
+// a, b 를 이어붙인 가중치 (weightMap 에 name 으로 보관, 종료시 함께 해제)
+static Weights concatWeights(std::unordered_map<std::string, Weights>& weightMap, const std::string& name, const Weights& a, const Weights& b) {
+	float *pval = reinterpret_cast<float*>(malloc(sizeof(float) * (a.count + b.count)));
+	memcpy(pval, a.values, sizeof(float) * a.count);
+	memcpy(pval + a.count, b.values, sizeof(float) * b.count);
+	Weights concat{ DataType::kFLOAT, pval, a.count + b.count };
+	weightMap[name] = concat;
+	return concat;
+}
+
 ITensor* MultiHeadAttention(INetworkDefinition *network, std::unordered_map<std::string, Weights>& weightMap, const std::string& lname, ITensor& query, ITensor& key, ITensor& value, int embed_dim, int num_heads) {
 	int tgt_len = query.getDimensions().d[0];
 	int head_dim = embed_dim / num_heads;
 
-	// q
-	auto linear_q = network->addFullyConnected(query, embed_dim, weightMap[lname + ".in_proj_weight_q"], weightMap[lname + ".in_proj_bias_q"]);
-	assert(linear_q);
-	// k
-	auto linear_k = network->addFullyConnected(key, embed_dim, weightMap[lname + ".in_proj_weight_k"], weightMap[lname + ".in_proj_bias_k"]);
-	assert(linear_k);
+	ITensor* q_proj = nullptr;
+	ITensor* k_proj = nullptr;
+	if (simplify_graph && &query == &key) {
+		// self-attention : query, key 입력이 같으므로 q, k projection 을 출력 2 * embed_dim 인 fully connected 하나로 (가중치 행 이어붙임)
+		Weights qk_weight = concatWeights(weightMap, lname + ".in_proj_weight_qk", weightMap[lname + ".in_proj_weight_q"], weightMap[lname + ".in_proj_weight_k"]);
+		Weights qk_bias = concatWeights(weightMap, lname + ".in_proj_bias_qk", weightMap[lname + ".in_proj_bias_q"], weightMap[lname + ".in_proj_bias_k"]);
+		auto linear_qk = network->addFullyConnected(query, 2 * embed_dim, qk_weight, qk_bias);
+		assert(linear_qk);
+		auto slice_q = network->addSlice(*linear_qk->getOutput(0), Dims4{ 0, 0, 0, 0 }, Dims4{ tgt_len, embed_dim, 1, 1 }, Dims4{ 1, 1, 1, 1 });
+		assert(slice_q);
+		auto slice_k = network->addSlice(*linear_qk->getOutput(0), Dims4{ 0, embed_dim, 0, 0 }, Dims4{ tgt_len, embed_dim, 1, 1 }, Dims4{ 1, 1, 1, 1 });
+		assert(slice_k);
+		q_proj = slice_q->getOutput(0);
+		k_proj = slice_k->getOutput(0);
+	}
+	else {
+		// q
+		auto linear_q = network->addFullyConnected(query, embed_dim, weightMap[lname + ".in_proj_weight_q"], weightMap[lname + ".in_proj_bias_q"]);
+		assert(linear_q);
+		// k
+		auto linear_k = network->addFullyConnected(key, embed_dim, weightMap[lname + ".in_proj_weight_k"], weightMap[lname + ".in_proj_bias_k"]);
+		assert(linear_k);
+		q_proj = linear_q->getOutput(0);
+		k_proj = linear_k->getOutput(0);
+	}
 	// v
 	auto linear_v = network->addFullyConnected(value, embed_dim, weightMap[lname + ".in_proj_weight_v"], weightMap[lname + ".in_proj_bias_v"]);
 	assert(linear_v);
 	auto scaling_t = network->addConstant(Dims4{ 1, 1, 1, 1 }, Weights{ DataType::kFLOAT, &SCALING, 1 });
 	assert(scaling_t);
-	auto q_scaling = network->addElementWise(*linear_q->getOutput(0), *scaling_t->getOutput(0), ElementWiseOperation::kPROD);
+	auto q_scaling = network->addElementWise(*q_proj, *scaling_t->getOutput(0), ElementWiseOperation::kPROD);
 	assert(q_scaling);
 
 	auto q_shuffle = network->addShuffle(*q_scaling->getOutput(0));
@@ -666,7 +706,7 @@ ITensor* MultiHeadAttention(INetworkDefinition *network, std::unordered_map<std:
 	q_shuffle->setReshapeDimensions(Dims3{ -1, num_heads, head_dim });
 	q_shuffle->setSecondTranspose(Permutation{ 1, 0, 2 });
 
-	auto k_shuffle = network->addShuffle(*linear_k->getOutput(0));
+	auto k_shuffle = network->addShuffle(*k_proj);
 	assert(k_shuffle);
 	k_shuffle->setName((lname + ".k_shuffle").c_str());
 	k_shuffle->setReshapeDimensions(Dims3{ -1, num_heads, head_dim });
@@ -785,24 +825,62 @@ ITensor* TransformerEncoder(INetworkDefinition *network, std::unordered_map<std:
 	return out;
 }
 
-ITensor* TransformerDecoderLayer(INetworkDefinition *network, std::unordered_map<std::string, Weights>& weightMap, const std::string& lname, ITensor& tgt, ITensor& memory, ITensor& pos, ITensor& query_pos, int d_model, int nhead, int dim_feedforward) {
-	auto pos_embed = network->addElementWise(tgt, query_pos, ElementWiseOperation::kSUM);
-	assert(pos_embed);
+// tgt 가 0 인 첫 decoder 레이어의 self-attention 블록 출력 (norm1) 을 build 시점에 계산
+// v = 0 * W_v + b_v 로 모든 행이 같아서 softmax 가중치 (query_pos) 와 무관하게 attention 출력은 b_v
+// norm1(0 + out_proj(b_v)) 를 query 수 만큼 반복한 상수 [num_queries, d_model, 1, 1]
+ITensor* ZeroTargetSelfAttention(INetworkDefinition *network, std::unordered_map<std::string, Weights>& weightMap, const std::string& lname, int num_queries, int d_model) {
+	const float *bias_v = (const float*)(weightMap[lname + ".self_attn.in_proj_bias_v"].values);
+	const float *out_w = (const float*)(weightMap[lname + ".self_attn.out_proj.weight"].values);
+	const float *out_b = (const float*)(weightMap[lname + ".self_attn.out_proj.bias"].values);
+	const float *gamma = (const float*)(weightMap[lname + ".norm1.weight"].values);
+	const float *beta = (const float*)(weightMap[lname + ".norm1.bias"].values);
+
+	std::vector<double> row(d_model);
+	double mean = 0.0, var = 0.0;
+	for (int o = 0; o < d_model; o++) {
+		double acc = out_b[o];
+		for (int i = 0; i < d_model; i++) acc += (double)out_w[o * d_model + i] * bias_v[i];
+		row[o] = acc;
+		mean += acc / d_model;
+	}
+	for (int o = 0; o < d_model; o++) var += (row[o] - mean) * (row[o] - mean) / d_model;
 
-	ITensor* tgt2 = MultiHeadAttention(network, weightMap, lname + ".self_attn", *pos_embed->getOutput(0), *pos_embed->getOutput(0), tgt);
-	//return tgt2; // 정합성 확인 완료
+	float *pval = reinterpret_cast<float*>(malloc(sizeof(float) * num_queries * d_model));
+	for (int o = 0; o < d_model; o++) {
+		pval[o] = (float)((row[o] - mean) / std::sqrt(var + EPS) * gamma[o] + beta[o]);
+	}
+	for (int q = 1; q < num_queries; q++) {
+		memcpy(pval + q * d_model, pval, sizeof(float) * d_model);
+	}
+	Weights norm1_weight{ DataType::kFLOAT, pval, num_queries * d_model };
+	weightMap[lname + ".norm1.const"] = norm1_weight;
+	auto norm1 = network->addConstant(Dims4{ num_queries, d_model, 1, 1 }, norm1_weight);
+	assert(norm1);
+	return norm1->getOutput(0);
+}
 
-	auto shortcut1 = network->addElementWise(tgt, *tgt2, ElementWiseOperation::kSUM);
-	assert(shortcut1);
-	ITensor* norm1 = LayerNorm(network, *shortcut1->getOutput(0), weightMap, lname + ".norm1");
+// tgt 가 nullptr 이면 0 (첫 decoder 레이어, self-attention 블록은 상수), key_embed 는 memory + pos
+ITensor* TransformerDecoderLayer(INetworkDefinition *network, std::unordered_map<std::string, Weights>& weightMap, const std::string& lname, ITensor* tgt, ITensor& memory, ITensor& key_embed, ITensor& query_pos, int d_model, int nhead, int dim_feedforward) {
+	ITensor* norm1 = nullptr;
+	if (tgt) {
+		auto pos_embed = network->addElementWise(*tgt, query_pos, ElementWiseOperation::kSUM);
+		assert(pos_embed);
+
+		ITensor* tgt2 = MultiHeadAttention(network, weightMap, lname + ".self_attn", *pos_embed->getOutput(0), *pos_embed->getOutput(0), *tgt);
+		//return tgt2; // 정합성 확인 완료
+
+		auto shortcut1 = network->addElementWise(*tgt, *tgt2, ElementWiseOperation::kSUM);
+		assert(shortcut1);
+		norm1 = LayerNorm(network, *shortcut1->getOutput(0), weightMap, lname + ".norm1");
+	}
+	else {
+		norm1 = ZeroTargetSelfAttention(network, weightMap, lname, query_pos.getDimensions().d[0], d_model);
+	}
 
 	auto query_embed = network->addElementWise(*norm1, query_pos, ElementWiseOperation::kSUM);
 	assert(query_embed);
 
-	auto key_embed = network->addElementWise(memory, pos, ElementWiseOperation::kSUM);
-	assert(key_embed);
-
-	ITensor* mha2 = MultiHeadAttention(network, weightMap, lname + ".multihead_attn", *query_embed->getOutput(0), *key_embed->getOutput(0), memory);
+	ITensor* mha2 = MultiHeadAttention(network, weightMap, lname + ".multihead_attn", *query_embed->getOutput(0), key_embed, memory);
 
 	auto shortcut2 = network->addElementWise(*norm1, *mha2, ElementWiseOperation::kSUM);
 	assert(shortcut2);
@@ -826,12 +904,20 @@ ITensor* TransformerDecoderLayer(INetworkDefinition *network, std::unordered_map
 	return norm3;
 }
 
-ITensor* TransformerDecoder(INetworkDefinition *network, std::unordered_map<std::string, Weights>& weightMap, const std::string& lname, ITensor& tgt, ITensor& memory, ITensor& pos, ITensor& query_pos, int num_layers, int d_model, int nhead, int dim_feedforward) {
-	ITensor* out = &tgt;
+// tgt 가 nullptr 이면 0 으로 시작 (simplify_graph)
+ITensor* TransformerDecoder(INetworkDefinition *network, std::unordered_map<std::string, Weights>& weightMap, const std::string& lname, ITensor* tgt, ITensor& memory, ITensor& pos, ITensor& query_pos, int num_layers, int d_model, int nhead, int dim_feedforward) {
+	ITensor* out = tgt;
+	// cross-attention 의 key 입력 memory + pos 는 모든 레이어가 같음
+	ITensor* key_embed = nullptr;
 	//std::vector<ITensor*> keeps;
 	for (int i = 0; i < num_layers; i++) {
 		std::string layer_name = lname + ".layers." + std::to_string(i);
-		out = TransformerDecoderLayer(network, weightMap, layer_name, *out, memory, pos, query_pos, d_model, nhead, dim_feedforward);
+		if (!key_embed || !simplify_graph) {
+			auto memory_pos = network->addElementWise(memory, pos, ElementWiseOperation::kSUM);
+			assert(memory_pos);
+			key_embed = memory_pos->getOutput(0);
+		}
+		out = TransformerDecoderLayer(network, weightMap, layer_name, out, memory, *key_embed, query_pos, d_model, nhead, dim_feedforward);
 		//IShuffleLayer* shuffle = network->addShuffle(*norm);
 		//shuffle->setReshapeDimensions(Dims3{ 1, norm->getDimensions().d[0], norm->getDimensions().d[1] });
 		//ITensor* shuffled = shuffle->getOutput(0);
@@ -849,20 +935,24 @@ ITensor* Transformer(INetworkDefinition *network, std::unordered_map<std::string
 	auto memory = TransformerEncoder(network, weightMap, lname + ".encoder", src, pos_embed, num_encoder_layers);
 	//return memory; // 수정 필요
 
-	// construct tgt
-	float *pval = reinterpret_cast<float*>(malloc(sizeof(float) * num_queries * d_model));
-	for (int i = 0; i < num_queries * d_model; i++) {
-		pval[i] = 0.0;
+	// construct tgt (simplify_graph 이면 첫 decoder 레이어가 0 을 직접 반영)
+	ITensor* tgt = nullptr;
+	if (!simplify_graph) {
+		float *pval = reinterpret_cast<float*>(malloc(sizeof(float) * num_queries * d_model));
+		for (int i = 0; i < num_queries * d_model; i++) {
+			pval[i] = 0.0;
+		}
+		Weights tgt_weight{ DataType::kFLOAT, pval, num_queries * d_model };
+		weightMap[lname + ".tgt_weight"] = tgt_weight;
+		auto tgt_const = network->addConstant(Dims4{ num_queries, d_model, 1, 1 }, tgt_weight);
+		assert(tgt_const);
+		tgt = tgt_const->getOutput(0);
 	}
-	Weights tgt_weight{ DataType::kFLOAT, pval, num_queries * d_model };
-	weightMap[lname + ".tgt_weight"] = tgt_weight;
-	auto tgt = network->addConstant(Dims4{ num_queries, d_model, 1, 1 }, tgt_weight);
-	assert(tgt);
 	// construct query_pos
 	auto query_pos = network->addConstant(Dims4{ num_queries, d_model, 1, 1 }, weightMap["query_embed.weight"]);
 	assert(query_pos);
 
-	auto out = TransformerDecoder(network, weightMap, lname + ".decoder", *tgt->getOutput(0), *memory, pos_embed, *query_pos->getOutput(0), num_decoder_layers, d_model, nhead, dim_feedforward);
+	auto out = TransformerDecoder(network, weightMap, lname + ".decoder", tgt, *memory, pos_embed, *query_pos->getOutput(0), num_decoder_layers, d_model, nhead, dim_feedforward);
 	return out;
 }
 
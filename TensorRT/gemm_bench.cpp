@@ -0,0 +1,179 @@
+﻿// 모델의 fully connected, matmul shape 에 대해 naive loop, packed GEMM (명령어 집합별), BLAS 의 GFLOP/s 비교
+// usage : gemm_bench [model (기본 전체)] [-b batch] [-n iterations] [-t threads]
+//   -b : fully connected 의 행 수 (M) 에 곱할 batch 크기 (기본 1, GEMV)
+//   USE_CBLAS 를 정의하고 cblas 와 link 하면 cblas_sgemm 도 측정
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include "cpu_gemm.hpp"
+#include "ir_models.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#ifdef USE_CBLAS
+#include <cblas.h>
+#endif
+
+// C[M, N] = A[M, K] B[K, N], fully connected 는 B = W^T (W : [N, K])
+struct GemmShape {
+	int M, N, K;
+	bool weights;	// true : fully connected (B 상수, 생성시 정렬), false : matmul (B 를 호출마다 정렬)
+	bool trans_b;	// matmul 의 B transpose
+};
+
+struct ShapeEntry {
+	GemmShape shape;
+	std::map<std::string, int> count;	// 모델별 사용 횟수
+};
+
+static std::string shapeKey(const GemmShape& s)
+{
+	std::ostringstream os;
+	os << (s.weights ? "fc " : "matmul ") << s.M << "x" << s.K << " * " << s.K << "x" << s.N;
+	if (s.trans_b) os << "^T";
+	return os.str();
+}
+
+static double bestMs(int iterations, const std::function<void()>& fn)
+{
+	fn();	// warm up
+	double ms = 1e30;
+	for (int it = 0; it < iterations; it++) {
+		auto t0 = std::chrono::high_resolution_clock::now();
+		fn();
+		auto t1 = std::chrono::high_resolution_clock::now();
+		ms = std::min(ms, std::chrono::duration<double, std::milli>(t1 - t0).count());
+	}
+	return ms;
+}
+
+int main(int argc, char** argv)
+{
+	std::string only;
+	int iterations = 5, batch = 1;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-n") && i + 1 < argc) iterations = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-b") && i + 1 < argc) batch = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+#ifdef _OPENMP
+			omp_set_num_threads(atoi(argv[++i]));
+#else
+			++i;
+#endif
+		}
+		else only = argv[i];
+	}
+	std::cout << "detected ISA : " << gemmIsaName(detectGemmIsa()) << std::endl;
+
+	// 1. 모델별 fully connected, matmul shape 수집
+	std::map<std::string, ShapeEntry> shapes;
+	std::vector<std::string> order;
+	for (const ir::ModelConfig& config : ir::modelConfigs()) {
+		if (!only.empty() && only != config.name) continue;
+		ir::WeightMap weightMap;
+		ir::WeightSource weights(weightMap, true);
+		ir::Network network;
+		if (!ir::buildModel(config.name, network, weights, 1)) continue;
+		for (int i = 0; i < network.getNbLayers(); i++) {
+			const ir::Layer* l = network.getLayer(i);
+			GemmShape s;
+			if (l->getType() == ir::LayerType::kFULLY_CONNECTED) {
+				const ir::Dims in = l->getInput(0)->getDimensions();
+				int rows = 1;
+				for (int d = 0; d < in.nbDims - 3; d++) rows *= in.d[d];
+				s = GemmShape{ rows * batch, l->nb_outputs_, (int)(l->kernel_weights_.size() / l->nb_outputs_), true, true };
+			}
+			else if (l->getType() == ir::LayerType::kMATRIX_MULTIPLY && l->op0_ == ir::MatrixOperation::kNONE) {
+				const ir::Dims out = l->getOutput(0)->getDimensions();
+				const ir::Dims a = l->getInput(0)->getDimensions();
+				s = GemmShape{ out.d[out.nbDims - 2], out.d[out.nbDims - 1], a.d[a.nbDims - 1], false, l->op1_ == ir::MatrixOperation::kTRANSPOSE };
+			}
+			else continue;
+			const std::string key = shapeKey(s);
+			if (!shapes.count(key)) order.push_back(key);
+			shapes[key].shape = s;
+			shapes[key].count[config.name]++;
+		}
+	}
+
+	std::vector<GemmIsa> isas;
+	for (GemmIsa isa : { GemmIsa::kSCALAR, GemmIsa::kAVX2, GemmIsa::kAVX512 }) {
+		if (gemmIsaSupported(isa)) isas.push_back(isa);
+	}
+	std::cout << std::left << std::setw(36) << "shape" << std::setw(22) << "models" << std::right << std::setw(8) << "MFLOP" << std::setw(10) << "naive";
+	for (GemmIsa isa : isas) std::cout << std::setw(10) << gemmIsaName(isa);
+#ifdef USE_CBLAS
+	std::cout << std::setw(10) << "cblas";
+#endif
+	std::cout << "  (GFLOP/s)  max abs err" << std::endl;
+
+	std::mt19937 rng(0);
+	std::uniform_real_distribution<float> uni(-1.f, 1.f);
+	for (const std::string& key : order) {
+		const ShapeEntry& e = shapes[key];
+		const GemmShape& s = e.shape;
+		// fully connected : b = W [N, K], matmul : b = [K, N] 또는 transpose 된 [N, K]
+		std::vector<float> a((size_t)s.M * s.K), b((size_t)s.K * s.N), bias(s.N);
+		for (auto& v : a) v = uni(rng);
+		for (auto& v : b) v = uni(rng) / std::sqrt((float)s.K);
+		for (auto& v : bias) v = s.weights ? uni(rng) : 0.f;
+		const int64_t sbk = s.trans_b ? 1 : s.N, sbn = s.trans_b ? s.K : 1;
+		std::vector<float> ref((size_t)s.M * s.N), out(ref.size());
+
+		std::ostringstream models;
+		for (const auto& c : e.count) models << (models.tellp() > 0 ? "," : "") << c.first << "x" << c.second;
+		const double flops = 2.0 * s.M * s.N * s.K;
+		std::cout << std::left << std::setw(36) << key << std::setw(22) << models.str() << std::right << std::fixed << std::setprecision(1) << std::setw(8) << flops / 1e6;
+
+		// naive : 출력 원소마다 내적 (CpuGemm 이전 interpreter 방식)
+		const double naive_ms = bestMs(iterations, [&]() {
+#pragma omp parallel for schedule(static)
+			for (int t = 0; t < s.M * s.N; t++) {
+				const int m = t / s.N, n = t % s.N;
+				float acc = bias[n];
+				for (int k = 0; k < s.K; k++) acc += a[(int64_t)m * s.K + k] * b[k * sbk + n * sbn];
+				ref[t] = acc;
+			}
+		});
+		std::cout << std::setw(10) << std::setprecision(2) << flops / (naive_ms * 1e6);
+
+		std::ostringstream errors;
+		auto check = [&](const char* name) {
+			double err = 0.0;
+			for (size_t i = 0; i < out.size(); i++) err = std::max(err, (double)std::fabs(out[i] - ref[i]));
+			errors << " " << name << " " << std::scientific << std::setprecision(1) << err << std::fixed;
+			if (err > 1e-3) errors << " [ERROR]";
+		};
+		for (GemmIsa isa : isas) {
+			double ms;
+			if (s.weights) {
+				const CpuGemm g(s.N, s.K, b.data(), bias.data(), ConvActivation{ false, ir::ActivationType::kRELU, 0.f, 0.f }, isa);
+				ms = bestMs(iterations, [&]() { g.run(s.M, a.data(), out.data()); });
+			}
+			else {
+				ms = bestMs(iterations, [&]() { gemm(s.M, s.N, s.K, a.data(), s.K, 1, b.data(), sbk, sbn, out.data(), s.N, isa); });
+			}
+			std::cout << std::setw(10) << std::setprecision(2) << flops / (ms * 1e6);
+			check(gemmIsaName(isa));
+		}
+#ifdef USE_CBLAS
+		const double blas_ms = bestMs(iterations, [&]() {
+			cblas_sgemm(CblasRowMajor, CblasNoTrans, s.trans_b ? CblasTrans : CblasNoTrans, s.M, s.N, s.K, 1.f, a.data(), s.K, b.data(), s.trans_b ? s.K : s.N, 0.f, out.data(), s.N);
+			for (int m = 0; m < s.M; m++) {
+				for (int n = 0; n < s.N; n++) out[(size_t)m * s.N + n] += bias[n];
+			}
+		});
+		std::cout << std::setw(10) << std::setprecision(2) << flops / (blas_ms * 1e6);
+		check("cblas");
+#endif
+		std::cout << " " << errors.str() << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,615 @@
+﻿#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include "graph_ir.hpp"
+
+namespace ir
+{
+	int64_t volume(const Dims& dims)
+	{
+		int64_t v = 1;
+		for (int i = 0; i < dims.nbDims; i++) v *= dims.d[i];
+		return v;
+	}
+
+	bool operator==(const Dims& a, const Dims& b)
+	{
+		if (a.nbDims != b.nbDims) return false;
+		for (int i = 0; i < a.nbDims; i++) {
+			if (a.d[i] != b.d[i]) return false;
+		}
+		return true;
+	}
+
+	std::ostream& operator<<(std::ostream& os, const Dims& dims)
+	{
+		os << "[";
+		for (int i = 0; i < dims.nbDims; i++) {
+			os << (i ? "," : "") << dims.d[i];
+		}
+		return os << "]";
+	}
+
+	const char* layerTypeName(LayerType type)
+	{
+		switch (type) {
+		case LayerType::kCONVOLUTION: return "Convolution";
+		case LayerType::kDECONVOLUTION: return "Deconvolution";
+		case LayerType::kFULLY_CONNECTED: return "FullyConnected";
+		case LayerType::kACTIVATION: return "Activation";
+		case LayerType::kPOOLING: return "Pooling";
+		case LayerType::kSCALE: return "Scale";
+		case LayerType::kSOFTMAX: return "SoftMax";
+		case LayerType::kCONCATENATION: return "Concatenation";
+		case LayerType::kELEMENTWISE: return "ElementWise";
+		case LayerType::kUNARY: return "Unary";
+		case LayerType::kPADDING: return "Padding";
+		case LayerType::kSHUFFLE: return "Shuffle";
+		case LayerType::kREDUCE: return "Reduce";
+		case LayerType::kTOPK: return "TopK";
+		case LayerType::kGATHER: return "Gather";
+		case LayerType::kMATRIX_MULTIPLY: return "MatrixMultiply";
+		case LayerType::kCONSTANT: return "Constant";
+		case LayerType::kSLICE: return "Slice";
+		case LayerType::kRESIZE: return "Resize";
+		case LayerType::kPREPROCESS: return "Preprocess";
+		case LayerType::kYOLOLAYER: return "Yololayer";
+		case LayerType::kLAYER_NORM: return "LayerNorm";
+		case LayerType::kATTENTION: return "Attention";
+		}
+		return "Unknown";
+	}
+
+	static Dims makeDims(int nbDims, int value)
+	{
+		Dims d{};
+		d.nbDims = nbDims;
+		for (int i = 0; i < nbDims; i++) d.d[i] = value;
+		return d;
+	}
+
+	// 입력이 둘 이상인 레이어의 출력 shape (numpy broadcast, 차원 수는 같아야 함)
+	static Dims broadcastDims(const Dims& a, const Dims& b)
+	{
+		assert(a.nbDims == b.nbDims);
+		Dims out = a;
+		for (int i = 0; i < a.nbDims; i++) {
+			assert(a.d[i] == b.d[i] || a.d[i] == 1 || b.d[i] == 1);
+			out.d[i] = std::max(a.d[i], b.d[i]);
+		}
+		return out;
+	}
+
+	void Layer::setInput(int index, Tensor& tensor)
+	{
+		assert(index < (int)inputs_.size());
+		inputs_[index] = &tensor;
+		update();
+	}
+
+	void Layer::update()
+	{
+		// 상수에서만 계산되는 레이어는 batch 간 공유
+		bool batched = false;
+		for (Tensor* t : inputs_) batched |= t->isBatched();
+		for (Tensor* t : outputs_) t->batched_ = batched;
+
+		const Dims in = inputs_.empty() ? Dims{} : inputs_[0]->getDimensions();
+		Dims& out = outputs_[0]->dims_;
+		switch (type_) {
+		case LayerType::kCONVOLUTION:
+		case LayerType::kDECONVOLUTION:
+		case LayerType::kPOOLING: {
+			const int nb = kernel_.nbDims;
+			// pooling 의 stride 를 지정하지 않으면 window 크기 (unet down block)
+			if (!stride_set_) stride_ = type_ == LayerType::kPOOLING ? kernel_ : makeDims(nb, 1);
+			if (dilation_.nbDims != nb) dilation_ = makeDims(nb, 1);
+			if (pre_padding_.nbDims != nb) pre_padding_ = post_padding_ = makeDims(nb, 0);
+			out = in;
+			if (type_ != LayerType::kPOOLING) out.d[in.nbDims - nb - 1] = nb_outputs_;
+			for (int i = 0; i < nb; i++) {
+				const int x = in.d[in.nbDims - nb + i];
+				const int k = dilation_.d[i] * (kernel_.d[i] - 1) + 1;
+				const int pad = pre_padding_.d[i] + post_padding_.d[i];
+				out.d[in.nbDims - nb + i] = type_ == LayerType::kDECONVOLUTION
+					? (x - 1) * stride_.d[i] + k - pad
+					: (x + pad - k) / stride_.d[i] + 1;
+			}
+			break;
+		}
+		case LayerType::kFULLY_CONNECTED:
+			// 마지막 3 차원(C,H,W)을 펼쳐서 [.., K, 1, 1]
+			assert(in.nbDims >= 3);
+			out = in;
+			out.d[in.nbDims - 3] = nb_outputs_;
+			out.d[in.nbDims - 2] = 1;
+			out.d[in.nbDims - 1] = 1;
+			break;
+		case LayerType::kACTIVATION:
+		case LayerType::kSCALE:
+		case LayerType::kSOFTMAX:
+		case LayerType::kUNARY:
+		case LayerType::kLAYER_NORM:
+		case LayerType::kATTENTION:
+			out = in;
+			break;
+		case LayerType::kCONCATENATION: {
+			out = in;
+			out.d[axis_] = 0;
+			for (Tensor* t : inputs_) {
+				assert(t->getDimensions().nbDims == in.nbDims);
+				out.d[axis_] += t->getDimensions().d[axis_];
+			}
+			break;
+		}
+		case LayerType::kELEMENTWISE:
+			out = broadcastDims(in, inputs_[1]->getDimensions());
+			break;
+		case LayerType::kPADDING:
+			out = in;
+			for (int i = 0; i < pre_padding_.nbDims; i++) {
+				out.d[in.nbDims - pre_padding_.nbDims + i] += pre_padding_.d[i] + post_padding_.d[i];
+			}
+			break;
+		case LayerType::kSHUFFLE: {
+			Dims t = in;
+			for (int i = 0; i < in.nbDims; i++) t.d[i] = in.d[first_transpose_.order[i]];
+			if (reshape_set_) {
+				Dims r = reshape_;
+				int64_t known = 1;
+				int infer = -1;
+				for (int i = 0; i < r.nbDims; i++) {
+					if (r.d[i] == 0) r.d[i] = t.d[i];
+					if (r.d[i] == -1) infer = i;
+					else known *= r.d[i];
+				}
+				if (infer >= 0) r.d[infer] = (int)(volume(t) / known);
+				assert(volume(r) == volume(t));
+				t = r;
+			}
+			out = t;
+			for (int i = 0; i < t.nbDims; i++) out.d[i] = t.d[second_transpose_.order[i]];
+			break;
+		}
+		case LayerType::kREDUCE: {
+			out.nbDims = 0;
+			for (int i = 0; i < in.nbDims; i++) {
+				if (axes_ & (1u << i)) {
+					if (keep_dims_) out.d[out.nbDims++] = 1;
+				}
+				else {
+					out.d[out.nbDims++] = in.d[i];
+				}
+			}
+			break;
+		}
+		case LayerType::kTOPK:
+			out = in;
+			for (int i = 0; i < in.nbDims; i++) {
+				if (axes_ & (1u << i)) out.d[i] = nb_outputs_;
+			}
+			outputs_[1]->dims_ = out;
+			outputs_[1]->type_ = DataType::kINT32;
+			break;
+		case LayerType::kGATHER: {
+			const Dims idx = inputs_[1]->getDimensions();
+			out.nbDims = 0;
+			for (int i = 0; i < axis_; i++) out.d[out.nbDims++] = in.d[i];
+			for (int i = 0; i < idx.nbDims; i++) out.d[out.nbDims++] = idx.d[i];
+			for (int i = axis_ + 1; i < in.nbDims; i++) out.d[out.nbDims++] = in.d[i];
+			break;
+		}
+		case LayerType::kMATRIX_MULTIPLY: {
+			const Dims b = inputs_[1]->getDimensions();
+			assert(in.nbDims == b.nbDims && in.nbDims >= 2);
+			const int nb = in.nbDims;
+			out = in;
+			for (int i = 0; i < nb - 2; i++) {
+				assert(in.d[i] == b.d[i] || in.d[i] == 1 || b.d[i] == 1);
+				out.d[i] = std::max(in.d[i], b.d[i]);
+			}
+			out.d[nb - 2] = op0_ == MatrixOperation::kTRANSPOSE ? in.d[nb - 1] : in.d[nb - 2];
+			out.d[nb - 1] = op1_ == MatrixOperation::kTRANSPOSE ? b.d[nb - 2] : b.d[nb - 1];
+			assert((op0_ == MatrixOperation::kTRANSPOSE ? in.d[nb - 2] : in.d[nb - 1]) == (op1_ == MatrixOperation::kTRANSPOSE ? b.d[nb - 1] : b.d[nb - 2]));
+			break;
+		}
+		case LayerType::kCONSTANT:
+			// out 은 addConstant 에서 설정
+			assert(volume(out) == (int64_t)constant_.size());
+			break;
+		case LayerType::kSLICE:
+			out = slice_size_;
+			break;
+		case LayerType::kRESIZE:
+			if (!resize_scales_.empty()) {
+				assert((int)resize_scales_.size() == in.nbDims);
+				out = in;
+				for (int i = 0; i < in.nbDims; i++) out.d[i] = (int)(in.d[i] * resize_scales_[i]);
+			}
+			else {
+				out = resize_dims_;
+			}
+			// graph pass 로 합쳐진 뒤쪽 padding (fuseResizePadding)
+			for (int i = 0; i < pre_padding_.nbDims; i++) {
+				out.d[out.nbDims - pre_padding_.nbDims + i] += pre_padding_.d[i] + post_padding_.d[i];
+			}
+			break;
+		case LayerType::kPREPROCESS:
+			out = Dims3(preprocess_.C, preprocess_.H, preprocess_.W);
+			break;
+		case LayerType::kYOLOLAYER:
+			out = Dims2(yololayer_.H * yololayer_.W * 3, 6);
+			break;
+		}
+	}
+
+	WeightMap loadWeights(const std::string& file)
+	{
+		std::cout << "Loading weights: " << file << std::endl;
+		WeightMap weightMap;
+		std::ifstream input(file);
+		if (!input.is_open()) {
+			std::cerr << "[ERROR] Unable to load weight file : " << file << std::endl;
+			return weightMap;
+		}
+		int32_t count;
+		input >> count;
+		while (count--) {
+			std::string name;
+			uint32_t size;
+			input >> name >> std::dec >> size;
+			std::vector<float>& val = weightMap[name];
+			val.resize(size);
+			for (uint32_t x = 0; x < size; ++x) {
+				uint32_t bits;
+				input >> std::hex >> bits;
+				memcpy(&val[x], &bits, sizeof(float));
+			}
+		}
+		return weightMap;
+	}
+
+	Tensor* Network::newTensor()
+	{
+		tensors_.emplace_back(new Tensor());
+		Tensor* t = tensors_.back().get();
+		t->id_ = (int)tensors_.size() - 1;
+		return t;
+	}
+
+	Layer* Network::addLayer(LayerType type, std::initializer_list<Tensor*> inputs, int nbOutputs)
+	{
+		layers_.emplace_back(new Layer());
+		Layer* layer = layers_.back().get();
+		layer->type_ = type;
+		layer->id_ = layer_count_;
+		layer->inputs_.assign(inputs.begin(), inputs.end());
+		std::ostringstream name;
+		name << "(Unnamed Layer* " << layer_count_++ << ") [" << layerTypeName(type) << "]";
+		layer->name_ = name.str();
+		for (int i = 0; i < nbOutputs; i++) {
+			Tensor* t = newTensor();
+			t->producer_ = layer;
+			t->name_ = layer->name_ + (nbOutputs > 1 ? "_output_" + std::to_string(i) : "_output");
+			layer->outputs_.push_back(t);
+		}
+		return layer;
+	}
+
+	Tensor* Network::addInput(const char* name, DataType type, Dims dims)
+	{
+		Tensor* t = newTensor();
+		t->name_ = name;
+		t->name_set_ = true;
+		t->type_ = type;
+		t->dims_ = dims;
+		inputs_.push_back(t);
+		return t;
+	}
+
+	void Network::markOutput(Tensor& tensor)
+	{
+		tensor.output_ = true;
+		outputs_.push_back(&tensor);
+	}
+
+	Layer* Network::addConvolutionNd(Tensor& input, int nbOutputMaps, Dims kernelSize, const std::vector<float>& kernelWeights, const std::vector<float>& biasWeights)
+	{
+		Layer* l = addLayer(LayerType::kCONVOLUTION, { &input }, 1);
+		l->nb_outputs_ = nbOutputMaps;
+		l->kernel_ = kernelSize;
+		l->kernel_weights_ = kernelWeights;
+		l->bias_weights_ = biasWeights;
+		l->update();
+		return l;
+	}
+
+	Layer* Network::addDeconvolutionNd(Tensor& input, int nbOutputMaps, Dims kernelSize, const std::vector<float>& kernelWeights, const std::vector<float>& biasWeights)
+	{
+		Layer* l = addLayer(LayerType::kDECONVOLUTION, { &input }, 1);
+		l->nb_outputs_ = nbOutputMaps;
+		l->kernel_ = kernelSize;
+		l->kernel_weights_ = kernelWeights;
+		l->bias_weights_ = biasWeights;
+		l->update();
+		return l;
+	}
+
+	Layer* Network::addFullyConnected(Tensor& input, int nbOutputs, const std::vector<float>& kernelWeights, const std::vector<float>& biasWeights)
+	{
+		Layer* l = addLayer(LayerType::kFULLY_CONNECTED, { &input }, 1);
+		l->nb_outputs_ = nbOutputs;
+		l->kernel_weights_ = kernelWeights;
+		l->bias_weights_ = biasWeights;
+		l->update();
+		return l;
+	}
+
+	Layer* Network::addActivation(Tensor& input, ActivationType type)
+	{
+		Layer* l = addLayer(LayerType::kACTIVATION, { &input }, 1);
+		l->activation_ = type;
+		l->update();
+		return l;
+	}
+
+	Layer* Network::addPoolingNd(Tensor& input, PoolingType type, Dims windowSize)
+	{
+		Layer* l = addLayer(LayerType::kPOOLING, { &input }, 1);
+		l->pooling_type_ = type;
+		l->kernel_ = windowSize;
+		l->update();
+		return l;
+	}
+
+	Layer* Network::addScale(Tensor& input, ScaleMode mode, const std::vector<float>& shift, const std::vector<float>& scale, const std::vector<float>& power)
+	{
+		return addScaleNd(input, mode, shift, scale, power, 0);
+	}
+
+	Layer* Network::addScaleNd(Tensor& input, ScaleMode mode, const std::vector<float>& shift, const std::vector<float>& scale, const std::vector<float>& power, int channelAxis)
+	{
+		Layer* l = addLayer(LayerType::kSCALE, { &input }, 1);
+		l->scale_mode_ = mode;
+		l->shift_ = shift;
+		l->scale_ = scale;
+		l->power_ = power;
+		l->channel_axis_ = channelAxis;
+		l->update();
+		return l;
+	}
+
+	Layer* Network::addSoftMax(Tensor& input)
+	{
+		Layer* l = addLayer(LayerType::kSOFTMAX, { &input }, 1);
+		const int nb = input.getDimensions().nbDims;
+		l->axes_ = 1u << (nb >= 3 ? nb - 3 : 0);
+		l->update();
+		return l;
+	}
+
+	Layer* Network::addConcatenation(Tensor* const* inputs, int nbInputs)
+	{
+		Layer* l = addLayer(LayerType::kCONCATENATION, {}, 1);
+		l->inputs_.assign(inputs, inputs + nbInputs);
+		const int nb = inputs[0]->getDimensions().nbDims;
+		l->axis_ = nb >= 3 ? nb - 3 : 0;
+		l->update();
+		return l;
+	}
+
+	Layer* Network::addElementWise(Tensor& input1, Tensor& input2, ElementWiseOperation op)
+	{
+		Layer* l = addLayer(LayerType::kELEMENTWISE, { &input1, &input2 }, 1);
+		l->elementwise_op_ = op;
+		l->update();
+		return l;
+	}
+
+	Layer* Network::addUnary(Tensor& input, UnaryOperation operation)
+	{
+		Layer* l = addLayer(LayerType::kUNARY, { &input }, 1);
+		l->unary_op_ = operation;
+		l->update();
+		return l;
+	}
+
+	Layer* Network::addPaddingNd(Tensor& input, Dims prePadding, Dims postPadding)
+	{
+		Layer* l = addLayer(LayerType::kPADDING, { &input }, 1);
+		l->pre_padding_ = prePadding;
+		l->post_padding_ = postPadding;
+		l->update();
+		return l;
+	}
+
+	Layer* Network::addShuffle(Tensor& input)
+	{
+		Layer* l = addLayer(LayerType::kSHUFFLE, { &input }, 1);
+		l->update();
+		return l;
+	}
+
+	Layer* Network::addReduce(Tensor& input, ReduceOperation operation, uint32_t reduceAxes, bool keepDimensions)
+	{
+		Layer* l = addLayer(LayerType::kREDUCE, { &input }, 1);
+		l->reduce_op_ = operation;
+		l->axes_ = reduceAxes;
+		l->keep_dims_ = keepDimensions;
+		l->update();
+		return l;
+	}
+
+	Layer* Network::addTopK(Tensor& input, TopKOperation op, int k, uint32_t reduceAxes)
+	{
+		Layer* l = addLayer(LayerType::kTOPK, { &input }, 2);
+		l->topk_op_ = op;
+		l->nb_outputs_ = k;
+		l->axes_ = reduceAxes;
+		l->update();
+		return l;
+	}
+
+	Layer* Network::addGather(Tensor& data, Tensor& indices, int axis)
+	{
+		Layer* l = addLayer(LayerType::kGATHER, { &data, &indices }, 1);
+		l->axis_ = axis;
+		l->update();
+		return l;
+	}
+
+	Layer* Network::addMatrixMultiply(Tensor& input0, MatrixOperation op0, Tensor& input1, MatrixOperation op1)
+	{
+		Layer* l = addLayer(LayerType::kMATRIX_MULTIPLY, { &input0, &input1 }, 1);
+		l->op0_ = op0;
+		l->op1_ = op1;
+		l->update();
+		return l;
+	}
+
+	Layer* Network::addConstant(Dims dimensions, const std::vector<float>& weights)
+	{
+		Layer* l = addLayer(LayerType::kCONSTANT, {}, 1);
+		l->constant_ = weights;
+		l->outputs_[0]->dims_ = dimensions;
+		l->update();
+		return l;
+	}
+
+	Layer* Network::addSlice(Tensor& input, Dims start, Dims size, Dims stride)
+	{
+		Layer* l = addLayer(LayerType::kSLICE, { &input }, 1);
+		l->slice_start_ = start;
+		l->slice_size_ = size;
+		l->slice_stride_ = stride;
+		l->update();
+		return l;
+	}
+
+	Layer* Network::addResize(Tensor& input)
+	{
+		Layer* l = addLayer(LayerType::kRESIZE, { &input }, 1);
+		l->resize_dims_ = input.getDimensions();
+		l->update();
+		return l;
+	}
+
+	Layer* Network::addPreprocess(Tensor& input, const PreprocessParam& param)
+	{
+		Layer* l = addLayer(LayerType::kPREPROCESS, { &input }, 1);
+		l->preprocess_ = param;
+		l->update();
+		return l;
+	}
+
+	Layer* Network::addYololayer(Tensor& input, Tensor& anchor_grid, const YololayerParam& param)
+	{
+		Layer* l = addLayer(LayerType::kYOLOLAYER, { &input, &anchor_grid }, 1);
+		l->yololayer_ = param;
+		l->update();
+		return l;
+	}
+
+	Layer* Network::addLayerNorm(Tensor& input, uint32_t axes, float epsilon, const std::vector<float>& shift, const std::vector<float>& scale, int channelAxis)
+	{
+		Layer* l = addLayer(LayerType::kLAYER_NORM, { &input }, 1);
+		l->axes_ = axes;
+		l->epsilon_ = epsilon;
+		l->shift_ = shift;
+		l->scale_ = scale;
+		l->channel_axis_ = channelAxis;
+		l->update();
+		return l;
+	}
+
+	Layer* Network::addAttention(Tensor& query, Tensor& key, Tensor& value, int numHeads, float scale)
+	{
+		Layer* l = addLayer(LayerType::kATTENTION, { &query, &key, &value }, 1);
+		l->num_heads_ = numHeads;
+		l->attention_scale_ = scale;
+		l->update();
+		return l;
+	}
+
+	Tensor* Network::findTensor(const std::string& name) const
+	{
+		for (const auto& t : tensors_) {
+			if (name == t->getName()) return t.get();
+		}
+		return nullptr;
+	}
+
+	void Network::removeLayer(Layer* layer)
+	{
+		for (Tensor* t : layer->outputs_) {
+			assert(!t->isNetworkOutput());
+			t->producer_ = nullptr;
+		}
+		std::set<Tensor*> dead(layer->outputs_.begin(), layer->outputs_.end());
+		layers_.erase(std::remove_if(layers_.begin(), layers_.end(), [&](const std::unique_ptr<Layer>& l) { return l.get() == layer; }), layers_.end());
+		tensors_.erase(std::remove_if(tensors_.begin(), tensors_.end(), [&](const std::unique_ptr<Tensor>& t) { return dead.count(t.get()) > 0; }), tensors_.end());
+		for (int i = 0; i < (int)tensors_.size(); i++) tensors_[i]->id_ = i;
+	}
+
+	void Network::replaceAllUses(Tensor* from, Tensor* to)
+	{
+		for (auto& l : layers_) {
+			for (auto& t : l->inputs_) {
+				if (t == from) t = to;
+			}
+		}
+		for (auto& t : outputs_) {
+			if (t == from) {
+				t = to;
+				from->output_ = false;
+				to->output_ = true;
+			}
+		}
+	}
+
+	void Network::topologicalSort()
+	{
+		std::set<const Tensor*> ready(inputs_.begin(), inputs_.end());
+		std::vector<std::unique_ptr<Layer>> sorted;
+		std::vector<bool> done(layers_.size(), false);
+		while (sorted.size() < layers_.size()) {
+			const size_t before = sorted.size();
+			for (size_t i = 0; i < layers_.size(); i++) {
+				if (done[i]) continue;
+				bool ok = true;
+				for (Tensor* t : layers_[i]->inputs_) ok &= ready.count(t) > 0;
+				if (!ok) continue;
+				done[i] = true;
+				for (Tensor* t : layers_[i]->outputs_) ready.insert(t);
+				sorted.push_back(std::move(layers_[i]));
+			}
+			if (sorted.size() == before) {
+				std::cerr << "[ERROR] graph has a cycle or a dangling input" << std::endl;
+				assert(false);
+				break;
+			}
+		}
+		layers_ = std::move(sorted);
+		for (auto& l : layers_) l->update();
+	}
+
+	void Network::printSummary(std::ostream& os) const
+	{
+		std::map<std::string, int> counts;
+		int64_t params = 0;
+		for (const auto& l : layers_) {
+			counts[layerTypeName(l->getType())]++;
+			params += l->kernel_weights_.size() + l->bias_weights_.size() + l->shift_.size() + l->scale_.size() + l->power_.size() + l->constant_.size();
+		}
+		os << "layers : " << layers_.size() << ", tensors : " << tensors_.size() << ", parameters : " << params << std::endl;
+		for (const auto& c : counts) {
+			os << "  " << c.first << " : " << c.second << std::endl;
+		}
+		for (const Tensor* t : inputs_) os << "  input  " << t->getName() << " " << t->getDimensions() << std::endl;
+		for (const Tensor* t : outputs_) os << "  output " << t->getName() << " " << t->getDimensions() << std::endl;
+	}
+}
@@ -0,0 +1,312 @@
+﻿#pragma once
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// 모델 그래프 IR
+// INetworkDefinition 의 builder 호출(addConvolutionNd, addScale ...)을 그대로 기록하는 network 표현.
+// TensorRT 와 같은 implicit batch 규칙 사용 (모든 Dims 는 batch 차원 제외, 상수는 batch 간 공유)
+// 기록된 그래프는 CPU interpreter 로 실행하거나 TensorRT network 로 다시 변환(ir_trt.hpp) 가능
+namespace ir
+{
+	static const int kMAX_DIMS = 8;
+
+	struct Dims {
+		int nbDims;
+		int d[kMAX_DIMS];
+	};
+
+	class Dims2 : public Dims {
+	public:
+		Dims2(int d0, int d1) { nbDims = 2; d[0] = d0; d[1] = d1; }
+	};
+	class DimsHW : public Dims2 {
+	public:
+		DimsHW(int h, int w) : Dims2(h, w) {}
+	};
+	class Dims3 : public Dims {
+	public:
+		Dims3(int d0, int d1, int d2) { nbDims = 3; d[0] = d0; d[1] = d1; d[2] = d2; }
+	};
+	class Dims4 : public Dims {
+	public:
+		Dims4(int d0, int d1, int d2, int d3) { nbDims = 4; d[0] = d0; d[1] = d1; d[2] = d2; d[3] = d3; }
+	};
+
+	struct Permutation {
+		int order[kMAX_DIMS];
+	};
+
+	int64_t volume(const Dims& dims);
+	bool operator==(const Dims& a, const Dims& b);
+	inline bool operator!=(const Dims& a, const Dims& b) { return !(a == b); }
+	std::ostream& operator<<(std::ostream& os, const Dims& dims);
+
+	// enum 값 순서는 nvinfer1 과 동일 (ir_trt.cpp 에서 그대로 변환)
+	enum class DataType { kFLOAT, kHALF, kINT8, kINT32 };
+	enum class ActivationType {
+		kRELU, kSIGMOID, kTANH, kLEAKY_RELU, kELU, kSELU, kSOFTSIGN, kSOFTPLUS, kCLIP,
+		kSILU = 100,	// IR 전용 x * sigmoid(x) (graph pass 에서 생성, TensorRT 변환시 sigmoid + prod)
+	};
+	enum class ElementWiseOperation { kSUM, kPROD, kMAX, kMIN, kSUB, kDIV, kPOW };
+	enum class PoolingType { kMAX, kAVERAGE };
+	enum class ScaleMode { kUNIFORM, kCHANNEL, kELEMENTWISE };
+	enum class ResizeMode { kNEAREST, kLINEAR };
+	enum class ReduceOperation { kSUM, kPROD, kMAX, kMIN, kAVG };
+	enum class UnaryOperation { kEXP, kLOG, kSQRT, kRECIP, kABS, kNEG, kSIN, kCOS };
+	enum class TopKOperation { kMAX, kMIN };
+	enum class MatrixOperation { kNONE, kTRANSPOSE };
+
+	enum class LayerType {
+		kCONVOLUTION, kDECONVOLUTION, kFULLY_CONNECTED, kACTIVATION, kPOOLING, kSCALE, kSOFTMAX,
+		kCONCATENATION, kELEMENTWISE, kUNARY, kPADDING, kSHUFFLE, kREDUCE, kTOPK, kGATHER,
+		kMATRIX_MULTIPLY, kCONSTANT, kSLICE, kRESIZE,
+		kPREPROCESS,	// preprocess plugin (preprocess.hpp)
+		kYOLOLAYER,		// yololayer plugin (yololayer.hpp)
+		kLAYER_NORM,	// IR 전용 (graph pass 에서 생성, TensorRT 변환시 reduce, elementwise ... 로 분해)
+		kATTENTION,		// IR 전용 multi-head attention (graph pass 에서 생성, TensorRT 변환시 shuffle, matmul, softmax 로 분해)
+	};
+	const char* layerTypeName(LayerType type);
+
+	// preprocess plugin 파라미터 (::Preprocess 와 동일)
+	struct PreprocessParam {
+		int N;
+		int C;
+		int H;
+		int W;
+		int preproc_type;	// 0 : BGR->RGB, /255, 1 : 0 + mean/std 정규화
+		float mean[3];
+		float std[3];
+	};
+
+	// yololayer plugin 파라미터 (::Yololayer 와 동일)
+	struct YololayerParam {
+		int C;			// anchor 수 (3)
+		int H;
+		int W;
+		int CLASS_NUM;
+		int Grid_stride;
+	};
+
+	class Layer;
+
+	class Tensor
+	{
+	public:
+		const char* getName() const { return name_.c_str(); }
+		void setName(const char* name) { name_ = name; name_set_ = true; }
+		Dims getDimensions() const { return dims_; }
+		DataType getType() const { return type_; }
+
+		Layer* producer() const { return producer_; }	// network 입력이면 nullptr
+		bool isNetworkInput() const { return producer_ == nullptr; }
+		bool isNetworkOutput() const { return output_; }
+		bool hasUserName() const { return name_set_; }
+		bool isBatched() const { return batched_; }		// false : 상수에서만 계산된 텐서 (batch 간 공유)
+		int id() const { return id_; }
+
+		// INT8 양자화 범위 (calibration table, ITensor::setDynamicRange 와 같은 의미, 대칭 범위만 사용)
+		bool setDynamicRange(float min, float max) { if (min > max) return false; range_min_ = min; range_max_ = max; range_set_ = true; return true; }
+		bool dynamicRangeIsSet() const { return range_set_; }
+		float getDynamicRangeMin() const { return range_min_; }
+		float getDynamicRangeMax() const { return range_max_; }
+
+	private:
+		friend class Network;
+		friend class Layer;
+		std::string name_;
+		bool name_set_ = false;
+		Dims dims_;
+		DataType type_ = DataType::kFLOAT;
+		Layer* producer_ = nullptr;
+		bool output_ = false;
+		bool batched_ = true;
+		int id_ = 0;
+		bool range_set_ = false;
+		float range_min_ = 0.f, range_max_ = 0.f;
+	};
+
+	//! \class Layer
+	//!
+	//! \brief 모든 레이어 종류의 파라미터를 담는 단일 레이어 표현.
+	//!  TensorRT 레이어 인터페이스와 같은 이름의 setter 제공, setter 호출시 출력 shape 재계산
+	//!
+	class Layer
+	{
+	public:
+		LayerType getType() const { return type_; }
+		const char* getName() const { return name_.c_str(); }
+		void setName(const char* name) { name_ = name; name_set_ = true; }
+		bool hasUserName() const { return name_set_; }
+		int getNbInputs() const { return (int)inputs_.size(); }
+		int getNbOutputs() const { return (int)outputs_.size(); }
+		Tensor* getInput(int index) const { return inputs_[index]; }
+		Tensor* getOutput(int index) const { return outputs_[index]; }
+		void setInput(int index, Tensor& tensor);
+		int id() const { return id_; }
+
+		// convolution, deconvolution, pooling
+		void setStrideNd(Dims stride) { stride_ = stride; stride_set_ = true; update(); }
+		void setPaddingNd(Dims padding) { pre_padding_ = post_padding_ = padding; update(); }
+		void setDilationNd(Dims dilation) { dilation_ = dilation; update(); }
+		void setNbGroups(int groups) { groups_ = groups; update(); }
+		Dims getStrideNd() const { return stride_; }
+		Dims getPaddingNd() const { return pre_padding_; }
+		Dims getDilationNd() const { return dilation_; }
+		int getNbGroups() const { return groups_; }
+		void setAverageCountExcludesPadding(bool exclusive) { average_count_excludes_padding_ = exclusive; }
+
+		// shuffle
+		void setFirstTranspose(Permutation permutation) { first_transpose_ = permutation; update(); }
+		void setReshapeDimensions(Dims dims) { reshape_ = dims; reshape_set_ = true; update(); }
+		void setSecondTranspose(Permutation permutation) { second_transpose_ = permutation; update(); }
+
+		// resize
+		void setResizeMode(ResizeMode mode) { resize_mode_ = mode; }
+		void setOutputDimensions(Dims dims) { resize_dims_ = dims; resize_scales_.clear(); update(); }
+		void setScales(const float* scales, int nbScales) { resize_scales_.assign(scales, scales + nbScales); update(); }
+		void setAlignCorners(bool align) { align_corners_ = align; }
+
+		// activation
+		void setAlpha(float alpha) { alpha_ = alpha; }
+		void setBeta(float beta) { beta_ = beta; }
+
+		// concatenation, gather / softmax, reduce, topk
+		void setAxis(int axis) { axis_ = axis; update(); }
+		void setAxes(uint32_t axes) { axes_ = axes; update(); }
+
+		// 파라미터 (interpreter, lowering, graph pass 에서 직접 사용)
+		int nb_outputs_ = 0;						// conv 출력 채널, fc 출력 수, topk k
+		Dims kernel_{};								// conv, deconv, pool window
+		Dims stride_{};
+		Dims pre_padding_{};
+		Dims post_padding_{};
+		Dims dilation_{};
+		int groups_ = 1;
+		bool stride_set_ = false;
+		std::vector<float> kernel_weights_;			// conv, deconv, fc
+		std::vector<float> bias_weights_;
+		ActivationType activation_ = ActivationType::kRELU;
+		float alpha_ = 0.f;
+		float beta_ = 0.f;
+		ElementWiseOperation elementwise_op_ = ElementWiseOperation::kSUM;
+		PoolingType pooling_type_ = PoolingType::kMAX;
+		bool average_count_excludes_padding_ = true;
+		ScaleMode scale_mode_ = ScaleMode::kUNIFORM;
+		int channel_axis_ = 0;
+		std::vector<float> shift_, scale_, power_;	// scale (비어 있으면 0, 1, 1)
+		int axis_ = 0;								// concat, gather
+		uint32_t axes_ = 0;							// softmax, reduce, topk (bit mask)
+		bool keep_dims_ = false;
+		ReduceOperation reduce_op_ = ReduceOperation::kSUM;
+		TopKOperation topk_op_ = TopKOperation::kMAX;
+		UnaryOperation unary_op_ = UnaryOperation::kEXP;
+		Permutation first_transpose_{ { 0, 1, 2, 3, 4, 5, 6, 7 } };
+		Permutation second_transpose_{ { 0, 1, 2, 3, 4, 5, 6, 7 } };
+		Dims reshape_{};
+		bool reshape_set_ = false;
+		ResizeMode resize_mode_ = ResizeMode::kNEAREST;
+		Dims resize_dims_{};
+		std::vector<float> resize_scales_;
+		bool align_corners_ = false;
+		Dims slice_start_{}, slice_size_{}, slice_stride_{};
+		MatrixOperation op0_ = MatrixOperation::kNONE, op1_ = MatrixOperation::kNONE;
+		std::vector<float> constant_;				// constant 값
+		PreprocessParam preprocess_{};
+		YololayerParam yololayer_{};
+		bool fused_activation_ = false;				// conv, deconv, fc, scale, elementwise 출력에 activation_ 적용 (graph pass)
+		float epsilon_ = 0.f;						// layer norm
+		int num_heads_ = 1;							// attention
+		float attention_scale_ = 1.f;				// attention (query 에 곱하는 값)
+
+		// 입력 shape 으로부터 출력 shape 재계산
+		void update();
+
+	private:
+		friend class Network;
+		LayerType type_;
+		std::string name_;
+		bool name_set_ = false;
+		std::vector<Tensor*> inputs_;
+		std::vector<Tensor*> outputs_;
+		int id_ = 0;
+	};
+
+	using WeightMap = std::map<std::string, std::vector<float>>;
+
+	// .wts 파일 로드 (각 모델 예제의 loadWeights 와 같은 형식)
+	WeightMap loadWeights(const std::string& file);
+
+	//! \class Network
+	//!
+	//! \brief INetworkDefinition 과 같은 이름의 add 함수로 레이어를 기록.
+	//!  weights 는 레이어가 복사해서 보관 (weightMap 해제와 무관)
+	//!
+	class Network
+	{
+	public:
+		Tensor* addInput(const char* name, DataType type, Dims dims);
+		void markOutput(Tensor& tensor);
+
+		Layer* addConvolutionNd(Tensor& input, int nbOutputMaps, Dims kernelSize, const std::vector<float>& kernelWeights, const std::vector<float>& biasWeights);
+		Layer* addDeconvolutionNd(Tensor& input, int nbOutputMaps, Dims kernelSize, const std::vector<float>& kernelWeights, const std::vector<float>& biasWeights);
+		Layer* addFullyConnected(Tensor& input, int nbOutputs, const std::vector<float>& kernelWeights, const std::vector<float>& biasWeights);
+		Layer* addActivation(Tensor& input, ActivationType type);
+		Layer* addPoolingNd(Tensor& input, PoolingType type, Dims windowSize);
+		Layer* addScale(Tensor& input, ScaleMode mode, const std::vector<float>& shift, const std::vector<float>& scale, const std::vector<float>& power);
+		Layer* addScaleNd(Tensor& input, ScaleMode mode, const std::vector<float>& shift, const std::vector<float>& scale, const std::vector<float>& power, int channelAxis);
+		Layer* addSoftMax(Tensor& input);
+		Layer* addConcatenation(Tensor* const* inputs, int nbInputs);
+		Layer* addElementWise(Tensor& input1, Tensor& input2, ElementWiseOperation op);
+		Layer* addUnary(Tensor& input, UnaryOperation operation);
+		Layer* addPaddingNd(Tensor& input, Dims prePadding, Dims postPadding);
+		Layer* addShuffle(Tensor& input);
+		Layer* addReduce(Tensor& input, ReduceOperation operation, uint32_t reduceAxes, bool keepDimensions);
+		Layer* addTopK(Tensor& input, TopKOperation op, int k, uint32_t reduceAxes);
+		Layer* addGather(Tensor& data, Tensor& indices, int axis);
+		Layer* addMatrixMultiply(Tensor& input0, MatrixOperation op0, Tensor& input1, MatrixOperation op1);
+		Layer* addConstant(Dims dimensions, const std::vector<float>& weights);
+		Layer* addSlice(Tensor& input, Dims start, Dims size, Dims stride);
+		Layer* addResize(Tensor& input);
+		// plugin (TensorRT 에서는 addPluginV2 로 추가되는 레이어)
+		Layer* addPreprocess(Tensor& input, const PreprocessParam& param);
+		Layer* addYololayer(Tensor& input, Tensor& anchor_grid, const YololayerParam& param);
+		// IR 전용 : axes 로 정규화 후 channelAxis 기준 scale, shift (비어 있으면 생략)
+		Layer* addLayerNorm(Tensor& input, uint32_t axes, float epsilon, const std::vector<float>& shift, const std::vector<float>& scale, int channelAxis);
+		// IR 전용 : query [Lq, E, 1, 1], key, value [Lk, E, 1, 1] -> softmax(scale * Q_h K_h^T) V_h 를 head 순서로 이어붙인 [Lq, E, 1, 1]
+		Layer* addAttention(Tensor& query, Tensor& key, Tensor& value, int numHeads, float scale);
+
+		int getNbLayers() const { return (int)layers_.size(); }
+		Layer* getLayer(int index) const { return layers_[index].get(); }
+		int getNbInputs() const { return (int)inputs_.size(); }
+		Tensor* getInput(int index) const { return inputs_[index]; }
+		int getNbOutputs() const { return (int)outputs_.size(); }
+		Tensor* getOutput(int index) const { return outputs_[index]; }
+		int getNbTensors() const { return (int)tensors_.size(); }
+		Tensor* getTensor(int index) const { return tensors_[index].get(); }
+		Tensor* findTensor(const std::string& name) const;
+
+		// graph pass 용 : 레이어 삭제 (출력 텐서를 사용하는 레이어가 없어야 함), tensor 사용처 일괄 변경
+		void removeLayer(Layer* layer);
+		void replaceAllUses(Tensor* from, Tensor* to);
+		// 레이어를 위상 순서로 정렬하고 모든 shape 재계산
+		void topologicalSort();
+
+		// 레이어 수, 종류별 개수, 파라미터 수 출력
+		void printSummary(std::ostream& os) const;
+
+	private:
+		Layer* addLayer(LayerType type, std::initializer_list<Tensor*> inputs, int nbOutputs);
+		Tensor* newTensor();
+
+		std::vector<std::unique_ptr<Layer>> layers_;
+		std::vector<std::unique_ptr<Tensor>> tensors_;
+		std::vector<Tensor*> inputs_;
+		std::vector<Tensor*> outputs_;
+		int layer_count_ = 0;	// 기본 레이어 이름 번호 (TensorRT 의 "(Unnamed Layer* N)" 과 같은 순서)
+		int tensor_count_ = 0;
+	};
+}
@@ -0,0 +1,445 @@
+﻿#include <iomanip>
+#include <map>
+#include "graph_passes.hpp"
+#include "cpu_interpreter.hpp"
+
+namespace ir
+{
+	typedef std::map<const Tensor*, std::vector<Layer*>> UserMap;
+
+	static UserMap findUsers(const Network& network)
+	{
+		UserMap users;
+		for (int i = 0; i < network.getNbLayers(); i++) {
+			Layer* l = network.getLayer(i);
+			for (int k = 0; k < l->getNbInputs(); k++) users[l->getInput(k)].push_back(l);
+		}
+		return users;
+	}
+
+	// t 를 사용하는 레이어가 하나뿐이고 network 출력이 아니면 그 레이어, 아니면 nullptr
+	static Layer* onlyUser(const UserMap& users, const Tensor* t)
+	{
+		if (t->isNetworkOutput()) return nullptr;
+		auto it = users.find(t);
+		return (it != users.end() && it->second.size() == 1) ? it->second[0] : nullptr;
+	}
+
+	static bool isUsed(const UserMap& users, const Tensor* t)
+	{
+		return t->isNetworkOutput() || users.count(t) > 0;
+	}
+
+	// from 의 사용처를 to 로 변경 (사용자가 지정한 이름은 유지)
+	static void replaceTensor(Network& network, Tensor* from, Tensor* to)
+	{
+		if (from->hasUserName() && !to->hasUserName()) to->setName(from->getName());
+		// 합쳐진 레이어의 출력은 마지막 레이어 출력 값이므로 그 양자화 범위를 이어받음
+		if (from->dynamicRangeIsSet()) to->setDynamicRange(from->getDynamicRangeMin(), from->getDynamicRangeMax());
+		network.replaceAllUses(from, to);
+	}
+
+	static bool allEqual(const std::vector<float>& v, float value)
+	{
+		for (float x : v) {
+			if (x != value) return false;
+		}
+		return true;
+	}
+
+	// scale 레이어의 power 가 모두 1 (선형 변환)
+	static bool isLinearScale(const Layer* l)
+	{
+		return l->getType() == LayerType::kSCALE && !l->fused_activation_ && allEqual(l->power_, 1.f);
+	}
+
+	int foldConstants(Network& network)
+	{
+		// 상수 부분 그래프의 경계 텐서 (batch 텐서를 계산하는 레이어나 출력에서 사용)만 교체, 나머지는 dead layer 로 삭제
+		const UserMap users = findUsers(network);
+		std::vector<Tensor*> targets;
+		for (int i = 0; i < network.getNbLayers(); i++) {
+			const Layer* l = network.getLayer(i);
+			if (l->getType() == LayerType::kCONSTANT || l->getOutput(0)->isBatched()) continue;
+			for (int k = 0; k < l->getNbOutputs(); k++) {
+				Tensor* t = l->getOutput(k);
+				if (t->getType() != DataType::kFLOAT) continue;
+				bool boundary = t->isNetworkOutput();
+				auto it = users.find(t);
+				if (it != users.end()) {
+					for (const Layer* u : it->second) boundary |= u->getOutput(0)->isBatched();
+				}
+				if (boundary) targets.push_back(t);
+			}
+		}
+		if (targets.empty()) return 0;
+
+		std::vector<std::vector<float>> values;
+		{
+			CpuInterpreter interpreter(network, 1);
+			interpreter.evaluateConstants();
+			for (const Tensor* t : targets) {
+				const float* p = interpreter.getTensor(t);
+				values.emplace_back(p, p + volume(t->getDimensions()));
+			}
+		}
+		for (size_t i = 0; i < targets.size(); i++) {
+			Layer* c = network.addConstant(targets[i]->getDimensions(), values[i]);
+			replaceTensor(network, targets[i], c->getOutput(0));
+		}
+		network.topologicalSort();
+		return (int)targets.size();
+	}
+
+	int eliminateDeadLayers(Network& network)
+	{
+		int removed = 0;
+		for (bool changed = true; changed;) {
+			changed = false;
+			const UserMap users = findUsers(network);
+			std::vector<Layer*> dead;
+			for (int i = 0; i < network.getNbLayers(); i++) {
+				Layer* l = network.getLayer(i);
+				bool used = false;
+				for (int k = 0; k < l->getNbOutputs(); k++) used |= isUsed(users, l->getOutput(k));
+				if (!used) dead.push_back(l);
+			}
+			for (Layer* l : dead) network.removeLayer(l);
+			removed += (int)dead.size();
+			changed = !dead.empty();
+		}
+		return removed;
+	}
+
+	static bool fuseConvBatchNormOnce(Network& network, const UserMap& users)
+	{
+		for (int i = 0; i < network.getNbLayers(); i++) {
+			Layer* s = network.getLayer(i);
+			if (!isLinearScale(s) || s->scale_mode_ == ScaleMode::kELEMENTWISE) continue;
+			Tensor* t = s->getInput(0);
+			Layer* conv = t->producer();
+			if (!conv || conv->getType() != LayerType::kCONVOLUTION || conv->fused_activation_ || onlyUser(users, t) != s) continue;
+			if (s->scale_mode_ == ScaleMode::kCHANNEL && s->channel_axis_ != t->getDimensions().nbDims - 3) continue;
+
+			// w' = w * scale, b' = b * scale + shift
+			const int K = conv->nb_outputs_;
+			const size_t per_k = conv->kernel_weights_.size() / K;
+			if (conv->bias_weights_.empty()) conv->bias_weights_.assign(K, 0.f);
+			for (int k = 0; k < K; k++) {
+				const int c = s->scale_mode_ == ScaleMode::kCHANNEL ? k : 0;
+				const float sc = s->scale_.empty() ? 1.f : s->scale_[c];
+				const float sh = s->shift_.empty() ? 0.f : s->shift_[c];
+				for (size_t j = 0; j < per_k; j++) conv->kernel_weights_[k * per_k + j] *= sc;
+				conv->bias_weights_[k] = conv->bias_weights_[k] * sc + sh;
+			}
+			replaceTensor(network, s->getOutput(0), t);
+			network.removeLayer(s);
+			return true;
+		}
+		return false;
+	}
+
+	static bool fuseSiluOnce(Network& network, const UserMap& users)
+	{
+		for (int i = 0; i < network.getNbLayers(); i++) {
+			Layer* prod = network.getLayer(i);
+			if (prod->getType() != LayerType::kELEMENTWISE || prod->elementwise_op_ != ElementWiseOperation::kPROD || prod->fused_activation_) continue;
+			for (int k = 0; k < 2; k++) {
+				Tensor* x = prod->getInput(k);
+				Tensor* sig_out = prod->getInput(1 - k);
+				Layer* sig = sig_out->producer();
+				if (!sig || sig->getType() != LayerType::kACTIVATION || sig->activation_ != ActivationType::kSIGMOID) continue;
+				if (sig->getInput(0) != x || onlyUser(users, sig_out) != prod || x->getDimensions() != prod->getOutput(0)->getDimensions()) continue;
+
+				sig->activation_ = ActivationType::kSILU;
+				replaceTensor(network, prod->getOutput(0), sig_out);
+				network.removeLayer(prod);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	static bool isElementWise(const Layer* l, ElementWiseOperation op)
+	{
+		return l && l->getType() == LayerType::kELEMENTWISE && l->elementwise_op_ == op && !l->fused_activation_;
+	}
+
+	static bool isReduceAvg(const Layer* l, uint32_t axes)
+	{
+		return l && l->getType() == LayerType::kREDUCE && l->reduce_op_ == ReduceOperation::kAVG && l->axes_ == axes && l->keep_dims_;
+	}
+
+	// 정규화 축은 연속 구간이어야 함 (interpreter 의 layerNorm 커널)
+	static bool contiguousAxes(uint32_t axes)
+	{
+		if (!axes) return false;
+		while (!(axes & 1u)) axes >>= 1;
+		return (axes & (axes + 1u)) == 0;
+	}
+
+	static bool fuseLayerNormOnce(Network& network, const UserMap& users)
+	{
+		for (int i = 0; i < network.getNbLayers(); i++) {
+			Layer* mean = network.getLayer(i);
+			if (mean->getType() != LayerType::kREDUCE) continue;
+			const uint32_t axes = mean->axes_;
+			if (!contiguousAxes(axes) || !isReduceAvg(mean, axes)) continue;
+			Tensor* x = mean->getInput(0);
+
+			// sub = x - mean(x)
+			Layer* sub = onlyUser(users, mean->getOutput(0));
+			if (!isElementWise(sub, ElementWiseOperation::kSUB) || sub->getInput(0) != x) continue;
+			// sub 사용처 : pow2, div
+			auto it = users.find(sub->getOutput(0));
+			if (sub->getOutput(0)->isNetworkOutput() || it == users.end() || it->second.size() != 2) continue;
+			Layer* pow2 = nullptr;
+			Layer* div = nullptr;
+			for (Layer* u : it->second) {
+				if (u->getType() == LayerType::kSCALE && !u->fused_activation_ && u->scale_mode_ == ScaleMode::kUNIFORM
+					&& allEqual(u->shift_, 0.f) && allEqual(u->scale_, 1.f) && u->power_.size() == 1 && u->power_[0] == 2.f) pow2 = u;
+				else if (isElementWise(u, ElementWiseOperation::kDIV) && u->getInput(0) == sub->getOutput(0)) div = u;
+			}
+			if (!pow2 || !div) continue;
+			// var = mean(sub^2), sqrt(var + eps)
+			Layer* var = onlyUser(users, pow2->getOutput(0));
+			if (!isReduceAvg(var, axes)) continue;
+			Layer* add_eps = onlyUser(users, var->getOutput(0));
+			if (!isElementWise(add_eps, ElementWiseOperation::kSUM)) continue;
+			const Tensor* eps_t = add_eps->getInput(0) == var->getOutput(0) ? add_eps->getInput(1) : add_eps->getInput(0);
+			const Layer* eps = eps_t->producer();
+			if (!eps || eps->getType() != LayerType::kCONSTANT || eps->constant_.size() != 1) continue;
+			Layer* sqrt = onlyUser(users, add_eps->getOutput(0));
+			if (!sqrt || sqrt->getType() != LayerType::kUNARY || sqrt->unary_op_ != UnaryOperation::kSQRT) continue;
+			if (onlyUser(users, sqrt->getOutput(0)) != div || div->getInput(1) != sqrt->getOutput(0)) continue;
+			// 뒤따르는 channel scale 은 affine 으로 합침
+			Layer* affine = onlyUser(users, div->getOutput(0));
+			if (affine && (!isLinearScale(affine) || affine->scale_mode_ != ScaleMode::kCHANNEL)) affine = nullptr;
+
+			Layer* ln = affine
+				? network.addLayerNorm(*x, axes, eps->constant_[0], affine->shift_, affine->scale_, affine->channel_axis_)
+				: network.addLayerNorm(*x, axes, eps->constant_[0], {}, {}, 0);
+			Layer* last = affine ? affine : div;
+			replaceTensor(network, last->getOutput(0), ln->getOutput(0));
+			if (affine) network.removeLayer(affine);
+			network.removeLayer(div);
+			network.removeLayer(sqrt);
+			network.removeLayer(add_eps);
+			network.removeLayer(var);
+			network.removeLayer(pow2);
+			network.removeLayer(sub);
+			network.removeLayer(mean);
+			return true;
+		}
+		return false;
+	}
+
+	static bool isPermutation(const Permutation& perm, std::initializer_list<int> order)
+	{
+		int i = 0;
+		for (int o : order) {
+			if (perm.order[i++] != o) return false;
+		}
+		return true;
+	}
+
+	// [L, E, 1, 1] -> reshape [L, H, D] -> transpose [H, L, D] (DETR MultiHeadAttention 의 head 분리), head 수 반환 (아니면 0)
+	static int headSplit(const Layer* l)
+	{
+		if (!l || l->getType() != LayerType::kSHUFFLE) return 0;
+		const Dims in = l->getInput(0)->getDimensions(), out = l->getOutput(0)->getDimensions();
+		if (in.nbDims != 4 || in.d[2] != 1 || in.d[3] != 1 || out.nbDims != 3) return 0;
+		if (!isPermutation(l->first_transpose_, { 0, 1, 2, 3 }) || !isPermutation(l->second_transpose_, { 1, 0, 2 })) return 0;
+		return (out.d[1] == in.d[0] && out.d[0] * out.d[2] == in.d[1]) ? out.d[0] : 0;
+	}
+
+	// [H, L, D] -> transpose [L, H, D] -> reshape [L, H * D, 1, 1] (head 합치기)
+	static bool isHeadMerge(const Layer* l)
+	{
+		if (!l || l->getType() != LayerType::kSHUFFLE) return false;
+		const Dims in = l->getInput(0)->getDimensions(), out = l->getOutput(0)->getDimensions();
+		if (in.nbDims != 3 || out.nbDims != 4 || !isPermutation(l->first_transpose_, { 1, 0, 2 }) || !isPermutation(l->second_transpose_, { 0, 1, 2, 3 })) return false;
+		return out.d[0] == in.d[1] && out.d[1] == in.d[0] * in.d[2] && out.d[2] == 1 && out.d[3] == 1;
+	}
+
+	// elementwise 의 입력 중 값 하나짜리 constant 의 index (없으면 -1)
+	static int scalarConstantInput(const Layer* l)
+	{
+		for (int k = 0; k < 2; k++) {
+			const Layer* c = l->getInput(k)->producer();
+			if (c && c->getType() == LayerType::kCONSTANT && c->constant_.size() == 1) return k;
+		}
+		return -1;
+	}
+
+	// 상수 접기로 이미 head 분리된 query 상수 [H, L, D] (첫 decoder 레이어의 cross-attention)
+	static bool isSplitConstant(const Layer* l, int heads)
+	{
+		if (!l || l->getType() != LayerType::kCONSTANT) return false;
+		const Dims d = l->getOutput(0)->getDimensions();
+		return d.nbDims == 3 && d.d[0] == heads;
+	}
+
+	static bool fuseAttentionOnce(Network& network, const UserMap& users)
+	{
+		for (int i = 0; i < network.getNbLayers(); i++) {
+			Layer* qk = network.getLayer(i);
+			if (qk->getType() != LayerType::kMATRIX_MULTIPLY || qk->op0_ != MatrixOperation::kNONE || qk->op1_ != MatrixOperation::kTRANSPOSE) continue;
+			Layer* q_split = qk->getInput(0)->producer();
+			Layer* k_split = qk->getInput(1)->producer();
+			const int heads = headSplit(k_split);
+			if (!heads || (headSplit(q_split) != heads && !isSplitConstant(q_split, heads))) continue;
+			if (onlyUser(users, q_split->getOutput(0)) != qk || onlyUser(users, k_split->getOutput(0)) != qk) continue;
+			// softmax(q k^T) v
+			Layer* softmax = onlyUser(users, qk->getOutput(0));
+			if (!softmax || softmax->getType() != LayerType::kSOFTMAX || softmax->axes_ != 1u << 2) continue;
+			Layer* av = onlyUser(users, softmax->getOutput(0));
+			if (!av || av->getType() != LayerType::kMATRIX_MULTIPLY || av->op0_ != MatrixOperation::kNONE || av->op1_ != MatrixOperation::kNONE
+				|| av->getInput(0) != softmax->getOutput(0)) continue;
+			Layer* v_split = av->getInput(1)->producer();
+			if (headSplit(v_split) != heads || onlyUser(users, v_split->getOutput(0)) != av) continue;
+			Layer* merge = onlyUser(users, av->getOutput(0));
+			if (!isHeadMerge(merge)) continue;
+			Tensor* k = k_split->getInput(0);
+			Tensor* v = v_split->getInput(0);
+			if (k->getDimensions() != v->getDimensions()) continue;
+
+			Tensor* q;
+			Layer* q_scale = nullptr;
+			float scale = 1.f;
+			if (q_split->getType() == LayerType::kCONSTANT) {
+				// [H, L, D] -> [L, H * D, 1, 1] 상수로 되돌림
+				const Dims d = q_split->getOutput(0)->getDimensions();
+				std::vector<float> merged(q_split->constant_.size());
+				for (int h = 0; h < d.d[0]; h++)
+					for (int l = 0; l < d.d[1]; l++)
+						for (int x = 0; x < d.d[2]; x++)
+							merged[((size_t)l * d.d[0] + h) * d.d[2] + x] = q_split->constant_[((size_t)h * d.d[1] + l) * d.d[2] + x];
+				q = network.addConstant(Dims4(d.d[1], d.d[0] * d.d[2], 1, 1), merged)->getOutput(0);
+			}
+			else {
+				// query 에 곱한 scalar 상수는 kernel 의 scale 로
+				q = q_split->getInput(0);
+				q_scale = q->producer();
+				const int c = isElementWise(q_scale, ElementWiseOperation::kPROD) && onlyUser(users, q) == q_split ? scalarConstantInput(q_scale) : -1;
+				if (c >= 0 && q_scale->getInput(1 - c)->getDimensions() == q->getDimensions()) {
+					scale = q_scale->getInput(c)->producer()->constant_[0];
+					q = q_scale->getInput(1 - c);
+				}
+				else q_scale = nullptr;
+			}
+
+			Layer* attn = network.addAttention(*q, *k, *v, heads, scale);
+			replaceTensor(network, merge->getOutput(0), attn->getOutput(0));
+			network.removeLayer(merge);
+			network.removeLayer(av);
+			network.removeLayer(v_split);
+			network.removeLayer(softmax);
+			network.removeLayer(qk);
+			network.removeLayer(k_split);
+			network.removeLayer(q_split);
+			if (q_scale) network.removeLayer(q_scale);
+			return true;
+		}
+		return false;
+	}
+
+	static bool fuseActivationOnce(Network& network, const UserMap& users)
+	{
+		for (int i = 0; i < network.getNbLayers(); i++) {
+			Layer* act = network.getLayer(i);
+			if (act->getType() != LayerType::kACTIVATION) continue;
+			Tensor* t = act->getInput(0);
+			Layer* p = t->producer();
+			if (!p || p->fused_activation_ || onlyUser(users, t) != act) continue;
+			const LayerType type = p->getType();
+			if (type != LayerType::kCONVOLUTION && type != LayerType::kDECONVOLUTION && type != LayerType::kFULLY_CONNECTED
+				&& type != LayerType::kSCALE && type != LayerType::kELEMENTWISE) continue;
+
+			p->fused_activation_ = true;
+			p->activation_ = act->activation_;
+			p->alpha_ = act->alpha_;
+			p->beta_ = act->beta_;
+			replaceTensor(network, act->getOutput(0), t);
+			network.removeLayer(act);
+			return true;
+		}
+		return false;
+	}
+
+	static bool fuseResizePaddingOnce(Network& network, const UserMap& users)
+	{
+		for (int i = 0; i < network.getNbLayers(); i++) {
+			Layer* pad = network.getLayer(i);
+			if (pad->getType() != LayerType::kPADDING || pad->pre_padding_.nbDims != 2) continue;
+			Tensor* t = pad->getInput(0);
+			Layer* resize = t->producer();
+			if (!resize || resize->getType() != LayerType::kRESIZE || resize->pre_padding_.nbDims != 0 || onlyUser(users, t) != pad) continue;
+			bool negative = false;
+			for (int k = 0; k < 2; k++) negative |= pad->pre_padding_.d[k] < 0 || pad->post_padding_.d[k] < 0;
+			if (negative) continue;
+
+			resize->pre_padding_ = pad->pre_padding_;
+			resize->post_padding_ = pad->post_padding_;
+			resize->update();
+			replaceTensor(network, pad->getOutput(0), t);
+			network.removeLayer(pad);
+			return true;
+		}
+		return false;
+	}
+
+	// 한 번에 하나씩 바꾸고 사용처를 다시 계산 (바뀐 그래프에서 다음 패턴 검색)
+	static int repeat(Network& network, bool(*once)(Network&, const UserMap&))
+	{
+		int count = 0;
+		while (once(network, findUsers(network))) count++;
+		return count;
+	}
+
+	int fuseConvBatchNorm(Network& network) { return repeat(network, fuseConvBatchNormOnce); }
+	int fuseSilu(Network& network) { return repeat(network, fuseSiluOnce); }
+	int fuseActivation(Network& network) { return repeat(network, fuseActivationOnce); }
+	int fuseResizePadding(Network& network) { return repeat(network, fuseResizePaddingOnce); }
+
+	int fuseLayerNorm(Network& network)
+	{
+		const int count = repeat(network, fuseLayerNormOnce);
+		if (count) network.topologicalSort();
+		return count;
+	}
+
+	int fuseAttention(Network& network)
+	{
+		const int count = repeat(network, fuseAttentionOnce);
+		if (count) network.topologicalSort();
+		return count;
+	}
+
+	std::vector<PassStats> optimizeNetwork(Network& network, std::ostream* log)
+	{
+		typedef int(*Pass)(Network&);
+		static const std::pair<const char*, Pass> passes[] = {
+			{ "constant folding", foldConstants },
+			{ "dead layer elimination", eliminateDeadLayers },
+			{ "conv + batchnorm", fuseConvBatchNorm },
+			{ "silu", fuseSilu },
+			{ "layer norm", fuseLayerNorm },
+			{ "attention", fuseAttention },
+			{ "conv/fc/scale + activation", fuseActivation },
+			{ "resize + padding", fuseResizePadding },
+			{ "dead layer elimination", eliminateDeadLayers },
+		};
+		std::vector<PassStats> stats;
+		for (const auto& pass : passes) {
+			const int before = network.getNbLayers();
+			const int rewrites = pass.second(network);
+			stats.push_back({ pass.first, rewrites, before, network.getNbLayers() });
+			if (log) {
+				*log << "  " << std::left << std::setw(28) << pass.first << std::right << " : " << std::setw(4) << rewrites
+					<< " rewrites, layers " << before << " -> " << network.getNbLayers() << std::endl;
+			}
+		}
+		return stats;
+	}
+}
@@ -0,0 +1,37 @@
+﻿#pragma once
+#include <ostream>
+#include <string>
+#include <vector>
+#include "graph_ir.hpp"
+
+// ir::Network 최적화 pass (각 함수는 변경한 패턴 수 반환)
+// 합쳐진 레이어는 IR 전용 표현(fused_activation_, kSILU, kLAYER_NORM, kATTENTION)이 되고 TensorRT 변환시 다시 분해
+namespace ir
+{
+	// 상수에서만 계산되는 부분 그래프를 CPU 에서 미리 계산해 constant 레이어로 교체 (DETR position embedding 등)
+	int foldConstants(Network& network);
+	// 출력이 사용되지 않는 레이어 삭제
+	int eliminateDeadLayers(Network& network);
+	// conv -> scale(BN) 을 conv 가중치, bias 로 합침
+	int fuseConvBatchNorm(Network& network);
+	// x * sigmoid(x) (elementwise prod + sigmoid) -> SiLU activation
+	int fuseSilu(Network& network);
+	// reduce, sub, pow, reduce, add eps, sqrt, div, scale -> layer norm
+	int fuseLayerNorm(Network& network);
+	// head 분리 shuffle, (query scale), matmul, softmax, matmul, head 합치기 shuffle -> attention
+	int fuseAttention(Network& network);
+	// conv, deconv, fc, scale, elementwise 다음의 activation 을 앞 레이어 출력 단계에서 적용
+	int fuseActivation(Network& network);
+	// resize 다음의 0 이상 padding (UNet up()) 을 resize 출력 단계에서 적용 (pre_padding_, post_padding_)
+	int fuseResizePadding(Network& network);
+
+	struct PassStats {
+		std::string name;
+		int rewrites;
+		int layers_before;
+		int layers_after;
+	};
+
+	// 전체 pass 순서대로 실행, log 가 있으면 pass 별 결과 출력
+	std::vector<PassStats> optimizeNetwork(Network& network, std::ostream* log = nullptr);
+}
@@ -0,0 +1,214 @@
+﻿// INT8 CPU 실행과 fp32 실행의 결과 일치율, 속도 비교
+// usage : int8_eval <resnet18|yolov5s|...> [options]
+//   -c <file>        TensorRT calibration table (기본 ../Int8_calib_table/<model>_int8_calib.table)
+//   -i <files>       uint8 HWC BGR raw 입력 파일 목록 (쉼표 구분, 없으면 난수 이미지)
+//   -k <count>       난수 이미지 수 (기본 8)
+//   -n <iterations>  속도 측정 반복 횟수 (기본 5)
+//   -t <threads>     OpenMP thread 수
+//   -r               .wts 에 없는 가중치를 난수로 생성 (가중치 파일 없이 실행)
+// 분류 모델은 fp32 top-1 과 INT8 top-1 / top-5 일치율, yolov5s 는 fp32 검출을 정답으로 한 INT8 검출의 mAP@0.5
+// calibration table 이 없으면 입력 이미지들의 fp32 실행 최대 절대값을 dynamic range 로 사용 (경고 출력)
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include "calib_table.hpp"
+#include "cpu_interpreter.hpp"
+#include "detection_eval.hpp"
+#include "graph_passes.hpp"
+#include "ir_models.hpp"
+
+static double measure(CpuInterpreter& interpreter, int iterations)
+{
+	interpreter.run(1);	// warm up
+	auto t0 = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < iterations; i++) interpreter.run(1);
+	auto t1 = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration<double, std::milli>(t1 - t0).count() / iterations;
+}
+
+/* ------ 분류 ------ */
+
+static std::vector<int> topK(const std::vector<float>& scores, int k)
+{
+	std::vector<int> order(scores.size());
+	for (int i = 0; i < (int)order.size(); i++) order[i] = i;
+	k = std::min(k, (int)order.size());
+	std::partial_sort(order.begin(), order.begin() + k, order.end(), [&](int a, int b) { return scores[a] > scores[b]; });
+	order.resize(k);
+	return order;
+}
+
+/* ------ 검출 (yolov5s.cpp 의 nms 와 같은 기준) ------ */
+
+// prob [count, 6] (x, y, w, h, conf, class) -> class 별 NMS
+static std::vector<Detection> detections(const float* prob, int count, float confThresh = 0.25f, float nmsThresh = 0.45f)
+{
+	std::vector<Detection> candidates, result;
+	for (int i = 0; i < count; i++) {
+		const float* r = prob + i * 6;
+		if (r[4] <= confThresh) continue;
+		candidates.push_back(Detection{ { r[0], r[1], r[2], r[3] }, r[4], (int)r[5] });
+	}
+	std::stable_sort(candidates.begin(), candidates.end(), [](const Detection& a, const Detection& b) { return a.conf > b.conf; });
+	std::vector<bool> removed(candidates.size(), false);
+	for (size_t i = 0; i < candidates.size(); i++) {
+		if (removed[i]) continue;
+		result.push_back(candidates[i]);
+		for (size_t j = i + 1; j < candidates.size(); j++) {
+			if (candidates[j].class_id == candidates[i].class_id && iou(candidates[i].bbox, candidates[j].bbox) > nmsThresh) removed[j] = true;
+		}
+	}
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2) {
+		std::cerr << "usage : int8_eval <resnet18|yolov5s|vgg11|unet|detr> [-c table] [-i a.raw,b.raw] [-k images] [-n iterations] [-t threads] [-r]" << std::endl;
+		return 1;
+	}
+	const ir::ModelConfig* config = ir::findModel(argv[1]);
+	if (!config) {
+		std::cerr << "[ERROR] unknown model : " << argv[1] << std::endl;
+		return 1;
+	}
+	std::string table = std::string("../Int8_calib_table/") + config->name + "_int8_calib.table";
+	std::vector<std::string> input_files;
+	int images = 8, iterations = 5, threads = 0;
+	bool random_missing = false;
+	for (int i = 2; i < argc; i++) {
+		if (!strcmp(argv[i], "-c") && i + 1 < argc) table = argv[++i];
+		else if (!strcmp(argv[i], "-i") && i + 1 < argc) {
+			std::stringstream ss(argv[++i]);
+			std::string item;
+			while (std::getline(ss, item, ',')) input_files.push_back(item);
+		}
+		else if (!strcmp(argv[i], "-k") && i + 1 < argc) images = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-n") && i + 1 < argc) iterations = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-t") && i + 1 < argc) threads = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-r")) random_missing = true;
+	}
+
+	// 1. 가중치 로드, network 기록, calibration table 적용 (이름이 원래 network 기준이므로 graph pass 이전)
+	ir::WeightMap weightMap;
+	std::ifstream wts(config->weight_file);
+	if (wts.good()) {
+		wts.close();
+		weightMap = ir::loadWeights(config->weight_file);
+	}
+	else if (!random_missing) {
+		std::cerr << "[ERROR] weight file not found : " << config->weight_file << " (use -r for random weights)" << std::endl;
+		return 1;
+	}
+	ir::WeightSource weights(weightMap, random_missing);
+	ir::Network network;
+	if (!ir::buildModel(config->name, network, weights, 1)) return 1;
+	std::map<std::string, float> scales;
+	bool calibrated = false;
+	if (std::ifstream(table).good() && readCalibrationTable(table, scales)) {
+		std::cout << "calibration table " << table << " : " << applyCalibrationTable(network, scales) << " / " << scales.size() << " tensors" << std::endl;
+		calibrated = true;
+	}
+	ir::optimizeNetwork(network, nullptr);
+
+	// 2. 입력
+	if (!input_files.empty()) images = (int)input_files.size();
+	const size_t input_size = (size_t)config->input_h * config->input_w * config->input_c;
+	std::vector<std::vector<uint8_t>> inputs(images, std::vector<uint8_t>(input_size));
+	std::mt19937 rng(0);
+	for (int i = 0; i < images; i++) {
+		if (!input_files.empty()) {
+			if (!readFile(input_files[i], inputs[i].data(), input_size)) return 1;
+		}
+		else {
+			for (auto& v : inputs[i]) v = (uint8_t)(rng() & 255);
+		}
+	}
+
+	// 3. fp32 실행 (table 이 없으면 텐서별 최대 절대값 수집)
+	const ir::Tensor* output = network.getOutput(0);
+	const size_t output_count = (size_t)ir::volume(output->getDimensions());
+	std::vector<std::vector<float>> fp32_out(images), int8_out(images);
+	std::vector<float> amax(network.getNbTensors(), 0.f);
+	CpuInterpreter fp32(network, 1, threads);
+	for (int i = 0; i < images; i++) {
+		fp32.setInput(config->input_name, inputs[i].data());
+		fp32.run(1);
+		fp32_out[i].assign(fp32.getTensor(output), fp32.getTensor(output) + output_count);
+		if (calibrated) continue;
+		for (int t = 0; t < network.getNbTensors(); t++) {
+			const ir::Tensor* tensor = network.getTensor(t);
+			if (!tensor->isBatched()) continue;
+			const float* v = fp32.getTensor(tensor);
+			const int64_t count = ir::volume(tensor->getDimensions());
+			for (int64_t k = 0; k < count; k++) amax[t] = std::max(amax[t], std::fabs(v[k]));
+		}
+	}
+	if (!calibrated) {
+		std::cerr << "[WARNING] calibration table not found : " << table << ", using max abs ranges of " << images << " fp32 runs" << std::endl;
+		for (int t = 0; t < network.getNbTensors(); t++) {
+			if (amax[t] > 0.f) network.getTensor(t)->setDynamicRange(-amax[t], amax[t]);
+		}
+	}
+
+	// 4. INT8 실행
+	CpuInterpreter int8(network, 1, threads, CpuPrecision::kINT8);
+	for (int i = 0; i < images; i++) {
+		int8.setInput(config->input_name, inputs[i].data());
+		int8.run(1);
+		int8_out[i].assign(int8.getTensor(output), int8.getTensor(output) + output_count);
+	}
+
+	// 5. 속도 (첫번째 입력)
+	fp32.setInput(config->input_name, inputs[0].data());
+	int8.setInput(config->input_name, inputs[0].data());
+	const double fp32_ms = measure(fp32, iterations);
+	const double int8_ms = measure(int8, iterations);
+
+	// 6. 정확도
+	double min_cosine = 1.0, max_abs = 0.0;
+	for (int i = 0; i < images; i++) {
+		const TensorDiff d = diffTensors(int8_out[i].data(), fp32_out[i].data(), output_count);
+		min_cosine = std::min(min_cosine, d.cosine);
+		max_abs = std::max(max_abs, d.max_abs);
+	}
+	bool detector = false;
+	for (int i = 0; i < network.getNbLayers(); i++) detector |= network.getLayer(i)->getType() == ir::LayerType::kYOLOLAYER;
+
+	std::cout << "[" << config->name << "] " << images << " images, int8 layers " << int8.int8LayerCount() << " (" << int8IsaName(int8Isa()) << ")" << std::endl;
+	std::cout << std::fixed << std::setprecision(2) << "latency  fp32 " << fp32_ms << " ms, int8 " << int8_ms << " ms, speedup " << fp32_ms / int8_ms << "x" << std::endl;
+	std::cout << std::setprecision(5) << "output   min cosine " << min_cosine << ", max abs diff " << max_abs << std::endl;
+	if (detector) {
+		std::vector<std::vector<Detection>> truth(images), pred(images);
+		size_t truth_total = 0, pred_total = 0;
+		for (int i = 0; i < images; i++) {
+			truth[i] = detections(fp32_out[i].data(), (int)(output_count / 6));
+			pred[i] = detections(int8_out[i].data(), (int)(output_count / 6));
+			truth_total += truth[i].size();
+			pred_total += pred[i].size();
+		}
+		const double map = meanAveragePrecision(truth, pred);
+		std::cout << "detect   fp32 " << truth_total << ", int8 " << pred_total << " boxes, mAP@0.5 agreement ";
+		if (map < 0.0) std::cout << "n/a (no fp32 detections)" << std::endl;
+		else std::cout << std::setprecision(2) << map * 100.0 << " %" << std::endl;
+	}
+	else {
+		int top1 = 0, top5 = 0;
+		for (int i = 0; i < images; i++) {
+			const int truth = topK(fp32_out[i], 1)[0];
+			const std::vector<int> pred = topK(int8_out[i], 5);
+			top1 += pred[0] == truth;
+			top5 += std::find(pred.begin(), pred.end(), truth) != pred.end();
+		}
+		std::cout << std::setprecision(2) << "classify top-1 agreement " << 100.0 * top1 / images << " %, fp32 top-1 in int8 top-5 " << 100.0 * top5 / images << " %" << std::endl;
+	}
+	return 0;
+}
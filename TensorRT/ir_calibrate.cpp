@@ -0,0 +1,213 @@
+﻿// TensorRT 없이 CPU interpreter 로 calibration table 생성 (builder 의 Int8EntropyCalibrator2 대신 오프라인으로)
+// usage : ir_calibrate <yolov5s|resnet18|vgg11|unet|detr> [options]
+//   -d <dir|list>    calibration 이미지 폴더 (기본 ../Data_calib/) 또는 calib_select 가 만든 목록 파일 (.txt)
+//   -raw             폴더의 파일을 입력 크기 uint8 HWC BGR raw 로 읽음 (OpenCV 디코딩 없이)
+//   -a <entropy|percentile|max|all>  scale 결정 방식 (기본 all : 모두 저장하고 비교)
+//   -p <percentile>  percentile 방식의 기준 (기본 99.99)
+//   -o <file>        table 경로 (기본 ../Int8_calib_table/<model>_int8_calib_cpu.table, all 이면 .table 앞에 _<방식>)
+//   -v <version>     table 첫 줄의 TensorRT 버전 (기본 8003, 빌드할 TensorRT 의 getInferLibVersion 과 다르면 TensorRT 가 table 을 무시)
+//   -n <images>      사용할 최대 이미지 수 (기본 전체)
+//   -b <batch>       interpreter batch 크기 (기본 1)
+//   -w <workers>     동시에 실행하는 interpreter 수 (기본 hardware thread 수 / -t)
+//   -t <threads>     interpreter 당 OpenMP thread 수 (기본 1)
+//   -k <images>      앞 k 장으로 INT8 CPU 실행 결과를 fp32 와 비교 (기본 4, 0 이면 비교 안함)
+//   -r               .wts 에 없는 가중치를 난수로 생성 (가중치 파일 없이 실행)
+// 전처리는 모델 예제의 Int8EntropyCalibrator2 와 같은 process_type (ModelConfig::calib_process)
+// 텐서 이름은 TensorRT network 와 같음 (graph pass 전 network)
+// 모든 방식의 table 첫 줄은 예제 calibrator 와 같은 "TRT-<version>-EntropyCalibration2" (방식은 파일 이름으로만 구분)
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "calib_loader.hpp"
+#include "calib_preprocess.hpp"
+#include "calib_table.hpp"
+#include "common.hpp"
+#include "cpu_calibrator.hpp"
+#include "cpu_interpreter.hpp"
+#include "graph_passes.hpp"
+#include "ir_models.hpp"
+
+struct EvalResult {
+	int tensors;		// table 에서 network 에 적용한 텐서 수
+	int int8_layers;
+	double min_cosine;
+	double max_abs;
+};
+
+// table 을 다시 읽어서 (저장한 형식 확인) graph pass 전 network 에 적용하고 INT8 CPU 실행을 fp32 출력과 비교
+static EvalResult evaluate(const ir::ModelConfig& config, ir::WeightSource& weights, const std::string& table,
+	const std::vector<std::vector<uint8_t>>& images, const std::vector<std::vector<float>>& reference, int threads)
+{
+	EvalResult r{ 0, 0, 1.0, 0.0 };
+	std::map<std::string, float> scales;
+	ir::Network network;
+	if (!readCalibrationTable(table, scales) || !ir::buildModel(config.name, network, weights, 1)) return r;
+	r.tensors = applyCalibrationTable(network, scales);
+	ir::optimizeNetwork(network, nullptr);
+	CpuInterpreter int8(network, 1, threads, CpuPrecision::kINT8);
+	r.int8_layers = int8.int8LayerCount();
+	const ir::Tensor* output = network.getOutput(0);
+	for (size_t i = 0; i < images.size(); i++) {
+		int8.setInput(config.input_name, images[i].data());
+		int8.run(1);
+		const TensorDiff d = diffTensors(int8.getTensor(output), reference[i].data(), reference[i].size());
+		r.min_cosine = std::min(r.min_cosine, d.cosine);
+		r.max_abs = std::max(r.max_abs, d.max_abs);
+	}
+	return r;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2) {
+		std::cerr << "usage : ir_calibrate <yolov5s|resnet18|vgg11|unet|detr> [-d dir] [-raw] [-a entropy|percentile|max|all] [-p percentile] [-o table] [-v version] [-n images] [-b batch] [-w workers] [-t threads] [-k images] [-r]" << std::endl;
+		return 1;
+	}
+	const ir::ModelConfig* config = ir::findModel(argv[1]);
+	if (!config) {
+		std::cerr << "[ERROR] unknown model : " << argv[1] << std::endl;
+		return 1;
+	}
+	std::string dir = "../Data_calib/", algorithm = "all", version = "8003";
+	std::string table = std::string("../Int8_calib_table/") + config->name + "_int8_calib_cpu.table";
+	double percentile = 99.99;
+	int max_images = 0, batch = 1, workers = 0, threads = 1, eval_images = 4;
+	bool raw = false, random_missing = false;
+	for (int i = 2; i < argc; i++) {
+		if (!strcmp(argv[i], "-d") && i + 1 < argc) dir = argv[++i];
+		else if (!strcmp(argv[i], "-raw")) raw = true;
+		else if (!strcmp(argv[i], "-a") && i + 1 < argc) algorithm = argv[++i];
+		else if (!strcmp(argv[i], "-p") && i + 1 < argc) percentile = atof(argv[++i]);
+		else if (!strcmp(argv[i], "-o") && i + 1 < argc) table = argv[++i];
+		else if (!strcmp(argv[i], "-v") && i + 1 < argc) version = argv[++i];
+		else if (!strcmp(argv[i], "-n") && i + 1 < argc) max_images = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-b") && i + 1 < argc) batch = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-w") && i + 1 < argc) workers = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-t") && i + 1 < argc) threads = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-k") && i + 1 < argc) eval_images = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-r")) random_missing = true;
+	}
+	if (!isCalibList(dir) && dir.back() != '/' && dir.back() != '\\') dir += '/';
+	threads = std::max(1, threads);
+	if (workers <= 0) workers = std::max(1, (int)std::thread::hardware_concurrency() / threads);
+
+	std::vector<CalibAlgorithm> algorithms;
+	for (CalibAlgorithm a : { CalibAlgorithm::kENTROPY, CalibAlgorithm::kPERCENTILE, CalibAlgorithm::kMAX }) {
+		if (algorithm == "all" || algorithm == calibAlgorithmName(a)) algorithms.push_back(a);
+	}
+	if (algorithms.empty()) {
+		std::cerr << "[ERROR] unknown algorithm : " << algorithm << std::endl;
+		return 1;
+	}
+
+	// 1. 가중치 로드, network 기록 (graph pass 없이 TensorRT 와 같은 텐서 이름)
+	ir::WeightMap weightMap;
+	std::ifstream wts(config->weight_file);
+	if (wts.good()) {
+		wts.close();
+		weightMap = ir::loadWeights(config->weight_file);
+	}
+	else if (!random_missing) {
+		std::cerr << "[ERROR] weight file not found : " << config->weight_file << " (use -r for random weights)" << std::endl;
+		return 1;
+	}
+	ir::WeightSource weights(weightMap, random_missing);
+	ir::Network network;
+	if (!ir::buildModel(config->name, network, weights, batch)) return 1;
+
+	// 2. calibration 이미지
+	std::vector<std::string> names, files;
+	if (isCalibList(dir)) {
+		if (!readCalibList(dir, files)) return 1;
+	}
+	else {
+		if (read_files_in_dir(dir.c_str(), names) != 0) return 1;
+		std::sort(names.begin(), names.end());
+		for (const std::string& name : names) files.push_back(dir + name);
+	}
+	if (max_images > 0 && (int)files.size() > max_images) files.resize(max_images);
+	std::unique_ptr<CalibPreprocess> preprocess;
+	if (raw) preprocess.reset(new RawPreprocess(config->input_w, config->input_h));
+	else preprocess = makeCalibPreprocess(config->calib_process, config->input_w, config->input_h);
+	if (files.size() < (size_t)batch) {
+		std::cerr << "[ERROR] not enough calibration images in " << dir << " : " << files.size() << std::endl;
+		return 1;
+	}
+
+	// 3. histogram 수집
+	std::cout << "[" << config->name << "] " << files.size() << " images, batch " << batch << ", " << preprocess->name() << " "
+		<< config->input_w << "x" << config->input_h << ", " << workers << " workers x " << threads << " threads" << std::endl;
+	CpuCalibrator calibrator(network, workers, threads);
+	{
+		CalibBatchLoader loader(files, batch, *preprocess);
+		if (!calibrator.collect(loader, config->input_name)) return 1;
+	}
+	const CpuCalibratorStats& stats = calibrator.stats();
+	std::cout << std::fixed << std::setprecision(1) << "  collect " << stats.images << " images : " << stats.wall_ms << " ms ("
+		<< stats.images * 1000.0 / std::max(stats.wall_ms, 1e-9) << " img/s), worker wait " << stats.wait_ms << " ms, run " << stats.run_ms
+		<< " ms, merge " << stats.merge_ms << " ms" << std::endl;
+
+	// 4. 비교용 fp32 출력 (앞 k 장)
+	std::vector<std::vector<uint8_t>> images;
+	std::vector<std::vector<float>> reference;
+	if (eval_images > 0) {
+		ir::Network fp32_network;
+		if (!ir::buildModel(config->name, fp32_network, weights, 1)) return 1;
+		ir::optimizeNetwork(fp32_network, nullptr);
+		CpuInterpreter fp32(fp32_network, 1, 0);
+		const ir::Tensor* output = fp32_network.getOutput(0);
+		const size_t output_count = (size_t)ir::volume(output->getDimensions());
+		for (int i = 0; i < eval_images && i < (int)files.size(); i++) {
+			images.emplace_back(preprocess->imageBytes());
+			if (!preprocess->load(files[i], images.back().data())) return 1;
+			fp32.setInput(config->input_name, images.back().data());
+			fp32.run(1);
+			reference.emplace_back(fp32.getTensor(output), fp32.getTensor(output) + output_count);
+		}
+	}
+
+	// 5. 방식별 scale 계산, table 저장, 비교
+	std::cout << "  " << std::left << std::setw(12) << "algorithm" << std::right << std::setw(9) << "tensors" << std::setw(12) << "scale ms"
+		<< std::setw(14) << "amax / max";
+	if (!images.empty()) std::cout << std::setw(9) << "applied" << std::setw(12) << "int8 layers" << std::setw(12) << "min cosine" << std::setw(12) << "max abs";
+	std::cout << "  table" << std::endl;
+	for (CalibAlgorithm a : algorithms) {
+		auto t0 = std::chrono::high_resolution_clock::now();
+		const std::vector<std::pair<std::string, float>> scales = calibrator.scales(a, percentile);
+		const double scale_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+		// 잘라낸 정도 : 텐서별 amax / 최대 절대값 평균
+		double ratio = 0.0;
+		int counted = 0;
+		for (int i = 0; i < network.getNbTensors(); i++) {
+			const ActivationHistogram* h = calibrator.histogram(network.getTensor(i));
+			if (!h || h->maxAbs() <= 0.f) continue;
+			ratio += h->amax(a, percentile) / h->maxAbs();
+			counted++;
+		}
+		std::string path = table;
+		if (algorithms.size() > 1) {
+			const size_t ext = path.rfind(".table");
+			path.insert(ext == std::string::npos ? path.size() : ext, std::string("_") + calibAlgorithmName(a));
+		}
+		if (!writeCalibrationTable(path, "TRT-" + version + "-" + kCALIB_TABLE_ALGORITHM, scales)) return 1;
+		std::cout << "  " << std::left << std::setw(12) << calibAlgorithmName(a) << std::right << std::setw(9) << scales.size()
+			<< std::setprecision(1) << std::setw(12) << scale_ms << std::setprecision(4) << std::setw(14) << (counted ? ratio / counted : 0.0);
+		if (!images.empty()) {
+			const EvalResult r = evaluate(*config, weights, path, images, reference, threads * workers);
+			std::cout << std::setw(9) << r.tensors << std::setw(12) << r.int8_layers << std::setprecision(5) << std::setw(12) << r.min_cosine
+				<< std::setprecision(4) << std::setw(12) << r.max_abs;
+		}
+		std::cout << "  " << path << std::endl;
+	}
+	return 0;
+}
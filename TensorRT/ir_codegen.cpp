@@ -0,0 +1,428 @@
+﻿// 고정 shape 모델의 ahead-of-time C++ 코드 생성
+// usage : ir_codegen <resnet18|yolov5s|vgg11|unet> [options]
+//   -o <dir>         출력 폴더 (기본 .)
+//   -n <iterations>  interpreter 기준 속도 측정 반복 횟수 (기본 5)
+//   -t <threads>     OpenMP thread 수
+//   -r               .wts 에 없는 가중치를 난수로 생성 (가중치 파일 없이 실행)
+// graph pass 를 적용한 network 를 레이어마다 aot_kernels.hpp 의 template 호출 하나로 옮긴 <model>_aot.cpp 와
+// 정렬된 가중치 <model>_aot.bin, 같은 난수 입력의 interpreter 출력 <model>_aot_ref.bin 을 생성
+// 중간 텐서 위치는 memory_planner 의 arena offset 상수, batch 1 고정
+// 생성 코드는 aot_kernels.hpp 만 사용 (g++ -O3 -march=native -fopenmp, cl /O2 /arch:AVX2 /openmp /EHsc)
+// 생성된 실행 파일이 속도와 interpreter 출력 대비 오차를 출력 (yolov5s 는 top-k 순위가 바뀌면 후처리 출력 차이가 큼)
+// attention, layer norm 등 DETR 레이어, broadcast elementwise, deconv 는 지원하지 않음 (레이어 이름 출력 후 실패)
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include "aot_kernels.hpp"
+#include "cpu_interpreter.hpp"
+#include "graph_passes.hpp"
+#include "ir_models.hpp"
+#include "memory_planner.hpp"
+
+using namespace ir;
+
+static const char* actName(ActivationType type)
+{
+	switch (type) {
+	case ActivationType::kRELU: return "aot::Act::kRELU";
+	case ActivationType::kSIGMOID: return "aot::Act::kSIGMOID";
+	case ActivationType::kTANH: return "aot::Act::kTANH";
+	case ActivationType::kLEAKY_RELU: return "aot::Act::kLEAKY_RELU";
+	case ActivationType::kELU: return "aot::Act::kELU";
+	case ActivationType::kSELU: return "aot::Act::kSELU";
+	case ActivationType::kSOFTSIGN: return "aot::Act::kSOFTSIGN";
+	case ActivationType::kSOFTPLUS: return "aot::Act::kSOFTPLUS";
+	case ActivationType::kCLIP: return "aot::Act::kCLIP";
+	case ActivationType::kSILU: return "aot::Act::kSILU";
+	}
+	return "aot::Act::kNONE";
+}
+
+static const char* opName(ElementWiseOperation op)
+{
+	switch (op) {
+	case ElementWiseOperation::kSUM: return "aot::Op::kSUM";
+	case ElementWiseOperation::kPROD: return "aot::Op::kPROD";
+	case ElementWiseOperation::kMAX: return "aot::Op::kMAX";
+	case ElementWiseOperation::kMIN: return "aot::Op::kMIN";
+	case ElementWiseOperation::kSUB: return "aot::Op::kSUB";
+	case ElementWiseOperation::kDIV: return "aot::Op::kDIV";
+	case ElementWiseOperation::kPOW: return "aot::Op::kPOW";
+	}
+	return "aot::Op::kSUM";
+}
+
+static std::string floatLiteral(float v)
+{
+	std::ostringstream ss;
+	ss << std::showpoint << std::setprecision(9) << v << "f";
+	return ss.str();
+}
+
+static int64_t product(const Dims& d, int begin, int end)
+{
+	int64_t n = 1;
+	for (int i = begin; i < end; i++) n *= d.d[i];
+	return n;
+}
+
+static int lowestAxis(uint32_t axes)
+{
+	int a = 0;
+	while (a < 31 && !(axes & (1u << a))) a++;
+	return a;
+}
+
+static std::string intArray(const int* v, int n)
+{
+	std::ostringstream ss;
+	ss << "{ ";
+	for (int i = 0; i < n; i++) ss << (i ? ", " : "") << v[i];
+	ss << " }";
+	return ss.str();
+}
+
+//! \class Generator
+//!
+//! \brief network 한 개의 코드, 가중치 파일 생성
+//!
+class Generator
+{
+public:
+	Generator(const Network& network, const ModelConfig& config, CpuInterpreter& constants)
+		: network_(network), config_(config), constants_(constants), plan_(planMemory(network, 1)), scratch_(0), arrays_(0) {}
+
+	// 지원하지 않는 레이어가 있으면 false
+	bool generate(std::ostream& code, std::vector<float>& weights);
+
+private:
+	std::string ptr(const Tensor* t);
+	int64_t append(const float* data, int64_t count);
+	std::string constArray(const int* v, int n);
+	bool emit(const Layer& l, std::ostream& os);
+
+	const Network& network_;
+	const ModelConfig& config_;
+	CpuInterpreter& constants_;
+	MemoryPlan plan_;
+	std::map<int, int64_t> const_offsets_;	// 상수 tensor id -> 가중치 offset
+	std::vector<float>* weights_;
+	std::ostringstream arrays_os_;			// 생성 코드의 constexpr 배열
+	int64_t scratch_;						// shuffle 중간 결과 (arena 뒤)
+	int arrays_;
+};
+
+int64_t Generator::append(const float* data, int64_t count)
+{
+	// 64 byte 정렬
+	while (weights_->size() % 16) weights_->push_back(0.f);
+	const int64_t offset = (int64_t)weights_->size();
+	weights_->insert(weights_->end(), data, data + count);
+	return offset;
+}
+
+std::string Generator::ptr(const Tensor* t)
+{
+	if (t->isNetworkInput()) return "input";
+	if (t->isBatched()) return "a + " + std::to_string(plan_.offsets[t->id()] / sizeof(float));
+	// batch 와 무관한 텐서는 interpreter 로 한번 계산한 값을 가중치 파일에 저장
+	auto it = const_offsets_.find(t->id());
+	if (it == const_offsets_.end()) {
+		const int64_t offset = append(constants_.getTensor(t), volume(t->getDimensions()));
+		it = const_offsets_.insert({ t->id(), offset }).first;
+	}
+	return "w + " + std::to_string(it->second);
+}
+
+std::string Generator::constArray(const int* v, int n)
+{
+	const std::string name = "kARRAY_" + std::to_string(arrays_++);
+	arrays_os_ << "\tconst int " << name << "[" << n << "] = " << intArray(v, n) << ";" << std::endl;
+	return name;
+}
+
+bool Generator::emit(const Layer& l, std::ostream& os)
+{
+	const Tensor* in = l.getNbInputs() > 0 ? l.getInput(0) : nullptr;
+	const Tensor* out = l.getOutput(0);
+	const Dims in_dims = in ? in->getDimensions() : Dims{};
+	const Dims out_dims = out->getDimensions();
+	const int nb = out_dims.nbDims;
+	const std::string act = l.fused_activation_ ? actName(l.activation_) : "aot::Act::kNONE";
+	const std::string ab = floatLiteral(l.alpha_) + ", " + floatLiteral(l.beta_);
+	if (in && in->isNetworkInput() && l.getType() != LayerType::kPREPROCESS) return false;
+
+	switch (l.getType()) {
+	case LayerType::kPREPROCESS: {
+		const PreprocessParam& p = l.preprocess_;
+		const std::string mean = "kMEAN_" + std::to_string(arrays_), std_name = "kSTD_" + std::to_string(arrays_++);
+		arrays_os_ << "\tconst float " << mean << "[3] = { " << floatLiteral(p.mean[0]) << ", " << floatLiteral(p.mean[1]) << ", " << floatLiteral(p.mean[2]) << " };" << std::endl;
+		arrays_os_ << "\tconst float " << std_name << "[3] = { " << floatLiteral(p.std[0]) << ", " << floatLiteral(p.std[1]) << ", " << floatLiteral(p.std[2]) << " };" << std::endl;
+		os << "aot::preprocess<" << p.C << ", " << p.H << ", " << p.W << ", " << p.preproc_type << ">(" << ptr(in) << ", " << mean << ", " << std_name << ", " << ptr(out) << ");";
+		return true;
+	}
+	case LayerType::kCONVOLUTION: {
+		if (in_dims.nbDims != 3) return false;
+		const ConvShape s = convShapeOf(l);
+		const int Kg = s.K / s.G, KD = s.C / s.G * s.KH * s.KW;
+		const int64_t group = aot::packedSize(Kg, KD);
+		std::vector<float> packed(group * s.G);
+		for (int g = 0; g < s.G; g++) aot::packPanels(l.kernel_weights_.data() + (int64_t)g * Kg * KD, Kg, KD, packed.data() + g * group);
+		const int64_t w = append(packed.data(), (int64_t)packed.size());
+		const std::string bias = l.bias_weights_.empty() ? "nullptr" : "w + " + std::to_string(append(l.bias_weights_.data(), s.K));
+		os << "aot::Conv<" << s.C << ", " << s.H << ", " << s.W << ", " << s.K << ", " << s.OH << ", " << s.OW << ", " << s.KH << ", " << s.KW << ", "
+			<< s.SH << ", " << s.SW << ", " << s.PH << ", " << s.PW << ", " << s.DH << ", " << s.DW << ", " << s.G << ", " << act << ">::run("
+			<< ptr(in) << ", w + " << w << ", " << bias << ", " << ab << ", " << ptr(out) << ");";
+		return true;
+	}
+	case LayerType::kFULLY_CONNECTED: {
+		if (product(in_dims, 0, in_dims.nbDims - 3) != 1) return false;
+		const int KD = (int)(l.kernel_weights_.size() / l.nb_outputs_);
+		const int64_t w = append(l.kernel_weights_.data(), (int64_t)l.kernel_weights_.size());
+		const std::string bias = l.bias_weights_.empty() ? "nullptr" : "w + " + std::to_string(append(l.bias_weights_.data(), l.nb_outputs_));
+		os << "aot::fullyConnected<" << l.nb_outputs_ << ", " << KD << ", " << act << ">(" << ptr(in) << ", w + " << w << ", " << bias << ", " << ab << ", " << ptr(out) << ");";
+		return true;
+	}
+	case LayerType::kACTIVATION:
+		os << "aot::activation<" << volume(out_dims) << ", " << actName(l.activation_) << ">(" << ptr(in) << ", " << ab << ", " << ptr(out) << ");";
+		return true;
+	case LayerType::kELEMENTWISE:
+		if (volume(in_dims) != volume(out_dims) || volume(l.getInput(1)->getDimensions()) != volume(out_dims)) return false;
+		os << "aot::elementwise<" << volume(out_dims) << ", " << opName(l.elementwise_op_) << ", " << act << ">(" << ptr(in) << ", " << ptr(l.getInput(1)) << ", " << ab << ", " << ptr(out) << ");";
+		return true;
+	case LayerType::kPOOLING:
+		os << "aot::pooling<" << product(in_dims, 0, nb - 2) << ", " << in_dims.d[nb - 2] << ", " << in_dims.d[nb - 1] << ", " << out_dims.d[nb - 2] << ", " << out_dims.d[nb - 1] << ", "
+			<< l.kernel_.d[0] << ", " << l.kernel_.d[1] << ", " << l.stride_.d[0] << ", " << l.stride_.d[1] << ", " << l.pre_padding_.d[0] << ", " << l.pre_padding_.d[1] << ", "
+			<< (l.pooling_type_ == PoolingType::kMAX ? "true" : "false") << ", " << (l.average_count_excludes_padding_ ? "true" : "false") << ">(" << ptr(in) << ", " << ptr(out) << ");";
+		return true;
+	case LayerType::kCONCATENATION: {
+		const int64_t inner = product(out_dims, l.axis_ + 1, nb);
+		const int64_t outer = product(out_dims, 0, l.axis_), out_block = out_dims.d[l.axis_] * inner;
+		int64_t offset = 0;
+		for (int k = 0; k < l.getNbInputs(); k++) {
+			const int64_t block = l.getInput(k)->getDimensions().d[l.axis_] * inner;
+			os << (k ? "\n\t\t" : "") << "aot::concatInput<" << outer << ", " << out_block << ", " << block << ", " << offset << ">(" << ptr(l.getInput(k)) << ", " << ptr(out) << ");";
+			offset += block;
+		}
+		return true;
+	}
+	case LayerType::kPADDING:
+		os << "aot::padding<" << product(in_dims, 0, nb - 2) << ", " << in_dims.d[nb - 2] << ", " << in_dims.d[nb - 1] << ", " << out_dims.d[nb - 2] << ", " << out_dims.d[nb - 1] << ", "
+			<< l.pre_padding_.d[0] << ", " << l.pre_padding_.d[1] << ">(" << ptr(in) << ", " << ptr(out) << ");";
+		return true;
+	case LayerType::kRESIZE: {
+		if (product(in_dims, 0, nb - 2) != product(out_dims, 0, nb - 2)) return false;
+		// graph pass 로 합쳐진 padding (fuseResizePadding)
+		const int pt = l.pre_padding_.nbDims == 2 ? l.pre_padding_.d[0] : 0, pl = l.pre_padding_.nbDims == 2 ? l.pre_padding_.d[1] : 0;
+		const int pb = l.post_padding_.nbDims == 2 ? l.post_padding_.d[0] : 0, pr = l.post_padding_.nbDims == 2 ? l.post_padding_.d[1] : 0;
+		os << "aot::resize<" << product(in_dims, 0, nb - 2) << ", " << in_dims.d[nb - 2] << ", " << in_dims.d[nb - 1] << ", " << out_dims.d[nb - 2] - pt - pb << ", " << out_dims.d[nb - 1] - pl - pr << ", "
+			<< (l.resize_mode_ == ResizeMode::kNEAREST ? "true" : "false") << ", " << (l.align_corners_ ? "true" : "false");
+		if (pt || pl || pb || pr) os << ", " << pt << ", " << pl << ", " << pb << ", " << pr;
+		os << ">(" << ptr(in) << ", " << ptr(out) << ");";
+		return true;
+	}
+	case LayerType::kSHUFFLE: {
+		// first transpose -> reshape (메모리 변화 없음) -> second transpose, 항등 순서는 생략
+		const int* first = l.first_transpose_.order;
+		const int* second = l.second_transpose_.order;
+		bool first_id = true, second_id = true;
+		for (int i = 0; i < in_dims.nbDims; i++) first_id &= first[i] == i;
+		for (int i = 0; i < nb; i++) second_id &= second[i] == i;
+		Dims reshaped = out_dims;
+		for (int i = 0; i < nb; i++) reshaped.d[second[i]] = out_dims.d[i];
+		if (first_id && second_id) {
+			os << "memcpy(" << ptr(out) << ", " << ptr(in) << ", " << volume(out_dims) << " * sizeof(float));";
+		}
+		else if (second_id) {
+			os << "aot::permute<" << in_dims.nbDims << ">(" << ptr(in) << ", " << constArray(in_dims.d, in_dims.nbDims) << ", " << constArray(first, in_dims.nbDims) << ", " << ptr(out) << ");";
+		}
+		else if (first_id) {
+			os << "aot::permute<" << nb << ">(" << ptr(in) << ", " << constArray(reshaped.d, nb) << ", " << constArray(second, nb) << ", " << ptr(out) << ");";
+		}
+		else {
+			const std::string tmp = "a + " + std::to_string(plan_.arena_bytes / sizeof(float));
+			scratch_ = std::max(scratch_, volume(out_dims));
+			os << "aot::permute<" << in_dims.nbDims << ">(" << ptr(in) << ", " << constArray(in_dims.d, in_dims.nbDims) << ", " << constArray(first, in_dims.nbDims) << ", " << tmp << ");\n\t\t"
+				<< "aot::permute<" << nb << ">(" << tmp << ", " << constArray(reshaped.d, nb) << ", " << constArray(second, nb) << ", " << ptr(out) << ");";
+		}
+		return true;
+	}
+	case LayerType::kSLICE:
+		os << "aot::slice<" << nb << ">(" << ptr(in) << ", " << constArray(in_dims.d, nb) << ", " << constArray(out_dims.d, nb) << ", "
+			<< constArray(l.slice_start_.d, nb) << ", " << constArray(l.slice_stride_.d, nb) << ", " << ptr(out) << ");";
+		return true;
+	case LayerType::kTOPK: {
+		const int axis = lowestAxis(l.axes_);
+		os << "aot::topk<" << product(in_dims, 0, axis) << ", " << in_dims.d[axis] << ", " << product(in_dims, axis + 1, in_dims.nbDims) << ", " << l.nb_outputs_ << ", "
+			<< (l.topk_op_ == TopKOperation::kMAX ? "true" : "false") << ">(" << ptr(in) << ", " << ptr(out) << ", " << ptr(l.getOutput(1)) << ");";
+		return true;
+	}
+	case LayerType::kGATHER:
+		os << "aot::gather<" << product(in_dims, 0, l.axis_) << ", " << in_dims.d[l.axis_] << ", " << product(in_dims, l.axis_ + 1, in_dims.nbDims) << ", "
+			<< volume(l.getInput(1)->getDimensions()) << ">(" << ptr(in) << ", " << ptr(l.getInput(1)) << ", " << ptr(out) << ");";
+		return true;
+	case LayerType::kYOLOLAYER: {
+		const YololayerParam& p = l.yololayer_;
+		os << "aot::yololayer<" << p.H << ", " << p.W << ", " << p.CLASS_NUM << ", " << p.Grid_stride << ">(" << ptr(in) << ", " << ptr(l.getInput(1)) << ", " << ptr(out) << ");";
+		return true;
+	}
+	default:
+		return false;
+	}
+}
+
+bool Generator::generate(std::ostream& code, std::vector<float>& weights)
+{
+	weights_ = &weights;
+	std::ostringstream body;
+	bool ok = true;
+	for (int i = 0; i < network_.getNbLayers(); i++) {
+		const Layer* l = network_.getLayer(i);
+		if (!l->getOutput(0)->isBatched()) continue;	// 상수 부분 그래프 (결과를 가중치 파일에 저장)
+		std::ostringstream os;
+		if (!emit(*l, os)) {
+			std::cerr << "[ERROR] unsupported layer for code generation : " << l->getName() << " (" << layerTypeName(l->getType()) << ")" << std::endl;
+			ok = false;
+			continue;
+		}
+		body << "\t\t// " << l->getName() << std::endl << "\t\t" << os.str() << std::endl;
+	}
+	if (!ok) return false;
+
+	int64_t output_count = 0;
+	std::ostringstream outputs;
+	for (int i = 0; i < network_.getNbOutputs(); i++) {
+		const Tensor* t = network_.getOutput(i);
+		outputs << "\t\t{ " << ptr(t).substr(4) << ", " << volume(t->getDimensions()) << " },\t// " << t->getName() << std::endl;
+		output_count += volume(t->getDimensions());
+	}
+	const std::string name = config_.name;
+	code << "// " << name << " ahead-of-time 생성 코드 (ir_codegen), batch 1, 입력 [" << config_.input_h << ", " << config_.input_w << ", " << config_.input_c << "] uint8 BGR" << std::endl
+		<< "// usage : " << name << "_aot [-w " << name << "_aot.bin] [-i input.raw] [-c " << name << "_aot_ref.bin] [-n iterations]" << std::endl
+		<< "#include <chrono>\n#include <cmath>\n#include <cstdlib>\n#include <cstring>\n#include <fstream>\n#include <iostream>\n#include <random>\n#include <string>\n#include \"aot_kernels.hpp\"\n\n"
+		<< "namespace\n{\n"
+		<< "\tconstexpr int64_t kWEIGHT_COUNT = " << weights.size() << ";" << std::endl
+		<< "\tconstexpr int64_t kARENA_COUNT = " << plan_.arena_bytes / sizeof(float) + scratch_ << ";\t// 중간 텐서 (memory_planner offset)" << std::endl
+		<< "\tconstexpr int64_t kINPUT_COUNT = " << (int64_t)config_.input_h * config_.input_w * config_.input_c << ";" << std::endl
+		<< "\tconstexpr int64_t kOUTPUT_COUNT = " << output_count << ";" << std::endl
+		<< "\tconstexpr int kOUTPUTS = " << network_.getNbOutputs() << ";" << std::endl
+		<< "\tconst int64_t kOUTPUT_LAYOUT[kOUTPUTS][2] = {\t// arena offset, 개수" << std::endl << outputs.str() << "\t};" << std::endl
+		<< arrays_os_.str() << std::endl
+		<< "\tvoid infer(const uint8_t* input, const float* w, float* a)\n\t{\n" << body.str() << "\t}\n"
+		<< "}\n\n"
+		<< "int main(int argc, char** argv)\n{\n"
+		<< "\tstd::string weight_file = \"" << name << "_aot.bin\", reference_file = \"" << name << "_aot_ref.bin\", input_file;\n"
+		<< "\tint iterations = 10;\n"
+		<< "\tfor (int i = 1; i + 1 < argc; i++) {\n"
+		<< "\t\tif (!strcmp(argv[i], \"-w\")) weight_file = argv[++i];\n"
+		<< "\t\telse if (!strcmp(argv[i], \"-i\")) input_file = argv[++i];\n"
+		<< "\t\telse if (!strcmp(argv[i], \"-c\")) reference_file = argv[++i];\n"
+		<< "\t\telse if (!strcmp(argv[i], \"-n\")) iterations = atoi(argv[++i]);\n"
+		<< "\t}\n"
+		<< "\tstd::vector<float> w(kWEIGHT_COUNT);\n"
+		<< "\tstd::ifstream wf(weight_file, std::ios::binary);\n"
+		<< "\tif (!wf.read((char*)w.data(), kWEIGHT_COUNT * sizeof(float))) {\n"
+		<< "\t\tstd::cerr << \"[ERROR] weight file read error : \" << weight_file << std::endl;\n"
+		<< "\t\treturn 1;\n\t}\n"
+		<< "\t// 입력 파일이 없으면 ir_codegen 과 같은 난수 이미지\n"
+		<< "\tstd::vector<uint8_t> input(kINPUT_COUNT);\n"
+		<< "\tstd::ifstream in(input_file, std::ios::binary);\n"
+		<< "\tif (in.is_open()) in.read((char*)input.data(), kINPUT_COUNT);\n"
+		<< "\telse {\n\t\tstd::mt19937 rng(0);\n\t\tfor (auto& v : input) v = (uint8_t)(rng() & 255);\n\t}\n"
+		<< "\tstd::vector<float> arena(kARENA_COUNT);\n"
+		<< "\tinfer(input.data(), w.data(), arena.data());\t// warm up\n"
+		<< "\tauto t0 = std::chrono::high_resolution_clock::now();\n"
+		<< "\tfor (int i = 0; i < iterations; i++) infer(input.data(), w.data(), arena.data());\n"
+		<< "\tauto t1 = std::chrono::high_resolution_clock::now();\n"
+		<< "\tstd::cout << \"" << name << " aot : \" << std::chrono::duration<double, std::milli>(t1 - t0).count() / iterations << \" ms\" << std::endl;\n"
+		<< "\n\t// interpreter 출력과 비교\n"
+		<< "\tstd::vector<float> output, reference(kOUTPUT_COUNT);\n"
+		<< "\tfor (int i = 0; i < kOUTPUTS; i++) output.insert(output.end(), arena.data() + kOUTPUT_LAYOUT[i][0], arena.data() + kOUTPUT_LAYOUT[i][0] + kOUTPUT_LAYOUT[i][1]);\n"
+		<< "\tstd::ifstream rf(reference_file, std::ios::binary);\n"
+		<< "\tif (rf.read((char*)reference.data(), kOUTPUT_COUNT * sizeof(float))) {\n"
+		<< "\t\tdouble max_abs = 0.0, dot = 0.0, na = 0.0, nb = 0.0;\n"
+		<< "\t\tfor (int64_t i = 0; i < kOUTPUT_COUNT; i++) {\n"
+		<< "\t\t\tmax_abs = std::max(max_abs, (double)std::fabs(output[i] - reference[i]));\n"
+		<< "\t\t\tdot += (double)output[i] * reference[i];\n"
+		<< "\t\t\tna += (double)output[i] * output[i];\n"
+		<< "\t\t\tnb += (double)reference[i] * reference[i];\n"
+		<< "\t\t}\n"
+		<< "\t\tstd::cout << \"vs interpreter : max abs \" << max_abs << \", cosine \" << (na > 0.0 && nb > 0.0 ? dot / std::sqrt(na * nb) : 1.0) << std::endl;\n"
+		<< "\t}\n"
+		<< "\treturn 0;\n}\n";
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2) {
+		std::cerr << "usage : ir_codegen <resnet18|yolov5s|vgg11|unet> [-o dir] [-n iterations] [-t threads] [-r]" << std::endl;
+		return 1;
+	}
+	const ModelConfig* config = findModel(argv[1]);
+	if (!config) {
+		std::cerr << "[ERROR] unknown model : " << argv[1] << std::endl;
+		return 1;
+	}
+	std::string dir = ".";
+	int iterations = 5, threads = 0;
+	bool random_missing = false;
+	for (int i = 2; i < argc; i++) {
+		if (!strcmp(argv[i], "-o") && i + 1 < argc) dir = argv[++i];
+		else if (!strcmp(argv[i], "-n") && i + 1 < argc) iterations = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-t") && i + 1 < argc) threads = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-r")) random_missing = true;
+	}
+
+	WeightMap weightMap;
+	std::ifstream wts(config->weight_file);
+	if (wts.good()) {
+		wts.close();
+		weightMap = loadWeights(config->weight_file);
+	}
+	else if (!random_missing) {
+		std::cerr << "[ERROR] weight file not found : " << config->weight_file << " (use -r for random weights)" << std::endl;
+		return 1;
+	}
+	WeightSource weights(weightMap, random_missing);
+	Network network;
+	if (!buildModel(config->name, network, weights, 1)) return 1;
+	optimizeNetwork(network, nullptr);
+
+	// 1. 코드, 가중치
+	CpuInterpreter interpreter(network, 1, threads);
+	interpreter.evaluateConstants();
+	Generator generator(network, *config, interpreter);
+	std::ostringstream code;
+	std::vector<float> packed;
+	if (!generator.generate(code, packed)) return 1;
+	const std::string base = dir + "/" + config->name + "_aot";
+	std::ofstream(base + ".cpp") << code.str();
+	std::ofstream(base + ".bin", std::ios::binary).write((const char*)packed.data(), packed.size() * sizeof(float));
+
+	// 2. 같은 입력의 interpreter 출력, 속도
+	std::vector<uint8_t> input((size_t)config->input_h * config->input_w * config->input_c);
+	std::mt19937 rng(0);
+	for (auto& v : input) v = (uint8_t)(rng() & 255);
+	interpreter.setInput(config->input_name, input.data());
+	interpreter.run(1);
+	auto t0 = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < iterations; i++) interpreter.run(1);
+	auto t1 = std::chrono::high_resolution_clock::now();
+	std::ofstream ref(base + "_ref.bin", std::ios::binary);
+	for (int i = 0; i < network.getNbOutputs(); i++) {
+		const Tensor* t = network.getOutput(i);
+		ref.write((const char*)interpreter.getTensor(t), volume(t->getDimensions()) * sizeof(float));
+	}
+
+	std::cout << base << ".cpp : " << network.getNbLayers() << " layers, weights " << std::fixed << std::setprecision(2) << packed.size() * sizeof(float) / (1024.0 * 1024.0) << " MB" << std::endl;
+	std::cout << config->name << " interpreter : " << std::chrono::duration<double, std::milli>(t1 - t0).count() / iterations << " ms" << std::endl;
+	std::cout << "build : g++ -O3 -march=native -fopenmp -I<TensorRT dir> " << base << ".cpp -o " << base << "  (or cl /O2 /arch:AVX2 /openmp /EHsc)" << std::endl;
+	return 0;
+}
@@ -0,0 +1,141 @@
+﻿// DETR graph 단순화 (BuildOptions::simplify_detr, detr_trt.cpp simplify_graph) 전후 비교
+// usage : ir_detr [options]
+//   -n <iterations>  반복 횟수 (기본 5)
+//   -t <threads>     OpenMP thread 수
+//   -r               .wts 에 없는 가중치를 난수로 생성 (가중치 파일 없이 실행)
+// PyTorch 모듈 구조 그대로 기록한 graph 와 단순화한 graph 의 레이어 수, 연산량, CPU 지연 시간, 출력 차이
+//   graph GFLOP : graph pass 전 전체 레이어 (상수 접기 없이 매 frame 실행하는 경우)
+//   frame GFLOP : graph pass 후 batch 텐서를 계산하는 레이어 (상수 부분 그래프는 첫 실행에서 한번만 계산)
+//   graph / frame Melem : 같은 기준의 원소 단위 연산 (elementwise, softmax, activation, ... 출력 원소 수, GFLOP 에 없는 memory + pos 반복 포함)
+// CPU interpreter 는 PyTorch graph 의 첫 decoder self-attention (zero target) 도 상수로 접으므로
+// frame GFLOP 은 같고, 단순화로 매 frame 줄어드는 것은 원소 단위 연산 (memory + pos 반복) 뿐 (지연 시간 차이는 대부분 측정 오차 수준)
+// 출력 차이는 PyTorch 구조 graph 기준 (PyTorch 와의 정합성은 ir_run -c 로 TensorRT 출력과 비교)
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include "cpu_interpreter.hpp"
+#include "graph_passes.hpp"
+#include "ir_models.hpp"
+
+static double measure(CpuInterpreter& interpreter, int iterations)
+{
+	interpreter.run(1);	// warm up (상수 부분 그래프 계산)
+	auto t0 = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < iterations; i++) interpreter.run(1);
+	auto t1 = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration<double, std::milli>(t1 - t0).count() / iterations;
+}
+
+// batchedOnly 이면 batch 텐서를 계산하는 레이어만
+static double gflops(const ir::Network& network, bool batchedOnly)
+{
+	int64_t flops = 0;
+	for (int i = 0; i < network.getNbLayers(); i++) {
+		const ir::Layer* l = network.getLayer(i);
+		if (!batchedOnly || l->getOutput(0)->isBatched()) flops += layerFlops(*l);
+	}
+	return flops * 1e-9;
+}
+
+// 원소 단위 연산 레이어의 출력 원소 수 (백만), batchedOnly 는 gflops 와 같음
+static double elementOps(const ir::Network& network, bool batchedOnly)
+{
+	int64_t count = 0;
+	for (int i = 0; i < network.getNbLayers(); i++) {
+		const ir::Layer* l = network.getLayer(i);
+		if (batchedOnly && !l->getOutput(0)->isBatched()) continue;
+		switch (l->getType()) {
+		case ir::LayerType::kELEMENTWISE:
+		case ir::LayerType::kSOFTMAX:
+		case ir::LayerType::kACTIVATION:
+		case ir::LayerType::kUNARY:
+		case ir::LayerType::kSCALE:
+		case ir::LayerType::kREDUCE:
+		case ir::LayerType::kLAYER_NORM:
+			count += ir::volume(l->getOutput(0)->getDimensions());
+			break;
+		default:
+			break;
+		}
+	}
+	return count * 1e-6;
+}
+
+int main(int argc, char** argv)
+{
+	int iterations = 5, threads = 0;
+	bool random_missing = false;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-n") && i + 1 < argc) iterations = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-t") && i + 1 < argc) threads = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-r")) random_missing = true;
+	}
+	const ir::ModelConfig* config = ir::findModel("detr");
+	ir::WeightMap weightMap;
+	std::ifstream wts(config->weight_file);
+	if (wts.good()) {
+		wts.close();
+		weightMap = ir::loadWeights(config->weight_file);
+	}
+	else if (!random_missing) {
+		std::cerr << "[ERROR] weight file not found : " << config->weight_file << " (use -r for random weights)" << std::endl;
+		return 1;
+	}
+
+	// 같은 WeightSource 로 두 번 기록 (난수 가중치도 동일)
+	ir::WeightSource weights(weightMap, random_missing);
+	ir::BuildOptions options[2];
+	options[0].simplify_detr = false;
+	const char* names[2] = { "pytorch", "simplified" };
+	ir::Network networks[2];
+	int raw_layers[2];
+	double raw_gflops[2], raw_elements[2];
+	for (int v = 0; v < 2; v++) {
+		if (!ir::buildModel(config->name, networks[v], weights, 1, options[v])) return 1;
+		raw_layers[v] = networks[v].getNbLayers();
+		raw_gflops[v] = gflops(networks[v], false);
+		raw_elements[v] = elementOps(networks[v], false);
+		ir::optimizeNetwork(networks[v], nullptr);
+	}
+
+	std::vector<uint8_t> input((size_t)config->input_h * config->input_w * config->input_c);
+	std::mt19937 rng(0);
+	for (auto& v : input) v = (uint8_t)(rng() & 255);
+	CpuInterpreter original(networks[0], 1, threads), simplified(networks[1], 1, threads);
+	CpuInterpreter* interpreters[2] = { &original, &simplified };
+	double ms[2];
+	for (int v = 0; v < 2; v++) {
+		interpreters[v]->setInput(config->input_name, input.data());
+		ms[v] = measure(*interpreters[v], iterations);
+	}
+
+	std::cout << std::left << std::setw(12) << "graph" << std::right << std::setw(8) << "layers" << std::setw(13) << "graph GFLOP"
+		<< std::setw(13) << "graph Melem" << std::setw(10) << "fused" << std::setw(13) << "frame GFLOP" << std::setw(13) << "frame Melem"
+		<< std::setw(10) << "ms" << std::setw(10) << "change" << std::endl;
+	for (int v = 0; v < 2; v++) {
+		std::cout << std::left << std::setw(12) << names[v] << std::right << std::setw(8) << raw_layers[v] << std::fixed << std::setprecision(3)
+			<< std::setw(13) << raw_gflops[v] << std::setw(13) << raw_elements[v] << std::setw(10) << networks[v].getNbLayers()
+			<< std::setw(13) << gflops(networks[v], true) << std::setw(13) << elementOps(networks[v], true)
+			<< std::setprecision(2) << std::setw(10) << ms[v] << std::setw(9) << 100.0 * (ms[v] - ms[0]) / ms[0] << "%" << std::endl;
+	}
+	const double frame_gflop = gflops(networks[1], true) - gflops(networks[0], true);
+	const double frame_elements = elementOps(networks[1], true) - elementOps(networks[0], true);
+	std::cout << std::setprecision(3) << "per frame change : " << frame_gflop << " GFLOP, " << frame_elements << " Melem ("
+		<< std::setprecision(2) << 100.0 * frame_elements / std::max(elementOps(networks[0], true), 1e-9) << "%), "
+		<< 100.0 * (ms[1] - ms[0]) / ms[0] << "% latency" << std::endl;
+	if (frame_gflop == 0.0) {
+		std::cout << "  first decoder self-attention is already constant-folded on CPU, the GEMM work per frame is unchanged" << std::endl;
+	}
+	for (int i = 0; i < networks[0].getNbOutputs(); i++) {
+		const ir::Tensor* a = networks[0].getOutput(i);
+		const ir::Tensor* b = networks[1].getOutput(i);
+		const TensorDiff diff = diffTensors(original.getTensor(a), simplified.getTensor(b), (size_t)ir::volume(a->getDimensions()));
+		std::cout << "output " << a->getName() << " : " << diff << std::endl;
+	}
+	return 0;
+}
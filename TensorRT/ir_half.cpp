@@ -0,0 +1,135 @@
+﻿// 16 bit activation 저장 (CpuPrecision::kFP16, kBF16) 과 float 실행 비교
+// usage : ir_half [unet|yolov5s|resnet18|vgg11|detr|all] [options]   (모델을 생략하면 unet, yolov5s)
+//   -n <iterations>  측정 반복 횟수 (기본 5)
+//   -t <threads>     OpenMP thread 수
+//   -u               planMemory 없이 텐서별 버퍼로 실행 (기본은 arena 배치)
+//   -r               .wts 에 없는 가중치를 난수로 생성 (가중치 파일 없이 실행)
+// 모델마다 형식별 중간 텐서 메모리, 실행 시간 (conv / 나머지 레이어), float 출력과의 차이, 레이어 종류별 시간
+//   나머지 레이어 (연산량 0 : pooling, concat, resize, elementwise 등) 는 memory bandwidth 가 시간을 정함
+//   topk 로 정렬된 출력 (yolov5s) 은 점수가 비슷한 검출의 순서가 바뀌면 max abs 가 커짐 (cosine 으로 판단)
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include "cpu_interpreter.hpp"
+#include "graph_passes.hpp"
+#include "ir_models.hpp"
+
+struct HalfResult {
+	const char* name;
+	int64_t activation_bytes;
+	double total_ms;
+	double conv_ms;		// 연산량이 있는 레이어 (conv, deconv, fc, matmul)
+	double memory_ms;	// 나머지 레이어
+	std::map<std::string, double> type_ms;
+	std::vector<float> outputs;
+};
+
+static HalfResult measure(const ir::Network& network, const ir::ModelConfig& config, const std::vector<uint8_t>& input,
+	CpuPrecision precision, const char* name, int iterations, int threads, bool plan)
+{
+	CpuInterpreter interpreter(network, 1, threads, precision, plan);
+	interpreter.setInput(config.input_name, input.data());
+	interpreter.run(1);	// warm up (상수 부분 그래프 계산)
+	interpreter.resetProfile();
+	for (int i = 0; i < iterations; i++) interpreter.run(1);
+
+	HalfResult r{ name, interpreter.activationBytes(), 0.0, 0.0, 0.0, {}, {} };
+	for (const LayerProfile& p : interpreter.profile()) {
+		const double ms = p.total_ms / iterations;
+		r.total_ms += ms;
+		(p.flops > 0 ? r.conv_ms : r.memory_ms) += ms;
+		r.type_ms[ir::layerTypeName(p.type)] += ms;
+	}
+	for (int i = 0; i < network.getNbOutputs(); i++) {
+		const ir::Tensor* output = network.getOutput(i);
+		const float* v = interpreter.getTensor(output);
+		r.outputs.insert(r.outputs.end(), v, v + ir::volume(output->getDimensions()));
+	}
+	return r;
+}
+
+int main(int argc, char** argv)
+{
+	std::string model = argc > 1 && argv[1][0] != '-' ? argv[1] : "";
+	int iterations = 5, threads = 0;
+	bool plan = true, random_missing = false;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-n") && i + 1 < argc) iterations = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-t") && i + 1 < argc) threads = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-u")) plan = false;
+		else if (!strcmp(argv[i], "-r")) random_missing = true;
+	}
+	std::vector<const ir::ModelConfig*> configs;
+	if (model == "all") {
+		for (const ir::ModelConfig& c : ir::modelConfigs()) configs.push_back(&c);
+	}
+	else if (model.empty()) {
+		configs.push_back(ir::findModel("unet"));
+		configs.push_back(ir::findModel("yolov5s"));
+	}
+	else if (const ir::ModelConfig* c = ir::findModel(model)) configs.push_back(c);
+	else {
+		std::cerr << "[ERROR] unknown model : " << model << std::endl;
+		return 1;
+	}
+
+	std::cout << "conversion isa " << halfIsaName(halfIsa()) << ", " << (plan ? "memory planned arena" : "per tensor buffers") << ", " << iterations << " iterations" << std::endl;
+	for (const ir::ModelConfig* config : configs) {
+		ir::WeightMap weightMap;
+		std::ifstream wts(config->weight_file);
+		if (wts.good()) {
+			wts.close();
+			weightMap = ir::loadWeights(config->weight_file);
+		}
+		else if (!random_missing) {
+			std::cerr << "[ERROR] weight file not found : " << config->weight_file << " (use -r for random weights)" << std::endl;
+			return 1;
+		}
+		ir::WeightSource weights(weightMap, random_missing);
+		ir::Network network;
+		if (!ir::buildModel(config->name, network, weights, 1)) return 1;
+		ir::optimizeNetwork(network, nullptr);
+
+		std::vector<uint8_t> input((size_t)config->input_h * config->input_w * config->input_c);
+		std::mt19937 rng(0);
+		for (auto& v : input) v = (uint8_t)(rng() & 255);
+
+		std::vector<HalfResult> results;
+		results.push_back(measure(network, *config, input, CpuPrecision::kFP32, "fp32", iterations, threads, plan));
+		results.push_back(measure(network, *config, input, CpuPrecision::kFP16, "fp16", iterations, threads, plan));
+		results.push_back(measure(network, *config, input, CpuPrecision::kBF16, "bf16", iterations, threads, plan));
+		const HalfResult& base = results[0];
+
+		std::cout << "[" << config->name << "] " << network.getNbLayers() << " layers" << std::endl;
+		std::cout << "  " << std::left << std::setw(6) << "format" << std::right << std::setw(12) << "act MB" << std::setw(11) << "total ms"
+			<< std::setw(10) << "conv ms" << std::setw(11) << "memory ms" << std::setw(10) << "speedup" << std::setw(12) << "max abs" << std::setw(12) << "cosine" << std::endl;
+		for (const HalfResult& r : results) {
+			const TensorDiff diff = diffTensors(base.outputs.data(), r.outputs.data(), base.outputs.size());
+			std::cout << "  " << std::left << std::setw(6) << r.name << std::right << std::fixed << std::setprecision(2)
+				<< std::setw(12) << r.activation_bytes / (1024.0 * 1024.0) << std::setw(11) << r.total_ms << std::setw(10) << r.conv_ms
+				<< std::setw(11) << r.memory_ms << std::setw(9) << base.memory_ms / std::max(r.memory_ms, 1e-9) << "x"
+				<< std::scientific << std::setw(12) << diff.max_abs << std::fixed << std::setprecision(6) << std::setw(12) << diff.cosine << std::endl;
+		}
+		// 레이어 종류별 시간 (float 기준 느린 순서)
+		std::vector<std::pair<double, std::string>> types;
+		for (const auto& e : base.type_ms) types.push_back({ e.second, e.first });
+		std::sort(types.rbegin(), types.rend());
+		std::cout << "  " << std::left << std::setw(16) << "layer type" << std::right;
+		for (const HalfResult& r : results) std::cout << std::setw(9) << r.name << " ms";
+		std::cout << std::setw(10) << "fp16" << std::setw(10) << "bf16" << std::endl;
+		for (const auto& t : types) {
+			std::cout << "  " << std::left << std::setw(16) << t.second << std::right << std::fixed << std::setprecision(3);
+			for (const HalfResult& r : results) std::cout << std::setw(12) << r.type_ms.at(t.second);
+			std::cout << std::setprecision(2);
+			for (int k = 1; k < (int)results.size(); k++) std::cout << std::setw(9) << t.first / std::max(results[k].type_ms.at(t.second), 1e-9) << "x";
+			std::cout << std::endl;
+		}
+		std::cout.unsetf(std::ios::floatfield);
+	}
+	return 0;
+}
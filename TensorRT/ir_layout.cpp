@@ -0,0 +1,101 @@
+﻿// layout planning (layout_planner.hpp) 적용 전후 비교
+// usage : ir_layout [resnet18|yolov5s|vgg11|unet|detr|all] [options]
+//   -n <iterations>  반복 횟수 (기본 5)
+//   -t <threads>     OpenMP thread 수
+//   -v               NCHWc 로 실행하는 레이어 이름 출력
+//   -r               .wts 에 없는 가중치를 난수로 생성 (가중치 파일 없이 실행)
+// 모델마다 NCHWc conv / 레이어 수, layout 변환 수, zero-copy concat 입력 수와 줄어든 복사량, 지연 시간 변화, 출력 오차
+// (출력 오차는 NCHWc conv 의 누적 순서 차이, yolov5s 는 top-k 순위가 바뀌면 후처리 출력 차이가 큼)
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include "cpu_interpreter.hpp"
+#include "graph_passes.hpp"
+#include "ir_models.hpp"
+
+static double measure(CpuInterpreter& interpreter, int iterations)
+{
+	interpreter.run(1);	// warm up
+	auto t0 = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < iterations; i++) interpreter.run(1);
+	auto t1 = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration<double, std::milli>(t1 - t0).count() / iterations;
+}
+
+int main(int argc, char** argv)
+{
+	std::string model = argc > 1 && argv[1][0] != '-' ? argv[1] : "all";
+	int iterations = 5, threads = 0;
+	bool verbose = false, random_missing = false;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-n") && i + 1 < argc) iterations = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-t") && i + 1 < argc) threads = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-v")) verbose = true;
+		else if (!strcmp(argv[i], "-r")) random_missing = true;
+	}
+	std::vector<const ir::ModelConfig*> configs;
+	if (model == "all") {
+		for (const ir::ModelConfig& c : ir::modelConfigs()) configs.push_back(&c);
+	}
+	else if (const ir::ModelConfig* c = ir::findModel(model)) configs.push_back(c);
+	else {
+		std::cerr << "[ERROR] unknown model : " << model << std::endl;
+		return 1;
+	}
+
+	std::cout << std::left << std::setw(10) << "model" << std::right << std::setw(8) << "nchwc" << std::setw(8) << "blocked" << std::setw(8) << "convs"
+		<< std::setw(9) << "concat" << std::setw(11) << "saved MB" << std::setw(10) << "base ms" << std::setw(10) << "plan ms" << std::setw(9) << "change"
+		<< std::setw(14) << "max abs diff" << std::endl;
+	for (const ir::ModelConfig* config : configs) {
+		ir::WeightMap weightMap;
+		std::ifstream wts(config->weight_file);
+		if (wts.good()) {
+			wts.close();
+			weightMap = ir::loadWeights(config->weight_file);
+		}
+		else if (!random_missing) {
+			std::cerr << "[ERROR] weight file not found : " << config->weight_file << " (use -r for random weights)" << std::endl;
+			return 1;
+		}
+		ir::WeightSource weights(weightMap, random_missing);
+		ir::Network network;
+		if (!ir::buildModel(config->name, network, weights, 1)) return 1;
+		ir::optimizeNetwork(network, nullptr);
+
+		std::vector<uint8_t> input((size_t)config->input_h * config->input_w * config->input_c);
+		std::mt19937 rng(0);
+		for (auto& v : input) v = (uint8_t)(rng() & 255);
+		CpuInterpreter base(network, 1, threads);
+		CpuInterpreter planned(network, 1, threads, CpuPrecision::kFP32, false, true);
+		base.setInput(config->input_name, input.data());
+		planned.setInput(config->input_name, input.data());
+		const double base_ms = measure(base, iterations);
+		const double plan_ms = measure(planned, iterations);
+
+		double max_abs = 0.0;
+		for (int i = 0; i < network.getNbOutputs(); i++) {
+			const ir::Tensor* output = network.getOutput(i);
+			const int64_t count = ir::volume(output->getDimensions());
+			const float* a = base.getTensor(output);
+			const float* b = planned.getTensor(output);
+			for (int64_t k = 0; k < count; k++) max_abs = std::max(max_abs, (double)std::fabs(a[k] - b[k]));
+		}
+		const LayoutPlan& plan = planned.layoutPlan();
+		std::cout << std::left << std::setw(10) << config->name << std::right << std::setw(8) << plan.blocked_convs << std::setw(8) << plan.blocked_layers_count
+			<< std::setw(8) << plan.conversions << std::setw(9) << plan.zero_copy_inputs << std::fixed << std::setprecision(2) << std::setw(11) << plan.concat_bytes_saved / (1024.0 * 1024.0)
+			<< std::setw(10) << base_ms << std::setw(10) << plan_ms << std::setw(8) << 100.0 * (plan_ms - base_ms) / base_ms << "%"
+			<< std::scientific << std::setw(14) << max_abs << std::endl;
+		if (verbose) {
+			for (int i = 0; i < network.getNbLayers(); i++) {
+				if (plan.blocked_layers[i]) std::cout << "  nchwc " << network.getLayer(i)->getName() << std::endl;
+			}
+		}
+	}
+	return 0;
+}
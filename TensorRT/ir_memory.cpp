@@ -0,0 +1,103 @@
+﻿// 중간 텐서 메모리 배치 결과 (memory_planner.hpp) 비교
+// usage : ir_memory [resnet18|yolov5s|vgg11|unet|detr|all] [options]
+//   -b <batch>   batch 크기 (기본 1)
+//   -v           planMemory 실행 결과를 텐서별 버퍼 실행과 비교 (출력 최대 절대 오차)
+//   -t <threads> OpenMP thread 수
+//   -r           .wts 에 없는 가중치를 난수로 생성 (가중치 파일 없이 실행)
+// 모델마다 naive (텐서별 버퍼), 동시에 살아있는 최대 크기 (하한), greedy-by-size (in-place 없음 / 있음) 크기 출력
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include "cpu_interpreter.hpp"
+#include "graph_passes.hpp"
+#include "ir_models.hpp"
+#include "memory_planner.hpp"
+
+static double mb(int64_t bytes)
+{
+	return bytes / (1024.0 * 1024.0);
+}
+
+// planMemory 유무로 같은 입력을 실행해서 network 출력의 최대 절대 오차
+static double verify(const ir::Network& network, const ir::ModelConfig& config, int batch, int threads)
+{
+	std::vector<uint8_t> input((size_t)batch * config.input_h * config.input_w * config.input_c);
+	std::mt19937 rng(0);
+	for (auto& v : input) v = (uint8_t)(rng() & 255);
+	CpuInterpreter plain(network, batch, threads);
+	CpuInterpreter planned(network, batch, threads, CpuPrecision::kFP32, true);
+	plain.setInput(config.input_name, input.data());
+	planned.setInput(config.input_name, input.data());
+	// 두 번 실행 (arena 에 남은 이전 실행 값에 의존하지 않는지 확인)
+	for (int k = 0; k < 2; k++) {
+		plain.run(batch);
+		planned.run(batch);
+	}
+	double max_abs = 0.0;
+	for (int i = 0; i < network.getNbOutputs(); i++) {
+		const ir::Tensor* output = network.getOutput(i);
+		const int64_t count = ir::volume(output->getDimensions()) * batch;
+		const float* a = plain.getTensor(output);
+		const float* b = planned.getTensor(output);
+		for (int64_t k = 0; k < count; k++) max_abs = std::max(max_abs, (double)std::fabs(a[k] - b[k]));
+	}
+	return max_abs;
+}
+
+int main(int argc, char** argv)
+{
+	std::string model = argc > 1 && argv[1][0] != '-' ? argv[1] : "all";
+	int batch = 1, threads = 0;
+	bool check = false, random_missing = false;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-b") && i + 1 < argc) batch = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-t") && i + 1 < argc) threads = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-v")) check = true;
+		else if (!strcmp(argv[i], "-r")) random_missing = true;
+	}
+	std::vector<const ir::ModelConfig*> configs;
+	if (model == "all") {
+		for (const ir::ModelConfig& c : ir::modelConfigs()) configs.push_back(&c);
+	}
+	else if (const ir::ModelConfig* c = ir::findModel(model)) configs.push_back(c);
+	else {
+		std::cerr << "[ERROR] unknown model : " << model << std::endl;
+		return 1;
+	}
+
+	std::cout << std::left << std::setw(10) << "model" << std::right << std::setw(9) << "tensors" << std::setw(12) << "naive MB" << std::setw(12) << "peak MB"
+		<< std::setw(14) << "greedy MB" << std::setw(14) << "+inplace MB" << std::setw(10) << "inplace" << std::setw(10) << "ratio";
+	if (check) std::cout << std::setw(14) << "max abs diff";
+	std::cout << std::endl;
+	for (const ir::ModelConfig* config : configs) {
+		ir::WeightMap weightMap;
+		std::ifstream wts(config->weight_file);
+		if (wts.good()) {
+			wts.close();
+			weightMap = ir::loadWeights(config->weight_file);
+		}
+		else if (!random_missing) {
+			std::cerr << "[ERROR] weight file not found : " << config->weight_file << " (use -r for random weights)" << std::endl;
+			return 1;
+		}
+		ir::WeightSource weights(weightMap, random_missing);
+		ir::Network network;
+		if (!ir::buildModel(config->name, network, weights, batch)) return 1;
+		ir::optimizeNetwork(network, nullptr);
+
+		const MemoryPlan naive = planMemory(network, batch, PlanStrategy::kNAIVE, false);
+		const MemoryPlan greedy = planMemory(network, batch, PlanStrategy::kGREEDY_BY_SIZE, false);
+		const MemoryPlan in_place = planMemory(network, batch);
+		std::cout << std::left << std::setw(10) << config->name << std::right << std::setw(9) << naive.lifetimes.size() << std::fixed << std::setprecision(2)
+			<< std::setw(12) << mb(naive.arena_bytes) << std::setw(12) << mb(in_place.peak_live_bytes) << std::setw(14) << mb(greedy.arena_bytes)
+			<< std::setw(14) << mb(in_place.arena_bytes) << std::setw(10) << in_place.in_place << std::setw(9) << (double)naive.arena_bytes / in_place.arena_bytes << "x";
+		if (check) std::cout << std::scientific << std::setprecision(2) << std::setw(14) << verify(network, *config, batch, threads);
+		std::cout << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,770 @@
+﻿#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include "ir_models.hpp"
+
+namespace ir
+{
+	static const std::vector<float> kEMPTY;
+
+	const std::vector<ModelConfig>& modelConfigs()
+	{
+		static const std::vector<ModelConfig> configs = {
+			{ "yolov5s", "../yolov5s_py/yolov5s.wts", 640, 640, 3, "data", 2 },
+			{ "resnet18", "../Resnet18_py/resnet18.wts", 224, 224, 3, "data", 0 },
+			{ "vgg11", "../VGG11_py/vgg11.wts", 224, 224, 3, "data", 0 },
+			{ "unet", "../Unet_py/unet.wts", 512, 512, 3, "data", 1 },
+			{ "detr", "../DETR_py/detr.wts", 500, 500, 3, "images", 0 },
+		};
+		return configs;
+	}
+
+	const ModelConfig* findModel(const std::string& name)
+	{
+		for (const ModelConfig& c : modelConfigs()) {
+			if (name == c.name) return &c;
+		}
+		return nullptr;
+	}
+
+	WeightSource::WeightSource(WeightMap& weightMap, bool random_missing)
+		: map_(weightMap), random_missing_(random_missing), missing_(0), rng_(1234)
+	{
+	}
+
+	const std::vector<float>& WeightSource::get(const std::string& name, size_t count, int fan_in)
+	{
+		auto it = map_.find(name);
+		if (it != map_.end()) {
+			if (it->second.size() != count) {
+				std::cerr << "[ERROR] weight size mismatch : " << name << " (" << it->second.size() << " != " << count << ")" << std::endl;
+			}
+			return it->second;
+		}
+		missing_++;
+		std::vector<float>& w = map_[name];
+		if (!random_missing_) {
+			std::cerr << "[ERROR] weight not found : " << name << std::endl;
+			w.assign(count, 0.f);
+			return w;
+		}
+		// BN 분산은 양수, anchor 는 픽셀 크기, 나머지는 분산 1/fan_in
+		float lo = -std::sqrt(3.f / fan_in), hi = -lo;
+		if (name.find("running_var") != std::string::npos) { lo = 0.5f; hi = 1.5f; }
+		else if (name.find("anchor_grid") != std::string::npos) { lo = 10.f; hi = 100.f; }
+		std::uniform_real_distribution<float> uni(lo, hi);
+		w.resize(count);
+		for (size_t i = 0; i < count; i++) w[i] = uni(rng_);
+		return w;
+	}
+
+	static Layer* addBatchNorm2d(Network* network, WeightSource& weights, Tensor& input, const std::string& lname, float eps)
+	{
+		const int len = input.getDimensions().d[0];
+		const std::vector<float>& gamma = weights.get(lname + ".weight", len);
+		const std::vector<float>& beta = weights.get(lname + ".bias", len);
+		const std::vector<float>& mean = weights.get(lname + ".running_mean", len);
+		const std::vector<float>& var = weights.get(lname + ".running_var", len);
+
+		std::vector<float> scale(len), shift(len), power(len, 1.f);
+		for (int i = 0; i < len; i++) {
+			scale[i] = gamma[i] / std::sqrt(var[i] + eps);
+			shift[i] = beta[i] - mean[i] * gamma[i] / std::sqrt(var[i] + eps);
+		}
+		return network->addScale(input, ScaleMode::kCHANNEL, shift, scale, power);
+	}
+
+	static Layer* addConv(Network* network, WeightSource& weights, Tensor& input, int outch, int k, const std::string& wname, const std::string& bname, int groups = 1)
+	{
+		const int inch = input.getDimensions().d[0];
+		const int fan_in = inch / groups * k * k;
+		const std::vector<float>& w = weights.get(wname, (size_t)outch * fan_in, fan_in);
+		const std::vector<float>& b = bname.empty() ? kEMPTY : weights.get(bname, outch, fan_in);
+		return network->addConvolutionNd(input, outch, DimsHW(k, k), w, b);
+	}
+
+	static Layer* addFc(Network* network, WeightSource& weights, Tensor& input, int nbOutputs, const std::string& lname)
+	{
+		const Dims d = input.getDimensions();
+		const int fan_in = d.d[d.nbDims - 3] * d.d[d.nbDims - 2] * d.d[d.nbDims - 1];
+		return network->addFullyConnected(input, nbOutputs, weights.get(lname + ".weight", (size_t)nbOutputs * fan_in, fan_in), weights.get(lname + ".bias", nbOutputs, fan_in));
+	}
+
+	/* ------ yolov5s (yolov5s.cpp) ------ */
+	namespace yolov5s
+	{
+		static const int CLASS_NUM = 80;
+		static const int MAX_OUTPUT_BBOX_COUNT = 300;
+		static const float gd = 0.33f;
+		static const float gw = 0.50f;
+
+		static int get_width(int x, float gw, int divisor = 8) {
+			return int(ceil((x * gw) / divisor)) * divisor;
+		}
+
+		static int get_depth(int x, float gd) {
+			if (x == 1) return 1;
+			int r = (int)round(x * gd);
+			if (x * gd - int(x * gd) == 0.5 && (int(x * gd) % 2) == 0) {
+				--r;
+			}
+			return std::max<int>(r, 1);
+		}
+
+		static Layer* convBlock(Network* network, WeightSource& weights, Tensor& input, int outch, int ksize, int s, int g, std::string lname) {
+			int p = ksize / 3;
+			Layer* conv1 = addConv(network, weights, input, outch, ksize, lname + ".conv.weight", "", g);
+			conv1->setStrideNd(DimsHW(s, s));
+			conv1->setPaddingNd(DimsHW(p, p));
+			conv1->setNbGroups(g);
+			Layer* bn1 = addBatchNorm2d(network, weights, *conv1->getOutput(0), lname + ".bn", 1e-3f);
+			Layer* sig = network->addActivation(*bn1->getOutput(0), ActivationType::kSIGMOID);
+			return network->addElementWise(*bn1->getOutput(0), *sig->getOutput(0), ElementWiseOperation::kPROD);
+		}
+
+		static Layer* bottleneck(Network* network, WeightSource& weights, Tensor& input, int c1, int c2, bool shortcut, int g, float e, std::string lname) {
+			Layer* cv1 = convBlock(network, weights, input, (int)((float)c2 * e), 1, 1, 1, lname + ".cv1");
+			Layer* cv2 = convBlock(network, weights, *cv1->getOutput(0), c2, 3, 1, g, lname + ".cv2");
+			if (shortcut && c1 == c2) {
+				return network->addElementWise(input, *cv2->getOutput(0), ElementWiseOperation::kSUM);
+			}
+			return cv2;
+		}
+
+		static Layer* C3(Network* network, WeightSource& weights, Tensor& input, int /*c1*/, int c2, int n, bool shortcut, int g, float e, std::string lname) {
+			int c_ = (int)((float)c2 * e);
+			Layer* cv1 = convBlock(network, weights, input, c_, 1, 1, 1, lname + ".cv1");
+			Layer* cv2 = convBlock(network, weights, input, c_, 1, 1, 1, lname + ".cv2");
+			Tensor* y1 = cv1->getOutput(0);
+			for (int i = 0; i < n; i++) {
+				Layer* b = bottleneck(network, weights, *y1, c_, c_, shortcut, g, 1.0, lname + ".m." + std::to_string(i));
+				y1 = b->getOutput(0);
+			}
+			Tensor* inputTensors[] = { y1, cv2->getOutput(0) };
+			Layer* cat = network->addConcatenation(inputTensors, 2);
+			return convBlock(network, weights, *cat->getOutput(0), c2, 1, 1, 1, lname + ".cv3");
+		}
+
+		static Layer* SPPF(Network* network, WeightSource& weights, Tensor& input, int c1, int c2, int k, std::string lname) {
+			int c_ = c1 / 2;
+			Layer* cv1 = convBlock(network, weights, input, c_, 1, 1, 1, lname + ".cv1");
+			Layer* pool1 = network->addPoolingNd(*cv1->getOutput(0), PoolingType::kMAX, DimsHW(k, k));
+			pool1->setPaddingNd(DimsHW(k / 2, k / 2));
+			pool1->setStrideNd(DimsHW(1, 1));
+			Layer* pool2 = network->addPoolingNd(*pool1->getOutput(0), PoolingType::kMAX, DimsHW(k, k));
+			pool2->setPaddingNd(DimsHW(k / 2, k / 2));
+			pool2->setStrideNd(DimsHW(1, 1));
+			Layer* pool3 = network->addPoolingNd(*pool2->getOutput(0), PoolingType::kMAX, DimsHW(k, k));
+			pool3->setPaddingNd(DimsHW(k / 2, k / 2));
+			pool3->setStrideNd(DimsHW(1, 1));
+			Tensor* inputTensors[] = { cv1->getOutput(0), pool1->getOutput(0), pool2->getOutput(0), pool3->getOutput(0) };
+			Layer* cat = network->addConcatenation(inputTensors, 4);
+			return convBlock(network, weights, *cat->getOutput(0), c2, 1, 1, 1, lname + ".cv2");
+		}
+
+		static Tensor* add_YoLoLayer(Network* network, WeightSource& weights, std::string lname, Tensor& input, int grid_stride)
+		{
+			Layer* shuffle_layer = network->addShuffle(input);
+			shuffle_layer->setReshapeDimensions(Dims4(3, CLASS_NUM + 5, input.getDimensions().d[1], input.getDimensions().d[2]));
+			shuffle_layer->setSecondTranspose(Permutation{ { 0, 2, 3, 1 } });
+			Layer* sigmoid_layer = network->addActivation(*shuffle_layer->getOutput(0), ActivationType::kSIGMOID);
+			Tensor* anchor_grid = network->addConstant(Dims2(3, 2), weights.get(lname, 6))->getOutput(0);
+			YololayerParam yololayer_vs{ 3, input.getDimensions().d[1], input.getDimensions().d[2], CLASS_NUM, grid_stride };
+			Layer* plugin_layer0 = network->addYololayer(*sigmoid_layer->getOutput(0), *anchor_grid, yololayer_vs);
+			return plugin_layer0->getOutput(0);
+		}
+
+		static void build(Network* network, WeightSource& weights, int maxBatchSize, const ModelConfig& cfg)
+		{
+			Tensor* data = network->addInput(cfg.input_name, DataType::kFLOAT, Dims3(cfg.input_h, cfg.input_w, cfg.input_c));
+			PreprocessParam preprocess{ maxBatchSize, cfg.input_c, cfg.input_h, cfg.input_w, 0, { 0.f, 0.f, 0.f }, { 1.f, 1.f, 1.f } };
+			Layer* preprocess_layer = network->addPreprocess(*data, preprocess);
+			preprocess_layer->setName("preprocess_layer");
+			Tensor* prep = preprocess_layer->getOutput(0);
+
+			Layer* conv0 = convBlock(network, weights, *prep, get_width(64, gw), 6, 2, 1, "model.0");
+			Layer* conv1 = convBlock(network, weights, *conv0->getOutput(0), get_width(128, gw), 3, 2, 1, "model.1");
+			Layer* bottleneck_CSP2 = C3(network, weights, *conv1->getOutput(0), get_width(128, gw), get_width(128, gw), get_depth(3, gd), true, 1, 0.5, "model.2");
+			Layer* conv3 = convBlock(network, weights, *bottleneck_CSP2->getOutput(0), get_width(256, gw), 3, 2, 1, "model.3");
+			Layer* bottleneck_csp4 = C3(network, weights, *conv3->getOutput(0), get_width(256, gw), get_width(256, gw), get_depth(6, gd), true, 1, 0.5, "model.4");
+			Layer* conv5 = convBlock(network, weights, *bottleneck_csp4->getOutput(0), get_width(512, gw), 3, 2, 1, "model.5");
+			Layer* bottleneck_csp6 = C3(network, weights, *conv5->getOutput(0), get_width(512, gw), get_width(512, gw), get_depth(9, gd), true, 1, 0.5, "model.6");
+			Layer* conv7 = convBlock(network, weights, *bottleneck_csp6->getOutput(0), get_width(1024, gw), 3, 2, 1, "model.7");
+			Layer* bottleneck_csp8 = C3(network, weights, *conv7->getOutput(0), get_width(1024, gw), get_width(1024, gw), get_depth(3, gd), true, 1, 0.5, "model.8");
+			Layer* spp9 = SPPF(network, weights, *bottleneck_csp8->getOutput(0), get_width(1024, gw), get_width(1024, gw), 5, "model.9");
+			/* ------ yolov5 head ------ */
+			Layer* conv10 = convBlock(network, weights, *spp9->getOutput(0), get_width(512, gw), 1, 1, 1, "model.10");
+
+			Layer* upsample11 = network->addResize(*conv10->getOutput(0));
+			upsample11->setResizeMode(ResizeMode::kNEAREST);
+			upsample11->setOutputDimensions(bottleneck_csp6->getOutput(0)->getDimensions());
+
+			Tensor* inputTensors12[] = { upsample11->getOutput(0), bottleneck_csp6->getOutput(0) };
+			Layer* cat12 = network->addConcatenation(inputTensors12, 2);
+			Layer* bottleneck_csp13 = C3(network, weights, *cat12->getOutput(0), get_width(1024, gw), get_width(512, gw), get_depth(3, gd), false, 1, 0.5, "model.13");
+			Layer* conv14 = convBlock(network, weights, *bottleneck_csp13->getOutput(0), get_width(256, gw), 1, 1, 1, "model.14");
+
+			Layer* upsample15 = network->addResize(*conv14->getOutput(0));
+			upsample15->setResizeMode(ResizeMode::kNEAREST);
+			upsample15->setOutputDimensions(bottleneck_csp4->getOutput(0)->getDimensions());
+
+			Tensor* inputTensors16[] = { upsample15->getOutput(0), bottleneck_csp4->getOutput(0) };
+			Layer* cat16 = network->addConcatenation(inputTensors16, 2);
+			Layer* bottleneck_csp17 = C3(network, weights, *cat16->getOutput(0), get_width(512, gw), get_width(256, gw), get_depth(3, gd), false, 1, 0.5, "model.17");
+
+			Layer* conv18 = convBlock(network, weights, *bottleneck_csp17->getOutput(0), get_width(256, gw), 3, 2, 1, "model.18");
+			Tensor* inputTensors19[] = { conv18->getOutput(0), conv14->getOutput(0) };
+			Layer* cat19 = network->addConcatenation(inputTensors19, 2);
+			Layer* bottleneck_csp20 = C3(network, weights, *cat19->getOutput(0), get_width(512, gw), get_width(512, gw), get_depth(3, gd), false, 1, 0.5, "model.20");
+
+			Layer* conv21 = convBlock(network, weights, *bottleneck_csp20->getOutput(0), get_width(512, gw), 3, 2, 1, "model.21");
+			Tensor* inputTensors22[] = { conv21->getOutput(0), conv10->getOutput(0) };
+			Layer* cat22 = network->addConcatenation(inputTensors22, 2);
+			Layer* bottleneck_csp23 = C3(network, weights, *cat22->getOutput(0), get_width(1024, gw), get_width(1024, gw), get_depth(3, gd), false, 1, 0.5, "model.23");
+
+			/* ------ detect ------ */
+			Layer* det0 = addConv(network, weights, *bottleneck_csp17->getOutput(0), 3 * (CLASS_NUM + 5), 1, "model.24.m.0.weight", "model.24.m.0.bias");
+			Layer* det1 = addConv(network, weights, *bottleneck_csp20->getOutput(0), 3 * (CLASS_NUM + 5), 1, "model.24.m.1.weight", "model.24.m.1.bias");
+			Layer* det2 = addConv(network, weights, *bottleneck_csp23->getOutput(0), 3 * (CLASS_NUM + 5), 1, "model.24.m.2.weight", "model.24.m.2.bias");
+
+			Tensor* yolo_t0 = add_YoLoLayer(network, weights, "model.24.anchor_grid0", *(det0->getOutput(0)), 8);
+			Tensor* yolo_t1 = add_YoLoLayer(network, weights, "model.24.anchor_grid1", *(det1->getOutput(0)), 16);
+			Tensor* yolo_t2 = add_YoLoLayer(network, weights, "model.24.anchor_grid2", *(det2->getOutput(0)), 32);
+
+			Tensor* yolo_ts[] = { yolo_t0, yolo_t1, yolo_t2 };
+			Layer* concat_layer = network->addConcatenation(yolo_ts, 3);
+
+			Layer* slice_layer = network->addSlice(*concat_layer->getOutput(0), Dims2(0, 4), Dims2(concat_layer->getOutput(0)->getDimensions().d[0], 1), Dims2(1, 1));
+			Layer* sort_layer = network->addTopK(*slice_layer->getOutput(0), TopKOperation::kMAX, MAX_OUTPUT_BBOX_COUNT, 1 << 0);
+			Layer* shuffle_layer = network->addShuffle(*sort_layer->getOutput(1));
+			Dims dims_shape{}; dims_shape.nbDims = 1; dims_shape.d[0] = MAX_OUTPUT_BBOX_COUNT;
+			shuffle_layer->setReshapeDimensions(dims_shape);
+			Layer* gather_layer = network->addGather(*concat_layer->getOutput(0), *shuffle_layer->getOutput(0), 0);
+			Tensor* final_out = gather_layer->getOutput(0);
+			final_out->setName("prob");
+			network->markOutput(*final_out);
+		}
+	}
+
+	/* ------ resnet18 (resnet18.cpp) ------ */
+	namespace resnet18
+	{
+		static Layer* basicBlock(Network* network, WeightSource& weights, Tensor& input, int inch, int outch, int stride, std::string lname) {
+			Layer* conv1 = addConv(network, weights, input, outch, 3, lname + "conv1.weight", "");
+			conv1->setStrideNd(DimsHW(stride, stride));
+			conv1->setPaddingNd(DimsHW(1, 1));
+			Layer* bn1 = addBatchNorm2d(network, weights, *conv1->getOutput(0), lname + "bn1", 1e-5f);
+			Layer* relu1 = network->addActivation(*bn1->getOutput(0), ActivationType::kRELU);
+			Layer* conv2 = addConv(network, weights, *relu1->getOutput(0), outch, 3, lname + "conv2.weight", "");
+			conv2->setPaddingNd(DimsHW(1, 1));
+			Layer* bn2 = addBatchNorm2d(network, weights, *conv2->getOutput(0), lname + "bn2", 1e-5f);
+			Layer* ew1;
+			if (inch != outch) {
+				Layer* conv3 = addConv(network, weights, input, outch, 1, lname + "downsample.0.weight", "");
+				conv3->setStrideNd(DimsHW(stride, stride));
+				Layer* bn3 = addBatchNorm2d(network, weights, *conv3->getOutput(0), lname + "downsample.1", 1e-5f);
+				ew1 = network->addElementWise(*bn3->getOutput(0), *bn2->getOutput(0), ElementWiseOperation::kSUM);
+			}
+			else {
+				ew1 = network->addElementWise(input, *bn2->getOutput(0), ElementWiseOperation::kSUM);
+			}
+			return network->addActivation(*ew1->getOutput(0), ActivationType::kRELU);
+		}
+
+		static void build(Network* network, WeightSource& weights, int maxBatchSize, const ModelConfig& cfg)
+		{
+			Tensor* data = network->addInput(cfg.input_name, DataType::kFLOAT, Dims3(cfg.input_h, cfg.input_w, cfg.input_c));
+			PreprocessParam preprocess{ maxBatchSize, cfg.input_c, cfg.input_h, cfg.input_w, 0, { 0.f, 0.f, 0.f }, { 1.f, 1.f, 1.f } };
+			Layer* preprocess_layer = network->addPreprocess(*data, preprocess);
+			preprocess_layer->setName("preprocess_layer");
+			Tensor* prep = preprocess_layer->getOutput(0);
+
+			Layer* conv1 = addConv(network, weights, *prep, 64, 7, "conv1.weight", "");
+			conv1->setStrideNd(DimsHW(2, 2));
+			conv1->setPaddingNd(DimsHW(3, 3));
+			Layer* bn1 = addBatchNorm2d(network, weights, *conv1->getOutput(0), "bn1", 1e-5f);
+			Layer* relu1 = network->addActivation(*bn1->getOutput(0), ActivationType::kRELU);
+			Layer* pool1 = network->addPoolingNd(*relu1->getOutput(0), PoolingType::kMAX, DimsHW(3, 3));
+			pool1->setStrideNd(DimsHW(2, 2));
+			pool1->setPaddingNd(DimsHW(1, 1));
+
+			Layer* relu2 = basicBlock(network, weights, *pool1->getOutput(0), 64, 64, 1, "layer1.0.");
+			Layer* relu3 = basicBlock(network, weights, *relu2->getOutput(0), 64, 64, 1, "layer1.1.");
+			Layer* relu4 = basicBlock(network, weights, *relu3->getOutput(0), 64, 128, 2, "layer2.0.");
+			Layer* relu5 = basicBlock(network, weights, *relu4->getOutput(0), 128, 128, 1, "layer2.1.");
+			Layer* relu6 = basicBlock(network, weights, *relu5->getOutput(0), 128, 256, 2, "layer3.0.");
+			Layer* relu7 = basicBlock(network, weights, *relu6->getOutput(0), 256, 256, 1, "layer3.1.");
+			Layer* relu8 = basicBlock(network, weights, *relu7->getOutput(0), 256, 512, 2, "layer4.0.");
+			Layer* relu9 = basicBlock(network, weights, *relu8->getOutput(0), 512, 512, 1, "layer4.1.");
+
+			Layer* pool2 = network->addPoolingNd(*relu9->getOutput(0), PoolingType::kAVERAGE, DimsHW(7, 7));
+			pool2->setStrideNd(DimsHW(1, 1));
+			Layer* fc1 = addFc(network, weights, *pool2->getOutput(0), 1000, "fc");
+			fc1->getOutput(0)->setName("prob");
+			network->markOutput(*fc1->getOutput(0));
+		}
+	}
+
+	/* ------ vgg11 (vgg11.cpp) ------ */
+	namespace vgg11
+	{
+		static void build(Network* network, WeightSource& weights, int maxBatchSize, const ModelConfig& cfg)
+		{
+			Tensor* data = network->addInput(cfg.input_name, DataType::kFLOAT, Dims3(cfg.input_h, cfg.input_w, cfg.input_c));
+			PreprocessParam preprocess{ maxBatchSize, cfg.input_c, cfg.input_h, cfg.input_w, 0, { 0.f, 0.f, 0.f }, { 1.f, 1.f, 1.f } };
+			Layer* preprocess_layer = network->addPreprocess(*data, preprocess);
+			preprocess_layer->setName("preprocess_layer");
+			Tensor* x = preprocess_layer->getOutput(0);
+
+			// features.N : conv(3x3, pad 1) + relu, 'M' : maxpool 2x2 s2
+			const int cfg_ch[] = { 64, -1, 128, -1, 256, 256, -1, 512, 512, -1, 512, 512, -1 };
+			int index = 0;
+			for (int ch : cfg_ch) {
+				if (ch < 0) {
+					Layer* pool1 = network->addPoolingNd(*x, PoolingType::kMAX, DimsHW(2, 2));
+					pool1->setStrideNd(DimsHW(2, 2));
+					x = pool1->getOutput(0);
+					index += 1;
+				}
+				else {
+					const std::string lname = "features." + std::to_string(index);
+					Layer* conv1 = addConv(network, weights, *x, ch, 3, lname + ".weight", lname + ".bias");
+					conv1->setPaddingNd(DimsHW(1, 1));
+					Layer* relu1 = network->addActivation(*conv1->getOutput(0), ActivationType::kRELU);
+					x = relu1->getOutput(0);
+					index += 2;
+				}
+			}
+			Layer* fc1 = addFc(network, weights, *x, 4096, "classifier.0");
+			Layer* relu1 = network->addActivation(*fc1->getOutput(0), ActivationType::kRELU);
+			fc1 = addFc(network, weights, *relu1->getOutput(0), 4096, "classifier.3");
+			relu1 = network->addActivation(*fc1->getOutput(0), ActivationType::kRELU);
+			fc1 = addFc(network, weights, *relu1->getOutput(0), 1000, "classifier.6");
+			fc1->getOutput(0)->setName("prob");
+			network->markOutput(*fc1->getOutput(0));
+		}
+	}
+
+	/* ------ unet (unet.cpp) ------ */
+	namespace unet
+	{
+		static const int class_count = 2;
+
+		static Layer* doubleConv(Network* network, WeightSource& weights, Tensor& input, int outch, int ksize, std::string lname, int midch) {
+			Layer* conv1 = addConv(network, weights, input, midch, ksize, lname + ".double_conv.0.weight", lname + ".double_conv.0.bias");
+			conv1->setStrideNd(DimsHW(1, 1));
+			conv1->setPaddingNd(DimsHW(1, 1));
+			conv1->setNbGroups(1);
+			Layer* bn1 = addBatchNorm2d(network, weights, *conv1->getOutput(0), lname + ".double_conv.1", 1E-05f);
+			Layer* relu1 = network->addActivation(*bn1->getOutput(0), ActivationType::kRELU);
+			Layer* conv2 = addConv(network, weights, *relu1->getOutput(0), outch, 3, lname + ".double_conv.3.weight", lname + ".double_conv.3.bias");
+			conv2->setStrideNd(DimsHW(1, 1));
+			conv2->setPaddingNd(DimsHW(1, 1));
+			conv2->setNbGroups(1);
+			Layer* bn2 = addBatchNorm2d(network, weights, *conv2->getOutput(0), lname + ".double_conv.4", 1E-05f);
+			return network->addActivation(*bn2->getOutput(0), ActivationType::kRELU);
+		}
+
+		static Layer* down(Network* network, WeightSource& weights, Tensor& input, int outch, std::string lname) {
+			Layer* pool1 = network->addPoolingNd(input, PoolingType::kMAX, DimsHW(2, 2));
+			return doubleConv(network, weights, *pool1->getOutput(0), outch, 3, lname + ".maxpool_conv.1", outch);
+		}
+
+		static Layer* up(Network* network, WeightSource& weights, Tensor& input1, Tensor& input2, int outch, int midch, std::string lname) {
+			Layer* resize = network->addResize(input1);
+			std::vector<float> scale{ 1.f, 2, 2 };
+			resize->setScales(scale.data(), (int)scale.size());
+			resize->setAlignCorners(true);
+			resize->setResizeMode(ResizeMode::kLINEAR);
+			Tensor* upsampleTensor = resize->getOutput(0);
+
+			int diffx = input2.getDimensions().d[1] - upsampleTensor->getDimensions().d[1];
+			int diffy = input2.getDimensions().d[2] - upsampleTensor->getDimensions().d[2];
+			Layer* pad1 = network->addPaddingNd(*upsampleTensor, DimsHW(diffx / 2, diffy / 2), DimsHW(diffx - (diffx / 2), diffy - (diffy / 2)));
+			Tensor* inputTensors[] = { &input2, pad1->getOutput(0) };
+			Layer* cat = network->addConcatenation(inputTensors, 2);
+			if (midch == 64) {
+				return doubleConv(network, weights, *cat->getOutput(0), outch, 3, lname + ".conv", outch);
+			}
+			return doubleConv(network, weights, *cat->getOutput(0), outch / 2, 3, lname + ".conv", outch);
+		}
+
+		static void build(Network* network, WeightSource& weights, int maxBatchSize, const ModelConfig& cfg)
+		{
+			Tensor* data = network->addInput(cfg.input_name, DataType::kFLOAT, Dims3(3, cfg.input_h, cfg.input_w));
+			PreprocessParam preprocess{ maxBatchSize, cfg.input_c, cfg.input_h, cfg.input_w, 0, { 0.f, 0.f, 0.f }, { 1.f, 1.f, 1.f } };
+			Layer* preprocess_layer = network->addPreprocess(*data, preprocess);
+			preprocess_layer->setName("[preprocess_layer]");
+
+			Layer* x1 = doubleConv(network, weights, *preprocess_layer->getOutput(0), 64, 3, "inc", 64);
+			Layer* x2 = down(network, weights, *x1->getOutput(0), 128, "down1");
+			Layer* x3 = down(network, weights, *x2->getOutput(0), 256, "down2");
+			Layer* x4 = down(network, weights, *x3->getOutput(0), 512, "down3");
+			Layer* x5 = down(network, weights, *x4->getOutput(0), 512, "down4");
+			Layer* x6 = up(network, weights, *x5->getOutput(0), *x4->getOutput(0), 512, 512, "up1");
+			Layer* x7 = up(network, weights, *x6->getOutput(0), *x3->getOutput(0), 256, 256, "up2");
+			Layer* x8 = up(network, weights, *x7->getOutput(0), *x2->getOutput(0), 128, 128, "up3");
+			Layer* x9 = up(network, weights, *x8->getOutput(0), *x1->getOutput(0), 64, 64, "up4");
+
+			Layer* x10 = addConv(network, weights, *x9->getOutput(0), class_count, 1, "outc.conv.weight", "outc.conv.bias");
+			x10->setStrideNd(DimsHW(1, 1));
+			x10->setPaddingNd(DimsHW(0, 0));
+			x10->setNbGroups(1);
+			x10->setName("[last_layer]");
+			x10->getOutput(0)->setName("prob");
+			network->markOutput(*x10->getOutput(0));
+		}
+	}
+
+	/* ------ detr (detr_trt.cpp, R50 backbone) ------ */
+	namespace detr
+	{
+		static const float SCALING = 0.17677669529663687f;
+		static const float EPS = 0.00001f;
+		static const int D_MODEL = 256;
+		static const int NHEAD = 8;
+		static const int DIM_FEEDFORWARD = 2048;
+		static const int NUM_ENCODE_LAYERS = 6;
+		static const int NUM_DECODE_LAYERS = 6;
+		static const int NUM_QUERIES = 100;
+		static const int NUM_CLASS = 92;  // include background
+		static const int R50_BLOCKS[] = { 3, 4, 6, 3 };
+
+		static Layer* BasicStem(Network* network, WeightSource& weights, const std::string& lname, Tensor& input, int out_channels) {
+			Layer* conv1 = addConv(network, weights, input, out_channels, 7, lname + ".conv1.weight", "");
+			conv1->setStrideNd(DimsHW(2, 2));
+			conv1->setPaddingNd(DimsHW(3, 3));
+			Layer* bn1 = addBatchNorm2d(network, weights, *conv1->getOutput(0), lname + ".bn1", 1e-5f);
+			Layer* r1 = network->addActivation(*bn1->getOutput(0), ActivationType::kRELU);
+			Layer* max_pool2d = network->addPoolingNd(*r1->getOutput(0), PoolingType::kMAX, DimsHW(3, 3));
+			max_pool2d->setStrideNd(DimsHW(2, 2));
+			max_pool2d->setPaddingNd(DimsHW(1, 1));
+			return max_pool2d;
+		}
+
+		static Tensor* BottleneckBlock(Network* network, WeightSource& weights, const std::string& lname, Tensor& input, int in_channels, int bottleneck_channels, int out_channels, int stride, int dilation) {
+			Layer* conv1 = addConv(network, weights, input, bottleneck_channels, 1, lname + ".conv1.weight", "");
+			conv1->setStrideNd(DimsHW(1, 1));
+			Layer* bn1 = addBatchNorm2d(network, weights, *conv1->getOutput(0), lname + ".bn1", 1e-5f);
+			Layer* r1 = network->addActivation(*bn1->getOutput(0), ActivationType::kRELU);
+
+			Layer* conv2 = addConv(network, weights, *r1->getOutput(0), bottleneck_channels, 3, lname + ".conv2.weight", "");
+			conv2->setStrideNd(DimsHW(stride, stride));
+			conv2->setPaddingNd(DimsHW(1 * dilation, 1 * dilation));
+			conv2->setDilationNd(DimsHW(dilation, dilation));
+			Layer* bn2 = addBatchNorm2d(network, weights, *conv2->getOutput(0), lname + ".bn2", 1e-5f);
+			Layer* r2 = network->addActivation(*bn2->getOutput(0), ActivationType::kRELU);
+
+			Layer* conv3 = addConv(network, weights, *r2->getOutput(0), out_channels, 1, lname + ".conv3.weight", "");
+			conv3->setStrideNd(DimsHW(1, 1));
+			Layer* bn3 = addBatchNorm2d(network, weights, *conv3->getOutput(0), lname + ".bn3", 1e-5f);
+
+			Tensor* shortcut_value = nullptr;
+			if (in_channels != out_channels) {
+				Layer* shortcut = addConv(network, weights, input, out_channels, 1, lname + ".downsample.0.weight", "");
+				shortcut->setStrideNd(DimsHW(stride, stride));
+				Layer* shortcut_bn = addBatchNorm2d(network, weights, *shortcut->getOutput(0), lname + ".downsample.1", 1e-5f);
+				shortcut_value = shortcut_bn->getOutput(0);
+			}
+			else {
+				shortcut_value = &input;
+			}
+			Layer* ew = network->addElementWise(*bn3->getOutput(0), *shortcut_value, ElementWiseOperation::kSUM);
+			return network->addActivation(*ew->getOutput(0), ActivationType::kRELU)->getOutput(0);
+		}
+
+		static Tensor* BuildResNet(Network* network, WeightSource& weights, Tensor& input, int stem_out_channels, int bottleneck_channels, int res2_out_channels) {
+			int out_channels = res2_out_channels;
+			Tensor* out = BasicStem(network, weights, "backbone.0.body", input, stem_out_channels)->getOutput(0);
+			for (int i = 0; i < 4; i++) {
+				int first_stride = i == 0 ? 1 : 2;
+				int in_channels = stem_out_channels;
+				for (int b = 0; b < R50_BLOCKS[i]; b++) {
+					std::string layerName = "backbone.0.body.layer" + std::to_string(i + 1) + "." + std::to_string(b);
+					out = BottleneckBlock(network, weights, layerName, *out, in_channels, bottleneck_channels, out_channels, b == 0 ? first_stride : 1, 1);
+					in_channels = out_channels;
+				}
+				stem_out_channels = out_channels;
+				bottleneck_channels *= 2;
+				out_channels *= 2;
+			}
+			return out;
+		}
+
+		// 위치 임베딩 (입력과 무관한 상수 [h * w, 2 * num_pos_feats, 1, 1])
+		static Tensor* PositionEmbeddingSine(Network* network, Tensor& input, int num_pos_feats, int temperature) {
+			Dims mask_dim = input.getDimensions();
+			int h = mask_dim.d[1], w = mask_dim.d[2];
+			float eps = 1e-6f, scale = 6.2831853071f;
+			std::vector<float> dim_t(num_pos_feats, 0);
+			for (int i = 0; i < num_pos_feats; i++) {
+				dim_t[i] = (float)pow(temperature, (2 * (i / 2) / static_cast<float>(num_pos_feats)));
+			}
+			std::vector<float> pval((size_t)h * w * num_pos_feats * 2);
+			float* pNext = pval.data();
+			for (int i = 0; i < h; i++) {
+				for (int j = 0; j < w; j++) {
+					const float y_embed = (i + 1) / (h + eps) * scale;
+					const float x_embed = (j + 1) / (w + eps) * scale;
+					for (int k = 0; k < num_pos_feats; k++) {
+						*pNext++ = (k & 1) ? std::cos(y_embed / dim_t[k]) : std::sin(y_embed / dim_t[k]);
+					}
+					for (int k = 0; k < num_pos_feats; k++) {
+						*pNext++ = (k & 1) ? std::cos(x_embed / dim_t[k]) : std::sin(x_embed / dim_t[k]);
+					}
+				}
+			}
+			return network->addConstant(Dims4(h * w, num_pos_feats * 2, 1, 1), pval)->getOutput(0);
+		}
+
+		static std::vector<float> concat(const std::vector<float>& a, const std::vector<float>& b) {
+			std::vector<float> c(a);
+			c.insert(c.end(), b.begin(), b.end());
+			return c;
+		}
+
+		// fuse_qk 이고 query, key 가 같은 텐서면 (self-attention) q, k projection 을 출력 2 * embed_dim 인 fully connected 하나로
+		static Tensor* MultiHeadAttention(Network* network, WeightSource& weights, const std::string& lname, Tensor& query, Tensor& key, Tensor& value, bool fuse_qk, int embed_dim = 256, int num_heads = 8) {
+			int tgt_len = query.getDimensions().d[0];
+			int head_dim = embed_dim / num_heads;
+			const size_t w_count = (size_t)embed_dim * embed_dim;
+
+			Tensor* q_proj;
+			Tensor* k_proj;
+			const std::vector<float>& w_q = weights.get(lname + ".in_proj_weight_q", w_count, embed_dim);
+			const std::vector<float>& b_q = weights.get(lname + ".in_proj_bias_q", embed_dim, embed_dim);
+			const std::vector<float>& w_k = weights.get(lname + ".in_proj_weight_k", w_count, embed_dim);
+			const std::vector<float>& b_k = weights.get(lname + ".in_proj_bias_k", embed_dim, embed_dim);
+			if (fuse_qk && &query == &key) {
+				Layer* linear_qk = network->addFullyConnected(query, 2 * embed_dim, concat(w_q, w_k), concat(b_q, b_k));
+				q_proj = network->addSlice(*linear_qk->getOutput(0), Dims4(0, 0, 0, 0), Dims4(tgt_len, embed_dim, 1, 1), Dims4(1, 1, 1, 1))->getOutput(0);
+				k_proj = network->addSlice(*linear_qk->getOutput(0), Dims4(0, embed_dim, 0, 0), Dims4(tgt_len, embed_dim, 1, 1), Dims4(1, 1, 1, 1))->getOutput(0);
+			}
+			else {
+				q_proj = network->addFullyConnected(query, embed_dim, w_q, b_q)->getOutput(0);
+				k_proj = network->addFullyConnected(key, embed_dim, w_k, b_k)->getOutput(0);
+			}
+			Layer* linear_v = network->addFullyConnected(value, embed_dim, weights.get(lname + ".in_proj_weight_v", w_count, embed_dim), weights.get(lname + ".in_proj_bias_v", embed_dim, embed_dim));
+			Layer* scaling_t = network->addConstant(Dims4(1, 1, 1, 1), { SCALING });
+			Layer* q_scaling = network->addElementWise(*q_proj, *scaling_t->getOutput(0), ElementWiseOperation::kPROD);
+
+			Layer* q_shuffle = network->addShuffle(*q_scaling->getOutput(0));
+			q_shuffle->setName((lname + ".q_shuffle").c_str());
+			q_shuffle->setReshapeDimensions(Dims3(-1, num_heads, head_dim));
+			q_shuffle->setSecondTranspose(Permutation{ { 1, 0, 2 } });
+
+			Layer* k_shuffle = network->addShuffle(*k_proj);
+			k_shuffle->setName((lname + ".k_shuffle").c_str());
+			k_shuffle->setReshapeDimensions(Dims3(-1, num_heads, head_dim));
+			k_shuffle->setSecondTranspose(Permutation{ { 1, 0, 2 } });
+
+			Layer* v_shuffle = network->addShuffle(*linear_v->getOutput(0));
+			v_shuffle->setName((lname + ".v_shuffle").c_str());
+			v_shuffle->setReshapeDimensions(Dims3(-1, num_heads, head_dim));
+			v_shuffle->setSecondTranspose(Permutation{ { 1, 0, 2 } });
+
+			Layer* q_product_k = network->addMatrixMultiply(*q_shuffle->getOutput(0), MatrixOperation::kNONE, *k_shuffle->getOutput(0), MatrixOperation::kTRANSPOSE);
+			Layer* softmax = network->addSoftMax(*q_product_k->getOutput(0));
+			softmax->setAxes(4);
+			Layer* attn_product_v = network->addMatrixMultiply(*softmax->getOutput(0), MatrixOperation::kNONE, *v_shuffle->getOutput(0), MatrixOperation::kNONE);
+
+			Layer* attn_shuffle = network->addShuffle(*attn_product_v->getOutput(0));
+			attn_shuffle->setName((lname + ".attn_shuffle").c_str());
+			attn_shuffle->setFirstTranspose(Permutation{ { 1, 0, 2 } });
+			attn_shuffle->setReshapeDimensions(Dims4(tgt_len, -1, 1, 1));
+
+			Layer* linear_attn = network->addFullyConnected(*attn_shuffle->getOutput(0), embed_dim, weights.get(lname + ".out_proj.weight", w_count, embed_dim), weights.get(lname + ".out_proj.bias", embed_dim, embed_dim));
+			return linear_attn->getOutput(0);
+		}
+
+		static Tensor* LayerNorm(Network* network, Tensor& input, WeightSource& weights, const std::string& lname, int d_model = 256) {
+			Layer* mean = network->addReduce(input, ReduceOperation::kAVG, 2, true);
+			Layer* sub_mean = network->addElementWise(input, *mean->getOutput(0), ElementWiseOperation::kSUB);
+			Layer* pow2 = network->addScaleNd(*sub_mean->getOutput(0), ScaleMode::kUNIFORM, { 0.f }, { 1.f }, { 2.f }, 0);
+			Layer* pow_mean = network->addReduce(*pow2->getOutput(0), ReduceOperation::kAVG, 2, true);
+			Layer* eps = network->addConstant(Dims4(1, 1, 1, 1), { EPS });
+			Layer* add_eps = network->addElementWise(*pow_mean->getOutput(0), *eps->getOutput(0), ElementWiseOperation::kSUM);
+			Layer* sqrt = network->addUnary(*add_eps->getOutput(0), UnaryOperation::kSQRT);
+			Layer* div = network->addElementWise(*sub_mean->getOutput(0), *sqrt->getOutput(0), ElementWiseOperation::kDIV);
+			std::vector<float> norm1_power(d_model, 1.f);
+			Layer* affine = network->addScaleNd(*div->getOutput(0), ScaleMode::kCHANNEL, weights.get(lname + ".bias", d_model), weights.get(lname + ".weight", d_model), norm1_power, 1);
+			return affine->getOutput(0);
+		}
+
+		static Tensor* FeedForward(Network* network, WeightSource& weights, const std::string& lname, Tensor& input, int d_model, int dim_feedforward) {
+			Layer* linear1 = addFc(network, weights, input, dim_feedforward, lname + ".linear1");
+			Layer* relu = network->addActivation(*linear1->getOutput(0), ActivationType::kRELU);
+			Layer* linear2 = addFc(network, weights, *relu->getOutput(0), d_model, lname + ".linear2");
+			return linear2->getOutput(0);
+		}
+
+		static Tensor* TransformerEncoderLayer(Network* network, WeightSource& weights, const std::string& lname, Tensor& src, Tensor& pos, bool simplify) {
+			Layer* pos_embed = network->addElementWise(src, pos, ElementWiseOperation::kSUM);
+			Tensor* src2 = MultiHeadAttention(network, weights, lname + ".self_attn", *pos_embed->getOutput(0), *pos_embed->getOutput(0), src, simplify, D_MODEL, NHEAD);
+			Layer* shortcut1 = network->addElementWise(*src2, src, ElementWiseOperation::kSUM);
+			Tensor* norm1 = LayerNorm(network, *shortcut1->getOutput(0), weights, lname + ".norm1");
+			Tensor* linear2 = FeedForward(network, weights, lname, *norm1, D_MODEL, DIM_FEEDFORWARD);
+			Layer* shortcut2 = network->addElementWise(*norm1, *linear2, ElementWiseOperation::kSUM);
+			return LayerNorm(network, *shortcut2->getOutput(0), weights, lname + ".norm2");
+		}
+
+		// tgt 가 0 인 첫 decoder 레이어의 self-attention 블록 출력 (norm1) 을 build 시점에 계산
+		// v = 0 * W_v + b_v 로 모든 행이 같아서 softmax 가중치와 무관하게 attention 출력은 b_v, 결과는 norm1(out_proj(b_v)) 의 반복
+		static Tensor* ZeroTargetSelfAttention(Network* network, WeightSource& weights, const std::string& lname, int num_queries) {
+			const size_t w_count = (size_t)D_MODEL * D_MODEL;
+			const std::vector<float>& bias_v = weights.get(lname + ".self_attn.in_proj_bias_v", D_MODEL, D_MODEL);
+			const std::vector<float>& out_w = weights.get(lname + ".self_attn.out_proj.weight", w_count, D_MODEL);
+			const std::vector<float>& out_b = weights.get(lname + ".self_attn.out_proj.bias", D_MODEL, D_MODEL);
+			const std::vector<float>& beta = weights.get(lname + ".norm1.bias", D_MODEL);
+			const std::vector<float>& gamma = weights.get(lname + ".norm1.weight", D_MODEL);
+
+			std::vector<double> row(D_MODEL);
+			double mean = 0.0, var = 0.0;
+			for (int o = 0; o < D_MODEL; o++) {
+				double acc = out_b[o];
+				for (int i = 0; i < D_MODEL; i++) acc += (double)out_w[(size_t)o * D_MODEL + i] * bias_v[i];
+				row[o] = acc;
+				mean += acc / D_MODEL;
+			}
+			for (int o = 0; o < D_MODEL; o++) var += (row[o] - mean) * (row[o] - mean) / D_MODEL;
+			std::vector<float> norm1((size_t)num_queries * D_MODEL);
+			for (int q = 0; q < num_queries; q++) {
+				for (int o = 0; o < D_MODEL; o++) norm1[(size_t)q * D_MODEL + o] = (float)((row[o] - mean) / std::sqrt(var + EPS) * gamma[o] + beta[o]);
+			}
+			return network->addConstant(Dims4(num_queries, D_MODEL, 1, 1), norm1)->getOutput(0);
+		}
+
+		// tgt 가 nullptr 이면 0 (첫 decoder 레이어), key_embed 는 memory + pos
+		static Tensor* TransformerDecoderLayer(Network* network, WeightSource& weights, const std::string& lname, Tensor* tgt, Tensor& memory, Tensor& key_embed, Tensor& query_pos, bool simplify) {
+			Tensor* norm1;
+			if (tgt) {
+				Layer* pos_embed = network->addElementWise(*tgt, query_pos, ElementWiseOperation::kSUM);
+				Tensor* tgt2 = MultiHeadAttention(network, weights, lname + ".self_attn", *pos_embed->getOutput(0), *pos_embed->getOutput(0), *tgt, simplify);
+				Layer* shortcut1 = network->addElementWise(*tgt, *tgt2, ElementWiseOperation::kSUM);
+				norm1 = LayerNorm(network, *shortcut1->getOutput(0), weights, lname + ".norm1");
+			}
+			else {
+				norm1 = ZeroTargetSelfAttention(network, weights, lname, query_pos.getDimensions().d[0]);
+			}
+
+			Layer* query_embed = network->addElementWise(*norm1, query_pos, ElementWiseOperation::kSUM);
+			Tensor* mha2 = MultiHeadAttention(network, weights, lname + ".multihead_attn", *query_embed->getOutput(0), key_embed, memory, simplify);
+			Layer* shortcut2 = network->addElementWise(*norm1, *mha2, ElementWiseOperation::kSUM);
+			Tensor* norm2 = LayerNorm(network, *shortcut2->getOutput(0), weights, lname + ".norm2");
+
+			Tensor* linear2 = FeedForward(network, weights, lname, *norm2, D_MODEL, DIM_FEEDFORWARD);
+			Layer* shortcut3 = network->addElementWise(*norm2, *linear2, ElementWiseOperation::kSUM);
+			return LayerNorm(network, *shortcut3->getOutput(0), weights, lname + ".norm3");
+		}
+
+		// exits : 중간 출력을 꺼낼 decoder 레이어, intermediate 에 decoder.norm 을 적용한 결과를 같은 순서로 추가
+		static Tensor* Transformer(Network* network, WeightSource& weights, const std::string& lname, Tensor& src, Tensor& pos_embed, bool simplify,
+			const std::vector<int>& exits, std::vector<Tensor*>& intermediate) {
+			Tensor* memory = &src;
+			for (int i = 0; i < NUM_ENCODE_LAYERS; i++) {
+				memory = TransformerEncoderLayer(network, weights, lname + ".encoder.layers." + std::to_string(i), *memory, pos_embed, simplify);
+			}
+			// simplify 이면 tgt 상수 대신 첫 decoder 레이어가 0 을 직접 반영, memory + pos 는 모든 레이어가 공유
+			Tensor* out = nullptr;
+			if (!simplify) {
+				std::vector<float> tgt_weight((size_t)NUM_QUERIES * D_MODEL, 0.f);
+				out = network->addConstant(Dims4(NUM_QUERIES, D_MODEL, 1, 1), tgt_weight)->getOutput(0);
+			}
+			Layer* query_pos = network->addConstant(Dims4(NUM_QUERIES, D_MODEL, 1, 1), weights.get("query_embed.weight", (size_t)NUM_QUERIES * D_MODEL, 3));
+
+			Tensor* key_embed = nullptr;
+			for (int i = 0; i < NUM_DECODE_LAYERS; i++) {
+				if (!key_embed || !simplify) key_embed = network->addElementWise(*memory, pos_embed, ElementWiseOperation::kSUM)->getOutput(0);
+				out = TransformerDecoderLayer(network, weights, lname + ".decoder.layers." + std::to_string(i), out, *memory, *key_embed, *query_pos->getOutput(0), simplify);
+				if (i != NUM_DECODE_LAYERS - 1 && std::find(exits.begin(), exits.end(), i) != exits.end()) {
+					intermediate.push_back(LayerNorm(network, *out, weights, lname + ".decoder.norm", D_MODEL));
+				}
+			}
+			return LayerNorm(network, *out, weights, lname + ".decoder.norm", D_MODEL);
+		}
+
+		static Tensor* MLP(Network* network, WeightSource& weights, const std::string& lname, Tensor& src, int num_layers = 3, int hidden_dim = 256, int output_dim = 4) {
+			Tensor* out = &src;
+			for (int i = 0; i < num_layers; i++) {
+				std::string layer_name = lname + "." + std::to_string(i);
+				if (i != num_layers - 1) {
+					Layer* fc = addFc(network, weights, *out, hidden_dim, layer_name);
+					out = network->addActivation(*fc->getOutput(0), ActivationType::kRELU)->getOutput(0);
+				}
+				else {
+					out = addFc(network, weights, *out, output_dim, layer_name)->getOutput(0);
+				}
+			}
+			return out;
+		}
+
+		// decoder 출력 [Q, D] -> "scores<suffix>" [Q, NUM_CLASS - 1], "boxes<suffix>" [Q, 4] 출력
+		static void Predict(Network* network, WeightSource& weights, Tensor& hs, const std::string& suffix)
+		{
+			Layer* class_embed = addFc(network, weights, hs, NUM_CLASS, "class_embed");
+			Layer* class_softmax = network->addSoftMax(*class_embed->getOutput(0));
+			class_softmax->setAxes(2);
+			Tensor* softmax_t = class_softmax->getOutput(0);
+
+			Layer* shuffle_l = network->addShuffle(*softmax_t);
+			shuffle_l->setReshapeDimensions(Dims2(softmax_t->getDimensions().d[0], softmax_t->getDimensions().d[1]));
+			Tensor* shuffle_t = shuffle_l->getOutput(0);
+			Layer* slice = network->addSlice(*shuffle_t, Dims2(0, 0), Dims2(shuffle_t->getDimensions().d[0], shuffle_t->getDimensions().d[1] - 1), Dims2(1, 1));
+
+			Tensor* bbox = MLP(network, weights, "bbox_embed.layers", hs);
+			Layer* bbox_sig = network->addActivation(*bbox, ActivationType::kSIGMOID);
+
+			Tensor* results[] = { slice->getOutput(0), bbox_sig->getOutput(0) };
+			const char* names[] = { "scores", "boxes" };
+			for (int i = 0; i < 2; i++) {
+				network->markOutput(*results[i]);
+				results[i]->setName((names[i] + suffix).c_str());
+			}
+		}
+
+		static void build(Network* network, WeightSource& weights, int maxBatchSize, const ModelConfig& cfg, const BuildOptions& options)
+		{
+			Tensor* data = network->addInput(cfg.input_name, DataType::kFLOAT, Dims3(cfg.input_c, cfg.input_h, cfg.input_w));
+			PreprocessParam preprocess{ maxBatchSize, cfg.input_c, cfg.input_h, cfg.input_w, 1, { 0.485f, 0.456f, 0.406f }, { 0.229f, 0.224f, 0.225f } };
+			Layer* preprocess_layer = network->addPreprocess(*data, preprocess);
+			preprocess_layer->setName("[preprocess_layer]");
+
+			// backbone
+			Tensor* features = BuildResNet(network, weights, *preprocess_layer->getOutput(0), 64, 64, 256);
+			Tensor* pos_embed = PositionEmbeddingSine(network, *features, 128, 10000);
+
+			Layer* input_proj = addConv(network, weights, *features, D_MODEL, 1, "input_proj.weight", "input_proj.bias");
+			input_proj->setStrideNd(DimsHW(1, 1));
+			Layer* flatten = network->addShuffle(*input_proj->getOutput(0));
+			flatten->setReshapeDimensions(Dims4(input_proj->getOutput(0)->getDimensions().d[0], -1, 1, 1));
+			flatten->setSecondTranspose(Permutation{ { 1, 0, 2, 3 } });
+			std::vector<int> exits;
+			for (int i : options.detr_exit_layers) {
+				if (i >= 0 && i < NUM_DECODE_LAYERS - 1 && std::find(exits.begin(), exits.end(), i) == exits.end()) exits.push_back(i);
+			}
+			std::sort(exits.begin(), exits.end());
+			std::vector<Tensor*> intermediate;
+			Tensor* out1 = Transformer(network, weights, "transformer", *flatten->getOutput(0), *pos_embed, options.simplify_detr, exits, intermediate);
+
+			// 최종 출력 다음에 중간 출력 (head 가중치는 공유)
+			Predict(network, weights, *out1, "");
+			for (size_t k = 0; k < exits.size(); k++) Predict(network, weights, *intermediate[k], "_" + std::to_string(exits[k]));
+		}
+	}
+
+	bool buildModel(const std::string& name, Network& network, WeightSource& weights, int maxBatchSize, const BuildOptions& options)
+	{
+		const ModelConfig* cfg = findModel(name);
+		if (!cfg) {
+			std::cerr << "[ERROR] unknown model : " << name << std::endl;
+			return false;
+		}
+		if (name == "yolov5s") yolov5s::build(&network, weights, maxBatchSize, *cfg);
+		else if (name == "resnet18") resnet18::build(&network, weights, maxBatchSize, *cfg);
+		else if (name == "vgg11") vgg11::build(&network, weights, maxBatchSize, *cfg);
+		else if (name == "unet") unet::build(&network, weights, maxBatchSize, *cfg);
+		else if (name == "detr") detr::build(&network, weights, maxBatchSize, *cfg, options);
+		return true;
+	}
+}
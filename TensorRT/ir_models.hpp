@@ -0,0 +1,57 @@
+﻿#pragma once
+#include <random>
+#include <string>
+#include <vector>
+#include "graph_ir.hpp"
+
+// 예제 모델(yolov5s, resnet18, vgg11, unet, detr)의 createEngine 을 ir::Network 로 기록
+// 레이어 추가 순서, 파라미터, 이름은 각 예제의 TensorRT builder 코드와 동일
+namespace ir
+{
+	struct ModelConfig {
+		const char* name;
+		const char* weight_file;	// 예제와 같은 상대 경로
+		int input_h;
+		int input_w;
+		int input_c;
+		const char* input_name;
+		int calib_process;			// Int8EntropyCalibrator2 의 process_type (calib_preprocess.hpp)
+	};
+
+	const std::vector<ModelConfig>& modelConfigs();
+	const ModelConfig* findModel(const std::string& name);
+
+	//! \class WeightSource
+	//!
+	//! \brief builder 에서 사용하는 가중치 조회. 크기가 다르면 에러 출력
+	//!  random_missing 이면 .wts 에 없는 가중치를 고정 seed 난수로 생성 (가중치 파일 없이 구조, 속도 확인용)
+	//!
+	class WeightSource
+	{
+	public:
+		WeightSource(WeightMap& weightMap, bool random_missing);
+
+		// fan_in : 난수 생성시 출력 분산이 1 근처가 되도록 하는 입력 수
+		const std::vector<float>& get(const std::string& name, size_t count, int fan_in = 1);
+		int missingCount() const { return missing_; }
+
+	private:
+		WeightMap& map_;
+		bool random_missing_;
+		int missing_;
+		std::mt19937 rng_;
+	};
+
+	// builder 선택 사항 (기본값은 각 예제 builder 의 현재 설정과 같음)
+	struct BuildOptions {
+		// DETR : self-attention q, k projection 합치기, memory + pos 한번만 계산, 첫 decoder self-attention 상수 (detr_trt.cpp simplify_graph)
+		// false 면 PyTorch 모듈 구조 그대로
+		bool simplify_detr = true;
+		// DETR : 지정한 decoder 레이어 (0 부터, 마지막 제외) 출력에도 decoder.norm, class, box head 를 붙여 "scores_<i>", "boxes_<i>" 출력 추가
+		// (PyTorch aux_loss 의 중간 예측, early exit 용 cpu_early_exit.hpp)
+		std::vector<int> detr_exit_layers;
+	};
+
+	// name 모델을 network 에 기록 (성공시 true)
+	bool buildModel(const std::string& name, Network& network, WeightSource& weights, int maxBatchSize, const BuildOptions& options = BuildOptions());
+}
@@ -0,0 +1,101 @@
+﻿// graph pass 적용 전후 레이어 수, CPU latency, 출력 차이 비교
+// usage : ir_optimize [model (기본 전체)] [-n iterations] [-t threads] [-r]
+//   -r : .wts 에 없는 가중치를 난수로 생성 (가중치 파일 없이 실행)
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include "cpu_interpreter.hpp"
+#include "graph_passes.hpp"
+#include "ir_models.hpp"
+
+struct OptimizeReport {
+	std::string model;
+	int layers_before;
+	int layers_after;
+	double ms_before;
+	double ms_after;
+	double max_abs;
+};
+
+static double measure(CpuInterpreter& interpreter, int iterations)
+{
+	interpreter.run(1);	// warm up (상수 부분 그래프 계산)
+	interpreter.resetProfile();
+	auto t0 = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < iterations; i++) interpreter.run(1);
+	auto t1 = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration<double, std::milli>(t1 - t0).count() / iterations;
+}
+
+int main(int argc, char** argv)
+{
+	std::string only;
+	int iterations = 5, threads = 0;
+	bool random_missing = false;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-n") && i + 1 < argc) iterations = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-t") && i + 1 < argc) threads = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-r")) random_missing = true;
+		else only = argv[i];
+	}
+
+	std::vector<OptimizeReport> reports;
+	for (const ir::ModelConfig& config : ir::modelConfigs()) {
+		if (!only.empty() && only != config.name) continue;
+		ir::WeightMap weightMap;
+		std::ifstream wts(config.weight_file);
+		if (wts.good()) {
+			wts.close();
+			weightMap = ir::loadWeights(config.weight_file);
+		}
+		else if (!random_missing) {
+			std::cerr << "[ERROR] weight file not found : " << config.weight_file << " (use -r for random weights)" << std::endl;
+			continue;
+		}
+		// 같은 WeightSource 로 두 번 기록 (난수 가중치도 동일)
+		ir::WeightSource weights(weightMap, random_missing);
+		ir::Network original, optimized;
+		if (!ir::buildModel(config.name, original, weights, 1) || !ir::buildModel(config.name, optimized, weights, 1)) continue;
+
+		std::cout << "=== " << config.name << " ===" << std::endl;
+		ir::optimizeNetwork(optimized, &std::cout);
+		optimized.printSummary(std::cout);
+
+		std::vector<uint8_t> input((size_t)config.input_h * config.input_w * config.input_c);
+		std::mt19937 rng(0);
+		for (auto& v : input) v = (uint8_t)(rng() & 255);
+
+		CpuInterpreter before(original, 1, threads), after(optimized, 1, threads);
+		before.setInput(config.input_name, input.data());
+		after.setInput(config.input_name, input.data());
+		OptimizeReport r{ config.name, original.getNbLayers(), optimized.getNbLayers(), measure(before, iterations), measure(after, iterations), 0.0 };
+		after.printProfile(std::cout, 10);
+
+		for (int i = 0; i < original.getNbOutputs(); i++) {
+			const ir::Tensor* a = original.getOutput(i);
+			const ir::Tensor* b = optimized.getOutput(i);
+			const TensorDiff diff = diffTensors(before.getTensor(a), after.getTensor(b), (size_t)ir::volume(a->getDimensions()));
+			std::cout << "output " << a->getName() << " : " << diff << std::endl;
+			r.max_abs = std::max(r.max_abs, diff.max_abs);
+		}
+		reports.push_back(r);
+	}
+
+	std::cout << std::endl << std::left << std::setw(10) << "model" << std::right << std::setw(16) << "layers" << std::setw(24) << "CPU latency (ms)"
+		<< std::setw(10) << "speedup" << std::setw(14) << "max abs diff" << std::endl;
+	std::cout << std::fixed;
+	for (const OptimizeReport& r : reports) {
+		std::ostringstream layers, latency;
+		layers << r.layers_before << " -> " << r.layers_after;
+		latency << std::fixed << std::setprecision(2) << r.ms_before << " -> " << r.ms_after;
+		std::cout << std::left << std::setw(10) << r.model << std::right << std::setw(16) << layers.str() << std::setw(24) << latency.str()
+			<< std::setw(9) << std::setprecision(2) << r.ms_before / r.ms_after << "x" << std::setw(14) << std::scientific << std::setprecision(2) << r.max_abs << std::fixed << std::endl;
+	}
+	return 0;
+}
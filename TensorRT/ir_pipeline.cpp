@@ -0,0 +1,204 @@
+﻿// 연속 frame 의 pipeline 병렬 실행 (cpu_scheduler.hpp PipelineExecutor) 과 data 병렬 실행 비교
+// usage : ir_pipeline [resnet18|yolov5s|vgg11|unet|detr|all] [options]
+//   -s <stages>      pipeline 단계 수 (기본 threads 와 4 중 작은 값)
+//   -c <cores>       단계별 core 수 (기본 threads / stages)
+//   -f <frames>      측정 frame 수 (기본 32)
+//   -k <count>       난수 이미지 수 (frame 은 이미지를 순서대로 반복, 기본 4)
+//   -n <iterations>  단계 경계를 정할 레이어 시간 측정 횟수 (기본 3)
+//   -t <threads>     전체 thread 수 (기본 OpenMP 기본값)
+//   -u               단계 thread 를 core 에 고정하지 않음
+//   -r               .wts 에 없는 가중치를 난수로 생성 (가중치 파일 없이 실행)
+// 모델마다 단계 경계 (레이어 구간, 측정 시간 기준 예상 단계 시간), 실행 방식별 처리량 (frames/s), frame 지연 시간 (평균, 최대), 출력 일치 여부
+//   intra-op : interpreter 하나가 frame 을 하나씩 (레이어 내부를 전체 thread 로 병렬)
+//   replicas : 단계 수 만큼의 interpreter 가 frame 을 나눠서 (core 묶음마다 frame 하나, data 병렬)
+//   pipeline : 단계 수 만큼의 core 묶음이 레이어 구간을 나눠서 (frame 이 단계를 차례로 통과)
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include "cpu_interpreter.hpp"
+#include "cpu_scheduler.hpp"
+#include "graph_passes.hpp"
+#include "ir_models.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+typedef std::chrono::high_resolution_clock Clock;
+
+struct ModeResult {
+	double fps;
+	double mean_latency_ms;
+	double max_latency_ms;
+	bool match;
+};
+
+// network 출력 전체를 이어 붙인 값
+static std::vector<float> outputs(const ir::Network& network, const CpuInterpreter& interpreter)
+{
+	std::vector<float> values;
+	for (int i = 0; i < network.getNbOutputs(); i++) {
+		const ir::Tensor* output = network.getOutput(i);
+		const float* v = interpreter.getTensor(output);
+		values.insert(values.end(), v, v + ir::volume(output->getDimensions()));
+	}
+	return values;
+}
+
+static void printMode(const char* name, const ModeResult& r, double base_fps)
+{
+	std::cout << "  " << std::left << std::setw(10) << name << std::right << std::fixed << std::setprecision(2) << std::setw(10) << r.fps
+		<< std::setw(9) << r.fps / base_fps << "x" << std::setw(13) << r.mean_latency_ms << std::setw(10) << r.max_latency_ms
+		<< std::setw(8) << (r.match ? "yes" : "NO") << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	std::string model = argc > 1 && argv[1][0] != '-' ? argv[1] : "all";
+	int stages = 0, cores = 0, frames = 32, images = 4, iterations = 3, threads = 0;
+	bool pin = true, random_missing = false;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-s") && i + 1 < argc) stages = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-c") && i + 1 < argc) cores = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-f") && i + 1 < argc) frames = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-k") && i + 1 < argc) images = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-n") && i + 1 < argc) iterations = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-t") && i + 1 < argc) threads = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-u")) pin = false;
+		else if (!strcmp(argv[i], "-r")) random_missing = true;
+	}
+#ifdef _OPENMP
+	if (threads <= 0) threads = omp_get_max_threads();
+#else
+	if (threads <= 0) threads = 1;
+#endif
+	if (stages <= 0) stages = std::max(1, std::min(threads, 4));
+	if (cores <= 0) cores = std::max(1, threads / stages);
+	std::vector<const ir::ModelConfig*> configs;
+	if (model == "all") {
+		for (const ir::ModelConfig& c : ir::modelConfigs()) configs.push_back(&c);
+	}
+	else if (const ir::ModelConfig* c = ir::findModel(model)) configs.push_back(c);
+	else {
+		std::cerr << "[ERROR] unknown model : " << model << std::endl;
+		return 1;
+	}
+
+	std::cout << threads << " threads, pipeline " << stages << " stages x " << cores << " cores" << (pin ? " (pinned)" : "") << ", " << frames << " frames" << std::endl;
+	for (const ir::ModelConfig* config : configs) {
+		ir::WeightMap weightMap;
+		std::ifstream wts(config->weight_file);
+		if (wts.good()) {
+			wts.close();
+			weightMap = ir::loadWeights(config->weight_file);
+		}
+		else if (!random_missing) {
+			std::cerr << "[ERROR] weight file not found : " << config->weight_file << " (use -r for random weights)" << std::endl;
+			return 1;
+		}
+		ir::WeightSource weights(weightMap, random_missing);
+		ir::Network network;
+		if (!ir::buildModel(config->name, network, weights, 1)) return 1;
+		ir::optimizeNetwork(network, nullptr);
+
+		std::vector<std::vector<uint8_t>> inputs(images, std::vector<uint8_t>((size_t)config->input_h * config->input_w * config->input_c));
+		std::mt19937 rng(0);
+		for (auto& input : inputs) {
+			for (auto& v : input) v = (uint8_t)(rng() & 255);
+		}
+		auto feed = [&](int frame, CpuInterpreter& interpreter) { interpreter.setInput(config->input_name, inputs[frame % images].data()); };
+
+		// intra-op (기준 출력)
+		std::vector<std::vector<float>> reference(images);
+		ModeResult intra{ 0.0, 0.0, 0.0, true };
+		{
+			CpuInterpreter interpreter(network, 1, threads);
+			for (int i = 0; i < images; i++) {
+				feed(i, interpreter);
+				interpreter.run(1);
+				reference[i] = outputs(network, interpreter);
+			}
+			const Clock::time_point t0 = Clock::now();
+			for (int k = 0; k < frames; k++) {
+				const Clock::time_point f0 = Clock::now();
+				feed(k, interpreter);
+				interpreter.run(1);
+				const double ms = std::chrono::duration<double, std::milli>(Clock::now() - f0).count();
+				intra.mean_latency_ms += ms / frames;
+				intra.max_latency_ms = std::max(intra.max_latency_ms, ms);
+			}
+			intra.fps = frames * 1e3 / std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+		}
+
+		// replicas : core 묶음마다 interpreter 하나, frame r, r + stages, ...
+		ModeResult replicas{ 0.0, 0.0, 0.0, true };
+		{
+			std::vector<std::unique_ptr<CpuInterpreter>> workers;
+			for (int r = 0; r < stages; r++) {
+				workers.emplace_back(new CpuInterpreter(network, 1, cores));
+				feed(r, *workers[r]);
+				workers[r]->run(1);	// warm up (상수 부분 그래프 계산)
+			}
+			std::vector<double> latency(frames, 0.0);
+			std::vector<char> match(frames, 1);
+			const Clock::time_point t0 = Clock::now();
+			std::vector<std::thread> pool;
+			for (int r = 0; r < stages; r++) {
+				pool.emplace_back([&, r]() {
+					if (pin) pinCurrentThread(r * cores, cores);
+#ifdef _OPENMP
+					omp_set_num_threads(cores);
+#endif
+					for (int k = r; k < frames; k += stages) {
+						const Clock::time_point f0 = Clock::now();
+						feed(k, *workers[r]);
+						workers[r]->run(1);
+						latency[k] = std::chrono::duration<double, std::milli>(Clock::now() - f0).count();
+						match[k] = outputs(network, *workers[r]) == reference[k % images];
+					}
+				});
+			}
+			for (auto& t : pool) t.join();
+			replicas.fps = frames * 1e3 / std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+			for (int k = 0; k < frames; k++) {
+				replicas.mean_latency_ms += latency[k] / frames;
+				replicas.max_latency_ms = std::max(replicas.max_latency_ms, latency[k]);
+				replicas.match &= match[k] != 0;
+			}
+		}
+
+		// pipeline : 측정한 레이어 시간으로 경계를 정하고, 한번 흘려서 warm up 후 측정
+		ModeResult pipelined{ 0.0, 0.0, 0.0, true };
+		PipelineExecutor pipeline(network, PipelineConfig{ stages, cores, pin });
+		pipeline.balance(feed, iterations);
+		auto collect = [&](int frame, const CpuInterpreter& interpreter) { pipelined.match &= outputs(network, interpreter) == reference[frame % images]; };
+		pipeline.run(std::min(frames, pipeline.slots()), feed, collect);
+		pipeline.run(frames, feed, collect);
+		const PipelineStats& stats = pipeline.stats();
+		pipelined.fps = stats.fps;
+		pipelined.mean_latency_ms = stats.mean_latency_ms;
+		pipelined.max_latency_ms = stats.max_latency_ms;
+
+		std::cout << "[" << config->name << "] " << network.getNbLayers() << " layers, stages (layers : estimated / measured ms)";
+		double slowest = 0.0, total = 0.0;
+		for (int s = 0; s < (int)pipeline.bounds().size() - 1; s++) {
+			std::cout << " [" << pipeline.bounds()[s] << ", " << pipeline.bounds()[s + 1] << ") " << std::fixed << std::setprecision(2)
+				<< pipeline.stageCostMs(s) << " / " << stats.stage_ms[s];
+			slowest = std::max(slowest, pipeline.stageCostMs(s));
+			total += pipeline.stageCostMs(s);
+		}
+		std::cout << ", balance " << std::setprecision(1) << 100.0 * total / (slowest * (pipeline.bounds().size() - 1)) << "%" << std::endl;
+		std::cout << "  " << std::left << std::setw(10) << "mode" << std::right << std::setw(10) << "frames/s" << std::setw(10) << "speedup"
+			<< std::setw(13) << "latency ms" << std::setw(10) << "max ms" << std::setw(8) << "match" << std::endl;
+		printMode("intra-op", intra, intra.fps);
+		printMode("replicas", replicas, intra.fps);
+		printMode("pipeline", pipelined, intra.fps);
+		std::cout.unsetf(std::ios::floatfield);
+	}
+	return 0;
+}
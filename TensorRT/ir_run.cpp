@@ -0,0 +1,145 @@
+﻿// 예제 모델을 graph IR 로 기록하고 CPU interpreter 로 실행, 레이어별 시간 출력
+// usage : ir_run <yolov5s|resnet18|vgg11|unet|detr> [options]
+//   -b <batch>       batch 크기 (기본 1)
+//   -t <threads>     OpenMP thread 수 (기본 0 : OpenMP 기본값)
+//   -n <iterations>  반복 실행 횟수 (기본 10)
+//   -r               .wts 에 없는 가중치를 난수로 생성 (가중치 파일 없이 실행)
+//   -i <file>        uint8 HWC BGR raw 입력 파일 (없으면 난수 이미지)
+//   -c <file>        첫번째 출력과 비교할 TensorRT 출력 float raw 파일 (batch 크기 만큼)
+//   -k <file>        kernel tuning 캐시 (kernel_tuner.hpp), 캐시에 없는 shape 는 측정 후 추가
+//   -p <fp32|fp16|bf16>  중간 텐서 저장 형식 (기본 fp32)
+//   -d <file>        첫 실행의 레이어 출력을 dump 파일로 기록 (tensor_dump.hpp, tensor_diff 로 비교)
+//   -f <pattern>     -d 에서 이름에 pattern 이 포함된 텐서만 기록 (여러번 지정 가능)
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include "cpu_interpreter.hpp"
+#include "detection_eval.hpp"
+#include "ir_models.hpp"
+#include "kernel_tuner.hpp"
+
+int main(int argc, char** argv)
+{
+	if (argc < 2) {
+		std::cerr << "usage : ir_run <yolov5s|resnet18|vgg11|unet|detr> [-b batch] [-t threads] [-n iterations] [-r] [-i input.raw] [-c trt_output.raw] [-p fp32|fp16|bf16] [-d dump.bin] [-f pattern]" << std::endl;
+		return 1;
+	}
+	const ir::ModelConfig* config = ir::findModel(argv[1]);
+	if (!config) {
+		std::cerr << "[ERROR] unknown model : " << argv[1] << std::endl;
+		return 1;
+	}
+	int batch = 1, threads = 0, iterations = 10;
+	bool random_missing = false;
+	const char* input_file = nullptr;
+	const char* compare_file = nullptr;
+	const char* tuning_cache = nullptr;
+	const char* dump_file = nullptr;
+	std::vector<std::string> dump_filter;
+	CpuPrecision precision = CpuPrecision::kFP32;
+	for (int i = 2; i < argc; i++) {
+		if (!strcmp(argv[i], "-b") && i + 1 < argc) batch = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-t") && i + 1 < argc) threads = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-n") && i + 1 < argc) iterations = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-r")) random_missing = true;
+		else if (!strcmp(argv[i], "-i") && i + 1 < argc) input_file = argv[++i];
+		else if (!strcmp(argv[i], "-c") && i + 1 < argc) compare_file = argv[++i];
+		else if (!strcmp(argv[i], "-k") && i + 1 < argc) tuning_cache = argv[++i];
+		else if (!strcmp(argv[i], "-d") && i + 1 < argc) dump_file = argv[++i];
+		else if (!strcmp(argv[i], "-f") && i + 1 < argc) dump_filter.push_back(argv[++i]);
+		else if (!strcmp(argv[i], "-p") && i + 1 < argc) {
+			const std::string p = argv[++i];
+			if (p == "fp16") precision = CpuPrecision::kFP16;
+			else if (p == "bf16") precision = CpuPrecision::kBF16;
+			else if (p != "fp32") {
+				std::cerr << "[ERROR] unknown precision : " << p << std::endl;
+				return 1;
+			}
+		}
+	}
+
+	// 1. 가중치 로드, network 기록
+	ir::WeightMap weightMap;
+	std::ifstream wts(config->weight_file);
+	if (wts.good()) {
+		wts.close();
+		weightMap = ir::loadWeights(config->weight_file);
+	}
+	else if (!random_missing) {
+		std::cerr << "[ERROR] weight file not found : " << config->weight_file << " (use -r for random weights)" << std::endl;
+		return 1;
+	}
+	ir::WeightSource weights(weightMap, random_missing);
+	ir::Network network;
+	if (!ir::buildModel(config->name, network, weights, batch)) return 1;
+	network.printSummary(std::cout);
+	if (weights.missingCount()) std::cout << "random weights : " << weights.missingCount() << std::endl;
+
+	// 2. 입력 준비
+	std::vector<uint8_t> input((size_t)batch * config->input_h * config->input_w * config->input_c);
+	if (input_file) {
+		if (!readFile(input_file, input.data(), input.size())) return 1;
+	}
+	else {
+		std::mt19937 rng(0);
+		for (auto& v : input) v = (uint8_t)(rng() & 255);
+	}
+
+	// 3. 실행
+	std::unique_ptr<KernelTuner> tuner;
+	if (tuning_cache) {
+		tuner.reset(new KernelTuner(tuning_cache));
+		if (!tuner->load()) return 1;
+		setKernelTuner(tuner.get());
+	}
+	CpuInterpreter interpreter(network, batch, threads, precision);
+	if (tuner) {
+		setKernelTuner(nullptr);
+		const TunerStats& stats = tuner->stats();
+		std::cout << "kernel tuning : " << stats.hits << " / " << stats.hits + stats.misses << " cached, tuning " << stats.tuning_ms << " ms" << std::endl;
+		if (stats.misses) tuner->save();
+	}
+	interpreter.setInput(config->input_name, input.data());
+	TensorDumpWriter dump;
+	if (dump_file) {
+		const char* format = precision == CpuPrecision::kFP16 ? "fp16" : precision == CpuPrecision::kBF16 ? "bf16" : "fp32";
+		if (!dump.open(dump_file, std::string(config->name) + " cpu " + format)) {
+			std::cerr << "[ERROR] file open error : " << dump_file << std::endl;
+			return 1;
+		}
+		dump.setFilter(dump_filter);
+		interpreter.setDump(&dump);
+	}
+	interpreter.run(batch);	// warm up (상수 부분 그래프 계산)
+	if (dump_file) {
+		interpreter.setDump(nullptr);
+		dump.close();
+		std::cout << "dump " << dump_file << " : " << dump.recordCount() << " tensors" << std::endl;
+	}
+	interpreter.resetProfile();
+	auto t0 = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < iterations; i++) interpreter.run(batch);
+	auto t1 = std::chrono::high_resolution_clock::now();
+	double total_ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+	std::cout << "[" << config->name << "] batch " << batch << ", " << iterations << " iterations : " << total_ms / iterations << " ms/iter" << std::endl;
+	interpreter.printProfile(std::cout, 20);
+
+	for (int i = 0; i < network.getNbOutputs(); i++) {
+		const ir::Tensor* t = network.getOutput(i);
+		std::cout << "output " << t->getName() << " " << t->getDimensions() << std::endl;
+	}
+
+	// 4. TensorRT 출력과 비교
+	if (compare_file) {
+		const ir::Tensor* out = network.getOutput(0);
+		size_t count = (size_t)batch * ir::volume(out->getDimensions());
+		std::vector<float> reference(count);
+		if (!readFile(compare_file, reference.data(), count * sizeof(float))) return 1;
+		std::cout << "compare " << out->getName() << " : " << diffTensors(interpreter.getTensor(out), reference.data(), count) << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,121 @@
+﻿// 레이어 DAG 병렬 실행 (cpu_scheduler.hpp) 과 순차 실행 비교
+// usage : ir_schedule [resnet18|yolov5s|vgg11|unet|detr|all] [options]
+//   -n <iterations>  반복 횟수 (기본 5)
+//   -t <threads>     thread 수 (기본 OpenMP 기본값)
+//   -p               critical path 의 레이어 출력
+//   -r               .wts 에 없는 가중치를 난수로 생성 (가중치 파일 없이 실행)
+// 모델마다 cost model 예상 (전체 작업, intra-op 반영 critical path, 레이어 간 평균 병렬도 = 작업 / 1 thread critical path), 순차 / DAG 실행 시간,
+// 측정된 레이어 시간 기준 critical path, parallel efficiency (speedup / threads), 출력 일치 여부
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include "cpu_interpreter.hpp"
+#include "cpu_scheduler.hpp"
+#include "graph_passes.hpp"
+#include "ir_models.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+int main(int argc, char** argv)
+{
+	std::string model = argc > 1 && argv[1][0] != '-' ? argv[1] : "all";
+	int iterations = 5, threads = 0;
+	bool print_path = false, random_missing = false;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-n") && i + 1 < argc) iterations = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-t") && i + 1 < argc) threads = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-p")) print_path = true;
+		else if (!strcmp(argv[i], "-r")) random_missing = true;
+	}
+#ifdef _OPENMP
+	if (threads <= 0) threads = omp_get_max_threads();
+#else
+	if (threads <= 0) threads = 1;
+#endif
+	std::vector<const ir::ModelConfig*> configs;
+	if (model == "all") {
+		for (const ir::ModelConfig& c : ir::modelConfigs()) configs.push_back(&c);
+	}
+	else if (const ir::ModelConfig* c = ir::findModel(model)) configs.push_back(c);
+	else {
+		std::cerr << "[ERROR] unknown model : " << model << std::endl;
+		return 1;
+	}
+
+	std::cout << threads << " threads" << std::endl;
+	std::cout << std::left << std::setw(10) << "model" << std::right << std::setw(8) << "layers" << std::setw(11) << "work ms" << std::setw(11) << "path ms"
+		<< std::setw(9) << "inter" << std::setw(10) << "seq ms" << std::setw(10) << "dag ms" << std::setw(9) << "speedup" << std::setw(8) << "eff"
+		<< std::setw(13) << "crit ms" << std::setw(7) << "conc" << std::setw(8) << "steals" << std::setw(8) << "match" << std::endl;
+	for (const ir::ModelConfig* config : configs) {
+		ir::WeightMap weightMap;
+		std::ifstream wts(config->weight_file);
+		if (wts.good()) {
+			wts.close();
+			weightMap = ir::loadWeights(config->weight_file);
+		}
+		else if (!random_missing) {
+			std::cerr << "[ERROR] weight file not found : " << config->weight_file << " (use -r for random weights)" << std::endl;
+			return 1;
+		}
+		ir::WeightSource weights(weightMap, random_missing);
+		ir::Network network;
+		if (!ir::buildModel(config->name, network, weights, 1)) return 1;
+		ir::optimizeNetwork(network, nullptr);
+
+		std::vector<uint8_t> input((size_t)config->input_h * config->input_w * config->input_c);
+		std::mt19937 rng(0);
+		for (auto& v : input) v = (uint8_t)(rng() & 255);
+		CpuInterpreter sequential(network, 1, threads);
+		CpuInterpreter parallel(network, 1, threads);
+		DagScheduler scheduler(network, 1, threads);
+		sequential.setInput(config->input_name, input.data());
+		parallel.setInput(config->input_name, input.data());
+		sequential.run(1);	// warm up
+		scheduler.run(parallel, 1);
+
+		auto t0 = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < iterations; i++) sequential.run(1);
+		auto t1 = std::chrono::high_resolution_clock::now();
+		double dag_ms = 0.0, crit_ms = 0.0;
+		int conc = 0, steals = 0;
+		for (int i = 0; i < iterations; i++) {
+			scheduler.run(parallel, 1);
+			dag_ms += scheduler.stats().wall_ms;
+			crit_ms += scheduler.stats().critical_ms;
+			conc = std::max(conc, scheduler.stats().max_concurrency);
+			steals += scheduler.stats().steals;
+		}
+		const double seq_ms = std::chrono::duration<double, std::milli>(t1 - t0).count() / iterations;
+		dag_ms /= iterations;
+		crit_ms /= iterations;
+
+		bool match = true;
+		for (int i = 0; i < network.getNbOutputs(); i++) {
+			const ir::Tensor* output = network.getOutput(i);
+			const int64_t count = ir::volume(output->getDimensions());
+			match &= std::equal(sequential.getTensor(output), sequential.getTensor(output) + count, parallel.getTensor(output));
+		}
+		const double work = scheduler.estimatedWorkMs(), path = scheduler.estimatedCriticalMs();
+		const double branch = work * 1e3 / criticalPath(scheduler.dag(), scheduler.dag().cost_us);
+		std::cout << std::left << std::setw(10) << config->name << std::right << std::setw(8) << network.getNbLayers() << std::fixed << std::setprecision(2)
+			<< std::setw(11) << work << std::setw(11) << path << std::setw(9) << branch << std::setw(10) << seq_ms << std::setw(10) << dag_ms
+			<< std::setw(8) << seq_ms / dag_ms << "x" << std::setw(7) << 100.0 * seq_ms / dag_ms / threads << "%" << std::setw(13) << crit_ms
+			<< std::setw(7) << conc << std::setw(8) << steals / iterations << std::setw(8) << (match ? "yes" : "NO") << std::endl;
+
+		if (print_path) {
+			std::vector<int> layers;
+			criticalPath(scheduler.dag(), scheduler.dag().cost_us, &layers);
+			std::cout << "  critical path (" << layers.size() << " layers) :";
+			for (int l : layers) std::cout << " " << network.getLayer(l)->getName() << "(x" << scheduler.dag().width[l] << ")";
+			std::cout << std::endl;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,220 @@
+﻿#include <iostream>
+#include <map>
+#include "ir_trt.hpp"
+#include "preprocess.hpp"	// preprocess plugin
+#include "yololayer.hpp"	// yololayer plugin
+
+using namespace nvinfer1;
+
+static Dims toTrt(const ir::Dims& dims)
+{
+	Dims d;
+	d.nbDims = dims.nbDims;
+	for (int i = 0; i < dims.nbDims; i++) d.d[i] = dims.d[i];
+	return d;
+}
+
+static Permutation toTrt(const ir::Permutation& perm)
+{
+	Permutation p;
+	for (int i = 0; i < Dims::MAX_DIMS; i++) p.order[i] = i < ir::kMAX_DIMS ? perm.order[i] : i;
+	return p;
+}
+
+static Weights toWeights(const std::vector<float>& values)
+{
+	return Weights{ DataType::kFLOAT, values.empty() ? nullptr : values.data(), (int64_t)values.size() };
+}
+
+// IR 전용 kSILU 는 sigmoid + prod 로 분해
+static ILayer* addActivation(INetworkDefinition* network, ITensor& input, ir::ActivationType type, float alpha, float beta)
+{
+	if (type == ir::ActivationType::kSILU) {
+		IActivationLayer* sig = network->addActivation(input, ActivationType::kSIGMOID);
+		return network->addElementWise(input, *sig->getOutput(0), ElementWiseOperation::kPROD);
+	}
+	IActivationLayer* act = network->addActivation(input, static_cast<ActivationType>(type));
+	act->setAlpha(alpha);
+	act->setBeta(beta);
+	return act;
+}
+
+// layer norm 을 DETR 의 LayerNorm() 과 같은 레이어들로 분해
+static ILayer* addLayerNorm(INetworkDefinition* network, ITensor& input, const ir::Layer& l)
+{
+	static const float kZERO = 0.f, kONE = 1.f, kTWO = 2.f;
+	IReduceLayer* mean = network->addReduce(input, ReduceOperation::kAVG, l.axes_, true);
+	IElementWiseLayer* sub_mean = network->addElementWise(input, *mean->getOutput(0), ElementWiseOperation::kSUB);
+	IScaleLayer* pow2 = network->addScaleNd(*sub_mean->getOutput(0), ScaleMode::kUNIFORM, Weights{ DataType::kFLOAT, &kZERO, 1 }, Weights{ DataType::kFLOAT, &kONE, 1 }, Weights{ DataType::kFLOAT, &kTWO, 1 }, 0);
+	IReduceLayer* pow_mean = network->addReduce(*pow2->getOutput(0), ReduceOperation::kAVG, l.axes_, true);
+	Dims ones;
+	ones.nbDims = input.getDimensions().nbDims;
+	for (int i = 0; i < ones.nbDims; i++) ones.d[i] = 1;
+	IConstantLayer* eps = network->addConstant(ones, Weights{ DataType::kFLOAT, &l.epsilon_, 1 });
+	IElementWiseLayer* add_eps = network->addElementWise(*pow_mean->getOutput(0), *eps->getOutput(0), ElementWiseOperation::kSUM);
+	IUnaryLayer* sqrt = network->addUnary(*add_eps->getOutput(0), UnaryOperation::kSQRT);
+	IElementWiseLayer* div = network->addElementWise(*sub_mean->getOutput(0), *sqrt->getOutput(0), ElementWiseOperation::kDIV);
+	if (l.scale_.empty() && l.shift_.empty()) return div;
+	return network->addScaleNd(*div->getOutput(0), ScaleMode::kCHANNEL, toWeights(l.shift_), toWeights(l.scale_), toWeights(l.power_), l.channel_axis_);
+}
+
+// attention 을 DETR 의 MultiHeadAttention() 과 같은 scale, head 분리 shuffle, matmul, softmax, matmul, head 합치기 shuffle 로 분해
+static ILayer* addAttention(INetworkDefinition* network, ITensor& query, ITensor& key, ITensor& value, const ir::Layer& l)
+{
+	const Dims q_dims = query.getDimensions();
+	const int head_dim = q_dims.d[1] / l.num_heads_;
+	IConstantLayer* scaling = network->addConstant(Dims4(1, 1, 1, 1), Weights{ DataType::kFLOAT, &l.attention_scale_, 1 });
+	IElementWiseLayer* q_scaling = network->addElementWise(query, *scaling->getOutput(0), ElementWiseOperation::kPROD);
+	auto split = [&](ITensor& t) {
+		IShuffleLayer* shuffle = network->addShuffle(t);
+		shuffle->setReshapeDimensions(Dims3(-1, l.num_heads_, head_dim));
+		shuffle->setSecondTranspose(Permutation{ { 1, 0, 2 } });
+		return shuffle->getOutput(0);
+	};
+	IMatrixMultiplyLayer* q_product_k = network->addMatrixMultiply(*split(*q_scaling->getOutput(0)), MatrixOperation::kNONE, *split(key), MatrixOperation::kTRANSPOSE);
+	ISoftMaxLayer* softmax = network->addSoftMax(*q_product_k->getOutput(0));
+	softmax->setAxes(4);
+	IMatrixMultiplyLayer* attn_product_v = network->addMatrixMultiply(*softmax->getOutput(0), MatrixOperation::kNONE, *split(value), MatrixOperation::kNONE);
+	IShuffleLayer* merge = network->addShuffle(*attn_product_v->getOutput(0));
+	merge->setFirstTranspose(Permutation{ { 1, 0, 2 } });
+	merge->setReshapeDimensions(Dims4(q_dims.d[0], -1, 1, 1));
+	return merge;
+}
+
+static ILayer* lowerLayer(const ir::Layer& l, const std::vector<ITensor*>& in, INetworkDefinition* network)
+{
+	switch (l.getType()) {
+	case ir::LayerType::kCONVOLUTION: {
+		IConvolutionLayer* conv = network->addConvolutionNd(*in[0], l.nb_outputs_, toTrt(l.kernel_), toWeights(l.kernel_weights_), toWeights(l.bias_weights_));
+		conv->setStrideNd(toTrt(l.stride_));
+		conv->setPrePadding(toTrt(l.pre_padding_));
+		conv->setPostPadding(toTrt(l.post_padding_));
+		conv->setDilationNd(toTrt(l.dilation_));
+		conv->setNbGroups(l.groups_);
+		return conv;
+	}
+	case ir::LayerType::kDECONVOLUTION: {
+		IDeconvolutionLayer* deconv = network->addDeconvolutionNd(*in[0], l.nb_outputs_, toTrt(l.kernel_), toWeights(l.kernel_weights_), toWeights(l.bias_weights_));
+		deconv->setStrideNd(toTrt(l.stride_));
+		deconv->setPrePadding(toTrt(l.pre_padding_));
+		deconv->setPostPadding(toTrt(l.post_padding_));
+		deconv->setDilationNd(toTrt(l.dilation_));
+		deconv->setNbGroups(l.groups_);
+		return deconv;
+	}
+	case ir::LayerType::kFULLY_CONNECTED:
+		return network->addFullyConnected(*in[0], l.nb_outputs_, toWeights(l.kernel_weights_), toWeights(l.bias_weights_));
+	case ir::LayerType::kACTIVATION:
+		return addActivation(network, *in[0], l.activation_, l.alpha_, l.beta_);
+	case ir::LayerType::kPOOLING: {
+		IPoolingLayer* pool = network->addPoolingNd(*in[0], static_cast<PoolingType>(l.pooling_type_), toTrt(l.kernel_));
+		// IR 의 stride 기본값(window 크기)을 명시적으로 설정
+		pool->setStrideNd(toTrt(l.stride_));
+		pool->setPrePadding(toTrt(l.pre_padding_));
+		pool->setPostPadding(toTrt(l.post_padding_));
+		pool->setAverageCountExcludesPadding(l.average_count_excludes_padding_);
+		return pool;
+	}
+	case ir::LayerType::kSCALE:
+		return network->addScaleNd(*in[0], static_cast<ScaleMode>(l.scale_mode_), toWeights(l.shift_), toWeights(l.scale_), toWeights(l.power_), l.channel_axis_);
+	case ir::LayerType::kSOFTMAX: {
+		ISoftMaxLayer* softmax = network->addSoftMax(*in[0]);
+		softmax->setAxes(l.axes_);
+		return softmax;
+	}
+	case ir::LayerType::kCONCATENATION: {
+		IConcatenationLayer* cat = network->addConcatenation(in.data(), (int)in.size());
+		cat->setAxis(l.axis_);
+		return cat;
+	}
+	case ir::LayerType::kELEMENTWISE:
+		return network->addElementWise(*in[0], *in[1], static_cast<ElementWiseOperation>(l.elementwise_op_));
+	case ir::LayerType::kUNARY:
+		return network->addUnary(*in[0], static_cast<UnaryOperation>(l.unary_op_));
+	case ir::LayerType::kPADDING:
+		return network->addPaddingNd(*in[0], toTrt(l.pre_padding_), toTrt(l.post_padding_));
+	case ir::LayerType::kSHUFFLE: {
+		IShuffleLayer* shuffle = network->addShuffle(*in[0]);
+		shuffle->setFirstTranspose(toTrt(l.first_transpose_));
+		if (l.reshape_set_) shuffle->setReshapeDimensions(toTrt(l.reshape_));
+		shuffle->setSecondTranspose(toTrt(l.second_transpose_));
+		return shuffle;
+	}
+	case ir::LayerType::kREDUCE:
+		return network->addReduce(*in[0], static_cast<ReduceOperation>(l.reduce_op_), l.axes_, l.keep_dims_);
+	case ir::LayerType::kTOPK:
+		return network->addTopK(*in[0], static_cast<TopKOperation>(l.topk_op_), l.nb_outputs_, l.axes_);
+	case ir::LayerType::kGATHER:
+		return network->addGather(*in[0], *in[1], l.axis_);
+	case ir::LayerType::kMATRIX_MULTIPLY:
+		return network->addMatrixMultiply(*in[0], static_cast<MatrixOperation>(l.op0_), *in[1], static_cast<MatrixOperation>(l.op1_));
+	case ir::LayerType::kCONSTANT:
+		return network->addConstant(toTrt(l.getOutput(0)->getDimensions()), toWeights(l.constant_));
+	case ir::LayerType::kSLICE:
+		return network->addSlice(*in[0], toTrt(l.slice_start_), toTrt(l.slice_size_), toTrt(l.slice_stride_));
+	case ir::LayerType::kRESIZE: {
+		IResizeLayer* resize = network->addResize(*in[0]);
+		resize->setResizeMode(static_cast<ResizeMode>(l.resize_mode_));
+		if (!l.resize_scales_.empty()) resize->setScales(l.resize_scales_.data(), (int)l.resize_scales_.size());
+		else resize->setOutputDimensions(toTrt(l.resize_dims_));
+		resize->setAlignCorners(l.align_corners_);
+		// graph pass 로 합쳐진 padding 은 별도 레이어로 추가
+		if (l.pre_padding_.nbDims > 0) {
+			return network->addPaddingNd(*resize->getOutput(0), toTrt(l.pre_padding_), toTrt(l.post_padding_));
+		}
+		return resize;
+	}
+	case ir::LayerType::kPREPROCESS: {
+		const ir::PreprocessParam& p = l.preprocess_;
+		Preprocess preprocess{ p.N, p.C, p.H, p.W, p.preproc_type, { p.mean[0], p.mean[1], p.mean[2] }, { p.std[0], p.std[1], p.std[2] } };
+		IPluginCreator* creator = getPluginRegistry()->getPluginCreator("preprocess", "1");
+		IPluginV2* plugin = creator->createPlugin("preprocess_plugin", (PluginFieldCollection*)&preprocess);
+		return network->addPluginV2(in.data(), 1, *plugin);
+	}
+	case ir::LayerType::kYOLOLAYER: {
+		const ir::YololayerParam& p = l.yololayer_;
+		Yololayer yololayer{ p.C, p.H, p.W, p.CLASS_NUM, p.Grid_stride };
+		IPluginCreator* creator = getPluginRegistry()->getPluginCreator("yololayer", "1");
+		IPluginV2* plugin = creator->createPlugin("yololayer_plugin", (PluginFieldCollection*)&yololayer);
+		return network->addPluginV2(in.data(), 2, *plugin);
+	}
+	case ir::LayerType::kLAYER_NORM:
+		return addLayerNorm(network, *in[0], l);
+	case ir::LayerType::kATTENTION:
+		return addAttention(network, *in[0], *in[1], *in[2], l);
+	}
+	return nullptr;
+}
+
+bool lowerToTensorRT(const ir::Network& network, INetworkDefinition* trt_network)
+{
+	std::map<const ir::Tensor*, ITensor*> tensors;
+	for (int i = 0; i < network.getNbInputs(); i++) {
+		const ir::Tensor* t = network.getInput(i);
+		tensors[t] = trt_network->addInput(t->getName(), static_cast<DataType>(t->getType()), toTrt(t->getDimensions()));
+		if (t->dynamicRangeIsSet()) tensors[t]->setDynamicRange(t->getDynamicRangeMin(), t->getDynamicRangeMax());
+	}
+	for (int i = 0; i < network.getNbLayers(); i++) {
+		const ir::Layer* l = network.getLayer(i);
+		std::vector<ITensor*> in;
+		for (int k = 0; k < l->getNbInputs(); k++) in.push_back(tensors[l->getInput(k)]);
+		ILayer* layer = lowerLayer(*l, in, trt_network);
+		if (!layer) {
+			std::cerr << "[ERROR] TensorRT lowering failed : " << l->getName() << std::endl;
+			return false;
+		}
+		if (l->hasUserName()) layer->setName(l->getName());
+		// graph pass 로 합쳐진 activation 은 별도 레이어로 추가
+		if (l->fused_activation_) layer = addActivation(trt_network, *layer->getOutput(0), l->activation_, l->alpha_, l->beta_);
+		for (int k = 0; k < l->getNbOutputs(); k++) {
+			const ir::Tensor* t = l->getOutput(k);
+			if (t->hasUserName()) layer->getOutput(k)->setName(t->getName());
+			if (t->dynamicRangeIsSet()) layer->getOutput(k)->setDynamicRange(t->getDynamicRangeMin(), t->getDynamicRangeMax());
+			tensors[t] = layer->getOutput(k);
+		}
+	}
+	for (int i = 0; i < network.getNbOutputs(); i++) {
+		trt_network->markOutput(*tensors[network.getOutput(i)]);
+	}
+	return true;
+}
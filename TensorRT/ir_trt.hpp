@@ -0,0 +1,10 @@
+﻿#pragma once
+#include "NvInfer.h"
+#include "graph_ir.hpp"
+
+// ir::Network 를 TensorRT network 로 변환 (기록된 레이어 순서, 이름, 출력 그대로)
+// graph pass 의 IR 전용 표현(fused activation, SiLU, layer norm)은 TensorRT 레이어들로 분해
+// preprocess, yololayer 레이어는 plugin registry 의 ("preprocess", "1"), ("yololayer", "1") 로 생성
+// dynamic range 가 설정된 텐서(calibration table)는 TensorRT 텐서에도 같은 범위 설정
+// TensorRT Weights 는 ir::Network 의 가중치를 가리키므로 engine build 가 끝날 때까지 network 유지
+bool lowerToTensorRT(const ir::Network& network, nvinfer1::INetworkDefinition* trt_network);
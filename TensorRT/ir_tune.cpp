@@ -0,0 +1,110 @@
+﻿// shape 별 kernel 자동 선택 (kernel_tuner.hpp) 과 기본 선택 비교
+// usage : ir_tune [resnet18|yolov5s|vgg11|unet|detr|all] [options]
+//   -c <file>        tuning 캐시 파일 (기본 kernel_tuning.cache, 없으면 생성)
+//   -n <iterations>  반복 횟수 (기본 5)
+//   -i <iterations>  후보마다 측정 횟수 (기본 3)
+//   -t <threads>     OpenMP thread 수
+//   -r               .wts 에 없는 가중치를 난수로 생성 (가중치 파일 없이 실행)
+// 모델마다 조회한 conv / fully connected shape 수, 캐시 적중률, 측정 시간, kernel 시간 합 (기본 선택 -> 선택된 설정), 지연 시간 변화
+// 두 번째 실행부터는 캐시를 읽으므로 적중률 100%, 측정 시간 0
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include "cpu_interpreter.hpp"
+#include "graph_passes.hpp"
+#include "ir_models.hpp"
+#include "kernel_tuner.hpp"
+
+static double measure(CpuInterpreter& interpreter, int iterations)
+{
+	interpreter.run(1);	// warm up
+	auto t0 = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < iterations; i++) interpreter.run(1);
+	auto t1 = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration<double, std::milli>(t1 - t0).count() / iterations;
+}
+
+int main(int argc, char** argv)
+{
+	std::string model = argc > 1 && argv[1][0] != '-' ? argv[1] : "all";
+	std::string cache = "kernel_tuning.cache";
+	int iterations = 5, tune_iterations = 3, threads = 0;
+	bool random_missing = false;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-c") && i + 1 < argc) cache = argv[++i];
+		else if (!strcmp(argv[i], "-n") && i + 1 < argc) iterations = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-i") && i + 1 < argc) tune_iterations = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-t") && i + 1 < argc) threads = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-r")) random_missing = true;
+	}
+	std::vector<const ir::ModelConfig*> configs;
+	if (model == "all") {
+		for (const ir::ModelConfig& c : ir::modelConfigs()) configs.push_back(&c);
+	}
+	else if (const ir::ModelConfig* c = ir::findModel(model)) configs.push_back(c);
+	else {
+		std::cerr << "[ERROR] unknown model : " << model << std::endl;
+		return 1;
+	}
+
+	KernelTuner tuner(cache, tune_iterations);
+	if (!tuner.load()) return 1;
+	std::cout << "cpu : " << tuner.cpuModel() << ", cache " << tuner.path() << " (" << tuner.entries() << " entries)" << std::endl;
+	std::cout << std::left << std::setw(10) << "model" << std::right << std::setw(8) << "shapes" << std::setw(7) << "hits" << std::setw(9) << "hit %"
+		<< std::setw(11) << "tune ms" << std::setw(13) << "kernel ms" << std::setw(10) << "tuned" << std::setw(10) << "base ms" << std::setw(10) << "tuned ms"
+		<< std::setw(9) << "change" << std::setw(14) << "max abs diff" << std::endl;
+	for (const ir::ModelConfig* config : configs) {
+		ir::WeightMap weightMap;
+		std::ifstream wts(config->weight_file);
+		if (wts.good()) {
+			wts.close();
+			weightMap = ir::loadWeights(config->weight_file);
+		}
+		else if (!random_missing) {
+			std::cerr << "[ERROR] weight file not found : " << config->weight_file << " (use -r for random weights)" << std::endl;
+			return 1;
+		}
+		ir::WeightSource weights(weightMap, random_missing);
+		ir::Network network;
+		if (!ir::buildModel(config->name, network, weights, 1)) return 1;
+		ir::optimizeNetwork(network, nullptr);
+
+		std::vector<uint8_t> input((size_t)config->input_h * config->input_w * config->input_c);
+		std::mt19937 rng(0);
+		for (auto& v : input) v = (uint8_t)(rng() & 255);
+		CpuInterpreter base(network, 1, threads);
+		const TunerStats before = tuner.stats();
+		setKernelTuner(&tuner);
+		CpuInterpreter tuned(network, 1, threads);
+		setKernelTuner(nullptr);
+		const TunerStats& after = tuner.stats();
+		base.setInput(config->input_name, input.data());
+		tuned.setInput(config->input_name, input.data());
+		const double base_ms = measure(base, iterations);
+		const double tuned_ms = measure(tuned, iterations);
+
+		double max_abs = 0.0;
+		for (int i = 0; i < network.getNbOutputs(); i++) {
+			const ir::Tensor* output = network.getOutput(i);
+			const int64_t count = ir::volume(output->getDimensions());
+			const float* a = base.getTensor(output);
+			const float* b = tuned.getTensor(output);
+			for (int64_t k = 0; k < count; k++) max_abs = std::max(max_abs, (double)std::fabs(a[k] - b[k]));
+		}
+		const int hits = after.hits - before.hits, shapes = hits + after.misses - before.misses;
+		std::cout << std::left << std::setw(10) << config->name << std::right << std::setw(8) << shapes << std::setw(7) << hits
+			<< std::fixed << std::setprecision(1) << std::setw(8) << (shapes ? 100.0 * hits / shapes : 100.0) << "%"
+			<< std::setprecision(2) << std::setw(11) << after.tuning_ms - before.tuning_ms
+			<< std::setw(13) << (after.heuristic_us - before.heuristic_us) / 1000.0 << std::setw(10) << (after.tuned_us - before.tuned_us) / 1000.0
+			<< std::setw(10) << base_ms << std::setw(10) << tuned_ms << std::setw(8) << 100.0 * (tuned_ms - base_ms) / base_ms << "%"
+			<< std::scientific << std::setw(14) << max_abs << std::endl;
+		std::cout.unsetf(std::ios::floatfield);
+	}
+	return tuner.save() ? 0 : 1;
+}
@@ -0,0 +1,276 @@
+﻿#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <vector>
+#include "kernel_tuner.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+static const char kHEADER[] = "# kernel tuning cache v";
+
+// 최대 thread 수부터 절반씩 (1 포함)
+static std::vector<int> threadCandidates()
+{
+	std::vector<int> threads;
+	for (int t = maxThreads(); t > 1; t /= 2) threads.push_back(t);
+	threads.push_back(1);
+	return threads;
+}
+
+static std::vector<float> randomData(size_t count)
+{
+	std::vector<float> data(count);
+	std::mt19937 rng(0);
+	std::uniform_real_distribution<float> dist(-1.f, 1.f);
+	for (auto& v : data) v = dist(rng);
+	return data;
+}
+
+// 최소 실행 시간 (us), limit_us 의 2 배를 넘으면 더 측정하지 않음
+template <class F>
+static double measure(F run, int iterations, double limit_us)
+{
+	double best = std::numeric_limits<double>::max();
+	for (int i = 0; i < iterations; i++) {
+		auto t0 = std::chrono::high_resolution_clock::now();
+		run();
+		auto t1 = std::chrono::high_resolution_clock::now();
+		best = std::min(best, std::chrono::duration<double, std::micro>(t1 - t0).count());
+		if (best > 2.0 * limit_us) break;
+	}
+	return best;
+}
+
+static bool parseAlgo(const std::string& name, ConvAlgo& algo)
+{
+	for (int a = (int)ConvAlgo::kDIRECT; a <= (int)ConvAlgo::kWINOGRAD_4X4; a++) {
+		if (name == convAlgoName((ConvAlgo)a)) {
+			algo = (ConvAlgo)a;
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool parseIsa(const std::string& name, GemmIsa& isa)
+{
+	for (int i = (int)GemmIsa::kSCALAR; i <= (int)GemmIsa::kAVX512; i++) {
+		if (name == gemmIsaName((GemmIsa)i)) {
+			isa = (GemmIsa)i;
+			return true;
+		}
+	}
+	return false;
+}
+
+KernelTuner::KernelTuner(const std::string& cachePath, int iterations)
+	: path_(cachePath), cpu_(cpuModelName()), iterations_(std::max(1, iterations)), stats_{}
+{
+}
+
+bool KernelTuner::load()
+{
+	std::ifstream file(path_);
+	if (!file.is_open()) return true;
+	std::string line;
+	std::getline(file, line);
+	if (line.compare(0, sizeof(kHEADER) - 1, kHEADER) != 0) {
+		std::cerr << "[ERROR] not a kernel tuning cache : " << path_ << std::endl;
+		return false;
+	}
+	if (atoi(line.c_str() + sizeof(kHEADER) - 1) != kVERSION) {
+		std::cerr << "[WARNING] kernel tuning cache version mismatch, ignored : " << path_ << std::endl;
+		return true;
+	}
+	while (std::getline(file, line)) {
+		if (!line.empty() && line.back() == '\r') line.pop_back();
+		if (line.empty() || line[0] == '#') continue;
+		// <cpu>\t<key>\t<tactic>\t<best us>\t<heuristic us>
+		std::vector<std::string> fields;
+		std::istringstream ss(line);
+		for (std::string f; std::getline(ss, f, '\t');) fields.push_back(f);
+		if (fields.size() != 5) continue;
+		cache_[fields[0] + "\t" + fields[1]] = Entry{ fields[2], atof(fields[3].c_str()), atof(fields[4].c_str()) };
+	}
+	return true;
+}
+
+bool KernelTuner::save() const
+{
+	std::ofstream file(path_);
+	if (!file.is_open()) {
+		std::cerr << "[ERROR] kernel tuning cache write error : " << path_ << std::endl;
+		return false;
+	}
+	file << kHEADER << kVERSION << std::endl;
+	file << "# cpu\tkey\ttactic\tbest us\theuristic us" << std::endl;
+	for (const auto& e : cache_) file << e.first << "\t" << e.second.tactic << "\t" << e.second.best_us << "\t" << e.second.heuristic_us << std::endl;
+	return true;
+}
+
+bool KernelTuner::lookup(const std::string& key, Entry& entry)
+{
+	auto it = cache_.find(cpu_ + "\t" + key);
+	if (it == cache_.end()) return false;
+	entry = it->second;
+	stats_.hits++;
+	stats_.heuristic_us += entry.heuristic_us;
+	stats_.tuned_us += entry.best_us;
+	return true;
+}
+
+void KernelTuner::store(const std::string& key, const Entry& entry)
+{
+	cache_[cpu_ + "\t" + key] = entry;
+	stats_.misses++;
+	stats_.heuristic_us += entry.heuristic_us;
+	stats_.tuned_us += entry.best_us;
+}
+
+ConvTactic KernelTuner::tuneConv(const ConvShape& s, const float* weights, const float* bias, const ConvActivation& activation)
+{
+	// thread 수에 따라 최적 설정이 달라지므로 key 에 포함
+	std::ostringstream key;
+	key << "conv " << s.C << "x" << s.H << "x" << s.W << " k" << s.K << " " << s.OH << "x" << s.OW << " f" << s.KH << "x" << s.KW
+		<< " s" << s.SH << "x" << s.SW << " p" << s.PH << "x" << s.PW << " d" << s.DH << "x" << s.DW << " g" << s.G
+		<< " fp32 " << gemmIsaName(detectGemmIsa()) << " t" << maxThreads();
+	Entry entry;
+	ConvTactic tactic{ chooseConvAlgo(s), 0, 0 };
+	if (lookup(key.str(), entry)) {
+		std::istringstream ss(entry.tactic);
+		std::string algo;
+		ss >> algo >> tactic.tile >> tactic.threads;
+		if (parseAlgo(algo, tactic.algo) && convSupports(s, tactic.algo)) return tactic;
+		return ConvTactic{ chooseConvAlgo(s), 0, 0 };
+	}
+
+	auto t0 = std::chrono::high_resolution_clock::now();
+	const std::vector<float> in = randomData((size_t)s.C * s.H * s.W);
+	std::vector<float> out((size_t)s.K * s.OH * s.OW);
+	auto run = [&](const CpuConv& conv, double limit_us) {
+		return measure([&] { conv.forward(in.data(), out.data()); }, iterations_, limit_us);
+	};
+
+	// 1. 알고리즘 (기본 tile, 전체 thread), 기본 선택이 기준
+	std::unique_ptr<CpuConv> best(new CpuConv(s, weights, bias, tactic.algo, activation));
+	entry.heuristic_us = entry.best_us = run(*best, std::numeric_limits<double>::max());
+	const ConvAlgo algos[] = { ConvAlgo::kGEMM_1X1, ConvAlgo::kIM2COL_GEMM, ConvAlgo::kWINOGRAD_2X2, ConvAlgo::kWINOGRAD_4X4, ConvAlgo::kDIRECT };
+	for (ConvAlgo algo : algos) {
+		if (algo == tactic.algo || !convSupports(s, algo)) continue;
+		std::unique_ptr<CpuConv> conv(new CpuConv(s, weights, bias, algo, activation));
+		const double us = run(*conv, entry.best_us);
+		if (us < entry.best_us) {
+			entry.best_us = us;
+			tactic.algo = algo;
+			best = std::move(conv);
+		}
+	}
+	// 2. tile (GEMM 알고리즘), 출력 pixel 수를 넘는 tile 은 제외
+	if (tactic.algo == ConvAlgo::kGEMM_1X1 || tactic.algo == ConvAlgo::kIM2COL_GEMM) {
+		for (int tile : { 48, 192, 384 }) {
+			if (tile > s.OH * s.OW) continue;
+			best->setSchedule(tile, 0);
+			const double us = run(*best, entry.best_us);
+			if (us < entry.best_us) {
+				entry.best_us = us;
+				tactic.tile = tile;
+			}
+		}
+		best->setSchedule(tactic.tile, 0);
+	}
+	// 3. thread 수 (작은 레이어는 fork/join, 동기화 비용이 더 큼)
+	for (int threads : threadCandidates()) {
+		if (threads == maxThreads()) continue;
+		best->setSchedule(tactic.tile, threads);
+		const double us = run(*best, entry.best_us);
+		if (us < entry.best_us) {
+			entry.best_us = us;
+			tactic.threads = threads;
+		}
+	}
+
+	std::ostringstream value;
+	value << convAlgoName(tactic.algo) << " " << tactic.tile << " " << tactic.threads;
+	entry.tactic = value.str();
+	store(key.str(), entry);
+	stats_.tuning_ms += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+	return tactic;
+}
+
+GemmTactic KernelTuner::tuneGemm(int batch, int N, int K, const float* weights, const float* bias, const ConvActivation& activation)
+{
+	std::ostringstream key;
+	key << "fc m" << batch << " n" << N << " k" << K << " fp32 " << gemmIsaName(detectGemmIsa()) << " t" << maxThreads();
+	Entry entry;
+	GemmTactic tactic{ gemmIsa(), 0 };
+	if (lookup(key.str(), entry)) {
+		std::istringstream ss(entry.tactic);
+		std::string isa;
+		int tile;
+		ss >> isa >> tile >> tactic.threads;
+		if (parseIsa(isa, tactic.isa) && gemmIsaSupported(tactic.isa)) return tactic;
+		return GemmTactic{ gemmIsa(), 0 };
+	}
+
+	auto t0 = std::chrono::high_resolution_clock::now();
+	const std::vector<float> in = randomData((size_t)batch * K);
+	std::vector<float> out((size_t)batch * N);
+	auto run = [&](const CpuGemm& gemm, double limit_us) {
+		return measure([&] { gemm.run(batch, in.data(), out.data()); }, iterations_, limit_us);
+	};
+
+	// 1. 명령어 집합
+	std::unique_ptr<CpuGemm> best(new CpuGemm(N, K, weights, bias, activation, tactic.isa));
+	entry.heuristic_us = entry.best_us = run(*best, std::numeric_limits<double>::max());
+	for (int i = (int)GemmIsa::kSCALAR; i <= (int)detectGemmIsa(); i++) {
+		const GemmIsa isa = (GemmIsa)i;
+		if (isa == tactic.isa) continue;
+		std::unique_ptr<CpuGemm> gemm(new CpuGemm(N, K, weights, bias, activation, isa));
+		const double us = run(*gemm, entry.best_us);
+		if (us < entry.best_us) {
+			entry.best_us = us;
+			tactic.isa = isa;
+			best = std::move(gemm);
+		}
+	}
+	// 2. thread 수 (batch 1 은 memory 대역폭이 먼저 포화)
+	for (int threads : threadCandidates()) {
+		if (threads == maxThreads()) continue;
+		best->setThreads(threads);
+		const double us = run(*best, entry.best_us);
+		if (us < entry.best_us) {
+			entry.best_us = us;
+			tactic.threads = threads;
+		}
+	}
+
+	std::ostringstream value;
+	value << gemmIsaName(tactic.isa) << " 0 " << tactic.threads;
+	entry.tactic = value.str();
+	store(key.str(), entry);
+	stats_.tuning_ms += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+	return tactic;
+}
+
+static KernelTuner*& currentTuner()
+{
+	static KernelTuner* tuner = nullptr;
+	return tuner;
+}
+
+void setKernelTuner(KernelTuner* tuner)
+{
+	currentTuner() = tuner;
+}
+
+KernelTuner* kernelTuner()
+{
+	return currentTuner();
+}
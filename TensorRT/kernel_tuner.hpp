@@ -0,0 +1,79 @@
+﻿#pragma once
+#include <map>
+#include <string>
+#include "cpu_conv.hpp"
+#include "cpu_gemm.hpp"
+
+// conv 실행 설정 (CpuConv 알고리즘 + setSchedule)
+struct ConvTactic {
+	ConvAlgo algo;
+	int tile;		// im2col 출력 pixel tile (GEMM 알고리즘만, 0 이면 기본값)
+	int threads;	// 0 이면 전체
+};
+
+// fully connected 실행 설정 (CpuGemm 명령어 집합 + setThreads)
+struct GemmTactic {
+	GemmIsa isa;
+	int threads;
+};
+
+// 생성 이후 누적 통계
+struct TunerStats {
+	int hits;				// 캐시에서 찾은 shape 수
+	int misses;				// 새로 측정한 shape 수
+	double tuning_ms;		// 측정에 쓴 시간
+	double heuristic_us;	// 조회한 shape 의 기본 선택 (chooseConvAlgo, gemmIsa) 실행 시간 합 (측정 당시 값)
+	double tuned_us;		// 조회한 shape 의 선택된 설정 실행 시간 합
+};
+
+//! \class KernelTuner
+//!
+//! \brief TensorRT tactic 선택처럼 conv, fully connected shape 마다 후보 kernel 을 처음 사용할 때 측정해서 가장 빠른 설정을 선택
+//!  conv 후보 : 지원하는 알고리즘 (direct, 1x1 GEMM, im2col, Winograd) -> 선택된 GEMM 알고리즘의 tile -> thread 수 순서로 좁혀감
+//!  fully connected 후보 : 지원하는 명령어 집합 -> thread 수
+//!  결과는 CPU 모델 이름, (연산, shape, 자료형, 명령어 집합) 을 key 로 text 파일에 저장, 다음 실행은 측정 없이 읽은 값을 사용
+//!  파일 버전이 다르면 전체를 무시, 다른 CPU 의 항목은 그대로 보존 (여러 장비가 같은 파일 공유)
+//!
+class KernelTuner
+{
+public:
+	static const int kVERSION = 1;
+
+	// iterations : 후보마다 측정 횟수 (최소값 사용)
+	explicit KernelTuner(const std::string& cachePath, int iterations = 3);
+
+	// 파일이 없으면 빈 캐시로 true, 형식, 버전 오류는 false
+	bool load();
+	bool save() const;
+
+	// conv 가중치 정렬은 알고리즘마다 다르므로 측정용 CpuConv 를 후보마다 생성
+	ConvTactic tuneConv(const ConvShape& shape, const float* weights, const float* bias, const ConvActivation& activation);
+	// batch : fully connected 의 행 수 (M)
+	GemmTactic tuneGemm(int batch, int N, int K, const float* weights, const float* bias, const ConvActivation& activation);
+
+	const std::string& cpuModel() const { return cpu_; }
+	const std::string& path() const { return path_; }
+	const TunerStats& stats() const { return stats_; }
+	int entries() const { return (int)cache_.size(); }
+
+private:
+	struct Entry {
+		std::string tactic;		// "<algo|isa> <tile> <threads>"
+		double best_us;
+		double heuristic_us;
+	};
+
+	bool lookup(const std::string& key, Entry& entry);
+	void store(const std::string& key, const Entry& entry);
+
+	std::string path_;
+	std::string cpu_;
+	int iterations_;
+	std::map<std::string, Entry> cache_;	// "<cpu>\t<key>" -> 항목
+	TunerStats stats_;
+};
+
+// CpuInterpreter 가 생성시 conv, fully connected 설정을 조회할 tuner (기본 nullptr : chooseConvAlgo, gemmIsa 사용)
+// INT8, NCHWc 로 실행하는 레이어는 대상이 아님
+void setKernelTuner(KernelTuner* tuner);
+KernelTuner* kernelTuner();
@@ -0,0 +1,127 @@
+﻿#include <algorithm>
+#include "cpu_conv.hpp"
+#include "layout_planner.hpp"
+
+using namespace ir;
+
+// conv_bench 기준 NCHWc direct kernel 이 NCHW 알고리즘보다 빠른 shape
+// (1x1 GEMM, Winograd 대상은 NCHW 가 빠르고, 나머지 im2col 대상 중 채널이 block 배수인 경우 NCHWc 가 빠름)
+static bool preferBlocked(const Layer& l)
+{
+	if (l.getInput(0)->getDimensions().nbDims != 3) return false;
+	const ConvShape s = convShapeOf(l);
+	return convSupports(s, ConvAlgo::kDIRECT_NCHWC) && chooseConvAlgo(s) == ConvAlgo::kIM2COL_GEMM;
+}
+
+// d[begin, end) 의 곱
+static int64_t product(const Dims& d, int begin, int end)
+{
+	int64_t n = 1;
+	for (int i = begin; i < end; i++) n *= d.d[i];
+	return n;
+}
+
+static bool channelBlocked(const Tensor* t)
+{
+	const Dims d = t->getDimensions();
+	return d.nbDims == 3 && d.d[0] % kCONV_BLOCK == 0;
+}
+
+// 입력이 모두 NCHWc 이면 같은 코드로 NCHWc 출력을 만드는 레이어
+static bool layoutAgnostic(const Layer& l, const std::vector<TensorLayout>& layouts)
+{
+	const Dims out = l.getOutput(0)->getDimensions();
+	switch (l.getType()) {
+	case LayerType::kACTIVATION:
+	case LayerType::kUNARY:
+		break;
+	case LayerType::kELEMENTWISE:
+		// broadcast 는 index 가 layout 에 따라 달라짐
+		for (int k = 0; k < l.getNbInputs(); k++) {
+			if (l.getInput(k)->getDimensions() != out) return false;
+		}
+		break;
+	case LayerType::kCONCATENATION:
+		// 채널 concat, 입력 채널이 block 배수이면 NCHWc 에서도 입력이 출력의 연속 구간
+		if (l.axis_ != 0) return false;
+		for (int k = 0; k < l.getNbInputs(); k++) {
+			if (!channelBlocked(l.getInput(k))) return false;
+		}
+		break;
+	default:
+		return false;
+	}
+	for (int k = 0; k < l.getNbInputs(); k++) {
+		const Tensor* in = l.getInput(k);
+		if (!in->isBatched() || layouts[in->id()] != TensorLayout::kNCHWC) return false;
+	}
+	return true;
+}
+
+LayoutPlan planLayouts(const Network& network, bool blocked, bool zeroCopyConcat)
+{
+	const int nb_layers = network.getNbLayers(), nb_tensors = network.getNbTensors();
+	LayoutPlan plan{};
+	plan.layouts.assign(nb_tensors, TensorLayout::kNCHW);
+	plan.blocked_layers.assign(nb_layers, 0);
+	plan.convert.assign(nb_tensors, 0);
+	plan.concat_root.assign(nb_tensors, -1);
+	plan.concat_offset.assign(nb_tensors, 0);
+
+	// 1. layout (레이어 순서 = 위상 순서)
+	for (int i = 0; blocked && i < nb_layers; i++) {
+		const Layer* l = network.getLayer(i);
+		const Tensor* out = l->getOutput(0);
+		if (!out->isBatched() || l->getNbOutputs() != 1) continue;
+		const bool conv = l->getType() == LayerType::kCONVOLUTION && preferBlocked(*l);
+		if (!conv && !layoutAgnostic(*l, plan.layouts)) continue;
+		plan.blocked_layers[i] = 1;
+		plan.layouts[out->id()] = TensorLayout::kNCHWC;
+		plan.blocked_convs += conv;
+		plan.blocked_layers_count++;
+	}
+
+	// 2. 변환 : 사용하는 레이어의 layout 이 다르거나 NCHWc network 출력
+	std::vector<std::vector<int>> consumers(nb_tensors);
+	for (int i = 0; i < nb_layers; i++) {
+		const Layer* l = network.getLayer(i);
+		for (int k = 0; k < l->getNbInputs(); k++) {
+			const Tensor* in = l->getInput(k);
+			consumers[in->id()].push_back(i);
+			const bool want = plan.blocked_layers[i] != 0;
+			if (want != (plan.layouts[in->id()] == TensorLayout::kNCHWC)) plan.convert[in->id()] = 1;
+		}
+	}
+	for (int i = 0; i < network.getNbOutputs(); i++) {
+		const Tensor* out = network.getOutput(i);
+		if (plan.layouts[out->id()] == TensorLayout::kNCHWC) plan.convert[out->id()] = 1;
+	}
+	for (int t = 0; t < nb_tensors; t++) plan.conversions += plan.convert[t];
+
+	// 3. zero-copy concat : 바깥 차원이 1 이면 각 입력은 출력 1 sample 안의 연속 구간
+	for (int i = 0; zeroCopyConcat && i < nb_layers; i++) {
+		const Layer* l = network.getLayer(i);
+		if (l->getType() != LayerType::kCONCATENATION) continue;
+		const Tensor* out = l->getOutput(0);
+		const Dims out_dims = out->getDimensions();
+		if (!out->isBatched() || product(out_dims, 0, l->axis_) != 1) continue;
+		const int64_t inner = product(out_dims, l->axis_ + 1, out_dims.nbDims);
+		int64_t offset = 0;
+		for (int k = 0; k < l->getNbInputs(); k++) {
+			const Tensor* in = l->getInput(k);
+			const int64_t block = in->getDimensions().d[l->axis_] * inner;
+			bool ok = in->isBatched() && !in->isNetworkInput() && !in->isNetworkOutput() && plan.concat_root[in->id()] < 0
+				&& plan.layouts[in->id()] == plan.layouts[out->id()];
+			for (int c : consumers[in->id()]) ok &= network.getLayer(c)->getType() != LayerType::kFULLY_CONNECTED;
+			for (int j = 0; j < k; j++) ok &= l->getInput(j) != in;
+			if (ok) {
+				plan.concat_root[in->id()] = out->id();
+				plan.concat_offset[in->id()] = offset;
+				plan.zero_copy_inputs++;
+				plan.concat_bytes_saved += block * (int64_t)sizeof(float);
+			}
+			offset += block;
+		}
+	}
+	return plan;
+}
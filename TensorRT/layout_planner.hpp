@@ -0,0 +1,30 @@
+﻿#pragma once
+#include <cstdint>
+#include <vector>
+#include "graph_ir.hpp"
+
+// CPU 실행 텐서 layout
+enum class TensorLayout {
+	kNCHW,
+	kNCHWC,		// [C / kCONV_BLOCK][H][W][kCONV_BLOCK] (cpu_conv.hpp)
+};
+
+struct LayoutPlan {
+	std::vector<TensorLayout> layouts;		// tensor id 별 저장 layout
+	std::vector<uint8_t> blocked_layers;	// layer index 별 NCHWc 입출력으로 실행
+	std::vector<uint8_t> convert;			// tensor id 별 다른 layout 복사본 필요 (생성 직후 변환)
+	std::vector<int> concat_root;			// tensor id 별 복사 없이 놓이는 concat 출력 tensor id (-1 이면 자체 버퍼)
+	std::vector<int64_t> concat_offset;		// concat 출력 1 sample 안의 시작 위치 (float 개수)
+	int blocked_convs;
+	int blocked_layers_count;
+	int conversions;						// 변환 복사본 수
+	int zero_copy_inputs;					// concat 출력에 직접 쓰는 입력 수
+	int64_t concat_bytes_saved;				// 1 sample 기준 줄어든 concat 복사량
+};
+
+// blocked : NCHWc kernel 이 NCHW 알고리즘보다 빠른 conv (im2col 대상 중 입출력 채널이 block 배수) 를 NCHWc 로 실행하고
+//  그 출력을 받는 layout 무관 레이어 (activation, unary, 같은 shape elementwise, 채널 concat) 로 blocked 영역을 넓힘
+//  NCHW 가 필요한 레이어 (shuffle, pooling, resize, network 출력 등) 와의 경계에만 변환
+// zeroCopyConcat : 바깥 차원이 1 인 concat 의 입력을 concat 출력의 해당 구간에 바로 생성 (C3, SPPF, UNet up 의 채널 concat)
+//  network 입출력, batch 전체를 한번에 읽는 fully connected 의 입력, 두 번째 concat 입력은 제외
+LayoutPlan planLayouts(const ir::Network& network, bool blocked = true, bool zeroCopyConcat = true);
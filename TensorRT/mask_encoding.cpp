@@ -0,0 +1,347 @@
+﻿#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+#include "mask_encoding.hpp"
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define MASK_USE_SSE2
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static inline int countTrailingZeros(uint32_t v)
+{
+#ifdef _MSC_VER
+	unsigned long idx;
+	_BitScanForward(&idx, v);
+	return (int)idx;
+#else
+	return __builtin_ctz(v);
+#endif
+}
+
+// src [rows, cols] -> dst [cols, rows] (32x32 블록 단위 전치)
+static void transposeU8(const uint8_t* src, int rows, int cols, uint8_t* dst)
+{
+	const int B = 32;
+#pragma omp parallel for schedule(static)
+	for (int cb = 0; cb < cols; cb += B) {
+		for (int rb = 0; rb < rows; rb += B) {
+			int ce = std::min(cb + B, cols);
+			int re = std::min(rb + B, rows);
+			for (int c = cb; c < ce; c++) {
+				uint8_t* d = dst + (size_t)c * rows;
+				for (int r = rb; r < re; r++) {
+					d[r] = src[(size_t)r * cols + c];
+				}
+			}
+		}
+	}
+}
+
+// pos 부터 같은 값이 이어지는 구간의 끝 위치 (16 byte 단위 비교)
+static inline int runEnd(const uint8_t* p, int pos, int n)
+{
+	const uint8_t v = p[pos];
+	int i = pos + 1;
+#ifdef MASK_USE_SSE2
+	const __m128i vv = _mm_set1_epi8((char)v);
+	for (; i + 16 <= n; i += 16) {
+		int m = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + i)), vv));
+		if (m != 0xFFFF) {
+			return i + countTrailingZeros(~m & 0xFFFF);
+		}
+	}
+#endif
+	while (i < n && p[i] == v) i++;
+	return i;
+}
+
+void encodeRle(const uint8_t* label, int width, int height, int class_count, std::vector<MaskRle>& rles)
+{
+	const int n = width * height;
+	std::vector<uint8_t> col(n);
+	transposeU8(label, height, width, col.data()); // COCO RLE 는 column-major 순서
+
+	rles.resize(class_count);
+	std::vector<int> last(class_count, 0);	// 클래스별 마지막 foreground run 의 끝 위치
+	for (int c = 0; c < class_count; c++) {
+		rles[c].width = width;
+		rles[c].height = height;
+		rles[c].class_id = c;
+		rles[c].counts.clear();
+	}
+	for (int pos = 0; pos < n;) {
+		int end = runEnd(col.data(), pos, n);
+		int c = col[pos];
+		if (c < class_count) {
+			rles[c].counts.push_back(pos - last[c]);	// 배경 run (0 가능)
+			rles[c].counts.push_back(end - pos);		// foreground run
+			last[c] = end;
+		}
+		pos = end;
+	}
+	for (int c = 0; c < class_count; c++) {
+		if (last[c] < n || rles[c].counts.empty()) {
+			rles[c].counts.push_back(n - last[c]);
+		}
+	}
+}
+
+void decodeRle(const MaskRle& rle, uint8_t* mask)
+{
+	const int n = rle.width * rle.height;
+	std::vector<uint8_t> col(n, 0);
+	int pos = 0;
+	uint8_t v = 0;
+	for (size_t i = 0; i < rle.counts.size() && pos < n; i++) {
+		int len = std::min((int)rle.counts[i], n - pos);
+		if (v) memset(col.data() + pos, 1, len);
+		pos += len;
+		v = !v;
+	}
+	transposeU8(col.data(), rle.width, rle.height, mask);
+}
+
+std::string rleToString(const MaskRle& rle)
+{
+	std::string s;
+	const std::vector<uint32_t>& cnts = rle.counts;
+	for (size_t i = 0; i < cnts.size(); i++) {
+		int64_t x = cnts[i];
+		if (i > 2) x -= (int64_t)cnts[i - 2];
+		bool more = true;
+		while (more) {
+			char c = (char)(x & 0x1f);
+			x >>= 5;
+			more = (c & 0x10) ? x != -1 : x != 0;
+			if (more) c |= 0x20;
+			c += 48;
+			s.push_back(c);
+		}
+	}
+	return s;
+}
+
+void rleFromString(const std::string& str, int width, int height, int class_id, MaskRle& rle)
+{
+	rle.width = width;
+	rle.height = height;
+	rle.class_id = class_id;
+	rle.counts.clear();
+	size_t p = 0;
+	while (p < str.size()) {
+		int64_t x = 0;
+		int k = 0;
+		bool more = true;
+		while (more) {
+			int64_t c = str[p] - 48;
+			x |= (c & 0x1f) << (5 * k);
+			more = (c & 0x20) != 0;
+			p++;
+			k++;
+			if (!more && (c & 0x10)) x |= (int64_t)(~0ULL << (5 * k));
+		}
+		size_t m = rle.counts.size();
+		if (m > 2) x += rle.counts[m - 2];
+		rle.counts.push_back((uint32_t)x);
+	}
+}
+
+// 닫힌 폴리곤 Douglas-Peucker 단순화 (시작점과 가장 먼 점 기준으로 두 체인으로 분할)
+static void simplifyPolygon(std::vector<int>& pts, float epsilon)
+{
+	const int n = (int)pts.size() / 2;
+	if (n <= 3) return;
+	std::vector<char> keep(n, 0);
+	int far_idx = 0;
+	long long far_d = -1;
+	for (int i = 1; i < n; i++) {
+		long long dx = pts[i * 2] - pts[0], dy = pts[i * 2 + 1] - pts[1];
+		if (dx * dx + dy * dy > far_d) {
+			far_d = dx * dx + dy * dy;
+			far_idx = i;
+		}
+	}
+	keep[0] = keep[far_idx] = 1;
+	std::vector<std::pair<int, int>> stack{ { 0, far_idx }, { far_idx, n } }; // [s, e] (e == n 은 시작점)
+	const float eps2 = epsilon * epsilon;
+	while (!stack.empty()) {
+		int s = stack.back().first, e = stack.back().second;
+		stack.pop_back();
+		if (e - s < 2) continue;
+		float ax = (float)pts[s * 2], ay = (float)pts[s * 2 + 1];
+		float bx = (float)pts[(e % n) * 2], by = (float)pts[(e % n) * 2 + 1];
+		float dx = bx - ax, dy = by - ay;
+		float len2 = dx * dx + dy * dy;
+		int idx = -1;
+		float max_d2 = eps2;
+		for (int i = s + 1; i < e; i++) {
+			float px = pts[i * 2] - ax, py = pts[i * 2 + 1] - ay;
+			float d2;
+			if (len2 > 0.f) {
+				float cross = px * dy - py * dx;
+				d2 = cross * cross / len2;
+			}
+			else {
+				d2 = px * px + py * py;
+			}
+			if (d2 > max_d2) {
+				max_d2 = d2;
+				idx = i;
+			}
+		}
+		if (idx >= 0) {
+			keep[idx] = 1;
+			stack.push_back({ s, idx });
+			stack.push_back({ idx, e });
+		}
+	}
+	int k = 0;
+	for (int i = 0; i < n; i++) {
+		if (keep[i]) {
+			pts[k * 2] = pts[i * 2];
+			pts[k * 2 + 1] = pts[i * 2 + 1];
+			k++;
+		}
+	}
+	pts.resize(k * 2);
+}
+
+void findPolygons(const uint8_t* label, int width, int height, int class_id, float epsilon, std::vector<MaskPolygon>& polygons)
+{
+	// 1 pixel 패딩된 int 이미지 (0 : 배경, 1 : 미방문 foreground, +-NBD : 추적된 경계)
+	const int W = width + 2, H = height + 2;
+	std::vector<int> f((size_t)W * H, 0);
+	for (int y = 0; y < height; y++) {
+		const uint8_t* src = label + (size_t)y * width;
+		int* dst = &f[(size_t)(y + 1) * W + 1];
+		for (int x = 0; x < width; x++) {
+			dst[x] = src[x] == class_id;
+		}
+	}
+	// 시계 방향 8-이웃 (E, SE, S, SW, W, NW, N, NE)
+	const int dy[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+	const int dx[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+	auto dirOf = [&](int cy, int cx, int ny, int nx) {
+		for (int d = 0; d < 8; d++) {
+			if (cy + dy[d] == ny && cx + dx[d] == nx) return d;
+		}
+		return 0;
+	};
+
+	int nbd = 1;
+	for (int i = 1; i < H - 1; i++) {
+		for (int j = 1; j < W - 1; j++) {
+			int* row = &f[(size_t)i * W];
+			int fij = row[j];
+			if (fij == 0) continue;
+			bool outer = (fij == 1 && row[j - 1] == 0);
+			bool hole = !outer && (fij >= 1 && row[j + 1] == 0);
+			if (!outer && !hole) continue;
+
+			nbd++;
+			MaskPolygon poly;
+			poly.class_id = class_id;
+			poly.hole = hole;
+			int i2 = i, j2 = outer ? j - 1 : j + 1;
+
+			// (3.1) (i2, j2) 부터 시계 방향으로 0 이 아닌 이웃 탐색
+			int start_d = dirOf(i, j, i2, j2);
+			int i1 = -1, j1 = -1;
+			for (int k = 0; k < 8; k++) {
+				int d = (start_d + k) & 7;
+				if (f[(size_t)(i + dy[d]) * W + j + dx[d]] != 0) {
+					i1 = i + dy[d];
+					j1 = j + dx[d];
+					break;
+				}
+			}
+			if (i1 < 0) { // 단일 픽셀
+				row[j] = -nbd;
+				poly.points.push_back(j - 1);
+				poly.points.push_back(i - 1);
+				polygons.push_back(poly);
+				continue;
+			}
+			i2 = i1; j2 = j1;
+			int i3 = i, j3 = j;
+			while (true) {
+				poly.points.push_back(j3 - 1);
+				poly.points.push_back(i3 - 1);
+				// (3.3) (i2, j2) 다음 위치부터 반시계 방향으로 0 이 아닌 이웃 탐색
+				int d2 = dirOf(i3, j3, i2, j2);
+				bool east_zero = false;
+				int i4 = i3, j4 = j3;
+				for (int k = 1; k <= 8; k++) {
+					int d = (d2 - k + 8) & 7;
+					int v = f[(size_t)(i3 + dy[d]) * W + j3 + dx[d]];
+					if (v != 0) {
+						i4 = i3 + dy[d];
+						j4 = j3 + dx[d];
+						break;
+					}
+					if (d == 0) east_zero = true;
+				}
+				// (3.4) 경계 표시
+				int& f3 = f[(size_t)i3 * W + j3];
+				if (east_zero) f3 = -nbd;
+				else if (f3 == 1) f3 = nbd;
+				// (3.5) 시작점 복귀시 종료
+				if (i4 == i && j4 == j && i3 == i1 && j3 == j1) break;
+				i2 = i3; j2 = j3;
+				i3 = i4; j3 = j4;
+			}
+			if (epsilon > 0.f) simplifyPolygon(poly.points, epsilon);
+			polygons.push_back(poly);
+		}
+	}
+}
+
+void rasterizePolygons(const std::vector<MaskPolygon>& polygons, int width, int height, uint8_t* mask)
+{
+	memset(mask, 0, (size_t)width * height);
+#pragma omp parallel
+	{
+		std::vector<float> xs;
+#pragma omp for schedule(static)
+		for (int y = 0; y < height; y++) {
+			uint8_t* row = mask + (size_t)y * width;
+			for (size_t p = 0; p < polygons.size(); p++) {
+				const std::vector<int>& pts = polygons[p].points;
+				int n = (int)pts.size() / 2;
+				// 윤곽선 픽셀 자체 표시
+				for (int k = 0; k < n; k++) {
+					int x0 = pts[k * 2], y0 = pts[k * 2 + 1];
+					int x1 = pts[((k + 1) % n) * 2], y1 = pts[((k + 1) % n) * 2 + 1];
+					if ((y0 <= y && y <= y1) || (y1 <= y && y <= y0)) {
+						int xa, xb;
+						if (y0 == y1) { xa = std::min(x0, x1); xb = std::max(x0, x1); }
+						else { xa = xb = (int)std::lround(x0 + (float)(x1 - x0) * (y - y0) / (y1 - y0)); }
+						for (int x = std::max(xa, 0); x <= std::min(xb, width - 1); x++) row[x] |= 2;
+					}
+				}
+				// even-odd 내부 채우기 (픽셀 중심 y 기준)
+				xs.clear();
+				for (int k = 0; k < n; k++) {
+					int x0 = pts[k * 2], y0 = pts[k * 2 + 1];
+					int x1 = pts[((k + 1) % n) * 2], y1 = pts[((k + 1) % n) * 2 + 1];
+					if ((y0 <= y && y < y1) || (y1 <= y && y < y0)) {
+						xs.push_back(x0 + (float)(x1 - x0) * (y - y0) / (y1 - y0));
+					}
+				}
+				std::sort(xs.begin(), xs.end());
+				for (size_t k = 0; k + 1 < xs.size(); k += 2) {
+					int xa = std::max((int)std::ceil(xs[k]), 0);
+					int xb = std::min((int)std::floor(xs[k + 1]), width - 1);
+					for (int x = xa; x <= xb; x++) row[x] ^= 1;
+				}
+			}
+			for (int x = 0; x < width; x++) {
+				row[x] = row[x] != 0;
+			}
+		}
+	}
+}
@@ -0,0 +1,38 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// COCO RLE (column-major 순서, 배경(0) run 부터 시작)
+// https://github.com/cocodataset/cocoapi/blob/master/common/maskApi.c
+struct MaskRle {
+	int width;
+	int height;
+	int class_id;
+	std::vector<uint32_t> counts;
+};
+
+// 윤곽선 폴리곤 (x0, y0, x1, y1, ...)
+struct MaskPolygon {
+	int class_id;
+	bool hole;				// 구멍(내부 윤곽선) 여부
+	std::vector<int> points;
+};
+
+// label map [H, W] 를 클래스별 COCO RLE 로 변환 (한번의 스캔으로 모든 클래스 처리)
+// rles[c] : c 번째 클래스의 RLE (class_count 개)
+void encodeRle(const uint8_t* label, int width, int height, int class_count, std::vector<MaskRle>& rles);
+
+// RLE -> binary mask [H, W] (row-major, 0 or 1)
+void decodeRle(const MaskRle& rle, uint8_t* mask);
+
+// COCO 압축 문자열 변환 (pycocotools rleToString / rleFrString 과 동일)
+std::string rleToString(const MaskRle& rle);
+void rleFromString(const std::string& str, int width, int height, int class_id, MaskRle& rle);
+
+// class_id 영역의 외곽선, 구멍 윤곽선 추출 (Suzuki-Abe border following, 8-connectivity)
+// epsilon > 0 이면 Douglas-Peucker 단순화 적용
+void findPolygons(const uint8_t* label, int width, int height, int class_id, float epsilon, std::vector<MaskPolygon>& polygons);
+
+// 폴리곤 -> binary mask [H, W] (even-odd 규칙, 검증용)
+void rasterizePolygons(const std::vector<MaskPolygon>& polygons, int width, int height, uint8_t* mask);
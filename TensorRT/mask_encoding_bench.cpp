@@ -0,0 +1,88 @@
+﻿// 분할 결과 전송 크기, 인코딩 시간 측정 (raw mask vs RLE vs 폴리곤)
+// 512x512 합성 2-class 마스크 기준, RLE 무손실 복원 및 폴리곤 IoU 검증
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include "mask_encoding.hpp"
+
+// 원, 타원, 구멍이 섞인 합성 마스크 생성
+static void makeMask(uint8_t* label, int width, int height, int blob_count, unsigned seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> pos(0.f, 1.f);
+	memset(label, 0, (size_t)width * height);
+	for (int b = 0; b < blob_count; b++) {
+		float cx = pos(rng) * width, cy = pos(rng) * height;
+		float rx = 10.f + pos(rng) * width / 6, ry = 10.f + pos(rng) * height / 6;
+		bool hole = (b % 3 == 2);
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				float dx = (x - cx) / rx, dy = (y - cy) / ry;
+				float d = dx * dx + dy * dy;
+				if (d <= 1.f) label[y * width + x] = (hole && d < 0.25f) ? 0 : 1;
+			}
+		}
+	}
+}
+
+int main()
+{
+	const int W = 512, H = 512, C = 2;
+	const int ITER = 200;
+	const int blob_counts[] = { 1, 4, 16 };
+	std::vector<uint8_t> label(W * H), decoded(W * H);
+	std::vector<MaskRle> rles;
+	std::vector<MaskPolygon> polygons;
+
+	std::cout << "raw label map : " << W * H << " bytes, BGR image : " << W * H * 3 << " bytes" << std::endl;
+	for (int blobs : blob_counts) {
+		makeMask(label.data(), W, H, blobs, 1234 + blobs);
+
+		auto t0 = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < ITER; i++) {
+			encodeRle(label.data(), W, H, C, rles);
+		}
+		auto t1 = std::chrono::high_resolution_clock::now();
+		std::string str;
+		for (int i = 0; i < ITER; i++) {
+			str = rleToString(rles[1]);
+		}
+		auto t2 = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < ITER; i++) {
+			polygons.clear();
+			findPolygons(label.data(), W, H, 1, 1.0f, polygons);
+		}
+		auto t3 = std::chrono::high_resolution_clock::now();
+
+		// RLE 무손실 검증 (배열, 문자열 모두)
+		MaskRle parsed;
+		rleFromString(str, W, H, 1, parsed);
+		decodeRle(parsed, decoded.data());
+		int rle_diff = 0;
+		for (int i = 0; i < W * H; i++) {
+			rle_diff += decoded[i] != (label[i] == 1);
+		}
+		// 폴리곤 복원 IoU
+		rasterizePolygons(polygons, W, H, decoded.data());
+		int inter = 0, uni = 0;
+		for (int i = 0; i < W * H; i++) {
+			bool a = label[i] == 1, b = decoded[i] != 0;
+			inter += a && b;
+			uni += a || b;
+		}
+		size_t poly_bytes = 0;
+		for (size_t p = 0; p < polygons.size(); p++) {
+			poly_bytes += polygons[p].points.size() * sizeof(int16_t) + 4; // int16 좌표 + 헤더
+		}
+
+		double enc_us = std::chrono::duration<double, std::micro>(t1 - t0).count() / ITER;
+		double str_us = std::chrono::duration<double, std::micro>(t2 - t1).count() / ITER;
+		double poly_us = std::chrono::duration<double, std::micro>(t3 - t2).count() / ITER;
+		std::cout << "blobs " << blobs << std::endl;
+		std::cout << "  RLE counts  : " << rles[1].counts.size() * sizeof(uint32_t) << " bytes, encode " << enc_us << " us" << std::endl;
+		std::cout << "  RLE string  : " << str.size() << " bytes, serialize " << str_us << " us, mismatch " << rle_diff << std::endl;
+		std::cout << "  polygons    : " << polygons.size() << " contours, " << poly_bytes << " bytes, trace " << poly_us << " us, IoU " << (uni ? (double)inter / uni : 1.0) << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,113 @@
+﻿#include <algorithm>
+#include "memory_planner.hpp"
+
+using namespace ir;
+
+static const int64_t kALIGNMENT = 64;	// cache line (SIMD load 정렬)
+
+static bool inPlaceCandidate(LayerType type)
+{
+	// 같은 index 의 입력을 읽은 뒤 출력에 쓰는 레이어 (cpu_interpreter.cpp 의 구현 기준)
+	return type == LayerType::kELEMENTWISE || type == LayerType::kACTIVATION || type == LayerType::kUNARY || type == LayerType::kSCALE;
+}
+
+MemoryPlan planMemory(const Network& network, int batchSize, PlanStrategy strategy, bool inPlace, const std::vector<int>* elementBytes)
+{
+	auto elementSize = [&](const Tensor* t) { return elementBytes ? (int64_t)(*elementBytes)[t->id()] : (int64_t)sizeof(float); };
+	const int nb_layers = network.getNbLayers();
+	MemoryPlan plan{};
+	plan.offsets.assign(network.getNbTensors(), -1);
+
+	// 1. 수명 (생성 레이어, 마지막 사용 레이어)
+	std::vector<int> first(network.getNbTensors(), -1), last(network.getNbTensors(), -1);
+	for (int i = 0; i < nb_layers; i++) {
+		const Layer* l = network.getLayer(i);
+		for (int k = 0; k < l->getNbOutputs(); k++) first[l->getOutput(k)->id()] = last[l->getOutput(k)->id()] = i;
+		for (int k = 0; k < l->getNbInputs(); k++) last[l->getInput(k)->id()] = i;
+	}
+	for (int i = 0; i < network.getNbOutputs(); i++) last[network.getOutput(i)->id()] = nb_layers;
+
+	std::vector<int> index(network.getNbTensors(), -1);	// tensor id -> lifetimes index
+	for (int i = 0; i < network.getNbTensors(); i++) {
+		const Tensor* t = network.getTensor(i);
+		if (!t->isBatched() || t->isNetworkInput() || first[t->id()] < 0) continue;
+		const int64_t bytes = (volume(t->getDimensions()) * batchSize * elementSize(t) + kALIGNMENT - 1) / kALIGNMENT * kALIGNMENT;
+		index[t->id()] = (int)plan.lifetimes.size();
+		plan.lifetimes.push_back(TensorLifetime{ t->id(), first[t->id()], last[t->id()], bytes, -1 });
+		plan.naive_bytes += bytes;
+	}
+
+	// 2. in-place : 출력이 입력 버퍼를 이어 씀 (root 텐서 하나에 수명을 합침)
+	std::vector<int> root(plan.lifetimes.size());
+	for (int i = 0; i < (int)root.size(); i++) root[i] = i;
+	if (inPlace) {
+		for (int i = 0; i < nb_layers; i++) {
+			const Layer* l = network.getLayer(i);
+			if (!inPlaceCandidate(l->getType())) continue;
+			const Tensor* out = l->getOutput(0);
+			if (index[out->id()] < 0) continue;
+			for (int k = 0; k < l->getNbInputs(); k++) {
+				const Tensor* in = l->getInput(k);
+				const int src = index[in->id()];
+				if (src < 0 || last[in->id()] != i || in->isNetworkOutput() || in->getDimensions() != out->getDimensions() || elementSize(in) != elementSize(out)) continue;
+				const int dst = index[out->id()];
+				root[dst] = root[src];
+				plan.lifetimes[dst].alias = in->id();
+				TensorLifetime& r = plan.lifetimes[root[src]];
+				r.last = std::max(r.last, plan.lifetimes[dst].last);
+				plan.in_place++;
+				break;
+			}
+		}
+	}
+
+	// 3. 동시에 살아있는 크기의 최대 (in-place 로 합친 수명 기준)
+	std::vector<int64_t> live(nb_layers + 1, 0);
+	for (int i = 0; i < (int)root.size(); i++) {
+		if (root[i] != i) continue;
+		const TensorLifetime& t = plan.lifetimes[i];
+		for (int k = t.first; k <= t.last; k++) live[k] += t.bytes;
+	}
+	plan.peak_live_bytes = *std::max_element(live.begin(), live.end());
+
+	// 4. 배치
+	std::vector<int> order;
+	for (int i = 0; i < (int)root.size(); i++) {
+		if (root[i] == i) order.push_back(i);
+	}
+	std::vector<int64_t> offset(root.size(), 0);
+	if (strategy == PlanStrategy::kNAIVE) {
+		for (int i : order) {
+			offset[i] = plan.arena_bytes;
+			plan.arena_bytes += plan.lifetimes[i].bytes;
+		}
+	}
+	else {
+		std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return plan.lifetimes[a].bytes > plan.lifetimes[b].bytes; });
+		std::vector<int> placed;
+		for (int i : order) {
+			const TensorLifetime& t = plan.lifetimes[i];
+			// 수명이 겹치는 배치된 텐서를 offset 순서로, 그 사이 빈 구간 중 들어가는 가장 작은 구간
+			std::vector<int> overlap;
+			for (int p : placed) {
+				const TensorLifetime& q = plan.lifetimes[p];
+				if (q.first <= t.last && t.first <= q.last) overlap.push_back(p);
+			}
+			std::sort(overlap.begin(), overlap.end(), [&](int a, int b) { return offset[a] < offset[b]; });
+			int64_t end = 0, best = -1, best_gap = INT64_MAX;
+			for (int p : overlap) {
+				const int64_t gap = offset[p] - end;
+				if (gap >= t.bytes && gap < best_gap) {
+					best = end;
+					best_gap = gap;
+				}
+				end = std::max(end, offset[p] + plan.lifetimes[p].bytes);
+			}
+			offset[i] = best >= 0 ? best : end;
+			plan.arena_bytes = std::max(plan.arena_bytes, offset[i] + t.bytes);
+			placed.push_back(i);
+		}
+	}
+	for (int i = 0; i < (int)root.size(); i++) plan.offsets[plan.lifetimes[i].tensor] = offset[root[i]];
+	return plan;
+}
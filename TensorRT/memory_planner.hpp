@@ -0,0 +1,35 @@
+﻿#pragma once
+#include <cstdint>
+#include <vector>
+#include "graph_ir.hpp"
+
+// 중간 텐서 메모리 배치 방식
+enum class PlanStrategy {
+	kNAIVE,				// 텐서마다 별도 영역 (배치 전 기준)
+	kGREEDY_BY_SIZE,	// 큰 텐서부터 수명이 겹치는 텐서 사이의 가장 작은 빈 구간에 배치 (best-fit)
+};
+
+// 텐서 수명 : 레이어 실행 순서 기준 [first, last] (첫 생성 레이어 ~ 마지막 사용 레이어, 출력 텐서는 끝까지)
+struct TensorLifetime {
+	int tensor;		// tensor id
+	int first;
+	int last;
+	int64_t bytes;	// batch 포함, 64 byte 배수
+	int alias;		// in-place 로 입력 버퍼를 이어 쓰면 그 텐서 id (없으면 -1)
+};
+
+struct MemoryPlan {
+	std::vector<TensorLifetime> lifetimes;	// arena 에 배치하는 텐서
+	std::vector<int64_t> offsets;			// tensor id 별 arena offset (byte), arena 밖 텐서 (network 입력, 상수) 는 -1
+	int64_t arena_bytes;
+	int64_t naive_bytes;					// 텐서마다 버퍼 하나씩 잡았을 때
+	int64_t peak_live_bytes;				// 한 레이어에서 동시에 살아있는 텐서 크기 합의 최대 (배치 결과의 하한)
+	int in_place;							// 입력 버퍼에 출력을 쓰는 레이어 수
+};
+
+// network 의 batch 텐서 (network 입력 제외) 를 하나의 arena 에 배치
+// 수명은 레이어 순서로 계산하므로 skip connection, concat, 여러 레이어가 쓰는 텐서는 마지막 사용까지 유지
+// inPlace : elementwise, activation, unary, scale 의 입력이 그 레이어에서 끝나고 shape, 원소 크기가 같으면 출력이 입력 버퍼를 사용
+// elementBytes : tensor id 별 원소 크기 (16 bit activation 은 2, nullptr 이면 모두 float)
+MemoryPlan planMemory(const ir::Network& network, int batchSize, PlanStrategy strategy = PlanStrategy::kGREEDY_BY_SIZE, bool inPlace = true,
+	const std::vector<int>* elementBytes = nullptr);
@@ -1,6 +1,7 @@
 #pragma once
 #include <common.h>
 #include <fstream>
+#include "tensor_dump.hpp"
 
 struct Preprocess {
 	int N;
@@ -88,29 +89,23 @@ namespace nvinfer1
 					break; 
 			}
 
-			//  
-			//cudaDeviceSynchronize();
-			//int count = batchSize * H * W * C;
-			//std::cout << "count : " << count << std::endl;
-			//std::vector<float> gpuBuffer(count);
-			//cudaMemcpy(gpuBuffer.data(), output, gpuBuffer.size() * sizeof(float), cudaMemcpyDeviceToHost);
-			//std::ofstream ofs("../Validation_py/trt_0", std::ios::binary);
-			//if (ofs.is_open())
-			//	ofs.write((const char*)gpuBuffer.data(), gpuBuffer.size() * sizeof(float));
-			//ofs.close();
-			//std::exit(0);
-
-			// Է 
-			//cudaDeviceSynchronize();
-			//int count = batchSize * H * W * C;
-			//std::cout << "count : " << count << std::endl;
-			//std::vector<uint8_t> gpuBuffer(count);
-			//cudaMemcpy(gpuBuffer.data(), input, gpuBuffer.size() * sizeof(uint8_t), cudaMemcpyDeviceToHost);
-			//std::ofstream ofs("../Validation_py/trt_1", std::ios::binary);
-			//if (ofs.is_open())
-			//	ofs.write((const char*)gpuBuffer.data(), gpuBuffer.size() * sizeof(uint8_t));
-			//ofs.close();
-			//std::exit(0);
+			// ߰ ټ  (setTensorDump  writer   츸,  )
+			if (TensorDumpWriter* dump = tensorDump()) {
+				if (dump->wants("preprocess_input")) {
+					const int dims[4] = { batchSize, H, W, C };
+					std::vector<uint8_t> host((size_t)batchSize * H * W * C);
+					cudaMemcpyAsync(host.data(), input, host.size() * sizeof(uint8_t), cudaMemcpyDeviceToHost, stream);
+					cudaStreamSynchronize(stream);
+					dump->append("preprocess_input", getPluginType(), kDUMP_UINT8, 4, dims, host.data());
+				}
+				if (dump->wants("preprocess_output")) {
+					const int dims[4] = { batchSize, C, H, W };
+					std::vector<float> host((size_t)batchSize * C * H * W);
+					cudaMemcpyAsync(host.data(), output, host.size() * sizeof(float), cudaMemcpyDeviceToHost, stream);
+					cudaStreamSynchronize(stream);
+					dump->append("preprocess_output", getPluginType(), kDUMP_FLOAT32, 4, dims, host.data());
+				}
+			}
 
 			return 0;
 		}
@@ -0,0 +1,256 @@
+﻿#include <chrono>
+#include <cstring>
+#include "result_stream.hpp"
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+int64_t resultTimestampUs()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+ResultStreamWriter::ResultStreamWriter()
+	: fp_(nullptr), frame_count_(0)
+{
+}
+
+ResultStreamWriter::~ResultStreamWriter()
+{
+	close();
+}
+
+bool ResultStreamWriter::open(const std::string& path, const std::string& model_name)
+{
+	close();
+	fp_ = fopen(path.c_str(), "wb");
+	if (!fp_) return false;
+	setvbuf(fp_, nullptr, _IOFBF, 1 << 20);
+
+	ResultStreamHeader header;
+	memset(&header, 0, sizeof(header));
+	header.magic = kRESULT_STREAM_MAGIC;
+	header.version = kRESULT_STREAM_VERSION;
+	header.header_size = sizeof(ResultStreamHeader);
+	strncpy(header.model_name, model_name.c_str(), sizeof(header.model_name) - 1);
+	fwrite(&header, sizeof(header), 1, fp_);
+	frame_count_ = 0;
+	return true;
+}
+
+void ResultStreamWriter::close()
+{
+	if (fp_) {
+		fclose(fp_);
+		fp_ = nullptr;
+	}
+}
+
+void ResultStreamWriter::append(const ResultFrameInfo& info, bool has_boxes, int count, const float* boxes, const float* scores, const int32_t* class_ids)
+{
+	const size_t box_bytes = has_boxes ? (size_t)count * 4 * sizeof(float) : 0;
+	const size_t body = box_bytes + (size_t)count * (sizeof(float) + sizeof(int32_t));
+	const size_t frame_size = (sizeof(ResultFrameHeader) + body + 7) & ~(size_t)7;
+	frame_.resize(frame_size);
+	char* p = frame_.data();
+
+	ResultFrameHeader header;
+	header.magic = kRESULT_FRAME_MAGIC;
+	header.frame_size = (uint32_t)frame_size;
+	header.frame_index = frame_count_;
+	header.timestamp_us = info.timestamp_us;
+	header.model_version = info.model_version;
+	header.flags = has_boxes ? (uint32_t)kRESULT_HAS_BOXES : 0u;
+	header.count = (uint32_t)count;
+	header.source_id = info.source_id;
+	memcpy(p, &header, sizeof(header));
+	p += sizeof(header);
+	if (count > 0) {
+		if (has_boxes) {
+			memcpy(p, boxes, box_bytes);
+			p += box_bytes;
+		}
+		memcpy(p, scores, count * sizeof(float));
+		p += count * sizeof(float);
+		memcpy(p, class_ids, count * sizeof(int32_t));
+		p += count * sizeof(int32_t);
+	}
+	memset(p, 0, frame_.data() + frame_size - p);
+
+	if (fp_) fwrite(frame_.data(), 1, frame_size, fp_);
+	frame_count_++;
+}
+
+ResultStreamReader::ResultStreamReader()
+	: data_(nullptr), size_(0), mapped_(false)
+#ifdef _WIN32
+	, file_(nullptr), mapping_(nullptr)
+#endif
+{
+}
+
+ResultStreamReader::~ResultStreamReader()
+{
+	close();
+}
+
+bool ResultStreamReader::open(const std::string& path)
+{
+	close();
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) return false;
+	LARGE_INTEGER size;
+	GetFileSizeEx(file, &size);
+	if (size.QuadPart == 0) {
+		CloseHandle(file);
+		return false;
+	}
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping) {
+		CloseHandle(file);
+		return false;
+	}
+	data_ = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	file_ = file;
+	mapping_ = mapping;
+	size_ = (size_t)size.QuadPart;
+#else
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) return false;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		::close(fd);
+		return false;
+	}
+	void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (p == MAP_FAILED) return false;
+	data_ = (const char*)p;
+	size_ = (size_t)st.st_size;
+#endif
+	mapped_ = true;
+	if (!data_ || !buildIndex()) {
+		close();
+		return false;
+	}
+	return true;
+}
+
+bool ResultStreamReader::attach(const void* data, size_t size)
+{
+	close();
+	data_ = (const char*)data;
+	size_ = size;
+	if (!buildIndex()) {
+		close();
+		return false;
+	}
+	return true;
+}
+
+void ResultStreamReader::close()
+{
+	if (mapped_) {
+#ifdef _WIN32
+		if (data_) UnmapViewOfFile(data_);
+		if (mapping_) CloseHandle((HANDLE)mapping_);
+		if (file_) CloseHandle((HANDLE)file_);
+		mapping_ = nullptr;
+		file_ = nullptr;
+#else
+		munmap((void*)data_, size_);
+#endif
+	}
+	mapped_ = false;
+	data_ = nullptr;
+	size_ = 0;
+	offsets_.clear();
+}
+
+// 프레임 헤더만 따라가며 위치 기록 (데이터는 읽지 않음)
+bool ResultStreamReader::buildIndex()
+{
+	if (size_ < sizeof(ResultStreamHeader)) return false;
+	const ResultStreamHeader& h = header();
+	if (h.magic != kRESULT_STREAM_MAGIC || h.version > kRESULT_STREAM_VERSION || h.header_size < sizeof(ResultStreamHeader)) {
+		return false;
+	}
+	size_t pos = h.header_size;
+	while (pos + sizeof(ResultFrameHeader) <= size_) {
+		const ResultFrameHeader* f = (const ResultFrameHeader*)(data_ + pos);
+		if (f->magic != kRESULT_FRAME_MAGIC || f->frame_size < sizeof(ResultFrameHeader) || pos + f->frame_size > size_) break;
+		offsets_.push_back(pos);
+		pos += f->frame_size;
+	}
+	return true;
+}
+
+ResultFrameView ResultStreamReader::frame(size_t index) const
+{
+	ResultFrameView v;
+	const char* p = data_ + offsets_[index];
+	v.header = (const ResultFrameHeader*)p;
+	p += sizeof(ResultFrameHeader);
+	const size_t count = v.header->count;
+	if (v.header->flags & kRESULT_HAS_BOXES) {
+		v.boxes = (const float*)p;
+		p += count * 4 * sizeof(float);
+	}
+	else {
+		v.boxes = nullptr;
+	}
+	v.scores = (const float*)p;
+	v.class_ids = (const int32_t*)(p + count * sizeof(float));
+	return v;
+}
+
+void resultStreamToJson(const ResultStreamReader& reader, std::ostream& os)
+{
+	const ResultStreamHeader& h = reader.header();
+	os << "{\"version\":" << h.version << ",\"model\":\"" << std::string(h.model_name, strnlen(h.model_name, sizeof(h.model_name))) << "\",\"frames\":[\n";
+	for (size_t i = 0; i < reader.frameCount(); i++) {
+		ResultFrameView f = reader.frame(i);
+		os << " {\"frame\":" << f.header->frame_index << ",\"timestamp_us\":" << f.header->timestamp_us
+			<< ",\"model_version\":" << f.header->model_version << ",\"source\":" << f.header->source_id << ",\"results\":[";
+		for (uint32_t k = 0; k < f.header->count; k++) {
+			if (k) os << ",";
+			os << "{\"class\":" << f.class_ids[k] << ",\"score\":" << f.scores[k];
+			if (f.boxes) {
+				const float* b = f.boxes + k * 4;
+				os << ",\"box\":[" << b[0] << "," << b[1] << "," << b[2] << "," << b[3] << "]";
+			}
+			os << "}";
+		}
+		os << "]}" << (i + 1 < reader.frameCount() ? ",\n" : "\n");
+	}
+	os << "]}" << std::endl;
+}
+
+// 결과 한개당 한 행 (classification 프레임은 box 열 비움)
+void resultStreamToCsv(const ResultStreamReader& reader, std::ostream& os)
+{
+	os << "frame,timestamp_us,model_version,source,class,score,x1,y1,x2,y2\n";
+	for (size_t i = 0; i < reader.frameCount(); i++) {
+		ResultFrameView f = reader.frame(i);
+		for (uint32_t k = 0; k < f.header->count; k++) {
+			os << f.header->frame_index << "," << f.header->timestamp_us << "," << f.header->model_version << "," << f.header->source_id
+				<< "," << f.class_ids[k] << "," << f.scores[k];
+			if (f.boxes) {
+				const float* b = f.boxes + k * 4;
+				os << "," << b[0] << "," << b[1] << "," << b[2] << "," << b[3] << "\n";
+			}
+			else {
+				os << ",,,,\n";
+			}
+		}
+	}
+	os.flush();
+}
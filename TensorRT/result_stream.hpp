@@ -0,0 +1,118 @@
+﻿#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// 결과 스트림 파일 구조 (little endian)
+// [ResultStreamHeader] [ResultFrameHeader][boxes][scores][class_ids][pad] [ResultFrameHeader]...
+//  boxes     : float [count, 4] x1, y1, x2, y2 원본 이미지 좌표 (flags & kRESULT_HAS_BOXES 일때만)
+//  scores    : float [count]
+//  class_ids : int32 [count]
+//  프레임 크기는 8 byte 단위로 패딩 (mmap 후 바로 포인터로 접근 가능)
+static const uint32_t kRESULT_STREAM_MAGIC = 0x53525254;	// "TRRS"
+static const uint32_t kRESULT_FRAME_MAGIC = 0x4D415246;		// "FRAM"
+static const uint16_t kRESULT_STREAM_VERSION = 1;
+
+enum ResultFrameFlag : uint32_t {
+	kRESULT_HAS_BOXES = 1,	// detection (boxes 열 포함), 없으면 classification (top-k scores, class_ids)
+};
+
+struct ResultStreamHeader {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t header_size;	// 이후 버전에서 필드 추가시 reader 는 이 크기만큼 건너뜀
+	char model_name[56];
+};
+
+struct ResultFrameHeader {
+	uint32_t magic;
+	uint32_t frame_size;	// 헤더 포함 프레임 전체 크기 (byte)
+	uint64_t frame_index;
+	int64_t timestamp_us;	// system_clock 기준 micro seconds
+	uint32_t model_version;
+	uint32_t flags;			// ResultFrameFlag
+	uint32_t count;			// 결과 개수
+	uint32_t source_id;		// 입력 이미지(카메라) 번호
+};
+
+static_assert(sizeof(ResultStreamHeader) == 64, "ResultStreamHeader layout");
+static_assert(sizeof(ResultFrameHeader) == 40, "ResultFrameHeader layout");
+
+struct ResultFrameInfo {
+	int64_t timestamp_us;
+	uint32_t model_version;
+	uint32_t source_id;
+};
+
+// 현재 시각 (ResultFrameInfo::timestamp_us)
+int64_t resultTimestampUs();
+
+//! \class ResultStreamWriter
+//!
+//! \brief 프레임 단위 결과 기록. 프레임 하나를 재사용 버퍼에 구성한 뒤 한번의 fwrite 로 추가
+//!
+class ResultStreamWriter
+{
+public:
+	ResultStreamWriter();
+	~ResultStreamWriter();
+
+	bool open(const std::string& path, const std::string& model_name);
+	void close();
+
+	// has_boxes 가 false 면 classification 프레임 (scores, class_ids 만 기록, boxes 무시)
+	// detection 프레임은 검출이 없어도 (count 0) has_boxes 로 기록, count 0 이면 포인터는 nullptr 가능
+	void append(const ResultFrameInfo& info, bool has_boxes, int count, const float* boxes, const float* scores, const int32_t* class_ids);
+	uint64_t frameCount() const { return frame_count_; }
+
+private:
+	FILE* fp_;
+	std::vector<char> frame_;	// 프레임 구성 버퍼 (재사용)
+	uint64_t frame_count_;
+};
+
+// mmap 된 프레임의 열 포인터
+struct ResultFrameView {
+	const ResultFrameHeader* header;
+	const float* boxes;			// [count, 4] (kRESULT_HAS_BOXES 가 아니면 nullptr)
+	const float* scores;		// [count]
+	const int32_t* class_ids;	// [count]
+};
+
+//! \class ResultStreamReader
+//!
+//! \brief 결과 스트림 파일을 mmap 으로 열어 복사 없이 프레임 단위로 접근.
+//!  기록 중인 파일의 마지막 불완전한 프레임은 무시
+//!
+class ResultStreamReader
+{
+public:
+	ResultStreamReader();
+	~ResultStreamReader();
+
+	bool open(const std::string& path);
+	bool attach(const void* data, size_t size);	// 이미 메모리에 있는 스트림
+	void close();
+
+	const ResultStreamHeader& header() const { return *(const ResultStreamHeader*)data_; }
+	size_t frameCount() const { return offsets_.size(); }
+	ResultFrameView frame(size_t index) const;
+
+private:
+	bool buildIndex();
+
+	const char* data_;
+	size_t size_;
+	std::vector<size_t> offsets_;	// 프레임 시작 위치
+	bool mapped_;
+#ifdef _WIN32
+	void* file_;
+	void* mapping_;
+#endif
+};
+
+// 디버깅용 변환
+void resultStreamToJson(const ResultStreamReader& reader, std::ostream& os);
+void resultStreamToCsv(const ResultStreamReader& reader, std::ostream& os);
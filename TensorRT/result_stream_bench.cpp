@@ -0,0 +1,68 @@
+﻿// 결과 스트림 기록, mmap 읽기 처리량 측정 (목표 10k frames/s)
+// usage : result_stream_bench [frames] [detections per frame]
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include "result_stream.hpp"
+
+int main(int argc, char** argv)
+{
+	const int frames = argc > 1 ? atoi(argv[1]) : 100000;
+	const int dets = argc > 2 ? atoi(argv[2]) : 20;
+	const char* path = "result_stream_bench.trs";
+
+	std::mt19937 rng(0);
+	std::uniform_real_distribution<float> uni(0.f, 640.f);
+	std::vector<float> boxes(dets * 4), scores(dets);
+	std::vector<int32_t> class_ids(dets);
+	for (int i = 0; i < dets; i++) {
+		boxes[i * 4] = uni(rng);
+		boxes[i * 4 + 1] = uni(rng);
+		boxes[i * 4 + 2] = boxes[i * 4] + 50.f;
+		boxes[i * 4 + 3] = boxes[i * 4 + 1] + 50.f;
+		scores[i] = uni(rng) / 640.f;
+		class_ids[i] = i % 80;
+	}
+
+	// 1. 기록
+	ResultStreamWriter writer;
+	if (!writer.open(path, "yolov5s")) {
+		std::cerr << "[ERROR] result stream open error" << std::endl;
+		return 1;
+	}
+	auto t0 = std::chrono::high_resolution_clock::now();
+	for (int f = 0; f < frames; f++) {
+		ResultFrameInfo info{ resultTimestampUs(), 1, (uint32_t)(f % 4) };
+		writer.append(info, true, dets, boxes.data(), scores.data(), class_ids.data());
+	}
+	writer.close();
+	auto t1 = std::chrono::high_resolution_clock::now();
+
+	// 2. mmap 읽기 (모든 열 순회)
+	ResultStreamReader reader;
+	if (!reader.open(path)) {
+		std::cerr << "[ERROR] result stream read error" << std::endl;
+		return 1;
+	}
+	double checksum = 0.0;
+	size_t total = 0;
+	for (size_t i = 0; i < reader.frameCount(); i++) {
+		ResultFrameView v = reader.frame(i);
+		for (uint32_t k = 0; k < v.header->count; k++) {
+			checksum += v.scores[k] + v.boxes[k * 4] + v.class_ids[k];
+		}
+		total += v.header->count;
+	}
+	auto t2 = std::chrono::high_resolution_clock::now();
+
+	double write_s = std::chrono::duration<double>(t1 - t0).count();
+	double read_s = std::chrono::duration<double>(t2 - t1).count();
+	std::cout << "frames : " << reader.frameCount() << " / " << frames << ", detections : " << total << " (checksum " << checksum << ")" << std::endl;
+	std::cout << "frame size : " << reader.frame(0).header->frame_size << " bytes (AoS Detection : " << dets * 6 * sizeof(float) << " bytes)" << std::endl;
+	std::cout << "write : " << frames / write_s << " frames/s" << std::endl;
+	std::cout << "read  : " << reader.frameCount() / read_s << " frames/s (open + index + scan)" << std::endl;
+	reader.close();
+	remove(path);
+	return 0;
+}
@@ -0,0 +1,25 @@
+﻿// 결과 스트림 파일 -> JSON / CSV 변환 (디버깅용)
+// usage : result_stream_dump <file.trs> [json|csv]
+#include <cstring>
+#include <iostream>
+#include "result_stream.hpp"
+
+int main(int argc, char** argv)
+{
+	if (argc < 2) {
+		std::cerr << "usage : " << argv[0] << " <file.trs> [json|csv]" << std::endl;
+		return 1;
+	}
+	ResultStreamReader reader;
+	if (!reader.open(argv[1])) {
+		std::cerr << "[ERROR] result stream open error : " << argv[1] << std::endl;
+		return 1;
+	}
+	if (argc > 2 && strcmp(argv[2], "csv") == 0) {
+		resultStreamToCsv(reader, std::cout);
+	}
+	else {
+		resultStreamToJson(reader, std::cout);
+	}
+	return 0;
+}
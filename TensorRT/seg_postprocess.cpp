@@ -0,0 +1,261 @@
+﻿#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include "seg_postprocess.hpp"
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define SEG_USE_SSE2
+#endif
+
+LetterboxInfo unetLetterbox(int src_w, int src_h, int net_w, int net_h)
+{
+	LetterboxInfo lb;
+	lb.src_w = src_w;
+	lb.src_h = src_h;
+	lb.net_w = net_w;
+	lb.net_h = net_h;
+	if (src_h == src_w) { // 입력이미지가 정사각형일 경우 (패딩 없이 리사이즈)
+		lb.new_w = net_w;
+		lb.new_h = net_h;
+	}
+	else if (src_w >= src_h) {
+		lb.new_h = (int)(src_h * ((float)net_w / src_w));
+		lb.new_w = net_w;
+	}
+	else {
+		lb.new_h = net_h;
+		lb.new_w = (int)(src_w * ((float)net_h / src_h));
+	}
+	lb.pad_t = (net_h - lb.new_h) / 2;
+	lb.pad_l = (net_w - lb.new_w) / 2;
+	return lb;
+}
+
+void argmaxRow(const float* const* planes, int class_count, int n, uint8_t* label, uint8_t* conf)
+{
+	int x = 0;
+#ifdef SEG_USE_SSE2
+	// 8 픽셀씩 클래스 방향으로 최대값 비교 (동일 값이면 앞의 클래스 유지)
+	for (; x + 8 <= n; x += 8) {
+		__m128 b0 = _mm_loadu_ps(planes[0] + x);
+		__m128 b1 = _mm_loadu_ps(planes[0] + x + 4);
+		__m128i i0 = _mm_setzero_si128();
+		__m128i i1 = _mm_setzero_si128();
+		for (int c = 1; c < class_count; c++) {
+			__m128 v0 = _mm_loadu_ps(planes[c] + x);
+			__m128 v1 = _mm_loadu_ps(planes[c] + x + 4);
+			__m128i m0 = _mm_castps_si128(_mm_cmpgt_ps(v0, b0));
+			__m128i m1 = _mm_castps_si128(_mm_cmpgt_ps(v1, b1));
+			__m128i cc = _mm_set1_epi32(c);
+			b0 = _mm_max_ps(b0, v0);
+			b1 = _mm_max_ps(b1, v1);
+			i0 = _mm_or_si128(_mm_and_si128(m0, cc), _mm_andnot_si128(m0, i0));
+			i1 = _mm_or_si128(_mm_and_si128(m1, cc), _mm_andnot_si128(m1, i1));
+		}
+		__m128i p = _mm_packs_epi32(i0, i1);
+		p = _mm_packus_epi16(p, p);
+		_mm_storel_epi64((__m128i*)(label + x), p);
+	}
+#endif
+	for (; x < n; x++) {
+		float max = planes[0][x];
+		int class_index = 0;
+		for (int c = 1; c < class_count; c++) {
+			if (max < planes[c][x]) {
+				max = planes[c][x];
+				class_index = c;
+			}
+		}
+		label[x] = (uint8_t)class_index;
+	}
+
+	if (conf == nullptr) return;
+	// softmax 최대 확률 = 1 / sum(exp(z_c - z_max))
+	for (x = 0; x < n; x++) {
+		float max = planes[label[x]][x];
+		float sum = 0.f;
+		for (int c = 0; c < class_count; c++) {
+			sum += std::exp(planes[c][x] - max);
+		}
+		conf[x] = (uint8_t)(255.f / sum + 0.5f);
+	}
+}
+
+SegPostprocess::SegPostprocess(const SegPostprocessParam& param)
+	: param_(param)
+{
+	memset(&map_lb_, 0, sizeof(map_lb_));
+	if (param_.colorize && param_.color_lut.size() < (size_t)param_.class_count * 3) {
+		param_.color_lut.resize(param_.class_count * 3, 0);
+	}
+}
+
+// 원본 좌표 -> 크롭된 모델 좌표 테이블 (레터박스 정보가 바뀔 때만 다시 계산)
+void SegPostprocess::prepareMap(const LetterboxInfo& lb)
+{
+	if (memcmp(&lb, &map_lb_, sizeof(lb)) == 0) return;
+	map_lb_ = lb;
+
+	x0_.resize(lb.src_w); x1_.resize(lb.src_w); wx_.resize(lb.src_w);
+	y0_.resize(lb.src_h); y1_.resize(lb.src_h); wy_.resize(lb.src_h);
+	float sx = (float)lb.new_w / lb.src_w;
+	float sy = (float)lb.new_h / lb.src_h;
+
+	if (param_.resize_mode == SegResize::kNEAREST) {
+		for (int x = 0; x < lb.src_w; x++) {
+			x0_[x] = std::min((int)((x + 0.5f) * sx), lb.new_w - 1);
+		}
+		for (int y = 0; y < lb.src_h; y++) {
+			y0_[y] = std::min((int)((y + 0.5f) * sy), lb.new_h - 1);
+		}
+	}
+	else { // half pixel center (cv::INTER_LINEAR 과 동일한 좌표계)
+		for (int x = 0; x < lb.src_w; x++) {
+			float fx = std::max((x + 0.5f) * sx - 0.5f, 0.f);
+			x0_[x] = std::min((int)fx, lb.new_w - 1);
+			x1_[x] = std::min(x0_[x] + 1, lb.new_w - 1);
+			wx_[x] = fx - x0_[x];
+		}
+		for (int y = 0; y < lb.src_h; y++) {
+			float fy = std::max((y + 0.5f) * sy - 0.5f, 0.f);
+			y0_[y] = std::min((int)fy, lb.new_h - 1);
+			y1_[y] = std::min(y0_[y] + 1, lb.new_h - 1);
+			wy_[y] = fy - y0_[y];
+		}
+	}
+}
+
+void SegPostprocess::run(const float* logits, const LetterboxInfo& lb, SegResult& result)
+{
+	prepareMap(lb);
+	result.width = lb.src_w;
+	result.height = lb.src_h;
+	size_t count = (size_t)lb.src_w * lb.src_h;
+	result.label.resize(count);
+	result.conf.resize(param_.confidence ? count : 0);
+	result.color.resize(param_.colorize ? count * 3 : 0);
+
+	if (param_.resize_mode == SegResize::kNEAREST) {
+		runNearest(logits, lb, result);
+	}
+	else {
+		runBilinear(logits, lb, result);
+	}
+	if (param_.emit_rle || param_.emit_polygon) {
+		encodeMasks(result);
+	}
+}
+
+// 전송용 마스크 인코딩 (label map 전체 대신 클래스별 RLE, 폴리곤만 전달)
+void SegPostprocess::encodeMasks(SegResult& result)
+{
+	result.rle.clear();
+	result.polygons.clear();
+	encodeRle(result.label.data(), result.width, result.height, param_.class_count, rles_);
+	for (int c = 1; c < param_.class_count; c++) {
+		if (rles_[c].counts.size() < 2) continue; // 해당 클래스 영역 없음
+		if (param_.emit_rle) {
+			result.rle.push_back(rles_[c]);
+		}
+		if (param_.emit_polygon) {
+			findPolygons(result.label.data(), result.width, result.height, c, param_.polygon_epsilon, result.polygons);
+		}
+	}
+}
+
+// 모델 해상도에서 argmax 후 원본 좌표로 샘플링 (필요한 행만 계산)
+void SegPostprocess::runNearest(const float* logits, const LetterboxInfo& lb, SegResult& result)
+{
+	const int C = param_.class_count;
+	const size_t plane = (size_t)param_.net_h * param_.net_w;
+	net_label_.resize((size_t)lb.new_h * lb.new_w);
+	net_conf_.resize(param_.confidence ? net_label_.size() : 0);
+	row_used_.assign(lb.new_h, 0);
+	for (int y = 0; y < lb.src_h; y++) {
+		row_used_[y0_[y]] = 1;
+	}
+
+#pragma omp parallel
+	{
+		std::vector<const float*> planes(C);
+#pragma omp for schedule(static)
+		for (int r = 0; r < lb.new_h; r++) {
+			if (!row_used_[r]) continue;
+			const float* row = logits + (size_t)(lb.pad_t + r) * param_.net_w + lb.pad_l;
+			for (int c = 0; c < C; c++) {
+				planes[c] = row + c * plane;
+			}
+			argmaxRow(planes.data(), C, lb.new_w, &net_label_[(size_t)r * lb.new_w], param_.confidence ? &net_conf_[(size_t)r * lb.new_w] : nullptr);
+		}
+	}
+
+	const uint8_t* lut = param_.color_lut.data();
+#pragma omp parallel for schedule(static)
+	for (int y = 0; y < lb.src_h; y++) {
+		const uint8_t* src_label = &net_label_[(size_t)y0_[y] * lb.new_w];
+		uint8_t* label = &result.label[(size_t)y * lb.src_w];
+		for (int x = 0; x < lb.src_w; x++) {
+			label[x] = src_label[x0_[x]];
+		}
+		if (param_.confidence) {
+			const uint8_t* src_conf = &net_conf_[(size_t)y0_[y] * lb.new_w];
+			uint8_t* conf = &result.conf[(size_t)y * lb.src_w];
+			for (int x = 0; x < lb.src_w; x++) {
+				conf[x] = src_conf[x0_[x]];
+			}
+		}
+		if (param_.colorize) {
+			uint8_t* color = &result.color[(size_t)y * lb.src_w * 3];
+			for (int x = 0; x < lb.src_w; x++) {
+				const uint8_t* c = lut + label[x] * 3;
+				color[x * 3] = c[0];
+				color[x * 3 + 1] = c[1];
+				color[x * 3 + 2] = c[2];
+			}
+		}
+	}
+}
+
+// logits 를 원본 좌표로 bilinear 보간 후 argmax (행 단위로 세로 -> 가로 보간)
+void SegPostprocess::runBilinear(const float* logits, const LetterboxInfo& lb, SegResult& result)
+{
+	const int C = param_.class_count;
+	const size_t plane = (size_t)param_.net_h * param_.net_w;
+	const uint8_t* lut = param_.color_lut.data();
+
+#pragma omp parallel
+	{
+		std::vector<float> vrow((size_t)C * lb.new_w);	// 세로 보간 결과 [C, new_w]
+		std::vector<float> hrow((size_t)C * lb.src_w);	// 가로 보간 결과 [C, src_w]
+		std::vector<const float*> planes(C);
+#pragma omp for schedule(static)
+		for (int y = 0; y < lb.src_h; y++) {
+			const float wy = wy_[y];
+			for (int c = 0; c < C; c++) {
+				const float* a = logits + c * plane + (size_t)(lb.pad_t + y0_[y]) * param_.net_w + lb.pad_l;
+				const float* b = logits + c * plane + (size_t)(lb.pad_t + y1_[y]) * param_.net_w + lb.pad_l;
+				float* v = &vrow[(size_t)c * lb.new_w];
+				for (int x = 0; x < lb.new_w; x++) {
+					v[x] = a[x] + (b[x] - a[x]) * wy;
+				}
+				float* h = &hrow[(size_t)c * lb.src_w];
+				for (int x = 0; x < lb.src_w; x++) {
+					float l = v[x0_[x]];
+					h[x] = l + (v[x1_[x]] - l) * wx_[x];
+				}
+				planes[c] = h;
+			}
+			uint8_t* label = &result.label[(size_t)y * lb.src_w];
+			argmaxRow(planes.data(), C, lb.src_w, label, param_.confidence ? &result.conf[(size_t)y * lb.src_w] : nullptr);
+			if (param_.colorize) {
+				uint8_t* color = &result.color[(size_t)y * lb.src_w * 3];
+				for (int x = 0; x < lb.src_w; x++) {
+					const uint8_t* c = lut + label[x] * 3;
+					color[x * 3] = c[0];
+					color[x * 3 + 1] = c[1];
+					color[x * 3 + 2] = c[2];
+				}
+			}
+		}
+	}
+}
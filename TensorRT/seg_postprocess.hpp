@@ -0,0 +1,80 @@
+﻿#pragma once
+#include <cstdint>
+#include <vector>
+#include "mask_encoding.hpp"
+
+// 레터박스 전처리 정보 (원본 이미지 -> 모델 입력)
+// 후처리에서 패딩 영역 제거 및 원본 해상도 복원에 사용
+struct LetterboxInfo {
+	int src_w;	// 원본 이미지 크기
+	int src_h;
+	int net_w;	// 모델 입력 크기
+	int net_h;
+	int new_w;	// 리사이즈된 이미지 크기 (패딩 제외)
+	int new_h;
+	int pad_l;	// 좌, 상단 패딩 크기
+	int pad_t;
+};
+
+// unet.cpp, calibrator(process_type 1) 전처리와 동일한 레터박스 계산
+LetterboxInfo unetLetterbox(int src_w, int src_h, int net_w, int net_h);
+
+// 원본 해상도로 복원시 사용할 보간 방법
+enum class SegResize { kNEAREST, kBILINEAR };
+
+struct SegPostprocessParam {
+	int class_count;
+	int net_h;
+	int net_w;
+	SegResize resize_mode;
+	bool confidence;			// uint8 신뢰도 맵 출력 (softmax 최대 확률 * 255), exp 연산은 이때만 수행
+	bool colorize;				// color_lut 이용한 BGR 이미지 출력
+	std::vector<uint8_t> color_lut;	// [class_count * 3] BGR 색상 테이블 (flat)
+	bool emit_rle;				// 클래스별 COCO RLE 출력 (배경(0) 제외)
+	bool emit_polygon;			// 클래스별 윤곽선 폴리곤 출력 (배경(0) 제외)
+	float polygon_epsilon;		// 폴리곤 단순화 허용 오차 (pixel, 0 이면 단순화 없음)
+};
+
+struct SegResult {
+	int width;
+	int height;
+	std::vector<uint8_t> label;	// [H, W] class index
+	std::vector<uint8_t> conf;	// [H, W] (confidence == true 일때)
+	std::vector<uint8_t> color;	// [H, W, 3] BGR (colorize == true 일때)
+	std::vector<MaskRle> rle;			// emit_rle == true 일때 (영역이 있는 클래스만)
+	std::vector<MaskPolygon> polygons;	// emit_polygon == true 일때
+};
+
+//! \class SegPostprocess
+//!
+//! \brief 분할 모델 출력(logits [C, H, W]) 후처리.
+//!  argmax(SIMD) -> 레터박스 패딩 제거 -> 원본 해상도 복원 -> 신뢰도, 컬러 출력을 한번에 수행 (행 단위 멀티스레드)
+//!
+class SegPostprocess
+{
+public:
+	SegPostprocess(const SegPostprocessParam& param);
+
+	// logits : 한 이미지의 모델 출력 [class_count, net_h, net_w]
+	void run(const float* logits, const LetterboxInfo& lb, SegResult& result);
+
+private:
+	void prepareMap(const LetterboxInfo& lb);
+	void runNearest(const float* logits, const LetterboxInfo& lb, SegResult& result);
+	void runBilinear(const float* logits, const LetterboxInfo& lb, SegResult& result);
+	void encodeMasks(SegResult& result);
+
+	SegPostprocessParam param_;
+	LetterboxInfo map_lb_;			// 현재 좌표 테이블을 만든 레터박스 정보
+	std::vector<int> x0_, x1_;		// 원본 x -> 크롭된 모델 x 좌표
+	std::vector<int> y0_, y1_;		// 원본 y -> 크롭된 모델 y 좌표
+	std::vector<float> wx_, wy_;	// 보간 가중치 (bilinear)
+	std::vector<uint8_t> net_label_;	// 모델 해상도 argmax 결과 (nearest)
+	std::vector<uint8_t> net_conf_;
+	std::vector<char> row_used_;
+	std::vector<MaskRle> rles_;		// 전체 클래스 RLE (재사용)
+};
+
+// 한 행(n 픽셀)에 대한 클래스 방향 argmax (SIMD)
+// planes[c] : c번째 클래스의 행 데이터 시작 포인터, conf 가 nullptr 이면 확률 계산 생략
+void argmaxRow(const float* const* planes, int class_count, int n, uint8_t* label, uint8_t* conf);
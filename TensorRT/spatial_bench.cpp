@@ -0,0 +1,189 @@
+﻿// cpu_spatial.hpp 의 max pooling, resize kernel 과 기존 레이어별 계산 (window 직접 비교, resize 후 padding 복사) 비교
+// usage : spatial_bench [-n iterations] [-t threads]
+// shape 는 예제 모델의 실제 크기
+//   yolov5s 640 SPPF (256 x 20 x 20, k 5 max pooling 3 번), nearest 2 배 upsample 2 개 (뒤에 concat)
+//   unet 512 bilinear align corners 2 배 upsample 4 개 (뒤에 padding, concat)
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "cpu_spatial.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+static double bestMs(int iterations, const std::function<void()>& fn)
+{
+	fn();	// warm up
+	double ms = 1e30;
+	for (int it = 0; it < iterations; it++) {
+		auto t0 = std::chrono::high_resolution_clock::now();
+		fn();
+		auto t1 = std::chrono::high_resolution_clock::now();
+		ms = std::min(ms, std::chrono::duration<double, std::milli>(t1 - t0).count());
+	}
+	return ms;
+}
+
+// 기준 : 출력마다 window 전체 비교 (stride 1, 범위 밖은 제외)
+static void maxPoolReference(const float* in, int planes, int H, int W, int K, int P, float* out)
+{
+#pragma omp parallel for schedule(static)
+	for (int p = 0; p < planes; p++) {
+		for (int oh = 0; oh < H; oh++) {
+			for (int ow = 0; ow < W; ow++) {
+				const int h0 = std::max(oh - P, 0), h1 = std::min(oh - P + K, H);
+				const int w0 = std::max(ow - P, 0), w1 = std::min(ow - P + K, W);
+				float m = -INFINITY;
+				for (int h = h0; h < h1; h++) {
+					for (int w = w0; w < w1; w++) m = std::max(m, in[((size_t)p * H + h) * W + w]);
+				}
+				out[((size_t)p * H + oh) * W + ow] = m;
+			}
+		}
+	}
+}
+
+// 기준 : 출력 pixel 마다 좌표 변환 (resize 레이어) 후 padding 레이어가 다시 복사
+static void resizeReference(const ResizeShape& s, const float* in, float* resized, float* out)
+{
+	const bool align = s.align_corners;
+	const float sy = align ? (s.OH > 1 ? (float)(s.H - 1) / (s.OH - 1) : 0.f) : (float)s.H / s.OH;
+	const float sx = align ? (s.OW > 1 ? (float)(s.W - 1) / (s.OW - 1) : 0.f) : (float)s.W / s.OW;
+#pragma omp parallel for schedule(static)
+	for (int p = 0; p < s.planes; p++) {
+		const float* src = in + (size_t)p * s.H * s.W;
+		for (int oh = 0; oh < s.OH; oh++) {
+			const float y = oh * sy;
+			for (int ow = 0; ow < s.OW; ow++) {
+				const float x = ow * sx;
+				float v;
+				if (s.nearest) {
+					const int iy = std::min(align ? (int)std::lround(y) : (int)std::floor(y), s.H - 1);
+					const int ix = std::min(align ? (int)std::lround(x) : (int)std::floor(x), s.W - 1);
+					v = src[(size_t)iy * s.W + ix];
+				}
+				else {
+					const int y0 = std::min((int)y, s.H - 1), y1 = std::min(y0 + 1, s.H - 1);
+					const int x0 = std::min((int)x, s.W - 1), x1 = std::min(x0 + 1, s.W - 1);
+					const float fy = y - y0, fx = x - x0;
+					const float* r0 = src + (size_t)y0 * s.W;
+					const float* r1 = src + (size_t)y1 * s.W;
+					const float top = r0[x0] + (r0[x1] - r0[x0]) * fx;
+					const float bottom = r1[x0] + (r1[x1] - r1[x0]) * fx;
+					v = top + (bottom - top) * fy;
+				}
+				resized[((size_t)p * s.OH + oh) * s.OW + ow] = v;
+			}
+		}
+	}
+	if (s.nearest) return;	// yolov5s upsample 은 바로 concat
+	const int FH = s.PT + s.OH + s.PB, FW = s.PL + s.OW + s.PR;
+#pragma omp parallel for schedule(static)
+	for (int p = 0; p < s.planes; p++) {
+		for (int oh = 0; oh < FH; oh++) {
+			const int ih = oh - s.PT;
+			for (int ow = 0; ow < FW; ow++) {
+				const int iw = ow - s.PL;
+				out[((size_t)p * FH + oh) * FW + ow] = ih >= 0 && ih < s.OH && iw >= 0 && iw < s.OW ? resized[((size_t)p * s.OH + ih) * s.OW + iw] : 0.f;
+			}
+		}
+	}
+}
+
+static double maxAbsDiff(const std::vector<float>& a, const std::vector<float>& b)
+{
+	double diff = 0.0;
+	for (size_t i = 0; i < a.size(); i++) diff = std::max(diff, (double)std::fabs(a[i] - b[i]));
+	return diff;
+}
+
+static void printRow(const std::string& name, const std::string& shape, double base_ms, double fast_ms, double diff)
+{
+	std::cout << std::left << std::setw(22) << name << std::setw(22) << shape << std::right << std::fixed << std::setprecision(3)
+		<< std::setw(11) << base_ms << std::setw(11) << fast_ms << std::setprecision(2) << std::setw(9) << base_ms / fast_ms << "x"
+		<< std::scientific << std::setprecision(1) << std::setw(12) << diff << std::fixed;
+	if (diff != 0.0) std::cout << " [ERROR]";
+	std::cout << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	int iterations = 20;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-n") && i + 1 < argc) iterations = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+#ifdef _OPENMP
+			omp_set_num_threads(atoi(argv[++i]));
+#else
+			++i;
+#endif
+		}
+	}
+
+	std::mt19937 rng(0);
+	std::normal_distribution<float> normal(0.f, 1.f);
+	std::cout << std::left << std::setw(22) << "kernel" << std::setw(22) << "shape" << std::right << std::setw(11) << "base ms" << std::setw(11) << "fast ms"
+		<< std::setw(10) << "speedup" << std::setw(12) << "max diff" << std::endl;
+
+	// SPPF : pool1 -> pool2 -> pool3 (k 5, padding 2), 기준은 레이어마다 전체 plane 을 다시 읽음
+	{
+		const int C = 256, H = 20, W = 20, K = 5, P = K / 2;
+		std::vector<float> in((size_t)C * H * W);
+		for (auto& v : in) v = normal(rng);
+		std::vector<std::vector<float>> base(3, std::vector<float>(in.size())), fast(3, std::vector<float>(in.size()));
+		MaxPoolStage stages[3];
+		for (int s = 0; s < 3; s++) stages[s] = MaxPoolStage{ K, K, P, P, H, W, fast[s].data() };
+		const double base_ms = bestMs(iterations, [&]() {
+			maxPoolReference(in.data(), C, H, W, K, P, base[0].data());
+			maxPoolReference(base[0].data(), C, H, W, K, P, base[1].data());
+			maxPoolReference(base[1].data(), C, H, W, K, P, base[2].data());
+		});
+		const double fast_ms = bestMs(iterations, [&]() { maxPoolCascade(in.data(), C, H, W, stages, 3); });
+		double diff = 0.0;
+		for (int s = 0; s < 3; s++) diff = std::max(diff, maxAbsDiff(base[s], fast[s]));
+		printRow("yolov5s SPPF k5 x3", "256x20x20", base_ms, fast_ms, diff);
+		// window 크기에 따른 변화 (직접 비교는 k^2, running max 는 일정)
+		for (int k : { 9, 13 }) {
+			MaxPoolStage stage{ k, k, k / 2, k / 2, H, W, fast[0].data() };
+			const double b = bestMs(iterations, [&]() { maxPoolReference(in.data(), C, H, W, k, k / 2, base[0].data()); });
+			const double f = bestMs(iterations, [&]() { maxPoolCascade(in.data(), C, H, W, &stage, 1); });
+			printRow("max pool k" + std::to_string(k), "256x20x20", b, f, maxAbsDiff(base[0], fast[0]));
+		}
+	}
+
+	// resize (+ padding) : { planes, H, W, OH, OW, nearest, align corners, PT, PL, PB, PR }
+	struct Case {
+		const char* name;
+		ResizeShape shape;
+	};
+	const Case cases[] = {
+		{ "yolov5s upsample11", { 256, 20, 20, 40, 40, true, false, 0, 0, 0, 0 } },
+		{ "yolov5s upsample15", { 128, 40, 40, 80, 80, true, false, 0, 0, 0, 0 } },
+		{ "unet up1", { 512, 32, 32, 64, 64, false, true, 0, 0, 0, 0 } },
+		{ "unet up2", { 256, 64, 64, 128, 128, false, true, 0, 0, 0, 0 } },
+		{ "unet up3", { 128, 128, 128, 256, 256, false, true, 0, 0, 0, 0 } },
+		{ "unet up4", { 64, 256, 256, 512, 512, false, true, 0, 0, 0, 0 } },
+		{ "unet up4 (pad 1)", { 64, 255, 255, 510, 510, false, true, 1, 1, 1, 1 } },	// 홀수 크기 입력의 padding
+	};
+	for (const Case& c : cases) {
+		const ResizeShape& s = c.shape;
+		std::vector<float> in((size_t)s.planes * s.H * s.W);
+		for (auto& v : in) v = normal(rng);
+		const size_t out_size = (size_t)s.planes * (s.PT + s.OH + s.PB) * (s.PL + s.OW + s.PR);
+		std::vector<float> resized((size_t)s.planes * s.OH * s.OW), base(out_size), fast(out_size);
+		const double base_ms = bestMs(iterations, [&]() { resizeReference(s, in.data(), resized.data(), base.data()); });
+		const double fast_ms = bestMs(iterations, [&]() { resizePadded(s, in.data(), fast.data()); });
+		if (s.nearest) base = resized;
+		const std::string shape = std::to_string(s.planes) + "x" + std::to_string(s.H) + " -> " + std::to_string(s.PT + s.OH + s.PB);
+		printRow(c.name, shape, base_ms, fast_ms, maxAbsDiff(base, fast));
+	}
+	return 0;
+}
@@ -0,0 +1,191 @@
+﻿// 두 tensor dump 파일 (tensor_dump.hpp) 을 이름, 실행 번호로 맞춰서 텐서별 오차 비교, 처음 어긋나는 레이어 찾기
+// usage : tensor_diff <reference.bin> <target.bin> [options]
+//   -t <threads>     OpenMP thread 수 (기본 0 : OpenMP 기본값)
+//   -c <cosine>      이 값보다 cosine 이 작으면 어긋난 텐서로 판단 (기본 0.999)
+//   -q               처음 어긋난 텐서와 요약만 출력
+//   -a <ref>=<target>  이름이 다른 텐서를 짝으로 지정 (여러번 지정 가능)
+//                      TensorRT plugin 은 레이어 이름을 모르므로 "preprocess_input", "preprocess_output", "yololayer_<H>x<W>_output" 로 기록
+// 예 : ir_run yolov5s -d fp32.bin, ir_run yolov5s -p fp16 -d fp16.bin, tensor_diff fp32.bin fp16.bin
+//      Validation_py/tensor_dump.py 로 PyTorch 중간 출력을 기록하면 같은 방식으로 비교
+// 두 파일을 mmap 으로 열고 텐서 쌍을 병렬로 비교 (원소는 구간 단위로 float 변환, 파일 전체를 메모리에 올리지 않음)
+// reference 의 기록 순서 (= 실행 순서) 로 출력, max rel 은 reference 값 기준
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "tensor_dump.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+static const int64_t kDIFF_CHUNK = 1 << 14;
+
+struct RecordDiff {
+	int reference;		// reference 레코드 번호
+	int target;			// target 레코드 번호 (없으면 -1)
+	bool shape_match;
+	double max_abs;
+	double mean_abs;
+	double max_rel;
+	double cosine;
+	int64_t non_finite;	// 한쪽만 nan, inf 인 원소 수
+};
+
+static std::string shapeString(const TensorRecordHeader& h)
+{
+	std::ostringstream os;
+	os << "[";
+	for (int i = 0; i < h.nb_dims; i++) os << (i ? "," : "") << h.dims[i];
+	os << "]";
+	return os.str();
+}
+
+static void compare(const TensorRecordView& ref, const TensorRecordView& tgt, std::vector<float>& buffer, RecordDiff& d)
+{
+	double sum = 0.0, dot = 0.0, na = 0.0, nb = 0.0;
+	buffer.resize(2 * kDIFF_CHUNK);
+	float* a = buffer.data();
+	float* b = buffer.data() + kDIFF_CHUNK;
+	for (int64_t begin = 0; begin < ref.count; begin += kDIFF_CHUNK) {
+		const int64_t n = std::min(kDIFF_CHUNK, ref.count - begin);
+		dumpToFloat(ref, begin, n, a);
+		dumpToFloat(tgt, begin, n, b);
+		for (int64_t i = 0; i < n; i++) {
+			if (std::isfinite(a[i]) != std::isfinite(b[i])) {
+				d.non_finite++;
+				continue;
+			}
+			if (!std::isfinite(a[i])) continue;
+			const double diff = std::fabs((double)a[i] - b[i]);
+			d.max_abs = std::max(d.max_abs, diff);
+			sum += diff;
+			d.max_rel = std::max(d.max_rel, diff / std::max(std::fabs((double)a[i]), 1e-6));
+			dot += (double)a[i] * b[i];
+			na += (double)a[i] * a[i];
+			nb += (double)b[i] * b[i];
+		}
+	}
+	if (ref.count) d.mean_abs = sum / ref.count;
+	d.cosine = (na > 0.0 && nb > 0.0) ? dot / std::sqrt(na * nb) : (na == nb ? 1.0 : 0.0);
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 3) {
+		std::cerr << "usage : tensor_diff <reference.bin> <target.bin> [-t threads] [-c cosine] [-q] [-a ref=target]" << std::endl;
+		return 1;
+	}
+	int threads = 0;
+	double threshold = 0.999;
+	bool quiet = false;
+	std::map<std::string, std::string> aliases;
+	for (int i = 3; i < argc; i++) {
+		if (!strcmp(argv[i], "-t") && i + 1 < argc) threads = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-c") && i + 1 < argc) threshold = atof(argv[++i]);
+		else if (!strcmp(argv[i], "-q")) quiet = true;
+		else if (!strcmp(argv[i], "-a") && i + 1 < argc) {
+			const std::string a = argv[++i];
+			const size_t eq = a.find('=');
+			if (eq != std::string::npos) aliases[a.substr(0, eq)] = a.substr(eq + 1);
+		}
+	}
+#ifdef _OPENMP
+	if (threads > 0) omp_set_num_threads(threads);
+#endif
+
+	TensorDumpReader reference, target;
+	if (!reference.open(argv[1])) {
+		std::cerr << "[ERROR] tensor dump open error : " << argv[1] << std::endl;
+		return 1;
+	}
+	if (!target.open(argv[2])) {
+		std::cerr << "[ERROR] tensor dump open error : " << argv[2] << std::endl;
+		return 1;
+	}
+	std::cout << "reference " << argv[1] << " (" << reference.header().source << ") : " << reference.recordCount() << " tensors" << std::endl;
+	std::cout << "target    " << argv[2] << " (" << target.header().source << ") : " << target.recordCount() << " tensors" << std::endl;
+
+	// 1. 이름, 실행 번호로 짝 맞추기
+	std::vector<RecordDiff> diffs(reference.recordCount());
+	std::vector<bool> matched(target.recordCount(), false);
+	for (int i = 0; i < (int)reference.recordCount(); i++) {
+		const TensorRecordHeader& h = *reference.record(i).header;
+		RecordDiff& d = diffs[i];
+		memset(&d, 0, sizeof(d));
+		d.reference = i;
+		const std::string name(h.name, strnlen(h.name, sizeof(h.name)));
+		auto alias = aliases.find(name);
+		d.target = target.find(alias == aliases.end() ? name : alias->second, h.run);
+		if (d.target >= 0) {
+			matched[d.target] = true;
+			d.shape_match = reference.record(i).count == target.record(d.target).count;
+		}
+	}
+
+	// 2. 텐서 쌍 병렬 비교 (크기가 제각각이라 dynamic)
+	auto t0 = std::chrono::high_resolution_clock::now();
+#pragma omp parallel
+	{
+		std::vector<float> buffer;
+#pragma omp for schedule(dynamic)
+		for (int i = 0; i < (int)diffs.size(); i++) {
+			RecordDiff& d = diffs[i];
+			if (d.target >= 0 && d.shape_match) compare(reference.record(i), target.record(d.target), buffer, d);
+		}
+	}
+	auto t1 = std::chrono::high_resolution_clock::now();
+
+	// 3. 실행 순서로 출력
+	int first = -1, diverged = 0, missing = 0, shape_mismatch = 0;
+	for (const RecordDiff& d : diffs) {
+		if (d.target < 0) missing++;
+		else if (!d.shape_match) shape_mismatch++;
+		else if (d.cosine < threshold || d.non_finite) {
+			diverged++;
+			if (first < 0) first = d.reference;
+		}
+	}
+	std::cout << "  " << std::setw(5) << "#" << "  " << std::left << std::setw(40) << "tensor" << std::setw(20) << "shape" << std::setw(11) << "types"
+		<< std::right << std::setw(12) << "max abs" << std::setw(12) << "mean abs" << std::setw(12) << "max rel" << std::setw(12) << "cosine" << std::endl;
+	for (const RecordDiff& d : diffs) {
+		if (quiet && d.reference != first) continue;
+		const TensorRecordHeader& h = *reference.record(d.reference).header;
+		std::string name(h.name, strnlen(h.name, sizeof(h.name)));
+		if (name.size() > 38) name = name.substr(0, 35) + "...";
+		std::cout << "  " << std::setw(5) << d.reference << "  " << std::left << std::setw(40) << name << std::setw(20) << shapeString(h);
+		if (d.target < 0) {
+			std::cout << "not in target" << std::right << std::endl;
+			continue;
+		}
+		const TensorRecordHeader& th = *target.record(d.target).header;
+		std::cout << std::setw(11) << (std::string(dumpTypeName((DumpType)h.dtype)) + "/" + dumpTypeName((DumpType)th.dtype)) << std::right;
+		if (!d.shape_match) {
+			std::cout << "  shape mismatch, target " << shapeString(th) << std::endl;
+			continue;
+		}
+		std::cout << std::scientific << std::setprecision(3) << std::setw(12) << d.max_abs << std::setw(12) << d.mean_abs << std::setw(12) << d.max_rel
+			<< std::fixed << std::setprecision(6) << std::setw(12) << d.cosine;
+		if (d.non_finite) std::cout << "  " << d.non_finite << " nan/inf";
+		if (d.reference == first) std::cout << "  <- first divergence (" << std::string(h.layer, strnlen(h.layer, sizeof(h.layer))) << ")";
+		std::cout << std::endl;
+	}
+	std::cout.unsetf(std::ios::floatfield);
+
+	int unmatched = 0;
+	for (bool m : matched) unmatched += m ? 0 : 1;
+	std::cout << diffs.size() - missing - shape_mismatch << " compared, " << diverged << " below cosine " << threshold << ", "
+		<< missing << " not in target, " << unmatched << " only in target, " << shape_mismatch << " shape mismatch ("
+		<< std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms)" << std::endl;
+	if (first >= 0) {
+		const TensorRecordHeader& h = *reference.record(first).header;
+		std::cout << "first divergence : " << std::string(h.name, strnlen(h.name, sizeof(h.name))) << " (layer " << std::string(h.layer, strnlen(h.layer, sizeof(h.layer))) << ")" << std::endl;
+	}
+	return first >= 0 ? 2 : 0;
+}
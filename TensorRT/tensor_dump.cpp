@@ -0,0 +1,279 @@
+﻿#include <cstring>
+#include "cpu_half.hpp"
+#include "tensor_dump.hpp"
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const size_t kRECORD_ALIGNMENT = 64;
+
+const char* dumpTypeName(DumpType type)
+{
+	switch (type) {
+	case kDUMP_FLOAT32: return "fp32";
+	case kDUMP_FLOAT16: return "fp16";
+	case kDUMP_BFLOAT16: return "bf16";
+	case kDUMP_INT8: return "int8";
+	case kDUMP_UINT8: return "uint8";
+	case kDUMP_INT32: return "int32";
+	}
+	return "unknown";
+}
+
+size_t dumpTypeSize(DumpType type)
+{
+	switch (type) {
+	case kDUMP_FLOAT16:
+	case kDUMP_BFLOAT16: return 2;
+	case kDUMP_INT8:
+	case kDUMP_UINT8: return 1;
+	default: return 4;
+	}
+}
+
+TensorDumpWriter::TensorDumpWriter()
+	: fp_(nullptr), record_count_(0)
+{
+}
+
+TensorDumpWriter::~TensorDumpWriter()
+{
+	close();
+}
+
+bool TensorDumpWriter::open(const std::string& path, const std::string& source)
+{
+	close();
+	fp_ = fopen(path.c_str(), "wb");
+	if (!fp_) return false;
+	setvbuf(fp_, nullptr, _IOFBF, 1 << 20);
+
+	TensorDumpHeader header;
+	memset(&header, 0, sizeof(header));
+	header.magic = kTENSOR_DUMP_MAGIC;
+	header.version = kTENSOR_DUMP_VERSION;
+	header.header_size = sizeof(TensorDumpHeader);
+	strncpy(header.source, source.c_str(), sizeof(header.source) - 1);
+	fwrite(&header, sizeof(header), 1, fp_);
+	record_count_ = 0;
+	name_counts_.clear();
+	return true;
+}
+
+void TensorDumpWriter::close()
+{
+	if (fp_) {
+		fclose(fp_);
+		fp_ = nullptr;
+	}
+}
+
+bool TensorDumpWriter::wants(const std::string& name) const
+{
+	if (!fp_) return false;
+	if (filter_.empty()) return true;
+	for (const std::string& pattern : filter_) {
+		if (name.find(pattern) != std::string::npos) return true;
+	}
+	return false;
+}
+
+void TensorDumpWriter::append(const std::string& name, const std::string& layer, DumpType type, int nbDims, const int* dims, const void* data, uint32_t run)
+{
+	TensorRecordHeader header;
+	memset(&header, 0, sizeof(header));
+	header.magic = kTENSOR_RECORD_MAGIC;
+	header.dtype = type;
+	header.nb_dims = nbDims < kDUMP_MAX_DIMS ? nbDims : kDUMP_MAX_DIMS;
+	uint64_t count = 1;
+	for (int i = 0; i < header.nb_dims; i++) {
+		header.dims[i] = dims[i];
+		count *= (uint64_t)dims[i];
+	}
+	header.data_bytes = count * dumpTypeSize(type);
+	header.record_size = (sizeof(header) + header.data_bytes + kRECORD_ALIGNMENT - 1) / kRECORD_ALIGNMENT * kRECORD_ALIGNMENT;
+	strncpy(header.name, name.c_str(), sizeof(header.name) - 1);
+	strncpy(header.layer, layer.c_str(), sizeof(header.layer) - 1);
+	static const char zeros[kRECORD_ALIGNMENT] = {};
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (!fp_) return;
+	uint32_t& written = name_counts_[name];
+	header.run = run == kDUMP_AUTO_RUN ? written : run;
+	written++;
+	fwrite(&header, sizeof(header), 1, fp_);
+	fwrite(data, 1, (size_t)header.data_bytes, fp_);
+	fwrite(zeros, 1, (size_t)(header.record_size - sizeof(header) - header.data_bytes), fp_);
+	record_count_++;
+}
+
+static TensorDumpWriter*& currentDump()
+{
+	static TensorDumpWriter* writer = nullptr;
+	return writer;
+}
+
+void setTensorDump(TensorDumpWriter* writer)
+{
+	currentDump() = writer;
+}
+
+TensorDumpWriter* tensorDump()
+{
+	return currentDump();
+}
+
+TensorDumpReader::TensorDumpReader()
+	: data_(nullptr), size_(0), mapped_(false)
+#ifdef _WIN32
+	, file_(nullptr), mapping_(nullptr)
+#endif
+{
+}
+
+TensorDumpReader::~TensorDumpReader()
+{
+	close();
+}
+
+bool TensorDumpReader::open(const std::string& path)
+{
+	close();
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) return false;
+	LARGE_INTEGER size;
+	GetFileSizeEx(file, &size);
+	if (size.QuadPart == 0) {
+		CloseHandle(file);
+		return false;
+	}
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping) {
+		CloseHandle(file);
+		return false;
+	}
+	data_ = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	file_ = file;
+	mapping_ = mapping;
+	size_ = (size_t)size.QuadPart;
+#else
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) return false;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		::close(fd);
+		return false;
+	}
+	void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (p == MAP_FAILED) return false;
+	data_ = (const char*)p;
+	size_ = (size_t)st.st_size;
+#endif
+	mapped_ = true;
+	if (!data_ || !buildIndex()) {
+		close();
+		return false;
+	}
+	return true;
+}
+
+bool TensorDumpReader::attach(const void* data, size_t size)
+{
+	close();
+	data_ = (const char*)data;
+	size_ = size;
+	if (!buildIndex()) {
+		close();
+		return false;
+	}
+	return true;
+}
+
+void TensorDumpReader::close()
+{
+	if (mapped_) {
+#ifdef _WIN32
+		if (data_) UnmapViewOfFile(data_);
+		if (mapping_) CloseHandle((HANDLE)mapping_);
+		if (file_) CloseHandle((HANDLE)file_);
+		mapping_ = nullptr;
+		file_ = nullptr;
+#else
+		munmap((void*)data_, size_);
+#endif
+	}
+	mapped_ = false;
+	data_ = nullptr;
+	size_ = 0;
+	offsets_.clear();
+	index_.clear();
+}
+
+// 레코드 헤더만 따라가며 위치, 이름 기록 (데이터는 읽지 않음)
+bool TensorDumpReader::buildIndex()
+{
+	if (size_ < sizeof(TensorDumpHeader)) return false;
+	const TensorDumpHeader& h = header();
+	if (h.magic != kTENSOR_DUMP_MAGIC || h.version > kTENSOR_DUMP_VERSION || h.header_size < sizeof(TensorDumpHeader)) {
+		return false;
+	}
+	size_t pos = h.header_size;
+	while (pos + sizeof(TensorRecordHeader) <= size_) {
+		const TensorRecordHeader* r = (const TensorRecordHeader*)(data_ + pos);
+		if (r->magic != kTENSOR_RECORD_MAGIC || r->record_size < sizeof(TensorRecordHeader) + r->data_bytes || pos + r->record_size > size_) break;
+		const std::string name(r->name, strnlen(r->name, sizeof(r->name)));
+		index_.insert({ { name, r->run }, (int)offsets_.size() });	// 같은 이름, 실행 번호가 여러번이면 처음 기록
+		offsets_.push_back(pos);
+		pos += (size_t)r->record_size;
+	}
+	return true;
+}
+
+TensorRecordView TensorDumpReader::record(size_t index) const
+{
+	TensorRecordView v;
+	const char* p = data_ + offsets_[index];
+	v.header = (const TensorRecordHeader*)p;
+	v.data = p + sizeof(TensorRecordHeader);
+	v.count = (int64_t)(v.header->data_bytes / dumpTypeSize((DumpType)v.header->dtype));
+	return v;
+}
+
+int TensorDumpReader::find(const std::string& name, uint32_t run) const
+{
+	auto it = index_.find({ name, run });
+	return it == index_.end() ? -1 : it->second;
+}
+
+void dumpToFloat(const TensorRecordView& record, int64_t begin, int64_t n, float* out)
+{
+	switch ((DumpType)record.header->dtype) {
+	case kDUMP_FLOAT32:
+		memcpy(out, (const float*)record.data + begin, (size_t)n * sizeof(float));
+		break;
+	case kDUMP_FLOAT16:
+		halfToFloat((const uint16_t*)record.data + begin, out, n, HalfFormat::kFP16);
+		break;
+	case kDUMP_BFLOAT16:
+		halfToFloat((const uint16_t*)record.data + begin, out, n, HalfFormat::kBF16);
+		break;
+	case kDUMP_INT8:
+		for (int64_t i = 0; i < n; i++) out[i] = ((const int8_t*)record.data)[begin + i];
+		break;
+	case kDUMP_UINT8:
+		for (int64_t i = 0; i < n; i++) out[i] = ((const uint8_t*)record.data)[begin + i];
+		break;
+	case kDUMP_INT32:
+		for (int64_t i = 0; i < n; i++) out[i] = (float)((const int32_t*)record.data)[begin + i];
+		break;
+	}
+}
@@ -0,0 +1,128 @@
+﻿#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 중간 텐서 dump 파일 구조 (little endian, Validation_py/tensor_dump.py 와 같은 형식)
+// [TensorDumpHeader] [TensorRecordHeader][data][pad] [TensorRecordHeader]...
+//  data : 원소 형식 dtype 의 row-major 값 (batch 텐서는 dims[0] 이 batch)
+//  레코드 크기는 64 byte 단위로 패딩 (mmap 후 data 가 cache line 정렬)
+static const uint32_t kTENSOR_DUMP_MAGIC = 0x44545254;		// "TRTD"
+static const uint32_t kTENSOR_RECORD_MAGIC = 0x534E4554;	// "TENS"
+static const uint16_t kTENSOR_DUMP_VERSION = 1;
+static const int kDUMP_MAX_DIMS = 8;
+static const uint32_t kDUMP_AUTO_RUN = 0xFFFFFFFF;			// append : 같은 이름으로 기록한 횟수를 실행 번호로 사용
+
+enum DumpType : uint32_t {
+	kDUMP_FLOAT32 = 0,
+	kDUMP_FLOAT16 = 1,	// IEEE half
+	kDUMP_BFLOAT16 = 2,
+	kDUMP_INT8 = 3,
+	kDUMP_UINT8 = 4,
+	kDUMP_INT32 = 5,
+};
+const char* dumpTypeName(DumpType type);
+size_t dumpTypeSize(DumpType type);
+
+struct TensorDumpHeader {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t header_size;	// 이후 버전에서 필드 추가시 reader 는 이 크기만큼 건너뜀
+	char source[56];		// 기록한 실행 (예 : "yolov5s cpu fp16", "pytorch")
+};
+
+struct TensorRecordHeader {
+	uint32_t magic;
+	uint32_t dtype;			// DumpType
+	uint64_t record_size;	// 헤더 포함 레코드 전체 크기 (byte)
+	uint64_t data_bytes;
+	uint32_t run;			// 같은 텐서를 여러번 기록할 때 실행 번호
+	int32_t nb_dims;
+	int32_t dims[kDUMP_MAX_DIMS];
+	char name[128];			// 텐서 이름 (diff 에서 두 파일을 맞추는 기준)
+	char layer[128];		// 텐서를 만든 레이어 이름
+};
+
+static_assert(sizeof(TensorDumpHeader) == 64, "TensorDumpHeader layout");
+static_assert(sizeof(TensorRecordHeader) == 320, "TensorRecordHeader layout");
+
+//! \class TensorDumpWriter
+//!
+//! \brief 이름 붙은 중간 텐서를 실행을 멈추지 않고 dump 파일에 추가 (shape, 원소 형식, 레이어 이름 포함)
+//!  filter 가 있으면 이름에 filter 문자열 중 하나가 포함된 텐서만 기록
+//!  append 는 여러 thread 에서 동시에 호출 가능 (cpu_scheduler 의 레이어 병렬 실행)
+//!
+class TensorDumpWriter
+{
+public:
+	TensorDumpWriter();
+	~TensorDumpWriter();
+
+	bool open(const std::string& path, const std::string& source);
+	void close();
+
+	void setFilter(const std::vector<std::string>& patterns) { filter_ = patterns; }
+	bool wants(const std::string& name) const;
+	// dims : nbDims 개 (batch 포함), data : 원소 dims 곱 개
+	void append(const std::string& name, const std::string& layer, DumpType type, int nbDims, const int* dims, const void* data, uint32_t run = kDUMP_AUTO_RUN);
+	uint64_t recordCount() const { return record_count_; }
+
+private:
+	FILE* fp_;
+	std::vector<std::string> filter_;
+	std::mutex mutex_;
+	std::map<std::string, uint32_t> name_counts_;	// 이름별 기록 횟수 (kDUMP_AUTO_RUN)
+	uint64_t record_count_;
+};
+
+// 실행 중인 코드 (TensorRT plugin enqueue 등) 가 기록할 writer (기본 nullptr : 기록 안함)
+void setTensorDump(TensorDumpWriter* writer);
+TensorDumpWriter* tensorDump();
+
+// mmap 된 레코드
+struct TensorRecordView {
+	const TensorRecordHeader* header;
+	const void* data;
+	int64_t count;			// 원소 개수
+};
+
+//! \class TensorDumpReader
+//!
+//! \brief dump 파일을 mmap 으로 열어 복사 없이 레코드 단위로 접근, 이름 (+ 실행 번호) 으로 검색
+//!  기록 중인 파일의 마지막 불완전한 레코드는 무시
+//!
+class TensorDumpReader
+{
+public:
+	TensorDumpReader();
+	~TensorDumpReader();
+
+	bool open(const std::string& path);
+	bool attach(const void* data, size_t size);	// 이미 메모리에 있는 dump
+	void close();
+
+	const TensorDumpHeader& header() const { return *(const TensorDumpHeader*)data_; }
+	size_t recordCount() const { return offsets_.size(); }
+	TensorRecordView record(size_t index) const;
+	// 없으면 -1
+	int find(const std::string& name, uint32_t run = 0) const;
+
+private:
+	bool buildIndex();
+
+	const char* data_;
+	size_t size_;
+	std::vector<size_t> offsets_;	// 레코드 시작 위치
+	std::map<std::pair<std::string, uint32_t>, int> index_;
+	bool mapped_;
+#ifdef _WIN32
+	void* file_;
+	void* mapping_;
+#endif
+};
+
+// 레코드 [begin, begin + n) 원소를 float 로 변환
+void dumpToFloat(const TensorRecordView& record, int64_t begin, int64_t n, float* out);
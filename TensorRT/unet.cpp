@@ -14,6 +14,8 @@
 #include "preprocess.hpp"	// preprocess plugin 
 #include "logging.hpp"	
 #include "calibrator.h"		// ptq
+#include "seg_postprocess.hpp"	// segmentation postprocess
+#include "connected_components.hpp"	// instance 분리
 
 using namespace nvinfer1;
 sample::Logger gLogger;
@@ -257,6 +259,7 @@ int main()
 {
 	unsigned int maxBatchSize = 1;	// 생성할 TensorRT 엔진파일에서 사용할 배치 사이즈 값 
 	bool serialize = true;			// Serialize 강제화 시키기(true 엔진 파일 생성)
+	bool dump_tensors = false;		// 첫 추론의 plugin 중간 텐서 (preprocess), 엔진 출력을 dump 파일로 기록 (tensor_diff 로 ir_run -d 결과와 비교)
 	char engineFileName[] = "unet";
 	char engine_file_path[256];
 	sprintf(engine_file_path, "../Engine/%s_%d.engine", engineFileName, precision_mode);
@@ -314,7 +317,7 @@ int main()
 	
 	// CPU에서 입력과 출력으로 사용할 메모리 공간할당
 	std::vector<uint8_t> input(maxBatchSize * INPUT_H * INPUT_W * INPUT_C);	// 입력이 담길 컨테이너 변수 생성
-	std::vector<float> outputs(OUTPUT_SIZE);
+	std::vector<float> outputs(maxBatchSize * OUTPUT_SIZE);
 
 	// 4) 입력으로 사용할 이미지 준비하기 (resize & letterbox padding) openCV 사용
 	std::string img_dir = "../Unet_py/data";
@@ -325,15 +328,18 @@ int main()
 	else {
 		std::cout << "Total number of images : " << file_names.size() << std::endl << std::endl;
 	}
-	cv::Mat ori_img;
+	std::vector<cv::Mat> ori_imgs(maxBatchSize);	// batch index 별 원본 (후처리 결과를 같은 이미지에 합성)
+	std::vector<LetterboxInfo> letterbox(maxBatchSize); // 후처리에서 패딩 제거 및 원본 크기 복원에 사용
 	for (int idx = 0; idx < maxBatchSize; idx++) { // mat -> vector<uint8_t> 
-		cv::Mat ori_img = cv::imread(file_names[idx]);
+		cv::Mat& ori_img = ori_imgs[idx];
+		ori_img = cv::imread(file_names[idx]);
 		int ori_w = ori_img.cols;
 		int ori_h = ori_img.rows;
+		letterbox[idx] = unetLetterbox(ori_w, ori_h, INPUT_W, INPUT_H);
 		if (ori_h == ori_w) { // 입력이미지가 정사각형일 경우
 			cv::Mat img_r(INPUT_H, INPUT_W, CV_8UC3);
 			cv::resize(ori_img, img_r, img_r.size(), cv::INTER_LINEAR); // 모델 사이즈로 리사이즈
-			memcpy(input.data(), img_r.data, maxBatchSize * INPUT_H * INPUT_W * INPUT_C);
+			memcpy(input.data() + idx * INPUT_H * INPUT_W * INPUT_C, img_r.data, INPUT_H * INPUT_W * INPUT_C);
 		}
 		else {
 			int new_h, new_w;
@@ -355,14 +361,9 @@ int main()
 			int rb = ((new_w % 2) == 1) ? lb + 1 : lb;
 			cv::Mat img_p(INPUT_H, INPUT_W, CV_8UC3);
 			cv::copyMakeBorder(img_r, img_p, tb, bb, lb, rb, cv::BORDER_CONSTANT, cv::Scalar(128, 128, 128));
-			memcpy(input.data(), img_p.data, maxBatchSize * INPUT_H * INPUT_W * INPUT_C);
+			memcpy(input.data() + idx * INPUT_H * INPUT_W * INPUT_C, img_p.data, INPUT_H * INPUT_W * INPUT_C);
 		}
 	}
-	//std::ofstream ofs("../Validation_py/trt_1", std::ios::binary);
-	//if (ofs.is_open())
-	//	ofs.write((const char*)input.data(), input.size() * sizeof(uint8_t));
-	//ofs.close();
-	//std::exit(0);
 
 	std::cout << "===== input load done =====" << std::endl << std::endl;
 
@@ -372,12 +373,35 @@ int main()
 	// CUDA 스트림 생성
 	cudaStream_t stream;
 	CHECK(cudaStreamCreate(&stream));
+
+	// 중간 텐서 dump : 한번 추론하면서 plugin 이 기록한 텐서와 엔진 출력 (batch 포함 binding shape) 저장
+	if (dump_tensors) {
+		char dump_file_path[256];
+		sprintf(dump_file_path, "../Engine/%s_%d.dump", engineFileName, precision_mode);
+		TensorDumpWriter dump;
+		if (dump.open(dump_file_path, std::string(engineFileName) + " trt " + std::to_string(precision_mode))) {
+			setTensorDump(&dump);
+			CHECK(cudaMemcpyAsync(buffers[inputIndex], input.data(), maxBatchSize * INPUT_C * INPUT_H * INPUT_W * sizeof(uint8_t), cudaMemcpyHostToDevice, stream));
+			context->enqueue(maxBatchSize, buffers, stream, nullptr);
+			CHECK(cudaMemcpyAsync(outputs.data(), buffers[outputIndex], maxBatchSize * OUTPUT_SIZE * sizeof(float), cudaMemcpyDeviceToHost, stream));
+			cudaStreamSynchronize(stream);
+			setTensorDump(nullptr);
+			const Dims d = engine->getBindingDimensions(outputIndex);
+			int dims[kDUMP_MAX_DIMS] = { (int)maxBatchSize };
+			for (int j = 0; j < d.nbDims && j + 1 < kDUMP_MAX_DIMS; j++) dims[j + 1] = d.d[j];
+			dump.append(OUTPUT_BLOB_NAME, "output", kDUMP_FLOAT32, std::min(d.nbDims + 1, kDUMP_MAX_DIMS), dims, outputs.data());
+			dump.close();
+			std::cout << "dump " << dump_file_path << " : " << dump.recordCount() << " tensors" << std::endl << std::endl;
+		}
+		else {
+			std::cerr << "[ERROR] file open error : " << dump_file_path << std::endl;
+		}
+	}
+
 	CHECK(cudaMemcpyAsync(buffers[inputIndex], input.data(), maxBatchSize * INPUT_C * INPUT_H * INPUT_W * sizeof(uint8_t), cudaMemcpyHostToDevice, stream));
 	context->enqueue(maxBatchSize, buffers, stream, nullptr);
 	CHECK(cudaMemcpyAsync(outputs.data(), buffers[outputIndex], maxBatchSize * OUTPUT_SIZE * sizeof(float), cudaMemcpyDeviceToHost, stream));
 	cudaStreamSynchronize(stream);
-	//tofile(outputs, "../Validation_py/trt");
-	//std::exit(0);
 
 	// 5) Inference 수행  
 	for (int i = 0; i < iter_count; i++) {
@@ -399,37 +423,29 @@ int main()
 	std::cout << "Model : " << engineFileName << ", Precision : " << precision_mode << std::endl;
 	std::cout << iter_count << " th Iteration, Total dur time : " << dur_time << " [milliseconds]" << std::endl;
 	
-	// 이미지 출력 로직
-	std::vector<uint8_t> show_img(maxBatchSize * INPUT_C * INPUT_H * INPUT_W);
-	std::vector<float> prob(maxBatchSize * INPUT_H * INPUT_W);
-	std::vector<uint8_t> index_c(maxBatchSize * INPUT_H * INPUT_W);
-	std::vector<std::vector<unsigned char>> color = { {0,0,0}, {255,255,255} }; // class 수 만큼 색 준비
-
-	for (int midx = 0; midx < prob.size(); midx++) {
-		float sum = 0.f;
-		float max = 0.f;
-		int class_index;
-		for (int i = 0; i < class_count; i++)
-		{
-			int ⁠g_idx_i = midx + i * prob.size();
-			float z = exp(outputs[⁠g_idx_i]);
-			sum += z;
-			if (max < z) {
-				class_index = i;
-				max = z;
-			}
+	// 이미지 출력 로직 (argmax, 패딩 제거, 원본 크기 복원, 컬러 변환)
+	SegPostprocessParam seg_param{ class_count, INPUT_H, INPUT_W, SegResize::kNEAREST, false, true, { 0,0,0, 255,255,255 } }; // class 수 만큼 색 준비
+	SegPostprocess seg_postprocess(seg_param);
+	ConnectedComponents components({ 8, 0, false });
+	for (int b = 0; b < maxBatchSize; b++) {
+		SegResult seg_result;
+		seg_postprocess.run(outputs.data() + b * OUTPUT_SIZE, letterbox[b], seg_result);
+
+		cv::Mat frame = cv::Mat(seg_result.height, seg_result.width, CV_8UC3, seg_result.color.data());
+		cv::Mat blend;
+		cv::addWeighted(ori_imgs[b], 0.5, frame, 0.5, 0, blend);
+
+		// 객체(car) 단위 분리, bbox 출력
+		ComponentResult instances;
+		components.run(seg_result.label.data(), seg_result.width, seg_result.height, instances);
+		std::cout << "[" << b << "] instance count : " << instances.components.size() << std::endl;
+		for (const ComponentStats& st : instances.components) {
+			cv::rectangle(blend, cv::Rect(st.left, st.top, st.width, st.height), cv::Scalar(0, 0, 255), 2);
 		}
-		prob[midx] = max / sum;
-		index_c[midx] = class_index;
-		show_img[midx * 3]		= color[class_index][0];
-		show_img[midx * 3 + 1]	= color[class_index][1];
-		show_img[midx * 3 + 2]	= color[class_index][2];
+		cv::imshow("result", blend);
+		cv::waitKey(0);
 	}
 
-	cv::Mat frame = cv::Mat(INPUT_H , INPUT_W, CV_8UC3, show_img.data());
-	cv::imshow("result", frame);
-	cv::waitKey(0);
-
 	std::cout << "==================================================" << std::endl;
 
 	// Release...
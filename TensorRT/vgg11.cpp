@@ -164,6 +164,7 @@ int main()
 	//   
 	unsigned int maxBatchSize = 1;	//  TensorRT Ͽ  ġ   
 	bool serialize = false;			// Serialize ȭ Ű(true   )
+	bool dump_tensors = false;		// ù ߷ plugin ߰ ټ (preprocess),   dump Ϸ  (tensor_diff  ir_run -d  )
 	char engineFileName[] = "vgg11";
 
 	char engine_file_path[256];
@@ -247,6 +248,30 @@ int main()
 	cudaStream_t stream;
 	CHECK(cudaStreamCreate(&stream));
 
+	// ߰ ټ dump : ѹ ߷ϸ鼭 plugin   ټ   (batch  binding shape) 
+	if (dump_tensors) {
+		char dump_file_path[256];
+		sprintf(dump_file_path, "../Engine/%s.dump", engineFileName);
+		TensorDumpWriter dump;
+		if (dump.open(dump_file_path, std::string(engineFileName) + " trt")) {
+			setTensorDump(&dump);
+			CHECK(cudaMemcpyAsync(buffers[inputIndex], input.data(), maxBatchSize * INPUT_C * INPUT_H * INPUT_W * sizeof(uint8_t), cudaMemcpyHostToDevice, stream));
+			context->enqueue(maxBatchSize, buffers, stream, nullptr);
+			CHECK(cudaMemcpyAsync(outputs.data(), buffers[outputIndex], maxBatchSize * OUTPUT_SIZE * sizeof(float), cudaMemcpyDeviceToHost, stream));
+			cudaStreamSynchronize(stream);
+			setTensorDump(nullptr);
+			const Dims d = engine->getBindingDimensions(outputIndex);
+			int dims[kDUMP_MAX_DIMS] = { (int)maxBatchSize };
+			for (int j = 0; j < d.nbDims && j + 1 < kDUMP_MAX_DIMS; j++) dims[j + 1] = d.d[j];
+			dump.append(OUTPUT_BLOB_NAME, "output", kDUMP_FLOAT32, std::min(d.nbDims + 1, kDUMP_MAX_DIMS), dims, outputs.data());
+			dump.close();
+			std::cout << "dump " << dump_file_path << " : " << dump.recordCount() << " tensors" << std::endl << std::endl;
+		}
+		else {
+			std::cerr << "[ERROR] file open error : " << dump_file_path << std::endl;
+		}
+	}
+
 	// 5) Inference   
 	for (int i = 0; i < iter_count; i++) {
 		// DMA input batch data to device, infer on the batch asynchronously, and DMA output back to host
@@ -1,6 +1,7 @@
 #pragma once
 #include <common.h>
 #include <fstream>
+#include "tensor_dump.hpp"
 
 struct Yololayer {
 	int C;
@@ -73,29 +74,17 @@ namespace nvinfer1
 			void yololayer_cu(float* output, float* input, float* anchor_grid, int batchSize, int height, int width, int CLASS_NUM, int Grid_stride, cudaStream_t stream);
 			yololayer_cu(output, input, anchor_grid, batchSize, Height, Width, CLASS_NUM, Grid_stride, stream);
 			
-			//  
-			//cudaDeviceSynchronize();
-			//int count = batchSize * H * W * C;
-			//std::cout << "count : " << count << std::endl;
-			//std::vector<float> gpuBuffer(count);
-			//cudaMemcpy(gpuBuffer.data(), output, gpuBuffer.size() * sizeof(float), cudaMemcpyDeviceToHost);
-			//std::ofstream ofs("../Validation_py/trt_0", std::ios::binary);
-			//if (ofs.is_open())
-			//	ofs.write((const char*)gpuBuffer.data(), gpuBuffer.size() * sizeof(float));
-			//ofs.close();
-			//std::exit(0);
-
-			// Է 
-			//cudaDeviceSynchronize();
-			//int count = batchSize * H * W * C;
-			//std::cout << "count : " << count << std::endl;
-			//std::vector<uint8_t> gpuBuffer(count);
-			//cudaMemcpy(gpuBuffer.data(), input, gpuBuffer.size() * sizeof(uint8_t), cudaMemcpyDeviceToHost);
-			//std::ofstream ofs("../Validation_py/trt_1", std::ios::binary);
-			//if (ofs.is_open())
-			//	ofs.write((const char*)gpuBuffer.data(), gpuBuffer.size() * sizeof(uint8_t));
-			//ofs.close();
-			//std::exit(0);
+			// ߰ ټ  (setTensorDump  writer   츸,  )
+			if (TensorDumpWriter* dump = tensorDump()) {
+				const std::string name = "yololayer_" + std::to_string(Height) + "x" + std::to_string(Width) + "_output";
+				if (dump->wants(name)) {
+					const int dims[3] = { batchSize, Height * Width * mYololayer.C, 6 };
+					std::vector<float> host((size_t)dims[0] * dims[1] * dims[2]);
+					cudaMemcpyAsync(host.data(), output, host.size() * sizeof(float), cudaMemcpyDeviceToHost, stream);
+					cudaStreamSynchronize(stream);
+					dump->append(name, getPluginType(), kDUMP_FLOAT32, 3, dims, host.data());
+				}
+			}
 
 			return 0;
 		}
@@ -15,6 +15,7 @@
 #include "yololayer.hpp"	// yololayer plugin 
 #include "logging.hpp"	
 #include "calibrator.h"		// ptq
+#include "result_stream.hpp"	// columnar result stream
 
 using namespace nvinfer1;
 sample::Logger gLogger;
@@ -30,6 +31,7 @@ static const int MAX_OUTPUT_BBOX_COUNT = 300;
 static const int OUTPUT_SIZE = 6 * MAX_OUTPUT_BBOX_COUNT;  
 //static const int OUTPUT_SIZE = 6 * 25200;  
 static const int precision_mode = 8; // fp32 : 32, fp16 : 16, int8(ptq) : 8
+static const uint32_t MODEL_VERSION = 1; //  Ʈ ϵǴ  
 
 // yolov5s 
 static const float  gd = 0.33;
@@ -317,6 +319,7 @@ int main()
 	//   
 	unsigned int maxBatchSize = 1;	//  TensorRT Ͽ  ġ   
 	bool serialize = false;			// Serialize ȭ Ű(true   )
+	bool dump_tensors = false;		// ù ߷ plugin ߰ ټ (preprocess, yololayer),   dump Ϸ  (tensor_diff  ir_run -d  )
 	char engineFileName[] = "yolov5s";
 	char engine_file_path[256];
 	sprintf(engine_file_path, "../Engine/%s_%d.engine", engineFileName, precision_mode);
@@ -420,12 +423,6 @@ int main()
 		}
 	}
 
-	//std::ofstream ofs("../Validation_py/trt_1", std::ios::binary);
-	//if (ofs.is_open())
-	//	ofs.write((const char*)input.data(), input.size() * sizeof(uint8_t));
-	//ofs.close();
-	//std::exit(0);
-
 	std::cout << "===== input load done =====" << std::endl << std::endl;
 
 	uint64_t dur_time = 0;
@@ -435,13 +432,35 @@ int main()
 	cudaStream_t stream;
 	CHECK(cudaStreamCreate(&stream));
 
+	// ߰ ټ dump : ѹ ߷ϸ鼭 plugin   ټ   (batch  binding shape) 
+	if (dump_tensors) {
+		char dump_file_path[256];
+		sprintf(dump_file_path, "../Engine/%s_%d.dump", engineFileName, precision_mode);
+		TensorDumpWriter dump;
+		if (dump.open(dump_file_path, std::string(engineFileName) + " trt " + std::to_string(precision_mode))) {
+			setTensorDump(&dump);
+			CHECK(cudaMemcpyAsync(buffers[inputIndex], input.data(), maxBatchSize * INPUT_C * INPUT_H * INPUT_W * sizeof(uint8_t), cudaMemcpyHostToDevice, stream));
+			context->enqueue(maxBatchSize, buffers, stream, nullptr);
+			CHECK(cudaMemcpyAsync(outputs.data(), buffers[outputIndex], maxBatchSize * OUTPUT_SIZE * sizeof(float), cudaMemcpyDeviceToHost, stream));
+			cudaStreamSynchronize(stream);
+			setTensorDump(nullptr);
+			const Dims d = engine->getBindingDimensions(outputIndex);
+			int dims[kDUMP_MAX_DIMS] = { (int)maxBatchSize };
+			for (int j = 0; j < d.nbDims && j + 1 < kDUMP_MAX_DIMS; j++) dims[j + 1] = d.d[j];
+			dump.append(OUTPUT_BLOB_NAME, "output", kDUMP_FLOAT32, std::min(d.nbDims + 1, kDUMP_MAX_DIMS), dims, outputs.data());
+			dump.close();
+			std::cout << "dump " << dump_file_path << " : " << dump.recordCount() << " tensors" << std::endl << std::endl;
+		}
+		else {
+			std::cerr << "[ERROR] file open error : " << dump_file_path << std::endl;
+		}
+	}
+
 	//ӵ  ù 1ȸ  ϱ  
 	CHECK(cudaMemcpyAsync(buffers[inputIndex], input.data(), maxBatchSize * INPUT_C * INPUT_H * INPUT_W * sizeof(uint8_t), cudaMemcpyHostToDevice, stream));
 	context->enqueue(maxBatchSize, buffers, stream, nullptr);
 	CHECK(cudaMemcpyAsync(outputs.data(), buffers[outputIndex], maxBatchSize * OUTPUT_SIZE * sizeof(float), cudaMemcpyDeviceToHost, stream));
 	cudaStreamSynchronize(stream);
-	//tofile(outputs);
-	//std::exit(0);
 
 	if (true) {
 		std::vector<std::vector<Detection>> batch_res(maxBatchSize);
@@ -449,14 +468,28 @@ int main()
 			auto& res = batch_res[b];
 			nms(res, &outputs[b * OUTPUT_SIZE]);
 		}
+		//  Ʈ  (̹  , result_stream_dump  json/csv Ȯ)
+		char result_file_path[256];
+		sprintf(result_file_path, "../Engine/%s_%d.trs", engineFileName, precision_mode);
+		ResultStreamWriter result_writer;
+		if (!result_writer.open(result_file_path, engineFileName)) {
+			std::cerr << "[ERROR] result stream open error" << std::endl;
+		}
+		std::vector<float> boxes, scores;
+		std::vector<int32_t> class_ids;
 		for (int b = 0; b < maxBatchSize; b++) {
 			auto& res = batch_res[b];
 			cv::Mat img = cv::imread(file_names[b]);
+			boxes.clear(); scores.clear(); class_ids.clear();
 			for (size_t j = 0; j < res.size(); j++) {
 				cv::Rect r = get_rect(img, res[j].bbox);
 				cv::rectangle(img, r, cv::Scalar(0x27, 0xC1, 0x36), 2);
 				cv::putText(img, COCO_names2[(int)res[j].class_id], cv::Point(r.x, r.y - 1), cv::FONT_HERSHEY_PLAIN, 1.2, cv::Scalar(0xFF, 0xFF, 0xFF), 2);
+				boxes.insert(boxes.end(), { (float)r.x, (float)r.y, (float)(r.x + r.width), (float)(r.y + r.height) });
+				scores.push_back(res[j].conf);
+				class_ids.push_back((int32_t)res[j].class_id);
 			}
+			result_writer.append({ resultTimestampUs(), MODEL_VERSION, (uint32_t)b }, true, (int)res.size(), boxes.data(), scores.data(), class_ids.data());
 			cv::imshow(engineFileName, img);
 			cv::waitKey(0);
 		}
@@ -0,0 +1,74 @@
+import struct
+import numpy as np
+
+# same layout as TensorRT/tensor_dump.hpp (compare with TensorRT/tensor_diff)
+DUMP_MAGIC = 0x44545254
+RECORD_MAGIC = 0x534E4554
+DUMP_VERSION = 1
+MAX_DIMS = 8
+HEADER_SIZE = 64
+RECORD_HEADER = struct.Struct("<IIQQIi8i128s128s")
+DTYPES = {np.dtype(np.float32): 0, np.dtype(np.float16): 1, np.dtype(np.int8): 3, np.dtype(np.uint8): 4, np.dtype(np.int32): 5}
+NUMPY_TYPES = {v: k for k, v in DTYPES.items()}
+
+
+class TensorDumpWriter:
+    def __init__(self, path, source="pytorch"):
+        self.file = open(path, "wb")
+        self.counts = {}
+        self.file.write(struct.pack("<IHH56s", DUMP_MAGIC, DUMP_VERSION, HEADER_SIZE, source.encode()[:55]))
+
+    def append(self, name, layer, array, run=None):
+        array = np.ascontiguousarray(array)
+        if array.dtype not in DTYPES:
+            array = array.astype(np.float32)
+        if run is None:
+            run = self.counts.get(name, 0)
+        self.counts[name] = self.counts.get(name, 0) + 1
+        data = array.tobytes()
+        dims = list(array.shape)[:MAX_DIMS] + [0] * (MAX_DIMS - min(array.ndim, MAX_DIMS))
+        record_size = (RECORD_HEADER.size + len(data) + 63) // 64 * 64
+        self.file.write(RECORD_HEADER.pack(RECORD_MAGIC, DTYPES[array.dtype], record_size, len(data), run, min(array.ndim, MAX_DIMS),
+                                           *dims, name.encode()[:127], layer.encode()[:127]))
+        self.file.write(data)
+        self.file.write(b"\0" * (record_size - RECORD_HEADER.size - len(data)))
+
+    def close(self):
+        self.file.close()
+
+
+def read_dump(path):
+    """returns [(name, layer, run, array)] in recorded order"""
+    buf = np.fromfile(path, dtype=np.uint8).tobytes()
+    magic, version, header_size = struct.unpack_from("<IHH", buf, 0)
+    assert magic == DUMP_MAGIC, "not a tensor dump : " + path
+    records = []
+    pos = header_size
+    while pos + RECORD_HEADER.size <= len(buf):
+        h = RECORD_HEADER.unpack_from(buf, pos)
+        if h[0] != RECORD_MAGIC or pos + h[2] > len(buf):
+            break
+        dtype, data_bytes, run, nb_dims = h[1], h[3], h[4], h[5]
+        shape = h[6:6 + nb_dims]
+        name = h[14].split(b"\0")[0].decode()
+        layer = h[15].split(b"\0")[0].decode()
+        start = pos + RECORD_HEADER.size
+        if dtype == 2:  # bf16
+            array = (np.frombuffer(buf, np.uint16, data_bytes // 2, start).astype(np.uint32) << 16).view(np.float32)
+        else:
+            array = np.frombuffer(buf, NUMPY_TYPES[dtype], data_bytes // NUMPY_TYPES[dtype].itemsize, start)
+        records.append((name, layer, run, array.reshape(shape)))
+        pos += h[2]
+    return records
+
+
+def record_module_outputs(model, writer, names):
+    """register forward hooks that write the output of model.named_modules() entries
+    names : {module name : dump tensor name (e.g. "(Unnamed Layer* 1) [Convolution]_output")}"""
+    handles = []
+    for module_name, module in model.named_modules():
+        if module_name in names:
+            def hook(m, inputs, output, module_name=module_name):
+                writer.append(names[module_name], module_name, output.detach().cpu().numpy())
+            handles.append(module.register_forward_hook(hook))
+    return handles